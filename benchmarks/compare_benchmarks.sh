@@ -0,0 +1,83 @@
+#!/bin/sh
+#
+#  compare_benchmarks.sh OLD-RESULTS NEW-RESULTS [THRESHOLD-PERCENT]
+#
+#  Compares two result files written by run_benchmarks_json.sh. For
+#  every benchmark/dataset pair the best (smallest) wall time of the
+#  runs in each file is compared and pairs that got slower by more
+#  than the threshold (default: 3 percent) are flagged. Exits with a
+#  non-zero status if there is any regression, so upgrades can be
+#  gated on "no regression beyond X percent" in a script.
+#
+
+set -e
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 OLD-RESULTS NEW-RESULTS [THRESHOLD-PERCENT]"
+    exit 2
+fi
+
+OLD_RESULTS=$1
+NEW_RESULTS=$2
+THRESHOLD=${3:-3}
+
+awk -v threshold="$THRESHOLD" '
+    function extract_str(line, key,    re) {
+        re = "\"" key "\":\"[^\"]*\"";
+        if (match(line, re)) {
+            return substr(line, RSTART + length(key) + 4, RLENGTH - length(key) - 5);
+        }
+        return "";
+    }
+    function extract_num(line, key,    re) {
+        re = "\"" key "\":[0-9.eE+-]+";
+        if (match(line, re)) {
+            return substr(line, RSTART + length(key) + 3, RLENGTH - length(key) - 3) + 0;
+        }
+        return -1;
+    }
+    {
+        id = extract_str($0, "benchmark") "/" extract_str($0, "dataset");
+        wall = extract_num($0, "wall_s");
+        rss = extract_num($0, "peak_rss_kb");
+        if (FILENAME == ARGV[1]) {
+            if (!(id in old_wall) || wall < old_wall[id]) {
+                old_wall[id] = wall;
+                old_rss[id] = rss;
+            }
+        } else {
+            if (!(id in new_wall) || wall < new_wall[id]) {
+                new_wall[id] = wall;
+                new_rss[id] = rss;
+            }
+        }
+    }
+    END {
+        regressions = 0;
+        printf "%-40s %10s %10s %8s %8s\n", "# benchmark/dataset", "old_s", "new_s", "diff_pct", "rss_pct";
+        for (id in new_wall) {
+            if (!(id in old_wall)) {
+                printf "%-40s %10s %10.3f %8s %8s new\n", id, "-", new_wall[id], "-", "-";
+                continue;
+            }
+            diff = (old_wall[id] > 0) ? (new_wall[id] - old_wall[id]) / old_wall[id] * 100 : 0;
+            rss_diff = (old_rss[id] > 0) ? (new_rss[id] - old_rss[id]) / old_rss[id] * 100 : 0;
+            flag = "";
+            if (diff > threshold) {
+                flag = " REGRESSION";
+                ++regressions;
+            }
+            printf "%-40s %10.3f %10.3f %8.1f %8.1f%s\n", id, old_wall[id], new_wall[id], diff, rss_diff, flag;
+        }
+        for (id in old_wall) {
+            if (!(id in new_wall)) {
+                printf "%-40s %10.3f %10s %8s %8s removed\n", id, old_wall[id], "-", "-", "-";
+            }
+        }
+        if (regressions > 0) {
+            printf "\n%d regression(s) beyond %s%%\n", regressions, threshold;
+            exit 1;
+        }
+        printf "\nno regressions beyond %s%%\n", threshold;
+    }
+' "$OLD_RESULTS" "$NEW_RESULTS"
@@ -0,0 +1,148 @@
+/*
+
+  This benchmarks the different ways of running several handlers over
+  a buffer: osmium::apply() with the handlers chained through a
+  ChainHandler, osmium::apply() with all handlers passed directly, and
+  the fused osmium::apply_chain() which decides each item's type only
+  once for all handlers. The buffer is generated in memory, no input
+  file is needed.
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/handler/chain.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/visitor.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+constexpr const std::size_t default_num_objects = 2 * 1000 * 1000;
+constexpr const std::size_t num_runs = 5;
+
+struct CountHandler : public osmium::handler::Handler {
+
+    uint64_t nodes = 0;
+    uint64_t ways = 0;
+
+    void node(const osmium::Node& /*node*/) noexcept {
+        ++nodes;
+    }
+
+    void way(const osmium::Way& /*way*/) noexcept {
+        ++ways;
+    }
+
+}; // struct CountHandler
+
+struct TagCountHandler : public osmium::handler::Handler {
+
+    uint64_t tags = 0;
+
+    // node() and way() instead of osm_object(), because ChainHandler
+    // does not forward osm_object() and all variants should do the
+    // same work
+    void node(const osmium::Node& node) noexcept {
+        tags += node.tags().size();
+    }
+
+    void way(const osmium::Way& way) noexcept {
+        tags += way.tags().size();
+    }
+
+}; // struct TagCountHandler
+
+struct RefCountHandler : public osmium::handler::Handler {
+
+    uint64_t refs = 0;
+
+    void way(const osmium::Way& way) noexcept {
+        refs += way.nodes().size();
+    }
+
+}; // struct RefCountHandler
+
+osmium::memory::Buffer generate_buffer(const std::size_t num_objects) {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+
+    for (std::size_t i = 0; i < num_objects; ++i) {
+        const auto id = static_cast<osmium::object_id_type>(i + 1);
+        if (i % 10 == 9) {
+            osmium::builder::add_way(buffer, _id(id), _version(1),
+                                     _nodes({id, id + 1, id + 2}),
+                                     _tag("highway", "residential"));
+        } else {
+            osmium::builder::add_node(buffer, _id(id), _version(1),
+                                      _location(1.02, 2.03),
+                                      _tag("name", "some name"));
+        }
+    }
+
+    return buffer;
+}
+
+template <typename TFunc>
+double run_timed(const std::size_t num_objects, TFunc&& func) {
+    double best = 1e100;
+    for (std::size_t run = 0; run < num_runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        const auto end = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(num_objects);
+        if (ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t num_objects = default_num_objects;
+    if (argc == 2) {
+        num_objects = std::stoul(argv[1]);
+    } else if (argc > 2) {
+        std::cerr << "Usage: " << argv[0] << " [NUM_OBJECTS]\n";
+        std::exit(1);
+    }
+
+    // not const: ChainHandler only takes non-const objects
+    osmium::memory::Buffer buffer = generate_buffer(num_objects);
+
+    CountHandler count;
+    TagCountHandler tags;
+    RefCountHandler refs;
+    CountHandler count2;
+    TagCountHandler tags2;
+    RefCountHandler refs2;
+
+    const double chained = run_timed(num_objects, [&](){
+        osmium::handler::ChainHandler<CountHandler, TagCountHandler, RefCountHandler, CountHandler, TagCountHandler, RefCountHandler> chain{count, tags, refs, count2, tags2, refs2};
+        osmium::apply(buffer, chain);
+    });
+
+    const double direct = run_timed(num_objects, [&](){
+        osmium::apply(buffer, count, tags, refs, count2, tags2, refs2);
+    });
+
+    const double fused = run_timed(num_objects, [&](){
+        osmium::apply_chain(buffer, count, tags, refs, count2, tags2, refs2);
+    });
+
+    std::cout << "objects: " << num_objects << "\n";
+    std::cout << "  apply(ChainHandler): " << chained << " ns/object\n";
+    std::cout << "  apply(h1, ..., h6):  " << direct  << " ns/object\n";
+    std::cout << "  apply_chain:         " << fused   << " ns/object\n";
+
+    // use the results so the handler calls can not be optimized away
+    std::cout << "checksum: " << (count.nodes + count.ways + tags.tags + refs.refs) << "\n";
+}
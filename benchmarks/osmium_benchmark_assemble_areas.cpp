@@ -0,0 +1,87 @@
+/*
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <osmium/area/assembler.hpp>
+#include <osmium/area/multipolygon_manager.hpp>
+#include <osmium/handler/node_locations_for_ways.hpp>
+#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/io/any_input.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/relations/manager_util.hpp>
+#include <osmium/util/memory.hpp>
+#include <osmium/visitor.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    const auto duration = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000000.0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE\n";
+        std::exit(1);
+    }
+
+    const osmium::io::File input_file{argv[1]};
+
+    osmium::area::Assembler::config_type assembler_config;
+    osmium::area::MultipolygonManager<osmium::area::Assembler> mp_manager{assembler_config};
+
+    const auto start_pass1 = std::chrono::steady_clock::now();
+    osmium::relations::read_relations(input_file, mp_manager);
+    const double pass1_duration = seconds_since(start_pass1);
+
+    index_type index;
+    location_handler_type location_handler{index};
+    location_handler.ignore_errors();
+
+    uint64_t areas_from_ways = 0;
+    uint64_t areas_from_relations = 0;
+
+    const auto start_pass2 = std::chrono::steady_clock::now();
+    osmium::io::Reader reader{input_file};
+    osmium::apply(reader, location_handler, mp_manager.handler([&](osmium::memory::Buffer&& buffer) {
+        for (const auto& area : buffer.select<osmium::Area>()) {
+            if (area.from_way()) {
+                ++areas_from_ways;
+            } else {
+                ++areas_from_relations;
+            }
+        }
+    }));
+    reader.close();
+    const double pass2_duration = seconds_since(start_pass2);
+
+    std::cout << "pass1 (relations): " << pass1_duration << " s\n";
+    std::cout << "pass2 (assembly): " << pass2_duration << " s\n";
+    std::cout << "areas from ways: " << areas_from_ways << "\n";
+    std::cout << "areas from relations: " << areas_from_relations << "\n";
+    if (pass2_duration > 0.0) {
+        std::cout << "relations/s: " << (areas_from_relations / pass2_duration) << "\n";
+    }
+
+    // The per-phase times are only filled in when libosmium was compiled
+    // with OSMIUM_WITH_TIMER defined.
+    std::cout << "stats:" << mp_manager.stats() << "\n";
+
+    std::cout << "slowest relations:\n";
+    for (const auto& timing : mp_manager.slowest_relations()) {
+        std::cout << "  r" << timing.id << " " << (timing.nanoseconds / 1000000.0) << " ms\n";
+    }
+
+    const osmium::MemoryUsage memory;
+    std::cout << "peak memory: " << memory.peak() << " MBytes\n";
+}
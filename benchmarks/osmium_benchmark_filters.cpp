@@ -0,0 +1,143 @@
+/*
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <osmium/io/any_input.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/tags/taglist.hpp>
+#include <osmium/tags/tags_filter.hpp>
+#include <osmium/util/memory.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef OSMIUM_WITH_REGEX
+# include <regex>
+#endif
+
+constexpr const std::size_t rule_counts[] = {1, 10, 100, 1000};
+
+// Collect the keys appearing in the input ordered by how often they
+// appear, so the generated rule sets probe the keys with a realistic
+// distribution. Keys beyond what the input has are synthesized; rules
+// that never match are realistic, too.
+static std::vector<std::string> keys_by_frequency(const std::vector<osmium::memory::Buffer>& buffers) {
+    std::unordered_map<std::string, uint64_t> counts;
+
+    for (const auto& buffer : buffers) {
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            for (const auto& tag : object.tags()) {
+                ++counts[tag.key()];
+            }
+        }
+    }
+
+    std::vector<std::pair<uint64_t, std::string>> sorted;
+    sorted.reserve(counts.size());
+    for (const auto& entry : counts) {
+        sorted.emplace_back(entry.second, entry.first);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<uint64_t, std::string>& lhs, const std::pair<uint64_t, std::string>& rhs) {
+        return lhs.first > rhs.first;
+    });
+
+    std::vector<std::string> keys;
+    keys.reserve(sorted.size());
+    for (const auto& entry : sorted) {
+        keys.push_back(entry.second);
+    }
+
+    const std::size_t max_rules = rule_counts[3];
+    for (std::size_t i = keys.size(); i < max_rules; ++i) {
+        keys.push_back("synthetic_key_" + std::to_string(i));
+    }
+
+    return keys;
+}
+
+static void run(const std::string& name, const osmium::TagsFilter& filter, const std::vector<osmium::memory::Buffer>& buffers) {
+    uint64_t objects = 0;
+    uint64_t matches = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (const auto& buffer : buffers) {
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            ++objects;
+            if (osmium::tags::match_any_of(object.tags(), filter)) {
+                ++matches;
+            }
+        }
+    }
+
+    const auto duration = std::chrono::steady_clock::now() - start;
+    const double seconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000000.0;
+
+    std::cout << name << " " << objects << " objects in " << seconds << " s";
+    if (seconds > 0.0) {
+        std::cout << " (" << static_cast<uint64_t>(objects / seconds) << " objects/s)";
+    }
+    std::cout << ", " << matches << " matches\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE\n";
+        std::exit(1);
+    }
+
+    const std::string input_filename{argv[1]};
+
+    std::vector<osmium::memory::Buffer> buffers;
+    osmium::io::Reader reader{input_filename};
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        buffers.push_back(std::move(buffer));
+    }
+    reader.close();
+
+    const auto keys = keys_by_frequency(buffers);
+
+    for (const auto num_rules : rule_counts) {
+        osmium::TagsFilter filter;
+        for (std::size_t i = 0; i < num_rules; ++i) {
+            filter.add_rule(true, keys[i].c_str());
+        }
+        run("equal_" + std::to_string(num_rules) + "          ", filter, buffers);
+
+        osmium::TagsFilter compiled_filter{filter};
+        compiled_filter.compile();
+        run("equal_" + std::to_string(num_rules) + "_compiled ", compiled_filter, buffers);
+    }
+
+    for (const auto num_rules : rule_counts) {
+        osmium::TagsFilter filter;
+        for (std::size_t i = 0; i < num_rules; ++i) {
+            const auto prefix = keys[i].substr(0, 3);
+            filter.add_rule(true, osmium::TagMatcher{osmium::StringMatcher::prefix{prefix}});
+        }
+        run("prefix_" + std::to_string(num_rules) + "         ", filter, buffers);
+    }
+
+#ifdef OSMIUM_WITH_REGEX
+    for (const auto num_rules : rule_counts) {
+        osmium::TagsFilter filter;
+        for (std::size_t i = 0; i < num_rules; ++i) {
+            filter.add_rule(true, osmium::TagMatcher{osmium::StringMatcher::regex{std::regex{"^" + keys[i] + "$", std::regex::optimize}}});
+        }
+        run("regex_" + std::to_string(num_rules) + "          ", filter, buffers);
+    }
+#endif
+
+    const osmium::MemoryUsage memory;
+    std::cout << "peak memory: " << memory.peak() << " MBytes\n";
+}
@@ -0,0 +1,374 @@
+/*
+
+  Generates a synthetic OSM file shaped like real planet data for use
+  in benchmarks: node ids are ascending with deletion holes and larger
+  never-assigned gaps, tag keys follow a Zipf-like frequency
+  distribution over a fixed vocabulary, way lengths and relation sizes
+  are drawn from planet-like histograms, and way nodes reference
+  nearby node ids like they do in a real extract.
+
+  The output is fully determined by the seed: std::mt19937_64 is
+  exactly specified by the standard and all sampling helpers are
+  implemented here instead of using the std distributions, whose
+  output may differ between standard library implementations. The same
+  seed therefore produces byte-identical data on every machine, which
+  makes benchmark results comparable across machines and dates without
+  downloading real extracts.
+
+  Usage: osmium_benchmark_generate OUTFILE [NUM_NODES [SEED]]
+
+  The number of ways and relations is derived from the number of nodes
+  using the planet ratios (roughly one way per 9 nodes and one
+  relation per 100 ways).
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/io/any_output.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+constexpr const std::size_t default_num_nodes = 1000 * 1000;
+
+constexpr const std::size_t buffer_flush_size = 800 * 1024;
+
+/**
+ * All randomness in the generator goes through these helpers so the
+ * output only depends on the exactly-specified std::mt19937_64 engine.
+ */
+class random_source {
+
+    std::mt19937_64 m_rng;
+
+public:
+
+    explicit random_source(const uint64_t seed) :
+        m_rng(seed) {
+    }
+
+    /// Random integer in [0, bound). The modulo bias is irrelevant here.
+    uint64_t uniform(const uint64_t bound) {
+        return m_rng() % bound;
+    }
+
+    /// Random true with the given percent probability.
+    bool percent(const uint64_t p) {
+        return uniform(100) < p;
+    }
+
+    /// Random double in [0.0, 1.0).
+    double uniform_real() {
+        return static_cast<double>(m_rng() >> 11U) * (1.0 / 9007199254740992.0);
+    }
+
+    /**
+     * Random value from a histogram given as (value, weight) pairs.
+     * Used for the way-length and relation-size distributions.
+     */
+    uint64_t from_histogram(const std::vector<std::pair<uint64_t, uint64_t>>& histogram) {
+        uint64_t total = 0;
+        for (const auto& bucket : histogram) {
+            total += bucket.second;
+        }
+        uint64_t pick = uniform(total);
+        for (const auto& bucket : histogram) {
+            if (pick < bucket.second) {
+                return bucket.first;
+            }
+            pick -= bucket.second;
+        }
+        return histogram.back().first;
+    }
+
+    /**
+     * Random rank in [0, num_ranks) with Zipf-like probability 1/(rank+1),
+     * used to pick tags so few keys are very common and most are rare,
+     * like in real planet data.
+     */
+    std::size_t zipf(const std::vector<double>& cumulative) {
+        const double pick = uniform_real() * cumulative.back();
+        std::size_t rank = 0;
+        while (rank < cumulative.size() - 1 && cumulative[rank] < pick) {
+            ++rank;
+        }
+        return rank;
+    }
+
+}; // class random_source
+
+/// Tag vocabulary ordered by frequency rank, most common first.
+static const std::vector<std::pair<const char*, const char*>> tag_vocabulary = {
+    {"building", "yes"},
+    {"highway", "residential"},
+    {"source", "survey"},
+    {"natural", "tree"},
+    {"surface", "asphalt"},
+    {"landuse", "farmland"},
+    {"power", "tower"},
+    {"waterway", "stream"},
+    {"amenity", "parking"},
+    {"oneway", "yes"},
+    {"barrier", "fence"},
+    {"access", "private"},
+    {"railway", "rail"},
+    {"maxspeed", "50"},
+    {"leisure", "pitch"},
+    {"bridge", "yes"},
+    {"lanes", "2"},
+    {"shop", "convenience"},
+    {"tourism", "information"},
+    {"boundary", "administrative"}
+};
+
+static std::vector<double> build_zipf_table(const std::size_t num_ranks) {
+    std::vector<double> cumulative;
+    cumulative.reserve(num_ranks);
+    double sum = 0.0;
+    for (std::size_t rank = 0; rank < num_ranks; ++rank) {
+        sum += 1.0 / static_cast<double>(rank + 1);
+        cumulative.push_back(sum);
+    }
+    return cumulative;
+}
+
+// Planet-like way length histogram: most ways are short (building
+// outlines, road segments), with a tail of long coastline- and
+// boundary-like ways. Mean is around 10 nodes per way.
+static const std::vector<std::pair<uint64_t, uint64_t>> way_length_histogram = {
+    {4, 30}, {5, 25}, {8, 15}, {12, 10}, {20, 9}, {40, 6}, {100, 3}, {500, 1}, {1900, 1}
+};
+
+// Planet-like relation size histogram: mostly small multipolygons and
+// restrictions, with a tail of large route and boundary relations.
+static const std::vector<std::pair<uint64_t, uint64_t>> relation_size_histogram = {
+    {2, 30}, {3, 25}, {5, 20}, {10, 12}, {25, 7}, {80, 4}, {300, 2}
+};
+
+class generator {
+
+    random_source m_random;
+    osmium::io::Writer& m_writer;
+    osmium::memory::Buffer m_buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+
+    std::vector<double> m_zipf_table = build_zipf_table(tag_vocabulary.size());
+
+    /// All node ids generated, ascending. Ways pick their nodes from this.
+    std::vector<osmium::object_id_type> m_node_ids;
+
+    /// All way ids generated, ascending. Relations pick members from this.
+    std::vector<osmium::object_id_type> m_way_ids;
+
+    void flush_buffer() {
+        if (m_buffer.committed() > buffer_flush_size) {
+            osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+            using std::swap;
+            swap(buffer, m_buffer);
+            m_writer(std::move(buffer));
+        }
+    }
+
+    /**
+     * Generate tags with Zipf-distributed keys. Objects have between
+     * min_tags and min_tags + 2 tags (before deduplication).
+     */
+    void add_tags(osmium::builder::Builder& parent, const uint64_t min_tags) {
+        osmium::builder::TagListBuilder builder{parent};
+        const uint64_t num_tags = min_tags + m_random.uniform(3);
+        std::size_t last_rank = tag_vocabulary.size();
+        for (uint64_t i = 0; i < num_tags; ++i) {
+            const std::size_t rank = m_random.zipf(m_zipf_table);
+            if (rank == last_rank) { // no duplicate keys
+                continue;
+            }
+            last_rank = rank;
+            builder.add_tag(tag_vocabulary[rank].first, tag_vocabulary[rank].second);
+        }
+    }
+
+    /**
+     * The next id after the specified one, leaving planet-like holes:
+     * mostly consecutive, about 15% deleted ids, and an occasional
+     * larger never-assigned gap.
+     */
+    osmium::object_id_type next_id(const osmium::object_id_type id) {
+        if (m_random.percent(1)) {
+            return id + 1 + static_cast<osmium::object_id_type>(m_random.uniform(10000));
+        }
+        if (m_random.percent(15)) {
+            return id + 2 + static_cast<osmium::object_id_type>(m_random.uniform(3));
+        }
+        return id + 1;
+    }
+
+public:
+
+    generator(const uint64_t seed, osmium::io::Writer& writer) :
+        m_random(seed),
+        m_writer(writer) {
+    }
+
+    void write_nodes(const std::size_t count) {
+        m_node_ids.reserve(count);
+
+        // Nodes are generated in clusters wandering over the world,
+        // like densely mapped regions in real data.
+        double lon = 8.0;
+        double lat = 47.0;
+
+        osmium::object_id_type id = 1;
+        for (std::size_t n = 0; n < count; ++n) {
+            if (m_random.percent(1)) { // jump to a new cluster
+                lon = -175.0 + m_random.uniform_real() * 350.0;
+                lat = -80.0 + m_random.uniform_real() * 160.0;
+            } else { // wander within the cluster
+                lon += (m_random.uniform_real() - 0.5) * 0.01;
+                lat += (m_random.uniform_real() - 0.5) * 0.01;
+            }
+
+            {
+                osmium::builder::NodeBuilder builder{m_buffer};
+                builder.object().set_id(id);
+                builder.object().set_version(1);
+                builder.object().set_timestamp(static_cast<osmium::Timestamp>(1500000000 + m_random.uniform(100000000)));
+                builder.object().set_location(osmium::Location{lon, lat});
+                builder.set_user("");
+                if (m_random.percent(5)) { // most nodes are untagged
+                    add_tags(builder, 1);
+                }
+            }
+            m_buffer.commit();
+            flush_buffer();
+
+            m_node_ids.push_back(id);
+            id = next_id(id);
+        }
+    }
+
+    void write_ways(const std::size_t count) {
+        m_way_ids.reserve(count);
+
+        osmium::object_id_type id = 1;
+        for (std::size_t n = 0; n < count; ++n) {
+            const uint64_t num_nodes = m_random.from_histogram(way_length_histogram);
+
+            // Way nodes reference ids close together: the nodes of a
+            // way were usually uploaded in one changeset.
+            const std::size_t start = m_random.uniform(m_node_ids.size());
+
+            {
+                osmium::builder::WayBuilder builder{m_buffer};
+                builder.object().set_id(id);
+                builder.object().set_version(1);
+                builder.object().set_timestamp(static_cast<osmium::Timestamp>(1500000000 + m_random.uniform(100000000)));
+                builder.set_user("");
+                {
+                    osmium::builder::WayNodeListBuilder wnl_builder{builder};
+                    std::size_t index = start;
+                    for (uint64_t i = 0; i < num_nodes && index < m_node_ids.size(); ++i) {
+                        wnl_builder.add_node_ref(m_node_ids[index]);
+                        index += 1 + m_random.uniform(3);
+                    }
+                    if (m_random.percent(40)) { // closed ways: building outlines etc.
+                        wnl_builder.add_node_ref(m_node_ids[start]);
+                    }
+                }
+                add_tags(builder, 1);
+            }
+            m_buffer.commit();
+            flush_buffer();
+
+            m_way_ids.push_back(id);
+            id = next_id(id);
+        }
+    }
+
+    void write_relations(const std::size_t count) {
+        osmium::object_id_type id = 1;
+        for (std::size_t n = 0; n < count; ++n) {
+            const uint64_t num_members = m_random.from_histogram(relation_size_histogram);
+
+            {
+                osmium::builder::RelationBuilder builder{m_buffer};
+                builder.object().set_id(id);
+                builder.object().set_version(1);
+                builder.object().set_timestamp(static_cast<osmium::Timestamp>(1500000000 + m_random.uniform(100000000)));
+                builder.set_user("");
+                {
+                    osmium::builder::RelationMemberListBuilder member_builder{builder};
+                    for (uint64_t i = 0; i < num_members; ++i) {
+                        if (m_random.percent(80)) { // most members are ways
+                            const auto member_id = m_way_ids[m_random.uniform(m_way_ids.size())];
+                            member_builder.add_member(osmium::item_type::way, member_id, i == 0 ? "outer" : "inner");
+                        } else {
+                            const auto member_id = m_node_ids[m_random.uniform(m_node_ids.size())];
+                            member_builder.add_member(osmium::item_type::node, member_id, "");
+                        }
+                    }
+                }
+                {
+                    osmium::builder::TagListBuilder tl_builder{builder};
+                    tl_builder.add_tag("type", m_random.percent(60) ? "multipolygon" : "route");
+                }
+            }
+            m_buffer.commit();
+            flush_buffer();
+
+            id = next_id(id);
+        }
+    }
+
+    void close() {
+        if (m_buffer.committed() > 0) {
+            m_writer(std::move(m_buffer));
+        }
+    }
+
+}; // class generator
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " OUTFILE [NUM_NODES [SEED]]\n";
+        std::exit(1);
+    }
+
+    const std::string output_filename{argv[1]};
+    const std::size_t num_nodes = argc > 2 ? static_cast<std::size_t>(std::atoll(argv[2])) : default_num_nodes;
+    const uint64_t seed = argc > 3 ? static_cast<uint64_t>(std::atoll(argv[3])) : 4711;
+
+    // Planet ratios: about one way per 9 nodes, one relation per 100 ways.
+    const std::size_t num_ways = num_nodes / 9;
+    const std::size_t num_relations = num_ways / 100;
+
+    osmium::io::Header header;
+    header.set("generator", "osmium_benchmark_generate/" + std::to_string(seed));
+
+    osmium::io::Writer writer{output_filename, header, osmium::io::overwrite::allow};
+
+    generator gen{seed, writer};
+    gen.write_nodes(num_nodes);
+    gen.write_ways(num_ways);
+    gen.write_relations(num_relations);
+    gen.close();
+
+    writer.close();
+
+    std::cout << "Nodes: "     << num_nodes     << '\n';
+    std::cout << "Ways: "      << num_ways      << '\n';
+    std::cout << "Relations: " << num_relations << '\n';
+    std::cout << "Seed: "      << seed          << '\n';
+}
@@ -0,0 +1,113 @@
+/*
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <osmium/geom/geojson.hpp>
+#include <osmium/geom/mercator_projection.hpp>
+#include <osmium/geom/wkb.hpp>
+#include <osmium/geom/wkt.hpp>
+#include <osmium/handler/node_locations_for_ways.hpp>
+#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/io/any_input.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/util/memory.hpp>
+#include <osmium/visitor.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
+
+template <typename TFactory>
+static void run(const char* name, TFactory& factory, const std::vector<osmium::memory::Buffer>& buffers) {
+    uint64_t geometries = 0;
+    uint64_t bytes = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (const auto& buffer : buffers) {
+        for (const auto& way : buffer.select<osmium::Way>()) {
+            try {
+                const auto geom = factory.create_linestring(way);
+                bytes += geom.size();
+                ++geometries;
+            } catch (const osmium::geometry_error&) {
+                // ignore broken geometries
+            }
+        }
+    }
+
+    const auto duration = std::chrono::steady_clock::now() - start;
+    const double seconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000000.0;
+
+    std::cout << name << " " << geometries << " geometries in " << seconds << " s";
+    if (seconds > 0.0) {
+        std::cout << " (" << static_cast<uint64_t>(geometries / seconds) << " geometries/s)";
+    }
+    std::cout << ", " << bytes << " bytes\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE\n";
+        std::exit(1);
+    }
+
+    const std::string input_filename{argv[1]};
+
+    // Read the whole file into memory and set the node locations on all
+    // way nodes, so the benchmark loops measure only the geometry
+    // factories and not the I/O.
+    std::vector<osmium::memory::Buffer> buffers;
+
+    index_type index;
+    location_handler_type location_handler{index};
+    location_handler.ignore_errors();
+
+    osmium::io::Reader reader{input_filename};
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        osmium::apply(buffer, location_handler);
+        buffers.push_back(std::move(buffer));
+    }
+    reader.close();
+
+    {
+        osmium::geom::WKBFactory<> factory{osmium::geom::wkb_type::wkb, osmium::geom::out_type::binary};
+        run("wkb            ", factory, buffers);
+    }
+    {
+        osmium::geom::WKBFactory<> factory{osmium::geom::wkb_type::wkb, osmium::geom::out_type::hex};
+        run("wkb_hex        ", factory, buffers);
+    }
+    {
+        osmium::geom::WKBFactory<osmium::geom::MercatorProjection> factory{osmium::geom::wkb_type::wkb, osmium::geom::out_type::binary};
+        run("wkb_mercator   ", factory, buffers);
+    }
+    {
+        osmium::geom::WKTFactory<> factory;
+        run("wkt            ", factory, buffers);
+    }
+    {
+        osmium::geom::WKTFactory<osmium::geom::MercatorProjection> factory{2};
+        run("wkt_mercator   ", factory, buffers);
+    }
+    {
+        osmium::geom::GeoJSONFactory<> factory;
+        run("geojson        ", factory, buffers);
+    }
+    {
+        osmium::geom::GeoJSONFactory<osmium::geom::MercatorProjection> factory{2};
+        run("geojson_mercator", factory, buffers);
+    }
+
+    const osmium::MemoryUsage memory;
+    std::cout << "peak memory: " << memory.peak() << " MBytes\n";
+}
@@ -0,0 +1,214 @@
+/*
+
+  This benchmarks the index maps and multimaps with synthetic
+  "planet-shaped" id distributions: long dense ascending ranges with
+  deletion holes and occasional larger gaps, like the node ids in a
+  planet file or an extract. No input file is needed, so different
+  index types can be compared without running full planet jobs.
+
+  For the maps it measures building the index, sorting it, and mixes
+  of hit-only and hit/miss lookups, for the multimaps building,
+  consolidating, and range lookups. Times are reported in ns per
+  operation together with the memory used by the index and the peak
+  RSS of the process.
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <osmium/index/map/all.hpp>
+#include <osmium/index/multimap/hybrid.hpp>
+#include <osmium/index/multimap/sparse_mem_array.hpp>
+#include <osmium/index/multimap/sparse_mem_multimap.hpp>
+#include <osmium/index/node_locations_map.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/util/memory.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using id_type = osmium::unsigned_object_id_type;
+
+using map_type = osmium::index::map::Map<id_type, osmium::Location>;
+
+constexpr const std::size_t default_num_ids = 10 * 1000 * 1000;
+constexpr const std::size_t num_lookups = 2 * 1000 * 1000;
+
+/**
+ * Generate ascending ids shaped like the node ids in a planet file:
+ * mostly consecutive runs with about 15% deletion holes and an
+ * occasional larger gap where a range of ids was never assigned.
+ */
+std::vector<id_type> generate_ids(const std::size_t count) {
+    std::vector<id_type> ids;
+    ids.reserve(count);
+
+    std::mt19937_64 rng{4711};
+    std::uniform_int_distribution<int> percent{0, 99};
+    std::uniform_int_distribution<id_type> gap{1000, 100000};
+
+    id_type id = 1;
+    while (ids.size() < count) {
+        if (percent(rng) < 85) {
+            ids.push_back(id);
+        }
+        ++id;
+        if (percent(rng) == 0 && percent(rng) == 0) {
+            id += gap(rng);
+        }
+    }
+
+    return ids;
+}
+
+double ns_per_op(const std::chrono::steady_clock::time_point start,
+                 const std::chrono::steady_clock::time_point end,
+                 const std::size_t ops) {
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(ops);
+}
+
+void report(const char* phase, const std::chrono::steady_clock::time_point start,
+            const std::chrono::steady_clock::time_point end, const std::size_t ops) {
+    std::cout << "  " << phase << ": " << ns_per_op(start, end, ops) << " ns/op\n";
+}
+
+void benchmark_map(map_type& index, const std::vector<id_type>& ids) {
+    const auto build_start = std::chrono::steady_clock::now();
+    for (const auto id : ids) {
+        index.set(id, osmium::Location{int32_t(id & 0x7fffffff), int32_t(id >> 8u)});
+    }
+    const auto build_end = std::chrono::steady_clock::now();
+    report("build", build_start, build_end, ids.size());
+
+    const auto sort_start = std::chrono::steady_clock::now();
+    index.sort();
+    const auto sort_end = std::chrono::steady_clock::now();
+    report("sort", sort_start, sort_end, ids.size());
+
+    std::mt19937_64 rng{815};
+    std::uniform_int_distribution<std::size_t> pick{0, ids.size() - 1};
+    const id_type beyond = ids.back() + 1000;
+
+    std::uint64_t sum = 0;
+
+    const auto hit_start = std::chrono::steady_clock::now();
+    for (std::size_t n = 0; n < num_lookups; ++n) {
+        sum += static_cast<std::uint64_t>(index.get_noexcept(ids[pick(rng)]).x());
+    }
+    const auto hit_end = std::chrono::steady_clock::now();
+    report("lookup hits", hit_start, hit_end, num_lookups);
+
+    // Half the lookups ask for ids above everything in the index,
+    // simulating ways referencing nodes outside an extract.
+    const auto mix_start = std::chrono::steady_clock::now();
+    for (std::size_t n = 0; n < num_lookups; ++n) {
+        const id_type id = (n & 1u) ? beyond + static_cast<id_type>(n) : ids[pick(rng)];
+        sum += static_cast<std::uint64_t>(index.get_noexcept(id).x());
+    }
+    const auto mix_end = std::chrono::steady_clock::now();
+    report("lookup 50% misses", mix_start, mix_end, num_lookups);
+
+    std::cout << "  index memory: " << (index.used_memory() / (1024 * 1024)) << " MBytes\n";
+    std::cout << "  (checksum " << sum << ")\n";
+}
+
+template <typename TIndex, typename TConsolidate>
+void benchmark_multimap(const std::vector<id_type>& ids, TConsolidate&& consolidate) {
+    TIndex index;
+
+    // Every 10th id gets a run of ~10 values, like ways with their
+    // node references.
+    const auto build_start = std::chrono::steady_clock::now();
+    std::size_t num_entries = 0;
+    for (std::size_t n = 0; n < ids.size(); n += 10) {
+        for (std::size_t m = 0; m < 10 && n + m < ids.size(); ++m) {
+            index.set(ids[n], ids[n + m]);
+            ++num_entries;
+        }
+    }
+    const auto build_end = std::chrono::steady_clock::now();
+    report("build", build_start, build_end, num_entries);
+
+    const auto sort_start = std::chrono::steady_clock::now();
+    consolidate(index);
+    const auto sort_end = std::chrono::steady_clock::now();
+    report("consolidate", sort_start, sort_end, num_entries);
+
+    std::mt19937_64 rng{815};
+    std::uniform_int_distribution<std::size_t> pick{0, (ids.size() - 1) / 10};
+    const id_type beyond = ids.back() + 1000;
+
+    std::uint64_t sum = 0;
+
+    const auto hit_start = std::chrono::steady_clock::now();
+    for (std::size_t n = 0; n < num_lookups; ++n) {
+        const auto range = index.get_all(ids[pick(rng) * 10]);
+        for (auto it = range.first; it != range.second; ++it) {
+            ++sum;
+        }
+    }
+    const auto hit_end = std::chrono::steady_clock::now();
+    report("lookup hits", hit_start, hit_end, num_lookups);
+
+    const auto mix_start = std::chrono::steady_clock::now();
+    for (std::size_t n = 0; n < num_lookups; ++n) {
+        const id_type id = (n & 1u) ? beyond + static_cast<id_type>(n) : ids[pick(rng) * 10];
+        const auto range = index.get_all(id);
+        for (auto it = range.first; it != range.second; ++it) {
+            ++sum;
+        }
+    }
+    const auto mix_end = std::chrono::steady_clock::now();
+    report("lookup 50% misses", mix_start, mix_end, num_lookups);
+
+    std::cout << "  index memory: " << (index.used_memory() / (1024 * 1024)) << " MBytes\n";
+    std::cout << "  (checksum " << sum << ")\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " INDEX_TYPE [NUM_IDS]\n"
+                  << "INDEX_TYPE is a map type as understood by the map factory or one of\n"
+                  << "multimap_sparse_mem_array, multimap_sparse_mem_multimap, multimap_hybrid\n";
+        std::exit(1);
+    }
+
+    const std::string index_type_name{argv[1]};
+    const std::size_t num_ids = argc == 3 ? static_cast<std::size_t>(std::atoll(argv[2])) : default_num_ids; // NOLINT(cert-err34-c)
+
+    const auto ids = generate_ids(num_ids);
+    std::cout << index_type_name << ": " << ids.size() << " ids up to " << ids.back() << "\n";
+
+    if (index_type_name == "multimap_sparse_mem_array") {
+        using index_type = osmium::index::multimap::SparseMemArray<id_type, id_type>;
+        benchmark_multimap<index_type>(ids, [](index_type& index) {
+            index.sort();
+        });
+    } else if (index_type_name == "multimap_sparse_mem_multimap") {
+        using index_type = osmium::index::multimap::SparseMemMultimap<id_type, id_type>;
+        benchmark_multimap<index_type>(ids, [](index_type& index) {
+            index.consolidate();
+        });
+    } else if (index_type_name == "multimap_hybrid") {
+        using index_type = osmium::index::multimap::Hybrid<id_type, id_type>;
+        benchmark_multimap<index_type>(ids, [](index_type& index) {
+            index.consolidate();
+        });
+    } else {
+        const auto& map_factory = osmium::index::MapFactory<id_type, osmium::Location>::instance();
+        std::unique_ptr<map_type> index = map_factory.create_map(index_type_name);
+        benchmark_map(*index, ids);
+    }
+
+    const osmium::MemoryUsage memory;
+    if (memory.peak() != 0) {
+        std::cout << "  peak RSS: " << memory.peak() << " MBytes\n";
+    }
+}
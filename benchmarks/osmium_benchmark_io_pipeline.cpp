@@ -0,0 +1,125 @@
+/*
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include <osmium/handler.hpp>
+#include <osmium/io/any_input.hpp>
+#include <osmium/io/any_output.hpp>
+#include <osmium/visitor.hpp>
+
+// Converts a file between formats and reports where the time in the
+// read -> handle -> write pipeline went. The wall times show how long
+// the main thread spent in each stage; time spent waiting in read()
+// or in the writer means the bottleneck is in the threads behind that
+// stage. The queue counters break this down further: if a queue runs
+// empty often its producer side is too slow, if it is full often its
+// consumer side is too slow. See osmium::thread::queue_counters.
+
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+    struct CountHandler : public osmium::handler::Handler {
+
+        std::uint64_t count = 0;
+
+        void osm_object(const osmium::OSMObject& /*object*/) noexcept {
+            ++count;
+        }
+
+    }; // struct CountHandler
+
+    double seconds(const clock_type::duration duration) {
+        return std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+    }
+
+    void print_stage(const char* name, const clock_type::duration duration) {
+        std::cout << "  " << name << " " << seconds(duration) << "s\n";
+    }
+
+    void print_queue(const char* name, const osmium::thread::queue_counters& counters) {
+        std::cout << "  " << name
+                  << " push=" << counters.push
+                  << " pop=" << counters.pop
+                  << " full=" << counters.full
+                  << " empty=" << counters.empty
+                  << " largest_size=" << counters.largest_size
+                  << "\n";
+    }
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3 || argc > 5) {
+        std::cerr << "Usage: " << argv[0] << " INPUT-FILE OUTPUT-FILE [INPUT-FORMAT [OUTPUT-FORMAT]]\n";
+        std::exit(1);
+    }
+
+    const std::string input_filename{argv[1]};
+    const std::string output_filename{argv[2]};
+    const std::string input_format{argc > 3 ? argv[3] : ""};
+    const std::string output_format{argc > 4 ? argv[4] : ""};
+
+    const osmium::io::File input_file{input_filename, input_format};
+    const osmium::io::File output_file{output_filename, output_format};
+
+    osmium::io::Reader reader{input_file};
+    osmium::io::Writer writer{output_file, osmium::io::overwrite::allow};
+
+    CountHandler handler;
+
+    clock_type::duration read_wait{0};
+    clock_type::duration handler_time{0};
+    clock_type::duration write_wait{0};
+
+    const auto start = clock_type::now();
+
+    while (true) {
+        auto t = clock_type::now();
+        osmium::memory::Buffer buffer = reader.read();
+        read_wait += clock_type::now() - t;
+
+        if (!buffer) {
+            break;
+        }
+
+        t = clock_type::now();
+        osmium::apply(buffer, handler);
+        handler_time += clock_type::now() - t;
+
+        t = clock_type::now();
+        writer(std::move(buffer));
+        write_wait += clock_type::now() - t;
+    }
+
+    const auto reader_metrics = reader.metrics();
+    const auto writer_metrics = writer.metrics();
+
+    const auto t = clock_type::now();
+    writer.close();
+    reader.close();
+    const auto close_wait = clock_type::now() - t;
+
+    const auto total = clock_type::now() - start;
+
+    std::cout << "objects: " << handler.count << "\n";
+    std::cout << "stage times (main thread):\n";
+    print_stage("read wait   ", read_wait);
+    print_stage("handler     ", handler_time);
+    print_stage("write wait  ", write_wait);
+    print_stage("close wait  ", close_wait);
+    print_stage("total       ", total);
+    std::cout << "queue counters:\n";
+    print_queue("raw input   ", reader_metrics.raw_input_queue);
+    print_queue("osmdata     ", reader_metrics.osmdata_queue);
+    print_queue("raw output  ", writer_metrics.raw_output_queue);
+}
@@ -0,0 +1,200 @@
+/*
+
+  Microbenchmarks for the core primitives: adding items to buffers,
+  constructing objects through the builders, iterating tag lists,
+  converting coordinates, updating CRCs, and decoding varints. The
+  macro benchmarks reading whole files can't resolve the small
+  regressions in these primitives that compound release over release,
+  this one can.
+
+  Each benchmark runs a fixed number of iterations (so runs are
+  comparable) several times and reports the best time in ns per
+  operation, which filters out scheduling noise. No input file is
+  needed.
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/io/detail/varint_decode.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/crc.hpp>
+#include <osmium/osm/crc_zlib.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/tag.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+constexpr const int num_repetitions = 5;
+
+/// Sink for benchmark results so the compiler can't optimize the work away.
+volatile uint64_t v_sink = 0; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+template <typename TFunc>
+void run_benchmark(const char* name, const uint64_t iterations, TFunc&& func) {
+    using clock_type = std::chrono::steady_clock;
+
+    int64_t best = 0;
+    for (int rep = 0; rep < num_repetitions; ++rep) {
+        const auto start = clock_type::now();
+        func(iterations);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count();
+        if (rep == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    std::cout << name << " " << iterations << " "
+              << (static_cast<double>(best) / static_cast<double>(iterations)) << " ns/op\n";
+}
+
+osmium::memory::Buffer make_node_buffer() {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(12345678), _version(3),
+        _location(osmium::Location{9.1234567, 48.7654321}),
+        _user("a_typical_username"),
+        _tag("highway", "residential"),
+        _tag("name", "Some Street"),
+        _tag("surface", "asphalt"),
+        _tag("maxspeed", "30"),
+        _tag("oneway", "yes"),
+        _tag("lit", "yes"),
+        _tag("sidewalk", "both"),
+        _tag("source", "survey"));
+
+    return buffer;
+}
+
+void benchmark_buffer_add_item(const uint64_t iterations) {
+    const osmium::memory::Buffer source = make_node_buffer();
+    const auto& node = source.get<osmium::Node>(0);
+
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+    for (uint64_t i = 0; i < iterations; ++i) {
+        buffer.add_item(node);
+        buffer.commit();
+        if (buffer.committed() > 512UL * 1024UL) {
+            buffer.clear();
+        }
+    }
+    v_sink += buffer.committed();
+}
+
+void benchmark_builder_node(const uint64_t iterations) {
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+    for (uint64_t i = 0; i < iterations; ++i) {
+        {
+            osmium::builder::NodeBuilder builder{buffer};
+            builder.object().set_id(static_cast<osmium::object_id_type>(i));
+            builder.object().set_version(1);
+            builder.object().set_location(osmium::Location{9.0, 48.0});
+            builder.set_user("a_typical_username");
+            {
+                osmium::builder::TagListBuilder tl_builder{builder};
+                tl_builder.add_tag("highway", "residential");
+                tl_builder.add_tag("name", "Some Street");
+            }
+        }
+        buffer.commit();
+        if (buffer.committed() > 512UL * 1024UL) {
+            buffer.clear();
+        }
+    }
+    v_sink += buffer.committed();
+}
+
+void benchmark_taglist_iteration(const uint64_t iterations) {
+    const osmium::memory::Buffer buffer = make_node_buffer();
+    const auto& tags = buffer.get<osmium::Node>(0).tags();
+
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (const auto& tag : tags) {
+            sum += static_cast<uint64_t>(tag.key()[0]) + static_cast<uint64_t>(tag.value()[0]);
+        }
+    }
+    v_sink += sum;
+}
+
+void benchmark_location_conversion(const uint64_t iterations) {
+    uint64_t sum = 0;
+    double lon = -180.0;
+    double lat = -80.0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        const osmium::Location location{lon, lat};
+        sum += static_cast<uint64_t>(static_cast<uint32_t>(location.x()));
+        sum += static_cast<uint64_t>(static_cast<uint32_t>(location.y()));
+        lon += 0.0000357;
+        if (lon > 180.0) {
+            lon = -180.0;
+        }
+        lat += 0.0000173;
+        if (lat > 80.0) {
+            lat = -80.0;
+        }
+    }
+    v_sink += sum;
+}
+
+void benchmark_crc_update(const uint64_t iterations) {
+    const osmium::memory::Buffer buffer = make_node_buffer();
+    const auto& node = buffer.get<osmium::Node>(0);
+
+    osmium::CRC<osmium::CRC_zlib> crc32;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        crc32.update(node);
+    }
+    v_sink += crc32().checksum();
+}
+
+/// Varint-encode a value, the inverse of what the decoder does.
+void encode_varint(std::string& data, uint64_t value) {
+    while (value >= 0x80ULL) {
+        data.push_back(static_cast<char>((value & 0x7fULL) | 0x80ULL));
+        value >>= 7U;
+    }
+    data.push_back(static_cast<char>(value));
+}
+
+void benchmark_varint_decode(const uint64_t iterations) {
+    // Delta-encoded ids like in PBF DenseNodes: mostly small deltas
+    // fitting in one byte, some larger ones.
+    std::string data;
+    const uint64_t values_per_round = 1000;
+    for (uint64_t i = 0; i < values_per_round; ++i) {
+        encode_varint(data, i % 19 == 0 ? 40000 + i * 131 : 2 + i % 7);
+    }
+
+    std::vector<uint64_t> values;
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < iterations / values_per_round; ++i) {
+        values.clear();
+        osmium::io::detail::decode_packed_varint(data.data(), data.data() + data.size(), values);
+        sum += values.back();
+    }
+    v_sink += sum;
+}
+
+int main() {
+    run_benchmark("buffer_add_item    ", 10000000, benchmark_buffer_add_item);
+    run_benchmark("builder_node       ", 10000000, benchmark_builder_node);
+    run_benchmark("taglist_iteration  ",  5000000, benchmark_taglist_iteration);
+    run_benchmark("location_conversion", 50000000, benchmark_location_conversion);
+    run_benchmark("crc_update         ",  5000000, benchmark_crc_update);
+    run_benchmark("varint_decode      ", 50000000, benchmark_varint_decode);
+
+    // Use the sink so nothing is optimized away, but don't make the
+    // output depend on it.
+    if (v_sink == 0) {
+        std::cout << "(empty run)\n";
+    }
+}
@@ -0,0 +1,104 @@
+/*
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <osmium/io/any_input.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/relations/manager_util.hpp>
+#include <osmium/relations/relations_manager.hpp>
+#include <osmium/util/memory.hpp>
+#include <osmium/visitor.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+/**
+ * A manager that tracks all relations and all their members, standing in
+ * for the bookkeeping part of a multipolygon-style two-pass job without
+ * the geometry assembly cost. complete_relation() touches every member
+ * object so the members database lookups are part of the measurement.
+ */
+class BenchmarkManager : public osmium::relations::RelationsManager<BenchmarkManager, true, true, true> {
+
+public:
+
+    std::uint64_t completed_relations = 0;
+    std::uint64_t completed_members = 0;
+    std::uint64_t tags_seen = 0;
+    std::size_t members_db_peak = 0;
+
+    void complete_relation(const osmium::Relation& relation) {
+        ++completed_relations;
+        for (const auto& member : relation.members()) {
+            if (member.ref() != 0) {
+                const osmium::OSMObject* object = this->get_member_object(member);
+                if (object) {
+                    ++completed_members;
+                    tags_seen += object->tags().size();
+                }
+            }
+        }
+
+        const std::size_t used = member_nodes_database().used_memory()
+                               + member_ways_database().used_memory()
+                               + member_relations_database().used_memory();
+        if (used > members_db_peak) {
+            members_db_peak = used;
+        }
+    }
+
+}; // class BenchmarkManager
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    const auto duration = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000000.0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE\n";
+        std::exit(1);
+    }
+
+    const osmium::io::File input_file{argv[1]};
+
+    BenchmarkManager manager;
+
+    const auto start_pass1 = std::chrono::steady_clock::now();
+    osmium::relations::read_relations(input_file, manager);
+    const double pass1_duration = seconds_since(start_pass1);
+
+    const auto start_pass2 = std::chrono::steady_clock::now();
+    osmium::io::Reader reader{input_file};
+    osmium::apply(reader, manager.handler());
+    reader.close();
+    const double pass2_duration = seconds_since(start_pass2);
+
+    std::uint64_t incomplete_relations = 0;
+    manager.for_each_incomplete_relation([&](const osmium::relations::RelationHandle& /*handle*/) {
+        ++incomplete_relations;
+    });
+
+    std::cout << "pass1 (relations): " << pass1_duration << " s\n";
+    std::cout << "pass2 (members): " << pass2_duration << " s\n";
+    std::cout << "completed relations: " << manager.completed_relations << "\n";
+    std::cout << "completed members: " << manager.completed_members << "\n";
+    std::cout << "tags seen: " << manager.tags_seen << "\n";
+    std::cout << "incomplete relations: " << incomplete_relations << "\n";
+    if (pass2_duration > 0.0) {
+        std::cout << "relations/s: " << (manager.completed_relations / pass2_duration) << "\n";
+    }
+
+    std::cout << "members database peak: " << (manager.members_db_peak / 1024) << " kB\n";
+    std::cout << "manager memory after pass2:\n";
+    osmium::relations::print_used_memory(std::cout, manager.used_memory());
+
+    const osmium::MemoryUsage memory;
+    std::cout << "peak memory: " << memory.peak() << " MBytes\n";
+}
@@ -0,0 +1,18 @@
+#!/bin/sh
+#
+#  run_benchmark_apply_chain.sh
+#
+
+set -e
+
+BENCHMARK_NAME=apply_chain
+
+. @CMAKE_BINARY_DIR@/benchmarks/setup.sh
+
+CMD=$OB_DIR/osmium_benchmark_$BENCHMARK_NAME
+
+NUM_OBJECTS=${NUM_OBJECTS:-2000000}
+
+for n in $OB_SEQ; do
+    $CMD $NUM_OBJECTS
+done
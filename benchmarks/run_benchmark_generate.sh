@@ -0,0 +1,26 @@
+#!/bin/sh
+#
+#  run_benchmark_generate.sh
+#
+#  Unlike the other benchmarks this one doesn't read the files in
+#  DATA_DIR, it generates a synthetic file there (which the other
+#  benchmarks then pick up). Generation itself is timed, it exercises
+#  the builders and the writer.
+#
+
+set -e
+
+BENCHMARK_NAME=generate
+
+. @CMAKE_BINARY_DIR@/benchmarks/setup.sh
+
+CMD=$OB_DIR/osmium_benchmark_$BENCHMARK_NAME
+
+NUM_NODES=${OB_GENERATE_NODES:-10000000}
+SEED=${OB_GENERATE_SEED:-4711}
+OUTPUT=$DATA_DIR/0_synthetic_$SEED.osm.pbf
+
+echo "# num_nodes seed num mem time cpu_kernel cpu_user cpu_percent cmd options"
+for n in $OB_SEQ; do
+    $OB_TIME_CMD -f "$NUM_NODES $SEED $n $OB_TIME_FORMAT" $CMD $OUTPUT $NUM_NODES $SEED 2>&1 >/dev/null | sed -e "s%$DATA_DIR/%%" | sed -e "s%$OB_DIR/%%"
+done
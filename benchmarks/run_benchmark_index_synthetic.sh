@@ -0,0 +1,23 @@
+#!/bin/sh
+#
+#  run_benchmark_index_synthetic.sh
+#
+
+set -e
+
+BENCHMARK_NAME=index_synthetic
+
+. @CMAKE_BINARY_DIR@/benchmarks/setup.sh
+
+CMD=$OB_DIR/osmium_benchmark_$BENCHMARK_NAME
+
+INDEXES="sparse_mem_map sparse_mem_array dense_mem_array flex_mem multimap_sparse_mem_array multimap_sparse_mem_multimap multimap_hybrid"
+
+NUM_IDS=${NUM_IDS:-10000000}
+
+echo "# index num mem time cpu_kernel cpu_user cpu_percent cmd options"
+for index in $INDEXES; do
+    for n in $OB_SEQ; do
+        $OB_TIME_CMD -f "$index $NUM_IDS $n $OB_TIME_FORMAT" $CMD $index $NUM_IDS 2>&1 | sed -e "s%$OB_DIR/%%"
+    done
+done
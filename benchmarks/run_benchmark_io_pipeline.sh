@@ -0,0 +1,25 @@
+#!/bin/sh
+#
+#  run_benchmark_io_pipeline.sh
+#
+#  Will convert each input file to PBF format written to /dev/null and
+#  print a breakdown of where the time in the read -> handle -> write
+#  pipeline went, including the queue counters of the reader and writer.
+#
+
+set -e
+
+BENCHMARK_NAME=io_pipeline
+
+. @CMAKE_BINARY_DIR@/benchmarks/setup.sh
+
+CMD=$OB_DIR/osmium_benchmark_$BENCHMARK_NAME
+
+for data in $OB_DATA_FILES; do
+    filename=`basename $data`
+    filesize=`stat --format="%s" --dereference $data`
+    for n in $OB_SEQ; do
+        echo "# $filename $filesize $n"
+        $CMD $data /dev/null "" pbf | sed -e "s%$DATA_DIR/%%" | sed -e "s%$OB_DIR/%%"
+    done
+done
@@ -0,0 +1,19 @@
+#!/bin/sh
+#
+#  run_benchmark_micro.sh
+#
+#  Runs the microbenchmarks for the core primitives. No input files
+#  are needed, each benchmark runs a fixed number of iterations and
+#  reports the best of several runs in ns per operation.
+#
+
+set -e
+
+BENCHMARK_NAME=micro
+
+. @CMAKE_BINARY_DIR@/benchmarks/setup.sh
+
+CMD=$OB_DIR/osmium_benchmark_$BENCHMARK_NAME
+
+echo "# benchmark iterations ns/op"
+$CMD
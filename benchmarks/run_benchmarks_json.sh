@@ -0,0 +1,55 @@
+#!/bin/sh
+#
+#  run_benchmarks_json.sh [RESULTS-FILE]
+#
+#  Runs the single-input-file benchmarks on every file in DATA_DIR and
+#  writes one JSON object per run: benchmark name, dataset, wall and
+#  cpu time, peak RSS, and throughput in input bytes per wall second.
+#  Results go to RESULTS-FILE (default: benchmark_results.json).
+#
+#  Use compare_benchmarks.sh to diff two result files and flag
+#  regressions, for instance before and after a library upgrade.
+#
+
+set -e
+
+BENCHMARK_NAME=all_json
+
+. @CMAKE_BINARY_DIR@/benchmarks/setup.sh
+
+RESULTS_FILE=${1:-benchmark_results.json}
+
+# The benchmarks that read a single OSM file. The other benchmarks
+# use synthetic data or need extra arguments and have their own run
+# scripts.
+JSON_BENCHMARKS="count count_tag filters geom_factories mercator"
+
+TMP_TIME=`mktemp`
+trap 'rm -f $TMP_TIME' EXIT
+
+: > $RESULTS_FILE
+
+for name in $JSON_BENCHMARKS; do
+    CMD=$OB_DIR/osmium_benchmark_$name
+    if [ ! -x $CMD ]; then
+        continue
+    fi
+    for data in $OB_DATA_FILES; do
+        filename=`basename $data`
+        filesize=`stat --format="%s" --dereference $data`
+        for n in $OB_SEQ; do
+            # %e wall clock in s, %S/%U cpu in s, %M peak RSS in kB
+            $OB_TIME_CMD -f "%e %S %U %M" -o $TMP_TIME $CMD $data >/dev/null 2>&1
+            read wall cpu_kernel cpu_user rss_kb < $TMP_TIME
+            awk -v name="$name" -v dataset="$filename" -v size="$filesize" \
+                -v run="$n" -v wall="$wall" -v ck="$cpu_kernel" -v cu="$cpu_user" -v rss="$rss_kb" \
+                'BEGIN {
+                    tp = (wall > 0) ? size / wall : 0;
+                    printf "{\"benchmark\":\"%s\",\"dataset\":\"%s\",\"input_bytes\":%d,\"run\":%d,\"wall_s\":%.3f,\"cpu_kernel_s\":%.3f,\"cpu_user_s\":%.3f,\"peak_rss_kb\":%d,\"throughput_bytes_per_s\":%.0f}\n",
+                        name, dataset, size, run, wall, ck, cu, rss, tp;
+                }' >> $RESULTS_FILE
+        done
+    done
+done
+
+echo "Results written to $RESULTS_FILE"
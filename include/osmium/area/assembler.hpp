@@ -70,6 +70,9 @@ namespace osmium {
                 }
                 if (area_okay) {
                     add_rings_to_area(builder);
+                    if (config().create_ring_directory) {
+                        add_ring_directory_to_area(builder);
+                    }
                 }
 
                 if (report_ways()) {
@@ -94,6 +97,9 @@ namespace osmium {
                 }
                 if (area_okay) {
                     add_rings_to_area(builder);
+                    if (config().create_ring_directory) {
+                        add_ring_directory_to_area(builder);
+                    }
                 }
 
                 if (report_ways()) {
@@ -111,6 +117,18 @@ namespace osmium {
                 detail::BasicAssemblerWithTags(config) {
             }
 
+            /**
+             * Can the given relation ever produce an area with this
+             * configuration? The MultipolygonManager uses this to avoid
+             * tracking and stashing the members of relations that can
+             * never result in an area.
+             */
+            static bool relation_can_produce_area(const osmium::Relation& /*relation*/, const config_type& config) noexcept {
+                // This assembler only builds areas with the tags from the
+                // relation (new-style multipolygons).
+                return config.create_new_style_polygons;
+            }
+
             /**
              * Assemble an area from the given way.
              * The resulting area is put into the out_buffer.
@@ -105,6 +105,16 @@ namespace osmium {
              */
             bool create_way_polygons = true;
 
+            /**
+             * Add a RingDirectory item to every assembled area storing
+             * the offset, the number of nodes, and the precomputed
+             * envelope of every ring, plus the envelope of the whole
+             * area. With the directory ring access on the finished area
+             * is O(1) and envelope() calls don't have to visit the
+             * nodes, at the cost of a few extra bytes per ring.
+             */
+            bool create_ring_directory = false;
+
             /**
              * Keep the type tag from multipolygon relations on the area
              * object. By default this is false, and the type tag will be
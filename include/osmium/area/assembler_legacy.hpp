@@ -170,6 +170,9 @@ namespace osmium {
                 }
                 if (area_okay) {
                     add_rings_to_area(builder);
+                    if (config().create_ring_directory) {
+                        add_ring_directory_to_area(builder);
+                    }
                 }
 
                 if (report_ways()) {
@@ -190,6 +193,9 @@ namespace osmium {
                 }
                 if (area_okay) {
                     add_rings_to_area(builder);
+                    if (config().create_ring_directory) {
+                        add_ring_directory_to_area(builder);
+                    }
                 }
 
                 if (report_ways()) {
@@ -207,6 +213,22 @@ namespace osmium {
                 detail::BasicAssemblerWithTags(config) {
             }
 
+            /**
+             * Can the given relation ever produce an area with this
+             * configuration? The MultipolygonManagerLegacy uses this to
+             * avoid tracking and stashing the members of relations that
+             * can never result in an area.
+             */
+            static bool relation_can_produce_area(const osmium::Relation& relation, const config_type& config) {
+                // Relations with interesting tags are new-style
+                // multipolygons, relations without them get their tags
+                // from the outer ways (old-style multipolygons). Uses
+                // the same filter add_tags_to_area() uses later.
+                const auto count = std::count_if(relation.tags().cbegin(), relation.tags().cend(), std::cref(filter()));
+                return count > 0 ? config.create_new_style_polygons
+                                 : config.create_old_style_polygons;
+            }
+
             /**
              * Assemble an area from the given way.
              * The resulting area is put into the out_buffer.
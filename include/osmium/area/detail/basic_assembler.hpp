@@ -40,7 +40,12 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/area/problem_reporter.hpp>
 #include <osmium/area/stats.hpp>
 #include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/scratch_arena.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/item_type.hpp>
 #include <osmium/osm/location.hpp>
+#include <osmium/osm/node_ref_list.hpp>
 #include <osmium/osm/node_ref.hpp>
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/way.hpp>
@@ -51,6 +56,7 @@ DEALINGS IN THE SOFTWARE.
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <list>
@@ -65,7 +71,11 @@ namespace osmium {
 
         namespace detail {
 
-            using open_ring_its_type = std::list<std::list<ProtoRing>::iterator>;
+            // The scratch data structures of the assembler draw their
+            // memory from a per-assembler arena, see BasicAssembler.
+            using ring_list_type = std::list<ProtoRing, osmium::memory::arena_allocator<ProtoRing>>;
+
+            using open_ring_its_type = std::list<ring_list_type::iterator, osmium::memory::arena_allocator<ring_list_type::iterator>>;
 
             struct location_to_ring_map {
                 osmium::Location location;
@@ -144,17 +154,24 @@ namespace osmium {
                 // Configuration settings for this Assembler
                 const AssemblerConfig& m_config;
 
+                // All short-lived scratch structures built up while
+                // assembling an area allocate from this arena instead of
+                // doing many small allocations from the system. The arena
+                // releases all of it together when the assembler is
+                // destroyed.
+                osmium::memory::ScratchArena m_arena{};
+
                 // List of segments (connection between two nodes)
                 SegmentList m_segment_list;
 
                 // The rings we are building from the segments
-                std::list<ProtoRing> m_rings;
+                ring_list_type m_rings;
 
                 // All node locations
-                std::vector<slocation> m_locations;
+                std::vector<slocation, osmium::memory::arena_allocator<slocation>> m_locations;
 
                 // All locations where more than two segments start/end
-                std::vector<Location> m_split_locations;
+                std::vector<Location, osmium::memory::arena_allocator<Location>> m_split_locations;
 
                 // Statistics
                 area_stats m_stats;
@@ -269,7 +286,7 @@ namespace osmium {
 
                 }; // class rings_stack_element
 
-                using rings_stack = std::vector<rings_stack_element>;
+                using rings_stack = std::vector<rings_stack_element, osmium::memory::arena_allocator<rings_stack_element>>;
 
                 void remove_duplicates(rings_stack& outer_rings) {
                     while (true) {
@@ -298,7 +315,7 @@ namespace osmium {
 
                     int nesting = 0;
 
-                    rings_stack outer_rings;
+                    rings_stack outer_rings{rings_stack::allocator_type{m_arena}};
                     while (segment >= &m_segment_list.front()) {
                         if (!segment->is_direction_done()) {
                             --segment;
@@ -604,8 +621,10 @@ namespace osmium {
                     }
                 }
 
-                std::vector<location_to_ring_map> create_location_to_ring_map(open_ring_its_type& open_ring_its) {
-                    std::vector<location_to_ring_map> xrings;
+                using xrings_type = std::vector<location_to_ring_map, osmium::memory::arena_allocator<location_to_ring_map>>;
+
+                xrings_type create_location_to_ring_map(open_ring_its_type& open_ring_its) {
+                    xrings_type xrings{xrings_type::allocator_type{m_arena}};
                     xrings.reserve(open_ring_its.size() * 2);
 
                     for (auto it = open_ring_its.begin(); it != open_ring_its.end(); ++it) {
@@ -621,9 +640,9 @@ namespace osmium {
                     return xrings;
                 }
 
-                void merge_two_rings(open_ring_its_type& open_ring_its, const location_to_ring_map& m1, const location_to_ring_map& m2) {
-                    const auto r1 = *m1.ring_it;
-                    const auto r2 = *m2.ring_it;
+                void merge_two_rings(open_ring_its_type& open_ring_its, open_ring_its_type::iterator r1_it, open_ring_its_type::iterator r2_it) {
+                    const auto r1 = *r1_it;
+                    const auto r2 = *r2_it;
 
                     if (r1->get_node_ref_stop().location() == r2->get_node_ref_start().location()) {
                         r1->join_forward(*r2);
@@ -639,45 +658,103 @@ namespace osmium {
                         assert(false);
                     }
 
-                    open_ring_its.erase(std::find(open_ring_its.begin(), open_ring_its.end(), r2));
+                    open_ring_its.erase(r2_it);
                     m_rings.erase(r2);
 
                     if (r1->closed()) {
-                        open_ring_its.erase(std::find(open_ring_its.begin(), open_ring_its.end(), r1));
+                        open_ring_its.erase(r1_it);
                     }
                 }
 
-                bool try_to_merge(open_ring_its_type& open_ring_its) {
-                    if (open_ring_its.empty()) {
-                        return false;
-                    }
+                void merge_two_rings(open_ring_its_type& open_ring_its, const location_to_ring_map& m1, const location_to_ring_map& m2) {
+                    merge_two_rings(open_ring_its, m1.ring_it, m2.ring_it);
+                }
 
+                // Hash table mapping locations to the ends of all open
+                // rings at that location. The inner vectors almost always
+                // contain two entries.
+                using open_ring_ends_type = std::vector<open_ring_its_type::iterator>;
+                using endpoint_map_type = std::unordered_map<osmium::Location, open_ring_ends_type,
+                                                             std::hash<osmium::Location>,
+                                                             std::equal_to<osmium::Location>,
+                                                             osmium::memory::arena_allocator<std::pair<const osmium::Location, open_ring_ends_type>>>;
+
+                /**
+                 * Merge open rings as long as there is any location where
+                 * exactly two open ring ends meet. Those joins are
+                 * unambiguous. A hash table from endpoint locations to
+                 * the open ring ends there makes every join O(1) instead
+                 * of rescanning all open rings after each merge, which
+                 * showed quadratic behaviour on relations with tens of
+                 * thousands of ways.
+                 */
+                void merge_rings_at_unambiguous_locations(open_ring_its_type& open_ring_its) {
                     if (debug()) {
-                        std::cerr << "    Trying to merge " << open_ring_its.size() << " open rings (try_to_merge)\n";
+                        std::cerr << "    Trying to merge " << open_ring_its.size() << " open rings (merge_rings_at_unambiguous_locations)\n";
                     }
 
-                    std::vector<location_to_ring_map> xrings = create_location_to_ring_map(open_ring_its);
+                    endpoint_map_type endpoints{open_ring_its.size() * 2,
+                                                std::hash<osmium::Location>{},
+                                                std::equal_to<osmium::Location>{},
+                                                endpoint_map_type::allocator_type{m_arena}};
 
-                    auto it = xrings.cbegin();
-                    while (it != xrings.cend()) {
-                        it = std::adjacent_find(it, xrings.cend());
-                        if (it == xrings.cend()) {
-                            return false;
+                    for (auto it = open_ring_its.begin(); it != open_ring_its.end(); ++it) {
+                        endpoints[(*it)->get_node_ref_start().location()].push_back(it);
+                        endpoints[(*it)->get_node_ref_stop().location()].push_back(it);
+                    }
+
+                    // Locations that (still) need to be checked. Entries
+                    // can appear multiple times, the current state is in
+                    // the hash table.
+                    std::vector<osmium::Location, osmium::memory::arena_allocator<osmium::Location>> todo{osmium::memory::arena_allocator<osmium::Location>{m_arena}};
+                    todo.reserve(endpoints.size());
+                    for (const auto& entry : endpoints) {
+                        todo.push_back(entry.first);
+                    }
+
+                    while (!todo.empty()) {
+                        const osmium::Location location = todo.back();
+                        todo.pop_back();
+
+                        const auto eit = endpoints.find(location);
+                        if (eit == endpoints.end() || eit->second.size() != 2) {
+                            continue;
                         }
-                        auto after = std::next(it, 2);
-                        if (after == xrings.cend() || after->location != it->location) {
-                            if (debug()) {
-                                std::cerr << "      Merging two rings\n";
-                            }
-                            merge_two_rings(open_ring_its, *it, *std::next(it));
-                            return true;
+
+                        const auto r1_it = eit->second[0];
+                        const auto r2_it = eit->second[1];
+                        const auto r1 = *r1_it;
+                        const auto r2 = *r2_it;
+                        assert(r1 != r2);
+
+                        // The endpoints of the two rings away from this
+                        // location. They belong to the combined ring after
+                        // the merge.
+                        const osmium::Location other1 = r1->get_node_ref_start().location() == location ? r1->get_node_ref_stop().location() : r1->get_node_ref_start().location();
+                        const osmium::Location other2 = r2->get_node_ref_start().location() == location ? r2->get_node_ref_stop().location() : r2->get_node_ref_start().location();
+
+                        if (debug()) {
+                            std::cerr << "      Merging two rings at " << location << '\n';
                         }
-                        while (it != xrings.cend() && it->location == after->location) {
-                            ++it;
+                        merge_two_rings(open_ring_its, r1_it, r2_it);
+                        endpoints.erase(eit);
+
+                        if (other1 == other2) {
+                            // The combined ring is closed, both its former
+                            // ends disappear from the other location which
+                            // may have become unambiguous now.
+                            auto& ends = endpoints[other1];
+                            ends.erase(std::find(ends.begin(), ends.end(), r1_it));
+                            ends.erase(std::find(ends.begin(), ends.end(), r2_it));
+                            todo.push_back(other1);
+                        } else {
+                            // The end of the second ring now belongs to the
+                            // combined first ring. The number of ends at the
+                            // other locations is unchanged.
+                            auto& ends = endpoints[other2];
+                            *std::find(ends.begin(), ends.end(), r2_it) = r1_it;
                         }
                     }
-
-                    return false;
                 }
 
                 bool there_are_open_rings() const noexcept {
@@ -705,7 +782,7 @@ namespace osmium {
 
                 };
 
-                void find_candidates(std::vector<candidate>& candidates, std::unordered_set<osmium::Location>& loc_done, const std::vector<location_to_ring_map>& xrings, candidate& cand) {
+                void find_candidates(std::vector<candidate>& candidates, std::unordered_set<osmium::Location>& loc_done, const xrings_type& xrings, candidate& cand) {
                     if (debug()) {
                         std::cerr << "      find_candidates sum=" << cand.sum << " start=" << cand.start_location << " stop=" << cand.stop_location << "\n";
                         for (const auto& ring : cand.rings) {
@@ -776,7 +853,7 @@ namespace osmium {
                         std::cerr << "    Trying to merge " << open_ring_its.size() << " open rings (join_connected_rings)\n";
                     }
 
-                    std::vector<location_to_ring_map> xrings = create_location_to_ring_map(open_ring_its);
+                    xrings_type xrings = create_location_to_ring_map(open_ring_its);
 
                     const auto ring_min = std::min_element(xrings.begin(), xrings.end(), [](const location_to_ring_map& lhs, const location_to_ring_map& rhs) {
                         return lhs.ring().min_segment() < rhs.ring().min_segment();
@@ -900,7 +977,7 @@ namespace osmium {
                     if (there_are_open_rings()) {
                         ++m_stats.area_really_complex_case;
 
-                        open_ring_its_type open_ring_its;
+                        open_ring_its_type open_ring_its{open_ring_its_type::allocator_type{m_arena}};
                         for (auto it = m_rings.begin(); it != m_rings.end(); ++it) {
                             if (!it->closed()) {
                                 open_ring_its.push_back(it);
@@ -911,9 +988,7 @@ namespace osmium {
                             if (debug()) {
                                 std::cerr << "  There are " << open_ring_its.size() << " open rings\n";
                             }
-                            while (try_to_merge(open_ring_its)) {
-                                // intentionally left blank
-                            }
+                            merge_rings_at_unambiguous_locations(open_ring_its);
 
                             if (!open_ring_its.empty()) {
                                 if (debug()) {
@@ -951,7 +1026,7 @@ namespace osmium {
 
             protected:
 
-                const std::list<ProtoRing>& rings() const noexcept {
+                const ring_list_type& rings() const noexcept {
                     return m_rings;
                 }
 
@@ -978,6 +1053,43 @@ namespace osmium {
                     }
                 }
 
+                /**
+                 * Append a RingDirectory item describing all the rings
+                 * already in the area to the area in the buffer. Must be
+                 * called after add_rings_to_area().
+                 */
+                static void add_ring_directory_to_area(osmium::builder::AreaBuilder& builder) {
+                    std::vector<osmium::RingDirectory::Entry> entries;
+                    osmium::Box envelope;
+
+                    {
+                        // Only valid until the buffer grows, so all the
+                        // entries are collected before the directory
+                        // builder is created.
+                        const osmium::Area& area = builder.cobject();
+                        for (const auto& item : area) {
+                            if (item.type() == osmium::item_type::outer_ring ||
+                                item.type() == osmium::item_type::inner_ring) {
+                                const auto& ring = static_cast<const osmium::NodeRefList&>(item);
+                                osmium::RingDirectory::Entry entry;
+                                entry.ring_offset = static_cast<uint32_t>(item.data() - area.data());
+                                entry.num_nodes = static_cast<uint32_t>(ring.size());
+                                entry.envelope = ring.envelope();
+                                if (item.type() == osmium::item_type::outer_ring) {
+                                    envelope.extend(entry.envelope);
+                                }
+                                entries.push_back(entry);
+                            }
+                        }
+                    }
+
+                    osmium::builder::RingDirectoryBuilder directory_builder{builder};
+                    directory_builder.set_envelope(envelope);
+                    for (const auto& entry : entries) {
+                        directory_builder.add_entry(entry);
+                    }
+                }
+
                 /**
                  * Create rings from segments.
                  */
@@ -989,6 +1101,7 @@ namespace osmium {
                     osmium::Timer timer_sort;
                     m_segment_list.sort();
                     timer_sort.stop();
+                    m_stats.sort_time_ns += static_cast<uint64_t>(timer_sort.elapsed_nanoseconds());
 
                     // Remove duplicate segments. Removal is in pairs, so if there
                     // are two identical segments, they will both be removed. If
@@ -996,6 +1109,7 @@ namespace osmium {
                     osmium::Timer timer_dupl;
                     m_segment_list.erase_duplicate_segments(m_config.problem_reporter, m_stats.duplicate_segments, m_stats.overlapping_segments);
                     timer_dupl.stop();
+                    m_stats.duplicates_time_ns += static_cast<uint64_t>(timer_dupl.elapsed_nanoseconds());
 
                     // If there are no segments left at this point, this isn't
                     // a valid area.
@@ -1020,6 +1134,7 @@ namespace osmium {
                     osmium::Timer timer_intersection;
                     m_stats.intersections = m_segment_list.find_intersections(m_config.problem_reporter);
                     timer_intersection.stop();
+                    m_stats.intersections_time_ns += static_cast<uint64_t>(timer_intersection.elapsed_nanoseconds());
 
                     if (m_stats.intersections) {
                         return false;
@@ -1032,6 +1147,7 @@ namespace osmium {
                     osmium::Timer timer_locations_list;
                     create_locations_list();
                     timer_locations_list.stop();
+                    m_stats.locations_time_ns += static_cast<uint64_t>(timer_locations_list.elapsed_nanoseconds());
 
                     // Find all locations where more than two segments start or
                     // end. We call those "split" locations. If there are any
@@ -1042,6 +1158,7 @@ namespace osmium {
                         return false;
                     }
                     timer_split.stop();
+                    m_stats.split_time_ns += static_cast<uint64_t>(timer_split.elapsed_nanoseconds());
 
                     // Now report all split locations to the problem reporter.
                     m_stats.touching_rings += m_split_locations.size();
@@ -1079,6 +1196,7 @@ namespace osmium {
                         timer_simple_case.start();
                         create_rings_simple_case();
                         timer_simple_case.stop();
+                        m_stats.ring_building_time_ns += static_cast<uint64_t>(timer_simple_case.elapsed_nanoseconds());
                     } else {
                         if (debug()) {
                             std::cerr << "  Found split locations -> using complex algorithm\n";
@@ -1090,6 +1208,7 @@ namespace osmium {
                             return false;
                         }
                         timer_complex_case.stop();
+                        m_stats.ring_building_time_ns += static_cast<uint64_t>(timer_complex_case.elapsed_nanoseconds());
                     }
 
                     // If the assembler was so configured, now check whether the
@@ -1139,7 +1258,10 @@ namespace osmium {
 
                 explicit BasicAssembler(const config_type& config) :
                     m_config(config),
-                    m_segment_list(config.debug_level > 1) {
+                    m_segment_list(config.debug_level > 1),
+                    m_rings(osmium::memory::arena_allocator<ProtoRing>{m_arena}),
+                    m_locations(osmium::memory::arena_allocator<slocation>{m_arena}),
+                    m_split_locations(osmium::memory::arena_allocator<Location>{m_arena}) {
 #ifdef OSMIUM_WITH_TIMER
                     init_header();
 #endif
@@ -50,6 +50,7 @@ DEALINGS IN THE SOFTWARE.
 #include <iterator>
 #include <numeric>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -212,7 +213,11 @@ namespace osmium {
 
                 /// Sort the list of segments.
                 void sort() {
-                    std::sort(m_segments.begin(), m_segments.end());
+                    if (m_segments.size() < min_segments_for_radix_sort) {
+                        std::sort(m_segments.begin(), m_segments.end());
+                        return;
+                    }
+                    radix_sort();
                 }
 
                 /**
@@ -273,38 +278,63 @@ namespace osmium {
                  * be removed and one will be left.
                  */
                 void erase_duplicate_segments(ProblemReporter* problem_reporter, uint64_t& duplicate_segments, uint64_t& overlapping_segments) {
-                    while (true) {
-                        auto it = std::adjacent_find(m_segments.begin(), m_segments.end());
-                        if (it == m_segments.end()) {
-                            break;
+                    auto out = std::adjacent_find(m_segments.begin(), m_segments.end());
+                    if (out == m_segments.end()) {
+                        return;
+                    }
+
+                    // Compact the list in a single pass over the runs of
+                    // equal segments, removal is always in pairs. This is
+                    // linear in the number of segments, the list is sorted
+                    // so equal segments can't become adjacent when a run
+                    // between them is removed.
+                    auto it = out;
+                    const auto last = m_segments.end();
+                    while (it != last) {
+                        auto run_end = std::next(it);
+                        while (run_end != last && *run_end == *it) {
+                            ++run_end;
                         }
-                        if (m_debug) {
-                            std::cerr << "  erase duplicate segment: " << *it << "\n";
+
+                        if (run_end - it == 1) {
+                            *out++ = *it++;
+                            continue;
                         }
 
-                        // Only count and report duplicate segments if they
-                        // belong to the same way or if they don't both have
-                        // the role "inner". Those cases are definitely wrong.
-                        // If the duplicate segments belong to different
-                        // "inner" ways, they could be touching inner rings
-                        // which are perfectly okay. Note that for this check
-                        // the role has to be correct in the member data.
-                        if (it->way() == std::next(it)->way() || !it->role_inner() || !std::next(it)->role_inner()) {
-                            ++duplicate_segments;
-                            if (problem_reporter) {
-                                problem_reporter->report_duplicate_segment(it->first(), it->second());
+                        for (; run_end - it >= 2; it += 2) {
+                            if (m_debug) {
+                                std::cerr << "  erase duplicate segment: " << *it << "\n";
                             }
-                        }
 
-                        if (it+2 != m_segments.end() && *it == *(it+2)) {
-                            ++overlapping_segments;
-                            if (problem_reporter) {
-                                problem_reporter->report_overlapping_segment(it->first(), it->second());
+                            // Only count and report duplicate segments if they
+                            // belong to the same way or if they don't both have
+                            // the role "inner". Those cases are definitely wrong.
+                            // If the duplicate segments belong to different
+                            // "inner" ways, they could be touching inner rings
+                            // which are perfectly okay. Note that for this check
+                            // the role has to be correct in the member data.
+                            if (it->way() == std::next(it)->way() || !it->role_inner() || !std::next(it)->role_inner()) {
+                                ++duplicate_segments;
+                                if (problem_reporter) {
+                                    problem_reporter->report_duplicate_segment(it->first(), it->second());
+                                }
+                            }
+
+                            if (run_end - it >= 3) {
+                                ++overlapping_segments;
+                                if (problem_reporter) {
+                                    problem_reporter->report_overlapping_segment(it->first(), it->second());
+                                }
                             }
                         }
 
-                        m_segments.erase(it, it+2);
+                        if (it != run_end) {
+                            // odd run length, the last segment remains
+                            *out++ = *it++;
+                        }
                     }
+
+                    m_segments.erase(out, last);
                 }
 
                 /**
@@ -315,6 +345,139 @@ namespace osmium {
                  * @returns true if there are intersections.
                  */
                 uint32_t find_intersections(ProblemReporter* problem_reporter) const {
+                    if (m_segments.size() < min_segments_for_sweep) {
+                        return find_intersections_brute_force(problem_reporter);
+                    }
+                    return find_intersections_sweep(problem_reporter);
+                }
+
+            private:
+
+                enum : std::size_t {
+                    /// Below this many segments the brute force check is used.
+                    min_segments_for_sweep = 100,
+
+                    /// Maximum number of y buckets used by the sweep.
+                    max_sweep_buckets = 4096,
+
+                    /// Below this many segments std::sort is used.
+                    min_segments_for_radix_sort = 1024
+                };
+
+                /**
+                 * The first location of the segment packed into a single
+                 * integer that sorts like the location does, x before y.
+                 */
+                static uint64_t packed_first_location(const NodeRefSegment& segment) noexcept {
+                    // Offset the signed coordinates so that the unsigned
+                    // values keep their order.
+                    const auto x = static_cast<uint32_t>(segment.first().location().x()) ^ 0x80000000u;
+                    const auto y = static_cast<uint32_t>(segment.first().location().y()) ^ 0x80000000u;
+                    return (static_cast<uint64_t>(x) << 32u) | y;
+                }
+
+                struct keyed_index {
+                    uint64_t key;
+                    uint32_t index;
+                };
+
+                /**
+                 * Sort the segments with a radix sort on the packed first
+                 * location. Segments with the same first location are
+                 * ordered by their slope, which a radix sort can't do, so
+                 * the (usually tiny) runs of equal locations are finished
+                 * off with a comparison sort. The result is the same
+                 * ordering std::sort produces, but in linear time.
+                 */
+                void radix_sort() {
+                    enum : uint32_t {
+                        radix_bits = 16u,
+                        num_buckets = 1u << radix_bits,
+                        radix_mask = num_buckets - 1u
+                    };
+
+                    std::vector<keyed_index> keys;
+                    keys.reserve(m_segments.size());
+                    for (uint32_t n = 0; n < m_segments.size(); ++n) {
+                        keys.push_back(keyed_index{packed_first_location(m_segments[n]), n});
+                    }
+
+                    // Four stable counting sort passes over 16-bit digits,
+                    // least significant digit first.
+                    std::vector<keyed_index> scratch(keys.size());
+                    std::vector<uint32_t> offsets(num_buckets);
+                    for (uint32_t shift = 0; shift < 64u; shift += radix_bits) {
+                        std::fill(offsets.begin(), offsets.end(), 0u);
+                        for (const auto& entry : keys) {
+                            ++offsets[(entry.key >> shift) & radix_mask];
+                        }
+                        uint32_t sum = 0;
+                        for (auto& offset : offsets) {
+                            const uint32_t count = offset;
+                            offset = sum;
+                            sum += count;
+                        }
+                        for (const auto& entry : keys) {
+                            scratch[offsets[(entry.key >> shift) & radix_mask]++] = entry;
+                        }
+                        using std::swap;
+                        swap(keys, scratch);
+                    }
+
+                    slist_type sorted;
+                    sorted.reserve(m_segments.size());
+                    for (const auto& entry : keys) {
+                        sorted.push_back(m_segments[entry.index]);
+                    }
+
+                    // Order the runs of segments starting at the same
+                    // location by the full comparison.
+                    std::size_t begin = 0;
+                    while (begin < keys.size()) {
+                        std::size_t end = begin + 1;
+                        while (end < keys.size() && keys[end].key == keys[begin].key) {
+                            ++end;
+                        }
+                        if (end - begin > 1) {
+                            std::sort(sorted.begin() + static_cast<slist_type::difference_type>(begin),
+                                      sorted.begin() + static_cast<slist_type::difference_type>(end));
+                        }
+                        begin = end;
+                    }
+
+                    using std::swap;
+                    swap(m_segments, sorted);
+                }
+
+                /**
+                 * Check a single pair of segments for an intersection and
+                 * report it. The pair is known to overlap in its x and y
+                 * ranges. Returns 1 if there is an intersection, 0
+                 * otherwise.
+                 */
+                uint32_t check_intersection(const NodeRefSegment& s1, const NodeRefSegment& s2, ProblemReporter* problem_reporter) const {
+                    const osmium::Location intersection{calculate_intersection(s1, s2)};
+                    if (!intersection) {
+                        return 0;
+                    }
+                    if (m_debug) {
+                        std::cerr << "  segments " << s1 << " and " << s2 << " intersecting at " << intersection << "\n";
+                    }
+                    if (problem_reporter) {
+                        problem_reporter->report_intersection(s1.way()->id(), s1.first().location(), s1.second().location(),
+                                                              s2.way()->id(), s2.first().location(), s2.second().location(), intersection);
+                    }
+                    return 1;
+                }
+
+                /**
+                 * Check all segment pairs that overlap in their x range.
+                 * Fine for the small segment lists making up the vast
+                 * majority of multipolygons, but degenerates toward O(n^2)
+                 * on large relations where many segments share the same x
+                 * range.
+                 */
+                uint32_t find_intersections_brute_force(ProblemReporter* problem_reporter) const {
                     if (m_segments.empty()) {
                         return 0;
                     }
@@ -333,18 +496,81 @@ namespace osmium {
                             }
 
                             if (y_range_overlap(s1, s2)) {
-                                osmium::Location intersection{calculate_intersection(s1, s2)};
-                                if (intersection) {
-                                    ++found_intersections;
-                                    if (m_debug) {
-                                        std::cerr << "  segments " << s1 << " and " << s2 << " intersecting at " << intersection << "\n";
-                                    }
-                                    if (problem_reporter) {
-                                        problem_reporter->report_intersection(s1.way()->id(), s1.first().location(), s1.second().location(),
-                                                                              s2.way()->id(), s2.first().location(), s2.second().location(), intersection);
-                                    }
+                                found_intersections += check_intersection(s1, s2, problem_reporter);
+                            }
+                        }
+                    }
+
+                    return found_intersections;
+                }
+
+                /// An entry in a y bucket of the sweep.
+                struct sweep_entry {
+                    const NodeRefSegment* segment;
+                    std::size_t first_bucket;
+                };
+
+                /**
+                 * Sweep over the segments from left to right (they are
+                 * sorted by their leftmost point), keeping all segments
+                 * whose x range is still under the sweep line in buckets
+                 * by y coordinate. Each segment is only checked against
+                 * the segments in the buckets its own y range covers, so,
+                 * unlike in the brute force check, segments that overlap
+                 * in x but are far apart in y never meet. This is what
+                 * makes huge coastline and boundary relations tractable.
+                 *
+                 * Checks exactly the pairs overlapping in their x and y
+                 * ranges, so it finds exactly the same intersections as
+                 * the brute force check, possibly in a different order.
+                 */
+                uint32_t find_intersections_sweep(ProblemReporter* problem_reporter) const {
+                    assert(!m_segments.empty());
+
+                    int32_t min_y = m_segments.front().first().location().y();
+                    int32_t max_y = min_y;
+                    for (const NodeRefSegment& segment : m_segments) {
+                        min_y = std::min(min_y, segment.second().location().y());
+                        max_y = std::max(max_y, segment.second().location().y());
+                        min_y = std::min(min_y, segment.first().location().y());
+                        max_y = std::max(max_y, segment.first().location().y());
+                    }
+
+                    const std::size_t num_buckets = std::min(m_segments.size(), static_cast<std::size_t>(max_sweep_buckets));
+                    const int64_t y_range = static_cast<int64_t>(max_y) - static_cast<int64_t>(min_y) + 1;
+                    const int64_t bucket_height = (y_range + static_cast<int64_t>(num_buckets) - 1) / static_cast<int64_t>(num_buckets);
+
+                    std::vector<std::vector<sweep_entry>> buckets(num_buckets);
+
+                    uint32_t found_intersections = 0;
+
+                    for (const NodeRefSegment& segment : m_segments) {
+                        const std::pair<int32_t, int32_t> yr = std::minmax(segment.first().location().y(), segment.second().location().y());
+                        const auto first_bucket = static_cast<std::size_t>((static_cast<int64_t>(yr.first) - min_y) / bucket_height);
+                        const auto last_bucket  = static_cast<std::size_t>((static_cast<int64_t>(yr.second) - min_y) / bucket_height);
+                        const int32_t sweep_x = segment.first().location().x();
+
+                        for (std::size_t n = first_bucket; n <= last_bucket; ++n) {
+                            auto& bucket = buckets[n];
+                            for (std::size_t i = 0; i < bucket.size();) {
+                                const sweep_entry& entry = bucket[i];
+                                if (entry.segment->second().location().x() < sweep_x) {
+                                    // The sweep line has passed this segment,
+                                    // its x range can not overlap any later
+                                    // segment. Remove it from the bucket.
+                                    bucket[i] = bucket.back();
+                                    bucket.pop_back();
+                                    continue;
+                                }
+                                assert(*entry.segment != segment); // erase_duplicate_segments() should have made sure of that
+                                // A pair can share several buckets, only
+                                // check it in the first one.
+                                if (std::max(entry.first_bucket, first_bucket) == n && y_range_overlap(*entry.segment, segment)) {
+                                    found_intersections += check_intersection(*entry.segment, segment, problem_reporter);
                                 }
+                                ++i;
                             }
+                            bucket.push_back(sweep_entry{&segment, first_bucket});
                         }
                     }
 
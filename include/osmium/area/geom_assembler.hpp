@@ -68,6 +68,16 @@ namespace osmium {
                 detail::BasicAssembler(config) {
             }
 
+            /**
+             * Can the given relation ever produce an area with this
+             * configuration? This assembler doesn't take tags or the
+             * config settings for them into account, so the answer is
+             * always yes.
+             */
+            static bool relation_can_produce_area(const osmium::Relation& /*relation*/, const config_type& /*config*/) noexcept {
+                return true;
+            }
+
             /**
              * Assemble an area from the given way.
              *
@@ -34,6 +34,9 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/area/stats.hpp>
+#include <osmium/index/id_set.hpp>
+#include <osmium/index/relations_map.hpp>
+#include <osmium/memory/buffer.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/relation.hpp>
 #include <osmium/osm/tag.hpp>
@@ -45,12 +48,15 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/storage/item_stash.hpp>
 #include <osmium/tags/taglist.hpp>
 #include <osmium/tags/tags_filter.hpp>
+#include <osmium/thread/pool.hpp>
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <mutex>
 #include <vector>
 
 namespace osmium {
@@ -75,13 +81,89 @@ namespace osmium {
         template <typename TAssembler>
         class MultipolygonManager : public osmium::relations::RelationsManager<MultipolygonManager<TAssembler>, false, true, false> {
 
+        public:
+
+            /// How long the assembly of one relation took.
+            struct relation_timing {
+                osmium::object_id_type id;
+                uint64_t nanoseconds;
+            }; // struct relation_timing
+
+        private:
+
+            enum : std::size_t {
+                default_slowest_relations_count = 10
+            };
+
             using assembler_config_type = typename TAssembler::config_type;
             const assembler_config_type m_assembler_config;
 
             area_stats m_stats;
 
+            /**
+             * The slowest relations assembled so far, kept as a min-heap
+             * on the assembly time, so the fastest of them is cheap to
+             * replace.
+             */
+            std::vector<relation_timing> m_slowest_relations;
+
+            std::size_t m_slowest_relations_count = default_slowest_relations_count;
+
+            /// Protects m_stats and m_slowest_relations when assembling
+            /// areas on multiple threads.
+            std::mutex m_stats_mutex;
+
             osmium::TagsFilter m_filter;
 
+            /// In incremental mode these contain the ids of all objects
+            /// that need to be (re)assembled, see enable_incremental_mode().
+            const osmium::index::IdSet<osmium::unsigned_object_id_type>* m_changed_relations = nullptr;
+            const osmium::index::IdSet<osmium::unsigned_object_id_type>* m_changed_ways = nullptr;
+
+            static bool timing_greater(const relation_timing& lhs, const relation_timing& rhs) noexcept {
+                return lhs.nanoseconds > rhs.nanoseconds;
+            }
+
+            /// Must be called with m_stats_mutex held.
+            void record_timing(osmium::object_id_type id, std::chrono::steady_clock::duration duration) {
+                const auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+                if (m_slowest_relations.size() < m_slowest_relations_count) {
+                    m_slowest_relations.push_back(relation_timing{id, ns});
+                    std::push_heap(m_slowest_relations.begin(), m_slowest_relations.end(), timing_greater);
+                } else if (!m_slowest_relations.empty() && ns > m_slowest_relations.front().nanoseconds) {
+                    std::pop_heap(m_slowest_relations.begin(), m_slowest_relations.end(), timing_greater);
+                    m_slowest_relations.back() = relation_timing{id, ns};
+                    std::push_heap(m_slowest_relations.begin(), m_slowest_relations.end(), timing_greater);
+                }
+            }
+
+            /**
+             * Assemble the area from the specified relation and its members
+             * into the specified buffer.
+             */
+            void assemble_relation(const osmium::Relation& relation, osmium::memory::Buffer& buffer) {
+                std::vector<const osmium::Way*> ways;
+                ways.reserve(relation.members().size());
+                for (const auto& member : relation.members()) {
+                    if (member.ref() != 0) {
+                        ways.push_back(this->get_member_way(member.ref()));
+                        assert(ways.back() != nullptr);
+                    }
+                }
+
+                try {
+                    const auto start_time = std::chrono::steady_clock::now();
+                    TAssembler assembler{m_assembler_config};
+                    assembler(relation, ways, buffer);
+                    const auto duration = std::chrono::steady_clock::now() - start_time;
+                    std::lock_guard<std::mutex> lock{m_stats_mutex};
+                    m_stats += assembler.stats();
+                    record_timing(relation.id(), duration);
+                } catch (const osmium::invalid_location&) {
+                    // XXX ignore
+                }
+            }
+
         public:
 
             /**
@@ -106,11 +188,124 @@ namespace osmium {
                 return m_stats;
             }
 
+            /**
+             * Set how many of the slowest relations are remembered for
+             * the slowest_relations() report (default: 10). Set to 0 to
+             * disable the report.
+             *
+             * Call this before the second pass through the data.
+             */
+            void set_slowest_relations_count(std::size_t count) {
+                m_slowest_relations_count = count;
+                m_slowest_relations.reserve(count);
+            }
+
+            /**
+             * The relations that took longest to assemble, slowest
+             * first. Useful for finding pathological relations in the
+             * input data.
+             *
+             * Call this after all relations have been assembled, it is
+             * not synchronized with assembler tasks still running on a
+             * thread pool.
+             */
+            std::vector<relation_timing> slowest_relations() const {
+                std::vector<relation_timing> timings{m_slowest_relations};
+                std::sort(timings.begin(), timings.end(), timing_greater);
+                return timings;
+            }
+
+            /**
+             * Enable parallel assembly of the areas: each completed
+             * relation is assembled as a task on the specified thread
+             * pool into its own output buffer, the buffers are appended
+             * to the output in completion order. Relations assemble
+             * independently of each other, so this parallelizes the
+             * most expensive part of the area building.
+             *
+             * This is a thin wrapper around
+             * RelationsManager::enable_parallel_completion(), see there
+             * for the details. Must not be combined with
+             * set_max_memory().
+             *
+             * Call this before the second pass through the data.
+             *
+             * @param pool The thread pool the assembler tasks are run on.
+             * @param batch_size Number of completed relations collected
+             *        before a batch is dispatched to the pool.
+             */
+            void enable_parallel_assembly(osmium::thread::Pool& pool, std::size_t batch_size) noexcept {
+                this->enable_parallel_completion(pool, batch_size);
+            }
+
+            /// @copydoc enable_parallel_assembly(osmium::thread::Pool&, std::size_t)
+            void enable_parallel_assembly(osmium::thread::Pool& pool) noexcept {
+                this->enable_parallel_completion(pool);
+            }
+
+            /**
+             * Enable incremental mode: Only relations whose ids are in
+             * @p changed_relations and closed ways whose ids are in
+             * @p changed_ways are assembled, everything else in the
+             * input is ignored. Use this after applying a change file
+             * when only a small part of the data changed and most areas
+             * are still valid.
+             *
+             * Note that @p changed_relations must contain not only the
+             * relations that changed themselves, but also the relations
+             * any changed way is a member of. Use the way-member-to-
+             * relation index from the previous run to find them, see
+             * add_way_members_to_stash():
+             *
+             * @code
+             * osmium::index::IdSetDense<osmium::unsigned_object_id_type> changed_relations;
+             * for (const auto way_id : changed_way_ids) {
+             *     index.for_each(way_id, [&](osmium::unsigned_object_id_type relation_id) {
+             *         changed_relations.set(relation_id);
+             *     });
+             * }
+             * manager.enable_incremental_mode(changed_relations, changed_ways);
+             * @endcode
+             *
+             * Call this before the first pass through the data. The id
+             * sets must stay alive while the manager is used.
+             */
+            void enable_incremental_mode(const osmium::index::IdSet<osmium::unsigned_object_id_type>& changed_relations,
+                                         const osmium::index::IdSet<osmium::unsigned_object_id_type>& changed_ways) noexcept {
+                m_changed_relations = &changed_relations;
+                m_changed_ways = &changed_ways;
+            }
+
+            /**
+             * Add a mapping from every way member to the relation it is
+             * a member of to the specified stash, for all relations
+             * tracked by this manager. Call this after the first pass
+             * through the data.
+             *
+             * Build a RelationsMapIndex from the stash and persist it
+             * using RelationsMapIndex::for_each_entry(). On the next
+             * (incremental) run it tells you which relations are
+             * affected by a changed way, see enable_incremental_mode().
+             */
+            void add_way_members_to_stash(osmium::index::RelationsMapStash& stash) {
+                this->relations_database().for_each_relation([&stash](const osmium::relations::RelationHandle& handle) {
+                    for (const auto& member : (*handle).members()) {
+                        if (member.type() == osmium::item_type::way && member.ref() != 0) {
+                            stash.add(member.positive_ref(), (*handle).positive_id());
+                        }
+                    }
+                });
+            }
+
             /**
              * We are interested in all relations tagged with type=multipolygon
              * or type=boundary with at least one way member.
              */
             bool new_relation(const osmium::Relation& relation) const {
+                if (m_changed_relations && !m_changed_relations->get(relation.positive_id())) {
+                    return false;
+                }
+
                 const char* type = relation.tags().get_value_by_key("type");
 
                 // ignore relations without "type" tag
@@ -118,6 +313,12 @@ namespace osmium {
                     return false;
                 }
 
+                // ignore relations the assembler will never turn into an
+                // area anyway, so their members are not tracked
+                if (!TAssembler::relation_can_produce_area(relation, m_assembler_config)) {
+                    return false;
+                }
+
                 if (((!std::strcmp(type, "multipolygon")) || (!std::strcmp(type, "boundary"))) && osmium::tags::match_any_of(relation.tags(), m_filter)) {
                     return std::any_of(relation.members().cbegin(), relation.members().cend(), [](const RelationMember& member) {
                         return member.type() == osmium::item_type::way;
@@ -133,25 +334,24 @@ namespace osmium {
              * assembler.
              */
             void complete_relation(const osmium::Relation& relation) {
-                std::vector<const osmium::Way*> ways;
-                ways.reserve(relation.members().size());
-                for (const auto& member : relation.members()) {
-                    if (member.ref() != 0) {
-                        ways.push_back(this->get_member_way(member.ref()));
-                        assert(ways.back() != nullptr);
-                    }
-                }
+                assemble_relation(relation, this->buffer());
+            }
 
-                try {
-                    TAssembler assembler{m_assembler_config};
-                    assembler(relation, ways, this->buffer());
-                    m_stats += assembler.stats();
-                } catch (const osmium::invalid_location&) {
-                    // XXX ignore
-                }
+            /**
+             * This is called instead of complete_relation() when parallel
+             * completion has been enabled on the manager. It builds the
+             * area into the specified buffer and can be called from
+             * multiple threads concurrently.
+             */
+            void complete_relation_into(const osmium::Relation& relation, osmium::memory::Buffer& buffer) {
+                assemble_relation(relation, buffer);
             }
 
             void after_way(const osmium::Way& way) {
+                if (m_changed_ways && !m_changed_ways->get(way.positive_id())) {
+                    return;
+                }
+
                 // you need at least 4 nodes to make up a polygon
                 if (way.nodes().size() <= 3) {
                     return;
@@ -172,7 +372,12 @@ namespace osmium {
 
                         TAssembler assembler{m_assembler_config};
                         assembler(way, this->buffer());
-                        m_stats += assembler.stats();
+                        {
+                            // Assembler tasks running on a thread pool
+                            // update the stats concurrently.
+                            std::lock_guard<std::mutex> lock{m_stats_mutex};
+                            m_stats += assembler.stats();
+                        }
                         this->possibly_flush();
                     }
                 } catch (const osmium::invalid_location&) {
@@ -114,6 +114,12 @@ namespace osmium {
                     return false;
                 }
 
+                // ignore relations the assembler will never turn into an
+                // area anyway, so their members are not tracked
+                if (!TAssembler::relation_can_produce_area(relation, m_assembler_config)) {
+                    return false;
+                }
+
                 if ((!std::strcmp(type, "multipolygon")) || (!std::strcmp(type, "boundary"))) {
                     return std::any_of(relation.members().cbegin(), relation.members().cend(), [](const RelationMember& member) {
                         return member.type() == osmium::item_type::way;
@@ -72,6 +72,16 @@ namespace osmium {
             uint64_t wrong_role = 0; ///< Member has wrong role (not "outer", "inner", or empty)
             uint64_t invalid_locations = 0; ///< Invalid location found
 
+            // Nanoseconds spent in the different phases of the assembly.
+            // These are only filled in when libosmium was compiled with
+            // OSMIUM_WITH_TIMER defined, otherwise they stay 0.
+            uint64_t sort_time_ns = 0; ///< Time spent sorting the segment list
+            uint64_t duplicates_time_ns = 0; ///< Time spent removing duplicate segments
+            uint64_t intersections_time_ns = 0; ///< Time spent checking for intersections
+            uint64_t locations_time_ns = 0; ///< Time spent building the locations list
+            uint64_t split_time_ns = 0; ///< Time spent finding split locations
+            uint64_t ring_building_time_ns = 0; ///< Time spent building the rings
+
             area_stats& operator+=(const area_stats& other) noexcept {
                 area_really_complex_case += other.area_really_complex_case;
                 area_simple_case += other.area_simple_case;
@@ -96,6 +106,12 @@ namespace osmium {
                 ways_in_multiple_rings += other.ways_in_multiple_rings;
                 wrong_role += other.wrong_role;
                 invalid_locations += invalid_locations;
+                sort_time_ns += other.sort_time_ns;
+                duplicates_time_ns += other.duplicates_time_ns;
+                intersections_time_ns += other.intersections_time_ns;
+                locations_time_ns += other.locations_time_ns;
+                split_time_ns += other.split_time_ns;
+                ring_building_time_ns += other.ring_building_time_ns;
                 return *this;
             }
 
@@ -125,7 +141,13 @@ namespace osmium {
                        << " touching_rings=" << s.touching_rings
                        << " ways_in_multiple_rings=" << s.ways_in_multiple_rings
                        << " wrong_role=" << s.wrong_role
-                       << " invalid_locations=" << s.invalid_locations;
+                       << " invalid_locations=" << s.invalid_locations
+                       << " sort_time_ns=" << s.sort_time_ns
+                       << " duplicates_time_ns=" << s.duplicates_time_ns
+                       << " intersections_time_ns=" << s.intersections_time_ns
+                       << " locations_time_ns=" << s.locations_time_ns
+                       << " split_time_ns=" << s.split_time_ns
+                       << " ring_building_time_ns=" << s.ring_building_time_ns;
         }
 
     } // namespace area
@@ -650,6 +650,170 @@ namespace osmium {
                 builder.set_user(get_user(args...));
             }
 
+            // ==============================================================
+            //
+            // The following functions estimate the size the object built
+            // from an attribute pack will take up in the buffer. The
+            // estimate does not have to be exact: it is only used to size
+            // the buffer once up front, so the growth checks in the
+            // nested builders never hit their slow path while the object
+            // is built. Small overestimates (a sub-item header per
+            // attribute, padding) are fine.
+
+            constexpr inline std::size_t padded_size_estimate(std::size_t size) noexcept {
+                return (size + osmium::memory::align_bytes - 1) & ~(static_cast<std::size_t>(osmium::memory::align_bytes) - 1);
+            }
+
+            inline std::size_t string_length(const char* str) noexcept {
+                return std::strlen(str);
+            }
+
+            inline std::size_t string_length(const std::string& str) noexcept {
+                return str.size();
+            }
+
+            template <typename TIterator>
+            inline std::size_t count_estimate(TIterator first, TIterator last, std::forward_iterator_tag) {
+                return static_cast<std::size_t>(std::distance(first, last));
+            }
+
+            // Single-pass iterators can not be counted in advance without
+            // consuming them, so their content is not part of the
+            // estimate. The builders grow the buffer as usual then.
+            template <typename TIterator>
+            inline constexpr std::size_t count_estimate(TIterator /*first*/, TIterator /*last*/, std::input_iterator_tag) noexcept {
+                return 0;
+            }
+
+            template <typename TIterator>
+            inline std::size_t count_estimate(TIterator first, TIterator last) {
+                return count_estimate(first, last, typename std::iterator_traits<TIterator>::iterator_category{});
+            }
+
+            // Attributes that only set fields on the object itself don't
+            // add anything to the size.
+            template <typename T>
+            inline constexpr std::size_t estimated_size(const T& /*arg*/) noexcept {
+                return 0;
+            }
+
+            inline std::size_t estimated_tag_size(const osmium::Tag& tag) noexcept {
+                return string_length(tag.key()) + string_length(tag.value()) + 2;
+            }
+
+            template <typename TPair>
+            inline std::size_t estimated_tag_size(const TPair& tag) noexcept {
+                return string_length(tag.first) + string_length(tag.second) + 2;
+            }
+
+            inline std::size_t estimated_size(const attr::_tag& tag) noexcept {
+                return sizeof(osmium::TagList) + padded_size_estimate(estimated_tag_size(tag.value));
+            }
+
+            template <typename TIterator>
+            inline std::size_t estimated_tags_size(const attr::detail::tags_from_iterator_pair<TIterator>& tags, std::forward_iterator_tag) {
+                std::size_t content = 0;
+                for (const auto& tag : tags) {
+                    content += estimated_tag_size(tag);
+                }
+                return sizeof(osmium::TagList) + padded_size_estimate(content);
+            }
+
+            template <typename TIterator>
+            inline constexpr std::size_t estimated_tags_size(const attr::detail::tags_from_iterator_pair<TIterator>& /*tags*/, std::input_iterator_tag) noexcept {
+                return 0;
+            }
+
+            template <typename TIterator>
+            inline std::size_t estimated_size(const attr::detail::tags_from_iterator_pair<TIterator>& tags) {
+                return estimated_tags_size(tags, typename std::iterator_traits<TIterator>::iterator_category{});
+            }
+
+            inline constexpr std::size_t estimated_size(const attr::_node& /*node*/) noexcept {
+                return sizeof(osmium::WayNodeList) + sizeof(osmium::NodeRef);
+            }
+
+            template <typename TIterator>
+            inline std::size_t estimated_size(const attr::detail::nodes_from_iterator_pair<TIterator>& nodes) {
+                return sizeof(osmium::WayNodeList) + count_estimate(nodes.begin(), nodes.end()) * sizeof(osmium::NodeRef);
+            }
+
+            inline std::size_t estimated_size(const attr::_member& member) noexcept {
+                return sizeof(osmium::RelationMemberList) + sizeof(osmium::RelationMember) +
+                       padded_size_estimate(string_length(member.value.role()) + 1);
+            }
+
+            template <typename TIterator>
+            inline std::size_t estimated_members_size(const attr::detail::members_from_iterator_pair<TIterator>& members, std::forward_iterator_tag) {
+                std::size_t size = sizeof(osmium::RelationMemberList);
+                for (const auto& member : members) {
+                    size += sizeof(osmium::RelationMember) + padded_size_estimate(string_length(member.role()) + 1);
+                }
+                return size;
+            }
+
+            template <typename TIterator>
+            inline constexpr std::size_t estimated_members_size(const attr::detail::members_from_iterator_pair<TIterator>& /*members*/, std::input_iterator_tag) noexcept {
+                return 0;
+            }
+
+            template <typename TIterator>
+            inline std::size_t estimated_size(const attr::detail::members_from_iterator_pair<TIterator>& members) {
+                return estimated_members_size(members, typename std::iterator_traits<TIterator>::iterator_category{});
+            }
+
+            inline std::size_t estimated_size(const attr::_comment& comment) noexcept {
+                return sizeof(osmium::ChangesetDiscussion) + sizeof(osmium::ChangesetComment) +
+                       padded_size_estimate(string_length(comment.value.user()) + 1) +
+                       padded_size_estimate(string_length(comment.value.text()) + 1);
+            }
+
+            template <typename TIterator>
+            inline std::size_t estimated_comments_size(const attr::detail::comments_from_iterator_pair<TIterator>& comments, std::forward_iterator_tag) {
+                std::size_t size = sizeof(osmium::ChangesetDiscussion);
+                for (const auto& comment : comments) {
+                    size += sizeof(osmium::ChangesetComment) +
+                            padded_size_estimate(string_length(comment.user()) + 1) +
+                            padded_size_estimate(string_length(comment.text()) + 1);
+                }
+                return size;
+            }
+
+            template <typename TIterator>
+            inline constexpr std::size_t estimated_comments_size(const attr::detail::comments_from_iterator_pair<TIterator>& /*comments*/, std::input_iterator_tag) noexcept {
+                return 0;
+            }
+
+            template <typename TIterator>
+            inline std::size_t estimated_size(const attr::detail::comments_from_iterator_pair<TIterator>& comments) {
+                return estimated_comments_size(comments, typename std::iterator_traits<TIterator>::iterator_category{});
+            }
+
+            template <typename TIterator>
+            inline std::size_t estimated_size(const attr::detail::outer_ring_from_iterator_pair<TIterator>& nodes) {
+                return sizeof(osmium::OuterRing) + count_estimate(nodes.begin(), nodes.end()) * sizeof(osmium::NodeRef);
+            }
+
+            template <typename TIterator>
+            inline std::size_t estimated_size(const attr::detail::inner_ring_from_iterator_pair<TIterator>& nodes) {
+                return sizeof(osmium::InnerRing) + count_estimate(nodes.begin(), nodes.end()) * sizeof(osmium::NodeRef);
+            }
+
+            /**
+             * Estimate the total size the entity of type TObject built
+             * from the given attribute pack will take up in the buffer,
+             * including the user name and all sub-items.
+             */
+            template <typename TObject, typename... TArgs>
+            inline std::size_t estimated_entity_size(const TArgs&... args) {
+                std::size_t size = sizeof(TObject) +
+                                   padded_size_estimate(string_length(get_user(args...)) + 1 + osmium::memory::align_bytes);
+                (void)std::initializer_list<int>{
+                    (size += estimated_size(args), 0)...
+                };
+                return size;
+            }
+
             // ==============================================================
 
             struct tags_handler {
@@ -791,6 +955,8 @@ namespace osmium {
             static_assert(sizeof...(args) > 0, "add_node() must have buffer and at least one additional argument");
             static_assert(detail::are_all_handled_by<detail::any_node_handlers, TArgs...>::value, "Attribute not allowed in add_node()");
 
+            buffer.reserve_capacity(detail::estimated_entity_size<osmium::Node>(args...));
+
             {
                 NodeBuilder builder{buffer};
 
@@ -814,6 +980,8 @@ namespace osmium {
             static_assert(sizeof...(args) > 0, "add_way() must have buffer and at least one additional argument");
             static_assert(detail::are_all_handled_by<detail::any_way_handlers, TArgs...>::value, "Attribute not allowed in add_way()");
 
+            buffer.reserve_capacity(detail::estimated_entity_size<osmium::Way>(args...));
+
             {
                 WayBuilder builder{buffer};
 
@@ -838,6 +1006,8 @@ namespace osmium {
             static_assert(sizeof...(args) > 0, "add_relation() must have buffer and at least one additional argument");
             static_assert(detail::are_all_handled_by<detail::any_relation_handlers, TArgs...>::value, "Attribute not allowed in add_relation()");
 
+            buffer.reserve_capacity(detail::estimated_entity_size<osmium::Relation>(args...));
+
             {
                 RelationBuilder builder{buffer};
 
@@ -862,6 +1032,8 @@ namespace osmium {
             static_assert(sizeof...(args) > 0, "add_changeset() must have buffer and at least one additional argument");
             static_assert(detail::are_all_handled_by<detail::any_changeset_handlers, TArgs...>::value, "Attribute not allowed in add_changeset()");
 
+            buffer.reserve_capacity(detail::estimated_entity_size<osmium::Changeset>(args...));
+
             {
                 ChangesetBuilder builder{buffer};
 
@@ -886,6 +1058,8 @@ namespace osmium {
             static_assert(sizeof...(args) > 0, "add_area() must have buffer and at least one additional argument");
             static_assert(detail::are_all_handled_by<detail::any_area_handlers, TArgs...>::value, "Attribute not allowed in add_area()");
 
+            buffer.reserve_capacity(detail::estimated_entity_size<osmium::Area>(args...));
+
             {
                 AreaBuilder builder{buffer};
 
@@ -226,6 +226,41 @@ namespace osmium {
         using OuterRingBuilder   = NodeRefListBuilder<OuterRing>;
         using InnerRingBuilder   = NodeRefListBuilder<InnerRing>;
 
+        class RingDirectoryBuilder : public Builder {
+
+        public:
+
+            explicit RingDirectoryBuilder(osmium::memory::Buffer& buffer, Builder* parent = nullptr) :
+                Builder(buffer, parent, sizeof(RingDirectory)) {
+                new (&item()) RingDirectory{};
+            }
+
+            explicit RingDirectoryBuilder(Builder& parent) :
+                Builder(parent.buffer(), &parent, sizeof(RingDirectory)) {
+                new (&item()) RingDirectory{};
+            }
+
+            RingDirectoryBuilder(const RingDirectoryBuilder&) = delete;
+            RingDirectoryBuilder& operator=(const RingDirectoryBuilder&) = delete;
+
+            RingDirectoryBuilder(RingDirectoryBuilder&&) = delete;
+            RingDirectoryBuilder& operator=(RingDirectoryBuilder&&) = delete;
+
+            ~RingDirectoryBuilder() {
+                add_padding();
+            }
+
+            void set_envelope(const osmium::Box& envelope) noexcept {
+                static_cast<RingDirectory&>(item()).set_envelope(envelope);
+            }
+
+            void add_entry(const RingDirectory::Entry& entry) {
+                new (reserve_space_for<RingDirectory::Entry>()) RingDirectory::Entry{entry};
+                add_size(sizeof(RingDirectory::Entry));
+            }
+
+        }; // class RingDirectoryBuilder
+
         class RelationMemberListBuilder : public Builder {
 
             /**
@@ -412,7 +447,7 @@ namespace osmium {
                 new (&item()) T{};
                 add_size(min_size_for_user);
                 std::fill_n(object().data() + sizeof(T), min_size_for_user, 0);
-                object().set_user_size(1);
+                object().set_subitems_offset(static_cast<string_size_type>(sizeof(T) + min_size_for_user));
             }
 
             /**
@@ -445,8 +480,9 @@ namespace osmium {
              */
             TDerived& set_user(const char* user, const string_size_type length) {
                 const auto size_of_object = sizeof(T) + sizeof(string_size_type);
-                assert(cobject().user_size() == 1 && (size() <= size_of_object + osmium::memory::padded_length(1))
+                assert(cobject().subitems_offset() == sizeof(T) + min_size_for_user && (size() <= size_of_object + osmium::memory::padded_length(1))
                        && "set_user() must be called at most once and before any sub-builders");
+                assert(size_of_object + length + 1 <= std::numeric_limits<string_size_type>::max());
                 const auto available_space = min_size_for_user - sizeof(string_size_type) - 1;
                 if (length > available_space) {
                     const auto space_needed = osmium::memory::padded_length(length - available_space);
@@ -454,7 +490,7 @@ namespace osmium {
                     add_size(static_cast<uint32_t>(space_needed));
                 }
                 std::copy_n(user, length, object().data() + size_of_object);
-                object().set_user_size(length + 1);
+                object().set_subitems_offset(static_cast<string_size_type>(osmium::memory::padded_length(size_of_object + length + 1)));
 
                 return static_cast<TDerived&>(*this);
             }
@@ -0,0 +1,346 @@
+#ifndef OSMIUM_BUILDER_PATCH_HPP
+#define OSMIUM_BUILDER_PATCH_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Copy an object into a buffer while applying small modifications.
+ * Include this file if you want to rewrite objects without manually
+ * rebuilding them through the osmium::builder classes.
+ */
+
+#include <osmium/builder/builder.hpp>
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/tag.hpp>
+#include <osmium/osm/timestamp.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace builder {
+
+        /**
+         * Describes small modifications to an object and can apply them
+         * while copying the object into a buffer. Sub-items the patch
+         * does not touch (node ref lists, untouched member lists, rings
+         * of areas, ...) are copied verbatim with a single memcpy each,
+         * only the affected sub-items are rebuilt:
+         *
+         * @code
+         * osmium::builder::Patch patch;
+         * patch.set_tag("highway", "secondary").set_version(object.version() + 1);
+         * patch.apply(target_buffer, object);
+         * @endcode
+         *
+         * A Patch holds no reference to any object, so one patch can be
+         * applied to many objects.
+         *
+         * @note As with the builder classes, the source object must not
+         *       live in the target buffer, because the buffer can grow
+         *       while the copy is built.
+         */
+        class Patch {
+
+            struct member_addition {
+                osmium::item_type type;
+                osmium::object_id_type ref;
+                std::string role;
+            };
+
+            std::vector<std::pair<std::string, std::string>> m_set_tags{};
+            std::vector<std::string> m_remove_tags{};
+            std::vector<member_addition> m_add_members{};
+
+            std::string m_user{};
+            osmium::Location m_location{};
+            osmium::Timestamp m_timestamp{};
+            osmium::object_id_type m_id = 0;
+            osmium::changeset_id_type m_changeset = 0;
+            osmium::user_id_type m_uid = 0;
+            osmium::object_version_type m_version = 0;
+
+            bool m_clear_tags = false;
+            bool m_has_id = false;
+            bool m_has_version = false;
+            bool m_has_changeset = false;
+            bool m_has_uid = false;
+            bool m_has_timestamp = false;
+            bool m_has_visible = false;
+            bool m_has_user = false;
+            bool m_has_location = false;
+            bool m_visible = true;
+
+            bool touches_tags() const noexcept {
+                return m_clear_tags || !m_set_tags.empty() || !m_remove_tags.empty();
+            }
+
+            bool tag_removed(const char* key) const noexcept {
+                for (const auto& remove_key : m_remove_tags) {
+                    if (!std::strcmp(remove_key.c_str(), key)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            const std::string* tag_replacement(const char* key) const noexcept {
+                for (const auto& tag : m_set_tags) {
+                    if (!std::strcmp(tag.first.c_str(), key)) {
+                        return &tag.second;
+                    }
+                }
+                return nullptr;
+            }
+
+            void build_tags(Builder& parent, const osmium::TagList* tags) const {
+                TagListBuilder builder{parent};
+
+                // Tags kept from the source keep their position, a
+                // replaced value stays where the tag was.
+                if (!m_clear_tags && tags) {
+                    for (const auto& tag : *tags) {
+                        if (tag_removed(tag.key())) {
+                            continue;
+                        }
+                        const std::string* new_value = tag_replacement(tag.key());
+                        builder.add_tag(tag.key(), new_value ? new_value->c_str() : tag.value());
+                    }
+                }
+
+                // Tags not present in the source are appended.
+                for (const auto& tag : m_set_tags) {
+                    if (m_clear_tags || !tags || !tags->has_key(tag.first.c_str())) {
+                        builder.add_tag(tag.first, tag.second);
+                    }
+                }
+            }
+
+            void build_members(Builder& parent, const osmium::RelationMemberList* members) const {
+                RelationMemberListBuilder builder{parent};
+
+                if (members) {
+                    for (const auto& member : *members) {
+                        builder.add_member(member.type(), member.ref(), member.role(),
+                                           member.full_member() ? &member.get_object() : nullptr);
+                    }
+                }
+
+                for (const auto& member : m_add_members) {
+                    builder.add_member(member.type, member.ref, member.role);
+                }
+            }
+
+            void copy_location(osmium::Node& node, const osmium::Node& source) const {
+                node.set_location(m_has_location ? m_location : source.location());
+            }
+
+            template <typename TObject>
+            void copy_location(TObject& /*object*/, const TObject& /*source*/) const noexcept {
+            }
+
+            template <typename TBuilder, typename TObject>
+            std::size_t apply_impl(osmium::memory::Buffer& buffer, const TObject& source) const {
+                {
+                    TBuilder builder{buffer};
+                    auto& object = builder.object();
+
+                    object.set_id(m_has_id ? m_id : source.id());
+                    object.set_version(m_has_version ? m_version : source.version());
+                    object.set_changeset(m_has_changeset ? m_changeset : source.changeset());
+                    object.set_uid(m_has_uid ? m_uid : source.uid());
+                    object.set_timestamp(m_has_timestamp ? m_timestamp : source.timestamp());
+                    object.set_visible(m_has_visible ? m_visible : source.visible());
+                    copy_location(object, source);
+
+                    builder.set_user(m_has_user ? m_user.c_str() : source.user());
+
+                    bool had_tags = false;
+                    bool had_members = false;
+                    for (auto it = source.cbegin(); it != source.cend(); ++it) {
+                        if (it->type() == osmium::item_type::tag_list && touches_tags()) {
+                            had_tags = true;
+                            build_tags(builder, &static_cast<const osmium::TagList&>(*it));
+                        } else if ((it->type() == osmium::item_type::relation_member_list ||
+                                    it->type() == osmium::item_type::relation_member_list_with_full_members) && !m_add_members.empty()) {
+                            had_members = true;
+                            build_members(builder, &static_cast<const osmium::RelationMemberList&>(*it));
+                        } else {
+                            builder.add_item(*it);
+                        }
+                    }
+
+                    if (touches_tags() && !had_tags && !m_set_tags.empty()) {
+                        build_tags(builder, nullptr);
+                    }
+                    if (!m_add_members.empty() && !had_members && source.type() == osmium::item_type::relation) {
+                        build_members(builder, nullptr);
+                    }
+                }
+                return buffer.commit();
+            }
+
+        public:
+
+            Patch() = default;
+
+            /// Add the tag, or replace its value if the key exists.
+            Patch& set_tag(std::string key, std::string value) {
+                m_set_tags.emplace_back(std::move(key), std::move(value));
+                return *this;
+            }
+
+            /// Remove the tag with the given key if it exists.
+            Patch& remove_tag(std::string key) {
+                m_remove_tags.push_back(std::move(key));
+                return *this;
+            }
+
+            /// Remove all tags of the source (set_tag() still applies).
+            Patch& clear_tags() noexcept {
+                m_clear_tags = true;
+                return *this;
+            }
+
+            /// Append a member (relations only).
+            Patch& add_member(const osmium::item_type type, const osmium::object_id_type ref, std::string role) {
+                m_add_members.push_back(member_addition{type, ref, std::move(role)});
+                return *this;
+            }
+
+            Patch& set_id(const osmium::object_id_type id) noexcept {
+                m_id = id;
+                m_has_id = true;
+                return *this;
+            }
+
+            Patch& set_version(const osmium::object_version_type version) noexcept {
+                m_version = version;
+                m_has_version = true;
+                return *this;
+            }
+
+            Patch& set_changeset(const osmium::changeset_id_type changeset) noexcept {
+                m_changeset = changeset;
+                m_has_changeset = true;
+                return *this;
+            }
+
+            Patch& set_uid(const osmium::user_id_type uid) noexcept {
+                m_uid = uid;
+                m_has_uid = true;
+                return *this;
+            }
+
+            Patch& set_timestamp(const osmium::Timestamp timestamp) noexcept {
+                m_timestamp = timestamp;
+                m_has_timestamp = true;
+                return *this;
+            }
+
+            Patch& set_visible(const bool visible) noexcept {
+                m_visible = visible;
+                m_has_visible = true;
+                return *this;
+            }
+
+            Patch& set_user(std::string user) {
+                m_user = std::move(user);
+                m_has_user = true;
+                return *this;
+            }
+
+            /// Set the location (nodes only).
+            Patch& set_location(const osmium::Location location) noexcept {
+                m_location = location;
+                m_has_location = true;
+                return *this;
+            }
+
+            /**
+             * Copy the given object into the buffer with this patch
+             * applied.
+             *
+             * @returns The position in the buffer of the new object.
+             * @throws std::invalid_argument if the item is not a node,
+             *         way, relation, or area.
+             */
+            std::size_t apply(osmium::memory::Buffer& buffer, const osmium::OSMObject& source) const {
+                switch (source.type()) {
+                    case osmium::item_type::node:
+                        return apply_impl<NodeBuilder>(buffer, static_cast<const osmium::Node&>(source));
+                    case osmium::item_type::way:
+                        return apply_impl<WayBuilder>(buffer, static_cast<const osmium::Way&>(source));
+                    case osmium::item_type::relation:
+                        return apply_impl<RelationBuilder>(buffer, static_cast<const osmium::Relation&>(source));
+                    case osmium::item_type::area:
+                        return apply_impl<AreaBuilder>(buffer, static_cast<const osmium::Area&>(source));
+                    default:
+                        throw std::invalid_argument{"can not patch this object type"};
+                }
+            }
+
+        }; // class Patch
+
+        /**
+         * Copy the given object into the buffer with the given patch
+         * applied, see osmium::builder::Patch.
+         *
+         * @returns The position in the buffer of the new object.
+         */
+        inline std::size_t add_patched_object(osmium::memory::Buffer& buffer, const osmium::OSMObject& source, const Patch& patch) {
+            return patch.apply(buffer, source);
+        }
+
+    } // namespace builder
+
+} // namespace osmium
+
+#endif // OSMIUM_BUILDER_PATCH_HPP
@@ -38,6 +38,16 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/diff_object.hpp>
 #include <osmium/osm/item_type.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <cstddef>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -99,6 +109,176 @@ namespace osmium {
         apply_diff(buffer.cbegin(), buffer.cend(), handlers...);
     }
 
+    /**
+     * Apply the diff objects in the buffer to the given handlers in
+     * parallel. Objects with different ids are independent, so the
+     * buffer, which must be sorted by type, id, and version as for
+     * apply_diff(), is partitioned into as many id-aligned pieces as
+     * there are handlers. Objects with the same type and id always end
+     * up in the same piece, so every handler sees complete version
+     * histories for a disjoint set of ids.
+     *
+     * Each handler runs on its own piece as a task in the given thread
+     * pool, so the handlers need no locking; combine their results
+     * after this returns. Exceptions from the handlers are re-thrown
+     * here.
+     */
+    template <typename THandler>
+    inline void apply_diff(const osmium::memory::Buffer& buffer, osmium::thread::Pool& pool, std::vector<THandler>& handlers) {
+        if (handlers.empty()) {
+            return;
+        }
+
+        const auto objects = buffer.select<osmium::OSMObject>();
+        const auto num_objects = static_cast<std::size_t>(std::distance(objects.cbegin(), objects.cend()));
+        const std::size_t objects_per_piece = num_objects / handlers.size() + 1;
+
+        std::vector<std::future<void>> results;
+        results.reserve(handlers.size());
+
+        auto piece_begin = objects.cbegin();
+        for (std::size_t i = 0; piece_begin != objects.cend() && i < handlers.size(); ++i) {
+            auto piece_end = piece_begin;
+            if (i == handlers.size() - 1) {
+                piece_end = objects.cend();
+            } else {
+                osmium::item_type last_type{};
+                osmium::object_id_type last_id = 0;
+                for (std::size_t count = 0; piece_end != objects.cend() && count < objects_per_piece; ++count) {
+                    last_type = piece_end->type();
+                    last_id = piece_end->id();
+                    ++piece_end;
+                }
+                // move the split point to the next id so no version
+                // history is torn apart
+                while (piece_end != objects.cend() && piece_end->type() == last_type && piece_end->id() == last_id) {
+                    ++piece_end;
+                }
+            }
+
+            THandler& handler = handlers[i];
+            results.push_back(pool.submit([piece_begin, piece_end, &handler](){
+                osmium::apply_diff(piece_begin, piece_end, handler);
+            }));
+
+            piece_begin = piece_end;
+        }
+
+        for (auto& result : results) {
+            result.get();
+        }
+    }
+
+    template <typename THandler>
+    inline void apply_diff(osmium::memory::Buffer& buffer, osmium::thread::Pool& pool, std::vector<THandler>& handlers) {
+        apply_diff(static_cast<const osmium::memory::Buffer&>(buffer), pool, handlers);
+    }
+
+    /**
+     * Apply the diff objects read from the given source (usually an
+     * osmium::io::Reader on a full-history file sorted by type, id,
+     * and version) to the given handlers in parallel.
+     *
+     * The stream of buffers coming from the source is cut into
+     * id-aligned chunks: a chunk boundary is only ever placed between
+     * two different ids, version runs crossing buffer boundaries are
+     * carried over into the next chunk. Chunks are handed round-robin
+     * to the handlers, each handler processing its chunks in order as
+     * tasks in the given thread pool. A handler only ever runs in one
+     * thread at a time and sees complete version histories for a
+     * disjoint set of ids, so the handlers need no locking; combine
+     * their results after this returns. Exceptions from the handlers
+     * are re-thrown here.
+     */
+    template <typename TSource, typename THandler>
+    inline void apply_diff(TSource& source, osmium::thread::Pool& pool, std::vector<THandler>& handlers) {
+        using object_iterator = osmium::memory::ItemIterator<const osmium::OSMObject>;
+
+        if (handlers.empty()) {
+            return;
+        }
+
+        // one chain of futures per handler serializes its chunks
+        std::vector<std::shared_future<void>> lanes{handlers.size()};
+        std::size_t next_lane = 0;
+
+        const auto submit_chunk = [&](std::shared_ptr<osmium::memory::Buffer> chunk, object_iterator begin, object_iterator end) {
+            THandler& handler = handlers[next_lane];
+            std::shared_future<void> prev{lanes[next_lane]};
+            lanes[next_lane] = pool.submit([chunk, begin, end, &handler, prev](){
+                if (prev.valid()) {
+                    prev.get();
+                }
+                osmium::apply_diff(begin, end, handler);
+            }).share();
+            next_lane = (next_lane + 1) % handlers.size();
+        };
+
+        constexpr std::size_t initial_carry_size = 1024UL * 64UL;
+
+        // holds the version run crossing the current chunk boundary
+        osmium::memory::Buffer carry{initial_carry_size, osmium::memory::Buffer::auto_grow::yes};
+        bool carry_active = false;
+        osmium::item_type carry_type{};
+        osmium::object_id_type carry_id = 0;
+
+        while (osmium::memory::Buffer buffer = source.read()) {
+            auto chunk = std::make_shared<osmium::memory::Buffer>(std::move(buffer));
+            const auto objects = chunk->select<osmium::OSMObject>();
+            auto it = objects.cbegin();
+
+            if (carry_active) {
+                // move objects continuing the carried version run over
+                // into the carry chunk
+                while (it != objects.cend() && it->type() == carry_type && it->id() == carry_id) {
+                    carry.add_item(*it);
+                    carry.commit();
+                    ++it;
+                }
+                if (it == objects.cend()) {
+                    continue; // whole buffer is one version run, keep carrying
+                }
+
+                auto carry_chunk = std::make_shared<osmium::memory::Buffer>(std::move(carry));
+                carry = osmium::memory::Buffer{initial_carry_size, osmium::memory::Buffer::auto_grow::yes};
+                const auto carried = carry_chunk->select<osmium::OSMObject>();
+                submit_chunk(carry_chunk, carried.cbegin(), carried.cend());
+            }
+
+            // find the start of the trailing version run and carry it
+            // over, it might continue in the next buffer
+            auto tail = it;
+            for (auto fit = it; fit != objects.cend(); ++fit) {
+                if (fit->type() != tail->type() || fit->id() != tail->id()) {
+                    tail = fit;
+                }
+            }
+            carry_active = true;
+            carry_type = tail->type();
+            carry_id = tail->id();
+            for (auto cit = tail; cit != objects.cend(); ++cit) {
+                carry.add_item(*cit);
+                carry.commit();
+            }
+
+            if (it != tail) {
+                submit_chunk(chunk, it, tail);
+            }
+        }
+
+        if (carry_active) {
+            auto carry_chunk = std::make_shared<osmium::memory::Buffer>(std::move(carry));
+            const auto carried = carry_chunk->select<osmium::OSMObject>();
+            submit_chunk(carry_chunk, carried.cbegin(), carried.cend());
+        }
+
+        for (auto& lane : lanes) {
+            if (lane.valid()) {
+                lane.get();
+            }
+        }
+    }
+
 } // namespace osmium
 
 #endif // OSMIUM_DIFF_VISITOR_HPP
@@ -34,18 +34,15 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/handler.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm.hpp>
+#include <osmium/osm/item_type.hpp>
 
 #include <memory>
 #include <utility>
 
 namespace osmium {
 
-    class Node;
-    class Way;
-    class Relation;
-    class Area;
-    class Changeset;
-
     namespace handler {
 
         namespace detail {
@@ -82,6 +79,37 @@ namespace osmium {
                 virtual void flush() {
                 }
 
+                /**
+                 * Handle all objects in the buffer. The default
+                 * implementation goes through the per-object virtual
+                 * functions, derived wrappers override this with a loop
+                 * that crosses the virtual boundary only once per
+                 * buffer. Does not call flush().
+                 */
+                virtual void handle_buffer(const osmium::memory::Buffer& buffer) {
+                    for (const auto& item : buffer) {
+                        switch (item.type()) {
+                            case osmium::item_type::node:
+                                node(static_cast<const osmium::Node&>(item));
+                                break;
+                            case osmium::item_type::way:
+                                way(static_cast<const osmium::Way&>(item));
+                                break;
+                            case osmium::item_type::relation:
+                                relation(static_cast<const osmium::Relation&>(item));
+                                break;
+                            case osmium::item_type::area:
+                                area(static_cast<const osmium::Area&>(item));
+                                break;
+                            case osmium::item_type::changeset:
+                                changeset(static_cast<const osmium::Changeset&>(item));
+                                break;
+                            default:
+                                throw osmium::unknown_type{};
+                        }
+                    }
+                }
+
             }; // class HandlerWrapperBase
 
 
@@ -150,6 +178,33 @@ auto _name_##_dispatch(THandler& handler, const osmium::_type_& object, long) ->
                     flush_dispatch(m_handler, 0);
                 }
 
+                // Only this call is virtual, the per-object dispatch
+                // inside the loop goes directly into the concrete
+                // handler and can be inlined.
+                void handle_buffer(const osmium::memory::Buffer& buffer) final {
+                    for (const auto& item : buffer) {
+                        switch (item.type()) {
+                            case osmium::item_type::node:
+                                node_dispatch(m_handler, static_cast<const osmium::Node&>(item), 0);
+                                break;
+                            case osmium::item_type::way:
+                                way_dispatch(m_handler, static_cast<const osmium::Way&>(item), 0);
+                                break;
+                            case osmium::item_type::relation:
+                                relation_dispatch(m_handler, static_cast<const osmium::Relation&>(item), 0);
+                                break;
+                            case osmium::item_type::area:
+                                area_dispatch(m_handler, static_cast<const osmium::Area&>(item), 0);
+                                break;
+                            case osmium::item_type::changeset:
+                                changeset_dispatch(m_handler, static_cast<const osmium::Changeset&>(item), 0);
+                                break;
+                            default:
+                                throw osmium::unknown_type{};
+                        }
+                    }
+                }
+
             }; // class HandlerWrapper
 
         } // namespace detail
@@ -194,6 +249,17 @@ auto _name_##_dispatch(THandler& handler, const osmium::_type_& object, long) ->
                 m_impl->flush();
             }
 
+            /**
+             * Handle all objects in the buffer with one virtual call
+             * instead of one per object. Use this instead of
+             * osmium::apply() when you have the buffer anyway, the
+             * per-object dispatch then runs devirtualized inside the
+             * concrete handler. Call flush() yourself when done.
+             */
+            void handle_buffer(const osmium::memory::Buffer& buffer) {
+                m_impl->handle_buffer(buffer);
+            }
+
         }; // class DynamicHandler
 
     } // namespace handler
@@ -54,6 +54,11 @@ namespace osmium {
      */
     namespace experimental {
 
+        /**
+         * @deprecated Use osmium::io::AreaReader
+         * (osmium/io/area_reader.hpp) instead, which does the same but
+         * is supported and runs the area assembly on the thread pool.
+         */
         template <typename TLocationHandler>
         class FlexReader {
 
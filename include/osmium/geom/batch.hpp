@@ -0,0 +1,365 @@
+#ifndef OSMIUM_GEOM_BATCH_HPP
+#define OSMIUM_GEOM_BATCH_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Batch execution of geometry kernels over columnar coordinate data.
+ * Include this file if you want to run projections, length or envelope
+ * computations over many objects at once instead of object by object.
+ *
+ * The geometry work is done by a BatchBackend. The built-in
+ * CPUBatchBackend runs simple loops; implementations offloading the
+ * batches to accelerators (CUDA, HIP, SYCL, ...) can live outside of
+ * libosmium by deriving from BatchBackend.
+ */
+
+#include <osmium/geom/coordinates.hpp>
+#include <osmium/geom/haversine.hpp>
+#include <osmium/geom/mercator_projection.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace geom {
+
+        /**
+         * One object in a CoordinateBatch: which object the coordinates
+         * belong to and where they are in the coordinate arrays.
+         */
+        struct batch_entry {
+            osmium::object_id_type id;
+            std::size_t offset;
+            std::size_t count;
+        };
+
+        /**
+         * Coordinates of many objects in columnar form: one array of x
+         * (longitude) and one of y (latitude) values, plus one
+         * batch_entry per object saying which slice of the arrays is
+         * its. This is the exchange format between Buffers and a
+         * BatchBackend.
+         */
+        class CoordinateBatch {
+
+            std::vector<double> m_x{};
+            std::vector<double> m_y{};
+            std::vector<batch_entry> m_entries{};
+
+        public:
+
+            CoordinateBatch() = default;
+
+            /// Add the location of the given node (nothing is added if it has none).
+            void add_node(const osmium::Node& node) {
+                if (!node.location().valid()) {
+                    return;
+                }
+                m_entries.push_back(batch_entry{node.id(), m_x.size(), 1});
+                m_x.push_back(node.location().lon());
+                m_y.push_back(node.location().lat());
+            }
+
+            /**
+             * Add the node locations of the given way. All node refs
+             * must have valid locations, so run this behind a location
+             * handler.
+             *
+             * @throws osmium::invalid_location if a location is not set.
+             */
+            void add_way(const osmium::Way& way) {
+                m_entries.push_back(batch_entry{way.id(), m_x.size(), way.nodes().size()});
+                for (const auto& node_ref : way.nodes()) {
+                    m_x.push_back(node_ref.lon());
+                    m_y.push_back(node_ref.lat());
+                }
+            }
+
+            /// Add all nodes and ways in the given buffer.
+            void add_buffer(const osmium::memory::Buffer& buffer) {
+                for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                    if (object.type() == osmium::item_type::node) {
+                        add_node(static_cast<const osmium::Node&>(object));
+                    } else if (object.type() == osmium::item_type::way) {
+                        add_way(static_cast<const osmium::Way&>(object));
+                    }
+                }
+            }
+
+            /// Number of objects in this batch.
+            std::size_t size() const noexcept {
+                return m_entries.size();
+            }
+
+            bool empty() const noexcept {
+                return m_entries.empty();
+            }
+
+            /// Number of coordinate pairs in this batch.
+            std::size_t coordinates_size() const noexcept {
+                return m_x.size();
+            }
+
+            const std::vector<batch_entry>& entries() const noexcept {
+                return m_entries;
+            }
+
+            const double* x() const noexcept {
+                return m_x.data();
+            }
+
+            const double* y() const noexcept {
+                return m_y.data();
+            }
+
+            /// Writable coordinate arrays for in-place kernels.
+            double* x() noexcept {
+                return m_x.data();
+            }
+
+            double* y() noexcept {
+                return m_y.data();
+            }
+
+            void clear() {
+                m_x.clear();
+                m_y.clear();
+                m_entries.clear();
+            }
+
+        }; // class CoordinateBatch
+
+        /**
+         * Interface for the device (or CPU) code executing geometry
+         * kernels over a CoordinateBatch. Derive from this to offload
+         * the batches to an accelerator; libosmium itself only ships
+         * the CPUBatchBackend.
+         *
+         * Backends may be called from several threads at once and must
+         * not keep per-call state between the virtual functions.
+         */
+        class BatchBackend {
+
+        public:
+
+            BatchBackend() = default;
+
+            BatchBackend(const BatchBackend&) = delete;
+            BatchBackend& operator=(const BatchBackend&) = delete;
+
+            BatchBackend(BatchBackend&&) = delete;
+            BatchBackend& operator=(BatchBackend&&) = delete;
+
+            virtual ~BatchBackend() noexcept = default;
+
+            /**
+             * Project all coordinates in the batch from WGS84 to Web
+             * Mercator in place.
+             */
+            virtual void project_web_mercator(CoordinateBatch& batch) = 0;
+
+            /**
+             * Compute the haversine length of every object in the
+             * (unprojected) batch. Writes one value per batch entry,
+             * in entry order; 0.0 for entries with fewer than two
+             * coordinates.
+             */
+            virtual void haversine_lengths(const CoordinateBatch& batch, double* lengths) = 0;
+
+            /**
+             * Compute the envelope of every object in the batch. Writes
+             * one box per batch entry, in entry order.
+             */
+            virtual void envelopes(const CoordinateBatch& batch, osmium::Box* boxes) = 0;
+
+        }; // class BatchBackend
+
+        /**
+         * Reference BatchBackend running the kernels as plain loops on
+         * the CPU.
+         */
+        class CPUBatchBackend final : public BatchBackend {
+
+        public:
+
+            void project_web_mercator(CoordinateBatch& batch) override {
+                double* x = batch.x();
+                double* y = batch.y();
+                for (std::size_t i = 0; i < batch.coordinates_size(); ++i) {
+                    x[i] = detail::lon_to_x(x[i]);
+                    y[i] = detail::lat_to_y(y[i]);
+                }
+            }
+
+            void haversine_lengths(const CoordinateBatch& batch, double* lengths) override {
+                const double* x = batch.x();
+                const double* y = batch.y();
+                for (const auto& entry : batch.entries()) {
+                    double sum = 0.0;
+                    for (std::size_t i = entry.offset; i + 1 < entry.offset + entry.count; ++i) {
+                        sum += haversine::distance(Coordinates{x[i], y[i]},
+                                                   Coordinates{x[i + 1], y[i + 1]});
+                    }
+                    *lengths++ = sum;
+                }
+            }
+
+            void envelopes(const CoordinateBatch& batch, osmium::Box* boxes) override {
+                const double* x = batch.x();
+                const double* y = batch.y();
+                for (const auto& entry : batch.entries()) {
+                    osmium::Box box;
+                    for (std::size_t i = entry.offset; i < entry.offset + entry.count; ++i) {
+                        box.extend(osmium::Location{x[i], y[i]});
+                    }
+                    *boxes++ = box;
+                }
+            }
+
+        }; // class CPUBatchBackend
+
+        /**
+         * Runs geometry kernels over CoordinateBatches on a backend,
+         * asynchronously on a thread pool. Results come back as futures
+         * of (object id, value) pairs, so they can be matched up with
+         * the objects again whenever they are needed:
+         *
+         * @code
+         * osmium::geom::CoordinateBatch batch;
+         * batch.add_buffer(buffer);
+         *
+         * osmium::geom::BatchEngine engine;
+         * auto lengths = engine.haversine_lengths(std::move(batch));
+         * // ... decode more buffers ...
+         * for (const auto& id_length : lengths.get()) { ... }
+         * @endcode
+         */
+        class BatchEngine {
+
+            std::unique_ptr<BatchBackend> m_own_backend{};
+            BatchBackend* m_backend;
+            osmium::thread::Pool* m_pool;
+
+        public:
+
+            using lengths_type = std::vector<std::pair<osmium::object_id_type, double>>;
+            using envelopes_type = std::vector<std::pair<osmium::object_id_type, osmium::Box>>;
+
+            /// Engine with the built-in CPU backend.
+            explicit BatchEngine(osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) :
+                m_own_backend(new CPUBatchBackend{}),
+                m_backend(m_own_backend.get()),
+                m_pool(&pool) {
+            }
+
+            /// Engine with a user-provided backend which must stay alive while the engine is used.
+            explicit BatchEngine(BatchBackend& backend, osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) :
+                m_backend(&backend),
+                m_pool(&pool) {
+            }
+
+            /**
+             * Project the batch to Web Mercator. The future delivers
+             * the batch back with the coordinate arrays projected.
+             */
+            std::future<CoordinateBatch> project_web_mercator(CoordinateBatch&& batch) {
+                auto shared_batch = std::make_shared<CoordinateBatch>(std::move(batch));
+                BatchBackend* backend = m_backend;
+                return m_pool->submit([shared_batch, backend]() {
+                    backend->project_web_mercator(*shared_batch);
+                    return std::move(*shared_batch);
+                });
+            }
+
+            /**
+             * Compute the haversine length of every object in the
+             * (unprojected) batch. The future delivers one (id, length)
+             * pair per object.
+             */
+            std::future<lengths_type> haversine_lengths(CoordinateBatch&& batch) {
+                auto shared_batch = std::make_shared<CoordinateBatch>(std::move(batch));
+                BatchBackend* backend = m_backend;
+                return m_pool->submit([shared_batch, backend]() {
+                    std::vector<double> lengths(shared_batch->size());
+                    backend->haversine_lengths(*shared_batch, lengths.data());
+                    lengths_type result;
+                    result.reserve(shared_batch->size());
+                    for (std::size_t i = 0; i < shared_batch->size(); ++i) {
+                        result.emplace_back(shared_batch->entries()[i].id, lengths[i]);
+                    }
+                    return result;
+                });
+            }
+
+            /**
+             * Compute the envelope of every object in the batch. The
+             * future delivers one (id, box) pair per object.
+             */
+            std::future<envelopes_type> envelopes(CoordinateBatch&& batch) {
+                auto shared_batch = std::make_shared<CoordinateBatch>(std::move(batch));
+                BatchBackend* backend = m_backend;
+                return m_pool->submit([shared_batch, backend]() {
+                    std::vector<osmium::Box> boxes(shared_batch->size());
+                    backend->envelopes(*shared_batch, boxes.data());
+                    envelopes_type result;
+                    result.reserve(shared_batch->size());
+                    for (std::size_t i = 0; i < shared_batch->size(); ++i) {
+                        result.emplace_back(shared_batch->entries()[i].id, boxes[i]);
+                    }
+                    return result;
+                });
+            }
+
+        }; // class BatchEngine
+
+    } // namespace geom
+
+} // namespace osmium
+
+#endif // OSMIUM_GEOM_BATCH_HPP
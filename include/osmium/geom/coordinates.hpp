@@ -98,9 +98,15 @@ namespace osmium {
              */
             void append_to_string(std::string& s, const char infix, int precision) const {
                 if (valid()) {
-                    osmium::double2string(s, x, precision);
-                    s += infix;
-                    osmium::double2string(s, y, precision);
+                    // Both coordinates and the infix character are
+                    // formatted into one buffer on the stack and appended
+                    // to the string in one go. This is much faster than
+                    // appending them one by one.
+                    char buffer[2 * 20 + 1];
+                    char* b = osmium::double2string(buffer, x, precision);
+                    *b++ = infix;
+                    b = osmium::double2string(b, y, precision);
+                    s.append(buffer, b);
                 } else {
                     s.append("invalid");
                 }
@@ -48,7 +48,9 @@ DEALINGS IN THE SOFTWARE.
 #include <cstddef>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -141,6 +143,31 @@ namespace osmium {
 
         }; // class IdentityProjection
 
+        namespace detail {
+
+            /**
+             * Detect whether the projection class has a function for
+             * transforming an array of coordinates in place. The geometry
+             * factory will use it to project all coordinates of a
+             * linestring in one call if there is one.
+             */
+            template <typename TProjection>
+            class has_batch_transform {
+
+                template <typename T>
+                static auto test(int) -> decltype(std::declval<const T&>().transform(std::declval<Coordinates*>(), std::size_t{}), std::true_type{});
+
+                template <typename T>
+                static std::false_type test(...);
+
+            public:
+
+                using type = decltype(test<TProjection>(0));
+
+            }; // class has_batch_transform
+
+        } // namespace detail
+
         /**
          * Geometry factory.
          */
@@ -160,8 +187,27 @@ namespace osmium {
                 }
             }
 
+            template <typename TIter>
+            void gather_coordinates(TIter it, TIter end) {
+                for (; it != end; ++it) {
+                    m_coordinates.emplace_back(it->location());
+                }
+            }
+
+            template <typename TIter>
+            void gather_coordinates_unique(TIter it, TIter end) {
+                osmium::Location last_location;
+                for (; it != end; ++it) {
+                    if (last_location != it->location()) {
+                        last_location = it->location();
+                        m_coordinates.emplace_back(last_location);
+                    }
+                }
+            }
+
             TProjection m_projection;
             TGeomImpl m_impl;
+            std::vector<Coordinates> m_coordinates;
 
         public:
 
@@ -263,6 +309,12 @@ namespace osmium {
             }
 
             linestring_type create_linestring(const osmium::WayNodeList& wnl, use_nodes un = use_nodes::unique, direction dir = direction::forward) {
+                return create_linestring_impl(typename detail::has_batch_transform<TProjection>::type{}, wnl, un, dir);
+            }
+
+        private:
+
+            linestring_type create_linestring_impl(std::false_type /*has_batch_transform*/, const osmium::WayNodeList& wnl, use_nodes un, direction dir) {
                 linestring_start();
                 size_t num_points = 0;
 
@@ -293,6 +345,49 @@ namespace osmium {
                 return linestring_finish(num_points);
             }
 
+            // Used when the projection can transform an array of
+            // coordinates in place: gather the raw lon/lat coordinates of
+            // all nodes first, project them all in one call into the
+            // projection, then hand them to the geometry implementation.
+            linestring_type create_linestring_impl(std::true_type /*has_batch_transform*/, const osmium::WayNodeList& wnl, use_nodes un, direction dir) {
+                m_coordinates.clear();
+
+                if (un == use_nodes::unique) {
+                    switch (dir) {
+                        case direction::forward:
+                            gather_coordinates_unique(wnl.cbegin(), wnl.cend());
+                            break;
+                        case direction::backward:
+                            gather_coordinates_unique(wnl.crbegin(), wnl.crend());
+                            break;
+                    }
+                } else {
+                    switch (dir) {
+                        case direction::forward:
+                            gather_coordinates(wnl.cbegin(), wnl.cend());
+                            break;
+                        case direction::backward:
+                            gather_coordinates(wnl.crbegin(), wnl.crend());
+                            break;
+                    }
+                }
+
+                if (m_coordinates.size() < 2) {
+                    throw osmium::geometry_error{"need at least two points for linestring"};
+                }
+
+                m_projection.transform(m_coordinates.data(), m_coordinates.size());
+
+                linestring_start();
+                for (const auto& c : m_coordinates) {
+                    m_impl.linestring_add_location(c);
+                }
+
+                return linestring_finish(m_coordinates.size());
+            }
+
+        public:
+
             linestring_type create_linestring(const osmium::Way& way, use_nodes un = use_nodes::unique, direction dir = direction::forward) {
                 try {
                     return create_linestring(way.nodes(), un, dir);
@@ -105,10 +105,25 @@ namespace osmium {
                 std::unique_ptr<geos::geom::GeometryFactory> m_our_geos_factory;
                 geos::geom::GeometryFactory* m_geos_factory;
 
-                std::unique_ptr<geos::geom::CoordinateSequence> m_coordinate_sequence;
+                std::vector<geos::geom::Coordinate> m_coordinates;
                 std::vector<std::unique_ptr<geos::geom::LinearRing>> m_rings;
                 std::vector<std::unique_ptr<geos::geom::Polygon>> m_polygons;
 
+                // Construct the coordinate sequence for a complete ring or
+                // linestring in one call from the collected coordinates.
+                // This is much faster than adding the points to the
+                // sequence one at a time through the virtual add()
+                // interface.
+                geos::geom::CoordinateSequence* build_coordinate_sequence() {
+                    std::unique_ptr<std::vector<geos::geom::Coordinate>> coordinates{new std::vector<geos::geom::Coordinate>{}};
+
+                    using std::swap;
+                    swap(*coordinates, m_coordinates);
+
+                    // takes ownership of the vector
+                    return m_geos_factory->getCoordinateSequenceFactory()->create(coordinates.release(), 2);
+                }
+
             public:
 
                 using point_type        = std::unique_ptr<geos::geom::Point>;
@@ -152,24 +167,16 @@ namespace osmium {
                 /* LineString */
 
                 void linestring_start() {
-                    try {
-                        m_coordinate_sequence.reset(m_geos_factory->getCoordinateSequenceFactory()->create(static_cast<std::size_t>(0), 2));
-                    } catch (const geos::util::GEOSException& e) {
-                        THROW(osmium::geos_geometry_error(e.what()));
-                    }
+                    m_coordinates.clear();
                 }
 
                 void linestring_add_location(const osmium::geom::Coordinates& xy) {
-                    try {
-                        m_coordinate_sequence->add(geos::geom::Coordinate{xy.x, xy.y});
-                    } catch (const geos::util::GEOSException& e) {
-                        THROW(osmium::geos_geometry_error(e.what()));
-                    }
+                    m_coordinates.emplace_back(xy.x, xy.y);
                 }
 
                 linestring_type linestring_finish(std::size_t /* num_points */) {
                     try {
-                        return linestring_type{m_geos_factory->createLineString(m_coordinate_sequence.release())};
+                        return linestring_type{m_geos_factory->createLineString(build_coordinate_sequence())};
                     } catch (const geos::util::GEOSException& e) {
                         THROW(osmium::geos_geometry_error(e.what()));
                     }
@@ -200,43 +207,31 @@ namespace osmium {
                 }
 
                 void multipolygon_outer_ring_start() {
-                    try {
-                        m_coordinate_sequence.reset(m_geos_factory->getCoordinateSequenceFactory()->create(static_cast<std::size_t>(0), 2));
-                    } catch (const geos::util::GEOSException& e) {
-                        THROW(osmium::geos_geometry_error(e.what()));
-                    }
+                    m_coordinates.clear();
                 }
 
                 void multipolygon_outer_ring_finish() {
                     try {
-                        m_rings.emplace_back(m_geos_factory->createLinearRing(m_coordinate_sequence.release()));
+                        m_rings.emplace_back(m_geos_factory->createLinearRing(build_coordinate_sequence()));
                     } catch (const geos::util::GEOSException& e) {
                         THROW(osmium::geos_geometry_error(e.what()));
                     }
                 }
 
                 void multipolygon_inner_ring_start() {
-                    try {
-                        m_coordinate_sequence.reset(m_geos_factory->getCoordinateSequenceFactory()->create(static_cast<std::size_t>(0), 2));
-                    } catch (const geos::util::GEOSException& e) {
-                        THROW(osmium::geos_geometry_error(e.what()));
-                    }
+                    m_coordinates.clear();
                 }
 
                 void multipolygon_inner_ring_finish() {
                     try {
-                        m_rings.emplace_back(m_geos_factory->createLinearRing(m_coordinate_sequence.release()));
+                        m_rings.emplace_back(m_geos_factory->createLinearRing(build_coordinate_sequence()));
                     } catch (const geos::util::GEOSException& e) {
                         THROW(osmium::geos_geometry_error(e.what()));
                     }
                 }
 
                 void multipolygon_add_location(const osmium::geom::Coordinates& xy) {
-                    try {
-                        m_coordinate_sequence->add(geos::geom::Coordinate{xy.x, xy.y});
-                    } catch (const geos::util::GEOSException& e) {
-                        THROW(osmium::geos_geometry_error(e.what()));
-                    }
+                    m_coordinates.emplace_back(xy.x, xy.y);
                 }
 
                 multipolygon_type multipolygon_finish() {
@@ -39,7 +39,6 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/way.hpp>
 
 #include <cmath>
-#include <iterator>
 
 namespace osmium {
 
@@ -78,15 +77,75 @@ namespace osmium {
             inline double distance(const osmium::WayNodeList& wnl) {
                 double sum_length = 0;
 
-                for (auto it = wnl.begin(); it != wnl.end(); ++it) {
-                    if (std::next(it) != wnl.end()) {
-                        sum_length += distance(it->location(), std::next(it)->location());
-                    }
+                auto it = wnl.begin();
+                if (it == wnl.end()) {
+                    return sum_length;
+                }
+
+                // The cosine of the latitude of each node is needed for
+                // the segment before and after that node. Keeping the
+                // previous coordinates and cosine around halves the number
+                // of trigonometric function calls compared to calling
+                // distance() for every segment.
+                osmium::geom::Coordinates prev{it->location()};
+                double prev_cos = cos(deg_to_rad(prev.y));
+
+                for (++it; it != wnl.end(); ++it) {
+                    const osmium::geom::Coordinates curr{it->location()};
+                    const double curr_cos = cos(deg_to_rad(curr.y));
+
+                    double lonh = sin(deg_to_rad(prev.x - curr.x) * 0.5);
+                    lonh *= lonh;
+                    double lath = sin(deg_to_rad(prev.y - curr.y) * 0.5);
+                    lath *= lath;
+                    sum_length += 2.0 * EARTH_RADIUS_IN_METERS * asin(sqrt(lath + prev_cos * curr_cos * lonh));
+
+                    prev = curr;
+                    prev_cos = curr_cos;
                 }
 
                 return sum_length;
             }
 
+            /**
+             * Calculate the approximate length of the way using the
+             * equirectangular approximation instead of the haversine
+             * formula, which needs only one trigonometric function call
+             * per node.
+             *
+             * The relative error grows with the square of the segment
+             * lengths. For the segment lengths typical in OSM ways (well
+             * below 100 km) it is smaller than about 1e-4, usually much
+             * smaller. Use this if you sum up the lengths of huge numbers
+             * of ways and small errors don't matter, use distance() if you
+             * need the exact great-circle length.
+             */
+            inline double approximate_distance(const osmium::WayNodeList& wnl) {
+                double sum_length = 0;
+
+                auto it = wnl.begin();
+                if (it == wnl.end()) {
+                    return sum_length;
+                }
+
+                osmium::geom::Coordinates prev{it->location()};
+                double prev_cos = cos(deg_to_rad(prev.y));
+
+                for (++it; it != wnl.end(); ++it) {
+                    const osmium::geom::Coordinates curr{it->location()};
+                    const double curr_cos = cos(deg_to_rad(curr.y));
+
+                    const double dx = deg_to_rad(prev.x - curr.x) * ((prev_cos + curr_cos) * 0.5);
+                    const double dy = deg_to_rad(prev.y - curr.y);
+                    sum_length += sqrt(dx * dx + dy * dy);
+
+                    prev = curr;
+                    prev_cos = curr_cos;
+                }
+
+                return sum_length * EARTH_RADIUS_IN_METERS;
+            }
+
         } // namespace haversine
 
     } // namespace geom
@@ -36,9 +36,13 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/geom/coordinates.hpp>
 #include <osmium/geom/util.hpp>
 #include <osmium/osm/location.hpp>
+#include <osmium/osm/node_ref_list.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <string>
+#include <vector>
 
 namespace osmium {
 
@@ -63,14 +67,11 @@ namespace osmium {
             }
 #else
 
-            // This is a much faster implementation than the canonical
-            // implementation using the tan() function. For details
-            // see https://github.com/osmcode/mercator-projection .
-            inline double lat_to_y(double lat) { // not constexpr because math functions aren't
-                if (lat < -78.0 || lat > 78.0) {
-                    return lat_to_y_with_tan(lat);
-                }
-
+            // The polynomial approximation used by lat_to_y() for
+            // latitudes between 78 degrees south and north. This is
+            // branch-free and doesn't call any library functions, so
+            // compilers can vectorize loops over it.
+            inline double lat_to_y_poly(double lat) {
                 return earth_radius_for_epsg3857 *
                     ((((((((((-3.1112583378460085319e-23  * lat +
                                2.0465852743943268009e-19) * lat +
@@ -94,6 +95,17 @@ namespace osmium {
                               -3.4554675198786337842e-4)  * lat +
                               -5.4367203601085991108e-4)  * lat + 1.0);
             }
+
+            // This is a much faster implementation than the canonical
+            // implementation using the tan() function. For details
+            // see https://github.com/osmcode/mercator-projection .
+            inline double lat_to_y(double lat) { // not constexpr because math functions aren't
+                if (lat < -78.0 || lat > 78.0) {
+                    return lat_to_y_with_tan(lat);
+                }
+
+                return lat_to_y_poly(lat);
+            }
 #endif
 
             constexpr inline double x_to_lon(double x) {
@@ -130,6 +142,54 @@ namespace osmium {
             return Coordinates{detail::x_to_lon(c.x), detail::y_to_lat(c.y)};
         }
 
+        /**
+         * Convert a batch of coordinates from WGS84 lon/lat to web
+         * mercator in place. When all latitudes are between 78 degrees
+         * south and north, the loop over the branch-free polynomial
+         * approximation can be vectorized by the compiler, making this
+         * much faster than calling lonlat_to_mercator() for every
+         * coordinate.
+         *
+         * The results are identical to calling lonlat_to_mercator()
+         * for every coordinate.
+         *
+         * @pre All coordinates must be valid.
+         */
+        inline void lonlat_to_mercator(Coordinates* data, std::size_t count) {
+#ifndef OSMIUM_USE_SLOW_MERCATOR_PROJECTION
+            const bool only_low_latitudes = std::all_of(data, data + count, [](const Coordinates& c) {
+                return c.y >= -78.0 && c.y <= 78.0;
+            });
+
+            if (only_low_latitudes) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    data[i].x = detail::lon_to_x(data[i].x);
+                    data[i].y = detail::lat_to_y_poly(data[i].y);
+                }
+                return;
+            }
+#endif
+            for (std::size_t i = 0; i < count; ++i) {
+                data[i] = lonlat_to_mercator(data[i]);
+            }
+        }
+
+        /**
+         * Project the locations of all nodes in the given NodeRefList
+         * from WGS84 lon/lat to web mercator and append the results to
+         * the given vector.
+         *
+         * @pre All locations must be valid.
+         */
+        inline void lonlat_to_mercator(const NodeRefList& nodes, std::vector<Coordinates>& coordinates) {
+            const std::size_t offset = coordinates.size();
+            coordinates.reserve(offset + nodes.size());
+            for (const auto& node_ref : nodes) {
+                coordinates.push_back(Coordinates{node_ref.lon(), node_ref.lat()});
+            }
+            lonlat_to_mercator(coordinates.data() + offset, nodes.size());
+        }
+
         /**
          * Functor that does projection from WGS84 (EPSG:4326) to "Web
          * Mercator" (EPSG:3857)
@@ -149,6 +209,15 @@ namespace osmium {
                 return Coordinates{detail::lon_to_x(location.lon()), detail::lat_to_y(location.lat())};
             }
 
+            /**
+             * Project an array of WGS84 lon/lat coordinates in place. The
+             * geometry factories use this to project all coordinates of a
+             * linestring in one vectorizable loop.
+             */
+            void transform(Coordinates* data, std::size_t count) const {
+                lonlat_to_mercator(data, count);
+            }
+
             int epsg() const noexcept {
                 return 3857;
             }
@@ -0,0 +1,231 @@
+#ifndef OSMIUM_GEOM_PREPARED_AREA_HPP
+#define OSMIUM_GEOM_PREPARED_AREA_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node_ref_list.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace osmium {
+
+    namespace geom {
+
+        /**
+         * A prepared point-in-area lookup structure for an osmium::Area.
+         * Build it once per area and then call contains() as often as you
+         * like.
+         *
+         * All the edges of all rings (outer and inner) are copied out of
+         * the area and bucketed into horizontal latitude bands. A query
+         * first checks the precomputed envelope, then runs a ray cast
+         * over only the edges in the band the point falls into, so the
+         * per-query cost is independent of the total number of edges for
+         * well-behaved polygons. The ray cast uses the even-odd rule with
+         * exact integer arithmetic on the raw coordinates, so no GEOS or
+         * floating point is involved.
+         *
+         * Points exactly on the boundary may be reported as inside or
+         * outside, like with most point-in-polygon implementations.
+         */
+        class PreparedArea {
+
+            struct edge {
+                int32_t x1;
+                int32_t y1;
+                int32_t x2;
+                int32_t y2;
+            }; // struct edge
+
+            enum : std::size_t {
+                max_bands = 256u,
+                min_edges_per_band = 4u
+            };
+
+            // All edges of all rings, bucketed into latitude bands:
+            // m_edges[m_band_start[b] .. m_band_start[b + 1]) are the
+            // edges overlapping band b. Edges spanning several bands are
+            // stored once per band.
+            std::vector<edge> m_edges;
+            std::vector<uint32_t> m_band_start;
+
+            osmium::Box m_envelope;
+
+            int64_t m_band_height = 0;
+
+            std::size_t num_bands() const noexcept {
+                return m_band_start.empty() ? 0 : m_band_start.size() - 1;
+            }
+
+            std::size_t band_of(int32_t y) const noexcept {
+                const auto band = static_cast<std::size_t>((static_cast<int64_t>(y) - m_envelope.bottom_left().y()) / m_band_height);
+                return std::min(band, num_bands() - 1);
+            }
+
+            template <typename TFunc>
+            void for_each_ring_edge(const osmium::Area& area, TFunc&& func) const {
+                for (const auto& item : area) {
+                    if (item.type() != osmium::item_type::outer_ring &&
+                        item.type() != osmium::item_type::inner_ring) {
+                        continue;
+                    }
+                    const auto& ring = static_cast<const osmium::NodeRefList&>(item);
+                    for (std::size_t n = 1; n < ring.size(); ++n) {
+                        const osmium::Location from = ring[n - 1].location();
+                        const osmium::Location to = ring[n].location();
+                        if (from.y() != to.y()) { // horizontal edges can never be crossed
+                            func(edge{from.x(), from.y(), to.x(), to.y()});
+                        }
+                    }
+                }
+            }
+
+            // Does a ray from (x, y) going in +x direction cross this edge?
+            static bool ray_crosses(const edge& e, int32_t x, int32_t y) noexcept {
+                if ((e.y1 > y) == (e.y2 > y)) {
+                    return false;
+                }
+                // x < x1 + (y - y1) * (x2 - x1) / (y2 - y1), evaluated
+                // without the division so it is exact.
+                const int64_t lhs = static_cast<int64_t>(x - e.x1) * (e.y2 - e.y1);
+                const int64_t rhs = static_cast<int64_t>(e.x2 - e.x1) * (y - e.y1);
+                return e.y2 > e.y1 ? lhs < rhs : lhs > rhs;
+            }
+
+        public:
+
+            /**
+             * Prepare the lookup structure for the given area. The edges
+             * are copied, the area does not have to stay around after
+             * this.
+             */
+            explicit PreparedArea(const osmium::Area& area) {
+                std::size_t count = 0;
+                for_each_ring_edge(area, [&count](const edge&) {
+                    ++count;
+                });
+
+                if (count == 0) {
+                    return;
+                }
+
+                m_envelope = area.envelope();
+
+                const auto bands = std::min<std::size_t>(max_bands, count / min_edges_per_band + 1);
+                const int64_t height = static_cast<int64_t>(m_envelope.top_right().y()) - m_envelope.bottom_left().y();
+                m_band_height = height / static_cast<int64_t>(bands) + 1;
+
+                // Count the edges per band first, so each band's edges
+                // end up in one contiguous run of m_edges.
+                std::vector<uint32_t> band_count(bands, 0);
+                for_each_ring_edge(area, [this, &band_count](const edge& e) {
+                    const std::size_t first = band_of(std::min(e.y1, e.y2));
+                    const std::size_t last = band_of(std::max(e.y1, e.y2));
+                    for (std::size_t band = first; band <= last; ++band) {
+                        ++band_count[band];
+                    }
+                });
+
+                m_band_start.resize(bands + 1, 0);
+                for (std::size_t band = 0; band < bands; ++band) {
+                    m_band_start[band + 1] = m_band_start[band] + band_count[band];
+                }
+
+                m_edges.resize(m_band_start.back());
+                std::vector<uint32_t> fill{m_band_start};
+                for_each_ring_edge(area, [this, &fill](const edge& e) {
+                    const std::size_t first = band_of(std::min(e.y1, e.y2));
+                    const std::size_t last = band_of(std::max(e.y1, e.y2));
+                    for (std::size_t band = first; band <= last; ++band) {
+                        m_edges[fill[band]++] = e;
+                    }
+                });
+            }
+
+            /**
+             * Is this area empty, ie. does it have no rings? contains()
+             * always returns false for an empty area.
+             */
+            bool empty() const noexcept {
+                return m_edges.empty();
+            }
+
+            /// The precomputed envelope of the area.
+            const osmium::Box& envelope() const noexcept {
+                return m_envelope;
+            }
+
+            /**
+             * Is the given location inside the area? Inner rings count
+             * as holes, ie. for locations inside an inner ring false is
+             * returned.
+             *
+             * @param location The location to check. Must be valid.
+             */
+            bool contains(const osmium::Location& location) const noexcept {
+                if (m_edges.empty() || !m_envelope.contains(location)) {
+                    return false;
+                }
+
+                const std::size_t band = band_of(location.y());
+                bool inside = false;
+                for (uint32_t n = m_band_start[band]; n != m_band_start[band + 1]; ++n) {
+                    if (ray_crosses(m_edges[n], location.x(), location.y())) {
+                        inside = !inside;
+                    }
+                }
+
+                return inside;
+            }
+
+            /// The amount of memory used by this structure.
+            std::size_t used_memory() const noexcept {
+                return sizeof(PreparedArea) +
+                       m_edges.capacity() * sizeof(edge) +
+                       m_band_start.capacity() * sizeof(uint32_t);
+            }
+
+        }; // class PreparedArea
+
+    } // namespace geom
+
+} // namespace osmium
+
+#endif // OSMIUM_GEOM_PREPARED_AREA_HPP
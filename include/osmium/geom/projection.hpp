@@ -49,6 +49,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <proj_api.h>
 
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -120,6 +121,25 @@ namespace osmium {
             return c;
         }
 
+        /**
+         * Transform an array of coordinates in place from one CRS into
+         * another in a single call into the proj library. This is much
+         * faster than calling transform() for every coordinate.
+         *
+         * Coordinates have to be in radians and are produced in radians.
+         *
+         * @throws osmium::projection_error if the projection fails
+         */
+        inline void transform(const CRS& src, const CRS& dest, Coordinates* data, std::size_t count) {
+            if (count == 0) {
+                return;
+            }
+            const int result = pj_transform(src.get(), dest.get(), static_cast<long>(count), 2, &data->x, &data->y, nullptr);
+            if (result != 0) {
+                throw osmium::projection_error{std::string{"projection failed: "} + pj_strerrno(result)};
+            }
+        }
+
         /**
          * Functor that does projection from WGS84 (EPSG:4326) to the given
          * CRS.
@@ -178,6 +198,38 @@ namespace osmium {
                 return c;
             }
 
+            /**
+             * Project an array of WGS84 lon/lat coordinates in place. This
+             * goes into the proj library only once for the whole array,
+             * which is much faster than calling the projection functor for
+             * every coordinate. The geometry factories use this to project
+             * all coordinates of a linestring in one call.
+             */
+            void transform(Coordinates* data, std::size_t count) const {
+                if (m_epsg == 4326) {
+                    return;
+                }
+
+                if (m_epsg == 3857) {
+                    lonlat_to_mercator(data, count);
+                    return;
+                }
+
+                for (std::size_t i = 0; i < count; ++i) {
+                    data[i].x = deg_to_rad(data[i].x);
+                    data[i].y = deg_to_rad(data[i].y);
+                }
+
+                osmium::geom::transform(m_crs_wgs84, m_crs_user, data, count);
+
+                if (m_crs_user.is_latlong()) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        data[i].x = rad_to_deg(data[i].x);
+                        data[i].y = rad_to_deg(data[i].y);
+                    }
+                }
+            }
+
             int epsg() const noexcept {
                 return m_epsg;
             }
@@ -53,6 +53,16 @@ namespace osmium {
 
                 TWriter* m_writer;
 
+                template <typename TW>
+                static auto set_max_decimal_places(TW& writer, int precision, int) -> decltype(writer.SetMaxDecimalPlaces(precision), void()) {
+                    writer.SetMaxDecimalPlaces(precision);
+                }
+
+                template <typename TW>
+                static void set_max_decimal_places(TW& /*writer*/, int /*precision*/, long) {
+                    // writer does not support limiting the decimal places
+                }
+
             public:
 
                 using point_type        = void;
@@ -65,15 +75,30 @@ namespace osmium {
                     m_writer(&writer) {
                 }
 
+                /**
+                 * Construct a factory that writes coordinates with at most
+                 * the given number of decimal places (calls
+                 * SetMaxDecimalPlaces() on the writer if it has such a
+                 * function). With a fixed precision RapidJSON uses a much
+                 * cheaper formatting algorithm than the default shortest
+                 * representation and the output gets smaller, too. For
+                 * WGS84 coordinates 7 decimal places are enough to keep
+                 * the full precision OSM uses.
+                 */
+                RapidGeoJSONFactoryImpl(int /* srid */, TWriter& writer, int precision) :
+                    m_writer(&writer) {
+                    set_max_decimal_places(*m_writer, precision, 0);
+                }
+
                 /* Point */
 
                 // { "type": "Point", "coordinates": [100.0, 0.0] }
                 point_type make_point(const osmium::geom::Coordinates& xy) const {
-                    m_writer->String("geometry");
+                    m_writer->String("geometry", 8);
                     m_writer->StartObject();
-                    m_writer->String("type");
-                    m_writer->String("Point");
-                    m_writer->String("coordinates");
+                    m_writer->String("type", 4);
+                    m_writer->String("Point", 5);
+                    m_writer->String("coordinates", 11);
                     m_writer->StartArray();
                     m_writer->Double(xy.x);
                     m_writer->Double(xy.y);
@@ -85,11 +110,11 @@ namespace osmium {
 
                 // { "type": "LineString", "coordinates": [ [100.0, 0.0], [101.0, 1.0] ] }
                 void linestring_start() {
-                    m_writer->String("geometry");
+                    m_writer->String("geometry", 8);
                     m_writer->StartObject();
-                    m_writer->String("type");
-                    m_writer->String("LineString");
-                    m_writer->String("coordinates");
+                    m_writer->String("type", 4);
+                    m_writer->String("LineString", 10);
+                    m_writer->String("coordinates", 11);
                     m_writer->StartArray();
                 }
 
@@ -109,11 +134,11 @@ namespace osmium {
 
                 // { "type": "Polygon", "coordinates": [[[100.0, 0.0], [101.0, 1.0]]] }
                 void polygon_start() {
-                    m_writer->String("geometry");
+                    m_writer->String("geometry", 8);
                     m_writer->StartObject();
-                    m_writer->String("type");
-                    m_writer->String("Polygon");
-                    m_writer->String("coordinates");
+                    m_writer->String("type", 4);
+                    m_writer->String("Polygon", 7);
+                    m_writer->String("coordinates", 11);
                     m_writer->StartArray();
                     m_writer->StartArray();
                 }
@@ -134,11 +159,11 @@ namespace osmium {
                 /* MultiPolygon */
 
                 void multipolygon_start() {
-                    m_writer->String("geometry");
+                    m_writer->String("geometry", 8);
                     m_writer->StartObject();
-                    m_writer->String("type");
-                    m_writer->String("MultiPolygon");
-                    m_writer->String("coordinates");
+                    m_writer->String("type", 4);
+                    m_writer->String("MultiPolygon", 12);
+                    m_writer->String("coordinates", 11);
                     m_writer->StartArray();
                 }
 
@@ -38,7 +38,9 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/location.hpp>
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 namespace osmium {
 
@@ -173,6 +175,66 @@ namespace osmium {
                 return x < max && y < max;
             }
 
+            /**
+             * Get the index of this tile on the Z-order (Morton) curve for
+             * its zoom level. Sorting tiles of the same zoom level by this
+             * index keeps tiles that are near each other on the globe near
+             * each other in the sort order.
+             *
+             * @pre @code valid() @endcode
+             */
+            uint64_t zorder() const noexcept {
+                return (interleave(x) << 1u) | interleave(y);
+            }
+
+            /**
+             * Get the index of this tile on the Hilbert curve for its zoom
+             * level. Like the Z-order index this can be used to sort tiles
+             * of the same zoom level by spatial locality, but unlike the
+             * Z-order curve the Hilbert curve has no jumps: tiles with
+             * consecutive indexes are always next to each other.
+             *
+             * @pre @code valid() @endcode
+             */
+            uint64_t hilbert_index() const noexcept {
+                const uint32_t n = num_tiles_in_zoom(z);
+                uint32_t tx = x;
+                uint32_t ty = y;
+                uint64_t d = 0;
+
+                for (uint32_t s = n >> 1u; s > 0; s >>= 1u) {
+                    const uint32_t rx = (tx & s) ? 1 : 0;
+                    const uint32_t ry = (ty & s) ? 1 : 0;
+                    d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+                    // rotate quadrant
+                    if (ry == 0) {
+                        if (rx == 1) {
+                            tx = n - 1 - tx;
+                            ty = n - 1 - ty;
+                        }
+                        const uint32_t t = tx;
+                        tx = ty;
+                        ty = t;
+                    }
+                }
+
+                return d;
+            }
+
+        private:
+
+            /// Spread out the bits of v so there is a zero bit between each.
+            static uint64_t interleave(uint32_t v) noexcept {
+                uint64_t n = v;
+                n = (n | (n << 16u)) & 0x0000ffff0000ffffllu;
+                n = (n | (n <<  8u)) & 0x00ff00ff00ff00ffllu;
+                n = (n | (n <<  4u)) & 0x0f0f0f0f0f0f0f0fllu;
+                n = (n | (n <<  2u)) & 0x3333333333333333llu;
+                n = (n | (n <<  1u)) & 0x5555555555555555llu;
+                return n;
+            }
+
         }; // struct Tile
 
         /// Tiles are equal if all their attributes are equal.
@@ -203,6 +265,23 @@ namespace osmium {
             return lhs.y < rhs.y;
         }
 
+        /**
+         * Compute for each of the given WGS84 lon/lat coordinates the tile
+         * in the given zoom level containing it and append the tiles to the
+         * given vector. The coordinates are projected to web mercator in
+         * place using the batch mercator projection, which is much faster
+         * than constructing each tile from a location.
+         *
+         * @pre All coordinates must be valid and @code zoom <= 30 @endcode
+         */
+        inline void lonlat_to_tiles(uint32_t zoom, Coordinates* data, std::size_t count, std::vector<Tile>& tiles) {
+            lonlat_to_mercator(data, count);
+            tiles.reserve(tiles.size() + count);
+            for (std::size_t i = 0; i < count; ++i) {
+                tiles.emplace_back(zoom, data[i]);
+            }
+        }
+
     } // namespace geom
 
 } // namespace osmium
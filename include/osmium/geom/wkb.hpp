@@ -56,6 +56,24 @@ namespace osmium {
             hex    = true
         }; // enum class out_type
 
+        /**
+         * Number of bytes needed for the WKB of a point geometry. Use this
+         * for sizing an output buffer given to the WKBFactory.
+         */
+        constexpr inline std::size_t wkb_point_size(wkb_type wtype = wkb_type::wkb, out_type otype = out_type::binary) {
+            return (1 + 4 + (wtype == wkb_type::ewkb ? 4 : 0) + 2 * sizeof(double)) * (otype == out_type::hex ? 2 : 1);
+        }
+
+        /**
+         * Number of bytes needed for the WKB of a linestring geometry with
+         * the given number of points. Use this for sizing an output buffer
+         * given to the WKBFactory, for instance with the size() of the
+         * WayNodeList the linestring will be created from.
+         */
+        constexpr inline std::size_t wkb_linestring_size(std::size_t num_points, wkb_type wtype = wkb_type::wkb, out_type otype = out_type::binary) {
+            return (1 + 4 + (wtype == wkb_type::ewkb ? 4 : 0) + 4 + num_points * 2 * sizeof(double)) * (otype == out_type::hex ? 2 : 1);
+        }
+
         namespace detail {
 
             template <typename T>
@@ -63,16 +81,19 @@ namespace osmium {
                 str.append(reinterpret_cast<const char*>(&data), sizeof(T));
             }
 
-            inline std::string convert_to_hex(const std::string& str) {
+            inline void append_as_hex(std::string& out, const std::string& str) {
                 static const char* lookup_hex = "0123456789ABCDEF";
-                std::string out;
-                out.reserve(str.size() * 2);
+                out.reserve(out.size() + str.size() * 2);
 
                 for (char c : str) {
                     out += lookup_hex[(static_cast<unsigned int>(c) >> 4u) & 0xfu];
                     out += lookup_hex[ static_cast<unsigned int>(c)        & 0xfu];
                 }
+            }
 
+            inline std::string convert_to_hex(const std::string& str) {
+                std::string out;
+                append_as_hex(out, str);
                 return out;
             }
 
@@ -107,6 +128,7 @@ namespace osmium {
                 }; // enum class wkb_byte_order_type
 
                 std::string m_data;
+                std::string* m_buffer = nullptr;
                 uint32_t m_points = 0;
                 int m_srid;
                 wkb_type m_wkb_type;
@@ -146,6 +168,32 @@ namespace osmium {
                     std::copy_n(reinterpret_cast<const char*>(&s), sizeof(uint32_t), &m_data[offset]);
                 }
 
+                void append_data(const std::string& data) const {
+                    if (m_out_type == out_type::hex) {
+                        append_as_hex(*m_buffer, data);
+                    } else {
+                        m_buffer->append(data);
+                    }
+                }
+
+                std::string finish_data() {
+                    if (m_buffer) {
+                        append_data(m_data);
+                        return std::string{};
+                    }
+
+                    std::string data;
+
+                    using std::swap;
+                    swap(data, m_data);
+
+                    if (m_out_type == out_type::hex) {
+                        return convert_to_hex(data);
+                    }
+
+                    return data;
+                }
+
             public:
 
                 using point_type        = std::string;
@@ -160,6 +208,30 @@ namespace osmium {
                     m_out_type(otype) {
                 }
 
+                /**
+                 * Construct a factory that appends all geometries it
+                 * creates to the given output buffer instead of returning
+                 * each geometry in its own string. The functions creating
+                 * geometries return an empty string in this mode, it is up
+                 * to the caller to remember the offset and length of each
+                 * geometry in the buffer.
+                 *
+                 * Reserve enough space in the buffer up front, for
+                 * instance computed with wkb_point_size() and
+                 * wkb_linestring_size() from the lengths of the node lists
+                 * the geometries will be created from, and no allocation
+                 * happens while the geometries are created.
+                 *
+                 * The buffer is not owned by the factory, it must stay
+                 * alive as long as the factory is used.
+                 */
+                WKBFactoryImpl(int srid, std::string* buffer, wkb_type wtype = wkb_type::wkb, out_type otype = out_type::binary) :
+                    m_buffer(buffer),
+                    m_srid(srid),
+                    m_wkb_type(wtype),
+                    m_out_type(otype) {
+                }
+
                 /* Point */
 
                 point_type make_point(const osmium::geom::Coordinates& xy) const {
@@ -168,6 +240,11 @@ namespace osmium {
                     str_push(data, xy.x);
                     str_push(data, xy.y);
 
+                    if (m_buffer) {
+                        append_data(data);
+                        return point_type{};
+                    }
+
                     if (m_out_type == out_type::hex) {
                         return convert_to_hex(data);
                     }
@@ -189,16 +266,7 @@ namespace osmium {
 
                 linestring_type linestring_finish(std::size_t num_points) {
                     set_size(m_linestring_size_offset, num_points);
-                    std::string data;
-
-                    using std::swap;
-                    swap(data, m_data);
-
-                    if (m_out_type == out_type::hex) {
-                        return convert_to_hex(data);
-                    }
-
-                    return data;
+                    return finish_data();
                 }
 
                 /* MultiPolygon */
@@ -249,16 +317,7 @@ namespace osmium {
 
                 multipolygon_type multipolygon_finish() {
                     set_size(m_multipolygon_size_offset, m_polygons);
-                    std::string data;
-
-                    using std::swap;
-                    swap(data, m_data);
-
-                    if (m_out_type == out_type::hex) {
-                        return convert_to_hex(data);
-                    }
-
-                    return data;
+                    return finish_data();
                 }
 
             }; // class WKBFactoryImpl
@@ -44,6 +44,7 @@ namespace osmium {
     class OuterRing;
     class Relation;
     class RelationMemberList;
+    class RingDirectory;
     class TagList;
     class Way;
     class WayNodeList;
@@ -105,6 +106,9 @@ namespace osmium {
             void inner_ring(const osmium::InnerRing& /*inner_ring*/) const noexcept {
             }
 
+            void ring_directory(const osmium::RingDirectory& /*ring_directory*/) const noexcept {
+            }
+
             void changeset_discussion(const osmium::ChangesetDiscussion& /*changeset_discussion*/) const noexcept {
             }
 
@@ -0,0 +1,246 @@
+#ifndef OSMIUM_HANDLER_AGGREGATOR_HPP
+#define OSMIUM_HANDLER_AGGREGATOR_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/handler.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace handler {
+
+        /**
+         * Streaming per-key aggregation over the objects in an
+         * osmium::apply() call. The reducer given as template parameter
+         * decides which objects take part, which 64 bit key they are
+         * grouped under, and how an object updates the accumulated
+         * value of its group:
+         *
+         * @code
+         * struct HighwayLength {
+         *     using value_type = uint64_t; // count of ways
+         *     bool key(const osmium::OSMObject& object, uint64_t& key) const {
+         *         const char* highway = object.tags()["highway"];
+         *         if (object.type() != osmium::item_type::way || !highway) {
+         *             return false;
+         *         }
+         *         key = my_string_table.id(highway);
+         *         return true;
+         *     }
+         *     void update(value_type& value, const osmium::OSMObject&) const {
+         *         ++value;
+         *     }
+         * };
+         *
+         * osmium::handler::Aggregator<HighwayLength> agg{
+         *     [](uint64_t key, const uint64_t& count) { ... }};
+         * osmium::apply(reader, agg);
+         * @endcode
+         *
+         * Groups are stored in a flat open-addressing hash table (two
+         * parallel vectors, no per-group allocation), so millions of
+         * groups stay cache-friendly and cheap to update.
+         *
+         * When flush() is called, the emit function is called once for
+         * every group collected so far and the table is reset, so in a
+         * pipeline with periodic flushes the results are emitted
+         * incrementally per flush window. Call flush() (directly or via
+         * the end of apply()) to get the final window. Use for_each()
+         * instead if you want to look at the groups without resetting.
+         */
+        template <typename TReducer>
+        class Aggregator : public osmium::handler::Handler {
+
+        public:
+
+            using reducer_type = TReducer;
+            using key_type     = std::uint64_t;
+            using value_type   = typename TReducer::value_type;
+            using emit_type    = std::function<void(key_type, const value_type&)>;
+
+        private:
+
+            /// This key is used to mark empty slots and can not be used as a group key.
+            enum : key_type {
+                empty_key = std::numeric_limits<key_type>::max()
+            };
+
+            enum : std::size_t {
+                initial_bits = 10 // 1024 slots
+            };
+
+            std::vector<key_type> m_keys;
+            std::vector<value_type> m_values;
+            std::size_t m_used = 0;
+            unsigned int m_bits = 0;
+
+            TReducer m_reducer;
+            emit_type m_emit;
+
+            std::size_t slot_of(const key_type key) const noexcept {
+                // fibonacci hashing spreads the keys over the table,
+                // the topmost bits of the product are well-mixed
+                return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ULL) >> (64U - m_bits));
+            }
+
+            std::size_t capacity() const noexcept {
+                return std::size_t{1} << m_bits;
+            }
+
+            void allocate(const unsigned int bits) {
+                m_bits = bits;
+                m_keys.assign(capacity(), key_type(empty_key));
+                m_values.assign(capacity(), value_type{});
+            }
+
+            void grow() {
+                std::vector<key_type> old_keys{std::move(m_keys)};
+                std::vector<value_type> old_values{std::move(m_values)};
+                allocate(m_bits + 1);
+                for (std::size_t i = 0; i < old_keys.size(); ++i) {
+                    if (old_keys[i] != empty_key) {
+                        find_value(old_keys[i]) = std::move(old_values[i]);
+                    }
+                }
+            }
+
+            value_type& find_value(const key_type key) noexcept {
+                const std::size_t mask = capacity() - 1;
+                std::size_t slot = slot_of(key);
+                while (m_keys[slot] != key && m_keys[slot] != empty_key) {
+                    slot = (slot + 1) & mask;
+                }
+                if (m_keys[slot] == empty_key) {
+                    m_keys[slot] = key;
+                }
+                return m_values[slot];
+            }
+
+        public:
+
+            explicit Aggregator(emit_type emit = emit_type{}, TReducer reducer = TReducer{}) :
+                m_reducer(std::move(reducer)),
+                m_emit(std::move(emit)) {
+            }
+
+            /// Access the reducer, for instance to get at lookup tables it built.
+            TReducer& reducer() noexcept {
+                return m_reducer;
+            }
+
+            const TReducer& reducer() const noexcept {
+                return m_reducer;
+            }
+
+            /// The number of groups currently in the table.
+            std::size_t size() const noexcept {
+                return m_used;
+            }
+
+            std::size_t used_memory() const noexcept {
+                return m_keys.capacity() * sizeof(key_type) +
+                       m_values.capacity() * sizeof(value_type) +
+                       sizeof(Aggregator);
+            }
+
+            void osm_object(const osmium::OSMObject& object) {
+                key_type key = 0;
+                if (!m_reducer.key(object, key)) {
+                    return;
+                }
+                assert(key != empty_key && "the all-ones key is reserved");
+                if (m_keys.empty()) {
+                    allocate(initial_bits);
+                }
+                // grow at 75% load so probe chains stay short
+                if (m_used + 1 > capacity() - capacity() / 4) {
+                    grow();
+                }
+                const std::size_t mask = capacity() - 1;
+                std::size_t slot = slot_of(key);
+                while (m_keys[slot] != key && m_keys[slot] != empty_key) {
+                    slot = (slot + 1) & mask;
+                }
+                if (m_keys[slot] == empty_key) {
+                    m_keys[slot] = key;
+                    ++m_used;
+                }
+                m_reducer.update(m_values[slot], object);
+            }
+
+            /**
+             * Call func(key, value) for every group currently in the
+             * table, in unspecified order. Does not change the table.
+             */
+            template <typename TFunc>
+            void for_each(TFunc&& func) const {
+                for (std::size_t i = 0; i < m_keys.size(); ++i) {
+                    if (m_keys[i] != empty_key) {
+                        func(m_keys[i], m_values[i]);
+                    }
+                }
+            }
+
+            /**
+             * Emit all groups collected since the last flush through
+             * the emit function and reset the table. Called at the end
+             * of osmium::apply() and by upstream handlers that flush
+             * periodically.
+             */
+            void flush() {
+                if (m_emit) {
+                    for_each(m_emit);
+                }
+                if (m_used > 0) {
+                    m_keys.assign(m_keys.size(), key_type(empty_key));
+                    m_values.assign(m_values.size(), value_type{});
+                    m_used = 0;
+                }
+            }
+
+        }; // class Aggregator
+
+    } // namespace handler
+
+} // namespace osmium
+
+#endif // OSMIUM_HANDLER_AGGREGATOR_HPP
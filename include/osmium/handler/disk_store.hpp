@@ -42,9 +42,23 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/relation.hpp>
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/way.hpp>
+#include <osmium/thread/queue.hpp>
+#include <osmium/thread/util.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
 #include <osmium/visitor.hpp>
 
+#include <cassert>
 #include <cstddef>
+#include <exception>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+# include <cerrno>
+# include <fcntl.h>
+# include <system_error>
+#endif
 
 namespace osmium {
 
@@ -55,6 +69,16 @@ namespace osmium {
          * keeping track of object offsets in the indexes given to the
          * constructor.
          *
+         * By default every buffer is written synchronously from the
+         * calling thread. Construct with async_writes::yes to write from
+         * a background thread instead, so the caller (usually the decode
+         * pipeline) doesn't stall on the disk. In that mode, move the
+         * buffers in if you can, otherwise they are copied. Call close()
+         * when done, it waits until everything is on disk and re-throws
+         * any write error from the background thread.
+         *
+         * Use the DiskStoreReader to get objects back out of the store.
+         *
          * Note: This handler will only work if either all object IDs are
          *       positive or all object IDs are negative.
          */
@@ -62,6 +86,17 @@ namespace osmium {
 
             using offset_index_type = osmium::index::map::Map<unsigned_object_id_type, std::size_t>;
 
+        public:
+
+            enum class async_writes : bool {
+                no  = false,
+                yes = true
+            }; // enum class async_writes
+
+        private:
+
+            enum { max_queue_size = 16 };
+
             std::size_t m_offset = 0;
             int m_data_fd;
 
@@ -69,13 +104,80 @@ namespace osmium {
             offset_index_type& m_way_index;
             offset_index_type& m_relation_index;
 
+            osmium::thread::Queue<osmium::memory::Buffer> m_queue;
+            std::thread m_writer_thread{};
+
+            // only set by the writer thread, only read after joining it
+            std::exception_ptr m_writer_error{};
+
+            void run_writer() noexcept {
+                osmium::thread::set_thread_name("_osmium_dstore");
+                while (true) {
+                    osmium::memory::Buffer buffer;
+                    m_queue.wait_and_pop(buffer);
+                    if (!buffer) {
+                        return;
+                    }
+                    if (!m_writer_error) {
+                        try {
+                            osmium::io::detail::reliable_write(m_data_fd, buffer.data(), buffer.committed());
+                        } catch (...) {
+                            // remember the error but keep draining the
+                            // queue so the pushing thread isn't blocked
+                            m_writer_error = std::current_exception();
+                        }
+                    }
+                }
+            }
+
+            void write(const osmium::memory::Buffer& buffer) {
+                osmium::io::detail::reliable_write(m_data_fd, buffer.data(), buffer.committed());
+            }
+
         public:
 
-            explicit DiskStore(int data_fd, offset_index_type& node_index, offset_index_type& way_index, offset_index_type& relation_index) :
+            explicit DiskStore(int data_fd, offset_index_type& node_index, offset_index_type& way_index, offset_index_type& relation_index, async_writes async = async_writes::no) :
                 m_data_fd(data_fd),
                 m_node_index(node_index),
                 m_way_index(way_index),
-                m_relation_index(relation_index) {
+                m_relation_index(relation_index),
+                m_queue(max_queue_size, "disk_store") {
+                if (async == async_writes::yes) {
+                    m_writer_thread = std::thread{&DiskStore::run_writer, this};
+                }
+            }
+
+            DiskStore(const DiskStore&) = delete;
+            DiskStore& operator=(const DiskStore&) = delete;
+
+            DiskStore(DiskStore&&) = delete;
+            DiskStore& operator=(DiskStore&&) = delete;
+
+            ~DiskStore() noexcept {
+                try {
+                    close();
+                } catch (...) {
+                    // ignore errors in destructor, call close() to get them
+                }
+            }
+
+            /**
+             * Preallocate disk space for the data file. Telling the
+             * filesystem the expected size up front avoids repeated
+             * extent allocations while the store grows. Only implemented
+             * on Linux, a no-op elsewhere.
+             *
+             * @param size Expected total size of the data file in bytes.
+             */
+            void preallocate(const std::size_t size) {
+#ifdef __linux__
+                const int err = ::posix_fallocate(m_data_fd, 0, static_cast<off_t>(size));
+                if (err != 0 && err != EOPNOTSUPP && err != EINVAL) {
+                    throw std::system_error{err, std::system_category(), "posix_fallocate failed"};
+                }
+#else
+                (void)size;
+#endif
             }
 
             void node(const osmium::Node& node) {
@@ -94,12 +196,111 @@ namespace osmium {
             }
 
             void operator()(const osmium::memory::Buffer& buffer) {
-                osmium::io::detail::reliable_write(m_data_fd, buffer.data(), buffer.committed());
+                if (m_writer_thread.joinable()) {
+                    osmium::memory::Buffer copy{buffer.committed()};
+                    copy.add_buffer(buffer);
+                    copy.commit();
+                    m_queue.push(std::move(copy));
+                } else {
+                    write(buffer);
+                }
+                osmium::apply(buffer.begin(), buffer.end(), *this);
+            }
+
+            void operator()(osmium::memory::Buffer&& buffer) {
                 osmium::apply(buffer.begin(), buffer.end(), *this);
+                if (m_writer_thread.joinable()) {
+                    m_queue.push(std::move(buffer));
+                } else {
+                    write(buffer);
+                }
+            }
+
+            /**
+             * Wait until all buffers are written to disk and stop the
+             * background writer thread (if there is one).
+             *
+             * @throws Whatever error the background writes ran into.
+             */
+            void close() {
+                if (m_writer_thread.joinable()) {
+                    m_queue.push(osmium::memory::Buffer{});
+                    m_writer_thread.join();
+                    if (m_writer_error) {
+                        std::rethrow_exception(m_writer_error);
+                    }
+                }
             }
 
         }; // class DiskStore
 
+        /**
+         * Random-access retrieval of objects from the data written by a
+         * DiskStore, using the offset indexes filled by it. The whole
+         * data file is memory-mapped read-only, so a get only touches
+         * the pages the object lives on and repeated gets are served
+         * from the page cache.
+         *
+         * Only use this after the DiskStore is closed, the mapping is
+         * created from the file size at construction time.
+         */
+        class DiskStoreReader {
+
+            using offset_index_type = osmium::index::map::Map<unsigned_object_id_type, std::size_t>;
+
+            osmium::util::MemoryMapping m_mapping;
+
+            const offset_index_type& m_node_index;
+            const offset_index_type& m_way_index;
+            const offset_index_type& m_relation_index;
+
+            template <typename T>
+            const T& object_at(const std::size_t offset) const {
+                assert(offset + sizeof(T) <= m_mapping.size());
+                return *reinterpret_cast<const T*>(m_mapping.get_addr<const unsigned char>() + offset);
+            }
+
+        public:
+
+            explicit DiskStoreReader(int data_fd, const offset_index_type& node_index, const offset_index_type& way_index, const offset_index_type& relation_index) :
+                m_mapping(osmium::util::file_size(data_fd), osmium::util::MemoryMapping::mapping_mode::readonly, data_fd),
+                m_node_index(node_index),
+                m_way_index(way_index),
+                m_relation_index(relation_index) {
+            }
+
+            /**
+             * Get the node with the given ID.
+             *
+             * @throws osmium::not_found if there is no node with this ID
+             *         in the index.
+             */
+            const osmium::Node& get_node(const unsigned_object_id_type id) const {
+                return object_at<osmium::Node>(m_node_index.get(id));
+            }
+
+            /**
+             * Get the way with the given ID.
+             *
+             * @throws osmium::not_found if there is no way with this ID
+             *         in the index.
+             */
+            const osmium::Way& get_way(const unsigned_object_id_type id) const {
+                return object_at<osmium::Way>(m_way_index.get(id));
+            }
+
+            /**
+             * Get the relation with the given ID.
+             *
+             * @throws osmium::not_found if there is no relation with this
+             *         ID in the index.
+             */
+            const osmium::Relation& get_relation(const unsigned_object_id_type id) const {
+                return object_at<osmium::Relation>(m_relation_index.get(id));
+            }
+
+        }; // class DiskStoreReader
+
     } // namespace handler
 
 } // namespace osmium
@@ -48,67 +48,125 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/tag.hpp>
 #include <osmium/osm/timestamp.hpp>
 #include <osmium/osm/way.hpp>
+#include <osmium/util/itoa.hpp>
 #include <osmium/visitor.hpp>
 
-#include <iomanip>
-#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ostream>
 #include <string>
+#include <utility>
 
 namespace osmium {
 
     namespace handler {
 
+        /**
+         * Handler writing a human-readable dump of the contents of
+         * every OSM entity. Each entity is formatted into an internal
+         * buffer with simple integer-to-string routines and written to
+         * the stream with a single write, instead of going through
+         * hundreds of locale-aware stream operators per object.
+         */
         class Dump : public osmium::handler::Handler {
 
             std::ostream* m_out;
+            std::string m_own_buffer;
+
+            // All formatting goes into this buffer: the own buffer for
+            // a top-level dump, the buffer of the parent for the nested
+            // dumps used for subitems.
+            std::string* m_buffer;
+
             bool m_with_size;
             std::string m_prefix;
 
+            // Nested dump writing into the buffer of its parent. Only
+            // the top-level dump flushes to the stream.
+            Dump(std::string* buffer, const bool with_size, std::string prefix) :
+                m_out(nullptr),
+                m_buffer(buffer),
+                m_with_size(with_size),
+                m_prefix(std::move(prefix)) {
+            }
+
+            void append_int(const int64_t value) {
+                char tmp[21];
+                const char* const end = osmium::util::int64_to_string(value, tmp);
+                m_buffer->append(tmp, static_cast<std::size_t>(end - tmp));
+            }
+
+            // Append a coordinate with a fixed seven digits after the
+            // decimal point, the same format the stream-based dump used.
+            void append_fixed_coordinate(const int32_t value) {
+                int64_t v = value;
+                if (v < 0) {
+                    m_buffer->push_back('-');
+                    v = -v;
+                }
+                append_int(v / osmium::detail::coordinate_precision);
+                m_buffer->push_back('.');
+                char tmp[7];
+                int64_t frac = v % osmium::detail::coordinate_precision;
+                for (int i = 6; i >= 0; --i) {
+                    tmp[i] = static_cast<char>('0' + frac % 10);
+                    frac /= 10;
+                }
+                m_buffer->append(tmp, 7);
+            }
+
+            void append_location(const osmium::Location& location) {
+                m_buffer->push_back('(');
+                location.as_string_without_check(std::back_inserter(*m_buffer), ',');
+                m_buffer->push_back(')');
+            }
+
             void print_title(const char* title, const osmium::memory::Item& item) {
-                *m_out << m_prefix
-                       << title
-                       << ":";
+                m_buffer->append(m_prefix);
+                m_buffer->append(title);
+                m_buffer->push_back(':');
 
                 if (m_with_size) {
-                    *m_out << " ["
-                           << item.byte_size()
-                           << "]";
+                    m_buffer->append(" [");
+                    append_int(static_cast<int64_t>(item.byte_size()));
+                    m_buffer->push_back(']');
                 }
 
-                *m_out << "\n";
+                m_buffer->push_back('\n');
             }
 
             void print_meta(const osmium::OSMObject& object) {
-                *m_out << m_prefix
-                       << "  id="
-                       << object.id()
-                       << "\n";
-                *m_out << m_prefix
-                       << "  version="
-                       << object.version()
-                       << "\n";
-                *m_out << m_prefix
-                       << "  uid="
-                       << object.uid()
-                       << "\n";
-                *m_out << m_prefix
-                       << "  user=|"
-                       << object.user()
-                       << "|\n";
-                *m_out << m_prefix
-                       << "  changeset="
-                       << object.changeset()
-                       << "\n";
-                *m_out << m_prefix
-                       << "  timestamp="
-                       << object.timestamp().to_iso()
-                       << "\n";
-                *m_out << m_prefix
-                       << "  visible="
-                       << (object.visible() ? "yes" : "no")
-                       << "\n";
-
-                Dump dump{*m_out, m_with_size, m_prefix + "  "};
+                m_buffer->append(m_prefix);
+                m_buffer->append("  id=");
+                append_int(object.id());
+                m_buffer->push_back('\n');
+                m_buffer->append(m_prefix);
+                m_buffer->append("  version=");
+                append_int(static_cast<int64_t>(object.version()));
+                m_buffer->push_back('\n');
+                m_buffer->append(m_prefix);
+                m_buffer->append("  uid=");
+                append_int(static_cast<int64_t>(object.uid()));
+                m_buffer->push_back('\n');
+                m_buffer->append(m_prefix);
+                m_buffer->append("  user=|");
+                m_buffer->append(object.user());
+                m_buffer->append("|\n");
+                m_buffer->append(m_prefix);
+                m_buffer->append("  changeset=");
+                append_int(static_cast<int64_t>(object.changeset()));
+                m_buffer->push_back('\n');
+                m_buffer->append(m_prefix);
+                m_buffer->append("  timestamp=");
+                m_buffer->append(object.timestamp().to_iso());
+                m_buffer->push_back('\n');
+                m_buffer->append(m_prefix);
+                m_buffer->append("  visible=");
+                m_buffer->append(object.visible() ? "yes" : "no");
+                m_buffer->push_back('\n');
+
+                Dump dump{m_buffer, m_with_size, m_prefix + "  "};
                 osmium::apply(object.cbegin(), object.cend(), dump);
             }
 
@@ -116,21 +174,33 @@ namespace osmium {
                 const osmium::Location& location = node.location();
 
                 if (location) {
-                    *m_out << m_prefix
-                           << "  lon="
-                           << std::fixed
-                           << std::setprecision(7)
-                           << location.lon_without_check()
-                           << "\n";
-                    *m_out << m_prefix
-                           << "  lat="
-                           << location.lat_without_check()
-                           << "\n";
+                    m_buffer->append(m_prefix);
+                    m_buffer->append("  lon=");
+                    append_fixed_coordinate(location.x());
+                    m_buffer->push_back('\n');
+                    m_buffer->append(m_prefix);
+                    m_buffer->append("  lat=");
+                    append_fixed_coordinate(location.y());
+                    m_buffer->push_back('\n');
                 } else {
-                    *m_out << m_prefix
-                           << "  lon=\n"
-                           << m_prefix
-                           << "  lat=\n";
+                    m_buffer->append(m_prefix);
+                    m_buffer->append("  lon=\n");
+                    m_buffer->append(m_prefix);
+                    m_buffer->append("  lat=\n");
+                }
+            }
+
+            void print_node_ref_list(const char* title, const osmium::NodeRefList& nrl) {
+                print_title(title, nrl);
+                for (const auto& node_ref : nrl) {
+                    m_buffer->append(m_prefix);
+                    m_buffer->append("  ref=");
+                    append_int(node_ref.ref());
+                    if (node_ref.location()) {
+                        m_buffer->append(" pos=");
+                        append_location(node_ref.location());
+                    }
+                    m_buffer->push_back('\n');
                 }
             }
 
@@ -138,151 +208,147 @@ namespace osmium {
 
             explicit Dump(std::ostream& out, bool with_size = true, std::string prefix = "") :
                 m_out(&out),
+                m_buffer(&m_own_buffer),
                 m_with_size(with_size),
                 m_prefix(std::move(prefix)) {
             }
 
+            Dump(const Dump&) = delete;
+            Dump& operator=(const Dump&) = delete;
+
+            Dump(Dump&&) = delete;
+            Dump& operator=(Dump&&) = delete;
+
+            ~Dump() noexcept = default;
+
+            /**
+             * Write out anything still in the internal buffer. Called
+             * by every entity callback and at the end of apply(), so
+             * normally there is nothing to do here.
+             */
+            void flush() {
+                if (m_out && !m_buffer->empty()) {
+                    m_out->write(m_buffer->data(), static_cast<std::streamsize>(m_buffer->size()));
+                    m_buffer->clear();
+                }
+            }
+
             void tag_list(const osmium::TagList& tags) {
                 print_title("TAGS", tags);
                 for (const auto& tag : tags) {
-                    *m_out << m_prefix
-                           << "  k=|"
-                           << tag.key()
-                           << "| v=|"
-                           << tag.value()
-                           << "|"
-                           << "\n";
+                    m_buffer->append(m_prefix);
+                    m_buffer->append("  k=|");
+                    m_buffer->append(tag.key());
+                    m_buffer->append("| v=|");
+                    m_buffer->append(tag.value());
+                    m_buffer->append("|\n");
                 }
+                flush();
             }
 
             void way_node_list(const osmium::WayNodeList& wnl) {
-                print_title("NODES", wnl);
-                for (const auto& node_ref : wnl) {
-                    *m_out << m_prefix
-                           << "  ref="
-                           << node_ref.ref();
-                    if (node_ref.location()) {
-                        *m_out << " pos="
-                               << node_ref.location();
-                    }
-                    *m_out << "\n";
-                }
+                print_node_ref_list("NODES", wnl);
+                flush();
             }
 
             void relation_member_list(const osmium::RelationMemberList& rml) {
                 print_title("MEMBERS", rml);
                 for (const auto& member : rml) {
-                    *m_out << m_prefix
-                           << "  type="
-                           << item_type_to_name(member.type())
-                           << " ref="
-                           << member.ref()
-                           << " role=|"
-                           << member.role()
-                           << "|\n";
+                    m_buffer->append(m_prefix);
+                    m_buffer->append("  type=");
+                    m_buffer->append(item_type_to_name(member.type()));
+                    m_buffer->append(" ref=");
+                    append_int(member.ref());
+                    m_buffer->append(" role=|");
+                    m_buffer->append(member.role());
+                    m_buffer->append("|\n");
                     if (member.full_member()) {
-                        Dump dump(*m_out, m_with_size, m_prefix + "  | ");
+                        Dump dump{m_buffer, m_with_size, m_prefix + "  | "};
                         osmium::apply_item(member.get_object(), dump);
                     }
                 }
+                flush();
             }
 
             void outer_ring(const osmium::OuterRing& ring) {
-                print_title("OUTER RING", ring);
-                for (const auto& node_ref : ring) {
-                    *m_out << m_prefix
-                           << "  ref="
-                           << node_ref.ref();
-                    if (node_ref.location()) {
-                        *m_out << " pos="
-                               << node_ref.location();
-                    }
-                    *m_out << "\n";
-                }
+                print_node_ref_list("OUTER RING", ring);
+                flush();
             }
 
             void inner_ring(const osmium::InnerRing& ring) {
-                print_title("INNER RING", ring);
-                for (const auto& node_ref : ring) {
-                    *m_out << m_prefix
-                           << "  ref="
-                           << node_ref.ref();
-                    if (node_ref.location()) {
-                        *m_out << " pos="
-                               << node_ref.location();
-                    }
-                    *m_out << "\n";
-                }
+                print_node_ref_list("INNER RING", ring);
+                flush();
             }
 
             void node(const osmium::Node& node) {
                 print_title("NODE", node);
                 print_meta(node);
                 print_location(node);
+                flush();
             }
 
             void way(const osmium::Way& way) {
                 print_title("WAY", way);
                 print_meta(way);
+                flush();
             }
 
             void relation(const osmium::Relation& relation) {
                 print_title("RELATION", relation);
                 print_meta(relation);
+                flush();
             }
 
             void area(const osmium::Area& area) {
                 print_title("AREA", area);
                 print_meta(area);
+                flush();
             }
 
             void changeset(const osmium::Changeset& changeset) {
                 print_title("CHANGESET", changeset);
-                *m_out << m_prefix
-                       << "  id="
-                       << changeset.id()
-                       << "\n";
-                *m_out << m_prefix
-                       << "  num_changes="
-                       << changeset.num_changes()
-                       << "\n";
-                *m_out << m_prefix
-                       << "  uid="
-                       << changeset.uid()
-                       << "\n";
-                *m_out << m_prefix
-                       << "  user=|"
-                       << changeset.user()
-                       << "|\n";
-                *m_out << m_prefix
-                       << "  created_at="
-                       << changeset.created_at().to_iso()
-                       << "\n";
-                *m_out << m_prefix
-                       << "  closed_at="
-                       << changeset.closed_at().to_iso()
-                       << "\n";
-                *m_out << m_prefix
-                       << "  bounds=";
+                m_buffer->append(m_prefix);
+                m_buffer->append("  id=");
+                append_int(static_cast<int64_t>(changeset.id()));
+                m_buffer->push_back('\n');
+                m_buffer->append(m_prefix);
+                m_buffer->append("  num_changes=");
+                append_int(static_cast<int64_t>(changeset.num_changes()));
+                m_buffer->push_back('\n');
+                m_buffer->append(m_prefix);
+                m_buffer->append("  uid=");
+                append_int(static_cast<int64_t>(changeset.uid()));
+                m_buffer->push_back('\n');
+                m_buffer->append(m_prefix);
+                m_buffer->append("  user=|");
+                m_buffer->append(changeset.user());
+                m_buffer->append("|\n");
+                m_buffer->append(m_prefix);
+                m_buffer->append("  created_at=");
+                m_buffer->append(changeset.created_at().to_iso());
+                m_buffer->push_back('\n');
+                m_buffer->append(m_prefix);
+                m_buffer->append("  closed_at=");
+                m_buffer->append(changeset.closed_at().to_iso());
+                m_buffer->push_back('\n');
+                m_buffer->append(m_prefix);
+                m_buffer->append("  bounds=");
 
                 if (changeset.bounds()) {
-                    *m_out << '('
-                           << changeset.bounds().bottom_left().lon_without_check()
-                           << ','
-                           << changeset.bounds().bottom_left().lat_without_check()
-                           << ','
-                           << changeset.bounds().top_right().lon_without_check()
-                           << ','
-                           << changeset.bounds().top_right().lat_without_check()
-                           << ')';
+                    m_buffer->push_back('(');
+                    changeset.bounds().bottom_left().as_string_without_check(std::back_inserter(*m_buffer), ',');
+                    m_buffer->push_back(',');
+                    changeset.bounds().top_right().as_string_without_check(std::back_inserter(*m_buffer), ',');
+                    m_buffer->push_back(')');
                 } else {
-                    *m_out << "(undefined)";
+                    m_buffer->append("(undefined)");
                 }
 
-                *m_out << "\n";
+                m_buffer->push_back('\n');
 
-                Dump dump{*m_out, m_with_size, m_prefix + "  "};
+                Dump dump{m_buffer, m_with_size, m_prefix + "  "};
                 osmium::apply(changeset.cbegin(), changeset.cend(), dump);
+                flush();
             }
 
         }; // class Dump
@@ -132,6 +132,18 @@ namespace osmium {
                 }
             }
 
+            /**
+             * Hint that the location of the node with the given id will be
+             * looked up soon, see osmium::index::map::Map::prefetch().
+             */
+            void prefetch_node_location(const osmium::object_id_type id) const {
+                if (id >= 0) {
+                    m_storage_pos.prefetch(static_cast<osmium::unsigned_object_id_type>( id));
+                } else {
+                    m_storage_neg.prefetch(static_cast<osmium::unsigned_object_id_type>(-id));
+                }
+            }
+
             /**
              * Get location of node with given id.
              */
@@ -153,6 +165,13 @@ namespace osmium {
                     m_must_sort = false;
                     m_last_id = std::numeric_limits<osmium::unsigned_object_id_type>::max();
                 }
+                // First issue prefetches for the locations of all nodes in
+                // the way, then look them up. This overlaps the cache (and,
+                // for mmapped indexes, page) misses of the lookups instead
+                // of paying for them one after the other.
+                for (const auto& node_ref : way.nodes()) {
+                    prefetch_node_location(node_ref.ref());
+                }
                 bool error = false;
                 for (auto& node_ref : way.nodes()) {
                     node_ref.set_location(get_node_location(node_ref.ref()));
@@ -41,6 +41,8 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/way.hpp>
 
+#include <cstddef>
+
 namespace osmium {
 
     namespace handler {
@@ -56,6 +58,11 @@ namespace osmium {
 
             using index_type = osmium::index::multimap::Multimap<unsigned_object_id_type, unsigned_object_id_type>;
 
+            // ids are collected into batches of this size and inserted
+            // with one set_all() call per batch instead of one virtual
+            // set() call per id
+            enum { batch_size = 256 };
+
             index_type& m_index_n2w;
             index_type& m_index_n2r;
             index_type& m_index_w2r;
@@ -71,27 +78,63 @@ namespace osmium {
             }
 
             void way(const osmium::Way& way) {
+                unsigned_object_id_type ids[batch_size];
+                std::size_t count = 0;
                 for (const auto& node_ref : way.nodes()) {
-                    m_index_n2w.set(node_ref.positive_ref(), way.positive_id());
+                    ids[count++] = node_ref.positive_ref();
+                    if (count == batch_size) {
+                        m_index_n2w.set_all(ids, count, way.positive_id());
+                        count = 0;
+                    }
+                }
+                if (count > 0) {
+                    m_index_n2w.set_all(ids, count, way.positive_id());
                 }
             }
 
             void relation(const osmium::Relation& relation) {
+                unsigned_object_id_type node_ids[batch_size];
+                unsigned_object_id_type way_ids[batch_size];
+                unsigned_object_id_type relation_ids[batch_size];
+                std::size_t node_count = 0;
+                std::size_t way_count = 0;
+                std::size_t relation_count = 0;
                 for (const auto& member : relation.members()) {
                     switch (member.type()) {
                         case osmium::item_type::node:
-                            m_index_n2r.set(member.positive_ref(), relation.positive_id());
+                            node_ids[node_count++] = member.positive_ref();
+                            if (node_count == batch_size) {
+                                m_index_n2r.set_all(node_ids, node_count, relation.positive_id());
+                                node_count = 0;
+                            }
                             break;
                         case osmium::item_type::way:
-                            m_index_w2r.set(member.positive_ref(), relation.positive_id());
+                            way_ids[way_count++] = member.positive_ref();
+                            if (way_count == batch_size) {
+                                m_index_w2r.set_all(way_ids, way_count, relation.positive_id());
+                                way_count = 0;
+                            }
                             break;
                         case osmium::item_type::relation:
-                            m_index_r2r.set(member.positive_ref(), relation.positive_id());
+                            relation_ids[relation_count++] = member.positive_ref();
+                            if (relation_count == batch_size) {
+                                m_index_r2r.set_all(relation_ids, relation_count, relation.positive_id());
+                                relation_count = 0;
+                            }
                             break;
                         default:
                             break;
                     }
                 }
+                if (node_count > 0) {
+                    m_index_n2r.set_all(node_ids, node_count, relation.positive_id());
+                }
+                if (way_count > 0) {
+                    m_index_w2r.set_all(way_ids, way_count, relation.positive_id());
+                }
+                if (relation_count > 0) {
+                    m_index_r2r.set_all(relation_ids, relation_count, relation.positive_id());
+                }
             }
 
         }; // class ObjectRelations
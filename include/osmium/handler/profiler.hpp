@@ -0,0 +1,233 @@
+#ifndef OSMIUM_HANDLER_PROFILER_HPP
+#define OSMIUM_HANDLER_PROFILER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/handler.hpp>
+#include <osmium/util/verbose_output.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+namespace osmium {
+
+    class Node;
+    class Way;
+    class Relation;
+    class Area;
+    class Changeset;
+
+    namespace handler {
+
+        /**
+         * Wraps any handler and measures the time spent in each of its
+         * callbacks. Use this to find out which handler in an
+         * osmium::apply() chain is the slow one without taking the
+         * pipeline apart:
+         *
+         * @code
+         * MyHandler handler;
+         * osmium::handler::Profiler<MyHandler> profiler{handler};
+         * osmium::apply(reader, profiler);
+         * osmium::util::VerboseOutput vout{true};
+         * profiler.report(vout, "my_handler");
+         * @endcode
+         *
+         * For every callback (node, way, relation, area, changeset,
+         * flush) the number of calls, the total and maximum time, and a
+         * histogram with power-of-two nanosecond buckets are collected.
+         * The per-call overhead is one steady_clock reading before and
+         * after the wrapped callback, cheap enough for production use,
+         * but don't expect single nanoseconds in the histogram to be
+         * meaningful.
+         */
+        template <typename THandler>
+        class Profiler : public osmium::handler::Handler {
+
+        public:
+
+            /**
+             * Timing data for one callback. Times are in nanoseconds.
+             */
+            struct timings {
+
+                /// number of histogram buckets, bucket n counts calls taking [2^n, 2^(n+1)) nanoseconds
+                enum { num_buckets = 32 };
+
+                uint64_t count = 0;
+                uint64_t total = 0;
+                uint64_t max = 0;
+                uint64_t histogram[num_buckets] = {};
+
+                void add(const uint64_t nsec) noexcept {
+                    ++count;
+                    total += nsec;
+                    if (nsec > max) {
+                        max = nsec;
+                    }
+                    unsigned int bucket = 0;
+                    uint64_t n = nsec;
+                    while (n > 1 && bucket < static_cast<unsigned int>(num_buckets) - 1) {
+                        n >>= 1U;
+                        ++bucket;
+                    }
+                    ++histogram[bucket];
+                }
+
+                /// mean time per call in nanoseconds
+                double mean() const noexcept {
+                    return count == 0 ? 0.0 : static_cast<double>(total) / static_cast<double>(count);
+                }
+
+            }; // struct timings
+
+        private:
+
+            using clock_type = std::chrono::steady_clock;
+
+            THandler& m_handler;
+
+            timings m_node_timings{};
+            timings m_way_timings{};
+            timings m_relation_timings{};
+            timings m_area_timings{};
+            timings m_changeset_timings{};
+            timings m_flush_timings{};
+
+            static uint64_t elapsed(const clock_type::time_point start) noexcept {
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count());
+            }
+
+            static void report_one(osmium::util::VerboseOutput& out, const char* name, const timings& t) {
+                if (t.count == 0) {
+                    return;
+                }
+                out << "    " << name << ": "
+                    << t.count << " calls, "
+                    << (t.total / 1000000) << " ms total, "
+                    << static_cast<uint64_t>(t.mean()) << " ns mean, "
+                    << t.max << " ns max\n";
+            }
+
+        public:
+
+            explicit Profiler(THandler& handler) noexcept :
+                m_handler(handler) {
+            }
+
+            void node(const osmium::Node& node) {
+                const auto start = clock_type::now();
+                m_handler.node(node);
+                m_node_timings.add(elapsed(start));
+            }
+
+            void way(const osmium::Way& way) {
+                const auto start = clock_type::now();
+                m_handler.way(way);
+                m_way_timings.add(elapsed(start));
+            }
+
+            void relation(const osmium::Relation& relation) {
+                const auto start = clock_type::now();
+                m_handler.relation(relation);
+                m_relation_timings.add(elapsed(start));
+            }
+
+            void area(const osmium::Area& area) {
+                const auto start = clock_type::now();
+                m_handler.area(area);
+                m_area_timings.add(elapsed(start));
+            }
+
+            void changeset(const osmium::Changeset& changeset) {
+                const auto start = clock_type::now();
+                m_handler.changeset(changeset);
+                m_changeset_timings.add(elapsed(start));
+            }
+
+            void flush() {
+                const auto start = clock_type::now();
+                m_handler.flush();
+                m_flush_timings.add(elapsed(start));
+            }
+
+            const timings& node_timings() const noexcept {
+                return m_node_timings;
+            }
+
+            const timings& way_timings() const noexcept {
+                return m_way_timings;
+            }
+
+            const timings& relation_timings() const noexcept {
+                return m_relation_timings;
+            }
+
+            const timings& area_timings() const noexcept {
+                return m_area_timings;
+            }
+
+            const timings& changeset_timings() const noexcept {
+                return m_changeset_timings;
+            }
+
+            const timings& flush_timings() const noexcept {
+                return m_flush_timings;
+            }
+
+            /**
+             * Write a summary of the collected timings to the given
+             * VerboseOutput. Callbacks that were never called are left
+             * out.
+             *
+             * @param out  Where to write the report.
+             * @param name Name of the profiled handler used in the
+             *             report, for telling several profilers apart.
+             */
+            void report(osmium::util::VerboseOutput& out, const char* name = "handler") const {
+                out << "profile for " << name << ":\n";
+                report_one(out, "node", m_node_timings);
+                report_one(out, "way", m_way_timings);
+                report_one(out, "relation", m_relation_timings);
+                report_one(out, "area", m_area_timings);
+                report_one(out, "changeset", m_changeset_timings);
+                report_one(out, "flush", m_flush_timings);
+            }
+
+        }; // class Profiler
+
+    } // namespace handler
+
+} // namespace osmium
+
+#endif // OSMIUM_HANDLER_PROFILER_HPP
@@ -0,0 +1,134 @@
+#ifndef OSMIUM_INDEX_DETAIL_ID_FILTER_HPP
+#define OSMIUM_INDEX_DETAIL_ID_FILTER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace osmium {
+
+    namespace detail {
+
+        /**
+         * A small bloom filter over ids. With the 8 bits per element it
+         * allocates and its two probes it answers "is this id possibly
+         * in the set?" with about 5% false positives, but never wrongly
+         * says no. Put one in front of a lookup structure with expensive
+         * misses, such as an index backed by a file, and most lookups of
+         * absent ids never touch the structure at all.
+         *
+         * A default constructed filter is empty and may_contain() then
+         * answers yes for every id.
+         */
+        class IdFilter {
+
+            std::vector<std::uint64_t> m_bits{};
+            std::uint64_t m_mask = 0;
+
+            // Mixing function from the splitmix64 generator.
+            static std::uint64_t hash(std::uint64_t id) noexcept {
+                id += 0x9e3779b97f4a7c15ULL;
+                id = (id ^ (id >> 30u)) * 0xbf58476d1ce4e5b9ULL;
+                id = (id ^ (id >> 27u)) * 0x94d049bb133111ebULL;
+                return id ^ (id >> 31u);
+            }
+
+            void set_bit(const std::uint64_t bit) noexcept {
+                m_bits[(bit & m_mask) >> 6u] |= 1ULL << (bit & 0x3fu);
+            }
+
+            bool get_bit(const std::uint64_t bit) const noexcept {
+                return (m_bits[(bit & m_mask) >> 6u] & (1ULL << (bit & 0x3fu))) != 0;
+            }
+
+        public:
+
+            IdFilter() = default;
+
+            /**
+             * Prepare the filter for the given number of ids, allocating
+             * 8 bits per id. Any previous contents are thrown away.
+             */
+            void init(const std::size_t count) {
+                std::uint64_t num_bits = 1024;
+                while (num_bits < count * 8) {
+                    num_bits *= 2;
+                }
+                m_mask = num_bits - 1;
+                m_bits.assign(static_cast<std::size_t>(num_bits >> 6u), 0);
+            }
+
+            /// Is this filter empty (ie letting every id through)?
+            bool empty() const noexcept {
+                return m_bits.empty();
+            }
+
+            /// Make the filter empty, freeing its memory.
+            void clear() {
+                m_bits.clear();
+                m_bits.shrink_to_fit();
+                m_mask = 0;
+            }
+
+            /// The memory used by the filter in bytes.
+            std::size_t used_memory() const noexcept {
+                return m_bits.size() * sizeof(std::uint64_t);
+            }
+
+            void add(const std::uint64_t id) noexcept {
+                const std::uint64_t h = hash(id);
+                set_bit(h);
+                set_bit(h >> 32u);
+            }
+
+            /**
+             * Might this id be in the set? A false answer is definitive,
+             * a true answer means the id was probably added before.
+             */
+            bool may_contain(const std::uint64_t id) const noexcept {
+                if (empty()) {
+                    return true;
+                }
+                const std::uint64_t h = hash(id);
+                return get_bit(h) && get_bit(h >> 32u);
+            }
+
+        }; // class IdFilter
+
+    } // namespace detail
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_DETAIL_ID_FILTER_HPP
@@ -34,6 +34,7 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/index/index.hpp>
+#include <osmium/util/config.hpp>
 #include <osmium/util/memory_mapping.hpp>
 
 #include <algorithm>
@@ -63,18 +64,27 @@ namespace osmium {
             std::size_t m_size = 0;
             osmium::TypedMemoryMapping<T> m_mapping;
 
+            // Best effort, see osmium::config::use_index_hugepages().
+            void advise_hugepages_if_configured() noexcept {
+                if (osmium::config::use_index_hugepages()) {
+                    m_mapping.advise_huge_pages();
+                }
+            }
+
         public:
 
             mmap_vector_base(const int fd, const std::size_t capacity, const std::size_t size = 0) :
                 m_size(size),
                 m_mapping(capacity, osmium::MemoryMapping::mapping_mode::write_shared, fd) {
                 assert(size <= capacity);
+                advise_hugepages_if_configured();
                 std::fill(data() + size, data() + capacity, osmium::index::empty_value<T>());
                 shrink_to_fit();
             }
 
             explicit mmap_vector_base(const std::size_t capacity = mmap_vector_size_increment) :
                 m_mapping(capacity) {
+                advise_hugepages_if_configured();
                 std::fill_n(data(), capacity, osmium::index::empty_value<T>());
             }
 
@@ -90,6 +100,26 @@ namespace osmium {
                 m_mapping.unmap();
             }
 
+            /**
+             * Tell the kernel how the memory behind this vector will be
+             * accessed, see osmium::MemoryMapping::advise(). Use this
+             * with osmium::MemoryMapping::advice::random before doing
+             * random lookups in a file-backed index.
+             */
+            bool advise(osmium::MemoryMapping::advice hint) noexcept {
+                return m_mapping.advise(hint);
+            }
+
+            /**
+             * Fault in all pages of the memory behind this vector, see
+             * osmium::MemoryMapping::populate(). Pre-faulting a
+             * file-backed index turns many scattered page faults during
+             * lookups into one sequential read.
+             */
+            void populate() const noexcept {
+                m_mapping.populate();
+            }
+
             std::size_t capacity() const noexcept {
                 return m_mapping.size();
             }
@@ -146,6 +176,7 @@ namespace osmium {
                 if (new_capacity > capacity()) {
                     const std::size_t old_capacity = capacity();
                     m_mapping.resize(new_capacity);
+                    advise_hugepages_if_configured();
                     std::fill(data() + old_capacity, data() + new_capacity, osmium::index::empty_value<value_type>());
                 }
             }
@@ -0,0 +1,125 @@
+#ifndef OSMIUM_INDEX_DETAIL_PARALLEL_SORT_HPP
+#define OSMIUM_INDEX_DETAIL_PARALLEL_SORT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <iterator>
+#include <vector>
+
+namespace osmium {
+
+    namespace detail {
+
+        /**
+         * Sort the range [begin, end) using the given thread pool. The
+         * range is split into one chunk per worker thread, the chunks are
+         * sorted concurrently and then merged pairwise, with the merges
+         * of each round also running concurrently. Small ranges are
+         * sorted directly without going through the pool.
+         */
+        template <typename TIterator>
+        void parallel_sort(osmium::thread::Pool& pool, TIterator begin, TIterator end) {
+            // Under this size a single-threaded sort is faster than
+            // paying the task and merge overhead.
+            enum : std::size_t {
+                min_parallel_sort_size = 64ul * 1024ul
+            };
+
+            const std::size_t size = static_cast<std::size_t>(std::distance(begin, end));
+            if (size < min_parallel_sort_size || pool.num_threads() < 2) {
+                std::sort(begin, end);
+                return;
+            }
+
+            // Pairwise merging needs a power-of-two number of chunks.
+            std::size_t num_chunks = 1;
+            while (num_chunks < static_cast<std::size_t>(pool.num_threads())) {
+                num_chunks *= 2;
+            }
+
+            std::vector<TIterator> bounds;
+            bounds.reserve(num_chunks + 1);
+            for (std::size_t i = 0; i <= num_chunks; ++i) {
+                bounds.push_back(begin + static_cast<typename std::iterator_traits<TIterator>::difference_type>(size * i / num_chunks));
+            }
+
+            struct sort_task {
+                TIterator begin;
+                TIterator end;
+
+                void operator()() const {
+                    std::sort(begin, end);
+                }
+            }; // struct sort_task
+
+            struct merge_task {
+                TIterator begin;
+                TIterator middle;
+                TIterator end;
+
+                void operator()() const {
+                    std::inplace_merge(begin, middle, end);
+                }
+            }; // struct merge_task
+
+            std::vector<std::future<void>> results;
+            results.reserve(num_chunks);
+            for (std::size_t i = 0; i < num_chunks; ++i) {
+                results.push_back(pool.submit(sort_task{bounds[i], bounds[i + 1]}));
+            }
+            for (auto& result : results) {
+                result.get();
+            }
+
+            for (std::size_t width = 1; width < num_chunks; width *= 2) {
+                results.clear();
+                for (std::size_t i = 0; i + width < num_chunks; i += 2 * width) {
+                    const std::size_t last = std::min(i + 2 * width, num_chunks);
+                    results.push_back(pool.submit(merge_task{bounds[i], bounds[i + width], bounds[last]}));
+                }
+                for (auto& result : results) {
+                    result.get();
+                }
+            }
+        }
+
+    } // namespace detail
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_DETAIL_PARALLEL_SORT_HPP
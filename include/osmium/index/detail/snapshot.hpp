@@ -0,0 +1,143 @@
+#ifndef OSMIUM_INDEX_DETAIL_SNAPSHOT_HPP
+#define OSMIUM_INDEX_DETAIL_SNAPSHOT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/detail/read_write.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            /**
+             * Helpers for writing and reading index snapshot files as
+             * created by the dump_to_file()/load_from_file() functions of
+             * the in-memory indexes. A snapshot file is a fixed-size
+             * header followed by raw fixed-size records, so the payload
+             * of a dense snapshot can be mmap()ed directly at offset
+             * sizeof(snapshot_header).
+             */
+
+            /// The kind of index data stored in a snapshot file.
+            enum class snapshot_kind : uint32_t {
+                dense       = 1,
+                sparse      = 2,
+                flex_sparse = 3,
+                flex_dense  = 4
+            }; // enum class snapshot_kind
+
+            struct snapshot_header {
+                char magic[8];
+                uint32_t version;
+                uint32_t kind;
+                uint64_t entry_size;
+                uint64_t entry_count;
+            }; // struct snapshot_header
+
+            constexpr const char snapshot_magic[8] = {'O', 'S', 'M', 'I', 'D', 'X', 'S', 'N'};
+
+            enum {
+                snapshot_version = 1
+            };
+
+            inline void write_snapshot_header(const int fd, const snapshot_kind kind, const uint64_t entry_size, const uint64_t entry_count) {
+                snapshot_header header{};
+                std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+                header.version     = snapshot_version;
+                header.kind        = static_cast<uint32_t>(kind);
+                header.entry_size  = entry_size;
+                header.entry_count = entry_count;
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&header), sizeof(header));
+            }
+
+            /**
+             * Read from the file until the buffer is full. Throws
+             * std::runtime_error if the file ends before that.
+             */
+            inline void read_exactly(const int fd, char* buffer, uint64_t size) {
+                while (size > 0) {
+                    const auto chunk = static_cast<unsigned int>(size > (1u << 30u) ? (1u << 30u) : size);
+                    const auto nread = osmium::io::detail::reliable_read(fd, buffer, chunk);
+                    if (nread == 0) {
+                        throw std::runtime_error{"index snapshot file is truncated"};
+                    }
+                    buffer += nread;
+                    size -= static_cast<uint64_t>(nread);
+                }
+            }
+
+            /**
+             * Read the header of a snapshot file, checking magic bytes
+             * and version. Throws std::runtime_error if this is not a
+             * snapshot file or the version is not understood.
+             */
+            inline snapshot_header read_snapshot_header(const int fd) {
+                snapshot_header header{};
+                read_exactly(fd, reinterpret_cast<char*>(&header), sizeof(header));
+                if (std::memcmp(header.magic, snapshot_magic, sizeof(header.magic)) != 0) {
+                    throw std::runtime_error{"not an index snapshot file"};
+                }
+                if (header.version != snapshot_version) {
+                    throw std::runtime_error{"unknown index snapshot file version"};
+                }
+                return header;
+            }
+
+            /**
+             * Check that a snapshot header describes the kind of index
+             * and entry size the caller expects. Throws
+             * std::runtime_error if not, for instance when a snapshot is
+             * loaded into a different index type than it was dumped from.
+             */
+            inline void check_snapshot_header(const snapshot_header& header, const snapshot_kind kind, const uint64_t entry_size) {
+                if (header.kind != static_cast<uint32_t>(kind)) {
+                    throw std::runtime_error{"index snapshot file contains a different kind of index"};
+                }
+                if (header.entry_size != entry_size) {
+                    throw std::runtime_error{"index snapshot file has wrong entry size"};
+                }
+            }
+
+        } // namespace detail
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_DETAIL_SNAPSHOT_HPP
@@ -33,26 +33,105 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/util/config.hpp>
+
 #include <cerrno>
+#include <cstddef>
 #include <cstdio>
+#include <string>
 #include <system_error>
 
+#ifndef _MSC_VER
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
 namespace osmium {
 
     namespace detail {
 
+        /**
+         * Preallocate disk space for the file behind the given file
+         * descriptor without changing the file size. Best effort: on
+         * systems without a suitable fallocate this does nothing.
+         *
+         * @returns True if the preallocation worked.
+         */
+        inline bool preallocate_tmp_file(const int fd, const std::size_t size) {
+#ifdef __linux__
+            return size > 0 && ::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size)) == 0;
+#else
+            (void)fd;
+            (void)size;
+            return false;
+#endif
+        }
+
+        /**
+         * Create and open a temporary file in the given directory. The
+         * file has no name (O_TMPFILE) or is removed after opening, so
+         * it disappears when the file descriptor is closed.
+         *
+         * Use this (or the OSMIUM_TMPDIR environment variable picked up
+         * by the overload without arguments) to put the files backing
+         * the file-based indexes on fast scratch storage instead of the
+         * system default temporary directory.
+         *
+         * @returns File descriptor of temporary file.
+         * @throws std::system_error if something went wrong.
+         */
+#ifndef _MSC_VER
+        inline int create_tmp_file(const std::string& directory) {
+# ifdef O_TMPFILE
+            const int fd = ::open(directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600); // NOLINT(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+            if (fd >= 0) {
+                return fd;
+            }
+            // Fall through to mkstemp() if the filesystem doesn't
+            // support O_TMPFILE.
+# endif
+            std::string name{directory + "/osmium_tmpfile_XXXXXX"};
+            const int fd2 = ::mkstemp(&*name.begin());
+            if (fd2 < 0) {
+                throw std::system_error{errno, std::system_category(), "creating temporary file in '" + directory + "' failed"};
+            }
+            ::unlink(name.c_str());
+            return fd2;
+        }
+#endif
+
         /**
          * Create and open a temporary file. It is removed after opening.
+         * The file is created in the directory named in the OSMIUM_TMPDIR
+         * environment variable, or in the system default temporary
+         * directory if that is not set. If OSMIUM_TMPFILE_PREALLOCATE is
+         * set, that many bytes of disk space are preallocated (best
+         * effort).
          *
          * @returns File descriptor of temporary file.
          * @throws std::system_error if something went wrong.
          */
         inline int create_tmp_file() {
-            FILE* file = ::tmpfile();
-            if (!file) {
-                throw std::system_error{errno, std::system_category(), "tempfile failed"};
+            int fd = -1;
+
+#ifndef _MSC_VER
+            const std::string directory{osmium::config::get_tmpdir()};
+            if (!directory.empty()) {
+                fd = create_tmp_file(directory);
+            }
+#endif
+
+            if (fd < 0) {
+                FILE* file = ::tmpfile();
+                if (!file) {
+                    throw std::system_error{errno, std::system_category(), "tempfile failed"};
+                }
+                fd = fileno(file);
             }
-            return fileno(file);
+
+            preallocate_tmp_file(fd, osmium::config::get_tmpfile_preallocation());
+
+            return fd;
         }
 
     } // namespace detail
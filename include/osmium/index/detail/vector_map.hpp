@@ -33,14 +33,24 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/detail/id_filter.hpp>
+#include <osmium/index/detail/parallel_sort.hpp>
+#include <osmium/index/detail/snapshot.hpp>
+#include <osmium/index/detail/tmpfile.hpp>
 #include <osmium/index/index.hpp>
 #include <osmium/index/map.hpp>
 #include <osmium/io/detail/read_write.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/misc.hpp>
+#include <osmium/util/profiling.hpp>
 
 #include <algorithm>
+#include <cassert>
 #include <cstddef>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 
 namespace osmium {
@@ -54,8 +64,17 @@ namespace osmium {
 
                 TVector m_vector;
 
+                // Writes not yet applied to the vector, see
+                // enable_write_batching().
+                std::vector<std::pair<TId, TValue>> m_pending{};
+                std::size_t m_max_pending = 0;
+
             public:
 
+                enum : std::size_t {
+                    default_write_batch_size = 1024ul * 1024ul
+                };
+
                 using element_type   = TValue;
                 using vector_type    = TVector;
                 using iterator       = typename vector_type::iterator;
@@ -74,30 +93,127 @@ namespace osmium {
                 }
 
                 void set(const TId id, const TValue value) final {
+                    if (m_max_pending != 0) {
+                        m_pending.emplace_back(id, value);
+                        if (m_pending.size() >= m_max_pending) {
+                            flush_writes();
+                        }
+                        return;
+                    }
                     if (size() <= id) {
                         m_vector.resize(id+1);
                     }
                     m_vector[id] = value;
                 }
 
+                /**
+                 * Enable write-combining for set() calls: writes are
+                 * collected in memory and applied to the underlying array
+                 * in batches sorted by id. For file-backed arrays this
+                 * turns the random single-value writes of an unsorted
+                 * input into mostly sequential bursts which are much
+                 * friendlier to the page cache and the disk underneath.
+                 *
+                 * Pending writes are not visible to lookups: call
+                 * flush_writes() (sort() does it, too) after the last
+                 * set() call and before the first lookup.
+                 *
+                 * @param batch_size Number of writes collected before
+                 *        they are applied automatically.
+                 */
+                void enable_write_batching(const std::size_t batch_size = default_write_batch_size) {
+                    assert(batch_size > 0);
+                    m_max_pending = batch_size;
+                    m_pending.reserve(batch_size);
+                }
+
+                /**
+                 * Apply all pending writes collected since the last flush
+                 * to the underlying array, in id order. Called
+                 * automatically whenever the batch is full.
+                 */
+                void flush_writes() {
+                    if (m_pending.empty()) {
+                        return;
+                    }
+                    // Stable sort so that several writes to the same id
+                    // are applied in set() call order and the last one
+                    // wins.
+                    std::stable_sort(m_pending.begin(), m_pending.end(), [](const std::pair<TId, TValue>& lhs, const std::pair<TId, TValue>& rhs) {
+                        return lhs.first < rhs.first;
+                    });
+                    const TId max_id = m_pending.back().first;
+                    if (size() <= max_id) {
+                        m_vector.resize(max_id + 1);
+                    }
+                    for (const auto& write : m_pending) {
+                        m_vector[write.first] = write.second;
+                    }
+                    m_pending.clear();
+                }
+
+                void sort() final {
+                    flush_writes();
+                }
+
+                /**
+                 * Grow the index to the given number of entries, filling
+                 * new entries with the empty value. Call this with a size
+                 * larger than the largest id you are going to set before
+                 * using set_concurrent().
+                 */
+                void resize(const std::size_t size) {
+                    if (size > m_vector.size()) {
+                        m_vector.resize(size);
+                    }
+                }
+
+                /**
+                 * Set the field with the given id to the given value, like
+                 * set(). Unlike set() this may be called from several
+                 * threads at the same time as long as no two threads write
+                 * to the same id and nobody reads the index concurrently.
+                 * Every id writes to its own slot in the underlying array,
+                 * so the writes are disjoint in memory.
+                 *
+                 * @pre The index must have been grown with resize() beyond
+                 *      the largest id that will be set, this function never
+                 *      resizes.
+                 */
+                void set_concurrent(const TId id, const TValue value) noexcept {
+                    assert(id < m_vector.size() && "Call resize() before set_concurrent()");
+                    m_vector[id] = value;
+                }
+
                 TValue get(const TId id) const final {
+                    assert(m_pending.empty() && "Call flush_writes() after the last set() and before the first lookup");
+                    OSMIUM_PROFILE_COUNT(index_probes);
                     if (id >= m_vector.size()) {
+                        OSMIUM_PROFILE_COUNT(index_misses);
                         throw osmium::not_found{id};
                     }
                     const TValue value = m_vector[id];
                     if (value == osmium::index::empty_value<TValue>()) {
+                        OSMIUM_PROFILE_COUNT(index_misses);
                         throw osmium::not_found{id};
                     }
                     return value;
                 }
 
                 TValue get_noexcept(const TId id) const noexcept final {
+                    assert(m_pending.empty() && "Call flush_writes() after the last set() and before the first lookup");
                     if (id >= m_vector.size()) {
                         return osmium::index::empty_value<TValue>();
                     }
                     return m_vector[id];
                 }
 
+                void prefetch(const TId id) const noexcept final {
+                    if (id < m_vector.size()) {
+                        osmium::detail::prefetch_read(&m_vector[id]);
+                    }
+                }
+
                 std::size_t size() const final {
                     return m_vector.size();
                 }
@@ -107,18 +223,52 @@ namespace osmium {
                 }
 
                 std::size_t used_memory() const final {
-                    return sizeof(TValue) * size();
+                    return sizeof(TValue) * size() +
+                           sizeof(std::pair<TId, TValue>) * m_pending.capacity();
                 }
 
                 void clear() final {
                     m_vector.clear();
                     m_vector.shrink_to_fit();
+                    m_pending.clear();
+                    m_pending.shrink_to_fit();
                 }
 
                 void dump_as_array(const int fd) final {
+                    flush_writes();
                     osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(m_vector.data()), byte_size());
                 }
 
+                /**
+                 * Write the contents of the index to a snapshot file from
+                 * which load_from_file() can restore it later, much faster
+                 * than rebuilding the index from the input data. The file
+                 * starts with a versioned header followed by the raw array.
+                 */
+                void dump_to_file(const std::string& filename) const {
+                    assert(m_pending.empty() && "Call flush_writes() before dump_to_file()");
+                    const int fd = osmium::io::detail::open_for_writing(filename, osmium::io::overwrite::allow);
+                    osmium::index::detail::write_snapshot_header(fd, osmium::index::detail::snapshot_kind::dense, sizeof(element_type), m_vector.size());
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(m_vector.data()), byte_size());
+                    osmium::io::detail::reliable_close(fd);
+                }
+
+                /**
+                 * Replace the contents of the index with those of a
+                 * snapshot file written by dump_to_file(). Throws
+                 * std::runtime_error if the file is not a snapshot of a
+                 * matching index.
+                 */
+                void load_from_file(const std::string& filename) {
+                    const int fd = osmium::io::detail::open_for_reading(filename);
+                    const auto header = osmium::index::detail::read_snapshot_header(fd);
+                    osmium::index::detail::check_snapshot_header(header, osmium::index::detail::snapshot_kind::dense, sizeof(element_type));
+                    m_vector.clear();
+                    m_vector.resize(header.entry_count);
+                    osmium::index::detail::read_exactly(fd, reinterpret_cast<char*>(m_vector.data()), header.entry_count * sizeof(element_type));
+                    osmium::io::detail::reliable_close(fd);
+                }
+
                 iterator begin() {
                     return m_vector.begin();
                 }
@@ -160,6 +310,10 @@ namespace osmium {
 
                 vector_type m_vector;
 
+                // Optional bloom filter rejecting absent ids before the
+                // binary search, see build_id_filter().
+                osmium::detail::IdFilter m_filter;
+
                 typename vector_type::const_iterator find_id(const TId id) const noexcept {
                     const element_type element {
                         id,
@@ -181,12 +335,41 @@ namespace osmium {
                 }
 
                 void set(const TId id, const TValue value) final {
+                    if (!m_filter.empty()) {
+                        m_filter.clear();
+                    }
                     m_vector.push_back(element_type(id, value));
                 }
 
+                /**
+                 * Build an in-memory bloom filter over all ids in the
+                 * index. Lookups of absent ids are then usually answered
+                 * from the filter without doing the binary search, which
+                 * is a big win for file-backed indexes where every probe
+                 * of the search can fault in a page. Useful when
+                 * processing extracts, where ways reference many nodes
+                 * outside the extract.
+                 *
+                 * Call this after sort(). The filter costs one byte of
+                 * memory per id and is thrown away again when more data
+                 * is added to the index.
+                 */
+                void build_id_filter() {
+                    m_filter.init(m_vector.size());
+                    for (const auto& element : m_vector) {
+                        m_filter.add(element.first);
+                    }
+                }
+
                 TValue get(const TId id) const final {
+                    OSMIUM_PROFILE_COUNT(index_probes);
+                    if (!m_filter.may_contain(id)) {
+                        OSMIUM_PROFILE_COUNT(index_misses);
+                        throw osmium::not_found{id};
+                    }
                     const auto result = find_id(id);
                     if (result == m_vector.end() || result->first != id) {
+                        OSMIUM_PROFILE_COUNT(index_misses);
                         throw osmium::not_found{id};
                     }
 
@@ -194,6 +377,9 @@ namespace osmium {
                 }
 
                 TValue get_noexcept(const TId id) const noexcept final {
+                    if (!m_filter.may_contain(id)) {
+                        return osmium::index::empty_value<TValue>();
+                    }
                     const auto result = find_id(id);
                     if (result == m_vector.end() || result->first != id) {
                         return osmium::index::empty_value<TValue>();
@@ -211,18 +397,113 @@ namespace osmium {
                 }
 
                 std::size_t used_memory() const final {
-                    return sizeof(element_type) * size();
+                    return sizeof(element_type) * size() + m_filter.used_memory();
                 }
 
                 void clear() final {
                     m_vector.clear();
                     m_vector.shrink_to_fit();
+                    m_filter.clear();
                 }
 
                 void sort() final {
                     std::sort(m_vector.begin(), m_vector.end());
                 }
 
+                /**
+                 * Like sort(), but sorts chunks of the data concurrently
+                 * on the given thread pool and then merges them. Much
+                 * faster for the billions of entries a planet-size index
+                 * contains.
+                 */
+                void sort(osmium::thread::Pool& pool) {
+                    osmium::detail::parallel_sort(pool, m_vector.begin(), m_vector.end());
+                }
+
+                /**
+                 * Sort the entries in the index like sort(), but with
+                 * bounded memory use: the data is sorted in runs that fit
+                 * into the given amount of memory and the sorted runs are
+                 * then k-way merged through a temporary file back into
+                 * the index. Use this for file-backed indexes larger than
+                 * RAM where sorting in place would thrash the page cache.
+                 *
+                 * @param max_memory Approximate amount of memory to use
+                 *        for sorting the runs, in bytes. The merge needs
+                 *        only small sequential buffers on top of this.
+                 */
+                void sort_external(const std::size_t max_memory) {
+                    const std::size_t run_size = std::max<std::size_t>(max_memory / sizeof(element_type), 1);
+                    if (run_size >= m_vector.size()) {
+                        sort();
+                        return;
+                    }
+
+                    // Sort runs of run_size entries in place. Each sort
+                    // only touches a window of max_memory bytes, so its
+                    // pages stay resident while it runs.
+                    for (std::size_t offset = 0; offset < m_vector.size(); offset += run_size) {
+                        const auto first = m_vector.begin() + static_cast<std::ptrdiff_t>(offset);
+                        const auto last = m_vector.begin() + static_cast<std::ptrdiff_t>(std::min(offset + run_size, m_vector.size()));
+                        std::sort(first, last);
+                    }
+
+                    // Merge all runs into a temporary file. Every run is
+                    // read strictly sequentially and the output is written
+                    // sequentially, so no part of the index is accessed
+                    // randomly any more.
+                    struct run_cursor {
+                        const element_type* it;
+                        const element_type* last;
+                    };
+
+                    std::vector<run_cursor> runs;
+                    runs.reserve(m_vector.size() / run_size + 1);
+                    for (std::size_t offset = 0; offset < m_vector.size(); offset += run_size) {
+                        const auto* first = m_vector.data() + offset;
+                        const auto* last = m_vector.data() + std::min(offset + run_size, m_vector.size());
+                        runs.push_back(run_cursor{first, last});
+                    }
+
+                    const auto greater = [](const run_cursor& lhs, const run_cursor& rhs) {
+                        return *rhs.it < *lhs.it;
+                    };
+
+                    const int fd = osmium::detail::create_tmp_file();
+                    constexpr const std::size_t output_buffer_size = (1024ul * 1024ul) / sizeof(element_type);
+                    std::vector<element_type> output_buffer;
+                    output_buffer.reserve(output_buffer_size);
+
+                    std::make_heap(runs.begin(), runs.end(), greater);
+                    while (!runs.empty()) {
+                        std::pop_heap(runs.begin(), runs.end(), greater);
+                        auto& run = runs.back();
+                        output_buffer.push_back(*run.it++);
+                        if (run.it == run.last) {
+                            runs.pop_back();
+                        } else {
+                            std::push_heap(runs.begin(), runs.end(), greater);
+                        }
+                        if (output_buffer.size() == output_buffer_size) {
+                            osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(output_buffer.data()), output_buffer.size() * sizeof(element_type));
+                            output_buffer.clear();
+                        }
+                    }
+                    if (!output_buffer.empty()) {
+                        osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(output_buffer.data()), output_buffer.size() * sizeof(element_type));
+                    }
+
+                    // Copy the merged data sequentially back into the
+                    // index and throw the temporary file away.
+#ifdef _MSC_VER
+                    _lseeki64(fd, 0, SEEK_SET);
+#else
+                    ::lseek(fd, 0, SEEK_SET);
+#endif
+                    osmium::index::detail::read_exactly(fd, reinterpret_cast<char*>(m_vector.data()), byte_size());
+                    osmium::io::detail::reliable_close(fd);
+                }
+
                 void dump_as_array(const int fd) final {
                     constexpr const size_t value_size = sizeof(TValue);
                     constexpr const size_t buffer_size = (10L * 1024L * 1024L) / value_size;
@@ -247,6 +528,38 @@ namespace osmium {
                     osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(m_vector.data()), byte_size());
                 }
 
+                /**
+                 * Write the contents of the index to a snapshot file from
+                 * which load_from_file() can restore it later, much faster
+                 * than rebuilding the index from the input data. Call this
+                 * after sort() so the snapshot loads ready for lookups.
+                 */
+                void dump_to_file(const std::string& filename) const {
+                    const int fd = osmium::io::detail::open_for_writing(filename, osmium::io::overwrite::allow);
+                    osmium::index::detail::write_snapshot_header(fd, osmium::index::detail::snapshot_kind::sparse, sizeof(element_type), m_vector.size());
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(m_vector.data()), byte_size());
+                    osmium::io::detail::reliable_close(fd);
+                }
+
+                /**
+                 * Replace the contents of the index with those of a
+                 * snapshot file written by dump_to_file(). Throws
+                 * std::runtime_error if the file is not a snapshot of a
+                 * matching index. The entries keep the order they were
+                 * dumped in; the id filter is not restored, call
+                 * build_id_filter() again if you need it.
+                 */
+                void load_from_file(const std::string& filename) {
+                    const int fd = osmium::io::detail::open_for_reading(filename);
+                    const auto header = osmium::index::detail::read_snapshot_header(fd);
+                    osmium::index::detail::check_snapshot_header(header, osmium::index::detail::snapshot_kind::sparse, sizeof(element_type));
+                    m_filter.clear();
+                    m_vector.clear();
+                    m_vector.resize(header.entry_count);
+                    osmium::index::detail::read_exactly(fd, reinterpret_cast<char*>(m_vector.data()), header.entry_count * sizeof(element_type));
+                    osmium::io::detail::reliable_close(fd);
+                }
+
                 iterator begin() {
                     return m_vector.begin();
                 }
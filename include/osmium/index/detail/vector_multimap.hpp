@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/detail/parallel_sort.hpp>
 #include <osmium/index/index.hpp>
 #include <osmium/index/multimap.hpp>
 #include <osmium/io/detail/read_write.hpp>
@@ -83,6 +84,18 @@ namespace osmium {
                     m_vector.push_back(element_type(id, value));
                 }
 
+                void set_all(const TId* ids, const std::size_t count, const TValue value) final {
+                    // grow geometrically, a plain reserve() of the exact
+                    // size would make repeated small bulk inserts quadratic
+                    const std::size_t needed = m_vector.size() + count;
+                    if (needed > m_vector.capacity()) {
+                        m_vector.reserve(std::max(needed, m_vector.capacity() * 2));
+                    }
+                    for (const TId* id = ids; id != ids + count; ++id) {
+                        m_vector.push_back(element_type(*id, value));
+                    }
+                }
+
                 std::pair<iterator, iterator> get_all(const TId id) {
                     const element_type element {
                         id,
@@ -124,6 +137,16 @@ namespace osmium {
                     std::sort(m_vector.begin(), m_vector.end());
                 }
 
+                /**
+                 * Like sort(), but sorts chunks of the data concurrently
+                 * on the given thread pool and then merges them. Much
+                 * faster for the billions of entries a planet-size index
+                 * contains.
+                 */
+                void sort(osmium::thread::Pool& pool) {
+                    osmium::detail::parallel_sort(pool, m_vector.begin(), m_vector.end());
+                }
+
                 void remove(const TId id, const TValue value) {
                     const auto r = get_all(id);
                     for (auto it = r.first; it != r.second; ++it) {
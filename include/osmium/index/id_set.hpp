@@ -33,16 +33,20 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/io/detail/read_write.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/types.hpp>
+#include <osmium/util/profiling.hpp>
 
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <iterator>
 #include <memory>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -105,6 +109,33 @@ namespace osmium {
                 default_chunk_bits = 22u
             };
 
+            /// The number of bits set in the given value.
+            inline unsigned int popcount(uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<unsigned int>(__builtin_popcountll(value));
+#else
+                value = value - ((value >> 1u) & 0x5555555555555555ULL);
+                value = (value & 0x3333333333333333ULL) + ((value >> 2u) & 0x3333333333333333ULL);
+                value = (value + (value >> 4u)) & 0x0f0f0f0f0f0f0f0fULL;
+                return static_cast<unsigned int>((value * 0x0101010101010101ULL) >> 56u);
+#endif
+            }
+
+            /// The number of trailing zero bits. The value must not be 0.
+            inline unsigned int count_trailing_zeros(unsigned int value) noexcept {
+                assert(value != 0);
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<unsigned int>(__builtin_ctz(value));
+#else
+                unsigned int count = 0;
+                while ((value & 1u) == 0) {
+                    value >>= 1u;
+                    ++count;
+                }
+                return count;
+#endif
+            }
+
         } // namespace detail
 
         template <typename T, std::size_t chunk_bits = detail::default_chunk_bits>
@@ -132,10 +163,21 @@ namespace osmium {
                     if (!m_set->m_data[cid]) {
                         m_value = (cid + 1) << (chunk_bits + 3);
                     } else {
-                        const auto slot = m_set->m_data[cid][id_set::offset(m_value)];
+                        const auto off = id_set::offset(m_value);
+                        const auto slot = m_set->m_data[cid][off];
                         if (slot == 0) {
-                            m_value += 8;
-                            m_value &= ~0x7ull;
+                            // The byte is empty. If the whole 64bit word
+                            // it is part of is empty, too, skip over all
+                            // of it at once.
+                            uint64_t word = 0;
+                            std::memcpy(&word, &m_set->m_data[cid][off & ~std::size_t{7u}], sizeof(word));
+                            if (word == 0) {
+                                m_value += 64;
+                                m_value &= ~0x3full;
+                            } else {
+                                m_value += 8;
+                                m_value &= ~0x7ull;
+                            }
                         } else {
                             ++m_value;
                         }
@@ -224,6 +266,17 @@ namespace osmium {
                 return static_cast<T>(m_data.size()) * chunk_size * 8;
             }
 
+            // The number of Ids stored in the given chunk.
+            static T count_chunk(const unsigned char* chunk) noexcept {
+                T count = 0;
+                for (std::size_t i = 0; i < chunk_size; i += sizeof(uint64_t)) {
+                    uint64_t word = 0;
+                    std::memcpy(&word, chunk + i, sizeof(word));
+                    count += detail::popcount(word);
+                }
+                return count;
+            }
+
             unsigned char& get_element(T id) {
                 const auto cid = chunk_id(id);
                 if (cid >= m_data.size()) {
@@ -272,6 +325,49 @@ namespace osmium {
                 (void)check_and_set(id);
             }
 
+            /**
+             * Add all Ids in the range [first, last) to the set. The
+             * ragged edges of the range are set bit by bit, everything
+             * in between is filled whole bytes at a time, which is much
+             * faster than calling set() for every single Id when the
+             * range is large.
+             *
+             * @param first The first Id to set.
+             * @param last One past the last Id to set.
+             */
+            void set_range(T first, T last) {
+                while (first < last && (first & 0x7u) != 0) {
+                    set(first++);
+                }
+                while (first < last && (last & 0x7u) != 0) {
+                    set(--last);
+                }
+
+                // The remaining range is byte-aligned on both ends.
+                // Handle it chunk by chunk, counting the bits already
+                // set before overwriting them so m_size stays correct.
+                T id = first;
+                while (id < last) {
+                    get_element(id); // makes sure the chunk is allocated
+                    unsigned char* chunk = m_data[chunk_id(id)].get();
+                    const T chunk_end = std::min(last, static_cast<T>((chunk_id(id) + 1) * chunk_size * 8));
+                    const std::size_t begin = offset(id);
+                    const std::size_t end = begin + (chunk_end - id) / 8;
+                    m_size += static_cast<T>((end - begin) * 8);
+                    std::size_t i = begin;
+                    for (; i + sizeof(uint64_t) <= end; i += sizeof(uint64_t)) {
+                        uint64_t word = 0;
+                        std::memcpy(&word, chunk + i, sizeof(word));
+                        m_size -= detail::popcount(word);
+                    }
+                    for (; i < end; ++i) {
+                        m_size -= detail::popcount(chunk[i]);
+                    }
+                    ::memset(chunk + begin, 0xff, end - begin);
+                    id = chunk_end;
+                }
+            }
+
             /**
              * Remove the given Id from the set.
              *
@@ -328,6 +424,166 @@ namespace osmium {
                 return m_data.size() * chunk_size;
             }
 
+            /**
+             * Write the contents of the set to the given file descriptor
+             * so they can be restored later with load(). Only allocated
+             * chunks of the bit field are written.
+             */
+            void dump(const int fd) const {
+                const std::size_t num_chunks = m_data.size();
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&num_chunks), sizeof(num_chunks));
+                for (const auto& chunk : m_data) {
+                    const char allocated = chunk ? 1 : 0;
+                    osmium::io::detail::reliable_write(fd, &allocated, 1);
+                    if (chunk) {
+                        osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(chunk.get()), chunk_size);
+                    }
+                }
+            }
+
+            /**
+             * Restore the contents of the set from the given file
+             * descriptor. The set is cleared first, the data must have
+             * been written by dump() with the same template parameters.
+             *
+             * @throws std::runtime_error If the data is truncated.
+             */
+            void load(const int fd) {
+                clear();
+                std::size_t num_chunks = 0;
+                osmium::io::detail::reliable_read_exact(fd, reinterpret_cast<char*>(&num_chunks), sizeof(num_chunks));
+                m_data.resize(num_chunks);
+                for (auto& chunk : m_data) {
+                    char allocated = 0;
+                    osmium::io::detail::reliable_read_exact(fd, &allocated, 1);
+                    if (allocated) {
+                        chunk.reset(new unsigned char[chunk_size]);
+                        osmium::io::detail::reliable_read_exact(fd, reinterpret_cast<char*>(chunk.get()), chunk_size);
+                        m_size += count_chunk(chunk.get());
+                    }
+                }
+            }
+
+            /**
+             * Call func(id) for every Id in the set in ascending order.
+             * This walks the bit field a word at a time, skipping over
+             * empty words, which is much faster than using the iterators
+             * when the per-id work is small.
+             */
+            template <typename TFunc>
+            void for_each(TFunc&& func) const {
+                for (std::size_t cid = 0; cid < m_data.size(); ++cid) {
+                    const unsigned char* chunk = m_data[cid].get();
+                    if (!chunk) {
+                        continue;
+                    }
+                    const T base = static_cast<T>(cid) * chunk_size * 8;
+                    for (std::size_t i = 0; i < chunk_size; i += sizeof(uint64_t)) {
+                        uint64_t word = 0;
+                        std::memcpy(&word, chunk + i, sizeof(word));
+                        if (word == 0) {
+                            continue;
+                        }
+                        for (std::size_t byte = i; byte < i + sizeof(uint64_t); ++byte) {
+                            for (unsigned int bits = chunk[byte]; bits != 0; bits &= bits - 1) {
+                                func(base + static_cast<T>(byte * 8 + detail::count_trailing_zeros(bits)));
+                            }
+                        }
+                    }
+                }
+            }
+
+            /**
+             * Add all Ids in the other set to this set. Works a word at
+             * a time, much faster than iterating over the other set and
+             * adding its Ids one by one.
+             */
+            void union_with(const IdSetDense& other) {
+                if (other.m_data.size() > m_data.size()) {
+                    m_data.resize(other.m_data.size());
+                }
+                for (std::size_t cid = 0; cid < other.m_data.size(); ++cid) {
+                    const unsigned char* other_chunk = other.m_data[cid].get();
+                    if (!other_chunk) {
+                        continue;
+                    }
+                    auto& chunk = m_data[cid];
+                    if (!chunk) {
+                        chunk.reset(new unsigned char[chunk_size]);
+                        std::memcpy(chunk.get(), other_chunk, chunk_size);
+                        m_size += count_chunk(other_chunk);
+                        continue;
+                    }
+                    for (std::size_t i = 0; i < chunk_size; i += sizeof(uint64_t)) {
+                        uint64_t word = 0;
+                        uint64_t other_word = 0;
+                        std::memcpy(&word, chunk.get() + i, sizeof(word));
+                        std::memcpy(&other_word, other_chunk + i, sizeof(other_word));
+                        const uint64_t result = word | other_word;
+                        if (result != word) {
+                            m_size += detail::popcount(result) - detail::popcount(word);
+                            std::memcpy(chunk.get() + i, &result, sizeof(result));
+                        }
+                    }
+                }
+            }
+
+            /**
+             * Remove all Ids from this set that are not also in the other
+             * set. Works a word at a time, much faster than iterating
+             * and checking single Ids.
+             */
+            void intersect_with(const IdSetDense& other) {
+                for (std::size_t cid = 0; cid < m_data.size(); ++cid) {
+                    auto& chunk = m_data[cid];
+                    if (!chunk) {
+                        continue;
+                    }
+                    const unsigned char* other_chunk = cid < other.m_data.size() ? other.m_data[cid].get() : nullptr;
+                    if (!other_chunk) {
+                        m_size -= count_chunk(chunk.get());
+                        chunk.reset();
+                        continue;
+                    }
+                    for (std::size_t i = 0; i < chunk_size; i += sizeof(uint64_t)) {
+                        uint64_t word = 0;
+                        uint64_t other_word = 0;
+                        std::memcpy(&word, chunk.get() + i, sizeof(word));
+                        std::memcpy(&other_word, other_chunk + i, sizeof(other_word));
+                        const uint64_t result = word & other_word;
+                        if (result != word) {
+                            m_size -= detail::popcount(word) - detail::popcount(result);
+                            std::memcpy(chunk.get() + i, &result, sizeof(result));
+                        }
+                    }
+                }
+            }
+
+            /**
+             * The number of Ids that are in both this and the other set.
+             * Like intersect_with() followed by size(), but changes
+             * neither set and allocates no memory.
+             */
+            T count_intersection(const IdSetDense& other) const noexcept {
+                T count = 0;
+                const std::size_t num_chunks = std::min(m_data.size(), other.m_data.size());
+                for (std::size_t cid = 0; cid < num_chunks; ++cid) {
+                    const unsigned char* chunk = m_data[cid].get();
+                    const unsigned char* other_chunk = other.m_data[cid].get();
+                    if (!chunk || !other_chunk) {
+                        continue;
+                    }
+                    for (std::size_t i = 0; i < chunk_size; i += sizeof(uint64_t)) {
+                        uint64_t word = 0;
+                        uint64_t other_word = 0;
+                        std::memcpy(&word, chunk + i, sizeof(word));
+                        std::memcpy(&other_word, other_chunk + i, sizeof(other_word));
+                        count += detail::popcount(word & other_word);
+                    }
+                }
+                return count;
+            }
+
             const_iterator begin() const {
                 return {this, 0, last()};
             }
@@ -419,6 +675,30 @@ namespace osmium {
                 return m_data.capacity() * sizeof(T);
             }
 
+            /**
+             * Write the contents of the set to the given file descriptor
+             * so they can be restored later with load().
+             */
+            void dump(const int fd) const {
+                const std::size_t count = m_data.size();
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&count), sizeof(count));
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(m_data.data()), count * sizeof(T));
+            }
+
+            /**
+             * Restore the contents of the set from the given file
+             * descriptor. The set is cleared first, the data must have
+             * been written by dump() with the same template parameters.
+             *
+             * @throws std::runtime_error If the data is truncated.
+             */
+            void load(const int fd) {
+                std::size_t count = 0;
+                osmium::io::detail::reliable_read_exact(fd, reinterpret_cast<char*>(&count), sizeof(count));
+                m_data.resize(count);
+                osmium::io::detail::reliable_read_exact(fd, reinterpret_cast<char*>(m_data.data()), count * sizeof(T));
+            }
+
             /// Iterator type. There is no non-const iterator.
             using const_iterator = typename std::vector<T>::const_iterator;
 
@@ -440,6 +720,174 @@ namespace osmium {
 
         }; // class IdSetSmall
 
+        /**
+         * IdSet implementation that adapts to the number of Ids in it.
+         * It starts out as an IdSetSmall and promotes itself to an
+         * IdSetDense when the number of set() calls reaches a threshold
+         * (16k by default, settable in the constructor).
+         *
+         * Use this when the sizes of your sets vary wildly and you can
+         * not choose between IdSetSmall (which degrades to slow linear
+         * or binary searches when a set unexpectedly grows large) and
+         * IdSetDense (which wastes memory on truly small sets) up
+         * front.
+         *
+         * Promotions can be counted per set with conversions() and
+         * process-wide with the id_set_promotions profiling counter
+         * (see osmium/util/profiling.hpp). If the counts are large,
+         * the threshold is probably set too high.
+         */
+        template <typename T, std::size_t chunk_bits = detail::default_chunk_bits>
+        class IdSetAdaptive : public IdSet<T> {
+
+        public:
+
+            enum : std::size_t {
+                default_threshold = 16u * 1024u
+            };
+
+        private:
+
+            IdSetSmall<T> m_small{};
+
+            // Only allocated after the promotion, so a small set costs
+            // no dense-representation memory.
+            std::unique_ptr<IdSetDense<T, chunk_bits>> m_dense{};
+
+            std::size_t m_threshold;
+
+            std::size_t m_conversions = 0;
+
+            void promote() {
+                std::unique_ptr<IdSetDense<T, chunk_bits>> dense{new IdSetDense<T, chunk_bits>{}};
+                for (const auto id : m_small) {
+                    dense->set(id);
+                }
+                m_dense = std::move(dense);
+                m_small = IdSetSmall<T>{}; // also frees the vector memory
+                ++m_conversions;
+                OSMIUM_PROFILE_COUNT(id_set_promotions);
+            }
+
+        public:
+
+            /**
+             * Create an adaptive Id set.
+             *
+             * @param threshold The number of set() calls after which the
+             *        set switches to the dense representation.
+             */
+            explicit IdSetAdaptive(const std::size_t threshold = default_threshold) :
+                m_threshold(threshold) {
+            }
+
+            /**
+             * Add the given Id to the set.
+             */
+            void set(T id) final {
+                if (m_dense) {
+                    m_dense->set(id);
+                    return;
+                }
+                m_small.set(id);
+                if (m_small.size() >= m_threshold) {
+                    promote();
+                }
+            }
+
+            /**
+             * Is the Id in the set?
+             */
+            bool get(T id) const noexcept final {
+                if (m_dense) {
+                    return m_dense->get(id);
+                }
+                return m_small.get(id);
+            }
+
+            /**
+             * Is the set empty?
+             */
+            bool empty() const noexcept final {
+                if (m_dense) {
+                    return m_dense->empty();
+                }
+                return m_small.empty();
+            }
+
+            /**
+             * The number of Ids stored in the set.
+             *
+             * @pre While the set uses the small representation you must
+             *      have called sort_unique() before calling this or be
+             *      sure there are no duplicates.
+             */
+            std::size_t size() const noexcept {
+                if (m_dense) {
+                    return m_dense->size();
+                }
+                return m_small.size();
+            }
+
+            /**
+             * Sort and remove duplicates in the small representation.
+             * Does nothing in the dense representation, which never
+             * contains duplicates.
+             */
+            void sort_unique() {
+                if (!m_dense) {
+                    m_small.sort_unique();
+                }
+            }
+
+            /**
+             * Clear the set. The set starts over with the small
+             * representation; the conversion counter keeps its value.
+             */
+            void clear() final {
+                m_small.clear();
+                m_dense.reset();
+            }
+
+            std::size_t used_memory() const noexcept final {
+                if (m_dense) {
+                    return m_dense->used_memory();
+                }
+                return m_small.used_memory();
+            }
+
+            /// Is the set currently using the dense representation?
+            bool is_dense() const noexcept {
+                return static_cast<bool>(m_dense);
+            }
+
+            /**
+             * How often has this set been promoted from the small to
+             * the dense representation? Can be more than one because
+             * clear() switches back to the small representation.
+             */
+            std::size_t conversions() const noexcept {
+                return m_conversions;
+            }
+
+            /**
+             * Call func(id) for every Id in the set in ascending order,
+             * each Id once.
+             */
+            template <typename TFunc>
+            void for_each(TFunc&& func) {
+                if (m_dense) {
+                    m_dense->for_each(std::forward<TFunc>(func));
+                    return;
+                }
+                m_small.sort_unique();
+                for (const auto id : m_small) {
+                    func(id);
+                }
+            }
+
+        }; // class IdSetAdaptive
+
         /// @deprecated Use nwr_array helper class instead.
         template <template <typename> class IdSetType>
         class NWRIdSet {
@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/util/memory.hpp>
 #include <osmium/util/string.hpp>
 
 #include <algorithm>
@@ -43,6 +44,7 @@ DEALINGS IN THE SOFTWARE.
 #include <stdexcept>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -145,6 +147,17 @@ namespace osmium {
                  */
                 virtual TValue get_noexcept(const TId id) const noexcept = 0;
 
+                /**
+                 * Hint that the value with the given id will be looked up
+                 * soon. Implementations with predictable memory layout use
+                 * this to issue a software prefetch for the relevant cache
+                 * line, so several lookup latencies can overlap. The
+                 * default implementation does nothing.
+                 */
+                virtual void prefetch(const TId /*id*/) const noexcept {
+                    // default implementation is empty
+                }
+
                 /**
                  * Get the approximate number of items in the storage. The storage
                  * might allocate memory in blocks, so this size might not be
@@ -162,6 +175,21 @@ namespace osmium {
                  */
                 virtual std::size_t used_memory() const = 0;
 
+                /**
+                 * Register this map in the process-wide MemoryAccounting
+                 * registry under the specified name, reporting its
+                 * used_memory(). Keep the returned handle next to the
+                 * map; the account is removed when the handle is
+                 * destroyed. The map must not be moved or destroyed
+                 * while the account exists.
+                 */
+                osmium::MemoryAccount account_memory(std::string name) const {
+                    const Map* self = this;
+                    return osmium::MemoryAccount{std::move(name), [self]() {
+                        return self->used_memory();
+                    }};
+                }
+
                 /**
                  * Clear memory used for this storage. After this you can not
                  * use the storage container any more.
@@ -0,0 +1,379 @@
+#ifndef OSMIUM_INDEX_MAP_DENSE_MEM_COMPRESSED_HPP
+#define OSMIUM_INDEX_MAP_DENSE_MEM_COMPRESSED_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#define OSMIUM_HAS_INDEX_MAP_DENSE_MEM_COMPRESSED
+
+namespace osmium {
+
+    namespace index {
+
+        namespace map {
+
+            /**
+             * A dense index with compressed pages. Ids are split into
+             * pages of 64Ki entries each. Pages currently being written
+             * or read are held uncompressed in a small hot-page cache;
+             * all other pages are stored as an occupancy bitmap plus
+             * delta- and varint-encoded values. Because neighboring OSM
+             * nodes tend to be close together, the deltas are small and
+             * an occupied slot usually compresses to a few bytes, while
+             * runs of empty slots cost almost nothing. This makes a
+             * full planet node location index fit into a fraction of the
+             * memory the uncompressed dense indexes need, at the cost of
+             * compressing and decompressing pages on cache misses.
+             *
+             * Ids must be added in (roughly) ascending order for good
+             * performance, random access to cold pages is expensive.
+             *
+             * The value type must consist of 32bit words (like
+             * osmium::Location does). An element is empty when its value
+             * is the empty value, so this index can not store the empty
+             * value.
+             */
+            template <typename TId, typename TValue>
+            class DenseMemCompressed : public osmium::index::map::Map<TId, TValue> {
+
+                static_assert(sizeof(TValue) % sizeof(std::int32_t) == 0,
+                              "Value type must consist of 32bit words");
+
+                enum {
+                    bits = 16
+                };
+
+                enum : std::uint64_t {
+                    page_size = 1ull << bits
+                };
+
+                enum : std::size_t {
+                    bitmap_size = page_size / 8,
+                    lanes = sizeof(TValue) / sizeof(std::int32_t)
+                };
+
+                struct hot_page {
+                    std::size_t num;
+                    std::vector<TValue> values;
+                }; // struct hot_page
+
+                // Compressed pages indexed by page number. An empty vector
+                // means all slots of the page are empty.
+                mutable std::vector<std::vector<unsigned char>> m_pages;
+
+                // Uncompressed pages, most recently used last.
+                mutable std::vector<hot_page> m_hot_pages;
+
+                std::size_t m_max_hot_pages;
+
+                std::size_t m_size = 0;
+
+                static std::size_t page(const std::uint64_t id) noexcept {
+                    return static_cast<std::size_t>(id >> bits);
+                }
+
+                static std::size_t offset(const std::uint64_t id) noexcept {
+                    return static_cast<std::size_t>(id & (page_size - 1));
+                }
+
+                static std::uint32_t zigzag_encode(const std::int32_t value) noexcept {
+                    return (static_cast<std::uint32_t>(value) << 1u) ^ static_cast<std::uint32_t>(value >> 31);
+                }
+
+                static std::int32_t zigzag_decode(const std::uint32_t value) noexcept {
+                    return static_cast<std::int32_t>(value >> 1u) ^ -static_cast<std::int32_t>(value & 1u);
+                }
+
+                static void append_varint(std::vector<unsigned char>& out, std::uint32_t value) {
+                    while (value >= 0x80u) {
+                        out.push_back(static_cast<unsigned char>(value | 0x80u));
+                        value >>= 7u;
+                    }
+                    out.push_back(static_cast<unsigned char>(value));
+                }
+
+                static std::uint32_t read_varint(const unsigned char*& data) noexcept {
+                    std::uint32_t value = 0;
+                    unsigned int shift = 0;
+                    while (*data & 0x80u) {
+                        value |= static_cast<std::uint32_t>(*data++ & 0x7fu) << shift;
+                        shift += 7;
+                    }
+                    return value | (static_cast<std::uint32_t>(*data++) << shift);
+                }
+
+                static bool is_empty(const TValue& value) noexcept {
+                    return value == osmium::index::empty_value<TValue>();
+                }
+
+                static std::vector<unsigned char> compress(const std::vector<TValue>& values) {
+                    std::vector<unsigned char> data;
+
+                    std::vector<unsigned char> bitmap(bitmap_size, 0);
+                    bool any = false;
+                    for (std::size_t i = 0; i < page_size; ++i) {
+                        if (!is_empty(values[i])) {
+                            bitmap[i >> 3u] |= static_cast<unsigned char>(1u << (i & 7u));
+                            any = true;
+                        }
+                    }
+                    if (!any) {
+                        return data;
+                    }
+
+                    data.reserve(bitmap_size + page_size);
+                    data.insert(data.end(), bitmap.begin(), bitmap.end());
+
+                    std::int32_t prev[lanes] = {0};
+                    std::int32_t curr[lanes];
+                    for (std::size_t i = 0; i < page_size; ++i) {
+                        if (is_empty(values[i])) {
+                            continue;
+                        }
+                        std::memcpy(curr, &values[i], sizeof(TValue));
+                        for (std::size_t lane = 0; lane < lanes; ++lane) {
+                            append_varint(data, zigzag_encode(curr[lane] - prev[lane]));
+                            prev[lane] = curr[lane];
+                        }
+                    }
+
+                    return data;
+                }
+
+                static void decompress(const std::vector<unsigned char>& data, std::vector<TValue>& values) {
+                    values.assign(page_size, osmium::index::empty_value<TValue>());
+                    if (data.empty()) {
+                        return;
+                    }
+
+                    const unsigned char* bitmap = data.data();
+                    const unsigned char* deltas = data.data() + bitmap_size;
+
+                    std::int32_t curr[lanes] = {0};
+                    for (std::size_t i = 0; i < page_size; ++i) {
+                        if ((bitmap[i >> 3u] & (1u << (i & 7u))) == 0) {
+                            continue;
+                        }
+                        for (std::size_t lane = 0; lane < lanes; ++lane) {
+                            curr[lane] += zigzag_decode(read_varint(deltas));
+                        }
+                        std::memcpy(&values[i], curr, sizeof(TValue));
+                    }
+                }
+
+                /// Decode the value at the given offset from compressed data.
+                static TValue decode_single(const std::vector<unsigned char>& data, const std::size_t off) noexcept {
+                    const unsigned char* bitmap = data.data();
+                    if ((bitmap[off >> 3u] & (1u << (off & 7u))) == 0) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+
+                    const unsigned char* deltas = data.data() + bitmap_size;
+                    std::int32_t curr[lanes] = {0};
+                    for (std::size_t i = 0; i <= off; ++i) {
+                        if ((bitmap[i >> 3u] & (1u << (i & 7u))) == 0) {
+                            continue;
+                        }
+                        for (std::size_t lane = 0; lane < lanes; ++lane) {
+                            curr[lane] += zigzag_decode(read_varint(deltas));
+                        }
+                    }
+
+                    TValue value;
+                    std::memcpy(&value, curr, sizeof(TValue));
+                    return value;
+                }
+
+                void evict(hot_page& page) const {
+                    if (m_pages.size() <= page.num) {
+                        m_pages.resize(page.num + 1);
+                    }
+                    m_pages[page.num] = compress(page.values);
+                }
+
+                /// Is the page guaranteed to contain only empty slots?
+                bool page_is_empty(const std::size_t num) const noexcept {
+                    return num >= m_pages.size() || m_pages[num].empty();
+                }
+
+                const hot_page* find_hot_page(const std::size_t num) const noexcept {
+                    for (const auto& page : m_hot_pages) {
+                        if (page.num == num) {
+                            return &page;
+                        }
+                    }
+                    return nullptr;
+                }
+
+                /// Get the page uncompressed, loading it into the cache.
+                hot_page& load_page(const std::size_t num) const {
+                    for (auto it = m_hot_pages.begin(); it != m_hot_pages.end(); ++it) {
+                        if (it->num == num) {
+                            std::rotate(it, it + 1, m_hot_pages.end());
+                            return m_hot_pages.back();
+                        }
+                    }
+
+                    if (m_hot_pages.size() >= m_max_hot_pages) {
+                        evict(m_hot_pages.front());
+                        m_hot_pages.erase(m_hot_pages.begin());
+                    }
+
+                    m_hot_pages.push_back(hot_page{num, {}});
+                    hot_page& page = m_hot_pages.back();
+                    if (num < m_pages.size()) {
+                        decompress(m_pages[num], page.values);
+                    } else {
+                        page.values.assign(page_size, osmium::index::empty_value<TValue>());
+                    }
+                    return page;
+                }
+
+            public:
+
+                enum : std::size_t {
+                    default_max_hot_pages = 16u
+                };
+
+                explicit DenseMemCompressed(std::size_t max_hot_pages = default_max_hot_pages) :
+                    m_max_hot_pages(max_hot_pages > 0 ? max_hot_pages : 1) {
+                }
+
+                void set(const TId id, const TValue value) final {
+                    TValue& slot = load_page(page(id)).values[offset(id)];
+                    if (is_empty(slot)) {
+                        ++m_size;
+                    }
+                    slot = value;
+                }
+
+                TValue get(const TId id) const final {
+                    const std::size_t num = page(id);
+                    if (!find_hot_page(num) && page_is_empty(num)) {
+                        throw osmium::not_found{id};
+                    }
+                    const TValue value = load_page(num).values[offset(id)];
+                    if (is_empty(value)) {
+                        throw osmium::not_found{id};
+                    }
+                    return value;
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    const std::size_t num = page(id);
+                    const hot_page* hot = find_hot_page(num);
+                    if (hot) {
+                        return hot->values[offset(id)];
+                    }
+                    if (page_is_empty(num)) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    // Decode just this one value without touching the
+                    // cache, this function must not allocate.
+                    return decode_single(m_pages[num], offset(id));
+                }
+
+                std::size_t size() const noexcept final {
+                    return m_size;
+                }
+
+                std::size_t used_memory() const noexcept final {
+                    std::size_t sum = m_hot_pages.size() * page_size * sizeof(TValue);
+                    for (const auto& data : m_pages) {
+                        sum += data.capacity();
+                    }
+                    return sum;
+                }
+
+                void clear() final {
+                    m_pages.clear();
+                    m_pages.shrink_to_fit();
+                    m_hot_pages.clear();
+                    m_hot_pages.shrink_to_fit();
+                    m_size = 0;
+                }
+
+                void dump_as_list(const int fd) final {
+                    std::size_t num_pages = m_pages.size();
+                    for (const auto& page : m_hot_pages) {
+                        num_pages = std::max(num_pages, page.num + 1);
+                    }
+
+                    std::vector<TValue> decompressed;
+                    std::vector<std::pair<TId, TValue>> v;
+                    for (std::size_t num = 0; num < num_pages; ++num) {
+                        const hot_page* hot = find_hot_page(num);
+                        const std::vector<TValue>* values = nullptr;
+                        if (hot) {
+                            values = &hot->values;
+                        } else if (!page_is_empty(num)) {
+                            decompress(m_pages[num], decompressed);
+                            values = &decompressed;
+                        } else {
+                            continue;
+                        }
+
+                        v.clear();
+                        for (std::size_t i = 0; i < page_size; ++i) {
+                            if (!is_empty((*values)[i])) {
+                                v.emplace_back(static_cast<TId>(num * page_size + i), (*values)[i]);
+                            }
+                        }
+                        osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(v.data()), sizeof(std::pair<TId, TValue>) * v.size());
+                    }
+                }
+
+            }; // class DenseMemCompressed
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#ifdef OSMIUM_WANT_NODE_LOCATION_MAPS
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseMemCompressed, dense_mem_compressed)
+#endif
+
+#endif // OSMIUM_INDEX_MAP_DENSE_MEM_COMPRESSED_HPP
@@ -33,12 +33,16 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/detail/snapshot.hpp>
 #include <osmium/index/index.hpp>
 #include <osmium/index/map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/util/misc.hpp>
 
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -72,8 +76,8 @@ namespace osmium {
 
                 // Minimum number of entries in the sparse index before we
                 // are considering switching to a dense index.
-                enum : int64_t {
-                    min_dense_entries = 0xffffff
+                enum : uint64_t {
+                    default_min_dense_entries = 0xffffff
                 };
 
                 // When more than a third of all Ids are in the index, we
@@ -81,8 +85,8 @@ namespace osmium {
                 // the best memory efficiency (which we would get at a factor
                 // of 2) and the performance (dense index is much faster then
                 // the sparse index).
-                enum {
-                    density_factor = 3
+                enum : uint64_t {
+                    default_density_factor = 3
                 };
 
                 // An entry in the sparse index
@@ -90,6 +94,11 @@ namespace osmium {
                     uint64_t id;
                     TValue value;
 
+                    entry() noexcept :
+                        id(0),
+                        value(osmium::index::empty_value<TValue>()) {
+                    }
+
                     entry(uint64_t i, TValue v) :
                         id(i),
                         value(std::move(v)) {
@@ -107,6 +116,11 @@ namespace osmium {
                 // The maximum Id that was seen yet. Only set in sparse mode.
                 uint64_t m_max_id = 0;
 
+                // Thresholds steering the switch from sparse to dense mode,
+                // see set_switch_threshold().
+                uint64_t m_min_dense_entries = default_min_dense_entries;
+                uint64_t m_density_factor = default_density_factor;
+
                 // Set to false in sparse mode and to true in dense mode.
                 bool m_dense;
 
@@ -134,8 +148,8 @@ namespace osmium {
                     if (id > m_max_id) {
                         m_max_id = id;
 
-                        if (m_sparse_entries.size() >= min_dense_entries) {
-                            if (m_max_id < m_sparse_entries.size() * density_factor) {
+                        if (m_sparse_entries.size() >= m_min_dense_entries) {
+                            if (m_max_id < m_sparse_entries.size() * m_density_factor) {
                                 switch_to_dense();
                             }
                         }
@@ -183,6 +197,53 @@ namespace osmium {
                     return m_dense;
                 }
 
+                /**
+                 * Configure when the index switches from the sparse to the
+                 * dense representation. The defaults are based on benchmarks
+                 * with a planet file, but for some extracts the index ends
+                 * up in the wrong mode. Use the memory accessors below to
+                 * see what both modes would cost and steer the switch with
+                 * this function (or call switch_to_dense() directly).
+                 *
+                 * Has no effect once the index is in dense mode.
+                 *
+                 * @param min_entries Number of entries the sparse index
+                 *        must contain before a switch is considered.
+                 * @param density_factor Switch when more than 1/density_factor
+                 *        of all Ids up to the largest one seen are in the
+                 *        index. Values below 1 are treated as 1.
+                 */
+                void set_switch_threshold(const uint64_t min_entries, const uint64_t density_factor) noexcept {
+                    m_min_dense_entries = min_entries;
+                    m_density_factor = density_factor > 0 ? density_factor : 1;
+                }
+
+                /// The largest Id seen so far. Only tracked in sparse mode.
+                uint64_t max_id() const noexcept {
+                    return m_max_id;
+                }
+
+                /// The memory used by the sparse part of the index in bytes.
+                std::size_t sparse_memory() const noexcept {
+                    return m_sparse_entries.size() * sizeof(entry);
+                }
+
+                /**
+                 * The memory used by the dense part of the index in bytes.
+                 * In sparse mode this is an estimate of what a dense index
+                 * over all Ids seen so far would use, so it can be compared
+                 * against sparse_memory() to decide whether the index is in
+                 * the right mode.
+                 */
+                std::size_t dense_memory() const noexcept {
+                    if (!m_dense && m_sparse_entries.empty()) {
+                        return 0;
+                    }
+                    const std::size_t num_blocks = m_dense ? m_dense_blocks.size()
+                                                           : block(m_max_id) + 1;
+                    return num_blocks * (block_size * sizeof(TValue) + sizeof(std::vector<TValue>));
+                }
+
                 std::size_t size() const noexcept final {
                     if (m_dense) {
                         return m_dense_blocks.size() * block_size;
@@ -219,6 +280,15 @@ namespace osmium {
                     return value;
                 }
 
+                void prefetch(const TId id) const noexcept final {
+                    // Only the dense representation has a predictable
+                    // memory layout, the probes of the binary search over
+                    // the sparse entries can not be prefetched.
+                    if (m_dense && block(id) < m_dense_blocks.size() && !m_dense_blocks[block(id)].empty()) {
+                        osmium::detail::prefetch_read(&m_dense_blocks[block(id)][offset(id)]);
+                    }
+                }
+
                 void clear() final {
                     m_sparse_entries.clear();
                     m_sparse_entries.shrink_to_fit();
@@ -253,6 +323,64 @@ namespace osmium {
                     m_dense = true;
                 }
 
+                /**
+                 * Write the contents of the index to a snapshot file from
+                 * which load_from_file() can restore it later, much faster
+                 * than rebuilding the index from the input data. Both the
+                 * sparse and the dense representation can be dumped, the
+                 * snapshot remembers which one was in use.
+                 */
+                void dump_to_file(const std::string& filename) const {
+                    const int fd = osmium::io::detail::open_for_writing(filename, osmium::io::overwrite::allow);
+                    if (m_dense) {
+                        const auto s = stats();
+                        osmium::index::detail::write_snapshot_header(fd, osmium::index::detail::snapshot_kind::flex_dense, sizeof(uint64_t) + block_size * sizeof(TValue), s.first);
+                        for (uint64_t num = 0; num < m_dense_blocks.size(); ++num) {
+                            if (!m_dense_blocks[num].empty()) {
+                                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&num), sizeof(num));
+                                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(m_dense_blocks[num].data()), block_size * sizeof(TValue));
+                            }
+                        }
+                    } else {
+                        osmium::index::detail::write_snapshot_header(fd, osmium::index::detail::snapshot_kind::flex_sparse, sizeof(entry), m_sparse_entries.size());
+                        osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(m_sparse_entries.data()), m_sparse_entries.size() * sizeof(entry));
+                    }
+                    osmium::io::detail::reliable_close(fd);
+                }
+
+                /**
+                 * Replace the contents of the index with those of a
+                 * snapshot file written by dump_to_file(). The index ends
+                 * up in the mode (sparse or dense) it was dumped in.
+                 * Throws std::runtime_error if the file is not a snapshot
+                 * of a matching index.
+                 */
+                void load_from_file(const std::string& filename) {
+                    const int fd = osmium::io::detail::open_for_reading(filename);
+                    const auto header = osmium::index::detail::read_snapshot_header(fd);
+                    clear();
+                    if (header.kind == static_cast<uint32_t>(osmium::index::detail::snapshot_kind::flex_dense)) {
+                        osmium::index::detail::check_snapshot_header(header, osmium::index::detail::snapshot_kind::flex_dense, sizeof(uint64_t) + block_size * sizeof(TValue));
+                        m_dense = true;
+                        for (uint64_t n = 0; n < header.entry_count; ++n) {
+                            uint64_t num = 0;
+                            osmium::index::detail::read_exactly(fd, reinterpret_cast<char*>(&num), sizeof(num));
+                            assure_block(num);
+                            osmium::index::detail::read_exactly(fd, reinterpret_cast<char*>(m_dense_blocks[num].data()), block_size * sizeof(TValue));
+                        }
+                    } else {
+                        osmium::index::detail::check_snapshot_header(header, osmium::index::detail::snapshot_kind::flex_sparse, sizeof(entry));
+                        m_sparse_entries.resize(header.entry_count);
+                        osmium::index::detail::read_exactly(fd, reinterpret_cast<char*>(m_sparse_entries.data()), header.entry_count * sizeof(entry));
+                        for (const auto& e : m_sparse_entries) {
+                            if (e.id > m_max_id) {
+                                m_max_id = e.id;
+                            }
+                        }
+                    }
+                    osmium::io::detail::reliable_close(fd);
+                }
+
                 std::pair<std::size_t, std::size_t> stats() const noexcept {
                     std::size_t used_blocks = 0;
                     std::size_t empty_blocks = 0;
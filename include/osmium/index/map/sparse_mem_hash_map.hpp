@@ -0,0 +1,190 @@
+#ifndef OSMIUM_INDEX_MAP_SPARSE_MEM_HASH_MAP_HPP
+#define OSMIUM_INDEX_MAP_SPARSE_MEM_HASH_MAP_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#define OSMIUM_HAS_INDEX_MAP_SPARSE_MEM_HASH_MAP
+
+namespace osmium {
+
+    namespace index {
+
+        namespace map {
+
+            /**
+             * This implementation uses an open-addressing hash table with
+             * linear probing. All elements are stored in one flat array,
+             * so unlike SparseMemMap there are no per-element allocations
+             * and lookups touch only a few consecutive cache lines. The
+             * table is kept at most half full, which keeps probe runs
+             * short.
+             *
+             * An element is empty when its value is the empty value, so
+             * this index can not store the empty value (SparseMemTable
+             * and the array based indexes have the same limitation).
+             */
+            template <typename TId, typename TValue>
+            class SparseMemHashMap : public osmium::index::map::Map<TId, TValue> {
+
+                struct element_type {
+                    TId id;
+                    TValue value;
+                }; // struct element_type
+
+                // Must be a power of two.
+                enum : std::size_t {
+                    initial_bucket_count = 1024u
+                };
+
+                std::vector<element_type> m_elements;
+                std::size_t m_size = 0;
+
+                static element_type empty_element() {
+                    return element_type{0, osmium::index::empty_value<TValue>()};
+                }
+
+                static bool is_empty(const element_type& element) noexcept {
+                    return element.value == osmium::index::empty_value<TValue>();
+                }
+
+                std::size_t bucket(const TId id) const noexcept {
+                    // Fibonacci hashing. The table size is a power of two,
+                    // so taking the high bits of the product spreads the
+                    // mostly consecutive OSM ids over the whole table.
+                    const auto h = static_cast<std::uint64_t>(id) * 0x9e3779b97f4a7c15ULL;
+                    return static_cast<std::size_t>(h >> 32u) & (m_elements.size() - 1);
+                }
+
+                element_type& find_slot(const TId id) noexcept {
+                    std::size_t i = bucket(id);
+                    while (!is_empty(m_elements[i]) && m_elements[i].id != id) {
+                        i = (i + 1) & (m_elements.size() - 1);
+                    }
+                    return m_elements[i];
+                }
+
+                const element_type& find_slot(const TId id) const noexcept {
+                    return const_cast<SparseMemHashMap*>(this)->find_slot(id);
+                }
+
+                void grow() {
+                    std::vector<element_type> old_elements{std::move(m_elements)};
+                    m_elements.assign(old_elements.size() * 2, empty_element());
+                    for (const auto& element : old_elements) {
+                        if (!is_empty(element)) {
+                            find_slot(element.id) = element;
+                        }
+                    }
+                }
+
+            public:
+
+                SparseMemHashMap() :
+                    m_elements(initial_bucket_count, empty_element()) {
+                }
+
+                void set(const TId id, const TValue value) final {
+                    if (m_size * 2 >= m_elements.size()) {
+                        grow();
+                    }
+                    element_type& slot = find_slot(id);
+                    if (is_empty(slot)) {
+                        ++m_size;
+                    }
+                    slot.id = id;
+                    slot.value = value;
+                }
+
+                TValue get(const TId id) const final {
+                    const element_type& slot = find_slot(id);
+                    if (is_empty(slot)) {
+                        throw osmium::not_found{id};
+                    }
+                    return slot.value;
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    return find_slot(id).value;
+                }
+
+                size_t size() const noexcept final {
+                    return m_size;
+                }
+
+                size_t used_memory() const noexcept final {
+                    return sizeof(element_type) * m_elements.size();
+                }
+
+                void clear() final {
+                    m_elements.assign(initial_bucket_count, empty_element());
+                    m_elements.shrink_to_fit();
+                    m_size = 0;
+                }
+
+                void dump_as_list(const int fd) final {
+                    std::vector<std::pair<TId, TValue>> v;
+                    v.reserve(m_size);
+                    for (const auto& element : m_elements) {
+                        if (!is_empty(element)) {
+                            v.emplace_back(element.id, element.value);
+                        }
+                    }
+                    std::sort(v.begin(), v.end(), [](const std::pair<TId, TValue>& lhs, const std::pair<TId, TValue>& rhs) {
+                        return lhs.first < rhs.first;
+                    });
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(v.data()), sizeof(std::pair<TId, TValue>) * v.size());
+                }
+
+            }; // class SparseMemHashMap
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#ifdef OSMIUM_WANT_NODE_LOCATION_MAPS
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMemHashMap, sparse_mem_hash_map)
+#endif
+
+#endif // OSMIUM_INDEX_MAP_SPARSE_MEM_HASH_MAP_HPP
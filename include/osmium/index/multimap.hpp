@@ -33,8 +33,11 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/util/memory.hpp>
+
 #include <cstddef>
 #include <stdexcept>
+#include <string>
 #include <type_traits>
 #include <utility>
 
@@ -77,6 +80,19 @@ namespace osmium {
                 /// Set the field with id to value.
                 virtual void set(const TId id, const TValue value) = 0;
 
+                /**
+                 * Set the fields with all the ids in [ids, ids + count)
+                 * to the same value. Same as calling set() for every id,
+                 * which is what the default implementation does, but
+                 * implementations can override this with a bulk insert
+                 * that pays the virtual call and growth check only once.
+                 */
+                virtual void set_all(const TId* ids, const std::size_t count, const TValue value) {
+                    for (const TId* id = ids; id != ids + count; ++id) {
+                        set(*id, value);
+                    }
+                }
+
                 using iterator = element_type*;
 
 //                virtual std::pair<iterator, iterator> get_all(const TId id) const = 0;
@@ -98,6 +114,21 @@ namespace osmium {
                  */
                 virtual size_t used_memory() const = 0;
 
+                /**
+                 * Register this multimap in the process-wide
+                 * MemoryAccounting registry under the specified name,
+                 * reporting its used_memory(). Keep the returned handle
+                 * next to the multimap; the account is removed when the
+                 * handle is destroyed. The multimap must not be moved
+                 * or destroyed while the account exists.
+                 */
+                osmium::MemoryAccount account_memory(std::string name) const {
+                    const Multimap* self = this;
+                    return osmium::MemoryAccount{std::move(name), [self]() {
+                        return self->used_memory();
+                    }};
+                }
+
                 /**
                  * Clear memory used for this storage. After this you can not
                  * use the storage container any more.
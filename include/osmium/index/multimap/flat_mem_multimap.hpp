@@ -0,0 +1,317 @@
+#ifndef OSMIUM_INDEX_MULTIMAP_FLAT_MEM_MULTIMAP_HPP
+#define OSMIUM_INDEX_MULTIMAP_FLAT_MEM_MULTIMAP_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/index.hpp>
+#include <osmium/index/multimap.hpp>
+#include <osmium/io/detail/read_write.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace multimap {
+
+            /**
+             * A multimap backed by an open-addressing hash table and a
+             * flat value arena instead of the node-based std::multimap
+             * the SparseMemMultimap uses. Each key has one bucket found
+             * with linear probing; the values for a key form a chain of
+             * entries in one contiguous arena. No per-entry allocation,
+             * no rebalancing, and growing the table only moves the
+             * small buckets, never the values.
+             *
+             * Use this where many entries are collected through set()
+             * and then looked up by key, for instance when building
+             * node-to-way backreferences.
+             */
+            template <typename TId, typename TValue>
+            class FlatMemMultimap : public Multimap<TId, TValue> {
+
+                static constexpr std::size_t empty_index = std::numeric_limits<std::size_t>::max();
+
+                enum : std::size_t {
+                    initial_bucket_count = 1024u
+                };
+
+                struct bucket_type {
+                    TId key;
+                    std::size_t head;
+                };
+
+                struct entry_type {
+                    TValue value;
+                    std::size_t next;
+                };
+
+                std::vector<bucket_type> m_buckets;
+                std::vector<entry_type> m_entries;
+
+                std::size_t m_used_buckets = 0;
+                std::size_t m_size = 0;
+
+                // Finalizer of a 64 bit mix function, enough to spread
+                // the mostly sequential OSM ids over the table.
+                static std::size_t hash(TId id) noexcept {
+                    uint64_t h = static_cast<uint64_t>(id);
+                    h ^= h >> 33u;
+                    h *= 0xff51afd7ed558ccdULL;
+                    h ^= h >> 33u;
+                    h *= 0xc4ceb9fe1a85ec53ULL;
+                    h ^= h >> 33u;
+                    return static_cast<std::size_t>(h);
+                }
+
+                // Find the slot for the given id: either the bucket
+                // holding its chain or the empty bucket where it would
+                // be inserted. The table size is a power of two.
+                static std::size_t find_slot(const std::vector<bucket_type>& buckets, const TId id) noexcept {
+                    assert(!buckets.empty());
+                    const std::size_t mask = buckets.size() - 1;
+                    std::size_t slot = hash(id) & mask;
+                    while (buckets[slot].head != empty_index && buckets[slot].key != id) {
+                        slot = (slot + 1) & mask;
+                    }
+                    return slot;
+                }
+
+                void rehash(const std::size_t new_bucket_count) {
+                    assert((new_bucket_count & (new_bucket_count - 1)) == 0);
+                    std::vector<bucket_type> new_buckets(new_bucket_count, bucket_type{0, empty_index});
+                    for (const auto& bucket : m_buckets) {
+                        if (bucket.head != empty_index) {
+                            new_buckets[find_slot(new_buckets, bucket.key)] = bucket;
+                        }
+                    }
+                    using std::swap;
+                    swap(m_buckets, new_buckets);
+                }
+
+                // Grow when the table is more than 70% full, the value
+                // chains in the arena are not affected.
+                void grow_if_needed() {
+                    if (m_buckets.empty()) {
+                        rehash(initial_bucket_count);
+                    } else if ((m_used_buckets + 1) * 10 > m_buckets.size() * 7) {
+                        rehash(m_buckets.size() * 2);
+                    }
+                }
+
+            public:
+
+                using element_type = typename std::pair<TId, TValue>;
+
+                /**
+                 * Iterator over the values of one key, yielding
+                 * (key, value) pairs like the other multimaps do. Walks
+                 * the chain in the arena, skipping removed entries.
+                 */
+                class iterator {
+
+                    const std::vector<entry_type>* m_entries = nullptr;
+                    std::size_t m_index = empty_index;
+                    element_type m_element{};
+
+                    void skip_removed() noexcept {
+                        while (m_index != empty_index && (*m_entries)[m_index].value == osmium::index::empty_value<TValue>()) {
+                            m_index = (*m_entries)[m_index].next;
+                        }
+                    }
+
+                public:
+
+                    iterator() noexcept = default;
+
+                    iterator(const std::vector<entry_type>* entries, const std::size_t index, const TId key) :
+                        m_entries(entries),
+                        m_index(index),
+                        m_element(key, TValue{}) {
+                        skip_removed();
+                    }
+
+                    iterator& operator++() {
+                        assert(m_index != empty_index);
+                        m_index = (*m_entries)[m_index].next;
+                        skip_removed();
+                        return *this;
+                    }
+
+                    iterator operator++(int) {
+                        const auto tmp{*this};
+                        operator++();
+                        return tmp;
+                    }
+
+                    bool operator==(const iterator& rhs) const noexcept {
+                        return m_index == rhs.m_index;
+                    }
+
+                    bool operator!=(const iterator& rhs) const noexcept {
+                        return !operator==(rhs);
+                    }
+
+                    const element_type& operator*() {
+                        assert(m_index != empty_index);
+                        m_element.second = (*m_entries)[m_index].value;
+                        return m_element;
+                    }
+
+                    const element_type* operator->() {
+                        return &operator*();
+                    }
+
+                }; // class iterator
+
+                FlatMemMultimap() = default;
+
+                FlatMemMultimap(FlatMemMultimap&&) = default;
+                FlatMemMultimap& operator=(FlatMemMultimap&&) = default;
+
+                ~FlatMemMultimap() noexcept final = default;
+
+                void reserve(const std::size_t size) {
+                    m_entries.reserve(size);
+                }
+
+                void set(const TId id, const TValue value) final {
+                    grow_if_needed();
+                    auto& bucket = m_buckets[find_slot(m_buckets, id)];
+                    if (bucket.head == empty_index) {
+                        bucket.key = id;
+                        ++m_used_buckets;
+                    }
+                    m_entries.push_back(entry_type{value, bucket.head});
+                    bucket.head = m_entries.size() - 1;
+                    ++m_size;
+                }
+
+                void set_all(const TId* ids, const std::size_t count, const TValue value) final {
+                    // grow geometrically, a plain reserve() of the exact
+                    // size would make repeated small bulk inserts quadratic
+                    const std::size_t needed = m_entries.size() + count;
+                    if (needed > m_entries.capacity()) {
+                        m_entries.reserve(std::max(needed, m_entries.capacity() * 2));
+                    }
+                    for (const TId* id = ids; id != ids + count; ++id) {
+                        set(*id, value);
+                    }
+                }
+
+                std::pair<iterator, iterator> get_all(const TId id) const {
+                    if (m_buckets.empty()) {
+                        return std::make_pair(iterator{}, iterator{});
+                    }
+                    const auto& bucket = m_buckets[find_slot(m_buckets, id)];
+                    if (bucket.head == empty_index) {
+                        return std::make_pair(iterator{}, iterator{});
+                    }
+                    return std::make_pair(iterator{&m_entries, bucket.head, id}, iterator{});
+                }
+
+                void remove(const TId id, const TValue value) {
+                    if (m_buckets.empty()) {
+                        return;
+                    }
+                    const auto& bucket = m_buckets[find_slot(m_buckets, id)];
+                    std::size_t index = bucket.head;
+                    while (index != empty_index) {
+                        auto& entry = m_entries[index];
+                        if (entry.value == value) {
+                            entry.value = osmium::index::empty_value<TValue>();
+                            --m_size;
+                            return;
+                        }
+                        index = entry.next;
+                    }
+                }
+
+                size_t size() const final {
+                    return m_size;
+                }
+
+                size_t used_memory() const final {
+                    return m_buckets.size() * sizeof(bucket_type) +
+                           m_entries.capacity() * sizeof(entry_type);
+                }
+
+                void clear() final {
+                    m_buckets.clear();
+                    m_buckets.shrink_to_fit();
+                    m_entries.clear();
+                    m_entries.shrink_to_fit();
+                    m_used_buckets = 0;
+                    m_size = 0;
+                }
+
+                void consolidate() {
+                    // intentionally left blank
+                }
+
+                void dump_as_list(const int fd) final {
+                    std::vector<element_type> v;
+                    v.reserve(m_size);
+                    for (const auto& bucket : m_buckets) {
+                        if (bucket.head == empty_index) {
+                            continue;
+                        }
+                        for (std::size_t index = bucket.head; index != empty_index; index = m_entries[index].next) {
+                            if (!(m_entries[index].value == osmium::index::empty_value<TValue>())) {
+                                v.emplace_back(bucket.key, m_entries[index].value);
+                            }
+                        }
+                    }
+                    std::sort(v.begin(), v.end());
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(v.data()), sizeof(element_type) * v.size());
+                }
+
+            }; // class FlatMemMultimap
+
+            template <typename TId, typename TValue>
+            constexpr std::size_t FlatMemMultimap<TId, TValue>::empty_index;
+
+        } // namespace multimap
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_MULTIMAP_FLAT_MEM_MULTIMAP_HPP
@@ -37,8 +37,13 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/index/multimap.hpp>
 #include <osmium/index/multimap/sparse_mem_array.hpp>
 #include <osmium/index/multimap/sparse_mem_multimap.hpp>
+#include <osmium/thread/pool.hpp>
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
 #include <utility>
 
 namespace osmium {
@@ -60,6 +65,11 @@ namespace osmium {
                 typename extra_map_type::iterator m_begin_extra;
                 typename extra_map_type::iterator m_end_extra;
 
+                // The extra map stores its elements with a const key,
+                // they have to be copied into an element of our own
+                // value type before a reference can be handed out.
+                element_type m_value{};
+
             public:
 
                  HybridIterator(typename main_map_type::iterator begin_main,
@@ -105,7 +115,8 @@ namespace osmium {
 
                 const element_type& operator*() {
                     if (m_begin_main == m_end_main) {
-                        return *m_begin_extra;
+                        m_value = element_type{m_begin_extra->first, m_begin_extra->second};
+                        return m_value;
                     } else {
                         return *m_begin_main;
                     }
@@ -123,9 +134,98 @@ namespace osmium {
                 using main_map_type  = SparseMemArray<TId, TValue>;
                 using extra_map_type = SparseMemMultimap<TId, TValue>;
 
+                using element_type = typename std::pair<TId, TValue>;
+
+            public:
+
+                /**
+                 * Statistics about the use of the index, see counters().
+                 * Together with main_size() and extra_size() this shows
+                 * how the entries are balanced between the sorted main
+                 * array and the unsorted extra map and what lookups
+                 * cost: every lookup that has to search a large extra
+                 * map is more expensive than one served from the main
+                 * array alone.
+                 */
+                struct counters_type {
+                    /// Number of get_all() calls.
+                    uint64_t lookups = 0;
+                    /// Lookups that had to search the extra map, too.
+                    uint64_t lookups_in_extra = 0;
+                    /// Number of consolidations, however triggered.
+                    uint64_t consolidations = 0;
+                    /// Consolidations triggered by the extra map
+                    /// growing past max_extra_size().
+                    uint64_t auto_consolidations = 0;
+                    /// Consolidations that ran on a thread pool.
+                    uint64_t background_consolidations = 0;
+                    /// Calls that had to wait for a background
+                    /// consolidation to finish.
+                    uint64_t merge_waits = 0;
+                };
+
+            private:
+
+                // Input and result of a background consolidation. The
+                // job owns the containers, so the task can run to
+                // completion even if the index goes away first.
+                struct merge_job {
+                    main_map_type main{};
+                    extra_map_type extra{};
+                };
+
                 main_map_type m_main;
                 extra_map_type m_extra;
 
+                // Result of a pending background consolidation, valid
+                // while one is running or finished but not yet adopted.
+                std::future<main_map_type> m_pending_merge{};
+
+                // Number of entries handed to the pending background
+                // consolidation, they are counted in size() until the
+                // result is adopted.
+                std::size_t m_pending_size = 0;
+
+                std::size_t m_max_extra_size = 0;
+
+                osmium::thread::Pool* m_pool = nullptr;
+
+                counters_type m_counters{};
+
+                /**
+                 * Adopt the result of a pending background
+                 * consolidation into the main array. Everything that
+                 * touches the main array has to call this first,
+                 * waiting if the merge hasn't finished yet.
+                 */
+                void finish_background_consolidation() {
+                    if (m_pending_merge.valid()) {
+                        if (m_pending_merge.wait_for(std::chrono::seconds::zero()) != std::future_status::ready) {
+                            ++m_counters.merge_waits;
+                        }
+                        m_main = m_pending_merge.get();
+                        m_pending_size = 0;
+                    }
+                }
+
+                void start_background_consolidation() {
+                    const auto job = std::make_shared<merge_job>();
+                    job->main = std::move(m_main);
+                    job->extra = std::move(m_extra);
+                    m_main = main_map_type{};
+                    m_extra = extra_map_type{};
+                    m_pending_size = job->main.size() + job->extra.size();
+
+                    m_pending_merge = m_pool->submit([job]() {
+                        job->main.erase_removed();
+                        for (const auto& element : job->extra) {
+                            job->main.set(element.first, element.second);
+                        }
+                        job->main.sort();
+                        return std::move(job->main);
+                    });
+                }
+
             public:
 
                 using iterator       = HybridIterator<TId, TValue>;
@@ -139,26 +239,98 @@ namespace osmium {
                 ~Hybrid() noexcept = default;
 
                 size_t size() const final {
-                    return m_main.size() + m_extra.size();
+                    return m_main.size() + m_extra.size() + m_pending_size;
                 }
 
                 size_t used_memory() const final {
-                    return m_main.used_memory() + m_extra.used_memory();
+                    return m_main.used_memory() + m_extra.used_memory() + m_pending_size * sizeof(element_type);
                 }
 
                 void reserve(const size_t size) {
+                    finish_background_consolidation();
                     m_main.reserve(size);
                 }
 
+                /**
+                 * Set the maximum size of the unsorted extra map. When
+                 * a set() makes the extra map grow past this size, the
+                 * index consolidates itself, in the background if a
+                 * thread pool was given with
+                 * enable_background_consolidation(). The default 0
+                 * disables automatic consolidation, the extra map then
+                 * only shrinks on manual consolidate() calls.
+                 */
+                void set_max_extra_size(const std::size_t max_size) noexcept {
+                    m_max_extra_size = max_size;
+                }
+
+                std::size_t max_extra_size() const noexcept {
+                    return m_max_extra_size;
+                }
+
+                /**
+                 * Run automatic consolidations as tasks on the given
+                 * thread pool instead of inline in the set() call that
+                 * crossed the threshold. The pool must outlive this
+                 * index. Only set() calls continue while a background
+                 * consolidation is running; everything that needs the
+                 * main array (lookups, removes, dumps, ...) waits for
+                 * it to finish first.
+                 */
+                void enable_background_consolidation(osmium::thread::Pool& pool) noexcept {
+                    m_pool = &pool;
+                }
+
+                void disable_background_consolidation() {
+                    finish_background_consolidation();
+                    m_pool = nullptr;
+                }
+
+                /// Access the usage statistics.
+                const counters_type& counters() const noexcept {
+                    return m_counters;
+                }
+
+                /// Number of entries in the sorted main array.
+                std::size_t main_size() const noexcept {
+                    return m_main.size() + m_pending_size;
+                }
+
+                /// Number of entries in the unsorted extra map.
+                std::size_t extra_size() const noexcept {
+                    return m_extra.size();
+                }
+
                 void unsorted_set(const TId id, const TValue value) {
+                    finish_background_consolidation();
                     m_main.set(id, value);
                 }
 
                 void set(const TId id, const TValue value) final {
                     m_extra.set(id, value);
+                    if (m_max_extra_size > 0 && m_extra.size() >= m_max_extra_size) {
+                        if (m_pool) {
+                            // while a merge is already running, the
+                            // extra map keeps collecting new entries
+                            if (!m_pending_merge.valid()) {
+                                ++m_counters.auto_consolidations;
+                                ++m_counters.consolidations;
+                                ++m_counters.background_consolidations;
+                                start_background_consolidation();
+                            }
+                        } else {
+                            ++m_counters.auto_consolidations;
+                            consolidate();
+                        }
+                    }
                 }
 
                 std::pair<iterator, iterator> get_all(const TId id) {
+                    finish_background_consolidation();
+                    ++m_counters.lookups;
+                    if (m_extra.size() > 0) {
+                        ++m_counters.lookups_in_extra;
+                    }
                     const auto result_main = m_main.get_all(id);
                     const auto result_extra = m_extra.get_all(id);
                     return std::make_pair(iterator{result_main.first, result_main.second, result_extra.first, result_extra.second},
@@ -166,11 +338,14 @@ namespace osmium {
                 }
 
                 void remove(const TId id, const TValue value) {
+                    finish_background_consolidation();
                     m_main.remove(id, value);
                     m_extra.remove(id, value);
                 }
 
                 void consolidate() {
+                    finish_background_consolidation();
+                    ++m_counters.consolidations;
                     m_main.erase_removed();
                     for (const auto& element : m_extra) {
                         m_main.set(element.first, element.second);
@@ -185,11 +360,13 @@ namespace osmium {
                 }
 
                 void clear() final {
+                    finish_background_consolidation();
                     m_main.clear();
                     m_extra.clear();
                 }
 
                 void sort() final {
+                    finish_background_consolidation();
                     m_main.sort();
                 }
 
@@ -79,6 +79,9 @@ namespace osmium {
 
                 SparseMemMultimap() = default;
 
+                SparseMemMultimap(SparseMemMultimap&&) = default;
+                SparseMemMultimap& operator=(SparseMemMultimap&&) = default;
+
                 ~SparseMemMultimap() noexcept final = default;
 
                 void unsorted_set(const TId id, const TValue value) {
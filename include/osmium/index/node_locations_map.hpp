@@ -47,6 +47,10 @@ DEALINGS IN THE SOFTWARE.
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseMemArray, dense_mem_array)
 #endif
 
+#ifdef OSMIUM_HAS_INDEX_MAP_DENSE_MEM_COMPRESSED
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseMemCompressed, dense_mem_compressed)
+#endif
+
 #ifdef OSMIUM_HAS_INDEX_MAP_DENSE_MMAP_ARRAY
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseMmapArray, dense_mmap_array)
 #endif
@@ -59,6 +63,10 @@ DEALINGS IN THE SOFTWARE.
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMemArray, sparse_mem_array)
 #endif
 
+#ifdef OSMIUM_HAS_INDEX_MAP_SPARSE_MEM_HASH_MAP
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMemHashMap, sparse_mem_hash_map)
+#endif
+
 #ifdef OSMIUM_HAS_INDEX_MAP_SPARSE_MEM_MAP
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMemMap, sparse_mem_map)
 #endif
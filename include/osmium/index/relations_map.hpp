@@ -36,11 +36,13 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/relation.hpp>
 #include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
 
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <future>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -87,6 +89,27 @@ namespace osmium {
 
                 std::vector<kv_pair> m_map;
 
+                struct sort_task {
+                    kv_pair* first;
+                    kv_pair* last;
+
+                    bool operator()() const {
+                        std::sort(first, last);
+                        return true;
+                    }
+                }; // struct sort_task
+
+                struct merge_task {
+                    kv_pair* first;
+                    kv_pair* middle;
+                    kv_pair* last;
+
+                    bool operator()() const {
+                        std::inplace_merge(first, middle, last);
+                        return true;
+                    }
+                }; // struct merge_task
+
             public:
 
                 using const_iterator = typename std::vector<kv_pair>::const_iterator;
@@ -113,12 +136,100 @@ namespace osmium {
                     return map;
                 }
 
+                /**
+                 * Append the contents of another map to this one. The
+                 * result is unsorted, call sort_unique() afterwards.
+                 */
+                void append(flat_map&& other) {
+                    if (m_map.empty()) {
+                        m_map = std::move(other.m_map);
+                    } else {
+                        m_map.insert(m_map.end(), other.m_map.begin(), other.m_map.end());
+                    }
+                    other.m_map.clear();
+                }
+
                 void sort_unique() {
                     std::sort(m_map.begin(), m_map.end());
                     const auto last = std::unique(m_map.begin(), m_map.end());
                     m_map.erase(last, m_map.end());
                 }
 
+                /**
+                 * Same as sort_unique(), but sorts chunks of the data as
+                 * parallel tasks on the given thread pool and then merges
+                 * neighbouring chunks in parallel rounds. Falls back to
+                 * the single-threaded version for small maps where the
+                 * task overhead would dominate.
+                 */
+                void sort_unique(osmium::thread::Pool& pool) {
+                    enum : std::size_t {
+                        min_chunk_size = 64ul * 1024ul
+                    };
+
+                    const std::size_t num_chunks = std::min<std::size_t>(static_cast<std::size_t>(pool.num_threads()),
+                                                                         m_map.size() / min_chunk_size);
+                    if (num_chunks < 2) {
+                        sort_unique();
+                        return;
+                    }
+
+                    std::vector<kv_pair*> bounds;
+                    bounds.reserve(num_chunks + 1);
+                    const std::size_t chunk_size = m_map.size() / num_chunks;
+                    for (std::size_t n = 0; n < num_chunks; ++n) {
+                        bounds.push_back(m_map.data() + n * chunk_size);
+                    }
+                    bounds.push_back(m_map.data() + m_map.size());
+
+                    {
+                        std::vector<std::future<bool>> results;
+                        results.reserve(num_chunks);
+                        for (std::size_t n = 0; n < num_chunks; ++n) {
+                            results.push_back(pool.submit(sort_task{bounds[n], bounds[n + 1]}));
+                        }
+                        for (auto& result : results) {
+                            result.get();
+                        }
+                    }
+
+                    // Merge pairs of neighbouring sorted chunks until only
+                    // one chunk is left. The merges in each round work on
+                    // disjoint ranges and run in parallel, the number of
+                    // chunks halves in each round.
+                    while (bounds.size() > 2) {
+                        std::vector<std::future<bool>> results;
+                        std::vector<kv_pair*> next_bounds;
+                        next_bounds.reserve(bounds.size() / 2 + 2);
+                        next_bounds.push_back(bounds.front());
+                        std::size_t n = 0;
+                        for (; n + 2 < bounds.size(); n += 2) {
+                            results.push_back(pool.submit(merge_task{bounds[n], bounds[n + 1], bounds[n + 2]}));
+                            next_bounds.push_back(bounds[n + 2]);
+                        }
+                        if (n + 1 < bounds.size()) {
+                            // odd chunk at the end, stays as it is this round
+                            next_bounds.push_back(bounds[n + 1]);
+                        }
+                        for (auto& result : results) {
+                            result.get();
+                        }
+                        using std::swap;
+                        swap(bounds, next_bounds);
+                    }
+
+                    const auto last = std::unique(m_map.begin(), m_map.end());
+                    m_map.erase(last, m_map.end());
+                }
+
+                const_iterator begin() const noexcept {
+                    return m_map.begin();
+                }
+
+                const_iterator end() const noexcept {
+                    return m_map.end();
+                }
+
                 std::pair<const_iterator, const_iterator> get(const key_type key) const noexcept {
                     return std::equal_range(m_map.begin(), m_map.end(), kv_pair{key}, [](const kv_pair& lhs, const kv_pair& rhs) {
                         return lhs.key < rhs.key;
@@ -238,6 +349,23 @@ namespace osmium {
                 }
             }
 
+            /**
+             * Call the given function with each (id, related id) pair in
+             * the index, in sorted order. This can be used to dump the
+             * contents of the index, for instance to persist it between
+             * program runs. To rebuild the index, call
+             * RelationsMapStash::add() with each pair.
+             *
+             * Complexity: Linear in the number of elements in the index.
+             */
+            template <typename TFunc>
+            void for_each_entry(TFunc&& func) const {
+                for (const auto& entry : m_map) {
+                    std::forward<TFunc>(func)(osmium::unsigned_object_id_type(entry.key),
+                                              osmium::unsigned_object_id_type(entry.value));
+                }
+            }
+
             /**
              * Is this index empty?
              *
@@ -353,6 +481,19 @@ namespace osmium {
                 }
             }
 
+            /**
+             * Merge the contents of another stash into this one. Use this
+             * to combine stashes that were filled independently, for
+             * instance from different threads each reading part of the
+             * input, before building the index. The other stash is empty
+             * afterwards.
+             */
+            void merge(RelationsMapStash&& other) {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_index()");
+                assert(other.m_valid && "You can't use the RelationsMap any more after calling build_index()");
+                m_map.append(std::move(other.m_map));
+            }
+
             /**
              * Is this stash empty?
              *
@@ -405,6 +546,19 @@ namespace osmium {
                 return RelationsMapIndex{std::move(m_map)};
             }
 
+            /**
+             * Same as build_member_to_parent_index(), but does the sorting
+             * in parallel on the given thread pool.
+             */
+            RelationsMapIndex build_member_to_parent_index(osmium::thread::Pool& pool) {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_member_to_parent_index()");
+                m_map.sort_unique(pool);
+#ifndef NDEBUG
+                m_valid = false;
+#endif
+                return RelationsMapIndex{std::move(m_map)};
+            }
+
             /**
              * Build an index for parent to member lookups from the contents
              * of this stash and return it.
@@ -421,6 +575,20 @@ namespace osmium {
                 return RelationsMapIndex{std::move(m_map)};
             }
 
+            /**
+             * Same as build_parent_to_member_index(), but does the sorting
+             * in parallel on the given thread pool.
+             */
+            RelationsMapIndex build_parent_to_member_index(osmium::thread::Pool& pool) {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_parent_to_member_index()");
+                m_map.flip_in_place();
+                m_map.sort_unique(pool);
+#ifndef NDEBUG
+                m_valid = false;
+#endif
+                return RelationsMapIndex{std::move(m_map)};
+            }
+
             /**
              * Build indexes for member-to-parent and parent-to-member lookups
              * from the contents of this stash and return them.
@@ -438,6 +606,21 @@ namespace osmium {
                 return RelationsMapIndexes{std::move(m_map), std::move(reverse_map)};
             }
 
+            /**
+             * Same as build_indexes(), but does the sorting in parallel
+             * on the given thread pool.
+             */
+            RelationsMapIndexes build_indexes(osmium::thread::Pool& pool) {
+                assert(m_valid && "You can't use the RelationsMap any more after calling build_indexes()");
+                auto reverse_map = m_map.flip_copy();
+                reverse_map.sort_unique(pool);
+                m_map.sort_unique(pool);
+#ifndef NDEBUG
+                m_valid = false;
+#endif
+                return RelationsMapIndexes{std::move(m_map), std::move(reverse_map)};
+            }
+
         }; // class RelationsMapStash
 
         // defined outside the class on purpose
@@ -39,10 +39,20 @@ DEALINGS IN THE SOFTWARE.
  * Include this file if you want to read or write compressed OSM XML files.
  *
  * @attention If you include this file, you'll need to link with `libz`
- *            and `libbz2`.
+ *            and `libbz2`. If you define `OSMIUM_WITH_ZSTD` or
+ *            `OSMIUM_WITH_LZ4` you'll also need to link with `libzstd`
+ *            or `liblz4`, respectively.
  */
 
 #include <osmium/io/bzip2_compression.hpp> // IWYU pragma: export
 #include <osmium/io/gzip_compression.hpp> // IWYU pragma: export
 
+#ifdef OSMIUM_WITH_ZSTD
+# include <osmium/io/zstd_compression.hpp> // IWYU pragma: export
+#endif
+
+#ifdef OSMIUM_WITH_LZ4
+# include <osmium/io/lz4_compression.hpp> // IWYU pragma: export
+#endif
+
 #endif // OSMIUM_IO_ANY_COMPRESSION_HPP
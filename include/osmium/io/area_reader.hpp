@@ -0,0 +1,240 @@
+#ifndef OSMIUM_IO_AREA_READER_HPP
+#define OSMIUM_IO_AREA_READER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/area/assembler.hpp>
+#include <osmium/area/multipolygon_collector.hpp>
+#include <osmium/handler/node_locations_for_ways.hpp> // IWYU pragma: keep
+#include <osmium/io/file.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/visitor.hpp>
+
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * A reader that bolts multipolygon area assembly onto reading:
+         * read() delivers buffers containing the objects of the file
+         * plus the areas assembled from its closed ways and
+         * multipolygon relations.
+         *
+         * On construction the relations of the file are read once to
+         * prime the collector, then the file is read again for the
+         * actual data. During the second read the location handling
+         * and area assembly for one buffer run as a task on the given
+         * thread pool while the reader is already decoding the next
+         * buffer, so assembly overlaps with the decode pipeline
+         * instead of serializing behind it on the calling thread.
+         *
+         * Because the collector is stateful, only one assembly task is
+         * ever in flight; the parallelism comes from overlapping it
+         * with the decoding, not from assembling several buffers at
+         * once.
+         *
+         * @code
+         * index_type index;
+         * location_handler_type location_handler{index};
+         * osmium::io::AreaReader<location_handler_type> reader{filename, location_handler};
+         * while (osmium::memory::Buffer buffer = reader.read()) {
+         *     // contains nodes, ways, relations, and areas
+         * }
+         * reader.close();
+         * @endcode
+         *
+         * This is the supported successor of the experimental
+         * FlexReader which did all the assembly work inline on the
+         * calling thread.
+         */
+        template <typename TLocationHandler>
+        class AreaReader {
+
+            bool m_with_areas;
+            osmium::osm_entity_bits::type m_entities;
+
+            TLocationHandler& m_location_handler;
+
+            osmium::thread::Pool* m_pool;
+            osmium::io::Reader m_reader;
+            osmium::area::Assembler::config_type m_assembler_config{};
+            osmium::area::MultipolygonCollector<osmium::area::Assembler> m_collector;
+
+            /// The buffer currently being processed on the pool.
+            std::future<osmium::memory::Buffer> m_pending{};
+
+            /// Did the underlying reader deliver its last buffer?
+            bool m_at_end = false;
+
+            /**
+             * Run the location handler and the collector over the
+             * buffer and append any assembled areas to it. Runs as a
+             * task on the pool, but never for more than one buffer at
+             * a time, so it can use the stateful handler and collector.
+             */
+            osmium::memory::Buffer process(osmium::memory::Buffer&& buffer) {
+                if (m_with_areas) {
+                    std::vector<osmium::memory::Buffer> area_buffers;
+                    osmium::apply(buffer, m_location_handler, m_collector.handler([&area_buffers](osmium::memory::Buffer&& area_buffer) {
+                        area_buffers.push_back(std::move(area_buffer));
+                    }));
+                    for (const osmium::memory::Buffer& b : area_buffers) {
+                        buffer.add_buffer(b);
+                        buffer.commit();
+                    }
+                } else if (m_entities & (osmium::osm_entity_bits::node | osmium::osm_entity_bits::way)) {
+                    osmium::apply(buffer, m_location_handler);
+                }
+                return std::move(buffer);
+            }
+
+            // Task functor submitted to the pool. Holds the buffer, so
+            // it must be movable but doesn't need to be copyable.
+            struct process_task {
+
+                AreaReader* reader;
+                osmium::memory::Buffer buffer;
+
+                osmium::memory::Buffer operator()() {
+                    return reader->process(std::move(buffer));
+                }
+
+            }; // struct process_task
+
+            void submit(osmium::memory::Buffer&& buffer) {
+                m_pending = m_pool->submit(osmium::thread::Pool::priority::high,
+                                           process_task{this, std::move(buffer)});
+            }
+
+        public:
+
+            explicit AreaReader(const osmium::io::File& file, TLocationHandler& location_handler,
+                                osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::nwr | osmium::osm_entity_bits::area,
+                                osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) :
+                m_with_areas((entities & osmium::osm_entity_bits::area) != 0),
+                m_entities((entities & ~osmium::osm_entity_bits::area) | (m_with_areas ? osmium::osm_entity_bits::node | osmium::osm_entity_bits::way : osmium::osm_entity_bits::nothing)),
+                m_location_handler(location_handler),
+                m_pool(&pool),
+                m_reader(file, pool, m_entities),
+                m_collector(m_assembler_config)
+            {
+                m_location_handler.ignore_errors();
+                if (m_with_areas) {
+                    osmium::io::Reader reader{file, pool, osmium::osm_entity_bits::relation};
+                    m_collector.read_relations(reader);
+                    reader.close();
+                }
+            }
+
+            explicit AreaReader(const std::string& filename, TLocationHandler& location_handler,
+                                osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::nwr | osmium::osm_entity_bits::area,
+                                osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) :
+                AreaReader(osmium::io::File(filename), location_handler, entities, pool) {
+            }
+
+            explicit AreaReader(const char* filename, TLocationHandler& location_handler,
+                                osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::nwr | osmium::osm_entity_bits::area,
+                                osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) :
+                AreaReader(osmium::io::File(filename), location_handler, entities, pool) {
+            }
+
+            /**
+             * Get the next buffer with the objects of the file plus
+             * the areas assembled from them. Returns an invalid
+             * buffer at the end of the file.
+             */
+            osmium::memory::Buffer read() {
+                if (!m_pending.valid()) {
+                    if (m_at_end) {
+                        return osmium::memory::Buffer{};
+                    }
+                    osmium::memory::Buffer buffer = m_reader.read();
+                    if (!buffer) {
+                        m_at_end = true;
+                        return buffer;
+                    }
+                    submit(std::move(buffer));
+                }
+
+                // Read the next buffer while the pending one is being
+                // processed on the pool.
+                osmium::memory::Buffer next{};
+                if (!m_at_end) {
+                    next = m_reader.read();
+                    if (!next) {
+                        m_at_end = true;
+                    }
+                }
+
+                osmium::memory::Buffer result = m_pending.get();
+                if (next) {
+                    submit(std::move(next));
+                }
+                return result;
+            }
+
+            osmium::io::Header header() {
+                return m_reader.header();
+            }
+
+            void close() {
+                if (m_pending.valid()) {
+                    m_pending.get();
+                }
+                return m_reader.close();
+            }
+
+            bool eof() const {
+                return m_at_end && !m_pending.valid();
+            }
+
+            const osmium::area::MultipolygonCollector<osmium::area::Assembler>& collector() const {
+                return m_collector;
+            }
+
+        }; // class AreaReader
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_AREA_READER_HPP
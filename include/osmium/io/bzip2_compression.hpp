@@ -40,6 +40,10 @@ DEALINGS IN THE SOFTWARE.
  * files.
  *
  * @attention If you include this file, you'll need to link with `libbz2`.
+ *
+ * @attention Define `OSMIUM_WITH_PARALLEL_BZIP2` if you want bzip2 files
+ *            to be read with the multithreaded ParallelBzip2Decompressor
+ *            instead of the single-threaded Bzip2Decompressor.
  */
 
 #include <osmium/io/compression.hpp>
@@ -50,6 +54,10 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/util/compatibility.hpp>
 #include <osmium/util/file.hpp>
 
+#ifdef OSMIUM_WITH_PARALLEL_BZIP2
+# include <osmium/thread/pool.hpp>
+#endif
+
 #include <bzlib.h>
 
 #include <cassert>
@@ -59,6 +67,13 @@ DEALINGS IN THE SOFTWARE.
 #include <string>
 #include <system_error>
 
+#ifdef OSMIUM_WITH_PARALLEL_BZIP2
+# include <cstddef>
+# include <future>
+# include <queue>
+# include <utility>
+#endif
+
 #ifndef _MSC_VER
 # include <unistd.h>
 #endif
@@ -319,6 +334,298 @@ namespace osmium {
 
         }; // class Bzip2Decompressor
 
+#ifdef OSMIUM_WITH_PARALLEL_BZIP2
+
+        /**
+         * Multithreaded bzip2 decompressor modelled after the pbzip2
+         * program. Multi-stream bzip2 files (as written by pbzip2 and
+         * similar programs) consist of many short, independently
+         * decompressible streams. The input is scanned for the byte-aligned
+         * stream header magic, the streams are decompressed concurrently on
+         * the shared thread pool and the results are handed out in file
+         * order.
+         *
+         * Files consisting of a single long stream (as written by the
+         * bzip2 program itself) can not be split this way, they are
+         * detected and decompressed serially like in the Bzip2Decompressor.
+         */
+        class ParallelBzip2Decompressor : public Decompressor {
+
+            enum : std::size_t {
+                raw_read_size = 1024u * 1024u,
+
+                // Single-stream files are detected by not finding a second
+                // stream header within this many bytes. Streams written by
+                // pbzip2 are always much shorter than this.
+                detect_limit = 16u * 1024u * 1024u,
+
+                max_streams_in_flight = 16u
+            };
+
+            struct pending_stream {
+                std::future<std::string> result;
+                std::size_t raw_size;
+            };
+
+            std::queue<pending_stream> m_results{};
+            std::string m_raw{};
+            osmium::thread::Pool& m_pool;
+            bz_stream m_bzstream{};
+            std::size_t m_scan_pos = 1;
+            std::size_t m_offset = 0;
+            int m_fd;
+            bool m_parallel = false;
+            bool m_eof = false;
+            bool m_stream_open = false;
+
+            /// Decompress one complete bzip2 stream in one go.
+            static std::string decompress_stream(const std::string& input) {
+                bz_stream bzstream{};
+                int result = BZ2_bzDecompressInit(&bzstream, 0, 0);
+                if (result != BZ_OK) {
+                    throw bzip2_error{"bzip2 error: decompression init failed: ", result};
+                }
+
+                assert(input.size() < std::numeric_limits<unsigned int>::max());
+                bzstream.next_in = const_cast<char*>(input.data());
+                bzstream.avail_in = static_cast<unsigned int>(input.size());
+
+                std::string output;
+                while (result == BZ_OK) {
+                    const std::size_t old_size = output.size();
+                    output.resize(old_size + osmium::io::Decompressor::input_buffer_size);
+                    bzstream.next_out = &output[old_size];
+                    bzstream.avail_out = osmium::io::Decompressor::input_buffer_size;
+
+                    result = BZ2_bzDecompress(&bzstream);
+                    output.resize(output.size() - bzstream.avail_out);
+
+                    if (result == BZ_OK && bzstream.avail_in == 0 && bzstream.avail_out != 0) {
+                        result = BZ_UNEXPECTED_EOF;
+                    }
+                }
+                BZ2_bzDecompressEnd(&bzstream);
+
+                if (result != BZ_STREAM_END) {
+                    throw bzip2_error{"bzip2 error: decompress failed: ", result};
+                }
+
+                return output;
+            }
+
+            /// Read more compressed data from the file into m_raw.
+            void fill_raw() {
+                const std::size_t old_size = m_raw.size();
+                m_raw.resize(old_size + raw_read_size);
+                const auto nread = osmium::io::detail::reliable_read(m_fd, &m_raw[old_size], raw_read_size);
+                m_raw.resize(old_size + static_cast<std::size_t>(nread));
+                if (nread == 0) {
+                    m_eof = true;
+                }
+            }
+
+            /**
+             * Find the next byte-aligned bzip2 stream header in m_raw at or
+             * after m_scan_pos. A header inside compressed data can only
+             * match by accident on a byte boundary, which is extremely
+             * unlikely for the full 10 magic bytes.
+             */
+            std::size_t find_stream_header() {
+                static const char magic[] = {0x31, 0x41, 0x59, 0x26, 0x53, 0x59}; // block magic "pi"
+                while (m_scan_pos + 10 <= m_raw.size()) {
+                    const std::size_t pos = m_raw.find("BZh", m_scan_pos, 3);
+                    if (pos == std::string::npos || pos + 10 > m_raw.size()) {
+                        break;
+                    }
+                    if (m_raw[pos + 3] >= '1' && m_raw[pos + 3] <= '9' &&
+                        m_raw.compare(pos + 4, 6, magic, 6) == 0) {
+                        return pos;
+                    }
+                    m_scan_pos = pos + 1;
+                }
+                // remember where to continue scanning, the last 9 bytes
+                // could contain the start of a header
+                m_scan_pos = m_raw.size() > 9 ? m_raw.size() - 9 : 1;
+                return std::string::npos;
+            }
+
+            void submit(std::size_t size) {
+                std::string input{m_raw.substr(0, size)};
+                m_raw.erase(0, size);
+                m_scan_pos = 1;
+                pending_stream stream{m_pool.submit(decompress_task{std::move(input)}), size};
+                m_results.push(std::move(stream));
+            }
+
+            struct decompress_task {
+
+                std::string input;
+
+                std::string operator()() const {
+                    return decompress_stream(input);
+                }
+
+            }; // struct decompress_task
+
+            /// Cut complete streams out of m_raw and submit them to the pool.
+            void submit_streams() {
+                while (m_results.size() < max_streams_in_flight) {
+                    const std::size_t pos = find_stream_header();
+                    if (pos != std::string::npos) {
+                        submit(pos);
+                        continue;
+                    }
+                    if (m_eof) {
+                        if (!m_raw.empty()) {
+                            submit(m_raw.size());
+                        }
+                        break;
+                    }
+                    fill_raw();
+                }
+            }
+
+            std::string read_serial() {
+                std::string output;
+
+                if (!m_stream_open) {
+                    return output;
+                }
+
+                while (true) {
+                    if (m_raw.empty() && !m_eof) {
+                        fill_raw();
+                    }
+
+                    output.resize(osmium::io::Decompressor::input_buffer_size);
+                    assert(m_raw.size() < std::numeric_limits<unsigned int>::max());
+                    m_bzstream.next_in = const_cast<char*>(m_raw.data());
+                    m_bzstream.avail_in = static_cast<unsigned int>(m_raw.size());
+                    m_bzstream.next_out = &*output.begin();
+                    m_bzstream.avail_out = static_cast<unsigned int>(output.size());
+
+                    const int result = BZ2_bzDecompress(&m_bzstream);
+                    if (result != BZ_OK && result != BZ_STREAM_END) {
+                        throw bzip2_error{"bzip2 error: decompress failed: ", result};
+                    }
+
+                    const std::size_t consumed = m_raw.size() - m_bzstream.avail_in;
+                    m_raw.erase(0, consumed);
+                    m_offset += consumed;
+                    output.resize(output.size() - m_bzstream.avail_out);
+
+                    if (result == BZ_STREAM_END) {
+                        BZ2_bzDecompressEnd(&m_bzstream);
+                        m_stream_open = false;
+                        if (!m_raw.empty() || !m_eof) {
+                            // a multi-stream file, the next stream follows
+                            if (BZ2_bzDecompressInit(&m_bzstream, 0, 0) != BZ_OK) {
+                                throw bzip2_error{"bzip2 error: decompression init failed: ", BZ_MEM_ERROR};
+                            }
+                            m_stream_open = true;
+                        }
+                        return output;
+                    }
+
+                    if (!output.empty()) {
+                        return output;
+                    }
+
+                    if (m_raw.empty() && m_eof) {
+                        throw bzip2_error{"bzip2 error: decompress failed: ", BZ_UNEXPECTED_EOF};
+                    }
+                }
+            }
+
+        public:
+
+            explicit ParallelBzip2Decompressor(const int fd) :
+                m_pool(osmium::thread::Pool::default_instance()),
+                m_fd(fd) {
+                fill_raw();
+
+                if (!m_raw.empty() &&
+                    (m_raw.size() < 4 || m_raw.compare(0, 3, "BZh") != 0 ||
+                     m_raw[3] < '1' || m_raw[3] > '9')) {
+                    osmium::io::detail::reliable_close(m_fd);
+                    throw bzip2_error{"bzip2 error: read open failed", BZ_DATA_ERROR_MAGIC};
+                }
+
+                // look for a second stream header to decide whether this is
+                // a splittable multi-stream file
+                while (!m_parallel && !m_eof && m_raw.size() < detect_limit) {
+                    m_parallel = find_stream_header() != std::string::npos;
+                    if (!m_parallel) {
+                        fill_raw();
+                    }
+                }
+                m_parallel = m_parallel || find_stream_header() != std::string::npos;
+                m_scan_pos = 1;
+
+                if (!m_parallel && !m_raw.empty()) {
+                    if (BZ2_bzDecompressInit(&m_bzstream, 0, 0) != BZ_OK) {
+                        osmium::io::detail::reliable_close(m_fd);
+                        throw bzip2_error{"bzip2 error: read open failed", BZ_MEM_ERROR};
+                    }
+                    m_stream_open = true;
+                }
+            }
+
+            ParallelBzip2Decompressor(const ParallelBzip2Decompressor&) = delete;
+            ParallelBzip2Decompressor& operator=(const ParallelBzip2Decompressor&) = delete;
+
+            ParallelBzip2Decompressor(ParallelBzip2Decompressor&&) = delete;
+            ParallelBzip2Decompressor& operator=(ParallelBzip2Decompressor&&) = delete;
+
+            ~ParallelBzip2Decompressor() noexcept final {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            std::string read() final {
+                if (!m_parallel) {
+                    const std::string output{read_serial()};
+                    set_offset(m_offset);
+                    return output;
+                }
+
+                submit_streams();
+
+                std::string output;
+                if (!m_results.empty()) {
+                    output = m_results.front().result.get();
+                    m_offset += m_results.front().raw_size;
+                    m_results.pop();
+                }
+
+                set_offset(m_offset);
+                return output;
+            }
+
+            void close() final {
+                if (m_stream_open) {
+                    BZ2_bzDecompressEnd(&m_bzstream);
+                    m_stream_open = false;
+                }
+                // wait for all outstanding results so exceptions from the
+                // pool threads are not lost
+                while (!m_results.empty()) {
+                    m_results.front().result.get();
+                    m_results.pop();
+                }
+                if (m_fd >= 0) {
+                    osmium::io::detail::reliable_close(m_fd);
+                    m_fd = -1;
+                }
+            }
+
+        }; // class ParallelBzip2Decompressor
+
+#endif
+
         class Bzip2BufferDecompressor : public Decompressor {
 
             const char* m_buffer;
@@ -391,7 +698,11 @@ namespace osmium {
             // the variable is only a side-effect, it will never be used
             const bool registered_bzip2_compression = osmium::io::CompressionFactory::instance().register_compression(osmium::io::file_compression::bzip2,
                 [](const int fd, const fsync sync) { return new osmium::io::Bzip2Compressor{fd, sync}; },
+#ifdef OSMIUM_WITH_PARALLEL_BZIP2
+                [](const int fd) { return new osmium::io::ParallelBzip2Decompressor{fd}; },
+#else
                 [](const int fd) { return new osmium::io::Bzip2Decompressor{fd}; },
+#endif
                 [](const char* buffer, const std::size_t size) { return new osmium::io::Bzip2BufferDecompressor{buffer, size}; }
             );
 
@@ -0,0 +1,252 @@
+#ifndef OSMIUM_IO_CHANGESET_INDEX_HPP
+#define OSMIUM_IO_CHANGESET_INDEX_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Sidecar index for time-window and bounding-box queries on changeset
+ * dumps. Include this file if you want to build, store or use changeset
+ * indexes.
+ *
+ * The index records for every changeset when it was created and closed,
+ * its bounds, and a caller-supplied file offset. With it, queries like
+ * "all changesets closed last week touching this region" become a
+ * binary search over a small sidecar file followed by seeks into the
+ * dump, instead of a scan over the whole dump.
+ */
+
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/io/writer_options.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/changeset.hpp>
+#include <osmium/osm/timestamp.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Index entry describing one changeset in a changeset dump.
+         */
+        struct changeset_info {
+
+            /// Offset given when the entry was added, see ChangesetIndex::add().
+            uint64_t offset = 0;
+
+            /// Id of the changeset.
+            osmium::changeset_id_type id = 0;
+
+            /// Creation time in seconds since the epoch.
+            uint32_t created_at = 0;
+
+            /// Close time in seconds since the epoch, 0 for open changesets.
+            uint32_t closed_at = 0;
+
+            /// Bounds of the changeset, an undefined Box if it has none.
+            osmium::Box bounds{};
+
+        }; // struct changeset_info
+
+        /**
+         * Index over the changesets of a changeset dump. Can be built by
+         * reading the dump once and then written to and read from a small
+         * sidecar file, so the scan cost is only paid once.
+         *
+         * The index is sorted by close time; open changesets count with
+         * their creation time. Call sort() after adding entries and
+         * before calling select() or write().
+         */
+        class ChangesetIndex {
+
+            std::vector<changeset_info> m_changesets{};
+
+            enum : uint32_t {
+                sidecar_magic   = 0x58444943u, // "CIDX"
+                sidecar_version = 1u
+            };
+
+            // Open changesets have no close time, they are sorted and
+            // queried by their creation time instead.
+            static uint32_t sort_key(const changeset_info& info) noexcept {
+                return info.closed_at != 0 ? info.closed_at : info.created_at;
+            }
+
+            static bool overlap(const osmium::Box& a, const osmium::Box& b) noexcept {
+                return a.bottom_left().x() <= b.top_right().x() &&
+                       a.top_right().x() >= b.bottom_left().x() &&
+                       a.bottom_left().y() <= b.top_right().y() &&
+                       a.top_right().y() >= b.bottom_left().y();
+            }
+
+        public:
+
+            ChangesetIndex() noexcept = default;
+
+            const std::vector<changeset_info>& changesets() const noexcept {
+                return m_changesets;
+            }
+
+            bool empty() const noexcept {
+                return m_changesets.empty();
+            }
+
+            std::size_t size() const noexcept {
+                return m_changesets.size();
+            }
+
+            /**
+             * Add an index entry for the given changeset. The offset is
+             * stored verbatim for the caller; typically it is the offset
+             * of the blob or byte range in the dump file the changeset
+             * can be re-read from.
+             */
+            void add(const osmium::Changeset& changeset, const uint64_t offset) {
+                changeset_info info;
+                info.offset = offset;
+                info.id = changeset.id();
+                info.created_at = static_cast<uint32_t>(changeset.created_at().seconds_since_epoch());
+                info.closed_at = static_cast<uint32_t>(changeset.closed_at().seconds_since_epoch());
+                info.bounds = changeset.bounds();
+                m_changesets.push_back(info);
+            }
+
+            /// Sort the index by close time.
+            void sort() {
+                std::stable_sort(m_changesets.begin(), m_changesets.end(),
+                                 [](const changeset_info& lhs, const changeset_info& rhs) {
+                    return sort_key(lhs) < sort_key(rhs);
+                });
+            }
+
+            /**
+             * Write the index to a sidecar file. The format is a small
+             * header followed by the raw index entries; it is not portable
+             * between architectures with different endianness.
+             */
+            void write(const std::string& filename, const osmium::io::overwrite allow_overwrite = osmium::io::overwrite::no) const {
+                const int fd = detail::open_for_writing(filename, allow_overwrite);
+
+                const uint32_t header[4] = {
+                    sidecar_magic,
+                    sidecar_version,
+                    static_cast<uint32_t>(sizeof(changeset_info)),
+                    static_cast<uint32_t>(m_changesets.size())
+                };
+                detail::reliable_write(fd, reinterpret_cast<const char*>(header), sizeof(header));
+                detail::reliable_write(fd, reinterpret_cast<const char*>(m_changesets.data()), sizeof(changeset_info) * m_changesets.size());
+                detail::reliable_close(fd);
+            }
+
+            /**
+             * Read an index from a sidecar file written with write().
+             *
+             * @throws osmium::io_error if the file is not a valid sidecar
+             *         index file.
+             */
+            void read(const std::string& filename) {
+                m_changesets.clear();
+
+                const int fd = detail::open_for_reading(filename);
+
+                uint32_t header[4] = {0, 0, 0, 0};
+                if (detail::reliable_read(fd, reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header) ||
+                    header[0] != sidecar_magic ||
+                    header[1] != sidecar_version ||
+                    header[2] != sizeof(changeset_info)) {
+                    detail::reliable_close(fd);
+                    throw osmium::io_error{"not a changeset index file: " + filename};
+                }
+
+                m_changesets.resize(header[3]);
+                const auto len = sizeof(changeset_info) * m_changesets.size();
+                if (static_cast<std::size_t>(detail::reliable_read(fd, reinterpret_cast<char*>(m_changesets.data()), static_cast<unsigned int>(len))) != len) {
+                    detail::reliable_close(fd);
+                    throw osmium::io_error{"truncated changeset index file: " + filename};
+                }
+                detail::reliable_close(fd);
+            }
+
+            /**
+             * Get the entries of all changesets closed in the given time
+             * window (open changesets count with their creation time)
+             * whose bounds overlap the given box. An invalid box matches
+             * every changeset, including those without bounds; with a
+             * valid box, changesets without bounds never match.
+             *
+             * The time window is found with a binary search, so the
+             * index must be sorted, see sort().
+             */
+            std::vector<changeset_info> select(const osmium::Timestamp from = osmium::start_of_time(),
+                                               const osmium::Timestamp to = osmium::end_of_time(),
+                                               const osmium::Box& box = osmium::Box{}) const {
+                std::vector<changeset_info> result;
+
+                const auto from_sec = static_cast<uint32_t>(from.seconds_since_epoch());
+                const auto to_sec = static_cast<uint32_t>(to.seconds_since_epoch());
+
+                auto it = std::lower_bound(m_changesets.begin(), m_changesets.end(), from_sec,
+                                           [](const changeset_info& info, const uint32_t value) {
+                    return sort_key(info) < value;
+                });
+                const auto last = std::upper_bound(it, m_changesets.end(), to_sec,
+                                                   [](const uint32_t value, const changeset_info& info) {
+                    return value < sort_key(info);
+                });
+
+                for (; it != last; ++it) {
+                    if (box.valid() && (!it->bounds.valid() || !overlap(it->bounds, box))) {
+                        continue;
+                    }
+                    result.push_back(*it);
+                }
+
+                return result;
+            }
+
+        }; // class ChangesetIndex
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_CHANGESET_INDEX_HPP
@@ -0,0 +1,165 @@
+#ifndef OSMIUM_IO_CHECKPOINT_HPP
+#define OSMIUM_IO_CHECKPOINT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/error.hpp>
+#include <osmium/io/header.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * A checkpoint of a Reader reading a PBF file: the file offset
+         * of the first blob record not yet delivered to the application
+         * plus the file header. Get one from Reader::checkpoint(),
+         * store its to_string() serialization somewhere safe, and after
+         * a crash give a deserialized Checkpoint to a new Reader to
+         * resume reading where the crashed run left off, instead of
+         * repeating the whole run:
+         *
+         * @code
+         * osmium::io::Checkpoint checkpoint{serialized};
+         * osmium::io::Reader reader{"planet.osm.pbf", checkpoint};
+         * @endcode
+         *
+         * This only works for PBF files without outer compression,
+         * because only their blob records are self-contained. The
+         * bounding boxes of the header are not serialized.
+         */
+        class Checkpoint {
+
+            osmium::io::Header m_header{};
+            std::size_t m_offset = 0;
+
+        public:
+
+            Checkpoint() = default;
+
+            Checkpoint(const std::size_t offset, osmium::io::Header header) :
+                m_header(std::move(header)),
+                m_offset(offset) {
+            }
+
+            /**
+             * Construct from the serialization format written by
+             * to_string().
+             *
+             * @throws osmium::io_error If the data can't be parsed.
+             */
+            explicit Checkpoint(const std::string& serialized) {
+                std::size_t begin = 0;
+                while (begin < serialized.size()) {
+                    auto end = serialized.find('\n', begin);
+                    if (end == std::string::npos) {
+                        end = serialized.size();
+                    }
+                    const std::string line{serialized.substr(begin, end - begin)};
+                    begin = end + 1;
+
+                    const auto space = line.find(' ');
+                    if (space == std::string::npos) {
+                        throw io_error{"Invalid checkpoint data"};
+                    }
+                    const std::string key{line.substr(0, space)};
+                    const std::string value{line.substr(space + 1)};
+
+                    if (key == "offset") {
+                        m_offset = std::strtoull(value.c_str(), nullptr, 10);
+                    } else if (key == "multiple_object_versions") {
+                        m_header.set_has_multiple_object_versions(value == "true");
+                    } else if (key == "option") {
+                        const auto equals = value.find('=');
+                        if (equals == std::string::npos) {
+                            throw io_error{"Invalid checkpoint data"};
+                        }
+                        m_header.set(value.substr(0, equals), value.substr(equals + 1));
+                    } else {
+                        throw io_error{"Invalid checkpoint data"};
+                    }
+                }
+
+                if (m_offset == 0) {
+                    throw io_error{"Invalid checkpoint data"};
+                }
+            }
+
+            /// Is this a usable checkpoint?
+            bool valid() const noexcept {
+                return m_offset != 0;
+            }
+
+            /// File offset of the first blob record not yet delivered.
+            std::size_t offset() const noexcept {
+                return m_offset;
+            }
+
+            /// The file header from the interrupted run.
+            const osmium::io::Header& header() const noexcept {
+                return m_header;
+            }
+
+            /**
+             * Serialize into a simple line-based text format that can
+             * be written to a file and given to the constructor later.
+             * Header option values must not contain newlines.
+             */
+            std::string to_string() const {
+                std::string result{"offset "};
+                result += std::to_string(m_offset);
+                result += "\nmultiple_object_versions ";
+                result += m_header.has_multiple_object_versions() ? "true" : "false";
+                result += '\n';
+                for (const auto& option : m_header) {
+                    result += "option ";
+                    result += option.first;
+                    result += '=';
+                    result += option.second;
+                    result += '\n';
+                }
+                return result;
+            }
+
+        }; // class Checkpoint
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_CHECKPOINT_HPP
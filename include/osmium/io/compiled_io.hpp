@@ -0,0 +1,123 @@
+#ifndef OSMIUM_IO_COMPILED_IO_HPP
+#define OSMIUM_IO_COMPILED_IO_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Stable entry points into the I/O stack for use with the optional
+ * compiled osmium-io library (CMake option BUILD_IO_LIBRARY). Unlike
+ * the rest of Osmium this header doesn't pull in the parser and
+ * encoder implementations: they are compiled once, with LTO and
+ * whatever architecture flags the library build used, into the static
+ * library you link against. This keeps the compile time of programs
+ * using only these functions low and their I/O performance identical
+ * no matter which flags the programs themselves were built with.
+ *
+ * Programs needing the full flexibility of osmium::io::Reader and
+ * osmium::io::Writer should keep using those directly.
+ */
+
+#include <osmium/io/file.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * @brief Entry points implemented in the compiled osmium-io library
+         */
+        namespace compiled {
+
+            /**
+             * Read the header of the specified file.
+             *
+             * @throws osmium::io_error or a derived exception if the
+             *         file can not be opened or parsed.
+             */
+            osmium::io::Header read_header(const osmium::io::File& file);
+
+            /**
+             * Read the complete contents of the specified file into
+             * memory and return them as a vector of buffers.
+             *
+             * @param file The file to read.
+             * @param entities Which entity types to read.
+             * @throws osmium::io_error or a derived exception on any
+             *         error while opening or parsing the file.
+             */
+            std::vector<osmium::memory::Buffer> read_file(const osmium::io::File& file,
+                                                          osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::all);
+
+            /**
+             * Read the specified file and call the callback for every
+             * buffer of parsed data. Use this instead of read_file()
+             * when the data doesn't have to stay in memory.
+             *
+             * @param file The file to read.
+             * @param callback Called with every buffer read.
+             * @param entities Which entity types to read.
+             * @throws osmium::io_error or a derived exception on any
+             *         error while opening or parsing the file.
+             */
+            void for_each_buffer(const osmium::io::File& file,
+                                 const std::function<void(osmium::memory::Buffer&)>& callback,
+                                 osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::all);
+
+            /**
+             * Write the contents of the specified buffers to a file.
+             *
+             * @param file The file to write.
+             * @param header The header to write.
+             * @param buffers The data to write.
+             * @throws osmium::io_error or a derived exception on any
+             *         error while opening or writing the file.
+             */
+            void write_file(const osmium::io::File& file,
+                            const osmium::io::Header& header,
+                            const std::vector<osmium::memory::Buffer>& buffers);
+
+        } // namespace compiled
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_COMPILED_IO_HPP
@@ -38,10 +38,12 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/file_compression.hpp>
 #include <osmium/io/writer_options.hpp>
 #include <osmium/util/file.hpp>
+#include <osmium/util/tuning.hpp>
 
 #include <atomic>
 #include <cerrno>
 #include <cstddef>
+#include <cstdlib>
 #include <functional>
 #include <map>
 #include <memory>
@@ -91,6 +93,9 @@ namespace osmium {
 
         public:
 
+            // Default block size for reading. Uncompressed files use
+            // the input_buffer_size knob from the tuning registry
+            // instead, which defaults to this value.
             enum {
                 input_buffer_size = 1024u * 1024u
             };
@@ -260,15 +265,52 @@ namespace osmium {
 
         class NoDecompressor : public Decompressor {
 
+            struct buffer_free {
+                void operator()(char* ptr) const noexcept {
+                    ::free(ptr); // NOLINT(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+                }
+            };
+
+            // Aligned buffer the file is read into when direct io is
+            // used. A single buffer is enough, because the read thread
+            // reads strictly sequentially and copies the data out
+            // before the next read.
+            std::unique_ptr<char, buffer_free> m_aligned_buffer{};
+
             int m_fd = -1;
             const char* m_buffer = nullptr;
             std::size_t m_buffer_size = 0;
             std::size_t m_offset = 0;
 
+            // Size of the blocks read from the file, from the tuning
+            // registry. For direct io it is rounded up to a multiple
+            // of the required alignment.
+            std::size_t m_read_size = osmium::config::tuning().input_buffer_size;
+
+            // Read with direct io, bypassing the page cache.
+            bool m_direct = false;
+
+            // Direct io isn't available, drop data from the page cache
+            // after reading it instead.
+            bool m_evict = false;
+
+            bool m_eof = false;
+
         public:
 
             explicit NoDecompressor(const int fd) :
                 m_fd(fd) {
+                if (osmium::config::tuning().direct_reads) {
+                    m_read_size += detail::direct_io_alignment - 1;
+                    m_read_size -= m_read_size % detail::direct_io_alignment;
+                    m_aligned_buffer.reset(detail::allocate_aligned_buffer(m_read_size));
+                    if (m_aligned_buffer && detail::set_direct_io(fd)) {
+                        m_direct = true;
+                    } else {
+                        m_aligned_buffer.reset();
+                        m_evict = true;
+                    }
+                }
             }
 
             NoDecompressor(const char* buffer, const std::size_t size) :
@@ -299,10 +341,34 @@ namespace osmium {
                         m_buffer_size = 0;
                         buffer.append(m_buffer, size);
                     }
+                } else if (m_direct) {
+                    // Direct io bypasses the page cache, prefetch and
+                    // evict hints don't apply. The buffer size is a
+                    // multiple of the required alignment and reads are
+                    // strictly sequential, so the file offset stays
+                    // aligned, too. A short read means end of file: the
+                    // file offset may be unaligned then, so don't read
+                    // again after that.
+                    if (!m_eof) {
+                        const auto nread = detail::reliable_read(m_fd, m_aligned_buffer.get(), m_read_size);
+                        buffer.assign(m_aligned_buffer.get(), std::string::size_type(nread));
+                        if (std::size_t(nread) < m_read_size) {
+                            m_eof = true;
+                        }
+                    }
                 } else {
-                    buffer.resize(osmium::io::Decompressor::input_buffer_size);
-                    const auto nread = detail::reliable_read(m_fd, &*buffer.begin(), osmium::io::Decompressor::input_buffer_size);
+                    // Ask the kernel for the blocks after this one while
+                    // this one is being decoded downstream.
+                    detail::prefetch_hint(m_fd, m_offset + m_read_size, m_read_size * 4);
+                    buffer.resize(m_read_size);
+                    const auto nread = detail::reliable_read(m_fd, &*buffer.begin(), m_read_size);
                     buffer.resize(std::string::size_type(nread));
+                    if (m_evict) {
+                        // Drop the chunk just read from the page cache,
+                        // it will never be read again.
+                        const std::size_t aligned_offset = m_offset - (m_offset % detail::direct_io_alignment);
+                        detail::evict_hint(m_fd, aligned_offset, m_offset + buffer.size() - aligned_offset);
+                    }
                 }
 
                 m_offset += buffer.size();
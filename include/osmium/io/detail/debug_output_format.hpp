@@ -577,7 +577,7 @@ namespace osmium {
                 }
 
                 void write_buffer(osmium::memory::Buffer&& buffer) final {
-                    m_output_queue.push(m_pool.submit(DebugOutputBlock{std::move(buffer), m_options}));
+                    m_output_queue.push(m_pool.submit(osmium::thread::Pool::priority::high, DebugOutputBlock{std::move(buffer), m_options}));
                 }
 
             }; // class DebugOutputFormat
@@ -0,0 +1,65 @@
+#ifndef OSMIUM_IO_DETAIL_IDS_FILTER_HPP
+#define OSMIUM_IO_DETAIL_IDS_FILTER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/id_set.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <memory>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Sets of object ids, one per object type. Given as an option to
+         * an osmium::io::Reader it is pushed down into the PBF decoder:
+         * Only objects whose id is in the set for their type are decoded,
+         * all other objects are skipped before any buffer space is
+         * allocated for them. An unset pointer means all objects of that
+         * type are decoded, an empty set means none are. Objects with
+         * negative ids never match a set. Only the PBF parser supports
+         * this option, other parsers ignore it.
+         */
+        struct pbf_ids_filter {
+            std::shared_ptr<const osmium::index::IdSetDense<osmium::unsigned_object_id_type>> node_ids;
+            std::shared_ptr<const osmium::index::IdSetDense<osmium::unsigned_object_id_type>> way_ids;
+            std::shared_ptr<const osmium::index::IdSetDense<osmium::unsigned_object_id_type>> relation_ids;
+        };
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_IDS_FILTER_HPP
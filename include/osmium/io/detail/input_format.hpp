@@ -33,36 +33,144 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/io/detail/ids_filter.hpp>
 #include <osmium/io/detail/queue_util.hpp>
+#include <osmium/io/detail/tags_filter.hpp>
 #include <osmium/io/error.hpp>
 #include <osmium/io/file.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/metadata_options.hpp>
 #include <osmium/thread/pool.hpp>
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <functional>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
     namespace io {
 
+        /**
+         * A list of (offset, size) byte ranges of blob records in a PBF
+         * file. Given as an option to an osmium::io::Reader it restricts
+         * reading to those blobs. Usually created from a sidecar index,
+         * see osmium::io::PBFBlobIndex in osmium/io/pbf_blob_index.hpp.
+         */
+        struct pbf_blob_ranges {
+            std::shared_ptr<const std::vector<std::pair<std::uint64_t, std::uint64_t>>> ranges;
+        };
+
+        /**
+         * Option for osmium::io::Reader limiting how many decode tasks
+         * this reader may have outstanding in the thread pool at any
+         * time. Set this when many readers share one pool, so a single
+         * reader with a large file can not monopolize the pool and
+         * starve the others. 0 means no limit.
+         */
+        struct max_pool_tasks {
+            std::size_t value;
+        };
+
         namespace detail {
 
+            /**
+             * Log of the file offsets after each blob record of a PBF
+             * file, in delivery order. The PBF parser appends to it
+             * while parsing, the Reader reads from it to build a
+             * Checkpoint. Entry 0 is the offset of the first data blob
+             * (after the header blob), entry n the offset after the
+             * n-th data blob.
+             */
+            class blob_offset_log {
+
+                mutable std::mutex m_mutex;
+                std::vector<std::size_t> m_offsets;
+
+            public:
+
+                void add(const std::size_t offset) {
+                    std::lock_guard<std::mutex> lock{m_mutex};
+                    m_offsets.push_back(offset);
+                }
+
+                /**
+                 * The offset to resume at after n delivered buffers.
+                 * Returns 0 if that offset hasn't been logged (yet).
+                 */
+                std::size_t get(const std::size_t n) const {
+                    std::lock_guard<std::mutex> lock{m_mutex};
+                    return n < m_offsets.size() ? m_offsets[n] : 0;
+                }
+
+            }; // class blob_offset_log
+
             struct parser_arguments {
                 osmium::thread::Pool& pool;
-                future_string_queue_type& input_queue;
+                raw_data_queue& input_queue;
                 future_buffer_queue_type& output_queue;
                 std::promise<osmium::io::Header>& header_promise;
                 osmium::osm_entity_bits::type read_which_entities;
                 osmium::io::read_meta read_metadata;
+                osmium::io::read_discussions read_discussions;
+
+                // If set to read_visible::only, deleted object versions
+                // and versions directly superseded within the same data
+                // block are not decoded (PBF only).
+                osmium::io::read_visible read_visible_objects;
+
+                // If the whole input file is available in memory (for
+                // instance because the Reader memory-mapped it), these
+                // members point to it and parsers can read directly from
+                // there instead of through the input queue. The owner
+                // pointer keeps the memory alive as long as anything
+                // references it.
+                std::shared_ptr<void> memory_owner;
+                const char* memory_data;
+                std::size_t memory_size;
+
+                // If set, only the blob records in these byte ranges of
+                // the memory input are parsed (PBF only).
+                pbf_blob_ranges blob_ranges;
+
+                // If set, only objects with at least one matching tag
+                // are decoded (PBF only).
+                pbf_tags_filter tags_filter;
+
+                // If set, only objects whose ids are in these sets are
+                // decoded (PBF only).
+                pbf_ids_filter ids_filter;
+
+                // Maximum number of outstanding decode tasks in the
+                // thread pool, 0 for no limit.
+                std::size_t max_pool_tasks;
+
+                // If set, the parser logs the file offset after each
+                // blob record here, so the Reader can build a
+                // Checkpoint (PBF only).
+                blob_offset_log* offset_log;
+
+                // If not 0, don't parse the file header, use
+                // resume_header instead and start parsing data blob
+                // records at this file offset (PBF only, coming from
+                // an osmium::io::Checkpoint).
+                std::size_t resume_offset;
+                osmium::io::Header resume_header;
+
+                // Which metadata fields (version, timestamp, ...) of
+                // the objects to decode. Only consulted when
+                // read_metadata is read_meta::yes (PBF only).
+                osmium::metadata_options metadata_opts;
             };
 
             class Parser {
@@ -70,17 +178,91 @@ namespace osmium {
                 osmium::thread::Pool& m_pool;
                 future_buffer_queue_type& m_output_queue;
                 std::promise<osmium::io::Header>& m_header_promise;
-                queue_wrapper<std::string> m_input_queue;
+                raw_data_queue_wrapper m_input_queue;
                 osmium::osm_entity_bits::type m_read_which_entities;
                 osmium::io::read_meta m_read_metadata;
+                osmium::io::read_discussions m_read_discussions;
+                osmium::io::read_visible m_read_visible_objects;
                 bool m_header_is_done;
 
+                std::shared_ptr<void> m_memory_owner;
+                const char* m_memory_data;
+                std::size_t m_memory_size;
+                pbf_blob_ranges m_blob_ranges;
+                pbf_tags_filter m_tags_filter;
+                pbf_ids_filter m_ids_filter;
+                osmium::io::Header m_resume_header;
+                blob_offset_log* m_offset_log;
+                std::size_t m_resume_offset;
+                osmium::metadata_options m_metadata_opts;
+                osmium::thread::Pool::Quota m_quota;
+
             protected:
 
+                /**
+                 * Is the whole input file available in memory? If yes,
+                 * parsers supporting this can read directly from
+                 * memory_data() instead of going through the input queue.
+                 */
+                bool has_memory_input() const noexcept {
+                    return m_memory_data != nullptr;
+                }
+
+                const std::shared_ptr<void>& memory_owner() const noexcept {
+                    return m_memory_owner;
+                }
+
+                const char* memory_data() const noexcept {
+                    return m_memory_data;
+                }
+
+                std::size_t memory_size() const noexcept {
+                    return m_memory_size;
+                }
+
+                const pbf_blob_ranges& blob_ranges() const noexcept {
+                    return m_blob_ranges;
+                }
+
+                const pbf_tags_filter& tags_filter() const noexcept {
+                    return m_tags_filter;
+                }
+
+                const pbf_ids_filter& ids_filter() const noexcept {
+                    return m_ids_filter;
+                }
+
+                /// Log for blob record offsets, nullptr if not wanted.
+                blob_offset_log* offset_log() noexcept {
+                    return m_offset_log;
+                }
+
+                /**
+                 * If not 0, don't parse the file header, use
+                 * resume_header() instead and start parsing data blob
+                 * records at this file offset.
+                 */
+                std::size_t resume_offset() const noexcept {
+                    return m_resume_offset;
+                }
+
+                const osmium::io::Header& resume_header() const noexcept {
+                    return m_resume_header;
+                }
+
                 osmium::thread::Pool& get_pool() {
                     return m_pool;
                 }
 
+                /**
+                 * Submit decode tasks through this instead of directly
+                 * through get_pool(), so the max_pool_tasks limit of
+                 * the Reader is respected.
+                 */
+                osmium::thread::Pool::Quota& get_quota() noexcept {
+                    return m_quota;
+                }
+
                 osmium::osm_entity_bits::type read_types() const noexcept {
                     return m_read_which_entities;
                 }
@@ -89,6 +271,18 @@ namespace osmium {
                     return m_read_metadata;
                 }
 
+                osmium::metadata_options metadata_opts() const noexcept {
+                    return m_metadata_opts;
+                }
+
+                osmium::io::read_visible read_visible_objects() const noexcept {
+                    return m_read_visible_objects;
+                }
+
+                osmium::io::read_discussions read_discussions() const noexcept {
+                    return m_read_discussions;
+                }
+
                 bool header_is_done() const noexcept {
                     return m_header_is_done;
                 }
@@ -127,7 +321,20 @@ namespace osmium {
                     m_input_queue(args.input_queue),
                     m_read_which_entities(args.read_which_entities),
                     m_read_metadata(args.read_metadata),
-                    m_header_is_done(false) {
+                    m_read_discussions(args.read_discussions),
+                    m_read_visible_objects(args.read_visible_objects),
+                    m_header_is_done(false),
+                    m_memory_owner(args.memory_owner),
+                    m_memory_data(args.memory_data),
+                    m_memory_size(args.memory_size),
+                    m_blob_ranges(args.blob_ranges),
+                    m_tags_filter(args.tags_filter),
+                    m_ids_filter(args.ids_filter),
+                    m_resume_header(args.resume_header),
+                    m_offset_log(args.offset_log),
+                    m_resume_offset(args.resume_offset),
+                    m_metadata_opts(args.metadata_opts),
+                    m_quota(args.pool, args.max_pool_tasks) {
                 }
 
                 Parser(const Parser&) = delete;
@@ -36,6 +36,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/builder/osm_object_builder.hpp>
 #include <osmium/io/detail/input_format.hpp>
 #include <osmium/io/detail/queue_util.hpp>
+#include <osmium/io/detail/varint_decode.hpp>
 #include <osmium/io/error.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
@@ -65,6 +66,7 @@ DEALINGS IN THE SOFTWARE.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -101,26 +103,57 @@ namespace osmium {
                     number_of_entries = 15000u
                 };
 
-                // The size of one entry in the table.
-                enum {
-                    entry_size = 256u
-                };
-
                 // The maximum length of a string in the table including
                 // two \0 bytes.
                 enum {
                     max_length = 250u + 2u
                 };
 
-                // The data is stored in this string. It is default constructed
-                // and then resized on demand the first time something is added.
+                // Compact the arena when it has grown beyond this size.
+                // Must be larger than the maximum live size
+                // (number_of_entries * max_length).
+                enum : std::size_t {
+                    max_arena_size = 8ul * 1024ul * 1024ul
+                };
+
+                struct entry {
+                    uint32_t offset;
+                    uint32_t size;
+                };
+
+                // Strings are appended back-to-back to this arena, the ring
+                // buffer of entries only stores offsets into it. Compared
+                // to fixed-size slots this keeps the live strings packed
+                // tightly together in cache and copies only the actual
+                // string bytes. Both containers are default constructed and
+                // only sized on demand the first time something is added.
                 // This is done because the ReferenceTable is in a O5mParser
-                // object which will be copied from one thread to another. This
-                // way the string is still small when it is copied.
-                std::string m_table;
+                // object which will be copied from one thread to another.
+                // This way the table is still small when it is copied.
+                std::string m_arena;
+
+                std::vector<entry> m_entries;
 
                 unsigned int current_entry = 0;
 
+                // Copy the live strings into a fresh arena so it does not
+                // grow without bound. All entry offsets stay valid because
+                // they are rewritten along the way.
+                void compact() {
+                    std::string new_arena;
+                    new_arena.reserve(number_of_entries * max_length);
+                    new_arena.append(2, '\0'); // for unset entries
+                    for (auto& e : m_entries) {
+                        if (e.size > 0) {
+                            const auto offset = static_cast<uint32_t>(new_arena.size());
+                            new_arena.append(m_arena, e.offset, e.size);
+                            e.offset = offset;
+                        }
+                    }
+                    using std::swap;
+                    swap(m_arena, new_arena);
+                }
+
             public:
 
                 void clear() {
@@ -128,23 +161,34 @@ namespace osmium {
                 }
 
                 void add(const char* string, std::size_t size) {
-                    if (m_table.empty()) {
-                        m_table.resize(entry_size * number_of_entries);
+                    if (m_entries.empty()) {
+                        m_entries.resize(number_of_entries);
+                        m_arena.reserve(number_of_entries * max_length);
+                        m_arena.append(2, '\0'); // for unset entries
                     }
                     if (size <= max_length) {
-                        std::copy_n(string, size, &m_table[current_entry * entry_size]);
+                        if (m_arena.size() + size > max_arena_size) {
+                            compact();
+                        }
+                        m_entries[current_entry].offset = static_cast<uint32_t>(m_arena.size());
+                        m_entries[current_entry].size = static_cast<uint32_t>(size);
+                        m_arena.append(string, size);
                         if (++current_entry == number_of_entries) {
                             current_entry = 0;
                         }
                     }
                 }
 
+                /**
+                 * Get the string with the given reference. The returned
+                 * pointer is only valid until the next call to add().
+                 */
                 const char* get(uint64_t index) const {
-                    if (m_table.empty() || index == 0 || index > number_of_entries) {
+                    if (m_entries.empty() || index == 0 || index > number_of_entries) {
                         throw o5m_error{"reference to non-existing string in table"};
                     }
-                    const auto entry = (current_entry + number_of_entries - index) % number_of_entries;
-                    return &m_table[entry * entry_size];
+                    const auto e = (current_entry + number_of_entries - index) % number_of_entries;
+                    return &m_arena[m_entries[e].offset];
                 }
 
             }; // class ReferenceTable
@@ -250,6 +294,10 @@ namespace osmium {
                 osmium::DeltaDecode<osmium::object_id_type> m_delta_way_node_id;
                 osmium::DeltaDecode<osmium::object_id_type> m_delta_member_ids[3];
 
+                // Scratch space for the bulk-decoded way node references,
+                // reused from one way to the next.
+                std::vector<int64_t> m_ref_deltas;
+
                 void reset() {
                     m_reference_table.clear();
 
@@ -417,10 +465,21 @@ namespace osmium {
                                 throw o5m_error{"way nodes ref section too long"};
                             }
 
+                            // The reference section is a packed array of
+                            // zigzag-encoded varint deltas, decode it in
+                            // bulk like the packed fields in PBF.
+                            try {
+                                decode_packed_zigzag(data, end_refs, m_ref_deltas);
+                            } catch (const osmium::pbf_error&) {
+                                throw o5m_error{"way nodes ref section too long"};
+                            }
+                            m_delta_way_node_id.update(m_ref_deltas.data(), m_ref_deltas.size());
+                            data = end_refs;
+
                             osmium::builder::WayNodeListBuilder wn_builder{builder};
 
-                            while (data < end_refs) {
-                                wn_builder.add_node_ref(m_delta_way_node_id.update(zvarint(&data, end)));
+                            for (const int64_t ref : m_ref_deltas) {
+                                wn_builder.add_node_ref(ref);
                             }
                         }
 
@@ -0,0 +1,401 @@
+#ifndef OSMIUM_IO_DETAIL_O5M_OUTPUT_FORMAT_HPP
+#define OSMIUM_IO_DETAIL_O5M_OUTPUT_FORMAT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/detail/output_format.hpp>
+#include <osmium/io/detail/queue_util.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/file_format.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/metadata_options.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/node_ref.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/tag.hpp>
+#include <osmium/osm/timestamp.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/util/delta.hpp>
+#include <osmium/visitor.hpp>
+
+#include <protozero/varint.hpp>
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            // Implementation of the o5m/o5c output according to the
+            // description at https://wiki.openstreetmap.org/wiki/O5m .
+
+            struct o5m_output_options {
+
+                /// Which metadata of objects should be added?
+                osmium::metadata_options add_metadata;
+
+                /// Write o5c change file format instead of o5m?
+                bool write_change_format = false;
+
+            }; // struct o5m_output_options
+
+            /**
+             * The writer side of the o5m string reference table: it
+             * remembers the last 15000 string pairs (up to 250 characters)
+             * written inline so they can be written as a back-reference
+             * the next time. This mirrors the ReferenceTable used by the
+             * o5m parser, so reader and writer always agree about which
+             * strings are in the table.
+             */
+            class StringReferenceTable {
+
+                // The following settings are from the o5m description:
+
+                // The maximum number of entries in this table.
+                enum {
+                    number_of_entries = 15000u
+                };
+
+                // The maximum length of a string in the table including
+                // two \0 bytes.
+                enum {
+                    max_length = 250u + 2u
+                };
+
+                std::unordered_map<std::string, uint64_t> m_index;
+
+                uint64_t m_counter = 0;
+
+            public:
+
+                /**
+                 * Get the back-reference for this string pair, 0 if there
+                 * is none. A reference of n means "the nth-to-last string
+                 * pair written inline".
+                 */
+                uint64_t get(const std::string& pair) const {
+                    if (pair.size() > max_length) {
+                        return 0;
+                    }
+                    const auto it = m_index.find(pair);
+                    if (it == m_index.end()) {
+                        return 0;
+                    }
+                    const uint64_t reference = m_counter - it->second + 1;
+                    return reference <= number_of_entries ? reference : 0;
+                }
+
+                /// Call this for every string pair written inline.
+                void add(const std::string& pair) {
+                    if (pair.size() <= max_length) {
+                        m_index[pair] = ++m_counter;
+                    }
+                }
+
+            }; // class StringReferenceTable
+
+            /**
+             * Writes out one buffer with OSM data in o5m format.
+             *
+             * Every block starts with an o5m reset so the delta encoders
+             * and the string reference table start fresh. This makes the
+             * blocks independent of each other and any number of them can
+             * be encoded concurrently on the thread pool.
+             */
+            class O5mOutputBlock : public OutputBlock {
+
+                enum class dataset_type : unsigned char {
+                    node     = 0x10,
+                    way      = 0x11,
+                    relation = 0x12,
+                    reset    = 0xff
+                };
+
+                o5m_output_options m_options;
+
+                StringReferenceTable m_reference_table;
+
+                std::string m_record{};
+                std::string m_section{};
+                std::string m_pair{};
+
+                osmium::DeltaEncode<osmium::object_id_type> m_delta_id;
+
+                osmium::DeltaEncode<int64_t> m_delta_timestamp;
+                osmium::DeltaEncode<int64_t> m_delta_changeset;
+                osmium::DeltaEncode<int64_t> m_delta_lon;
+                osmium::DeltaEncode<int64_t> m_delta_lat;
+
+                osmium::DeltaEncode<osmium::object_id_type> m_delta_way_node_id;
+                osmium::DeltaEncode<osmium::object_id_type> m_delta_member_ids[3];
+
+                static void append_varint(std::string& out, const uint64_t value) {
+                    protozero::write_varint(std::back_inserter(out), value);
+                }
+
+                static void append_zvarint(std::string& out, const int64_t value) {
+                    append_varint(out, protozero::encode_zigzag64(value));
+                }
+
+                /**
+                 * Append a string pair, either as a back-reference into
+                 * the string reference table or inline (marked with a
+                 * \0 byte).
+                 */
+                void append_string_pair(std::string& out, const std::string& pair) {
+                    const auto reference = m_reference_table.get(pair);
+                    if (reference != 0) {
+                        append_varint(out, reference);
+                        return;
+                    }
+                    out += '\0';
+                    out += pair;
+                    m_reference_table.add(pair);
+                }
+
+                void append_tags(const osmium::TagList& tags) {
+                    for (const auto& tag : tags) {
+                        m_pair.clear();
+                        m_pair.append(tag.key());
+                        m_pair += '\0';
+                        m_pair.append(tag.value());
+                        m_pair += '\0';
+                        append_string_pair(m_record, m_pair);
+                    }
+                }
+
+                void append_user(const osmium::OSMObject& object) {
+                    const osmium::user_id_type uid = m_options.add_metadata.uid() ? object.uid() : 0;
+
+                    m_pair.clear();
+                    append_varint(m_pair, uid);
+                    m_pair += '\0';
+                    if (uid != 0) {
+                        m_pair.append(m_options.add_metadata.user() ? object.user() : "");
+                        m_pair += '\0';
+                    }
+                    append_string_pair(m_record, m_pair);
+                }
+
+                void append_info(const osmium::OSMObject& object) {
+                    const osmium::object_version_type version = m_options.add_metadata.version() ? object.version() : 0;
+
+                    // A version of 0 means "no info section". The reader
+                    // will not look at anything after that byte, so no
+                    // other metadata can be written and the timestamp
+                    // delta state must stay untouched.
+                    if (version == 0) {
+                        m_record += '\0'; // no info section
+                        return;
+                    }
+
+                    append_varint(m_record, version);
+
+                    const int64_t timestamp = m_options.add_metadata.timestamp() ? int64_t(uint32_t(object.timestamp())) : 0;
+                    append_zvarint(m_record, m_delta_timestamp.update(timestamp));
+
+                    if (timestamp != 0) {
+                        append_zvarint(m_record, m_delta_changeset.update(m_options.add_metadata.changeset() ? object.changeset() : 0));
+                        append_user(object);
+                    }
+                }
+
+                void write_record(const dataset_type type) {
+                    *m_out += static_cast<char>(type);
+                    append_varint(*m_out, m_record.size());
+                    m_out->append(m_record);
+                    m_record.clear();
+                }
+
+            public:
+
+                O5mOutputBlock(osmium::memory::Buffer&& buffer, const o5m_output_options& options) :
+                    OutputBlock(std::move(buffer)),
+                    m_options(options) {
+                }
+
+                std::string operator()() {
+                    *m_out += static_cast<char>(dataset_type::reset);
+
+                    osmium::apply(m_input_buffer->cbegin(), m_input_buffer->cend(), *this);
+
+                    std::string out;
+                    using std::swap;
+                    swap(out, *m_out);
+
+                    return out;
+                }
+
+                void node(const osmium::Node& node) {
+                    append_zvarint(m_record, m_delta_id.update(node.id()));
+                    append_info(node);
+
+                    // A node without a location is written as deleted,
+                    // the o5m format can not express anything else.
+                    if (node.visible() && node.location()) {
+                        append_zvarint(m_record, m_delta_lon.update(node.location().x()));
+                        append_zvarint(m_record, m_delta_lat.update(node.location().y()));
+                        append_tags(node.tags());
+                    }
+
+                    write_record(dataset_type::node);
+                }
+
+                void way(const osmium::Way& way) {
+                    append_zvarint(m_record, m_delta_id.update(way.id()));
+                    append_info(way);
+
+                    if (way.visible()) {
+                        m_section.clear();
+                        for (const auto& node_ref : way.nodes()) {
+                            append_zvarint(m_section, m_delta_way_node_id.update(node_ref.ref()));
+                        }
+                        append_varint(m_record, m_section.size());
+                        m_record.append(m_section);
+
+                        append_tags(way.tags());
+                    }
+
+                    write_record(dataset_type::way);
+                }
+
+                void relation(const osmium::Relation& relation) {
+                    append_zvarint(m_record, m_delta_id.update(relation.id()));
+                    append_info(relation);
+
+                    if (relation.visible()) {
+                        m_section.clear();
+                        for (const auto& member : relation.members()) {
+                            const auto i = osmium::item_type_to_nwr_index(member.type());
+                            append_zvarint(m_section, m_delta_member_ids[i].update(member.ref()));
+
+                            m_pair.clear();
+                            m_pair += static_cast<char>('0' + i);
+                            m_pair.append(member.role());
+                            m_pair += '\0';
+                            append_string_pair(m_section, m_pair);
+                        }
+                        append_varint(m_record, m_section.size());
+                        m_record.append(m_section);
+
+                        append_tags(relation.tags());
+                    }
+
+                    write_record(dataset_type::relation);
+                }
+
+            }; // class O5mOutputBlock
+
+            class O5mOutputFormat : public osmium::io::detail::OutputFormat {
+
+                o5m_output_options m_options;
+
+            public:
+
+                O5mOutputFormat(osmium::thread::Pool& pool, const osmium::io::File& file, future_string_queue_type& output_queue) :
+                    OutputFormat(pool, output_queue) {
+                    m_options.add_metadata        = osmium::metadata_options{file.get("add_metadata")};
+                    m_options.write_change_format = file.has_multiple_object_versions();
+                }
+
+                void write_header(const osmium::io::Header& header) final {
+                    std::string data;
+
+                    // file magic and version
+                    data.append("\xff\xe0\x04o5", 5);
+                    data += m_options.write_change_format ? 'c' : 'm';
+                    data += '2';
+
+                    const std::string timestamp{header.get("o5m_timestamp").empty() ? header.get("timestamp") : header.get("o5m_timestamp")};
+                    if (!timestamp.empty()) {
+                        std::string record;
+                        protozero::write_varint(std::back_inserter(record), protozero::encode_zigzag64(uint32_t(osmium::Timestamp{timestamp.c_str()})));
+                        data += '\xdc'; // timestamp dataset
+                        protozero::write_varint(std::back_inserter(data), record.size());
+                        data.append(record);
+                    }
+
+                    if (!header.boxes().empty()) {
+                        const osmium::Box box = header.joined_boxes();
+                        std::string record;
+                        protozero::write_varint(std::back_inserter(record), protozero::encode_zigzag64(box.bottom_left().x()));
+                        protozero::write_varint(std::back_inserter(record), protozero::encode_zigzag64(box.bottom_left().y()));
+                        protozero::write_varint(std::back_inserter(record), protozero::encode_zigzag64(box.top_right().x()));
+                        protozero::write_varint(std::back_inserter(record), protozero::encode_zigzag64(box.top_right().y()));
+                        data += '\xdb'; // bounding box dataset
+                        protozero::write_varint(std::back_inserter(data), record.size());
+                        data.append(record);
+                    }
+
+                    send_to_output_queue(std::move(data));
+                }
+
+                void write_buffer(osmium::memory::Buffer&& buffer) final {
+                    m_output_queue.push(m_pool.submit(osmium::thread::Pool::priority::high, O5mOutputBlock{std::move(buffer), m_options}));
+                }
+
+            }; // class O5mOutputFormat
+
+            // we want the register_output_format() function to run, setting
+            // the variable is only a side-effect, it will never be used
+            const bool registered_o5m_output = osmium::io::detail::OutputFormatFactory::instance().register_output_format(osmium::io::file_format::o5m,
+                [](osmium::thread::Pool& pool, const osmium::io::File& file, future_string_queue_type& output_queue) {
+                    return new osmium::io::detail::O5mOutputFormat(pool, file, output_queue);
+            });
+
+            // dummy function to silence the unused variable warning from above
+            inline bool get_registered_o5m_output() noexcept {
+                return registered_o5m_output;
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_O5M_OUTPUT_FORMAT_HPP
@@ -38,9 +38,12 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
 #include <osmium/thread/util.hpp>
 
+#include <cstddef>
 #include <cstdint>
+#include <future>
 #include <memory>
 #include <string>
 #include <utility>
@@ -98,17 +101,74 @@ namespace osmium {
                 }
             }
 
+            /**
+             * Parser for OPL files. OPL lines are completely independent
+             * of each other, so the input is cut into batches of whole
+             * lines which are parsed concurrently on the thread pool. The
+             * resulting buffers are put into the output queue in input
+             * order like on the PBF path.
+             */
             class OPLParser : public Parser {
 
-                enum {
-                    initial_buffer_size = 1024ul * 1024ul
+                enum : std::size_t {
+                    min_batch_size = 1024ul * 1024ul
                 };
 
-                osmium::memory::Buffer m_buffer{initial_buffer_size,
-                                                osmium::memory::Buffer::auto_grow::internal};
-
                 uint64_t m_line_count = 0;
 
+                struct parse_batch_task {
+
+                    std::string batch; // lines are NUL-terminated in place
+                    uint64_t line_count;
+                    osmium::osm_entity_bits::type read_types;
+
+                    osmium::memory::Buffer operator()() {
+                        osmium::memory::Buffer buffer{batch.size() + 1024,
+                                                      osmium::memory::Buffer::auto_grow::yes};
+
+                        std::string::size_type ppos = 0;
+                        while (ppos < batch.size()) {
+                            auto pos = batch.find_first_of("\n\r", ppos);
+                            if (pos == std::string::npos) {
+                                pos = batch.size();
+                            } else {
+                                batch[pos] = '\0';
+                            }
+                            if (pos > ppos) {
+                                opl_parse_line(line_count, &batch[ppos], buffer, read_types);
+                                ++line_count;
+                            }
+                            ppos = pos + 1;
+                        }
+
+                        return buffer;
+                    }
+
+                }; // struct parse_batch_task
+
+                /// Count the lines of a batch the way parse_batch_task does.
+                static uint64_t count_non_empty_lines(const std::string& batch) {
+                    uint64_t lines = 0;
+                    std::string::size_type ppos = 0;
+                    while (ppos < batch.size()) {
+                        auto pos = batch.find_first_of("\n\r", ppos);
+                        if (pos == std::string::npos) {
+                            pos = batch.size();
+                        }
+                        if (pos > ppos) {
+                            ++lines;
+                        }
+                        ppos = pos + 1;
+                    }
+                    return lines;
+                }
+
+                void submit_batch(std::string&& batch) {
+                    const uint64_t lines = count_non_empty_lines(batch);
+                    send_to_output_queue(get_quota().submit(parse_batch_task{std::move(batch), m_line_count, read_types()}));
+                    m_line_count += lines;
+                }
+
             public:
 
                 explicit OPLParser(parser_arguments& args) :
@@ -124,23 +184,28 @@ namespace osmium {
 
                 ~OPLParser() noexcept final = default;
 
-                void parse_line(const char* data) {
-                    if (opl_parse_line(m_line_count, data, m_buffer, read_types())) {
-                        if (m_buffer.has_nested_buffers()) {
-                            std::unique_ptr<osmium::memory::Buffer> buffer_ptr{m_buffer.get_last_nested()};
-                            send_to_output_queue(std::move(*buffer_ptr));
-                        }
-                    }
-                    ++m_line_count;
-                }
-
                 void run() final {
                     osmium::thread::set_thread_name("_osmium_opl_in");
 
-                    line_by_line(*this);
+                    // Cut the input into batches of whole lines and let the
+                    // thread pool parse them. The bounded output queue
+                    // provides the backpressure.
+                    std::string text;
+                    while (!input_done()) {
+                        text.append(get_input());
+
+                        if (text.size() >= min_batch_size) {
+                            const auto pos = text.find_last_of("\n\r");
+                            if (pos != std::string::npos) {
+                                std::string batch{text.substr(0, pos + 1)};
+                                text.erase(0, pos + 1);
+                                submit_batch(std::move(batch));
+                            }
+                        }
+                    }
 
-                    if (m_buffer.committed() > 0) {
-                        send_to_output_queue(std::move(m_buffer));
+                    if (!text.empty()) {
+                        submit_batch(std::move(text));
                     }
                 }
 
@@ -295,7 +295,7 @@ namespace osmium {
                 }
 
                 void write_buffer(osmium::memory::Buffer&& buffer) final {
-                    m_output_queue.push(m_pool.submit(OPLOutputBlock{std::move(buffer), m_options}));
+                    m_output_queue.push(m_pool.submit(osmium::thread::Pool::priority::high, OPLOutputBlock{std::move(buffer), m_options}));
                 }
 
             }; // class OPLOutputFormat
@@ -48,6 +48,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/way.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <iterator>
@@ -55,6 +56,28 @@ DEALINGS IN THE SOFTWARE.
 #include <stdexcept>
 #include <string>
 
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+# define OSMIUM_USE_SSE2_OPL_SCAN
+#endif
+
+// The SSE2 scan reads (but never uses) a few bytes beyond the
+// terminating NUL character, which the address sanitizer would
+// (correctly) complain about.
+#if defined(__SANITIZE_ADDRESS__)
+# undef OSMIUM_USE_SSE2_OPL_SCAN
+#elif defined(__has_feature)
+# if __has_feature(address_sanitizer)
+#  undef OSMIUM_USE_SSE2_OPL_SCAN
+# endif
+#endif
+
+#ifdef OSMIUM_USE_SSE2_OPL_SCAN
+# include <emmintrin.h>
+# ifdef _MSC_VER
+#  include <intrin.h>
+# endif
+#endif
+
 namespace osmium {
 
     namespace builder {
@@ -126,14 +149,63 @@ namespace osmium {
                 return *s != '\0' && *s != ' ' && *s != '\t';
             }
 
+#ifdef OSMIUM_USE_SSE2_OPL_SCAN
+
+            /**
+             * Scan for the next of up to five delimiter characters (or the
+             * end of the string) 16 bytes at a time. The string end is not
+             * known beforehand, so the data is read with aligned loads
+             * after a short scalar prologue: an aligned 16 byte load can
+             * never cross a page boundary, so reading a few bytes beyond
+             * the terminating NUL character is safe.
+             */
+            template <char TD1, char TD2, char TD3, char TD4, char TD5>
+            inline const char* opl_scan_for_delimiter(const char* s) noexcept {
+                while (reinterpret_cast<uintptr_t>(s) % 16 != 0) {
+                    if (*s == '\0' || *s == TD1 || *s == TD2 || *s == TD3 || *s == TD4 || *s == TD5) {
+                        return s;
+                    }
+                    ++s;
+                }
+
+                while (true) {
+                    const __m128i chunk = _mm_load_si128(reinterpret_cast<const __m128i*>(s));
+
+                    __m128i hits = _mm_cmpeq_epi8(chunk, _mm_setzero_si128());
+                    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(TD1)));
+                    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(TD2)));
+                    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(TD3)));
+                    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(TD4)));
+                    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(TD5)));
+
+                    const int mask = _mm_movemask_epi8(hits);
+                    if (mask != 0) {
+#ifdef _MSC_VER
+                        unsigned long index = 0;
+                        _BitScanForward(&index, static_cast<unsigned long>(mask));
+                        return s + index;
+#else
+                        return s + __builtin_ctz(static_cast<unsigned int>(mask));
+#endif
+                    }
+                    s += 16;
+                }
+            }
+
+#endif
+
             /**
              * Skip to the next space or tab character or the end of the
              * string.
              */
             inline const char* opl_skip_section(const char** s) noexcept {
+#ifdef OSMIUM_USE_SSE2_OPL_SCAN
+                *s = opl_scan_for_delimiter<' ', '\t', '\t', '\t', '\t'>(*s);
+#else
                 while (opl_non_empty(*s)) {
                     ++*s;
                 }
+#endif
                 return *s;
             }
 
@@ -184,6 +256,18 @@ namespace osmium {
             inline void opl_parse_string(const char** data, std::string& result) {
                 const char* s = *data;
                 while (true) {
+#ifdef OSMIUM_USE_SSE2_OPL_SCAN
+                    // Find the run of characters up to the next delimiter
+                    // or escape and append it to the result in one go.
+                    const char* const run_end = opl_scan_for_delimiter<' ', '\t', ',', '=', '%'>(s);
+                    result.append(s, static_cast<std::size_t>(run_end - s));
+                    s = run_end;
+                    if (*s == '\0' || *s == ' ' || *s == '\t' || *s == ',' || *s == '=') {
+                        break;
+                    }
+                    ++s; // the '%' starting an escape sequence
+                    opl_parse_escaped(&s, result);
+#else
                     if (*s == '\0' || *s == ' ' || *s == '\t' || *s == ',' || *s == '=') {
                         break;
                     }
@@ -194,6 +278,7 @@ namespace osmium {
                         result += *s;
                         ++s;
                     }
+#endif
                 }
                 *data = s;
             }
@@ -40,8 +40,10 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/file_format.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/thread/pool.hpp>
+#include <osmium/util/itoa.hpp>
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -71,28 +73,10 @@ namespace osmium {
                     m_out(std::make_shared<std::string>()) {
                 }
 
-                // Simple function to convert integer to string. This is much
-                // faster than using sprintf, but could be further optimized.
-                // See https://github.com/miloyip/itoa-benchmark .
-                void output_int(int64_t value) {
-                    if (value < 0) {
-                        *m_out += '-';
-                        value = -value;
-                    }
-
-                    char temp[20];
-                    char *t = temp;
-                    do {
-                        *t++ = char(value % 10) + '0';
-                        value /= 10;
-                    } while (value > 0);
-
-                    const auto old_size = m_out->size();
-                    m_out->resize(old_size + (t - temp));
-                    char* data = &(*m_out)[old_size];
-                    do {
-                        *data++ += *--t;
-                    } while (t != temp);
+                void output_int(const int64_t value) {
+                    char buffer[21];
+                    const char* const end = osmium::util::int64_to_string(value, buffer);
+                    m_out->append(buffer, static_cast<std::size_t>(end - buffer));
                 }
 
             }; // class OutputBlock;
@@ -139,6 +123,15 @@ namespace osmium {
 
                 virtual void write_buffer(osmium::memory::Buffer&& /*buffer*/) = 0;
 
+                /**
+                 * Write a pre-serialized blob record verbatim. Only
+                 * formats whose files are a sequence of self-contained
+                 * records can support this, all others throw.
+                 */
+                virtual void write_raw_blob(std::string&& /*data*/) {
+                    throw io_error{"Raw blob pass-through is only supported for the PBF format"};
+                }
+
                 virtual void write_end() {
                 }
 
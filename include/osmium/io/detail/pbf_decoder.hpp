@@ -34,16 +34,25 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/index/id_set.hpp>
+#include <osmium/io/detail/ids_filter.hpp>
 #include <osmium/io/detail/pbf.hpp> // IWYU pragma: export
 #include <osmium/io/detail/protobuf_tags.hpp>
+#include <osmium/io/detail/tags_filter.hpp>
+#include <osmium/io/detail/varint_decode.hpp>
 #include <osmium/io/detail/zlib.hpp>
+#ifdef OSMIUM_WITH_ZSTD
+# include <osmium/io/detail/zstd.hpp>
+#endif
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/memory/buffer_pool.hpp>
 #include <osmium/osm/box.hpp>
 #include <osmium/osm/entity_bits.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/location.hpp>
+#include <osmium/osm/metadata_options.hpp>
 #include <osmium/osm/node.hpp>
 #include <osmium/osm/object.hpp>
 #include <osmium/osm/relation.hpp>
@@ -51,13 +60,17 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/way.hpp>
 #include <osmium/util/delta.hpp>
+#include <osmium/util/probes.hpp>
+#include <osmium/util/profiling.hpp>
 
 #include <protozero/iterators.hpp>
 #include <protozero/pbf_message.hpp>
 #include <protozero/types.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <stdexcept>
@@ -80,12 +93,45 @@ namespace osmium {
 
             class PBFPrimitiveBlockDecoder {
 
-                enum {
-                    initial_buffer_size = 64ul * 1024ul
-                };
-
                 data_view m_data;
+
+                // Raw view of the string table of this block. The table is
+                // only decoded into m_stringtable when a string is actually
+                // needed, see string_at(). For passes that only look at ids
+                // and/or locations it is never decoded at all.
+                data_view m_stringtable_view{};
                 std::vector<osm_string_len_type> m_stringtable;
+                bool m_stringtable_decoded = false;
+
+                // Optional filter pushed down from the Reader: if set, only
+                // objects with at least one matching tag are decoded.
+                pbf_tags_filter m_tags_filter;
+
+                // One entry per string table entry, filled when the tags
+                // filter has a key filter: nonzero if the string could be
+                // the key of a matching tag. Computed once per block, it
+                // turns the key check for each tag into an indexed load
+                // with the string-table id instead of a string match.
+                std::vector<uint8_t> m_wanted_keys;
+
+                // Optional id filter pushed down from the Reader: if a set
+                // is given for an object type, only objects of that type
+                // whose id is in the set are decoded.
+                pbf_ids_filter m_ids_filter;
+
+                // NUL-terminated copies of the string table entries. Only
+                // filled when a tag filter is set, because the filter needs
+                // C strings while the entries in the raw blob data are only
+                // length-delimited.
+                std::string m_stringtable_data{};
+
+                // Scratch arrays for bulk-decoded packed sint64 fields of
+                // DenseNodes. Members so their allocations are re-used
+                // between primitive groups.
+                std::vector<int64_t> m_ids;
+                std::vector<int64_t> m_lats;
+                std::vector<int64_t> m_lons;
+                std::vector<int64_t> m_timestamps;
 
                 int64_t m_lon_offset = 0;
                 int64_t m_lat_offset = 0;
@@ -94,16 +140,34 @@ namespace osmium {
 
                 osmium::osm_entity_bits::type m_read_types;
 
-                osmium::memory::Buffer m_buffer{initial_buffer_size, osmium::memory::Buffer::auto_grow::internal};
+                // Drawn from the shared pool so blob decodes can reuse the
+                // memory of buffers the application has given back.
+                osmium::memory::Buffer m_buffer = osmium::memory::BufferPool::default_instance().get_buffer();
 
                 osmium::io::read_meta m_read_metadata;
 
-                void decode_stringtable(const data_view& data) {
-                    if (!m_stringtable.empty()) {
-                        throw osmium::pbf_error{"more than one stringtable in pbf file"};
-                    }
+                // Which metadata fields to decode, only consulted when
+                // m_read_metadata is read_meta::yes.
+                osmium::metadata_options m_metadata_opts{};
+
+                // If set to read_visible::only, deleted object versions
+                // and versions directly superseded within this block are
+                // skipped before anything is built in the buffer.
+                osmium::io::read_visible m_read_visible = osmium::io::read_visible::all;
 
-                    protozero::pbf_message<OSMFormat::StringTable> pbf_string_table{data};
+                bool only_visible() const noexcept {
+                    return m_read_visible == osmium::io::read_visible::only;
+                }
+
+                bool decode_metadata() const noexcept {
+                    return m_read_metadata == osmium::io::read_meta::yes &&
+                           m_metadata_opts.any();
+                }
+
+                void decode_stringtable() {
+                    m_stringtable_decoded = true;
+
+                    protozero::pbf_message<OSMFormat::StringTable> pbf_string_table{m_stringtable_view};
                     while (pbf_string_table.next(OSMFormat::StringTable::repeated_bytes_s, protozero::pbf_wire_type::length_delimited)) {
                         const auto str_view = pbf_string_table.get_view();
                         if (str_view.size() > osmium::max_osm_string_length) {
@@ -111,6 +175,41 @@ namespace osmium {
                         }
                         m_stringtable.emplace_back(str_view.data(), osmium::string_size_type(str_view.size()));
                     }
+
+                    if (m_tags_filter.filter) {
+                        std::size_t needed_size = 0;
+                        for (const auto& entry : m_stringtable) {
+                            needed_size += entry.second + 1u;
+                        }
+                        m_stringtable_data.clear();
+                        m_stringtable_data.reserve(needed_size);
+                        for (auto& entry : m_stringtable) {
+                            const std::size_t offset = m_stringtable_data.size();
+                            m_stringtable_data.append(entry.first, entry.second);
+                            m_stringtable_data.append(1, '\0');
+                            entry.first = m_stringtable_data.data() + offset;
+                        }
+
+                        if (m_tags_filter.key_filter) {
+                            m_wanted_keys.reserve(m_stringtable.size());
+                            for (const auto& entry : m_stringtable) {
+                                m_wanted_keys.push_back(m_tags_filter.key_filter(entry.first) ? 1 : 0);
+                            }
+                        }
+                    }
+                }
+
+                /**
+                 * Get the string with the given index from the string
+                 * table, decoding the table on first use.
+                 *
+                 * @throws std::out_of_range If the index is not valid
+                 */
+                const osm_string_len_type& string_at(const std::size_t index) {
+                    if (!m_stringtable_decoded) {
+                        decode_stringtable();
+                    }
+                    return m_stringtable.at(index);
                 }
 
                 void decode_primitive_block_metadata() {
@@ -118,7 +217,10 @@ namespace osmium {
                     while (pbf_primitive_block.next()) {
                         switch (pbf_primitive_block.tag_and_type()) {
                             case protozero::tag_and_type(OSMFormat::PrimitiveBlock::required_StringTable_stringtable, protozero::pbf_wire_type::length_delimited):
-                                decode_stringtable(pbf_primitive_block.get_view());
+                                if (m_stringtable_view.data() != nullptr) {
+                                    throw osmium::pbf_error{"more than one stringtable in pbf file"};
+                                }
+                                m_stringtable_view = pbf_primitive_block.get_view();
                                 break;
                             case protozero::tag_and_type(OSMFormat::PrimitiveBlock::optional_int32_granularity, protozero::pbf_wire_type::varint):
                                 m_granularity = pbf_primitive_block.get_int32();
@@ -138,7 +240,42 @@ namespace osmium {
                     }
                 }
 
+                // An object message held back in read_visible::only
+                // mode: it is only decoded once the following message
+                // of the same type shows that it is not superseded by a
+                // newer version of the same object.
+                struct pending_object {
+                    data_view view{};
+                    int64_t id = 0;
+                    bool set = false;
+                };
+
+                // In read_visible::only mode decide what to do with an
+                // object message that passed the other filters: a pending
+                // older version of the same object is dropped undecoded,
+                // and the message itself becomes pending unless it is a
+                // deleted version.
+                void defer_or_drop(pending_object& pending, const data_view& view, const bool zigzag) {
+                    const int64_t id = object_id(view, zigzag);
+                    if (pending.set && pending.id == id) {
+                        pending.set = false;
+                    }
+                    if (visible_object(view)) {
+                        pending.view = view;
+                        pending.id = id;
+                        pending.set = true;
+                    }
+                }
+
                 void decode_primitive_block_data() {
+                    // Pending objects live until the end of the block:
+                    // versions of one object can span primitive groups,
+                    // but what is superseded by the first version in the
+                    // next block can not be seen from here.
+                    pending_object pending_node;
+                    pending_object pending_way;
+                    pending_object pending_relation;
+
                     protozero::pbf_message<OSMFormat::PrimitiveBlock> pbf_primitive_block{m_data};
                     while (pbf_primitive_block.next(OSMFormat::PrimitiveBlock::repeated_PrimitiveGroup_primitivegroup, protozero::pbf_wire_type::length_delimited)) {
                         protozero::pbf_message<OSMFormat::PrimitiveGroup> pbf_primitive_group = pbf_primitive_block.get_message();
@@ -146,15 +283,23 @@ namespace osmium {
                             switch (pbf_primitive_group.tag_and_type()) {
                                 case protozero::tag_and_type(OSMFormat::PrimitiveGroup::repeated_Node_nodes, protozero::pbf_wire_type::length_delimited):
                                     if (m_read_types & osmium::osm_entity_bits::node) {
-                                        decode_node(pbf_primitive_group.get_view());
-                                        m_buffer.commit();
+                                        const auto view = pbf_primitive_group.get_view();
+                                        if ((!m_ids_filter.node_ids || wanted_object_id(view, *m_ids_filter.node_ids, true)) &&
+                                            (!m_tags_filter.filter || wanted_object(view))) {
+                                            if (only_visible()) {
+                                                defer_or_drop(pending_node, view, true);
+                                            } else {
+                                                decode_node(view);
+                                                m_buffer.commit();
+                                            }
+                                        }
                                     } else {
                                         pbf_primitive_group.skip();
                                     }
                                     break;
                                 case protozero::tag_and_type(OSMFormat::PrimitiveGroup::optional_DenseNodes_dense, protozero::pbf_wire_type::length_delimited):
                                     if (m_read_types & osmium::osm_entity_bits::node) {
-                                        if (m_read_metadata == osmium::io::read_meta::yes) {
+                                        if (decode_metadata()) {
                                             decode_dense_nodes(pbf_primitive_group.get_view());
                                         } else {
                                             decode_dense_nodes_without_metadata(pbf_primitive_group.get_view());
@@ -166,16 +311,32 @@ namespace osmium {
                                     break;
                                 case protozero::tag_and_type(OSMFormat::PrimitiveGroup::repeated_Way_ways, protozero::pbf_wire_type::length_delimited):
                                     if (m_read_types & osmium::osm_entity_bits::way) {
-                                        decode_way(pbf_primitive_group.get_view());
-                                        m_buffer.commit();
+                                        const auto view = pbf_primitive_group.get_view();
+                                        if ((!m_ids_filter.way_ids || wanted_object_id(view, *m_ids_filter.way_ids, false)) &&
+                                            (!m_tags_filter.filter || wanted_object(view))) {
+                                            if (only_visible()) {
+                                                defer_or_drop(pending_way, view, false);
+                                            } else {
+                                                decode_way(view);
+                                                m_buffer.commit();
+                                            }
+                                        }
                                     } else {
                                         pbf_primitive_group.skip();
                                     }
                                     break;
                                 case protozero::tag_and_type(OSMFormat::PrimitiveGroup::repeated_Relation_relations, protozero::pbf_wire_type::length_delimited):
                                     if (m_read_types & osmium::osm_entity_bits::relation) {
-                                        decode_relation(pbf_primitive_group.get_view());
-                                        m_buffer.commit();
+                                        const auto view = pbf_primitive_group.get_view();
+                                        if ((!m_ids_filter.relation_ids || wanted_object_id(view, *m_ids_filter.relation_ids, false)) &&
+                                            (!m_tags_filter.filter || wanted_object(view))) {
+                                            if (only_visible()) {
+                                                defer_or_drop(pending_relation, view, false);
+                                            } else {
+                                                decode_relation(view);
+                                                m_buffer.commit();
+                                            }
+                                        }
                                     } else {
                                         pbf_primitive_group.skip();
                                     }
@@ -185,6 +346,19 @@ namespace osmium {
                             }
                         }
                     }
+
+                    if (pending_node.set) {
+                        decode_node(pending_node.view);
+                        m_buffer.commit();
+                    }
+                    if (pending_way.set) {
+                        decode_way(pending_way.view);
+                        m_buffer.commit();
+                    }
+                    if (pending_relation.set) {
+                        decode_relation(pending_relation.view);
+                        m_buffer.commit();
+                    }
                 }
 
                 osm_string_len_type decode_info(const data_view& data, osmium::OSMObject& object) {
@@ -195,6 +369,11 @@ namespace osmium {
                         switch (pbf_info.tag_and_type()) {
                             case protozero::tag_and_type(OSMFormat::Info::optional_int32_version, protozero::pbf_wire_type::varint):
                                 {
+                                    if (!m_metadata_opts.version()) {
+                                        pbf_info.skip();
+                                        break;
+                                    }
+
                                     const auto version = pbf_info.get_int32();
                                     if (version < -1) {
                                         throw osmium::pbf_error{"object version must not be negative"};
@@ -208,10 +387,19 @@ namespace osmium {
                                 }
                                 break;
                             case protozero::tag_and_type(OSMFormat::Info::optional_int64_timestamp, protozero::pbf_wire_type::varint):
-                                object.set_timestamp(pbf_info.get_int64() * m_date_factor / 1000);
+                                if (m_metadata_opts.timestamp()) {
+                                    object.set_timestamp(pbf_info.get_int64() * m_date_factor / 1000);
+                                } else {
+                                    pbf_info.skip();
+                                }
                                 break;
                             case protozero::tag_and_type(OSMFormat::Info::optional_int64_changeset, protozero::pbf_wire_type::varint):
                                 {
+                                    if (!m_metadata_opts.changeset()) {
+                                        pbf_info.skip();
+                                        break;
+                                    }
+
                                     const auto changeset_id = pbf_info.get_int64();
                                     if (changeset_id < -1 || changeset_id >= std::numeric_limits<changeset_id_type>::max()) {
                                         throw osmium::pbf_error{"object changeset_id must be between 0 and 2^32-1"};
@@ -225,10 +413,18 @@ namespace osmium {
                                 }
                                 break;
                             case protozero::tag_and_type(OSMFormat::Info::optional_int32_uid, protozero::pbf_wire_type::varint):
-                                object.set_uid_from_signed(pbf_info.get_int32());
+                                if (m_metadata_opts.uid()) {
+                                    object.set_uid_from_signed(pbf_info.get_int32());
+                                } else {
+                                    pbf_info.skip();
+                                }
                                 break;
                             case protozero::tag_and_type(OSMFormat::Info::optional_uint32_user_sid, protozero::pbf_wire_type::varint):
-                                user = m_stringtable.at(pbf_info.get_uint32());
+                                if (m_metadata_opts.user()) {
+                                    user = string_at(pbf_info.get_uint32());
+                                } else {
+                                    pbf_info.skip();
+                                }
                                 break;
                             case protozero::tag_and_type(OSMFormat::Info::optional_bool_visible, protozero::pbf_wire_type::varint):
                                 object.set_visible(pbf_info.get_bool());
@@ -253,8 +449,8 @@ namespace osmium {
                                 // this is against the spec, must have same number of elements
                                 throw osmium::pbf_error{"PBF format error"};
                             }
-                            const auto& k = m_stringtable.at(*kit++);
-                            const auto& v = m_stringtable.at(*vit++);
+                            const auto& k = string_at(*kit++);
+                            const auto& v = string_at(*vit++);
                             builder.add_tag(k.first, k.second, v.first, v.second);
                         }
                     }
@@ -264,7 +460,148 @@ namespace osmium {
                     return int32_t((c * m_granularity + m_lon_offset) / resolution_convert);
                 }
 
+                // Check a key by its string-table id against the
+                // precomputed wanted-keys table. Returns false only if the
+                // table says no tag with this key can match the filter.
+                bool wanted_key(const uint32_t key_id) const noexcept {
+                    return m_wanted_keys.empty() ||
+                           key_id >= m_wanted_keys.size() ||
+                           m_wanted_keys[key_id];
+                }
+
+                bool any_tag_matches(const kv_type& keys, const kv_type& vals) {
+                    if (keys.empty()) {
+                        return false;
+                    }
+                    if (!m_stringtable_decoded) {
+                        decode_stringtable();
+                    }
+                    auto kit = keys.begin();
+                    auto vit = vals.begin();
+                    while (kit != keys.end() && vit != vals.end()) {
+                        const auto key_id = *kit++;
+                        if (!wanted_key(key_id)) {
+                            ++vit;
+                            continue;
+                        }
+                        const auto& k = string_at(key_id);
+                        const auto& v = string_at(*vit++);
+                        if (m_tags_filter.filter(k.first, v.first)) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                // Check whether an object has at least one tag matching the
+                // filter before it is decoded. The keys and vals fields have
+                // the same tags in the Node, Way, and Relation messages, so
+                // this one function can scan all three object types.
+                bool wanted_object(const data_view& data) {
+                    kv_type keys;
+                    kv_type vals;
+
+                    protozero::pbf_message<OSMFormat::Way> pbf_object{data};
+                    while (pbf_object.next()) {
+                        switch (pbf_object.tag_and_type()) {
+                            case protozero::tag_and_type(OSMFormat::Way::packed_uint32_keys, protozero::pbf_wire_type::length_delimited):
+                                keys = pbf_object.get_packed_uint32();
+                                break;
+                            case protozero::tag_and_type(OSMFormat::Way::packed_uint32_vals, protozero::pbf_wire_type::length_delimited):
+                                vals = pbf_object.get_packed_uint32();
+                                break;
+                            default:
+                                pbf_object.skip();
+                        }
+                    }
+
+                    return any_tag_matches(keys, vals);
+                }
+
+                static bool id_in_set(const int64_t id, const osmium::index::IdSetDense<osmium::unsigned_object_id_type>& ids) noexcept {
+                    return id >= 0 && ids.get(static_cast<osmium::unsigned_object_id_type>(id));
+                }
+
+                // Get the id of a not-yet-decoded object. The id is
+                // field 1 in the Node, Way, and Relation messages alike,
+                // but Nodes store it zigzag-encoded (sint64) while Ways
+                // and Relations use plain int64. Returns -1 if there is
+                // no id in the message.
+                static int64_t object_id(const data_view& data, const bool zigzag) {
+                    protozero::pbf_message<OSMFormat::Way> pbf_object{data};
+                    while (pbf_object.next()) {
+                        if (pbf_object.tag_and_type() == protozero::tag_and_type(OSMFormat::Way::required_int64_id, protozero::pbf_wire_type::varint)) {
+                            return zigzag ? pbf_object.get_sint64() : pbf_object.get_int64();
+                        }
+                        pbf_object.skip();
+                    }
+                    return -1;
+                }
+
+                // Check the id of a not-yet-decoded object against an id
+                // set.
+                static bool wanted_object_id(const data_view& data, const osmium::index::IdSetDense<osmium::unsigned_object_id_type>& ids, const bool zigzag) {
+                    return id_in_set(object_id(data, zigzag), ids);
+                }
+
+                // Check the visible flag of a not-yet-decoded object
+                // without building anything in the buffer. The Info
+                // message is field 4 in the Node, Way, and Relation
+                // messages alike. Objects without the flag are visible.
+                static bool visible_object(const data_view& data) {
+                    protozero::pbf_message<OSMFormat::Way> pbf_object{data};
+                    while (pbf_object.next()) {
+                        if (pbf_object.tag_and_type() == protozero::tag_and_type(OSMFormat::Way::optional_Info_info, protozero::pbf_wire_type::length_delimited)) {
+                            protozero::pbf_message<OSMFormat::Info> pbf_info{pbf_object.get_message()};
+                            while (pbf_info.next()) {
+                                if (pbf_info.tag_and_type() == protozero::tag_and_type(OSMFormat::Info::optional_bool_visible, protozero::pbf_wire_type::varint)) {
+                                    return pbf_info.get_bool();
+                                }
+                                pbf_info.skip();
+                            }
+                            return true;
+                        }
+                        pbf_object.skip();
+                    }
+                    return true;
+                }
+
+                bool wanted_dense_node(protozero::pbf_reader::const_int32_iterator it, protozero::pbf_reader::const_int32_iterator last) {
+                    if (it == last || *it == 0) {
+                        return false;
+                    }
+                    if (!m_stringtable_decoded) {
+                        decode_stringtable();
+                    }
+                    while (it != last && *it != 0) {
+                        const auto key_id = static_cast<uint32_t>(*it++);
+                        if (it == last) {
+                            throw osmium::pbf_error{"PBF format error"}; // this is against the spec, keys/vals must come in pairs
+                        }
+                        if (!wanted_key(key_id)) {
+                            ++it;
+                            continue;
+                        }
+                        const auto& k = string_at(key_id);
+                        const auto& v = string_at(*it++);
+                        if (m_tags_filter.filter(k.first, v.first)) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                static void skip_tags_from_dense_nodes(protozero::pbf_reader::const_int32_iterator& it, protozero::pbf_reader::const_int32_iterator last) {
+                    while (it != last && *it != 0) {
+                        ++it;
+                    }
+                    if (it != last) {
+                        ++it;
+                    }
+                }
+
                 void decode_node(const data_view& data) {
+                    OSMIUM_PROFILE_COUNT(objects_decoded);
                     osmium::builder::NodeBuilder builder{m_buffer};
                     osmium::Node& node = builder.object();
 
@@ -288,7 +625,7 @@ namespace osmium {
                                 vals = pbf_node.get_packed_uint32();
                                 break;
                             case protozero::tag_and_type(OSMFormat::Node::optional_Info_info, protozero::pbf_wire_type::length_delimited):
-                                if (m_read_metadata == osmium::io::read_meta::yes) {
+                                if (decode_metadata()) {
                                     user = decode_info(pbf_node.get_view(), builder.object());
                                 } else {
                                     pbf_node.skip();
@@ -322,6 +659,7 @@ namespace osmium {
                 }
 
                 void decode_way(const data_view& data) {
+                    OSMIUM_PROFILE_COUNT(objects_decoded);
                     osmium::builder::WayBuilder builder{m_buffer};
 
                     kv_type keys;
@@ -345,7 +683,7 @@ namespace osmium {
                                 vals = pbf_way.get_packed_uint32();
                                 break;
                             case protozero::tag_and_type(OSMFormat::Way::optional_Info_info, protozero::pbf_wire_type::length_delimited):
-                                if (m_read_metadata == osmium::io::read_meta::yes) {
+                                if (decode_metadata()) {
                                     user = decode_info(pbf_way.get_view(), builder.object());
                                 } else {
                                     pbf_way.skip();
@@ -394,6 +732,7 @@ namespace osmium {
                 }
 
                 void decode_relation(const data_view& data) {
+                    OSMIUM_PROFILE_COUNT(objects_decoded);
                     osmium::builder::RelationBuilder builder{m_buffer};
 
                     kv_type keys;
@@ -417,7 +756,7 @@ namespace osmium {
                                 vals = pbf_relation.get_packed_uint32();
                                 break;
                             case protozero::tag_and_type(OSMFormat::Relation::optional_Info_info, protozero::pbf_wire_type::length_delimited):
-                                if (m_read_metadata == osmium::io::read_meta::yes) {
+                                if (decode_metadata()) {
                                     user = decode_info(pbf_relation.get_view(), builder.object());
                                 } else {
                                     pbf_relation.skip();
@@ -443,7 +782,7 @@ namespace osmium {
                         osmium::builder::RelationMemberListBuilder rml_builder{builder};
                         osmium::DeltaDecode<int64_t> ref;
                         while (!roles.empty() && !refs.empty() && !types.empty()) {
-                            const auto& r = m_stringtable.at(roles.front());
+                            const auto& r = string_at(roles.front());
                             const int type = types.front();
                             if (type < 0 || type > 2) {
                                 throw osmium::pbf_error{"unknown relation member type"};
@@ -466,11 +805,11 @@ namespace osmium {
                 void build_tag_list_from_dense_nodes(osmium::builder::NodeBuilder& builder, protozero::pbf_reader::const_int32_iterator& it, protozero::pbf_reader::const_int32_iterator last) {
                     osmium::builder::TagListBuilder tl_builder{builder};
                     while (it != last && *it != 0) {
-                        const auto& k = m_stringtable.at(*it++);
+                        const auto& k = string_at(*it++);
                         if (it == last) {
                             throw osmium::pbf_error{"PBF format error"}; // this is against the spec, keys/vals must come in pairs
                         }
-                        const auto& v = m_stringtable.at(*it++);
+                        const auto& v = string_at(*it++);
                         tl_builder.add_tag(k.first, k.second, v.first, v.second);
                     }
 
@@ -480,23 +819,47 @@ namespace osmium {
                 }
 
                 void decode_dense_nodes_without_metadata(const data_view& data) {
-                    protozero::iterator_range<protozero::pbf_reader::const_sint64_iterator> ids;
-                    protozero::iterator_range<protozero::pbf_reader::const_sint64_iterator> lats;
-                    protozero::iterator_range<protozero::pbf_reader::const_sint64_iterator> lons;
+                    m_ids.clear();
+                    m_lats.clear();
+                    m_lons.clear();
 
-                    protozero::iterator_range<protozero::pbf_reader::const_int32_iterator>  tags;
+                    protozero::iterator_range<protozero::pbf_reader::const_int32_iterator> tags;
+                    protozero::iterator_range<protozero::pbf_reader::const_int32_iterator> visibles;
 
                     protozero::pbf_message<OSMFormat::DenseNodes> pbf_dense_nodes{data};
                     while (pbf_dense_nodes.next()) {
                         switch (pbf_dense_nodes.tag_and_type()) {
-                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_id, protozero::pbf_wire_type::length_delimited):
-                                ids = pbf_dense_nodes.get_packed_sint64();
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_id, protozero::pbf_wire_type::length_delimited): {
+                                    const auto view = pbf_dense_nodes.get_view();
+                                    decode_packed_sint64_delta(view.data(), view.data() + view.size(), m_ids);
+                                }
                                 break;
-                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lat, protozero::pbf_wire_type::length_delimited):
-                                lats = pbf_dense_nodes.get_packed_sint64();
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::optional_DenseInfo_denseinfo, protozero::pbf_wire_type::length_delimited):
+                                // Metadata isn't decoded here, but in
+                                // read_visible::only mode the visible
+                                // flags are still needed for filtering.
+                                if (only_visible()) {
+                                    protozero::pbf_message<OSMFormat::DenseInfo> pbf_dense_info{pbf_dense_nodes.get_message()};
+                                    while (pbf_dense_info.next()) {
+                                        if (pbf_dense_info.tag_and_type() == protozero::tag_and_type(OSMFormat::DenseInfo::packed_bool_visible, protozero::pbf_wire_type::length_delimited)) {
+                                            visibles = pbf_dense_info.get_packed_bool();
+                                        } else {
+                                            pbf_dense_info.skip();
+                                        }
+                                    }
+                                } else {
+                                    pbf_dense_nodes.skip();
+                                }
+                                break;
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lat, protozero::pbf_wire_type::length_delimited): {
+                                    const auto view = pbf_dense_nodes.get_view();
+                                    decode_packed_sint64_delta(view.data(), view.data() + view.size(), m_lats);
+                                }
                                 break;
-                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lon, protozero::pbf_wire_type::length_delimited):
-                                lons = pbf_dense_nodes.get_packed_sint64();
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lon, protozero::pbf_wire_type::length_delimited): {
+                                    const auto view = pbf_dense_nodes.get_view();
+                                    decode_packed_sint64_delta(view.data(), view.data() + view.size(), m_lons);
+                                }
                                 break;
                             case protozero::tag_and_type(OSMFormat::DenseNodes::packed_int32_keys_vals, protozero::pbf_wire_type::length_delimited):
                                 tags = pbf_dense_nodes.get_packed_int32();
@@ -506,39 +869,48 @@ namespace osmium {
                         }
                     }
 
-                    osmium::DeltaDecode<int64_t> dense_id;
-                    osmium::DeltaDecode<int64_t> dense_latitude;
-                    osmium::DeltaDecode<int64_t> dense_longitude;
+                    if (m_lons.size() != m_ids.size() ||
+                        m_lats.size() != m_ids.size()) {
+                        // this is against the spec, must have same number of elements
+                        throw osmium::pbf_error{"PBF format error"};
+                    }
 
                     auto tag_it = tags.begin();
 
-                    while (!ids.empty()) {
-                        if (lons.empty() ||
-                            lats.empty()) {
-                            // this is against the spec, must have same number of elements
-                            throw osmium::pbf_error{"PBF format error"};
+                    for (std::size_t i = 0; i < m_ids.size(); ++i) {
+                        bool visible = true;
+                        if (!visibles.empty()) {
+                            visible = (visibles.front() != 0);
+                            visibles.drop_front();
+                        }
+
+                        // A following entry with the same id is a newer
+                        // version of the same node superseding this one.
+                        const bool superseded = i + 1 < m_ids.size() && m_ids[i + 1] == m_ids[i];
+
+                        if ((only_visible() && (!visible || superseded)) ||
+                            (m_ids_filter.node_ids && !id_in_set(m_ids[i], *m_ids_filter.node_ids)) ||
+                            (m_tags_filter.filter && !wanted_dense_node(tag_it, tags.end()))) {
+                            skip_tags_from_dense_nodes(tag_it, tags.end());
+                            continue;
                         }
 
                         {
                             osmium::builder::NodeBuilder builder{m_buffer};
                             osmium::Node& node = builder.object();
 
-                            node.set_id(dense_id.update(ids.front()));
-                            ids.drop_front();
+                            node.set_id(m_ids[i]);
 
-                            const auto lon = dense_longitude.update(lons.front());
-                            lons.drop_front();
-                            const auto lat = dense_latitude.update(lats.front());
-                            lats.drop_front();
                             builder.object().set_location(osmium::Location{
-                                    convert_pbf_coordinate(lon),
-                                    convert_pbf_coordinate(lat)
+                                    convert_pbf_coordinate(m_lons[i]),
+                                    convert_pbf_coordinate(m_lats[i])
                             });
 
                             if (tag_it != tags.end()) {
                                 build_tag_list_from_dense_nodes(builder, tag_it, tags.end());
                             }
                         }
+                        OSMIUM_PROFILE_COUNT(objects_decoded);
                         m_buffer.commit();
                     }
 
@@ -547,14 +919,14 @@ namespace osmium {
                 void decode_dense_nodes(const data_view& data) {
                     bool has_info = false;
 
-                    protozero::iterator_range<protozero::pbf_reader::const_sint64_iterator> ids;
-                    protozero::iterator_range<protozero::pbf_reader::const_sint64_iterator> lats;
-                    protozero::iterator_range<protozero::pbf_reader::const_sint64_iterator> lons;
+                    m_ids.clear();
+                    m_lats.clear();
+                    m_lons.clear();
+                    m_timestamps.clear();
 
                     protozero::iterator_range<protozero::pbf_reader::const_int32_iterator>  tags;
 
                     protozero::iterator_range<protozero::pbf_reader::const_int32_iterator>  versions;
-                    protozero::iterator_range<protozero::pbf_reader::const_sint64_iterator> timestamps;
                     protozero::iterator_range<protozero::pbf_reader::const_sint64_iterator> changesets;
                     protozero::iterator_range<protozero::pbf_reader::const_sint32_iterator> uids;
                     protozero::iterator_range<protozero::pbf_reader::const_sint32_iterator> user_sids;
@@ -563,8 +935,10 @@ namespace osmium {
                     protozero::pbf_message<OSMFormat::DenseNodes> pbf_dense_nodes{data};
                     while (pbf_dense_nodes.next()) {
                         switch (pbf_dense_nodes.tag_and_type()) {
-                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_id, protozero::pbf_wire_type::length_delimited):
-                                ids = pbf_dense_nodes.get_packed_sint64();
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_id, protozero::pbf_wire_type::length_delimited): {
+                                    const auto view = pbf_dense_nodes.get_view();
+                                    decode_packed_sint64_delta(view.data(), view.data() + view.size(), m_ids);
+                                }
                                 break;
                             case protozero::tag_and_type(OSMFormat::DenseNodes::optional_DenseInfo_denseinfo, protozero::pbf_wire_type::length_delimited):
                                 {
@@ -572,20 +946,45 @@ namespace osmium {
                                     protozero::pbf_message<OSMFormat::DenseInfo> pbf_dense_info{pbf_dense_nodes.get_message()};
                                     while (pbf_dense_info.next()) {
                                         switch (pbf_dense_info.tag_and_type()) {
+                                            // Disabled metadata fields are skipped here so
+                                            // their iterator ranges (or m_timestamps) stay
+                                            // empty and the code below never touches them.
                                             case protozero::tag_and_type(OSMFormat::DenseInfo::packed_int32_version, protozero::pbf_wire_type::length_delimited):
-                                                versions = pbf_dense_info.get_packed_int32();
+                                                if (m_metadata_opts.version()) {
+                                                    versions = pbf_dense_info.get_packed_int32();
+                                                } else {
+                                                    pbf_dense_info.skip();
+                                                }
                                                 break;
-                                            case protozero::tag_and_type(OSMFormat::DenseInfo::packed_sint64_timestamp, protozero::pbf_wire_type::length_delimited):
-                                                timestamps = pbf_dense_info.get_packed_sint64();
+                                            case protozero::tag_and_type(OSMFormat::DenseInfo::packed_sint64_timestamp, protozero::pbf_wire_type::length_delimited): {
+                                                    if (!m_metadata_opts.timestamp()) {
+                                                        pbf_dense_info.skip();
+                                                        break;
+                                                    }
+                                                    const auto view = pbf_dense_info.get_view();
+                                                    decode_packed_sint64_delta(view.data(), view.data() + view.size(), m_timestamps);
+                                                }
                                                 break;
                                             case protozero::tag_and_type(OSMFormat::DenseInfo::packed_sint64_changeset, protozero::pbf_wire_type::length_delimited):
-                                                changesets = pbf_dense_info.get_packed_sint64();
+                                                if (m_metadata_opts.changeset()) {
+                                                    changesets = pbf_dense_info.get_packed_sint64();
+                                                } else {
+                                                    pbf_dense_info.skip();
+                                                }
                                                 break;
                                             case protozero::tag_and_type(OSMFormat::DenseInfo::packed_sint32_uid, protozero::pbf_wire_type::length_delimited):
-                                                uids = pbf_dense_info.get_packed_sint32();
+                                                if (m_metadata_opts.uid()) {
+                                                    uids = pbf_dense_info.get_packed_sint32();
+                                                } else {
+                                                    pbf_dense_info.skip();
+                                                }
                                                 break;
                                             case protozero::tag_and_type(OSMFormat::DenseInfo::packed_sint32_user_sid, protozero::pbf_wire_type::length_delimited):
-                                                user_sids = pbf_dense_info.get_packed_sint32();
+                                                if (m_metadata_opts.user()) {
+                                                    user_sids = pbf_dense_info.get_packed_sint32();
+                                                } else {
+                                                    pbf_dense_info.skip();
+                                                }
                                                 break;
                                             case protozero::tag_and_type(OSMFormat::DenseInfo::packed_bool_visible, protozero::pbf_wire_type::length_delimited):
                                                 visibles = pbf_dense_info.get_packed_bool();
@@ -596,11 +995,15 @@ namespace osmium {
                                     }
                                 }
                                 break;
-                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lat, protozero::pbf_wire_type::length_delimited):
-                                lats = pbf_dense_nodes.get_packed_sint64();
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lat, protozero::pbf_wire_type::length_delimited): {
+                                    const auto view = pbf_dense_nodes.get_view();
+                                    decode_packed_sint64_delta(view.data(), view.data() + view.size(), m_lats);
+                                }
                                 break;
-                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lon, protozero::pbf_wire_type::length_delimited):
-                                lons = pbf_dense_nodes.get_packed_sint64();
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lon, protozero::pbf_wire_type::length_delimited): {
+                                    const auto view = pbf_dense_nodes.get_view();
+                                    decode_packed_sint64_delta(view.data(), view.data() + view.size(), m_lons);
+                                }
                                 break;
                             case protozero::tag_and_type(OSMFormat::DenseNodes::packed_int32_keys_vals, protozero::pbf_wire_type::length_delimited):
                                 tags = pbf_dense_nodes.get_packed_int32();
@@ -610,31 +1013,63 @@ namespace osmium {
                         }
                     }
 
-                    osmium::DeltaDecode<int64_t> dense_id;
-                    osmium::DeltaDecode<int64_t> dense_latitude;
-                    osmium::DeltaDecode<int64_t> dense_longitude;
                     osmium::DeltaDecode<int64_t> dense_uid;
                     osmium::DeltaDecode<int64_t> dense_user_sid;
                     osmium::DeltaDecode<int64_t> dense_changeset;
-                    osmium::DeltaDecode<int64_t> dense_timestamp;
+
+                    if (m_lons.size() != m_ids.size() ||
+                        m_lats.size() != m_ids.size()) {
+                        // this is against the spec, must have same number of elements
+                        throw osmium::pbf_error{"PBF format error"};
+                    }
 
                     auto tag_it = tags.begin();
 
-                    while (!ids.empty()) {
-                        if (lons.empty() ||
-                            lats.empty()) {
-                            // this is against the spec, must have same number of elements
-                            throw osmium::pbf_error{"PBF format error"};
+                    for (std::size_t i = 0; i < m_ids.size(); ++i) {
+                        // Peek at the visible flag (without consuming it)
+                        // so deleted nodes can be skipped before anything
+                        // is built in the buffer.
+                        const bool visible = visibles.empty() || visibles.front() != 0;
+
+                        // A following entry with the same id is a newer
+                        // version of the same node superseding this one.
+                        const bool superseded = i + 1 < m_ids.size() && m_ids[i + 1] == m_ids[i];
+
+                        if ((only_visible() && (!visible || superseded)) ||
+                            (m_ids_filter.node_ids && !id_in_set(m_ids[i], *m_ids_filter.node_ids)) ||
+                            (m_tags_filter.filter && !wanted_dense_node(tag_it, tags.end()))) {
+                            // The delta-encoded metadata fields have to be
+                            // consumed even for skipped nodes, otherwise the
+                            // values of the following nodes would be wrong.
+                            if (has_info) {
+                                if (!versions.empty()) {
+                                    versions.drop_front();
+                                }
+                                if (!changesets.empty()) {
+                                    dense_changeset.update(changesets.front());
+                                    changesets.drop_front();
+                                }
+                                if (!uids.empty()) {
+                                    dense_uid.update(uids.front());
+                                    uids.drop_front();
+                                }
+                                if (!visibles.empty()) {
+                                    visibles.drop_front();
+                                }
+                                if (!user_sids.empty()) {
+                                    dense_user_sid.update(user_sids.front());
+                                    user_sids.drop_front();
+                                }
+                            }
+                            skip_tags_from_dense_nodes(tag_it, tags.end());
+                            continue;
                         }
 
-                        bool visible = true;
-
                         {
                             osmium::builder::NodeBuilder builder{m_buffer};
                             osmium::Node& node = builder.object();
 
-                            node.set_id(dense_id.update(ids.front()));
-                            ids.drop_front();
+                            node.set_id(m_ids[i]);
 
                             if (has_info) {
                                 if (!versions.empty()) {
@@ -665,9 +1100,8 @@ namespace osmium {
                                     }
                                 }
 
-                                if (!timestamps.empty()) {
-                                    node.set_timestamp(dense_timestamp.update(timestamps.front()) * m_date_factor / 1000);
-                                    timestamps.drop_front();
+                                if (i < m_timestamps.size()) {
+                                    node.set_timestamp(m_timestamps[i] * m_date_factor / 1000);
                                 }
 
                                 if (!uids.empty()) {
@@ -676,13 +1110,12 @@ namespace osmium {
                                 }
 
                                 if (!visibles.empty()) {
-                                    visible = (visibles.front() != 0);
                                     visibles.drop_front();
                                 }
                                 node.set_visible(visible);
 
                                 if (!user_sids.empty()) {
-                                    const auto& u = m_stringtable.at(dense_user_sid.update(user_sids.front()));
+                                    const auto& u = string_at(dense_user_sid.update(user_sids.front()));
                                     user_sids.drop_front();
                                     builder.set_user(u.first, u.second);
                                 }
@@ -690,14 +1123,10 @@ namespace osmium {
 
                             // even if the node isn't visible, there's still a record
                             // of its lat/lon in the dense arrays.
-                            const auto lon = dense_longitude.update(lons.front());
-                            lons.drop_front();
-                            const auto lat = dense_latitude.update(lats.front());
-                            lats.drop_front();
                             if (visible) {
                                 builder.object().set_location(osmium::Location{
-                                        convert_pbf_coordinate(lon),
-                                        convert_pbf_coordinate(lat)
+                                        convert_pbf_coordinate(m_lons[i]),
+                                        convert_pbf_coordinate(m_lats[i])
                                 });
                             }
 
@@ -705,16 +1134,21 @@ namespace osmium {
                                 build_tag_list_from_dense_nodes(builder, tag_it, tags.end());
                             }
                         }
+                        OSMIUM_PROFILE_COUNT(objects_decoded);
                         m_buffer.commit();
                     }
                 }
 
             public:
 
-                PBFPrimitiveBlockDecoder(const data_view& data, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata) :
+                PBFPrimitiveBlockDecoder(const data_view& data, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata, pbf_tags_filter tags_filter = {}, pbf_ids_filter ids_filter = {}, const osmium::metadata_options metadata_opts = {}, const osmium::io::read_visible read_visible_objects = osmium::io::read_visible::all) :
                     m_data(data),
+                    m_tags_filter(std::move(tags_filter)),
+                    m_ids_filter(std::move(ids_filter)),
                     m_read_types(read_types),
-                    m_read_metadata(read_metadata) {
+                    m_read_metadata(read_metadata),
+                    m_metadata_opts(metadata_opts),
+                    m_read_visible(read_visible_objects) {
                 }
 
                 PBFPrimitiveBlockDecoder(const PBFPrimitiveBlockDecoder&) = delete;
@@ -738,9 +1172,10 @@ namespace osmium {
 
             }; // class PBFPrimitiveBlockDecoder
 
-            inline data_view decode_blob(const std::string& blob_data, std::string& output) {
+            inline data_view decode_blob(const data_view& blob_data, std::string& output) {
                 int32_t raw_size = 0;
                 protozero::data_view zlib_data;
+                protozero::data_view zstd_data;
 
                 protozero::pbf_message<FileFormat::Blob> pbf_blob{blob_data};
                 while (pbf_blob.next()) {
@@ -764,12 +1199,34 @@ namespace osmium {
                             break;
                         case protozero::tag_and_type(FileFormat::Blob::optional_bytes_lzma_data, protozero::pbf_wire_type::length_delimited):
                             throw osmium::pbf_error{"lzma blobs not implemented"};
+                        case protozero::tag_and_type(FileFormat::Blob::optional_bytes_zstd_data, protozero::pbf_wire_type::length_delimited):
+#ifdef OSMIUM_WITH_ZSTD
+                            zstd_data = pbf_blob.get_view();
+                            break;
+#else
+                            throw osmium::pbf_error{"zstd blobs not supported, compile with OSMIUM_WITH_ZSTD"};
+#endif
                         default:
                             throw osmium::pbf_error{"unknown compression"};
                     }
                 }
 
+#ifdef OSMIUM_WITH_ZSTD
+                if (!zstd_data.empty() && raw_size != 0) {
+                    OSMIUM_PROFILE_ADD(bytes_compressed, zstd_data.size());
+                    return osmium::io::detail::zstd_uncompress_string(
+                        zstd_data.data(),
+                        zstd_data.size(),
+                        static_cast<std::size_t>(raw_size),
+                        output
+                    );
+                }
+#else
+                (void)zstd_data;
+#endif
+
                 if (!zlib_data.empty() && raw_size != 0) {
+                    OSMIUM_PROFILE_ADD(bytes_compressed, zlib_data.size());
                     return osmium::io::detail::zlib_uncompress_string(
                         zlib_data.data(),
                         static_cast<unsigned long>(zlib_data.size()), // NOLINT(google-runtime-int)
@@ -881,7 +1338,7 @@ namespace osmium {
              * @returns Header object
              * @throws osmium::pbf_error If there was a parsing error
              */
-            inline osmium::io::Header decode_header(const std::string& header_block_data) {
+            inline osmium::io::Header decode_header(const data_view& header_block_data) {
                 std::string output;
 
                 return decode_header_block(decode_blob(header_block_data, output));
@@ -889,21 +1346,51 @@ namespace osmium {
 
             class PBFDataBlobDecoder {
 
-                std::shared_ptr<std::string> m_input_buffer;
+                std::shared_ptr<const void> m_input_owner{};
+                data_view m_input_data{};
+                pbf_tags_filter m_tags_filter{};
+                pbf_ids_filter m_ids_filter{};
                 osmium::osm_entity_bits::type m_read_types;
                 osmium::io::read_meta m_read_metadata;
+                osmium::metadata_options m_metadata_opts{};
+                osmium::io::read_visible m_read_visible;
 
             public:
 
-                PBFDataBlobDecoder(std::string&& input_buffer, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata) :
-                    m_input_buffer(std::make_shared<std::string>(std::move(input_buffer))),
+                PBFDataBlobDecoder(std::string&& input_buffer, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata, pbf_tags_filter tags_filter = {}, pbf_ids_filter ids_filter = {}, const osmium::metadata_options metadata_opts = {}, const osmium::io::read_visible read_visible_objects = osmium::io::read_visible::all) :
+                    m_tags_filter(std::move(tags_filter)),
+                    m_ids_filter(std::move(ids_filter)),
+                    m_read_types(read_types),
+                    m_read_metadata(read_metadata),
+                    m_metadata_opts(metadata_opts),
+                    m_read_visible(read_visible_objects) {
+                    auto buffer = std::make_shared<std::string>(std::move(input_buffer));
+                    m_input_data = data_view{buffer->data(), buffer->size()};
+                    m_input_owner = std::move(buffer);
+                }
+
+                /**
+                 * Decode a blob sitting in externally owned memory, for
+                 * instance a memory mapping of the input file. No data is
+                 * copied, the owner pointer keeps the memory alive while
+                 * this decoder (or a copy of it queued in the thread pool)
+                 * exists.
+                 */
+                PBFDataBlobDecoder(std::shared_ptr<const void> input_owner, const data_view& input_data, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata, pbf_tags_filter tags_filter = {}, pbf_ids_filter ids_filter = {}, const osmium::metadata_options metadata_opts = {}, const osmium::io::read_visible read_visible_objects = osmium::io::read_visible::all) :
+                    m_input_owner(std::move(input_owner)),
+                    m_input_data(input_data),
+                    m_tags_filter(std::move(tags_filter)),
+                    m_ids_filter(std::move(ids_filter)),
                     m_read_types(read_types),
-                    m_read_metadata(read_metadata) {
+                    m_read_metadata(read_metadata),
+                    m_metadata_opts(metadata_opts),
+                    m_read_visible(read_visible_objects) {
                 }
 
                 osmium::memory::Buffer operator()() {
+                    OSMIUM_PROBE1(pbf_blob_decode, m_input_data.size());
                     std::string output;
-                    PBFPrimitiveBlockDecoder decoder{decode_blob(*m_input_buffer, output), m_read_types, m_read_metadata};
+                    PBFPrimitiveBlockDecoder decoder{decode_blob(m_input_data, output), m_read_types, m_read_metadata, m_tags_filter, m_ids_filter, m_metadata_opts, m_read_visible};
                     return decoder();
                 }
 
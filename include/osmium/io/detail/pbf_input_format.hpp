@@ -42,7 +42,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/entity_bits.hpp>
 #include <osmium/thread/pool.hpp>
 #include <osmium/thread/util.hpp>
-#include <osmium/util/config.hpp>
+#include <osmium/util/tuning.hpp>
 
 #include <protozero/pbf_message.hpp>
 #include <protozero/types.hpp>
@@ -66,6 +66,16 @@ namespace osmium {
 
                 std::string m_input_buffer{};
 
+                // File offset after the last blob record fully read
+                // from the input queue. Only meaningful when reading
+                // through the queue, the memory path uses m_memory_ptr.
+                std::size_t m_file_offset = 0;
+
+                // Read position and end when reading directly from memory
+                // (see has_memory_input()).
+                const char* m_memory_ptr = nullptr;
+                const char* m_memory_end = nullptr;
+
                 /**
                  * Read the given number of bytes from the input queue.
                  *
@@ -117,28 +127,51 @@ namespace osmium {
                     return size;
                 }
 
+                /**
+                 * What we know about a blob after decoding its BlobHeader
+                 * but before touching the Blob itself: its size and,
+                 * when the BlobHeader carries our indexdata marker, the
+                 * types of the entities in it. Without the marker the
+                 * entity types are unknown, so they default to "all"
+                 * and the blob is always decoded.
+                 */
+                struct blob_header_info {
+                    size_t datasize = 0;
+                    osmium::osm_entity_bits::type entity_types = osmium::osm_entity_bits::all;
+                };
+
                 /**
                  * Decode the BlobHeader. Make sure it contains the expected
-                 * type. Return the size of the following Blob.
+                 * type. Return the size of the following Blob and the
+                 * entity types noted in the indexdata field, if any.
                  */
-                size_t decode_blob_header(protozero::pbf_message<FileFormat::BlobHeader>&& pbf_blob_header, const char* expected_type) {
+                blob_header_info decode_blob_header(protozero::pbf_message<FileFormat::BlobHeader>&& pbf_blob_header, const char* expected_type) {
                     protozero::data_view blob_header_type;
-                    size_t blob_header_datasize = 0;
+                    blob_header_info info;
 
                     while (pbf_blob_header.next()) {
                         switch (pbf_blob_header.tag_and_type()) {
                             case protozero::tag_and_type(FileFormat::BlobHeader::required_string_type, protozero::pbf_wire_type::length_delimited):
                                 blob_header_type = pbf_blob_header.get_view();
                                 break;
+                            case protozero::tag_and_type(FileFormat::BlobHeader::optional_bytes_indexdata, protozero::pbf_wire_type::length_delimited): {
+                                const auto view = pbf_blob_header.get_view();
+                                // only use indexdata with our "OE" marker,
+                                // other writers can put anything in here
+                                if (view.size() == 3 && view.data()[0] == 'O' && view.data()[1] == 'E') {
+                                    info.entity_types = static_cast<osmium::osm_entity_bits::type>(static_cast<unsigned char>(view.data()[2])) & osmium::osm_entity_bits::all;
+                                }
+                                break;
+                            }
                             case protozero::tag_and_type(FileFormat::BlobHeader::required_int32_datasize, protozero::pbf_wire_type::varint):
-                                blob_header_datasize = pbf_blob_header.get_int32();
+                                info.datasize = pbf_blob_header.get_int32();
                                 break;
                             default:
                                 pbf_blob_header.skip();
                         }
                     }
 
-                    if (blob_header_datasize == 0) {
+                    if (info.datasize == 0) {
                         throw osmium::pbf_error{"PBF format error: BlobHeader.datasize missing or zero."};
                     }
 
@@ -146,18 +179,19 @@ namespace osmium {
                         throw osmium::pbf_error{"blob does not have expected type (OSMHeader in first blob, OSMData in following blobs)"};
                     }
 
-                    return blob_header_datasize;
+                    return info;
                 }
 
-                size_t check_type_and_get_blob_size(const char* expected_type) {
+                blob_header_info check_type_and_get_blob_size(const char* expected_type) {
                     assert(expected_type);
 
                     const auto size = read_blob_header_size_from_file();
                     if (size == 0) { // EOF
-                        return 0;
+                        return blob_header_info{};
                     }
 
                     const std::string blob_header{read_from_input_queue(size)};
+                    m_file_offset += 4 + size;
 
                     return decode_blob_header(protozero::pbf_message<FileFormat::BlobHeader>(blob_header), expected_type);
                 }
@@ -172,25 +206,196 @@ namespace osmium {
 
                 // Parse the header in the PBF OSMHeader blob.
                 void parse_header_blob() {
-                    const auto size = check_type_and_get_blob_size("OSMHeader");
+                    const auto size = check_type_and_get_blob_size("OSMHeader").datasize;
                     osmium::io::Header header{decode_header(read_from_input_queue_with_check(size))};
+                    m_file_offset += size;
+                    log_offset(m_file_offset);
                     set_header_value(header);
                 }
 
+                /// Does this blob contain none of the entity types we want?
+                bool can_skip_blob(const blob_header_info& info) const noexcept {
+                    return (info.entity_types & read_types()) == osmium::osm_entity_bits::nothing;
+                }
+
                 void parse_data_blobs() {
-                    while (const auto size = check_type_and_get_blob_size("OSMData")) {
-                        std::string input_buffer{read_from_input_queue_with_check(size)};
+                    for (;;) {
+                        const auto info = check_type_and_get_blob_size("OSMData");
+                        if (info.datasize == 0) { // EOF
+                            break;
+                        }
+
+                        std::string input_buffer{read_from_input_queue_with_check(info.datasize)};
+                        m_file_offset += info.datasize;
+                        log_offset(m_file_offset);
+
+                        // The BlobHeader told us there is nothing of
+                        // interest in this blob, no need to decompress
+                        // and decode it.
+                        if (can_skip_blob(info)) {
+                            continue;
+                        }
 
-                        PBFDataBlobDecoder data_blob_parser{std::move(input_buffer), read_types(), read_metadata()};
+                        PBFDataBlobDecoder data_blob_parser{std::move(input_buffer), read_types(), read_metadata(), tags_filter(), ids_filter(), metadata_opts(), read_visible_objects()};
 
-                        if (osmium::config::use_pool_threads_for_pbf_parsing()) {
-                            send_to_output_queue(get_pool().submit(std::move(data_blob_parser)));
+                        if (osmium::config::tuning().pool_threads_for_pbf_parsing) {
+                            send_to_output_queue(get_quota().submit(std::move(data_blob_parser)));
                         } else {
                             send_to_output_queue(data_blob_parser());
                         }
                     }
                 }
 
+                /**
+                 * Read the given number of bytes directly from the memory
+                 * mapping of the input file. No data is copied.
+                 *
+                 * @throws osmium::pbf_error If size bytes aren't available
+                 */
+                data_view read_from_memory(size_t size) {
+                    if (static_cast<size_t>(m_memory_end - m_memory_ptr) < size) {
+                        throw osmium::pbf_error{"truncated data (EOF encountered)"};
+                    }
+                    const data_view data{m_memory_ptr, size};
+                    m_memory_ptr += size;
+                    return data;
+                }
+
+                uint32_t read_blob_header_size_from_memory() {
+                    if (m_memory_ptr == m_memory_end) {
+                        return 0; // EOF
+                    }
+
+                    const auto input_data = read_from_memory(4);
+                    const auto* d = reinterpret_cast<const uint8_t*>(input_data.data());
+                    const uint32_t size = (static_cast<uint32_t>(d[3])) |
+                                          (static_cast<uint32_t>(d[2]) << 8u) |
+                                          (static_cast<uint32_t>(d[1]) << 16u) |
+                                          (static_cast<uint32_t>(d[0]) << 24u);
+
+                    if (size > static_cast<uint32_t>(max_blob_header_size)) {
+                        throw osmium::pbf_error{"invalid BlobHeader size (> max_blob_header_size)"};
+                    }
+
+                    return size;
+                }
+
+                blob_header_info check_type_and_get_blob_size_from_memory(const char* expected_type) {
+                    assert(expected_type);
+
+                    const auto size = read_blob_header_size_from_memory();
+                    if (size == 0) { // EOF
+                        return blob_header_info{};
+                    }
+
+                    const auto blob_header = read_from_memory(size);
+
+                    return decode_blob_header(protozero::pbf_message<FileFormat::BlobHeader>(blob_header), expected_type);
+                }
+
+                data_view read_from_memory_with_check(size_t size) {
+                    if (size > max_uncompressed_blob_size) {
+                        throw osmium::pbf_error{std::string{"invalid blob size: "} +
+                                                std::to_string(size)};
+                    }
+                    return read_from_memory(size);
+                }
+
+                /**
+                 * Parse the whole file from the memory mapping, handing
+                 * views into the mapping directly to the blob decoders.
+                 * The input queue is not used at all.
+                 */
+                void parse_from_memory() {
+                    m_memory_ptr = memory_data();
+                    m_memory_end = memory_data() + memory_size();
+
+                    if (resume_offset() != 0) {
+                        m_memory_ptr += resume_offset();
+                        log_offset(resume_offset());
+                        set_header_value(resume_header());
+                    } else {
+                        const auto header_size = check_type_and_get_blob_size_from_memory("OSMHeader").datasize;
+                        osmium::io::Header header{decode_header(read_from_memory_with_check(header_size))};
+                        log_offset(static_cast<std::size_t>(m_memory_ptr - memory_data()));
+                        set_header_value(header);
+                    }
+
+                    if (read_types() == osmium::osm_entity_bits::nothing) {
+                        return;
+                    }
+
+                    if (blob_ranges().ranges) {
+                        parse_blob_ranges_from_memory();
+                        return;
+                    }
+
+                    for (;;) {
+                        const auto info = check_type_and_get_blob_size_from_memory("OSMData");
+                        if (info.datasize == 0) { // EOF
+                            break;
+                        }
+
+                        const auto blob_data = read_from_memory_with_check(info.datasize);
+                        log_offset(static_cast<std::size_t>(m_memory_ptr - memory_data()));
+
+                        if (can_skip_blob(info)) {
+                            continue;
+                        }
+
+                        PBFDataBlobDecoder data_blob_parser{memory_owner(), blob_data, read_types(), read_metadata(), tags_filter(), ids_filter(), metadata_opts(), read_visible_objects()};
+
+                        if (osmium::config::tuning().pool_threads_for_pbf_parsing) {
+                            send_to_output_queue(get_quota().submit(std::move(data_blob_parser)));
+                        } else {
+                            send_to_output_queue(data_blob_parser());
+                        }
+                    }
+                }
+
+                /**
+                 * Parse only the blob records in the byte ranges given as
+                 * the pbf_blob_ranges option, usually coming from a sidecar
+                 * index (see osmium/io/pbf_blob_index.hpp). All other blobs
+                 * are never touched.
+                 */
+                void parse_blob_ranges_from_memory() {
+                    for (const auto& range : *blob_ranges().ranges) {
+                        if (range.first + range.second > memory_size()) {
+                            throw osmium::pbf_error{"blob range outside of file"};
+                        }
+                        m_memory_ptr = memory_data() + range.first;
+                        m_memory_end = m_memory_ptr + range.second;
+
+                        const auto info = check_type_and_get_blob_size_from_memory("OSMData");
+                        if (info.datasize == 0) {
+                            throw osmium::pbf_error{"blob range does not point at a blob record"};
+                        }
+
+                        if (can_skip_blob(info)) {
+                            continue;
+                        }
+
+                        PBFDataBlobDecoder data_blob_parser{memory_owner(), read_from_memory_with_check(info.datasize), read_types(), read_metadata(), tags_filter(), ids_filter(), metadata_opts(), read_visible_objects()};
+
+                        if (osmium::config::tuning().pool_threads_for_pbf_parsing) {
+                            send_to_output_queue(get_quota().submit(std::move(data_blob_parser)));
+                        } else {
+                            send_to_output_queue(data_blob_parser());
+                        }
+                    }
+                }
+
+                // Log the offset after a blob record for checkpoints.
+                // With blob ranges the delivered blobs don't form a
+                // prefix of the file, a resume offset would be
+                // meaningless, so nothing is logged then.
+                void log_offset(const std::size_t offset) {
+                    if (offset_log() && !blob_ranges().ranges) {
+                        offset_log()->add(offset);
+                    }
+                }
+
             public:
 
                 explicit PBFParser(parser_arguments& args) :
@@ -208,7 +413,21 @@ namespace osmium {
                 void run() final {
                     osmium::thread::set_thread_name("_osmium_pbf_in");
 
-                    parse_header_blob();
+                    if (has_memory_input()) {
+                        parse_from_memory();
+                        return;
+                    }
+
+                    if (resume_offset() != 0) {
+                        // Resuming from a checkpoint: the input stream
+                        // starts at a data blob record, the header
+                        // comes from the checkpoint.
+                        m_file_offset = resume_offset();
+                        log_offset(m_file_offset);
+                        set_header_value(resume_header());
+                    } else {
+                        parse_header_blob();
+                    }
 
                     if (read_types() != osmium::osm_entity_bits::nothing) {
                         parse_data_blobs();
@@ -33,19 +33,22 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
-#include <osmium/handler.hpp>
 #include <osmium/io/detail/output_format.hpp>
 #include <osmium/io/detail/pbf.hpp> // IWYU pragma: export
 #include <osmium/io/detail/protobuf_tags.hpp>
 #include <osmium/io/detail/queue_util.hpp>
 #include <osmium/io/detail/string_table.hpp>
 #include <osmium/io/detail/zlib.hpp>
+#ifdef OSMIUM_WITH_ZSTD
+# include <osmium/io/detail/zstd.hpp>
+#endif
 #include <osmium/io/file.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/memory/item_iterator.hpp>
 #include <osmium/osm/box.hpp>
+#include <osmium/osm/entity_bits.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/metadata_options.hpp>
@@ -60,7 +63,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/thread/pool.hpp>
 #include <osmium/util/delta.hpp>
 #include <osmium/util/misc.hpp>
-#include <osmium/visitor.hpp>
+#include <osmium/util/probes.hpp>
 
 #include <protozero/pbf_builder.hpp>
 #include <protozero/pbf_writer.hpp>
@@ -68,8 +71,10 @@ DEALINGS IN THE SOFTWARE.
 
 #include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -81,6 +86,12 @@ namespace osmium {
 
         namespace detail {
 
+            enum class pbf_compression {
+                none = 0,
+                zlib = 1,
+                zstd = 2
+            };
+
             struct pbf_output_options {
 
                 /// Which metadata of objects should be added?
@@ -90,14 +101,21 @@ namespace osmium {
                 bool use_dense_nodes = true;
 
                 /**
-                 * Should the PBF blobs contain zlib compressed data?
+                 * How should the PBF blobs be compressed?
                  *
-                 * The zlib compression is optional, it's possible to store the
+                 * The compression is optional, it's possible to store the
                  * blobs in raw format. Disabling the compression can improve
                  * the writing speed a little but the output will be 2x to 3x
                  * bigger.
                  */
-                bool use_compression = true;
+                pbf_compression use_compression = pbf_compression::zlib;
+
+                /**
+                 * Compression level for compressed blobs. Only used for
+                 * zstd, the zlib compressor always uses its default level.
+                 * 0 means "use the default level".
+                 */
+                int compression_level = 0;
 
                 /// Add the "HistoricalInformation" header flag.
                 bool add_historical_information_flag = false;
@@ -137,18 +155,134 @@ namespace osmium {
                 return static_cast<int64_t>(std::round(lonlat * lonlat_resolution / location_granularity));
             }
 
+            /**
+             * Flat arrays with the not-yet-delta-encoded data for a
+             * DenseNodes group. This is kept separate from the DenseNodes
+             * class so the data can be moved into the serialization task
+             * running on the thread pool.
+             */
+            struct dense_nodes_data {
+
+                std::vector<int64_t> ids;
+
+                std::vector<int32_t> versions;
+                std::vector<int64_t> timestamps;
+                std::vector<int64_t> changesets;
+                std::vector<int32_t> uids;
+                std::vector<int32_t> user_sids;
+                std::vector<bool> visibles;
+
+                std::vector<int64_t> lats;
+                std::vector<int64_t> lons;
+                std::vector<int32_t> tags;
+
+            }; // struct dense_nodes_data
+
+            /**
+             * Serialize the data for a DenseNodes group into a DenseNodes
+             * protobuf message. The delta encoding happens here, in one
+             * bulk pass per array (see osmium::DeltaEncode::update()),
+             * which the compiler can vectorize, instead of scalar-by-scalar
+             * while the nodes are added.
+             */
+            inline std::string serialize_dense_nodes(dense_nodes_data&& data, const pbf_output_options& options) {
+                std::string dense_nodes_message;
+                protozero::pbf_builder<OSMFormat::DenseNodes> pbf_dense_nodes{dense_nodes_message};
+
+                osmium::DeltaEncode<int64_t, int64_t>{}.update(data.ids.data(), data.ids.size());
+                pbf_dense_nodes.add_packed_sint64(OSMFormat::DenseNodes::packed_sint64_id, data.ids.cbegin(), data.ids.cend());
+
+                if (options.add_metadata.any() || options.add_visible_flag) {
+                    protozero::pbf_builder<OSMFormat::DenseInfo> pbf_dense_info{pbf_dense_nodes, OSMFormat::DenseNodes::optional_DenseInfo_denseinfo};
+                    if (options.add_metadata.version()) {
+                        pbf_dense_info.add_packed_int32(OSMFormat::DenseInfo::packed_int32_version, data.versions.cbegin(), data.versions.cend());
+                    }
+                    if (options.add_metadata.timestamp()) {
+                        osmium::DeltaEncode<int64_t, int64_t>{}.update(data.timestamps.data(), data.timestamps.size());
+                        pbf_dense_info.add_packed_sint64(OSMFormat::DenseInfo::packed_sint64_timestamp, data.timestamps.cbegin(), data.timestamps.cend());
+                    }
+                    if (options.add_metadata.changeset()) {
+                        osmium::DeltaEncode<int64_t, int64_t>{}.update(data.changesets.data(), data.changesets.size());
+                        pbf_dense_info.add_packed_sint64(OSMFormat::DenseInfo::packed_sint64_changeset, data.changesets.cbegin(), data.changesets.cend());
+                    }
+                    if (options.add_metadata.uid()) {
+                        osmium::DeltaEncode<int32_t, int32_t>{}.update(data.uids.data(), data.uids.size());
+                        pbf_dense_info.add_packed_sint32(OSMFormat::DenseInfo::packed_sint32_uid, data.uids.cbegin(), data.uids.cend());
+                    }
+                    if (options.add_metadata.user()) {
+                        osmium::DeltaEncode<int32_t, int32_t>{}.update(data.user_sids.data(), data.user_sids.size());
+                        pbf_dense_info.add_packed_sint32(OSMFormat::DenseInfo::packed_sint32_user_sid, data.user_sids.cbegin(), data.user_sids.cend());
+                    }
+                    if (options.add_visible_flag) {
+                        pbf_dense_info.add_packed_bool(OSMFormat::DenseInfo::packed_bool_visible, data.visibles.cbegin(), data.visibles.cend());
+                    }
+                }
+
+                osmium::DeltaEncode<int64_t, int64_t>{}.update(data.lats.data(), data.lats.size());
+                pbf_dense_nodes.add_packed_sint64(OSMFormat::DenseNodes::packed_sint64_lat, data.lats.cbegin(), data.lats.cend());
+                osmium::DeltaEncode<int64_t, int64_t>{}.update(data.lons.data(), data.lons.size());
+                pbf_dense_nodes.add_packed_sint64(OSMFormat::DenseNodes::packed_sint64_lon, data.lons.cbegin(), data.lons.cend());
+
+                pbf_dense_nodes.add_packed_int32(OSMFormat::DenseNodes::packed_int32_keys_vals, data.tags.cbegin(), data.tags.cend());
+
+                return dense_nodes_message;
+            }
+
             enum class pbf_blob_type {
                 header = 0,
                 data = 1
             };
 
+            /**
+             * Append a value to the string as a padded five-byte varint.
+             * Varints with redundant continuation bytes are valid protobuf
+             * encoding. The fixed width allows writing a length field
+             * before the data it describes is there and patching in the
+             * real value afterwards, see patch_padded_varint().
+             */
+            inline void append_padded_varint(std::string& data, const uint32_t value) {
+                data += static_cast<char>(( value         & 0x7fu) | 0x80u);
+                data += static_cast<char>(((value >>  7u) & 0x7fu) | 0x80u);
+                data += static_cast<char>(((value >> 14u) & 0x7fu) | 0x80u);
+                data += static_cast<char>(((value >> 21u) & 0x7fu) | 0x80u);
+                data += static_cast<char>( (value >> 28u) & 0x7fu);
+            }
+
+            /// Overwrite a padded five-byte varint written earlier at the given offset.
+            inline void patch_padded_varint(std::string& data, const std::size_t offset, const uint32_t value) {
+                data[offset    ] = static_cast<char>(( value         & 0x7fu) | 0x80u);
+                data[offset + 1] = static_cast<char>(((value >>  7u) & 0x7fu) | 0x80u);
+                data[offset + 2] = static_cast<char>(((value >> 14u) & 0x7fu) | 0x80u);
+                data[offset + 3] = static_cast<char>(((value >> 21u) & 0x7fu) | 0x80u);
+                data[offset + 4] = static_cast<char>( (value >> 28u) & 0x7fu);
+            }
+
+            /// Append a value to the string as a (minimal) varint.
+            inline void append_varint(std::string& data, uint64_t value) {
+                while (value >= 0x80u) {
+                    data += static_cast<char>((value & 0x7fu) | 0x80u);
+                    value >>= 7u;
+                }
+                data += static_cast<char>(value);
+            }
+
+            /// Append a protobuf field key (tag and wire type) to the string.
+            inline void append_field_key(std::string& data, const protozero::pbf_tag_type tag, const unsigned int wire_type) {
+                assert(tag < 16 && "field key must fit into a single byte");
+                data += static_cast<char>((tag << 3u) | wire_type);
+            }
+
             class SerializeBlob {
 
                 std::string m_msg;
 
                 pbf_blob_type m_blob_type;
 
-                bool m_use_compression;
+                pbf_compression m_use_compression;
+
+                int m_compression_level;
+
+                osmium::osm_entity_bits::type m_entity_types;
 
             public:
 
@@ -157,57 +291,121 @@ namespace osmium {
                  *
                  * @param msg Protobuf-message containing the blob data
                  * @param type Type of blob.
-                 * @param use_compression Should the output be compressed using
-                 *        zlib?
+                 * @param use_compression How should the output be
+                 *        compressed?
+                 * @param compression_level Compression level, 0 for the
+                 *        default of the chosen compressor.
+                 * @param entity_types Types of the entities in a data
+                 *        blob. If set, they are noted in the (never
+                 *        compressed) indexdata field of the BlobHeader
+                 *        so readers can skip the blob without
+                 *        decompressing it.
                  */
-                SerializeBlob(std::string&& msg, pbf_blob_type type, bool use_compression) :
+                SerializeBlob(std::string&& msg, pbf_blob_type type, pbf_compression use_compression, int compression_level,
+                              osmium::osm_entity_bits::type entity_types = osmium::osm_entity_bits::nothing) :
                     m_msg(std::move(msg)),
                     m_blob_type(type),
-                    m_use_compression(use_compression) {
+                    m_use_compression(use_compression),
+                    m_compression_level(compression_level),
+                    m_entity_types(entity_types) {
                 }
 
                 /**
                  * Serialize a protobuf message into a Blob, optionally apply
                  * compression and return it together with a BlobHeader ready
                  * to be written to a file.
+                 *
+                 * Everything is assembled directly in the output buffer:
+                 * The BlobHeader has a fixed length, because its datasize
+                 * field is written as a padded five-byte varint, so the
+                 * Blob can be built in place behind it and the compressors
+                 * write their output directly to its final position. This
+                 * saves two large temporary buffers and the copies into and
+                 * out of them for every blob.
                  */
                 std::string operator()() {
+                    OSMIUM_PROBE1(pbf_blob_serialize, m_msg.size());
                     assert(m_msg.size() <= max_uncompressed_blob_size);
 
-                    std::string blob_data;
-                    protozero::pbf_builder<FileFormat::Blob> pbf_blob{blob_data};
-
-                    if (m_use_compression) {
-                        pbf_blob.add_int32(FileFormat::Blob::optional_int32_raw_size, int32_t(m_msg.size()));
-                        pbf_blob.add_bytes(FileFormat::Blob::optional_bytes_zlib_data, osmium::io::detail::zlib_compress(m_msg));
-                    } else {
-                        pbf_blob.add_bytes(FileFormat::Blob::optional_bytes_raw, m_msg);
-                    }
-
-                    std::string blob_header_data;
-                    protozero::pbf_builder<FileFormat::BlobHeader> pbf_blob_header{blob_header_data};
+                    const char* blob_type = m_blob_type == pbf_blob_type::data ? "OSMData" : "OSMHeader";
+                    const std::size_t blob_type_size = std::strlen(blob_type);
 
-                    pbf_blob_header.add_string(FileFormat::BlobHeader::required_string_type, m_blob_type == pbf_blob_type::data ? "OSMData" : "OSMHeader");
+                    const bool add_indexdata = m_blob_type == pbf_blob_type::data &&
+                                               m_entity_types != osmium::osm_entity_bits::nothing;
 
-                    // The static_cast is okay, because the size can never
-                    // be much larger than max_uncompressed_blob_size. This
-                    // is due to the assert above and the fact that the zlib
-                    // library will not grow deflated data beyond the original
-                    // data plus a few header bytes (https://zlib.net/zlib_tech.html).
-                    pbf_blob_header.add_int32(FileFormat::BlobHeader::required_int32_datasize, static_cast<int32_t>(blob_data.size()));
+                    // field key + length + string, optionally field key +
+                    // length + indexdata, field key + padded varint
+                    const std::size_t blob_header_size = 2 + blob_type_size + (add_indexdata ? 2 + 3 : 0) + 1 + 5;
 
-                    const auto size = static_cast<uint32_t>(blob_header_data.size());
-
-                    // write to output: the 4-byte BlobHeader size in network
-                    // byte order followed by the BlobHeader followed by the Blob
                     std::string output;
-                    output.reserve(4 + blob_header_data.size() + blob_data.size());
+                    output.reserve(4 + blob_header_size + 16 + m_msg.size() + m_msg.size() / 128);
+
+                    // the 4-byte BlobHeader size in network byte order
+                    const auto size = static_cast<uint32_t>(blob_header_size);
                     output += static_cast<char>((size >> 24u) & 0xffu);
                     output += static_cast<char>((size >> 16u) & 0xffu);
                     output += static_cast<char>((size >>  8u) & 0xffu);
                     output += static_cast<char>( size         & 0xffu);
-                    output.append(blob_header_data);
-                    output.append(blob_data);
+
+                    // the BlobHeader with a placeholder for the datasize
+                    append_field_key(output, protozero::pbf_tag_type(FileFormat::BlobHeader::required_string_type), 2u);
+                    output += static_cast<char>(blob_type_size);
+                    output.append(blob_type);
+                    if (add_indexdata) {
+                        // "OE" (for OSM entities) plus one byte with the
+                        // entity type bits of the objects in this blob
+                        append_field_key(output, protozero::pbf_tag_type(FileFormat::BlobHeader::optional_bytes_indexdata), 2u);
+                        output += static_cast<char>(3);
+                        output += 'O';
+                        output += 'E';
+                        output += static_cast<char>(m_entity_types);
+                    }
+                    append_field_key(output, protozero::pbf_tag_type(FileFormat::BlobHeader::required_int32_datasize), 0u);
+                    const std::size_t datasize_offset = output.size();
+                    append_padded_varint(output, 0);
+
+                    // the Blob
+                    const std::size_t blob_offset = output.size();
+                    switch (m_use_compression) {
+                        case pbf_compression::none:
+                            append_field_key(output, protozero::pbf_tag_type(FileFormat::Blob::optional_bytes_raw), 2u);
+                            append_varint(output, m_msg.size());
+                            output.append(m_msg);
+                            break;
+                        case pbf_compression::zlib: {
+                            append_field_key(output, protozero::pbf_tag_type(FileFormat::Blob::optional_int32_raw_size), 0u);
+                            append_varint(output, m_msg.size());
+                            append_field_key(output, protozero::pbf_tag_type(FileFormat::Blob::optional_bytes_zlib_data), 2u);
+                            const std::size_t compressed_size_offset = output.size();
+                            append_padded_varint(output, 0);
+                            const auto compressed_size = osmium::io::detail::zlib_compress_into(m_msg, output, output.size());
+                            patch_padded_varint(output, compressed_size_offset, static_cast<uint32_t>(compressed_size));
+                            break;
+                        }
+                        case pbf_compression::zstd:
+#ifdef OSMIUM_WITH_ZSTD
+                            {
+                                append_field_key(output, protozero::pbf_tag_type(FileFormat::Blob::optional_int32_raw_size), 0u);
+                                append_varint(output, m_msg.size());
+                                append_field_key(output, protozero::pbf_tag_type(FileFormat::Blob::optional_bytes_zstd_data), 2u);
+                                const std::size_t compressed_size_offset = output.size();
+                                append_padded_varint(output, 0);
+                                const auto compressed_size = osmium::io::detail::zstd_compress_into(m_msg, output, output.size(),
+                                                                                                    m_compression_level != 0 ? m_compression_level : zstd_default_compression_level);
+                                patch_padded_varint(output, compressed_size_offset, static_cast<uint32_t>(compressed_size));
+                            }
+#else
+                            throw osmium::pbf_error{"zstd compression not supported, compile with OSMIUM_WITH_ZSTD"};
+#endif
+                            break;
+                    }
+
+                    // The static_cast is okay, because the blob can never
+                    // be much larger than max_uncompressed_blob_size. This
+                    // is due to the assert above and the fact that the
+                    // compressors will not grow the data beyond the original
+                    // size plus a few header bytes (https://zlib.net/zlib_tech.html).
+                    patch_padded_varint(output, datasize_offset, static_cast<uint32_t>(output.size() - blob_offset));
 
                     return output;
                 }
@@ -215,39 +413,85 @@ namespace osmium {
             }; // class SerializeBlob
 
             /**
-             * Contains the code to pack any number of nodes into a DenseNode
-             * structure.
-             *
-             * Because this needs to allocate a lot of memory on the heap,
-             * only one object of this class will be created and then re-used
-             * after calling clear() on it.
+             * Functor class doing the final serialization of a primitive
+             * block and then the work of SerializeBlob. Running this on
+             * the thread pool lets the delta encoding and serialization
+             * of one block overlap with the compression of the previous
+             * ones instead of everything but the compression happening
+             * on the single writer thread.
              */
-            class DenseNodes {
+            class SerializeDataBlob {
 
-                StringTable& m_stringtable;
+                /// Primitive block message with the string table already serialized.
+                std::string m_block_data;
 
-                std::vector<int64_t> m_ids;
+                std::string m_group_data;
 
-                std::vector<int32_t> m_versions;
-                std::vector<int64_t> m_timestamps;
-                std::vector<int64_t> m_changesets;
-                std::vector<int32_t> m_uids;
-                std::vector<int32_t> m_user_sids;
-                std::vector<bool> m_visibles;
+                dense_nodes_data m_dense_data;
 
-                std::vector<int64_t> m_lats;
-                std::vector<int64_t> m_lons;
-                std::vector<int32_t> m_tags;
+                bool m_has_dense_data = false;
 
-                osmium::DeltaEncode<object_id_type, int64_t> m_delta_id;
+                pbf_output_options m_options;
 
-                osmium::DeltaEncode<uint32_t, int64_t> m_delta_timestamp;
-                osmium::DeltaEncode<changeset_id_type, int64_t> m_delta_changeset;
-                osmium::DeltaEncode<user_id_type, int32_t> m_delta_uid;
-                osmium::DeltaEncode<int32_t, int32_t> m_delta_user_sid;
+                osmium::osm_entity_bits::type m_entity_types;
 
-                osmium::DeltaEncode<int64_t, int64_t> m_delta_lat;
-                osmium::DeltaEncode<int64_t, int64_t> m_delta_lon;
+            public:
+
+                /**
+                 * Initialize a serializer for a block with a completely
+                 * serialized primitive group (nodes, ways, relations, or
+                 * changesets).
+                 */
+                SerializeDataBlob(std::string&& block_data, std::string&& group_data, const pbf_output_options& options,
+                                  osmium::osm_entity_bits::type entity_types) :
+                    m_block_data(std::move(block_data)),
+                    m_group_data(std::move(group_data)),
+                    m_options(options),
+                    m_entity_types(entity_types) {
+                }
+
+                /**
+                 * Initialize a serializer for a DenseNodes block. The
+                 * DenseNodes message is built in operator()().
+                 */
+                SerializeDataBlob(std::string&& block_data, dense_nodes_data&& dense_data, const pbf_output_options& options) :
+                    m_block_data(std::move(block_data)),
+                    m_dense_data(std::move(dense_data)),
+                    m_has_dense_data(true),
+                    m_options(options),
+                    m_entity_types(osmium::osm_entity_bits::node) {
+                }
+
+                std::string operator()() {
+                    if (m_has_dense_data) {
+                        protozero::pbf_builder<OSMFormat::PrimitiveGroup> pbf_primitive_group{m_group_data};
+                        pbf_primitive_group.add_message(OSMFormat::PrimitiveGroup::optional_DenseNodes_dense,
+                                                        serialize_dense_nodes(std::move(m_dense_data), m_options));
+                    }
+
+                    protozero::pbf_builder<OSMFormat::PrimitiveBlock> primitive_block{m_block_data};
+                    primitive_block.add_message(OSMFormat::PrimitiveBlock::repeated_PrimitiveGroup_primitivegroup, m_group_data);
+
+                    return SerializeBlob{std::move(m_block_data),
+                                         pbf_blob_type::data,
+                                         m_options.use_compression,
+                                         m_options.compression_level,
+                                         m_entity_types}();
+                }
+
+            }; // class SerializeDataBlob
+
+            /**
+             * Contains the code to collect any number of nodes for a
+             * DenseNodes structure. The collected data is moved into a
+             * SerializeDataBlob task which does the delta encoding and
+             * serialization on the thread pool.
+             */
+            class DenseNodes {
+
+                StringTable& m_stringtable;
+
+                dense_nodes_data m_data;
 
                 const pbf_output_options& m_options;
 
@@ -258,102 +502,66 @@ namespace osmium {
                     m_options(options) {
                 }
 
-                /// Clear object for re-use. Keep the allocated memory.
+                /// Clear object for re-use.
                 void clear() {
-                    m_ids.clear();
-
-                    m_versions.clear();
-                    m_timestamps.clear();
-                    m_changesets.clear();
-                    m_uids.clear();
-                    m_user_sids.clear();
-                    m_visibles.clear();
-
-                    m_lats.clear();
-                    m_lons.clear();
-                    m_tags.clear();
-
-                    m_delta_id.clear();
-
-                    m_delta_timestamp.clear();
-                    m_delta_changeset.clear();
-                    m_delta_uid.clear();
-                    m_delta_user_sid.clear();
-
-                    m_delta_lat.clear();
-                    m_delta_lon.clear();
+                    m_data.ids.clear();
+
+                    m_data.versions.clear();
+                    m_data.timestamps.clear();
+                    m_data.changesets.clear();
+                    m_data.uids.clear();
+                    m_data.user_sids.clear();
+                    m_data.visibles.clear();
+
+                    m_data.lats.clear();
+                    m_data.lons.clear();
+                    m_data.tags.clear();
                 }
 
                 std::size_t size() const noexcept {
-                    return m_ids.size() * 3 * sizeof(int64_t);
+                    return m_data.ids.size() * 3 * sizeof(int64_t);
                 }
 
                 void add_node(const osmium::Node& node) {
-                    m_ids.push_back(m_delta_id.update(node.id()));
+                    m_data.ids.push_back(node.id());
 
                     if (m_options.add_metadata.version()) {
                         assert(node.version() <= static_cast<std::size_t>(std::numeric_limits<int32_t>::max()));
-                        m_versions.push_back(static_cast<int32_t>(node.version()));
+                        m_data.versions.push_back(static_cast<int32_t>(node.version()));
                     }
                     if (m_options.add_metadata.timestamp()) {
-                        m_timestamps.push_back(m_delta_timestamp.update(uint32_t(node.timestamp())));
+                        m_data.timestamps.push_back(uint32_t(node.timestamp()));
                     }
                     if (m_options.add_metadata.changeset()) {
-                        m_changesets.push_back(m_delta_changeset.update(node.changeset()));
+                        m_data.changesets.push_back(int64_t(node.changeset()));
                     }
                     if (m_options.add_metadata.uid()) {
-                        m_uids.push_back(m_delta_uid.update(node.uid()));
+                        m_data.uids.push_back(static_cast<int32_t>(node.uid()));
                     }
                     if (m_options.add_metadata.user()) {
-                        m_user_sids.push_back(m_delta_user_sid.update(m_stringtable.add(node.user())));
+                        m_data.user_sids.push_back(m_stringtable.add(node.user()));
                     }
                     if (m_options.add_visible_flag) {
-                        m_visibles.push_back(node.visible());
+                        m_data.visibles.push_back(node.visible());
                     }
 
-                    m_lats.push_back(m_delta_lat.update(lonlat2int(node.location().lat_without_check())));
-                    m_lons.push_back(m_delta_lon.update(lonlat2int(node.location().lon_without_check())));
+                    m_data.lats.push_back(lonlat2int(node.location().lat_without_check()));
+                    m_data.lons.push_back(lonlat2int(node.location().lon_without_check()));
 
                     for (const auto& tag : node.tags()) {
-                        m_tags.push_back(m_stringtable.add(tag.key()));
-                        m_tags.push_back(m_stringtable.add(tag.value()));
+                        m_data.tags.push_back(m_stringtable.add(tag.key()));
+                        m_data.tags.push_back(m_stringtable.add(tag.value()));
                     }
-                    m_tags.push_back(0);
+                    m_data.tags.push_back(0);
                 }
 
-                std::string serialize() const {
-                    std::string data;
-                    protozero::pbf_builder<OSMFormat::DenseNodes> pbf_dense_nodes{data};
-
-                    pbf_dense_nodes.add_packed_sint64(OSMFormat::DenseNodes::packed_sint64_id, m_ids.cbegin(), m_ids.cend());
-
-                    if (m_options.add_metadata.any() || m_options.add_visible_flag) {
-                        protozero::pbf_builder<OSMFormat::DenseInfo> pbf_dense_info{pbf_dense_nodes, OSMFormat::DenseNodes::optional_DenseInfo_denseinfo};
-                        if (m_options.add_metadata.version()) {
-                            pbf_dense_info.add_packed_int32(OSMFormat::DenseInfo::packed_int32_version, m_versions.cbegin(), m_versions.cend());
-                        }
-                        if (m_options.add_metadata.timestamp()) {
-                            pbf_dense_info.add_packed_sint64(OSMFormat::DenseInfo::packed_sint64_timestamp, m_timestamps.cbegin(), m_timestamps.cend());
-                        }
-                        if (m_options.add_metadata.changeset()) {
-                            pbf_dense_info.add_packed_sint64(OSMFormat::DenseInfo::packed_sint64_changeset, m_changesets.cbegin(), m_changesets.cend());
-                        }
-                        if (m_options.add_metadata.uid()) {
-                            pbf_dense_info.add_packed_sint32(OSMFormat::DenseInfo::packed_sint32_uid, m_uids.cbegin(), m_uids.cend());
-                        }
-                        if (m_options.add_metadata.user()) {
-                            pbf_dense_info.add_packed_sint32(OSMFormat::DenseInfo::packed_sint32_user_sid, m_user_sids.cbegin(), m_user_sids.cend());
-                        }
-                        if (m_options.add_visible_flag) {
-                            pbf_dense_info.add_packed_bool(OSMFormat::DenseInfo::packed_bool_visible, m_visibles.cbegin(), m_visibles.cend());
-                        }
-                    }
-
-                    pbf_dense_nodes.add_packed_sint64(OSMFormat::DenseNodes::packed_sint64_lat, m_lats.cbegin(), m_lats.cend());
-                    pbf_dense_nodes.add_packed_sint64(OSMFormat::DenseNodes::packed_sint64_lon, m_lons.cbegin(), m_lons.cend());
-
-                    pbf_dense_nodes.add_packed_int32(OSMFormat::DenseNodes::packed_int32_keys_vals, m_tags.cbegin(), m_tags.cend());
-
+                /**
+                 * Move the collected data out for serialization on the
+                 * thread pool. Leaves this object in the cleared state.
+                 */
+                dense_nodes_data take_data() {
+                    dense_nodes_data data{std::move(m_data)};
+                    m_data = dense_nodes_data{};
                     return data;
                 }
 
@@ -375,11 +583,22 @@ namespace osmium {
                     m_dense_nodes(m_stringtable, options) {
                 }
 
-                const std::string& group_data() {
-                    if (type() == OSMFormat::PrimitiveGroup::optional_DenseNodes_dense) {
-                        m_pbf_primitive_group.add_message(OSMFormat::PrimitiveGroup::optional_DenseNodes_dense, m_dense_nodes.serialize());
-                    }
-                    return m_pbf_primitive_group_data;
+                bool has_dense_nodes() const noexcept {
+                    return type() == OSMFormat::PrimitiveGroup::optional_DenseNodes_dense;
+                }
+
+                /// Only call this when has_dense_nodes() is true.
+                dense_nodes_data take_dense_nodes_data() {
+                    return m_dense_nodes.take_data();
+                }
+
+                /**
+                 * Move the serialized group data out for use in the
+                 * serialization task. The next reset() makes this object
+                 * usable again.
+                 */
+                std::string take_group_data() {
+                    return std::move(m_pbf_primitive_group_data);
                 }
 
                 void reset(OSMFormat::PrimitiveGroup type) {
@@ -454,47 +673,39 @@ namespace osmium {
 
             }; // class PrimitiveBlock
 
-            class PBFOutputFormat : public osmium::io::detail::OutputFormat, public osmium::handler::Handler {
-
-                pbf_output_options m_options;
+            /**
+             * Functor class encoding one whole primitive block: it builds
+             * the string table, encodes all objects and then hands over
+             * to SerializeDataBlob for the delta encoding, serialization,
+             * and compression. PBF primitive blocks are self-contained,
+             * so any number of these tasks can run on the thread pool
+             * concurrently while the write thread pops the results from
+             * the queue in submission order. The buffers holding the
+             * objects are kept alive through shared ownership.
+             */
+            class EncodeDataBlock {
 
-                PrimitiveBlock m_primitive_block;
+                std::vector<std::shared_ptr<osmium::memory::Buffer>> m_buffers;
 
-                void store_primitive_block() {
-                    if (m_primitive_block.count() == 0) {
-                        return;
-                    }
+                std::vector<const osmium::OSMObject*> m_objects;
 
-                    std::string primitive_block_data;
-                    protozero::pbf_builder<OSMFormat::PrimitiveBlock> primitive_block{primitive_block_data};
-
-                    {
-                        protozero::pbf_builder<OSMFormat::StringTable> pbf_string_table{primitive_block, OSMFormat::PrimitiveBlock::required_StringTable_stringtable};
-                        m_primitive_block.write_stringtable(pbf_string_table);
-                    }
-
-                    primitive_block.add_message(OSMFormat::PrimitiveBlock::repeated_PrimitiveGroup_primitivegroup, m_primitive_block.group_data());
+                pbf_output_options m_options;
 
-                    m_output_queue.push(m_pool.submit(
-                        SerializeBlob{std::move(primitive_block_data),
-                                      pbf_blob_type::data,
-                                      m_options.use_compression}
-                    ));
-                }
+                OSMFormat::PrimitiveGroup m_type;
 
                 template <typename T>
-                void add_meta(const osmium::OSMObject& object, T& pbf_object) {
+                void add_meta(PrimitiveBlock& block, const osmium::OSMObject& object, T& pbf_object) {
                     {
                         protozero::packed_field_uint32 field{pbf_object, protozero::pbf_tag_type(T::enum_type::packed_uint32_keys)};
                         for (const auto& tag : object.tags()) {
-                            field.add_element(m_primitive_block.store_in_stringtable_unsigned(tag.key()));
+                            field.add_element(block.store_in_stringtable_unsigned(tag.key()));
                         }
                     }
 
                     {
                         protozero::packed_field_uint32 field{pbf_object, protozero::pbf_tag_type(T::enum_type::packed_uint32_vals)};
                         for (const auto& tag : object.tags()) {
-                            field.add_element(m_primitive_block.store_in_stringtable_unsigned(tag.value()));
+                            field.add_element(block.store_in_stringtable_unsigned(tag.value()));
                         }
                     }
 
@@ -516,7 +727,7 @@ namespace osmium {
                             pbf_info.add_int32(OSMFormat::Info::optional_int32_uid, static_cast<int32_t>(object.uid()));
                         }
                         if (m_options.add_metadata.user()) {
-                            pbf_info.add_uint32(OSMFormat::Info::optional_uint32_user_sid, m_primitive_block.store_in_stringtable_unsigned(object.user()));
+                            pbf_info.add_uint32(OSMFormat::Info::optional_uint32_user_sid, block.store_in_stringtable_unsigned(object.user()));
                         }
                         if (m_options.add_visible_flag) {
                             pbf_info.add_bool(OSMFormat::Info::optional_bool_visible, object.visible());
@@ -524,25 +735,248 @@ namespace osmium {
                     }
                 }
 
-                void switch_primitive_block_type(OSMFormat::PrimitiveGroup type) {
-                    if (!m_primitive_block.can_add(type)) {
-                        store_primitive_block();
-                        m_primitive_block.reset(type);
+                void encode_node(PrimitiveBlock& block, const osmium::Node& node) {
+                    if (m_options.use_dense_nodes) {
+                        block.add_dense_node(node);
+                        return;
+                    }
+
+                    protozero::pbf_builder<OSMFormat::Node> pbf_node{block.group(), OSMFormat::PrimitiveGroup::repeated_Node_nodes};
+
+                    pbf_node.add_sint64(OSMFormat::Node::required_sint64_id, node.id());
+                    add_meta(block, node, pbf_node);
+
+                    pbf_node.add_sint64(OSMFormat::Node::required_sint64_lat, lonlat2int(node.location().lat_without_check()));
+                    pbf_node.add_sint64(OSMFormat::Node::required_sint64_lon, lonlat2int(node.location().lon_without_check()));
+                }
+
+                void encode_way(PrimitiveBlock& block, const osmium::Way& way) {
+                    protozero::pbf_builder<OSMFormat::Way> pbf_way{block.group(), OSMFormat::PrimitiveGroup::repeated_Way_ways};
+
+                    pbf_way.add_int64(OSMFormat::Way::required_int64_id, way.id());
+                    add_meta(block, way, pbf_way);
+
+                    {
+                        osmium::DeltaEncode<object_id_type, int64_t> delta_id;
+                        protozero::packed_field_sint64 field{pbf_way, protozero::pbf_tag_type(OSMFormat::Way::packed_sint64_refs)};
+                        for (const auto& node_ref : way.nodes()) {
+                            field.add_element(delta_id.update(node_ref.ref()));
+                        }
+                    }
+
+                    if (m_options.locations_on_ways) {
+                        {
+                            osmium::DeltaEncode<int64_t, int64_t> delta_id;
+                            protozero::packed_field_sint64 field{pbf_way, protozero::pbf_tag_type(OSMFormat::Way::packed_sint64_lon)};
+                            for (const auto& node_ref : way.nodes()) {
+                                field.add_element(delta_id.update(lonlat2int(node_ref.location().lon_without_check())));
+                            }
+                        }
+                        {
+                            osmium::DeltaEncode<int64_t, int64_t> delta_id;
+                            protozero::packed_field_sint64 field{pbf_way, protozero::pbf_tag_type(OSMFormat::Way::packed_sint64_lat)};
+                            for (const auto& node_ref : way.nodes()) {
+                                field.add_element(delta_id.update(lonlat2int(node_ref.location().lat_without_check())));
+                            }
+                        }
+                    }
+                }
+
+                void encode_relation(PrimitiveBlock& block, const osmium::Relation& relation) {
+                    protozero::pbf_builder<OSMFormat::Relation> pbf_relation{block.group(), OSMFormat::PrimitiveGroup::repeated_Relation_relations};
+
+                    pbf_relation.add_int64(OSMFormat::Relation::required_int64_id, relation.id());
+                    add_meta(block, relation, pbf_relation);
+
+                    {
+                        protozero::packed_field_int32 field{pbf_relation, protozero::pbf_tag_type(OSMFormat::Relation::packed_int32_roles_sid)};
+                        for (const auto& member : relation.members()) {
+                            field.add_element(block.store_in_stringtable(member.role()));
+                        }
+                    }
+
+                    {
+                        osmium::DeltaEncode<object_id_type, int64_t> delta_id;
+                        protozero::packed_field_sint64 field{pbf_relation, protozero::pbf_tag_type(OSMFormat::Relation::packed_sint64_memids)};
+                        for (const auto& member : relation.members()) {
+                            field.add_element(delta_id.update(member.ref()));
+                        }
+                    }
+
+                    {
+                        protozero::packed_field_int32 field{pbf_relation, protozero::pbf_tag_type(OSMFormat::Relation::packed_MemberType_types)};
+                        for (const auto& member : relation.members()) {
+                            field.add_element(int32_t(osmium::item_type_to_nwr_index(member.type())));
+                        }
                     }
                 }
 
+            public:
+
+                EncodeDataBlock(std::vector<std::shared_ptr<osmium::memory::Buffer>>&& buffers,
+                                std::vector<const osmium::OSMObject*>&& objects,
+                                OSMFormat::PrimitiveGroup type,
+                                const pbf_output_options& options) :
+                    m_buffers(std::move(buffers)),
+                    m_objects(std::move(objects)),
+                    m_options(options),
+                    m_type(type) {
+                }
+
+                std::string operator()() {
+                    OSMIUM_PROBE1(pbf_block_encode, m_objects.size());
+                    PrimitiveBlock block{m_options};
+                    block.reset(m_type);
+
+                    for (const osmium::OSMObject* object : m_objects) {
+                        switch (object->type()) {
+                            case osmium::item_type::node:
+                                encode_node(block, static_cast<const osmium::Node&>(*object));
+                                break;
+                            case osmium::item_type::way:
+                                encode_way(block, static_cast<const osmium::Way&>(*object));
+                                break;
+                            case osmium::item_type::relation:
+                                encode_relation(block, static_cast<const osmium::Relation&>(*object));
+                                break;
+                            default:
+                                break;
+                        }
+                    }
+
+                    std::string primitive_block_data;
+                    protozero::pbf_builder<OSMFormat::PrimitiveBlock> primitive_block{primitive_block_data};
+
+                    {
+                        protozero::pbf_builder<OSMFormat::StringTable> pbf_string_table{primitive_block, OSMFormat::PrimitiveBlock::required_StringTable_stringtable};
+                        block.write_stringtable(pbf_string_table);
+                    }
+
+                    if (block.has_dense_nodes()) {
+                        return SerializeDataBlob{std::move(primitive_block_data),
+                                                 block.take_dense_nodes_data(),
+                                                 m_options}();
+                    }
+                    return SerializeDataBlob{std::move(primitive_block_data),
+                                             block.take_group_data(),
+                                             m_options,
+                                             entity_types()}();
+                }
+
+            private:
+
+                /// The entity type bits matching the primitive group type of this block.
+                osmium::osm_entity_bits::type entity_types() const noexcept {
+                    switch (m_type) {
+                        case OSMFormat::PrimitiveGroup::optional_DenseNodes_dense:
+                        case OSMFormat::PrimitiveGroup::repeated_Node_nodes:
+                            return osmium::osm_entity_bits::node;
+                        case OSMFormat::PrimitiveGroup::repeated_Way_ways:
+                            return osmium::osm_entity_bits::way;
+                        case OSMFormat::PrimitiveGroup::repeated_Relation_relations:
+                            return osmium::osm_entity_bits::relation;
+                        default:
+                            return osmium::osm_entity_bits::nothing;
+                    }
+                }
+
+            }; // class EncodeDataBlock
+
+            class PBFOutputFormat : public osmium::io::detail::OutputFormat {
+
+                pbf_output_options m_options;
+
+                // The block currently being planned: pointers to the
+                // objects that will go into it and shared ownership of
+                // the buffers they live in. Encoding happens in an
+                // EncodeDataBlock task on the thread pool.
+                std::vector<std::shared_ptr<osmium::memory::Buffer>> m_block_buffers;
+                std::vector<const osmium::OSMObject*> m_block_objects;
+                OSMFormat::PrimitiveGroup m_block_type = OSMFormat::PrimitiveGroup::unknown;
+                std::size_t m_block_estimated_size = 0;
+
+                void flush_block() {
+                    if (m_block_objects.empty()) {
+                        return;
+                    }
+
+                    m_output_queue.push(m_pool.submit(
+                        osmium::thread::Pool::priority::high,
+                        EncodeDataBlock{std::move(m_block_buffers),
+                                        std::move(m_block_objects),
+                                        m_block_type,
+                                        m_options}
+                    ));
+
+                    m_block_buffers.clear();
+                    m_block_objects.clear();
+                    m_block_estimated_size = 0;
+                }
+
+                OSMFormat::PrimitiveGroup group_type(const osmium::OSMObject& object) const noexcept {
+                    switch (object.type()) {
+                        case osmium::item_type::node:
+                            return m_options.use_dense_nodes ? OSMFormat::PrimitiveGroup::optional_DenseNodes_dense
+                                                             : OSMFormat::PrimitiveGroup::repeated_Node_nodes;
+                        case osmium::item_type::way:
+                            return OSMFormat::PrimitiveGroup::repeated_Way_ways;
+                        case osmium::item_type::relation:
+                            return OSMFormat::PrimitiveGroup::repeated_Relation_relations;
+                        default:
+                            return OSMFormat::PrimitiveGroup::unknown;
+                    }
+                }
+
+                void add_to_block(const osmium::OSMObject& object, const std::shared_ptr<osmium::memory::Buffer>& buffer) {
+                    const auto type = group_type(object);
+
+                    // The in-memory size of the objects is an upper bound
+                    // for the size of the encoded block, so blocks planned
+                    // this way always stay below the blob size limit.
+                    if (type != m_block_type ||
+                        m_block_objects.size() >= max_entities_per_block ||
+                        m_block_estimated_size >= PrimitiveBlock::max_used_blob_size) {
+                        flush_block();
+                        m_block_type = type;
+                    }
+
+                    if (m_block_buffers.empty() || m_block_buffers.back() != buffer) {
+                        m_block_buffers.push_back(buffer);
+                    }
+                    m_block_objects.push_back(&object);
+                    m_block_estimated_size += object.byte_size();
+                }
+
             public:
 
                 PBFOutputFormat(osmium::thread::Pool& pool, const osmium::io::File& file, future_string_queue_type& output_queue) :
-                    OutputFormat(pool, output_queue),
-                    m_primitive_block(m_options) {
+                    OutputFormat(pool, output_queue) {
 
                     if (!file.get("pbf_add_metadata").empty()) {
                         throw std::invalid_argument{"The 'pbf_add_metadata' option is deprecated. Please use 'add_metadata' instead."};
                     }
 
                     m_options.use_dense_nodes = file.is_not_false("pbf_dense_nodes");
-                    m_options.use_compression = file.get("pbf_compression") != "none" && file.is_not_false("pbf_compression");
+
+                    const std::string compression{file.get("pbf_compression")};
+                    if (compression == "none" || compression == "false") {
+                        m_options.use_compression = pbf_compression::none;
+                    } else if (compression == "zstd") {
+#ifdef OSMIUM_WITH_ZSTD
+                        m_options.use_compression = pbf_compression::zstd;
+#else
+                        throw std::invalid_argument{"The 'pbf_compression=zstd' option is only available when compiled with OSMIUM_WITH_ZSTD."};
+#endif
+                    } else if (compression.empty() || compression == "zlib" || compression == "true") {
+                        m_options.use_compression = pbf_compression::zlib;
+                    } else {
+                        throw std::invalid_argument{std::string{"Unknown value for 'pbf_compression' option: "} + compression};
+                    }
+
+                    const std::string compression_level{file.get("pbf_compression_level")};
+                    if (!compression_level.empty()) {
+                        m_options.compression_level = osmium::detail::str_to_int<int>(compression_level.c_str());
+                    }
                     m_options.add_metadata = osmium::metadata_options{file.get("add_metadata")};
                     m_options.add_historical_information_flag = file.has_multiple_object_versions();
                     m_options.add_visible_flag = file.has_multiple_object_versions();
@@ -596,98 +1030,31 @@ namespace osmium {
                     }
 
                     m_output_queue.push(m_pool.submit(
+                        osmium::thread::Pool::priority::high,
                         SerializeBlob{std::move(data),
                                       pbf_blob_type::header,
-                                      m_options.use_compression}
+                                      m_options.use_compression,
+                                      m_options.compression_level}
                         ));
                 }
 
                 void write_buffer(osmium::memory::Buffer&& buffer) final {
-                    osmium::apply(buffer.cbegin(), buffer.cend(), *this);
-                }
-
-                void write_end() final {
-                    store_primitive_block();
-                }
-
-                void node(const osmium::Node& node) {
-                    if (m_options.use_dense_nodes) {
-                        switch_primitive_block_type(OSMFormat::PrimitiveGroup::optional_DenseNodes_dense);
-                        m_primitive_block.add_dense_node(node);
-                        return;
+                    const auto buffer_ptr = std::make_shared<osmium::memory::Buffer>(std::move(buffer));
+                    for (const auto& object : buffer_ptr->select<osmium::OSMObject>()) {
+                        add_to_block(object, buffer_ptr);
                     }
-
-                    switch_primitive_block_type(OSMFormat::PrimitiveGroup::repeated_Node_nodes);
-                    protozero::pbf_builder<OSMFormat::Node> pbf_node{m_primitive_block.group(), OSMFormat::PrimitiveGroup::repeated_Node_nodes};
-
-                    pbf_node.add_sint64(OSMFormat::Node::required_sint64_id, node.id());
-                    add_meta(node, pbf_node);
-
-                    pbf_node.add_sint64(OSMFormat::Node::required_sint64_lat, lonlat2int(node.location().lat_without_check()));
-                    pbf_node.add_sint64(OSMFormat::Node::required_sint64_lon, lonlat2int(node.location().lon_without_check()));
                 }
 
-                void way(const osmium::Way& way) {
-                    switch_primitive_block_type(OSMFormat::PrimitiveGroup::repeated_Way_ways);
-                    protozero::pbf_builder<OSMFormat::Way> pbf_way{m_primitive_block.group(), OSMFormat::PrimitiveGroup::repeated_Way_ways};
-
-                    pbf_way.add_int64(OSMFormat::Way::required_int64_id, way.id());
-                    add_meta(way, pbf_way);
-
-                    {
-                        osmium::DeltaEncode<object_id_type, int64_t> delta_id;
-                        protozero::packed_field_sint64 field{pbf_way, protozero::pbf_tag_type(OSMFormat::Way::packed_sint64_refs)};
-                        for (const auto& node_ref : way.nodes()) {
-                            field.add_element(delta_id.update(node_ref.ref()));
-                        }
-                    }
-
-                    if (m_options.locations_on_ways) {
-                        {
-                            osmium::DeltaEncode<int64_t, int64_t> delta_id;
-                            protozero::packed_field_sint64 field{pbf_way, protozero::pbf_tag_type(OSMFormat::Way::packed_sint64_lon)};
-                            for (const auto& node_ref : way.nodes()) {
-                                field.add_element(delta_id.update(lonlat2int(node_ref.location().lon_without_check())));
-                            }
-                        }
-                        {
-                            osmium::DeltaEncode<int64_t, int64_t> delta_id;
-                            protozero::packed_field_sint64 field{pbf_way, protozero::pbf_tag_type(OSMFormat::Way::packed_sint64_lat)};
-                            for (const auto& node_ref : way.nodes()) {
-                                field.add_element(delta_id.update(lonlat2int(node_ref.location().lat_without_check())));
-                            }
-                        }
-                    }
+                void write_raw_blob(std::string&& data) final {
+                    // Flush the block under construction first so the
+                    // raw blob ends up in the file after all objects
+                    // written before it.
+                    flush_block();
+                    send_to_output_queue(std::move(data));
                 }
 
-                void relation(const osmium::Relation& relation) {
-                    switch_primitive_block_type(OSMFormat::PrimitiveGroup::repeated_Relation_relations);
-                    protozero::pbf_builder<OSMFormat::Relation> pbf_relation{m_primitive_block.group(), OSMFormat::PrimitiveGroup::repeated_Relation_relations};
-
-                    pbf_relation.add_int64(OSMFormat::Relation::required_int64_id, relation.id());
-                    add_meta(relation, pbf_relation);
-
-                    {
-                        protozero::packed_field_int32 field{pbf_relation, protozero::pbf_tag_type(OSMFormat::Relation::packed_int32_roles_sid)};
-                        for (const auto& member : relation.members()) {
-                            field.add_element(m_primitive_block.store_in_stringtable(member.role()));
-                        }
-                    }
-
-                    {
-                        osmium::DeltaEncode<object_id_type, int64_t> delta_id;
-                        protozero::packed_field_sint64 field{pbf_relation, protozero::pbf_tag_type(OSMFormat::Relation::packed_sint64_memids)};
-                        for (const auto& member : relation.members()) {
-                            field.add_element(delta_id.update(member.ref()));
-                        }
-                    }
-
-                    {
-                        protozero::packed_field_int32 field{pbf_relation, protozero::pbf_tag_type(OSMFormat::Relation::packed_MemberType_types)};
-                        for (const auto& member : relation.members()) {
-                            field.add_element(int32_t(osmium::item_type_to_nwr_index(member.type())));
-                        }
-                    }
+                void write_end() final {
+                    flush_block();
                 }
 
             }; // class PBFOutputFormat
@@ -50,7 +50,9 @@ namespace osmium {
                     optional_bytes_raw       = 1,
                     optional_int32_raw_size  = 2,
                     optional_bytes_zlib_data = 3,
-                    optional_bytes_lzma_data = 4
+                    optional_bytes_lzma_data = 4,
+                    optional_bytes_lz4_data  = 6,
+                    optional_bytes_zstd_data = 7
                 };
 
                 enum class BlobHeader : protozero::pbf_tag_type {
@@ -34,11 +34,18 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/memory/buffer.hpp>
-#include <osmium/thread/queue.hpp>
+
+#ifdef OSMIUM_USE_RING_QUEUE
+# include <osmium/thread/ring_queue.hpp>
+#else
+# include <osmium/thread/queue.hpp>
+#endif
 
 #include <cassert>
+#include <cstddef>
 #include <exception>
 #include <future>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -48,9 +55,21 @@ namespace osmium {
 
         namespace detail {
 
+            // Define OSMIUM_USE_RING_QUEUE to feed the io pipeline
+            // through the lock-free osmium::thread::RingQueue instead
+            // of the mutex-based osmium::thread::Queue.
+#ifdef OSMIUM_USE_RING_QUEUE
+            template <typename T>
+            using future_queue_type = osmium::thread::RingQueue<std::future<T>>;
+
+            using string_queue_type = osmium::thread::RingQueue<std::string>;
+#else
             template <typename T>
             using future_queue_type = osmium::thread::Queue<std::future<T>>;
 
+            using string_queue_type = osmium::thread::Queue<std::string>;
+#endif
+
             /**
              * This type of queue contains buffers with OSM data in them.
              * The "end of file" is marked by an invalid Buffer.
@@ -97,6 +116,143 @@ namespace osmium {
                 return !buffer;
             }
 
+            /**
+             * The queue of raw file data on its way from the read
+             * thread to the parser. The data flows as plain strings,
+             * an exception from the read thread is handed over through
+             * a side channel and re-thrown when the consumer reaches
+             * the end of the data.
+             *
+             * This hop is strictly in-order, so it doesn't need the
+             * promise/future pair and its heap-allocated shared state
+             * per chunk that the more general future_queue_type has to
+             * pay for out-of-order results.
+             * The "end of file" is marked by an empty string.
+             */
+            class raw_data_queue {
+
+                string_queue_type m_queue;
+
+                std::mutex m_mutex;
+                std::exception_ptr m_exception{};
+
+            public:
+
+                explicit raw_data_queue(std::size_t max_size, const std::string& name) :
+                    m_queue(max_size, name) {
+                }
+
+                void push(std::string data) {
+                    assert(!data.empty());
+                    m_queue.push(std::move(data));
+                }
+
+                /**
+                 * Hand over an exception from the producer. This also
+                 * marks the end of the data, because nothing the
+                 * producer could push after it would ever be seen by
+                 * the consumer.
+                 */
+                void push_exception(std::exception_ptr&& exception) {
+                    {
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        m_exception = std::move(exception);
+                    }
+                    push_end_of_data();
+                }
+
+                void push_end_of_data() {
+                    m_queue.push(std::string{});
+                }
+
+                /**
+                 * Get the next chunk of data, blocking until there is
+                 * one. An empty string marks the end of the data. If
+                 * the producer handed over an exception, it is
+                 * re-thrown here instead.
+                 */
+                std::string pop() {
+                    std::string data;
+                    m_queue.wait_and_pop(data);
+                    if (at_end_of_data(data)) {
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        if (m_exception) {
+                            std::exception_ptr exception{};
+                            using std::swap;
+                            swap(exception, m_exception);
+                            std::rethrow_exception(exception);
+                        }
+                    }
+                    return data;
+                }
+
+                /// See osmium::thread::Queue::set_adaptive_size().
+                void set_adaptive_size(const std::size_t min_size, const std::size_t max_size) {
+                    m_queue.set_adaptive_size(min_size, max_size);
+                }
+
+                osmium::thread::queue_counters counters() const {
+                    return m_queue.counters();
+                }
+
+            }; // class raw_data_queue
+
+            /**
+             * Consumer-side wrapper around a raw_data_queue keeping
+             * track of whether the end of the data has been reached,
+             * draining the queue on destruction so a blocked producer
+             * can finish. The counterpart of queue_wrapper for queues
+             * that don't transport futures.
+             */
+            class raw_data_queue_wrapper {
+
+                raw_data_queue& m_queue;
+                bool m_has_reached_end_of_data;
+
+            public:
+
+                explicit raw_data_queue_wrapper(raw_data_queue& queue) :
+                    m_queue(queue),
+                    m_has_reached_end_of_data(false) {
+                }
+
+                raw_data_queue_wrapper(const raw_data_queue_wrapper&) = delete;
+                raw_data_queue_wrapper& operator=(const raw_data_queue_wrapper&) = delete;
+
+                raw_data_queue_wrapper(raw_data_queue_wrapper&&) = delete;
+                raw_data_queue_wrapper& operator=(raw_data_queue_wrapper&&) = delete;
+
+                ~raw_data_queue_wrapper() noexcept {
+                    drain();
+                }
+
+                void drain() {
+                    while (!m_has_reached_end_of_data) {
+                        try {
+                            pop();
+                        } catch (...) {
+                            // Ignore any exceptions.
+                        }
+                    }
+                }
+
+                bool has_reached_end_of_data() const noexcept {
+                    return m_has_reached_end_of_data;
+                }
+
+                std::string pop() {
+                    std::string data;
+                    if (!m_has_reached_end_of_data) {
+                        data = m_queue.pop();
+                        if (at_end_of_data(data)) {
+                            m_has_reached_end_of_data = true;
+                        }
+                    }
+                    return data;
+                }
+
+            }; // class raw_data_queue_wrapper
+
             template <typename T>
             class queue_wrapper {
 
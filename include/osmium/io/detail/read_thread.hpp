@@ -59,7 +59,7 @@ namespace osmium {
 
                 // only used in the sub-thread
                 osmium::io::Decompressor& m_decompressor;
-                future_string_queue_type& m_queue;
+                raw_data_queue& m_queue;
 
                 // used in both threads
                 std::atomic<bool> m_done;
@@ -76,21 +76,21 @@ namespace osmium {
                             if (at_end_of_data(data)) {
                                 break;
                             }
-                            add_to_queue(m_queue, std::move(data));
+                            m_queue.push(std::move(data));
                         }
 
                         m_decompressor.close();
                     } catch (...) {
-                        add_to_queue(m_queue, std::current_exception());
+                        m_queue.push_exception(std::current_exception());
                     }
 
-                    add_end_of_data_to_queue(m_queue);
+                    m_queue.push_end_of_data();
                 }
 
             public:
 
                 ReadThreadManager(osmium::io::Decompressor& decompressor,
-                                  future_string_queue_type& queue) :
+                                  raw_data_queue& queue) :
                     m_decompressor(decompressor),
                     m_queue(queue),
                     m_done(false),
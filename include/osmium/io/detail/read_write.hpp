@@ -38,7 +38,9 @@ DEALINGS IN THE SOFTWARE.
 
 #include <cerrno>
 #include <cstddef>
+#include <cstdlib>
 #include <fcntl.h>
+#include <stdexcept>
 #include <string>
 #include <system_error>
 
@@ -114,9 +116,112 @@ namespace osmium {
                 if (fd < 0) {
                     throw std::system_error{errno, std::system_category(), std::string("Open failed for '") + filename + "'"};
                 }
+#ifdef POSIX_FADV_SEQUENTIAL
+                // Files are read front to back, tell the kernel so it can
+                // use a larger readahead window. Ignore errors, this is
+                // only a hint.
+                ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
                 return fd;
             }
 
+            /**
+             * Ask the kernel to start reading the given range of the file
+             * into the page cache in the background. This keeps the disk
+             * busy while already-read data is being decompressed and
+             * decoded, which matters on high-latency storage. Only a
+             * hint, does nothing on systems without posix_fadvise().
+             *
+             * @param fd File descriptor.
+             * @param offset Offset of the range in the file.
+             * @param length Length of the range.
+             */
+            inline void prefetch_hint(const int fd, const std::size_t offset, const std::size_t length) noexcept {
+#ifdef POSIX_FADV_WILLNEED
+                ::posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+#else
+                (void)fd;
+                (void)offset;
+                (void)length;
+#endif
+            }
+
+            /**
+             * Ask the kernel to drop the given range of the file from the
+             * page cache. Use this after reading data that will never be
+             * needed again, so a one-shot bulk read doesn't evict more
+             * useful data of other processes from the cache. Only a
+             * hint, does nothing on systems without posix_fadvise().
+             *
+             * @param fd File descriptor.
+             * @param offset Offset of the range in the file.
+             * @param length Length of the range.
+             */
+            inline void evict_hint(const int fd, const std::size_t offset, const std::size_t length) noexcept {
+#ifdef POSIX_FADV_DONTNEED
+                ::posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_DONTNEED);
+#else
+                (void)fd;
+                (void)offset;
+                (void)length;
+#endif
+            }
+
+            enum : std::size_t {
+                // Alignment for buffers, read sizes, and file offsets
+                // when reading with direct io. The logical block size of
+                // the device would be enough, but there is no portable
+                // way to get it and a memory page always satisfies it.
+                direct_io_alignment = 4096u
+            };
+
+            /**
+             * Try to switch the given open file descriptor to direct io,
+             * bypassing the page cache completely. Only works for regular
+             * files and only on systems that have the O_DIRECT flag. The
+             * caller has to do all further reads with buffers, sizes, and
+             * file offsets aligned to direct_io_alignment.
+             *
+             * @param fd File descriptor.
+             * @returns Was direct io enabled?
+             */
+            inline bool set_direct_io(const int fd) noexcept {
+#if defined(O_DIRECT) && !defined(_WIN32)
+                struct stat file_stat{};
+                if (::fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) { // NOLINT(hicpp-signed-bitwise)
+                    return false;
+                }
+                const int flags = ::fcntl(fd, F_GETFL); // NOLINT(hicpp-signed-bitwise,hicpp-vararg)
+                if (flags == -1) {
+                    return false;
+                }
+                return ::fcntl(fd, F_SETFL, flags | O_DIRECT) == 0; // NOLINT(hicpp-signed-bitwise,hicpp-vararg)
+#else
+                (void)fd;
+                return false;
+#endif
+            }
+
+            /**
+             * Allocate a buffer of the given size aligned to
+             * direct_io_alignment for use with direct io. The buffer must
+             * be released with free(). Returns nullptr if the memory
+             * could not be allocated or the system has no aligned
+             * allocation function.
+             */
+            inline char* allocate_aligned_buffer(const std::size_t size) noexcept {
+#ifdef _WIN32
+                (void)size;
+                return nullptr;
+#else
+                void* ptr = nullptr;
+                if (::posix_memalign(&ptr, direct_io_alignment, size) != 0) {
+                    return nullptr;
+                }
+                return static_cast<char*>(ptr);
+#endif
+            }
+
             /**
              * Writes the given number of bytes from the output_buffer to the file descriptor.
              * This is just a wrapper around write(2), because write(2) can write less than
@@ -200,6 +305,26 @@ namespace osmium {
                 return nread;
             }
 
+            /**
+             * Read exactly size bytes from the file descriptor into the
+             * buffer.
+             *
+             * @throws std::system_error On error.
+             * @throws std::runtime_error If the end of the file is
+             *         reached before size bytes have been read.
+             */
+            inline void reliable_read_exact(const int fd, char* input_buffer, const std::size_t size) {
+                std::size_t done = 0;
+                while (done < size) {
+                    const std::size_t chunk = size - done > (1UL << 30U) ? (1UL << 30U) : size - done;
+                    const auto nread = reliable_read(fd, input_buffer + done, static_cast<unsigned int>(chunk));
+                    if (nread == 0) {
+                        throw std::runtime_error{"unexpected end of file"};
+                    }
+                    done += static_cast<std::size_t>(nread);
+                }
+            }
+
             inline void reliable_fsync(const int fd) {
 #ifdef _MSC_VER
                 osmium::detail::disable_invalid_parameter_handler diph;
@@ -42,8 +42,8 @@ DEALINGS IN THE SOFTWARE.
 #include <iterator>
 #include <list>
 #include <string>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -201,28 +201,43 @@ namespace osmium {
 
             }; // class StringStore
 
-            struct str_equal {
-
-                bool operator()(const char* lhs, const char* rhs) const noexcept {
-                    return lhs == rhs || std::strcmp(lhs, rhs) == 0;
+            /**
+             * Hash the string word-at-a-time using multiply-and-mix
+             * rounds in the style of MurmurHash64A. This is considerably
+             * faster than byte-at-a-time hashes like djb2 which this
+             * replaces, because the typical tag key or value is longer
+             * than one word and because this function needs the length
+             * up front which the callers know anyway.
+             */
+            inline uint64_t hash_string(const char* str, const std::size_t len) noexcept {
+                const uint64_t mul = 0xc6a4a7935bd1e995ULL;
+
+                uint64_t hash = 0x9e3779b97f4a7c15ULL ^ (len * mul);
+
+                std::size_t offset = 0;
+                for (; offset + 8 <= len; offset += 8) {
+                    uint64_t word;
+                    std::memcpy(&word, str + offset, 8);
+                    word *= mul;
+                    word ^= word >> 47u;
+                    word *= mul;
+                    hash ^= word;
+                    hash *= mul;
                 }
 
-            }; // struct str_equal
-
-            struct djb2_hash {
-
-                std::size_t operator()(const char* str) const noexcept {
-                    std::size_t hash = 5381;
-                    int c;
-
-                    while ((c = *str++)) {
-                        hash = ((hash << 5u) + hash) + c; /* hash * 33 + c */
-                    }
-
-                    return hash;
+                if (offset < len) {
+                    uint64_t word = 0;
+                    std::memcpy(&word, str + offset, len - offset);
+                    hash ^= word;
+                    hash *= mul;
                 }
 
-            }; // struct djb2_hash
+                hash ^= hash >> 47u;
+                hash *= mul;
+                hash ^= hash >> 47u;
+
+                return hash;
+            }
 
             class StringTable {
 
@@ -246,20 +261,74 @@ namespace osmium {
                     default_stringtable_chunk_size = 100u * 1024u
                 };
 
+                // One slot of the open-addressing index. A str of nullptr
+                // marks an empty slot.
+                struct index_entry {
+                    const char* str = nullptr;
+                    uint64_t hash = 0;
+                    int32_t id = 0;
+                };
+
+                // Initial number of slots in the index. Must be a power
+                // of two. Large enough that blocks full of untagged nodes
+                // never need to grow the index.
+                enum {
+                    initial_index_size = 1024u
+                };
+
                 StringStore m_strings;
-                std::unordered_map<const char*, int32_t, djb2_hash, str_equal> m_index;
+
+                // Flat open-addressing index with linear probing into the
+                // string store. Grown when it is three quarters full.
+                std::vector<index_entry> m_index;
+
+                std::size_t m_index_used = 0;
                 int32_t m_size = 0;
 
+                index_entry& find_slot(const char* s, const uint64_t hash) noexcept {
+                    const std::size_t mask = m_index.size() - 1;
+                    std::size_t slot = static_cast<std::size_t>(hash) & mask;
+
+                    while (m_index[slot].str != nullptr) {
+                        if (m_index[slot].hash == hash && std::strcmp(m_index[slot].str, s) == 0) {
+                            break;
+                        }
+                        slot = (slot + 1) & mask;
+                    }
+
+                    return m_index[slot];
+                }
+
+                void grow_index() {
+                    std::vector<index_entry> old_index(m_index.size() * 2);
+
+                    using std::swap;
+                    swap(old_index, m_index);
+
+                    const std::size_t mask = m_index.size() - 1;
+                    for (const auto& entry : old_index) {
+                        if (entry.str != nullptr) {
+                            std::size_t slot = static_cast<std::size_t>(entry.hash) & mask;
+                            while (m_index[slot].str != nullptr) {
+                                slot = (slot + 1) & mask;
+                            }
+                            m_index[slot] = entry;
+                        }
+                    }
+                }
+
             public:
 
                 explicit StringTable(size_t size = default_stringtable_chunk_size) :
-                    m_strings(size) {
+                    m_strings(size),
+                    m_index(initial_index_size) {
                     m_strings.add("");
                 }
 
                 void clear() {
                     m_strings.clear();
-                    m_index.clear();
+                    m_index.assign(m_index.size(), index_entry{});
+                    m_index_used = 0;
                     m_size = 0;
                     m_strings.add("");
                 }
@@ -269,18 +338,27 @@ namespace osmium {
                 }
 
                 int32_t add(const char* s) {
-                    const auto f = m_index.find(s);
-                    if (f != m_index.end()) {
-                        return f->second;
+                    const std::size_t len = std::strlen(s);
+                    const uint64_t hash = hash_string(s, len);
+
+                    auto& entry = find_slot(s, hash);
+                    if (entry.str != nullptr) {
+                        return entry.id;
                     }
 
-                    const char* cs = m_strings.add(s);
-                    m_index[cs] = ++m_size;
+                    entry.str = m_strings.add(s);
+                    entry.hash = hash;
+                    entry.id = ++m_size;
+                    ++m_index_used;
 
                     if (m_size > max_entries) {
                         throw osmium::pbf_error{"string table has too many entries"};
                     }
 
+                    if (m_index_used * 4 >= m_index.size() * 3) {
+                        grow_index();
+                    }
+
                     return m_size;
                 }
 
@@ -34,6 +34,7 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
@@ -41,6 +42,20 @@ DEALINGS IN THE SOFTWARE.
 #include <string>
 #include <utility>
 
+#include <osmium/util/cpu_features.hpp>
+
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+# define OSMIUM_USE_SSE2_XML_ESCAPE
+# include <emmintrin.h>
+# ifdef _MSC_VER
+#  include <intrin.h>
+# endif
+#endif
+
+#ifdef OSMIUM_USE_RUNTIME_DISPATCH
+# include <immintrin.h>
+#endif
+
 namespace osmium {
 
     namespace io {
@@ -203,11 +218,132 @@ namespace osmium {
                 out += hex_digits[ value         & 0xfu];
             }
 
+            /**
+             * Is this an ASCII character that OPL output lets through
+             * unescaped? These are the single-byte characters of the
+             * code point whitelist in append_utf8_encoded_string().
+             */
+            inline bool is_opl_clean_character(const char c) noexcept {
+                const auto u = static_cast<unsigned char>(c);
+                return u > 0x20u && u < 0x7fu &&
+                       c != '%' && c != ',' && c != '=' && c != '@';
+            }
+
+            /**
+             * Return the number of leading characters in the given string
+             * that OPL output can copy through unchanged. Like its XML
+             * counterpart this is the baseline implementation, use
+             * opl_clean_prefix_length() which dispatches on the CPU
+             * features at runtime.
+             */
+            inline std::size_t opl_clean_prefix_length_default(const char* data, const std::size_t size) noexcept {
+                std::size_t offset = 0;
+
+#ifdef OSMIUM_USE_SSE2_XML_ESCAPE
+                // Clean characters are the (signed) byte range between
+                // space and DEL minus the four characters with special
+                // meaning in OPL. Bytes of multibyte UTF-8 sequences are
+                // negative in the signed comparison and so never clean,
+                // they go through the code point decoder below.
+                while (offset + 16 <= size) {
+                    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+
+                    __m128i clean = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8(0x20)),
+                                                  _mm_cmplt_epi8(chunk, _mm_set1_epi8(0x7f)));
+
+                    __m128i special = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('%'));
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(',')));
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('=')));
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('@')));
+                    clean = _mm_andnot_si128(special, clean);
+
+                    const int mask = _mm_movemask_epi8(clean) ^ 0xffff;
+                    if (mask != 0) {
+#ifdef _MSC_VER
+                        unsigned long index = 0;
+                        _BitScanForward(&index, static_cast<unsigned long>(mask));
+                        return offset + index;
+#else
+                        return offset + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned int>(mask)));
+#endif
+                    }
+                    offset += 16;
+                }
+#endif
+
+                while (offset < size && is_opl_clean_character(data[offset])) {
+                    ++offset;
+                }
+
+                return offset;
+            }
+
+#ifdef OSMIUM_USE_RUNTIME_DISPATCH
+            /**
+             * AVX2 variant of opl_clean_prefix_length_default()
+             * checking 32 characters at a time. Compiled with the
+             * "target" function attribute, only ever called through
+             * the dispatch in opl_clean_prefix_length() on CPUs that
+             * have AVX2.
+             */
+            OSMIUM_TARGET_AVX2
+            inline std::size_t opl_clean_prefix_length_avx2(const char* data, const std::size_t size) noexcept {
+                std::size_t offset = 0;
+
+                while (offset + 32 <= size) {
+                    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset));
+
+                    __m256i clean = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(0x20)),
+                                                     _mm256_cmpgt_epi8(_mm256_set1_epi8(0x7f), chunk));
+
+                    __m256i special = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('%'));
+                    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(',')));
+                    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('=')));
+                    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('@')));
+                    clean = _mm256_andnot_si256(special, clean);
+
+                    const auto mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(clean));
+                    if (mask != 0) {
+                        return offset + static_cast<std::size_t>(__builtin_ctz(mask));
+                    }
+                    offset += 32;
+                }
+
+                return offset + opl_clean_prefix_length_default(data + offset, size - offset);
+            }
+#endif
+
+            /**
+             * Return the number of leading characters in the given string
+             * that OPL output can copy through unchanged, using the
+             * widest vector instructions this CPU has.
+             */
+            inline std::size_t opl_clean_prefix_length(const char* data, const std::size_t size) noexcept {
+#ifdef OSMIUM_USE_RUNTIME_DISPATCH
+                using fn_type = std::size_t (*)(const char*, std::size_t);
+                static const fn_type fn = osmium::util::cpu_features().avx2 ?
+                    opl_clean_prefix_length_avx2 : opl_clean_prefix_length_default;
+                return fn(data, size);
+#else
+                return opl_clean_prefix_length_default(data, size);
+#endif
+            }
+
             inline void append_utf8_encoded_string(std::string& out, const char* data) {
                 static const char* lookup_hex = "0123456789abcdef";
                 const char* end = data + std::strlen(data);
 
                 while (data != end) {
+                    // Copy the run of clean ASCII characters wholesale,
+                    // in the typical tag value there is nothing else.
+                    const std::size_t clean = opl_clean_prefix_length(data, static_cast<std::size_t>(end - data));
+                    out.append(data, clean);
+                    data += clean;
+
+                    if (data == end) {
+                        break;
+                    }
+
                     const char* last = data;
                     const uint32_t c = next_utf8_codepoint(&data, end);
 
@@ -237,8 +373,123 @@ namespace osmium {
                 }
             }
 
+            /// Does this character need to be escaped in XML?
+            inline bool is_xml_special_character(const char c) noexcept {
+                return c == '&'  || c == '\"' || c == '\'' ||
+                       c == '<'  || c == '>'  ||
+                       c == '\n' || c == '\r' || c == '\t';
+            }
+
+            /**
+             * Return the number of leading characters in the given string
+             * that do not need to be escaped in XML. These "clean" runs can
+             * be appended to the output as-is. This is the baseline
+             * implementation, use xml_clean_prefix_length() which
+             * dispatches on the CPU features at runtime.
+             */
+            inline std::size_t xml_clean_prefix_length_default(const char* data, const std::size_t size) noexcept {
+                std::size_t offset = 0;
+
+#ifdef OSMIUM_USE_SSE2_XML_ESCAPE
+                // Compare 16 characters at a time against all characters
+                // needing to be escaped. Anything else, including all bytes
+                // of multibyte UTF-8 sequences, goes through unchanged.
+                while (offset + 16 <= size) {
+                    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+
+                    __m128i special = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('&'));
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\"')));
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\'')));
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('<')));
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('>')));
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')));
+                    special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+
+                    const int mask = _mm_movemask_epi8(special);
+                    if (mask != 0) {
+#ifdef _MSC_VER
+                        unsigned long index = 0;
+                        _BitScanForward(&index, static_cast<unsigned long>(mask));
+                        return offset + index;
+#else
+                        return offset + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned int>(mask)));
+#endif
+                    }
+                    offset += 16;
+                }
+#endif
+
+                while (offset < size && !is_xml_special_character(data[offset])) {
+                    ++offset;
+                }
+
+                return offset;
+            }
+
+#ifdef OSMIUM_USE_RUNTIME_DISPATCH
+            /**
+             * AVX2 variant of xml_clean_prefix_length_default()
+             * comparing 32 characters at a time. Compiled with the
+             * "target" function attribute, only ever called through
+             * the dispatch in xml_clean_prefix_length() on CPUs that
+             * have AVX2.
+             */
+            OSMIUM_TARGET_AVX2
+            inline std::size_t xml_clean_prefix_length_avx2(const char* data, const std::size_t size) noexcept {
+                std::size_t offset = 0;
+
+                while (offset + 32 <= size) {
+                    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset));
+
+                    __m256i special = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('&'));
+                    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\"')));
+                    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\'')));
+                    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('<')));
+                    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('>')));
+                    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')));
+                    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')));
+                    special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t')));
+
+                    const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+                    if (mask != 0) {
+                        return offset + static_cast<std::size_t>(__builtin_ctz(mask));
+                    }
+                    offset += 32;
+                }
+
+                return offset + xml_clean_prefix_length_default(data + offset, size - offset);
+            }
+#endif
+
+            /**
+             * Return the number of leading characters in the given string
+             * that do not need to be escaped in XML, using the widest
+             * vector instructions this CPU has.
+             */
+            inline std::size_t xml_clean_prefix_length(const char* data, const std::size_t size) noexcept {
+#ifdef OSMIUM_USE_RUNTIME_DISPATCH
+                using fn_type = std::size_t (*)(const char*, std::size_t);
+                static const fn_type fn = osmium::util::cpu_features().avx2 ?
+                    xml_clean_prefix_length_avx2 : xml_clean_prefix_length_default;
+                return fn(data, size);
+#else
+                return xml_clean_prefix_length_default(data, size);
+#endif
+            }
+
             inline void append_xml_encoded_string(std::string& out, const char* data) {
-                for (; *data != '\0'; ++data) {
+                const char* end = data + std::strlen(data);
+
+                while (data != end) {
+                    const std::size_t clean = xml_clean_prefix_length(data, static_cast<std::size_t>(end - data));
+                    out.append(data, clean);
+                    data += clean;
+
+                    if (data == end) {
+                        break;
+                    }
+
                     switch (*data) {
                         case '&':  out += "&amp;";  break;
                         case '\"': out += "&quot;"; break;
@@ -247,9 +498,9 @@ namespace osmium {
                         case '>':  out += "&gt;";   break;
                         case '\n': out += "&#xA;";  break;
                         case '\r': out += "&#xD;";  break;
-                        case '\t': out += "&#x9;";  break;
-                        default:   out += *data;    break;
+                        default:   out += "&#x9;";  break; // '\t'
                     }
+                    ++data;
                 }
             }
 
@@ -0,0 +1,104 @@
+#ifndef OSMIUM_IO_DETAIL_TAGS_FILTER_HPP
+#define OSMIUM_IO_DETAIL_TAGS_FILTER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/tags/tags_filter.hpp>
+
+#include <functional>
+#include <memory>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * A predicate deciding from key and value strings whether a tag
+         * matches. Given as an option to an osmium::io::Reader it is
+         * pushed down into the PBF decoder: Only objects with at least
+         * one matching tag are decoded, all other objects are skipped
+         * before any buffer space is allocated for them. An
+         * osmium::TagsFilter can be used directly as the filter
+         * function. Only the PBF parser supports this option, other
+         * parsers ignore it.
+         */
+        struct pbf_tags_filter {
+
+            std::function<bool(const char* key, const char* value)> filter;
+
+            /**
+             * Optional key-only predicate: It must return true for every
+             * key for which the filter function could return true with
+             * any value (returning true for more keys is allowed, false
+             * negatives are not). If set, the PBF decoder evaluates it
+             * once per block for each entry in the block's string table.
+             * Checking the key of a tag then becomes a lookup with the
+             * string-table id instead of running the filter function on
+             * the strings, which is much cheaper for the common case of
+             * tags that don't match. Use make_pbf_tags_filter() to create
+             * this automatically from an osmium::TagsFilter.
+             */
+            std::function<bool(const char* key)> key_filter;
+
+        }; // struct pbf_tags_filter
+
+        /**
+         * Create a pbf_tags_filter option from an osmium::TagsFilter.
+         * The filter is copied and compiled (see TagsFilterBase::compile())
+         * and, unless the filter's default result is true, its key check
+         * is made available to the PBF decoder separately, so the decoder
+         * can reject tags with non-matching keys by their string-table id
+         * without looking at the strings at all.
+         */
+        inline pbf_tags_filter make_pbf_tags_filter(const osmium::TagsFilter& filter) {
+            const auto fp = std::make_shared<osmium::TagsFilter>(filter);
+            fp->compile();
+
+            pbf_tags_filter result;
+            result.filter = [fp](const char* key, const char* value) {
+                return (*fp)(key, value);
+            };
+            if (!fp->default_result()) {
+                result.key_filter = [fp](const char* key) {
+                    return fp->matches_key(key);
+                };
+            }
+
+            return result;
+        }
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_TAGS_FILTER_HPP
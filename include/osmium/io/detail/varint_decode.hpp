@@ -0,0 +1,225 @@
+#ifndef OSMIUM_IO_DETAIL_VARINT_DECODE_HPP
+#define OSMIUM_IO_DETAIL_VARINT_DECODE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/detail/pbf.hpp>
+#include <osmium/util/delta.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+# define OSMIUM_USE_SSE2_VARINT_DECODE
+# include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+# define OSMIUM_USE_NEON_VARINT_DECODE
+# include <arm_neon.h>
+#endif
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * Decoding of protobuf packed varint fields in bulk. The packed
+             * sint64 delta arrays in PBF DenseNodes (ids, lats, lons,
+             * timestamps) are the hottest loops when reading a planet file.
+             * Decoding a whole field into a flat array first and building
+             * objects from that afterwards is considerably faster than
+             * pulling one varint at a time through an iterator, and it
+             * allows skipping the per-byte continuation-bit test for whole
+             * chunks of single-byte varints, which dominate delta-encoded
+             * data.
+             */
+
+            inline int64_t zigzag_decode(const uint64_t value) noexcept {
+                return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+            }
+
+            /**
+             * Decode one varint from [data, end). Updates data to point
+             * behind the decoded bytes.
+             *
+             * @throws osmium::pbf_error if the varint is truncated or longer
+             *         than 10 bytes.
+             */
+            inline uint64_t decode_varint_slow(const char** data, const char* end) {
+                const auto* begin = reinterpret_cast<const uint8_t*>(*data);
+                const auto* iend = reinterpret_cast<const uint8_t*>(end);
+                const uint8_t* p = begin;
+                uint64_t value = 0;
+                unsigned shift = 0;
+
+                while (p != iend && shift < 70u) {
+                    const uint8_t byte = *p++;
+                    value |= static_cast<uint64_t>(byte & 0x7fu) << shift;
+                    if ((byte & 0x80u) == 0) {
+                        *data = reinterpret_cast<const char*>(p);
+                        return value;
+                    }
+                    shift += 7;
+                }
+
+                if (p == iend) {
+                    throw osmium::pbf_error{"truncated varint in packed field"};
+                }
+                throw osmium::pbf_error{"varint too long"};
+            }
+
+            /**
+             * Decode a whole packed varint field into the given vector.
+             * The vector is not cleared, decoded values are appended.
+             *
+             * Works in chunks: whenever the next 16 input bytes all have
+             * the continuation bit clear, they are 16 complete one-byte
+             * varints and are appended without any further tests. On x86
+             * (SSE2) and AArch64 (NEON) the check for such a chunk is a
+             * single vector load plus mask extraction. Remaining bytes and
+             * multi-byte varints go through the normal decoder.
+             */
+            inline void decode_packed_varint(const char* data, const char* end, std::vector<uint64_t>& values) {
+                values.reserve(values.size() + static_cast<std::size_t>(end - data));
+
+                while (data < end) {
+#if defined(OSMIUM_USE_SSE2_VARINT_DECODE)
+                    while (end - data >= 16) {
+                        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+                        if (_mm_movemask_epi8(chunk) != 0) {
+                            break;
+                        }
+                        for (int i = 0; i < 16; ++i) {
+                            values.push_back(static_cast<uint8_t>(data[i]));
+                        }
+                        data += 16;
+                    }
+#elif defined(OSMIUM_USE_NEON_VARINT_DECODE)
+                    while (end - data >= 16) {
+                        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data));
+                        if (vmaxvq_u8(chunk) >= 0x80u) {
+                            break;
+                        }
+                        for (int i = 0; i < 16; ++i) {
+                            values.push_back(static_cast<uint8_t>(data[i]));
+                        }
+                        data += 16;
+                    }
+#endif
+                    if (data >= end) {
+                        break;
+                    }
+                    const auto byte = static_cast<uint8_t>(*data);
+                    if ((byte & 0x80u) == 0) {
+                        values.push_back(byte);
+                        ++data;
+                    } else {
+                        values.push_back(decode_varint_slow(&data, end));
+                    }
+                }
+            }
+
+            /**
+             * Decode a whole array of zigzag-encoded varints into the
+             * given vector. The vector is cleared first. Used for the
+             * packed sint64 fields in PBF and for the reference sections
+             * in o5m files.
+             */
+            inline void decode_packed_zigzag(const char* data, const char* end, std::vector<int64_t>& values) {
+                values.clear();
+                values.reserve(static_cast<std::size_t>(end - data));
+
+                while (data < end) {
+#if defined(OSMIUM_USE_SSE2_VARINT_DECODE)
+                    while (end - data >= 16) {
+                        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+                        if (_mm_movemask_epi8(chunk) != 0) {
+                            break;
+                        }
+                        for (int i = 0; i < 16; ++i) {
+                            values.push_back(zigzag_decode(static_cast<uint8_t>(data[i])));
+                        }
+                        data += 16;
+                    }
+#elif defined(OSMIUM_USE_NEON_VARINT_DECODE)
+                    while (end - data >= 16) {
+                        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data));
+                        if (vmaxvq_u8(chunk) >= 0x80u) {
+                            break;
+                        }
+                        for (int i = 0; i < 16; ++i) {
+                            values.push_back(zigzag_decode(static_cast<uint8_t>(data[i])));
+                        }
+                        data += 16;
+                    }
+#endif
+                    if (data >= end) {
+                        break;
+                    }
+                    const auto byte = static_cast<uint8_t>(*data);
+                    uint64_t raw;
+                    if ((byte & 0x80u) == 0) {
+                        raw = byte;
+                        ++data;
+                    } else {
+                        raw = decode_varint_slow(&data, end);
+                    }
+                    values.push_back(zigzag_decode(raw));
+                }
+            }
+
+            /**
+             * Decode a whole packed sint64 field (zigzag-encoded varints)
+             * interpreted as deltas into the given vector of absolute
+             * values, starting the running sum at zero. The vector is
+             * cleared first.
+             *
+             * The varints are decoded into the vector as raw deltas
+             * first, then turned into absolute values with one bulk
+             * prefix-sum pass over the flat array, see
+             * osmium::DeltaDecode::update().
+             */
+            inline void decode_packed_sint64_delta(const char* data, const char* end, std::vector<int64_t>& values) {
+                decode_packed_zigzag(data, end, values);
+                osmium::DeltaDecode<int64_t>{}.update(values.data(), values.size());
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_VARINT_DECODE_HPP
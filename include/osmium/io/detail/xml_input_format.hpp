@@ -37,6 +37,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/builder/osm_object_builder.hpp>
 #include <osmium/io/detail/input_format.hpp>
 #include <osmium/io/detail/queue_util.hpp>
+#include <osmium/io/detail/string_util.hpp>
 #include <osmium/io/error.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
@@ -59,12 +60,15 @@ DEALINGS IN THE SOFTWARE.
 #include <expat.h>
 
 #include <cassert>
+#include <cstddef>
 #include <cstring>
+#include <functional>
 #include <future>
 #include <limits>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -124,12 +128,26 @@ namespace osmium {
 
         namespace detail {
 
-            class XMLParser : public Parser {
+            /**
+             * The guts of the XML parser: the expat callbacks building OSM
+             * entities from the elements. This is separate from the Parser
+             * subclass below so that several instances can work on different
+             * parts of the input concurrently. Where the built entities and
+             * the header go is up to the user-supplied callbacks.
+             */
+            class XMLParserCore {
+
+            public:
 
-                enum {
+                enum : std::size_t {
                     initial_buffer_size = 1024ul * 1024ul
                 };
 
+                using flush_callback_type = std::function<void(osmium::memory::Buffer&&)>;
+                using header_callback_type = std::function<void(const osmium::io::Header&)>;
+
+            private:
+
                 enum class context {
                     osm,
                     osmChange,
@@ -154,8 +172,14 @@ namespace osmium {
 
                 osmium::io::Header m_header{};
 
-                osmium::memory::Buffer m_buffer{initial_buffer_size,
-                                                osmium::memory::Buffer::auto_grow::internal};
+                osmium::memory::Buffer m_buffer;
+
+                flush_callback_type m_flush_callback;
+                header_callback_type m_header_callback;
+
+                osmium::osm_entity_bits::type m_read_types;
+                osmium::io::read_discussions m_read_discussions;
+                bool m_header_is_done = false;
 
                 std::unique_ptr<osmium::builder::NodeBuilder>                m_node_builder{};
                 std::unique_ptr<osmium::builder::WayBuilder>                 m_way_builder{};
@@ -178,15 +202,15 @@ namespace osmium {
                     XML_Parser m_parser;
 
                     static void XMLCALL start_element_wrapper(void* data, const XML_Char* element, const XML_Char** attrs) {
-                        static_cast<XMLParser*>(data)->start_element(element, attrs);
+                        static_cast<XMLParserCore*>(data)->start_element(element, attrs);
                     }
 
                     static void XMLCALL end_element_wrapper(void* data, const XML_Char* element) {
-                        static_cast<XMLParser*>(data)->end_element(element);
+                        static_cast<XMLParserCore*>(data)->end_element(element);
                     }
 
                     static void XMLCALL character_data_wrapper(void* data, const XML_Char* text, int len) {
-                        static_cast<XMLParser*>(data)->characters(text, len);
+                        static_cast<XMLParserCore*>(data)->characters(text, len);
                     }
 
                     // This handler is called when there are any XML entities
@@ -314,8 +338,21 @@ namespace osmium {
                     m_tl_builder->add_tag(k, v);
                 }
 
+                osmium::osm_entity_bits::type read_types() const noexcept {
+                    return m_read_types;
+                }
+
+                bool want_discussions() const noexcept {
+                    return m_read_discussions == osmium::io::read_discussions::yes;
+                }
+
                 void mark_header_as_done() {
-                    set_header_value(m_header);
+                    if (!m_header_is_done) {
+                        m_header_is_done = true;
+                        if (m_header_callback) {
+                            m_header_callback(m_header);
+                        }
+                    }
                 }
 
                 void top_level_element(const XML_Char* element, const XML_Char** attrs) {
@@ -553,7 +590,7 @@ namespace osmium {
                                 m_context_stack.push_back(context::discussion);
                                 if (read_types() & osmium::osm_entity_bits::changeset) {
                                     m_tl_builder.reset();
-                                    if (!m_changeset_discussion_builder) {
+                                    if (want_discussions() && !m_changeset_discussion_builder) {
                                         m_changeset_discussion_builder.reset(new osmium::builder::ChangesetDiscussionBuilder{*m_changeset_builder});
                                     }
                                 }
@@ -570,7 +607,7 @@ namespace osmium {
                         case context::discussion:
                             if (!std::strcmp(element, "comment")) {
                                 m_context_stack.push_back(context::comment);
-                                if (read_types() & osmium::osm_entity_bits::changeset) {
+                                if ((read_types() & osmium::osm_entity_bits::changeset) && want_discussions()) {
                                     osmium::Timestamp date;
                                     osmium::user_id_type uid = 0;
                                     const char* user = "";
@@ -678,7 +715,7 @@ namespace osmium {
                             break;
                         case context::text:
                             assert(!std::strcmp(element, "text"));
-                            if (read_types() & osmium::osm_entity_bits::changeset) {
+                            if ((read_types() & osmium::osm_entity_bits::changeset) && want_discussions()) {
                                 m_changeset_discussion_builder->add_comment_text(m_comment_text);
                                 m_comment_text.clear();
                             }
@@ -694,6 +731,7 @@ namespace osmium {
 
                 void characters(const XML_Char* text, int len) {
                     if ((read_types() & osmium::osm_entity_bits::changeset) &&
+                        want_discussions() &&
                         !m_context_stack.empty() &&
                         m_context_stack.back() == context::text) {
                         m_comment_text.append(text, len);
@@ -701,9 +739,736 @@ namespace osmium {
                 }
 
                 void flush_buffer() {
-                    if (m_buffer.has_nested_buffers()) {
+                    if (m_buffer.has_nested_buffers() && m_flush_callback) {
                         std::unique_ptr<osmium::memory::Buffer> buffer_ptr{m_buffer.get_last_nested()};
-                        send_to_output_queue(std::move(*buffer_ptr));
+                        m_flush_callback(std::move(*buffer_ptr));
+                    }
+                }
+
+                ExpatXMLParser m_parser{this};
+
+            public:
+
+                XMLParserCore(osmium::osm_entity_bits::type read_types,
+                              flush_callback_type flush_callback,
+                              header_callback_type header_callback,
+                              osmium::io::read_discussions read_discussions = osmium::io::read_discussions::yes,
+                              std::size_t buffer_size = initial_buffer_size) :
+                    m_context_stack(),
+                    m_buffer(buffer_size, osmium::memory::Buffer::auto_grow::internal),
+                    m_flush_callback(std::move(flush_callback)),
+                    m_header_callback(std::move(header_callback)),
+                    m_read_types(read_types),
+                    m_read_discussions(read_discussions) {
+                }
+
+                XMLParserCore(const XMLParserCore&) = delete;
+                XMLParserCore& operator=(const XMLParserCore&) = delete;
+
+                XMLParserCore(XMLParserCore&&) = delete;
+                XMLParserCore& operator=(XMLParserCore&&) = delete;
+
+                ~XMLParserCore() noexcept = default;
+
+                void parse(const std::string& data, const bool last) {
+                    m_parser(data, last);
+                }
+
+                const osmium::io::Header& header() const noexcept {
+                    return m_header;
+                }
+
+                bool header_is_done() const noexcept {
+                    return m_header_is_done;
+                }
+
+                /// Take the buffer with all data not flushed out yet.
+                osmium::memory::Buffer take_buffer() {
+                    return std::move(m_buffer);
+                }
+
+            }; // class XMLParserCore
+
+            /**
+             * Hand-written parser for the small fixed vocabulary of OSM XML
+             * data files. Attribute values are decoded in place and the
+             * strings handed directly to the builders, avoiding the
+             * callback and copying overhead of the generic expat parser.
+             *
+             * The parser handles sequences of complete <node>, <way>, and
+             * <relation> elements (with comments and processing
+             * instructions between them). When it runs into anything else
+             * it stops and reports how far it got, the caller then falls
+             * back to the expat-based parser for the rest of the input.
+             * Malformed XML in the elements it does understand is reported
+             * with an exception.
+             */
+            class XMLFastSegmentParser {
+
+                char* m_ptr;
+                char* m_end;
+                osmium::memory::Buffer& m_buffer;
+                osmium::osm_entity_bits::type m_read_types;
+
+                static bool is_whitespace(const char c) noexcept {
+                    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+                }
+
+                static bool is_name_char(const char c) noexcept {
+                    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                           (c >= '0' && c <= '9') ||
+                           c == '_' || c == '-' || c == ':' || c == '.';
+                }
+
+                void skip_whitespace() noexcept {
+                    while (m_ptr != m_end && is_whitespace(*m_ptr)) {
+                        ++m_ptr;
+                    }
+                }
+
+                void skip_past(const char* delimiter, const char* error) {
+                    char* const pos = std::strstr(m_ptr, delimiter);
+                    if (!pos || pos >= m_end) {
+                        throw osmium::xml_error{error};
+                    }
+                    m_ptr = pos + std::strlen(delimiter);
+                }
+
+                /// Skip whitespace, comments, and processing instructions.
+                void skip_misc() {
+                    while (true) {
+                        skip_whitespace();
+                        if (m_end - m_ptr >= 4 && m_ptr[0] == '<' && m_ptr[1] == '!' && m_ptr[2] == '-' && m_ptr[3] == '-') {
+                            m_ptr += 4;
+                            skip_past("-->", "XML comment not closed");
+                        } else if (m_end - m_ptr >= 2 && m_ptr[0] == '<' && m_ptr[1] == '?') {
+                            m_ptr += 2;
+                            skip_past("?>", "XML processing instruction not closed");
+                        } else {
+                            break;
+                        }
+                    }
+                }
+
+                /// Decode one XML entity starting at the '&', write the
+                /// result to dst, and return the position after the ';'.
+                static char* decode_entity(char* src, char*& dst) {
+                    if (!std::strncmp(src, "&amp;", 5))  { *dst++ = '&';  return src + 5; }
+                    if (!std::strncmp(src, "&lt;", 4))   { *dst++ = '<';  return src + 4; }
+                    if (!std::strncmp(src, "&gt;", 4))   { *dst++ = '>';  return src + 4; }
+                    if (!std::strncmp(src, "&quot;", 6)) { *dst++ = '\"'; return src + 6; }
+                    if (!std::strncmp(src, "&apos;", 6)) { *dst++ = '\''; return src + 6; }
+
+                    if (src[1] == '#') {
+                        src += 2;
+                        uint32_t cp = 0;
+                        if (*src == 'x' || *src == 'X') {
+                            ++src;
+                            while (*src != ';') {
+                                if (*src >= '0' && *src <= '9') {
+                                    cp = cp * 16 + static_cast<uint32_t>(*src - '0');
+                                } else if (*src >= 'a' && *src <= 'f') {
+                                    cp = cp * 16 + static_cast<uint32_t>(*src - 'a' + 10);
+                                } else if (*src >= 'A' && *src <= 'F') {
+                                    cp = cp * 16 + static_cast<uint32_t>(*src - 'A' + 10);
+                                } else {
+                                    throw osmium::xml_error{"invalid XML character reference"};
+                                }
+                                ++src;
+                            }
+                        } else {
+                            while (*src != ';') {
+                                if (*src < '0' || *src > '9') {
+                                    throw osmium::xml_error{"invalid XML character reference"};
+                                }
+                                cp = cp * 10 + static_cast<uint32_t>(*src - '0');
+                                ++src;
+                            }
+                        }
+                        if (cp == 0 || cp > 0x10ffffu) {
+                            throw osmium::xml_error{"invalid XML character reference"};
+                        }
+                        dst = append_codepoint_as_utf8(cp, dst);
+                        return src + 1;
+                    }
+
+                    throw osmium::xml_error{"unknown XML entity"};
+                }
+
+                /**
+                 * Parse the attributes of a start tag, calling
+                 * handler(name, value) with NUL-terminated in-place strings
+                 * for each one. Returns true if the element has content,
+                 * false if it is self-closing.
+                 */
+                template <typename THandler>
+                bool parse_attributes(THandler&& handler) {
+                    while (true) {
+                        skip_whitespace();
+                        if (m_ptr == m_end) {
+                            throw osmium::xml_error{"unexpected end of input in XML tag"};
+                        }
+                        if (*m_ptr == '>') {
+                            ++m_ptr;
+                            return true;
+                        }
+                        if (*m_ptr == '/') {
+                            ++m_ptr;
+                            if (m_ptr == m_end || *m_ptr != '>') {
+                                throw osmium::xml_error{"expected '>' in XML tag"};
+                            }
+                            ++m_ptr;
+                            return false;
+                        }
+
+                        char* const name = m_ptr;
+                        while (is_name_char(*m_ptr)) {
+                            ++m_ptr;
+                        }
+                        if (m_ptr == name) {
+                            throw osmium::xml_error{"expected attribute name in XML tag"};
+                        }
+                        char* const name_end = m_ptr;
+                        skip_whitespace();
+                        if (*m_ptr != '=') {
+                            throw osmium::xml_error{"expected '=' after attribute name"};
+                        }
+                        ++m_ptr;
+                        skip_whitespace();
+                        const char quote = *m_ptr;
+                        if (quote != '\"' && quote != '\'') {
+                            throw osmium::xml_error{"expected quoted attribute value"};
+                        }
+                        ++m_ptr;
+                        *name_end = '\0';
+
+                        char* const value = m_ptr;
+                        char* src = m_ptr;
+                        char* dst = m_ptr;
+                        while (*src != quote) {
+                            if (src == m_end) {
+                                throw osmium::xml_error{"unexpected end of input in attribute value"};
+                            }
+                            if (*src == '&') {
+                                src = decode_entity(src, dst);
+                            } else {
+                                *dst++ = *src++;
+                            }
+                        }
+                        m_ptr = src + 1;
+                        *dst = '\0';
+
+                        handler(name, value);
+                    }
+                }
+
+                /// Skip to the end of the start tag whose name was already
+                /// consumed. Returns true if the element has content.
+                bool skip_start_tag() {
+                    while (m_ptr != m_end) {
+                        const char c = *m_ptr;
+                        if (c == '\"' || c == '\'') {
+                            ++m_ptr;
+                            while (m_ptr != m_end && *m_ptr != c) {
+                                ++m_ptr;
+                            }
+                            if (m_ptr == m_end) {
+                                break;
+                            }
+                            ++m_ptr;
+                        } else if (c == '/' && m_ptr + 1 != m_end && m_ptr[1] == '>') {
+                            m_ptr += 2;
+                            return false;
+                        } else if (c == '>') {
+                            ++m_ptr;
+                            return true;
+                        } else {
+                            ++m_ptr;
+                        }
+                    }
+                    throw osmium::xml_error{"unexpected end of input in XML tag"};
+                }
+
+                /// Skip a whole element (the '<' and name were already
+                /// consumed), including any nested elements.
+                void skip_element() {
+                    int depth = skip_start_tag() ? 1 : 0;
+                    while (depth > 0) {
+                        char* const pos = static_cast<char*>(std::memchr(m_ptr, '<', static_cast<std::size_t>(m_end - m_ptr)));
+                        if (!pos) {
+                            throw osmium::xml_error{"unexpected end of input in XML element"};
+                        }
+                        m_ptr = pos + 1;
+                        if (*m_ptr == '/') {
+                            const char* const gt = static_cast<const char*>(std::memchr(m_ptr, '>', static_cast<std::size_t>(m_end - m_ptr)));
+                            if (!gt) {
+                                throw osmium::xml_error{"unexpected end of input in XML element"};
+                            }
+                            m_ptr = const_cast<char*>(gt) + 1;
+                            --depth;
+                        } else if (m_end - m_ptr >= 3 && m_ptr[0] == '!' && m_ptr[1] == '-' && m_ptr[2] == '-') {
+                            m_ptr += 3;
+                            skip_past("-->", "XML comment not closed");
+                        } else {
+                            if (skip_start_tag()) {
+                                ++depth;
+                            }
+                        }
+                    }
+                }
+
+                /// Expect the end tag with the given name next.
+                void parse_end_tag(const char* name) {
+                    if (m_end - m_ptr < 2 || m_ptr[0] != '<' || m_ptr[1] != '/') {
+                        throw osmium::xml_error{std::string{"expected closing tag for <"} + name + ">"};
+                    }
+                    m_ptr += 2;
+                    const std::size_t len = std::strlen(name);
+                    if (static_cast<std::size_t>(m_end - m_ptr) < len + 1 ||
+                        std::strncmp(m_ptr, name, len) != 0) {
+                        throw osmium::xml_error{std::string{"expected closing tag for <"} + name + ">"};
+                    }
+                    m_ptr += len;
+                    skip_whitespace();
+                    if (m_ptr == m_end || *m_ptr != '>') {
+                        throw osmium::xml_error{std::string{"expected closing tag for <"} + name + ">"};
+                    }
+                    ++m_ptr;
+                }
+
+                /// Is this the start of a child element with the given name?
+                bool at_child_element(const char* name) const noexcept {
+                    const std::size_t len = std::strlen(name);
+                    return static_cast<std::size_t>(m_end - m_ptr) > len + 1 &&
+                           m_ptr[0] == '<' &&
+                           !std::strncmp(m_ptr + 1, name, len) &&
+                           !is_name_char(m_ptr[1 + len]);
+                }
+
+                void parse_tag_element(osmium::builder::Builder& parent,
+                                       std::unique_ptr<osmium::builder::TagListBuilder>& tl_builder) {
+                    m_ptr += 4; // "<tag"
+                    const char* k = "";
+                    const char* v = "";
+                    const bool has_content = parse_attributes([&k, &v](const char* name, const char* value) {
+                        if (name[0] == 'k' && name[1] == '\0') {
+                            k = value;
+                        } else if (name[0] == 'v' && name[1] == '\0') {
+                            v = value;
+                        }
+                    });
+                    if (has_content) {
+                        skip_misc();
+                        if (m_end - m_ptr < 2 || m_ptr[0] != '<' || m_ptr[1] != '/') {
+                            throw osmium::xml_error{"No element inside <tag> allowed"};
+                        }
+                        parse_end_tag("tag");
+                    }
+                    if (!tl_builder) {
+                        tl_builder.reset(new osmium::builder::TagListBuilder{parent});
+                    }
+                    tl_builder->add_tag(k, v);
+                }
+
+                template <typename TBuilder>
+                const char* init_object_attributes(TBuilder& builder, bool& has_content) {
+                    osmium::OSMObject& object = builder.object();
+                    osmium::Location location;
+                    const char* user = "";
+
+                    has_content = parse_attributes([&location, &user, &object](const char* name, const char* value) {
+                        if (!std::strcmp(name, "lon")) {
+                            location.set_lon(value);
+                        } else if (!std::strcmp(name, "lat")) {
+                            location.set_lat(value);
+                        } else if (!std::strcmp(name, "user")) {
+                            user = value;
+                        } else {
+                            object.set_attribute(name, value);
+                        }
+                    });
+
+                    if (location && object.type() == osmium::item_type::node) {
+                        static_cast<osmium::Node&>(object).set_location(location);
+                    }
+
+                    return user;
+                }
+
+                void parse_node() {
+                    {
+                        osmium::builder::NodeBuilder builder{m_buffer};
+                        bool has_content = false;
+                        builder.set_user(init_object_attributes(builder, has_content));
+
+                        if (has_content) {
+                            std::unique_ptr<osmium::builder::TagListBuilder> tl_builder;
+                            while (true) {
+                                skip_misc();
+                                if (at_child_element("tag")) {
+                                    parse_tag_element(builder, tl_builder);
+                                } else if (m_end - m_ptr >= 2 && m_ptr[0] == '<' && m_ptr[1] == '/') {
+                                    break;
+                                } else {
+                                    throw osmium::xml_error{"Unknown element in <node>"};
+                                }
+                            }
+                            tl_builder.reset();
+                            parse_end_tag("node");
+                        }
+                    }
+                    m_buffer.commit();
+                }
+
+                void parse_way() {
+                    {
+                        osmium::builder::WayBuilder builder{m_buffer};
+                        bool has_content = false;
+                        builder.set_user(init_object_attributes(builder, has_content));
+
+                        if (has_content) {
+                            std::unique_ptr<osmium::builder::TagListBuilder> tl_builder;
+                            std::unique_ptr<osmium::builder::WayNodeListBuilder> wnl_builder;
+                            while (true) {
+                                skip_misc();
+                                if (at_child_element("nd")) {
+                                    m_ptr += 3; // "<nd"
+                                    tl_builder.reset();
+                                    if (!wnl_builder) {
+                                        wnl_builder.reset(new osmium::builder::WayNodeListBuilder{builder});
+                                    }
+                                    NodeRef nr;
+                                    const bool nd_content = parse_attributes([&nr](const char* name, const char* value) {
+                                        if (!std::strcmp(name, "ref")) {
+                                            nr.set_ref(osmium::string_to_object_id(value));
+                                        } else if (!std::strcmp(name, "lon")) {
+                                            nr.location().set_lon(value);
+                                        } else if (!std::strcmp(name, "lat")) {
+                                            nr.location().set_lat(value);
+                                        }
+                                    });
+                                    if (nd_content) {
+                                        skip_misc();
+                                        parse_end_tag("nd");
+                                    }
+                                    wnl_builder->add_node_ref(nr);
+                                } else if (at_child_element("tag")) {
+                                    wnl_builder.reset();
+                                    parse_tag_element(builder, tl_builder);
+                                } else if (m_end - m_ptr >= 2 && m_ptr[0] == '<' && m_ptr[1] == '/') {
+                                    break;
+                                } else {
+                                    throw osmium::xml_error{"Unknown element in <way>"};
+                                }
+                            }
+                            tl_builder.reset();
+                            wnl_builder.reset();
+                            parse_end_tag("way");
+                        }
+                    }
+                    m_buffer.commit();
+                }
+
+                void parse_relation() {
+                    {
+                        osmium::builder::RelationBuilder builder{m_buffer};
+                        bool has_content = false;
+                        builder.set_user(init_object_attributes(builder, has_content));
+
+                        if (has_content) {
+                            std::unique_ptr<osmium::builder::TagListBuilder> tl_builder;
+                            std::unique_ptr<osmium::builder::RelationMemberListBuilder> rml_builder;
+                            while (true) {
+                                skip_misc();
+                                if (at_child_element("member")) {
+                                    m_ptr += 7; // "<member"
+                                    tl_builder.reset();
+                                    if (!rml_builder) {
+                                        rml_builder.reset(new osmium::builder::RelationMemberListBuilder{builder});
+                                    }
+                                    item_type type = item_type::undefined;
+                                    object_id_type ref = 0;
+                                    bool ref_is_set = false;
+                                    const char* role = "";
+                                    const bool member_content = parse_attributes([&type, &ref, &ref_is_set, &role](const char* name, const char* value) {
+                                        if (!std::strcmp(name, "type")) {
+                                            type = char_to_item_type(value[0]);
+                                        } else if (!std::strcmp(name, "ref")) {
+                                            ref = osmium::string_to_object_id(value);
+                                            ref_is_set = true;
+                                        } else if (!std::strcmp(name, "role")) {
+                                            role = value;
+                                        }
+                                    });
+                                    if (member_content) {
+                                        skip_misc();
+                                        parse_end_tag("member");
+                                    }
+                                    if (type != item_type::node && type != item_type::way && type != item_type::relation) {
+                                        throw osmium::xml_error{"Unknown type on relation <member>"};
+                                    }
+                                    if (!ref_is_set) {
+                                        throw osmium::xml_error{"Missing ref on relation <member>"};
+                                    }
+                                    rml_builder->add_member(type, ref, role);
+                                } else if (at_child_element("tag")) {
+                                    rml_builder.reset();
+                                    parse_tag_element(builder, tl_builder);
+                                } else if (m_end - m_ptr >= 2 && m_ptr[0] == '<' && m_ptr[1] == '/') {
+                                    break;
+                                } else {
+                                    throw osmium::xml_error{"Unknown element in <relation>"};
+                                }
+                            }
+                            tl_builder.reset();
+                            rml_builder.reset();
+                            parse_end_tag("relation");
+                        }
+                    }
+                    m_buffer.commit();
+                }
+
+            public:
+
+                XMLFastSegmentParser(std::string& input,
+                                     osmium::osm_entity_bits::type read_types,
+                                     osmium::memory::Buffer& buffer) noexcept :
+                    m_ptr(&input[0]),
+                    m_end(&input[0] + input.size()),
+                    m_buffer(buffer),
+                    m_read_types(read_types) {
+                }
+
+                /**
+                 * Parse as much of the input as possible. Returns nullptr
+                 * if everything was parsed, otherwise a pointer to the
+                 * first character this parser can not handle.
+                 */
+                const char* parse() {
+                    while (true) {
+                        const char* const restart = m_ptr;
+                        skip_misc();
+                        if (m_ptr == m_end) {
+                            return nullptr;
+                        }
+                        if (*m_ptr != '<') {
+                            return restart;
+                        }
+                        if (m_ptr[1] == '/') {
+                            // the closing tag of the root element, only
+                            // whitespace and comments may follow
+                            const char* const gt = static_cast<const char*>(std::memchr(m_ptr, '>', static_cast<std::size_t>(m_end - m_ptr)));
+                            if (!gt) {
+                                return restart;
+                            }
+                            m_ptr = const_cast<char*>(gt) + 1;
+                            skip_misc();
+                            return m_ptr == m_end ? nullptr : m_ptr;
+                        }
+
+                        if (at_child_element("node")) {
+                            m_ptr += 5;
+                            if (m_read_types & osmium::osm_entity_bits::node) {
+                                parse_node();
+                            } else {
+                                skip_element();
+                            }
+                        } else if (at_child_element("way")) {
+                            m_ptr += 4;
+                            if (m_read_types & osmium::osm_entity_bits::way) {
+                                parse_way();
+                            } else {
+                                skip_element();
+                            }
+                        } else if (at_child_element("relation")) {
+                            m_ptr += 9;
+                            if (m_read_types & osmium::osm_entity_bits::relation) {
+                                parse_relation();
+                            } else {
+                                skip_element();
+                            }
+                        } else {
+                            // something this parser does not understand,
+                            // for instance a <changeset>
+                            return restart;
+                        }
+                    }
+                }
+
+            }; // class XMLFastSegmentParser
+
+            /**
+             * Parser for XML files. The input is split at the start of
+             * top-level object elements and the pieces are parsed
+             * concurrently on the thread pool, the resulting buffers are
+             * put into the output queue in input order. This works because
+             * a literal '<' is not allowed in XML attribute values or
+             * character data, so a "<node", "<way", "<relation", or
+             * "<changeset" in the input always starts a new object --
+             * except inside comments and CDATA sections, which the scan
+             * for split points tracks and never splits.
+             *
+             * OSM change files can not be split this way, because the
+             * create/modify/delete state would be lost, they are parsed
+             * serially on this thread like files in which no split point
+             * is found.
+             */
+            class XMLParser : public Parser {
+
+                enum : std::size_t {
+                    min_segment_size = 1024ul * 1024ul
+                };
+
+                /// Does an object element start at this position?
+                static bool object_starts_at(const std::string& text, const std::size_t pos) {
+                    static const char* const names[] = {"node", "way", "relation", "changeset"};
+                    for (const char* name : names) {
+                        const std::size_t len = std::strlen(name);
+                        if (text.compare(pos, len, name) == 0 && pos + len < text.size()) {
+                            const char next = text[pos + len];
+                            if (next == ' ' || next == '\t' || next == '\n' || next == '\r' ||
+                                next == '/' || next == '>') {
+                                return true;
+                            }
+                        }
+                    }
+                    return false;
+                }
+
+                /**
+                 * Find the start of the next top-level object element at or
+                 * after the given position. Returns npos if there is none
+                 * (or it is not complete yet at the end of the text).
+                 *
+                 * Comments and CDATA sections may contain anything,
+                 * including something looking like an object element, so
+                 * they are tracked while scanning and never split. The
+                 * scan always starts at the beginning of the text,
+                 * because whether a position is inside such a section
+                 * can not be decided locally; @p from only limits where
+                 * a match is accepted.
+                 */
+                static std::size_t find_object_start(const std::string& text, const std::size_t from) {
+                    for (std::size_t pos = text.find('<', 0);
+                         pos != std::string::npos;
+                         pos = text.find('<', pos + 1)) {
+                        if (text.compare(pos, 4, "<!--") == 0) {
+                            pos = text.find("-->", pos + 4);
+                            if (pos == std::string::npos) {
+                                return std::string::npos; // comment not complete yet
+                            }
+                            pos += 2; // find() below skips the '>'
+                            continue;
+                        }
+                        if (text.compare(pos, 9, "<![CDATA[") == 0) {
+                            pos = text.find("]]>", pos + 9);
+                            if (pos == std::string::npos) {
+                                return std::string::npos; // CDATA section not complete yet
+                            }
+                            pos += 2;
+                            continue;
+                        }
+                        if (pos >= from && object_starts_at(text, pos + 1)) {
+                            return pos;
+                        }
+                    }
+                    return std::string::npos;
+                }
+
+                struct parse_segment_task {
+
+                    std::string segment; // mutated by the in-place tokenizer
+                    osmium::osm_entity_bits::type read_types;
+                    osmium::io::read_discussions read_discussions;
+                    bool last;
+
+                    osmium::memory::Buffer operator()() {
+                        // The hand-written tokenizer parses the object
+                        // elements in place without copying any strings.
+                        osmium::memory::Buffer fast_buffer{segment.size() + 1024,
+                                                           osmium::memory::Buffer::auto_grow::yes};
+                        XMLFastSegmentParser fast_parser{segment, read_types, fast_buffer};
+                        const char* const rest = fast_parser.parse();
+
+                        if (rest == nullptr) {
+                            return fast_buffer;
+                        }
+
+                        // The tokenizer ran into something it does not
+                        // handle. It has not touched the input from that
+                        // point on, so expat can parse the rest. The
+                        // synthetic root element stands in for the real one
+                        // that went to the prologue parser.
+                        std::string input{"<osm version=\"0.6\">"};
+                        input.append(rest, static_cast<std::size_t>(segment.data() + segment.size() - rest));
+
+                        std::vector<osmium::memory::Buffer> full_buffers;
+                        XMLParserCore core{read_types,
+                                           [&full_buffers](osmium::memory::Buffer&& buffer) {
+                                               full_buffers.push_back(std::move(buffer));
+                                           },
+                                           XMLParserCore::header_callback_type{},
+                                           read_discussions,
+                                           input.size() + 1024};
+
+                        core.parse(input, last);
+
+                        osmium::memory::Buffer buffer{core.take_buffer()};
+
+                        // Merge everything into one buffer in input order.
+                        std::size_t total = fast_buffer.committed() + buffer.committed();
+                        for (const auto& full_buffer : full_buffers) {
+                            total += full_buffer.committed();
+                        }
+
+                        osmium::memory::Buffer merged{total, osmium::memory::Buffer::auto_grow::yes};
+                        if (fast_buffer.committed() > 0) {
+                            merged.add_buffer(fast_buffer);
+                        }
+                        for (const auto& full_buffer : full_buffers) {
+                            merged.add_buffer(full_buffer);
+                        }
+                        if (buffer.committed() > 0) {
+                            merged.add_buffer(buffer);
+                        }
+                        merged.commit();
+
+                        return merged;
+                    }
+
+                }; // struct parse_segment_task
+
+                void submit_segment(std::string&& segment, const bool last) {
+                    send_to_output_queue(get_quota().submit(parse_segment_task{std::move(segment), read_types(), read_discussions(), last}));
+                }
+
+                /// Parse everything on this thread like older versions did.
+                void run_serial(const std::string& text, bool done) {
+                    XMLParserCore core{read_types(),
+                                       [this](osmium::memory::Buffer&& buffer) {
+                                           send_to_output_queue(std::move(buffer));
+                                       },
+                                       [this](const osmium::io::Header& header) {
+                                           set_header_value(header);
+                                       },
+                                       read_discussions()};
+
+                    core.parse(text, done);
+
+                    while (!done) {
+                        if (read_types() == osmium::osm_entity_bits::nothing && core.header_is_done()) {
+                            break;
+                        }
+                        const std::string data{get_input()};
+                        done = input_done();
+                        core.parse(data, done);
+                    }
+
+                    set_header_value(core.header());
+
+                    osmium::memory::Buffer buffer{core.take_buffer()};
+                    if (buffer.committed() > 0) {
+                        send_to_output_queue(std::move(buffer));
                     }
                 }
 
@@ -724,21 +1489,61 @@ namespace osmium {
                 void run() final {
                     osmium::thread::set_thread_name("_osmium_xml_in");
 
-                    ExpatXMLParser parser{this};
-
-                    while (!input_done()) {
-                        const std::string data{get_input()};
-                        parser(data, input_done());
-                        if (read_types() == osmium::osm_entity_bits::nothing && header_is_done()) {
+                    // Read input until we find the start of the first object
+                    // element, everything before it is the prologue.
+                    std::string text;
+                    bool done = input_done();
+                    std::size_t first = std::string::npos;
+                    while (true) {
+                        // The scan always starts at the beginning, an
+                        // object element name (or the comment it is in)
+                        // could be cut off at the end of the text.
+                        first = find_object_start(text, 0);
+                        if (first != std::string::npos || done) {
                             break;
                         }
+                        const std::string data{get_input()};
+                        done = input_done();
+                        text += data;
                     }
 
-                    mark_header_as_done();
+                    // Change files need the enclosing create/modify/delete
+                    // sections, so they can not be split.
+                    if (first == std::string::npos ||
+                        text.find("<osmChange") < first ||
+                        read_types() == osmium::osm_entity_bits::nothing) {
+                        run_serial(text, done);
+                        return;
+                    }
+
+                    // Parse the prologue to get the header.
+                    {
+                        XMLParserCore prologue_core{osmium::osm_entity_bits::nothing,
+                                                    XMLParserCore::flush_callback_type{},
+                                                    XMLParserCore::header_callback_type{}};
+                        prologue_core.parse(text.substr(0, first), false);
+                        set_header_value(prologue_core.header());
+                    }
+                    text.erase(0, first);
 
-                    if (m_buffer.committed() > 0) {
-                        send_to_output_queue(std::move(m_buffer));
+                    // Cut the input at object boundaries and let the thread
+                    // pool parse the segments. The bounded output queue
+                    // provides the backpressure.
+                    while (!done) {
+                        const std::string data{get_input()};
+                        done = input_done();
+                        text += data;
+
+                        if (text.size() >= 2 * min_segment_size) {
+                            const std::size_t pos = find_object_start(text, min_segment_size);
+                            if (pos != std::string::npos) {
+                                submit_segment(text.substr(0, pos), false);
+                                text.erase(0, pos);
+                            }
+                        }
                     }
+
+                    submit_segment(std::move(text), true);
                 }
 
             }; // class XMLParser
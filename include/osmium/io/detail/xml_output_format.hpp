@@ -464,7 +464,7 @@ namespace osmium {
                 }
 
                 void write_buffer(osmium::memory::Buffer&& buffer) final {
-                    m_output_queue.push(m_pool.submit(XMLOutputBlock{std::move(buffer), m_options}));
+                    m_output_queue.push(m_pool.submit(osmium::thread::Pool::priority::high, XMLOutputBlock{std::move(buffer), m_options}));
                 }
 
                 void write_end() final {
@@ -33,6 +33,16 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+/**
+ * @file
+ *
+ * Compression/decompression of zlib-format data as used in PBF blobs.
+ * By default this calls stock zlib. Define OSMIUM_WITH_LIBDEFLATE and
+ * link with libdeflate to use the (considerably faster) libdeflate
+ * implementation instead; the format on the wire stays the same, so
+ * the resulting files are fully compatible.
+ */
+
 #include <osmium/io/error.hpp>
 
 #include <protozero/version.hpp>
@@ -43,9 +53,15 @@ DEALINGS IN THE SOFTWARE.
 # include <protozero/types.hpp>
 #endif
 
-#include <zlib.h>
+#ifdef OSMIUM_WITH_LIBDEFLATE
+# include <libdeflate.h>
+# include <memory>
+#else
+# include <zlib.h>
+#endif
 
 #include <cassert>
+#include <cstddef>
 #include <limits>
 #include <string>
 
@@ -55,6 +71,136 @@ namespace osmium {
 
         namespace detail {
 
+#ifdef OSMIUM_WITH_LIBDEFLATE
+
+            // The compression level used with libdeflate, roughly
+            // equivalent to the zlib default.
+            enum {
+                libdeflate_compression_level = 6
+            };
+
+            struct libdeflate_compressor_deleter {
+                void operator()(::libdeflate_compressor* compressor) const noexcept {
+                    ::libdeflate_free_compressor(compressor);
+                }
+            }; // struct libdeflate_compressor_deleter
+
+            struct libdeflate_decompressor_deleter {
+                void operator()(::libdeflate_decompressor* decompressor) const noexcept {
+                    ::libdeflate_free_decompressor(decompressor);
+                }
+            }; // struct libdeflate_decompressor_deleter
+
+            /**
+             * Compress data in zlib format using libdeflate.
+             *
+             * @param input Data to compress.
+             * @returns Compressed data.
+             */
+            inline std::string zlib_compress(const std::string& input) {
+                thread_local std::unique_ptr<::libdeflate_compressor, libdeflate_compressor_deleter> compressor{
+                    ::libdeflate_alloc_compressor(libdeflate_compression_level)};
+
+                if (!compressor) {
+                    throw io_error{"failed to allocate libdeflate compressor"};
+                }
+
+                std::string output(::libdeflate_zlib_compress_bound(compressor.get(), input.size()), '\0');
+
+                const std::size_t result = ::libdeflate_zlib_compress(
+                    compressor.get(),
+                    input.data(),
+                    input.size(),
+                    &*output.begin(),
+                    output.size()
+                );
+
+                if (result == 0) {
+                    throw io_error{"failed to compress data"};
+                }
+
+                output.resize(result);
+
+                return output;
+            }
+
+            /**
+             * Compress data in zlib format using libdeflate directly into
+             * the output string starting at the given offset. Content
+             * before the offset is kept, everything after it is
+             * overwritten and the string is resized to just fit the
+             * compressed data.
+             *
+             * @param input Data to compress.
+             * @param output String the compressed data is written to.
+             * @param offset Offset in the output string to write to.
+             * @returns Size of the compressed data.
+             */
+            inline std::size_t zlib_compress_into(const std::string& input, std::string& output, const std::size_t offset) {
+                thread_local std::unique_ptr<::libdeflate_compressor, libdeflate_compressor_deleter> compressor{
+                    ::libdeflate_alloc_compressor(libdeflate_compression_level)};
+
+                if (!compressor) {
+                    throw io_error{"failed to allocate libdeflate compressor"};
+                }
+
+                output.resize(offset + ::libdeflate_zlib_compress_bound(compressor.get(), input.size()));
+
+                const std::size_t result = ::libdeflate_zlib_compress(
+                    compressor.get(),
+                    input.data(),
+                    input.size(),
+                    &output[offset],
+                    output.size() - offset
+                );
+
+                if (result == 0) {
+                    throw io_error{"failed to compress data"};
+                }
+
+                output.resize(offset + result);
+
+                return result;
+            }
+
+            /**
+             * Uncompress zlib-format data using libdeflate.
+             *
+             * @param input Compressed input data.
+             * @param input_size Size of compressed input data.
+             * @param raw_size Size of uncompressed data.
+             * @param output Uncompressed result data.
+             * @returns Pointer and size to uncompressed data.
+             */
+            inline protozero::data_view zlib_uncompress_string(const char* input, unsigned long input_size, unsigned long raw_size, std::string& output) { // NOLINT(google-runtime-int)
+                thread_local std::unique_ptr<::libdeflate_decompressor, libdeflate_decompressor_deleter> decompressor{
+                    ::libdeflate_alloc_decompressor()};
+
+                if (!decompressor) {
+                    throw io_error{"failed to allocate libdeflate decompressor"};
+                }
+
+                output.resize(raw_size);
+
+                std::size_t actual_size = 0;
+                const auto result = ::libdeflate_zlib_decompress(
+                    decompressor.get(),
+                    input,
+                    input_size,
+                    &*output.begin(),
+                    raw_size,
+                    &actual_size
+                );
+
+                if (result != LIBDEFLATE_SUCCESS || actual_size != raw_size) {
+                    throw io_error{"failed to uncompress data"};
+                }
+
+                return protozero::data_view{output.data(), output.size()};
+            }
+
+#else
+
             /**
              * Compress data using zlib.
              *
@@ -86,6 +232,42 @@ namespace osmium {
                 return output;
             }
 
+            /**
+             * Compress data using zlib directly into the output string
+             * starting at the given offset. Content before the offset is
+             * kept, everything after it is overwritten and the string is
+             * resized to just fit the compressed data.
+             *
+             * Note that this function can not compress data larger than
+             * what fits in an unsigned long, on Windows this is usually 32bit.
+             *
+             * @param input Data to compress.
+             * @param output String the compressed data is written to.
+             * @param offset Offset in the output string to write to.
+             * @returns Size of the compressed data.
+             */
+            inline std::size_t zlib_compress_into(const std::string& input, std::string& output, const std::size_t offset) {
+                assert(input.size() < std::numeric_limits<unsigned long>::max());
+                unsigned long output_size = ::compressBound(static_cast<unsigned long>(input.size())); // NOLINT(google-runtime-int)
+
+                output.resize(offset + output_size);
+
+                const auto result = ::compress(
+                    reinterpret_cast<unsigned char*>(&output[offset]),
+                    &output_size,
+                    reinterpret_cast<const unsigned char*>(input.data()),
+                    static_cast<unsigned long>(input.size()) // NOLINT(google-runtime-int)
+                );
+
+                if (result != Z_OK) {
+                    throw io_error{std::string{"failed to compress data: "} + zError(result)};
+                }
+
+                output.resize(offset + output_size);
+
+                return output_size;
+            }
+
             /**
              * Uncompress data using zlib.
              *
@@ -114,6 +296,8 @@ namespace osmium {
                 return protozero::data_view{output.data(), output.size()};
             }
 
+#endif
+
         } // namespace detail
 
     } // namespace io
@@ -191,6 +191,12 @@ namespace osmium {
                 } else if (suffixes.back() == "bz2") {
                     m_file_compression = file_compression::bzip2;
                     suffixes.pop_back();
+                } else if (suffixes.back() == "zst") {
+                    m_file_compression = file_compression::zstd;
+                    suffixes.pop_back();
+                } else if (suffixes.back() == "lz4") {
+                    m_file_compression = file_compression::lz4;
+                    suffixes.pop_back();
                 }
 
                 if (suffixes.empty()) {
@@ -56,6 +56,21 @@ namespace osmium {
             yes = 1
         };
 
+        enum class read_visible {
+            all  = 0,
+            only = 1
+        };
+
+        enum class read_discussions {
+            no  = 0,
+            yes = 1
+        };
+
+        enum class mmap_input {
+            no  = 0,
+            yes = 1
+        };
+
         inline const char* as_string(const file_format format) noexcept {
             switch (format) {
                 case file_format::xml:
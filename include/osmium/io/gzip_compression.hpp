@@ -40,6 +40,10 @@ DEALINGS IN THE SOFTWARE.
  * files.
  *
  * @attention If you include this file, you'll need to link with `libz`.
+ *
+ * @attention Define `OSMIUM_WITH_PARALLEL_GZIP` if you want gzip files
+ *            to be written with the multithreaded ParallelGzipCompressor
+ *            instead of the single-threaded GzipCompressor.
  */
 
 #include <osmium/io/compression.hpp>
@@ -49,6 +53,10 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/writer_options.hpp>
 #include <osmium/util/compatibility.hpp>
 
+#ifdef OSMIUM_WITH_PARALLEL_GZIP
+# include <osmium/thread/pool.hpp>
+#endif
+
 #include <zlib.h>
 
 #include <cassert>
@@ -57,6 +65,13 @@ DEALINGS IN THE SOFTWARE.
 #include <limits>
 #include <string>
 
+#ifdef OSMIUM_WITH_PARALLEL_GZIP
+# include <chrono>
+# include <future>
+# include <queue>
+# include <utility>
+#endif
+
 #ifndef _MSC_VER
 # include <unistd.h>
 #endif
@@ -169,6 +184,182 @@ namespace osmium {
 
         }; // class GzipCompressor
 
+#ifdef OSMIUM_WITH_PARALLEL_GZIP
+
+        /**
+         * Multithreaded gzip compressor modelled after the pigz program.
+         * The data is cut into chunks which are compressed as independent
+         * deflate blocks on the shared thread pool. Each chunk (except the
+         * last one) ends with an empty stored block aligned on a byte
+         * boundary, so the compressed chunks can simply be concatenated in
+         * order into a single valid gzip stream. To keep the compression
+         * ratio up, each chunk is primed with the last 32 kByte of the
+         * preceding chunk as a preset dictionary.
+         */
+        class ParallelGzipCompressor : public Compressor {
+
+            enum : std::size_t {
+                chunk_size = 128u * 1024u,
+                dictionary_size = 32u * 1024u,
+                max_queued_chunks = 16u
+            };
+
+            struct compressed_chunk {
+                std::string data{};
+                unsigned long crc32 = 0; // NOLINT(google-runtime-int)
+                std::size_t size = 0;
+            };
+
+            std::queue<std::future<compressed_chunk>> m_results{};
+            std::string m_pending{};
+            std::string m_dictionary{};
+            osmium::thread::Pool& m_pool;
+            unsigned long m_crc32 = ::crc32(0, nullptr, 0); // NOLINT(google-runtime-int)
+            std::size_t m_size = 0;
+            int m_fd;
+            bool m_closed = false;
+
+            static compressed_chunk deflate_chunk(const std::string& input, const std::string& dictionary, const bool last) {
+                z_stream zstream{};
+                int result = deflateInit2(&zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+                if (result != Z_OK) {
+                    throw osmium::gzip_error{"gzip error: compression init failed", result};
+                }
+
+                if (!dictionary.empty()) {
+                    assert(dictionary.size() < std::numeric_limits<unsigned int>::max());
+                    deflateSetDictionary(&zstream, reinterpret_cast<const unsigned char*>(dictionary.data()), static_cast<unsigned int>(dictionary.size()));
+                }
+
+                compressed_chunk chunk;
+                chunk.crc32 = ::crc32(0, reinterpret_cast<const unsigned char*>(input.data()), static_cast<unsigned int>(input.size()));
+                chunk.size = input.size();
+
+                // The bound is for a complete deflate stream, an empty
+                // stored block for the sync flush needs a few bytes more.
+                chunk.data.resize(::deflateBound(&zstream, static_cast<unsigned long>(input.size())) + 16u); // NOLINT(google-runtime-int)
+
+                assert(input.size() < std::numeric_limits<unsigned int>::max());
+                zstream.next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(input.data()));
+                zstream.avail_in = static_cast<unsigned int>(input.size());
+                zstream.next_out = reinterpret_cast<unsigned char*>(&*chunk.data.begin());
+                zstream.avail_out = static_cast<unsigned int>(chunk.data.size());
+
+                result = ::deflate(&zstream, last ? Z_FINISH : Z_SYNC_FLUSH);
+                deflateEnd(&zstream);
+                if (result != (last ? Z_STREAM_END : Z_OK)) {
+                    throw osmium::gzip_error{"gzip error: deflate failed", result};
+                }
+
+                chunk.data.resize(chunk.data.size() - zstream.avail_out);
+                return chunk;
+            }
+
+            struct deflate_task {
+
+                std::string input;
+                std::string dictionary;
+                bool last;
+
+                compressed_chunk operator()() const {
+                    return deflate_chunk(input, dictionary, last);
+                }
+
+            }; // struct deflate_task
+
+            void submit_chunk(std::string&& input, const bool last) {
+                std::string dictionary{std::move(m_dictionary)};
+                if (input.size() >= dictionary_size) {
+                    m_dictionary = input.substr(input.size() - dictionary_size);
+                }
+                m_results.push(m_pool.submit(osmium::thread::Pool::priority::high, deflate_task{std::move(input), std::move(dictionary), last}));
+            }
+
+            /**
+             * Write all finished chunks in submission order to the output
+             * file. Blocks when too many chunks are in flight or when all
+             * outstanding chunks are needed (on close).
+             */
+            void write_finished_chunks(const bool all) {
+                while (!m_results.empty() &&
+                       (all || m_results.size() > max_queued_chunks ||
+                        m_results.front().wait_for(std::chrono::seconds::zero()) == std::future_status::ready)) {
+                    const compressed_chunk chunk = m_results.front().get();
+                    m_results.pop();
+                    osmium::io::detail::reliable_write(m_fd, chunk.data.data(), chunk.data.size());
+                    m_crc32 = ::crc32_combine(m_crc32, chunk.crc32, static_cast<z_off_t>(chunk.size));
+                    m_size += chunk.size;
+                }
+            }
+
+        public:
+
+            explicit ParallelGzipCompressor(const int fd, const fsync sync) :
+                Compressor(sync),
+                m_pool(osmium::thread::Pool::default_instance()),
+                m_fd(fd) {
+                static const unsigned char gzip_header[10] = {
+                    0x1f, 0x8b, // magic
+                    8,          // deflate
+                    0,          // flags
+                    0, 0, 0, 0, // mtime
+                    0,          // extra flags
+                    3           // OS: unix
+                };
+                osmium::io::detail::reliable_write(m_fd, gzip_header, sizeof(gzip_header));
+            }
+
+            ParallelGzipCompressor(const ParallelGzipCompressor&) = delete;
+            ParallelGzipCompressor& operator=(const ParallelGzipCompressor&) = delete;
+
+            ParallelGzipCompressor(ParallelGzipCompressor&&) = delete;
+            ParallelGzipCompressor& operator=(ParallelGzipCompressor&&) = delete;
+
+            ~ParallelGzipCompressor() noexcept final {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            void write(const std::string& data) final {
+                m_pending += data;
+                while (m_pending.size() >= chunk_size) {
+                    submit_chunk(m_pending.substr(0, chunk_size), false);
+                    m_pending.erase(0, chunk_size);
+                }
+                write_finished_chunks(false);
+            }
+
+            void close() final {
+                if (m_closed) {
+                    return;
+                }
+                m_closed = true;
+
+                // The last chunk is compressed even when it is empty,
+                // because the stream needs a final deflate block.
+                submit_chunk(std::move(m_pending), true);
+                write_finished_chunks(true);
+
+                unsigned char trailer[8];
+                for (int i = 0; i < 4; ++i) {
+                    trailer[i] = static_cast<unsigned char>((m_crc32 >> (i * 8)) & 0xffu);
+                    trailer[i + 4] = static_cast<unsigned char>((m_size >> (i * 8)) & 0xffu);
+                }
+                osmium::io::detail::reliable_write(m_fd, trailer, sizeof(trailer));
+
+                if (do_fsync()) {
+                    osmium::io::detail::reliable_fsync(m_fd);
+                }
+                osmium::io::detail::reliable_close(m_fd);
+            }
+
+        }; // class ParallelGzipCompressor
+
+#endif
+
         class GzipDecompressor : public Decompressor {
 
             gzFile m_gzfile = nullptr;
@@ -315,7 +506,11 @@ namespace osmium {
             // we want the register_compression() function to run, setting
             // the variable is only a side-effect, it will never be used
             const bool registered_gzip_compression = osmium::io::CompressionFactory::instance().register_compression(osmium::io::file_compression::gzip,
+#ifdef OSMIUM_WITH_PARALLEL_GZIP
+                [](const int fd, const fsync sync) { return new osmium::io::ParallelGzipCompressor{fd, sync}; },
+#else
                 [](const int fd, const fsync sync) { return new osmium::io::GzipCompressor{fd, sync}; },
+#endif
                 [](const int fd) { return new osmium::io::GzipDecompressor{fd}; },
                 [](const char* buffer, const std::size_t size) { return new osmium::io::GzipBufferDecompressor{buffer, size}; }
             );
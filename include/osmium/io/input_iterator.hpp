@@ -170,6 +170,125 @@ namespace osmium {
             return InputIteratorRange<TSource, TItem>{it_type{source}, it_type{}};
         }
 
+        /**
+         * This iterator class allows you to iterate over the buffers of
+         * a source (usually an osmium::io::Reader). Unlike the
+         * InputIterator it does no per-object bookkeeping: each
+         * increment is one call to read() on the source, and the
+         * contents of the buffer can then be iterated with the plain
+         * ItemIterator ranges of the buffer.
+         *
+         * This is a move-only single-pass input iterator, usually used
+         * through osmium::io::buffers().
+         */
+        template <typename TSource>
+        class BufferIterator {
+
+            TSource* m_source;
+            osmium::memory::Buffer m_buffer{};
+
+            void next_buffer() {
+                m_buffer = m_source->read();
+                if (!m_buffer) { // end of input
+                    m_source = nullptr;
+                }
+            }
+
+        public:
+
+            using iterator_category = std::input_iterator_tag;
+            using value_type        = osmium::memory::Buffer;
+            using difference_type   = ptrdiff_t;
+            using pointer           = value_type*;
+            using reference         = value_type&;
+
+            explicit BufferIterator(TSource& source) :
+                m_source(&source) {
+                next_buffer();
+            }
+
+            // end iterator
+            BufferIterator() noexcept :
+                m_source(nullptr) {
+            }
+
+            BufferIterator(const BufferIterator&) = delete;
+            BufferIterator& operator=(const BufferIterator&) = delete;
+
+            BufferIterator(BufferIterator&&) noexcept = default;
+            BufferIterator& operator=(BufferIterator&&) noexcept = default;
+
+            ~BufferIterator() noexcept = default;
+
+            BufferIterator& operator++() {
+                assert(m_source);
+                next_buffer();
+                return *this;
+            }
+
+            bool operator==(const BufferIterator& rhs) const noexcept {
+                return m_source == rhs.m_source;
+            }
+
+            bool operator!=(const BufferIterator& rhs) const noexcept {
+                return !(*this == rhs);
+            }
+
+            reference operator*() noexcept {
+                assert(m_source);
+                return m_buffer;
+            }
+
+            pointer operator->() noexcept {
+                assert(m_source);
+                return &m_buffer;
+            }
+
+        }; // class BufferIterator
+
+        template <typename TSource>
+        class BufferRange {
+
+            TSource* m_source;
+
+        public:
+
+            explicit BufferRange(TSource& source) noexcept :
+                m_source(&source) {
+            }
+
+            /// Note that this reads the first buffer from the source.
+            BufferIterator<TSource> begin() const {
+                return BufferIterator<TSource>{*m_source};
+            }
+
+            BufferIterator<TSource> end() const noexcept {
+                return BufferIterator<TSource>{};
+            }
+
+        }; // class BufferRange
+
+        /**
+         * Iterate over the committed buffers of a source (usually an
+         * osmium::io::Reader) with a range-based for loop. The buffers
+         * are consumed while iterating, so this is a single pass over
+         * the source:
+         *
+         * @code
+         * osmium::io::Reader reader{"input.osm.pbf"};
+         * for (auto& buffer : osmium::io::buffers(reader)) {
+         *     osmium::apply(buffer, check_order); // optional handlers
+         *     for (const auto& node : buffer.select<osmium::Node>()) {
+         *         ...
+         *     }
+         * }
+         * @endcode
+         */
+        template <typename TSource>
+        BufferRange<TSource> buffers(TSource& source) noexcept {
+            return BufferRange<TSource>{source};
+        }
+
     } // namespace io
 
 } // namespace osmium
@@ -0,0 +1,323 @@
+#ifndef OSMIUM_IO_LZ4_COMPRESSION_HPP
+#define OSMIUM_IO_LZ4_COMPRESSION_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Include this file if you want to read or write lz4-compressed OSM
+ * files (`.opl.lz4` and similar) in the lz4 frame format as written
+ * by the lz4 command line program. The very fast decompression makes
+ * lz4 a good fit for intermediate files in processing pipelines.
+ *
+ * @attention If you include this file, you'll need to link with
+ *            `liblz4`.
+ */
+
+#include <osmium/io/compression.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/io/file_compression.hpp>
+#include <osmium/io/writer_options.hpp>
+
+#include <lz4frame.h>
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+
+namespace osmium {
+
+    /**
+     * Exception thrown when there are problems compressing or
+     * decompressing lz4 files.
+     */
+    struct lz4_error : public io_error {
+
+        std::size_t lz4_error_code = 0;
+
+        lz4_error(const std::string& what, const std::size_t error_code) :
+            io_error(what + ": " + LZ4F_getErrorName(error_code)),
+            lz4_error_code(error_code) {
+        }
+
+        explicit lz4_error(const std::string& what) :
+            io_error(what) {
+        }
+
+    }; // struct lz4_error
+
+    namespace io {
+
+        namespace detail {
+
+            inline std::size_t check_lz4_result(const std::size_t result, const char* msg) {
+                if (LZ4F_isError(result)) {
+                    throw osmium::lz4_error{std::string{"lz4 error: "} + msg, result};
+                }
+                return result;
+            }
+
+        } // namespace detail
+
+        class LZ4Compressor : public Compressor {
+
+            std::string m_output{};
+            LZ4F_compressionContext_t m_cctx{};
+            int m_fd;
+
+        public:
+
+            explicit LZ4Compressor(const int fd, const fsync sync) :
+                Compressor(sync),
+                m_fd(fd) {
+                detail::check_lz4_result(
+                    LZ4F_createCompressionContext(&m_cctx, LZ4F_VERSION),
+                    "compression init failed");
+
+                m_output.resize(LZ4F_HEADER_SIZE_MAX);
+                const std::size_t header_size = detail::check_lz4_result(
+                    LZ4F_compressBegin(m_cctx, &*m_output.begin(), m_output.size(), nullptr),
+                    "write open failed");
+                osmium::io::detail::reliable_write(m_fd, m_output.data(), header_size);
+            }
+
+            LZ4Compressor(const LZ4Compressor&) = delete;
+            LZ4Compressor& operator=(const LZ4Compressor&) = delete;
+
+            LZ4Compressor(LZ4Compressor&&) = delete;
+            LZ4Compressor& operator=(LZ4Compressor&&) = delete;
+
+            ~LZ4Compressor() noexcept final {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+                LZ4F_freeCompressionContext(m_cctx);
+            }
+
+            void write(const std::string& data) final {
+                assert(m_fd >= 0);
+                if (data.empty()) {
+                    return;
+                }
+
+                m_output.resize(LZ4F_compressBound(data.size(), nullptr));
+                const std::size_t size = detail::check_lz4_result(
+                    LZ4F_compressUpdate(m_cctx, &*m_output.begin(), m_output.size(), data.data(), data.size(), nullptr),
+                    "write failed");
+                if (size > 0) {
+                    osmium::io::detail::reliable_write(m_fd, m_output.data(), size);
+                }
+            }
+
+            void close() final {
+                if (m_fd >= 0) {
+                    const int fd = m_fd;
+                    m_output.resize(LZ4F_compressBound(0, nullptr));
+                    const std::size_t size = detail::check_lz4_result(
+                        LZ4F_compressEnd(m_cctx, &*m_output.begin(), m_output.size(), nullptr),
+                        "write close failed");
+                    osmium::io::detail::reliable_write(fd, m_output.data(), size);
+                    m_fd = -1;
+                    if (do_fsync()) {
+                        osmium::io::detail::reliable_fsync(fd);
+                    }
+                    osmium::io::detail::reliable_close(fd);
+                }
+            }
+
+        }; // class LZ4Compressor
+
+        class LZ4Decompressor : public Decompressor {
+
+            std::string m_input{};
+            LZ4F_decompressionContext_t m_dctx{};
+            std::size_t m_input_pos = 0;
+            std::size_t m_offset = 0;
+            int m_fd;
+            bool m_eof = false;
+
+        public:
+
+            explicit LZ4Decompressor(const int fd) :
+                m_fd(fd) {
+                const std::size_t result = LZ4F_createDecompressionContext(&m_dctx, LZ4F_VERSION);
+                if (LZ4F_isError(result)) {
+                    osmium::io::detail::reliable_close(fd);
+                    throw osmium::lz4_error{"lz4 error: decompression init failed", result};
+                }
+            }
+
+            LZ4Decompressor(const LZ4Decompressor&) = delete;
+            LZ4Decompressor& operator=(const LZ4Decompressor&) = delete;
+
+            LZ4Decompressor(LZ4Decompressor&&) = delete;
+            LZ4Decompressor& operator=(LZ4Decompressor&&) = delete;
+
+            ~LZ4Decompressor() noexcept final {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+                LZ4F_freeDecompressionContext(m_dctx);
+            }
+
+            std::string read() final {
+                std::string output;
+
+                while (output.empty() && !(m_eof && m_input_pos == m_input.size())) {
+                    if (m_input_pos == m_input.size()) {
+                        m_input.resize(osmium::io::Decompressor::input_buffer_size);
+                        const auto nread = osmium::io::detail::reliable_read(m_fd, &*m_input.begin(), osmium::io::Decompressor::input_buffer_size);
+                        m_input.resize(static_cast<std::string::size_type>(nread));
+                        m_input_pos = 0;
+                        if (nread == 0) {
+                            m_eof = true;
+                            break;
+                        }
+                    }
+
+                    output.resize(osmium::io::Decompressor::input_buffer_size);
+                    std::size_t dst_size = output.size();
+                    std::size_t src_size = m_input.size() - m_input_pos;
+
+                    detail::check_lz4_result(
+                        LZ4F_decompress(m_dctx, &*output.begin(), &dst_size, m_input.data() + m_input_pos, &src_size, nullptr),
+                        "read failed");
+
+                    m_input_pos += src_size;
+                    m_offset += src_size;
+                    output.resize(dst_size);
+                }
+
+                set_offset(m_offset);
+
+                return output;
+            }
+
+            void close() final {
+                if (m_fd >= 0) {
+                    const int fd = m_fd;
+                    m_fd = -1;
+                    osmium::io::detail::reliable_close(fd);
+                }
+            }
+
+        }; // class LZ4Decompressor
+
+        class LZ4BufferDecompressor : public Decompressor {
+
+            LZ4F_decompressionContext_t m_dctx{};
+            const char* m_buffer;
+            std::size_t m_buffer_size;
+            std::size_t m_buffer_pos = 0;
+
+        public:
+
+            LZ4BufferDecompressor(const char* buffer, const std::size_t size) :
+                m_buffer(buffer),
+                m_buffer_size(size) {
+                detail::check_lz4_result(
+                    LZ4F_createDecompressionContext(&m_dctx, LZ4F_VERSION),
+                    "decompression init failed");
+            }
+
+            LZ4BufferDecompressor(const LZ4BufferDecompressor&) = delete;
+            LZ4BufferDecompressor& operator=(const LZ4BufferDecompressor&) = delete;
+
+            LZ4BufferDecompressor(LZ4BufferDecompressor&&) = delete;
+            LZ4BufferDecompressor& operator=(LZ4BufferDecompressor&&) = delete;
+
+            ~LZ4BufferDecompressor() noexcept final {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+                LZ4F_freeDecompressionContext(m_dctx);
+            }
+
+            std::string read() final {
+                std::string output;
+
+                if (m_buffer_pos < m_buffer_size) {
+                    output.resize(osmium::io::Decompressor::input_buffer_size);
+                    std::size_t dst_size = output.size();
+                    std::size_t src_size = m_buffer_size - m_buffer_pos;
+
+                    detail::check_lz4_result(
+                        LZ4F_decompress(m_dctx, &*output.begin(), &dst_size, m_buffer + m_buffer_pos, &src_size, nullptr),
+                        "read failed");
+
+                    if (src_size == 0 && dst_size == 0) {
+                        throw osmium::lz4_error{"lz4 error: read failed: truncated input"};
+                    }
+
+                    m_buffer_pos += src_size;
+                    output.resize(dst_size);
+                }
+
+                return output;
+            }
+
+            void close() final {
+            }
+
+        }; // class LZ4BufferDecompressor
+
+        namespace detail {
+
+            // we want the register_compression() function to run, setting
+            // the variable is only a side-effect, it will never be used
+            const bool registered_lz4_compression = osmium::io::CompressionFactory::instance().register_compression(osmium::io::file_compression::lz4,
+                [](const int fd, const fsync sync) { return new osmium::io::LZ4Compressor{fd, sync}; },
+                [](const int fd) { return new osmium::io::LZ4Decompressor{fd}; },
+                [](const char* buffer, const std::size_t size) { return new osmium::io::LZ4BufferDecompressor{buffer, size}; }
+            );
+
+            // dummy function to silence the unused variable warning from above
+            inline bool get_registered_lz4_compression() noexcept {
+                return registered_lz4_compression;
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_LZ4_COMPRESSION_HPP
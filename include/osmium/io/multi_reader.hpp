@@ -0,0 +1,319 @@
+#ifndef OSMIUM_IO_MULTI_READER_HPP
+#define OSMIUM_IO_MULTI_READER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/file.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item_iterator.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/object_comparisons.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Read from several OSM files at the same time. One Reader per
+         * file is created, so the blobs of all files are decoded
+         * concurrently on the shared thread pool. A single Reader can
+         * only keep a limited number of decode tasks in flight, with
+         * several files the pipelines add up and more cores can be
+         * used.
+         *
+         * In mode::concatenate (the default) the contents of the files
+         * are delivered one file after the other. In mode::merge the
+         * objects of all files are merged into new buffers ordered by
+         * osmium::object_order_type_id_reverse_version; for this to
+         * result in a fully ordered stream each input file must already
+         * be ordered this way. The merge uses a loser tree over the
+         * inputs, so each object costs only log2(number of files)
+         * comparisons no matter how many files there are.
+         *
+         * mode::merge_unique works like mode::merge, but when several
+         * objects have the same type and id only the first one, ie the
+         * one with the highest version, is delivered. Use this to
+         * merge files with overlapping contents or to squash a history
+         * stream down to the newest versions.
+         *
+         * Takes the same optional arguments as the Reader and hands
+         * them to every Reader it creates.
+         */
+        class MultiReader {
+
+        public:
+
+            enum class mode {
+                concatenate  = 0,
+                merge        = 1,
+                merge_unique = 2
+            };
+
+        private:
+
+            enum {
+                initial_merge_buffer_size = 1024ul * 1024ul
+            };
+
+            /**
+             * One input file with the buffer currently read from it and
+             * an iterator to the current object in that buffer.
+             */
+            struct source {
+
+                std::unique_ptr<Reader> reader;
+                osmium::memory::Buffer buffer{};
+                osmium::memory::ItemIterator<const osmium::OSMObject> it{};
+                osmium::memory::ItemIterator<const osmium::OSMObject> end{};
+                bool done = false;
+
+                explicit source(std::unique_ptr<Reader>&& r) :
+                    reader(std::move(r)) {
+                }
+
+                /**
+                 * Make sure the iterator points at an object, reading
+                 * the next buffer(s) from the file if needed.
+                 *
+                 * @returns Is there a current object?
+                 */
+                bool ensure_data() {
+                    if (done) {
+                        return false;
+                    }
+                    while (it == end) {
+                        buffer = reader->read();
+                        if (!buffer) {
+                            done = true;
+                            return false;
+                        }
+                        it = buffer.cbegin<osmium::OSMObject>();
+                        end = buffer.cend<osmium::OSMObject>();
+                    }
+                    return true;
+                }
+
+            }; // struct source
+
+            std::vector<source> m_sources;
+
+            /**
+             * Loser tree over the sources. m_tree[0] holds the index of
+             * the source with the smallest current object, m_tree[1] to
+             * m_tree[k-1] are the internal tournament nodes holding the
+             * indexes of the sources that lost there.
+             */
+            std::vector<std::size_t> m_tree{};
+
+            mode m_mode;
+
+            std::size_t m_next = 0; // index of the file currently delivered in mode::concatenate
+
+            // type and id of the last object delivered in mode::merge_unique
+            osmium::item_type m_last_type = osmium::item_type::undefined;
+            osmium::object_id_type m_last_id = 0;
+
+            bool m_have_last = false;
+
+            bool m_eof = false;
+
+            osmium::memory::Buffer read_concatenated() {
+                while (m_next < m_sources.size()) {
+                    osmium::memory::Buffer buffer{m_sources[m_next].reader->read()};
+                    if (buffer) {
+                        return buffer;
+                    }
+                    ++m_next;
+                }
+                m_eof = true;
+                return osmium::memory::Buffer{};
+            }
+
+            enum : std::size_t {
+                empty_node = std::numeric_limits<std::size_t>::max()
+            };
+
+            /**
+             * Does the current object of source a come before the one
+             * of source b? Exhausted sources lose against everything,
+             * so they sink to the bottom of the tree.
+             */
+            bool source_wins(const std::size_t a, const std::size_t b) {
+                if (!m_sources[a].ensure_data()) {
+                    return false;
+                }
+                if (!m_sources[b].ensure_data()) {
+                    return true;
+                }
+                const osmium::object_order_type_id_reverse_version order{};
+                return order(*m_sources[a].it, *m_sources[b].it);
+            }
+
+            /**
+             * Replay the tournament on the path from the given source
+             * to the root: at every node the winner moves up and the
+             * loser stays. Used both to build the tree (then empty
+             * nodes just take the current winner) and to find the new
+             * overall winner after the old one advanced.
+             */
+            void replay(const std::size_t leaf) {
+                std::size_t winner = leaf;
+                for (std::size_t node = (leaf + m_sources.size()) >> 1u; node > 0; node >>= 1u) {
+                    if (m_tree[node] == empty_node) {
+                        m_tree[node] = winner;
+                        return;
+                    }
+                    if (source_wins(m_tree[node], winner)) {
+                        std::swap(winner, m_tree[node]);
+                    }
+                }
+                m_tree[0] = winner;
+            }
+
+            osmium::memory::Buffer read_merged() {
+                if (m_tree.empty()) {
+                    m_tree.assign(m_sources.size() > 1 ? m_sources.size() : 1, empty_node);
+                    for (std::size_t i = 0; i < m_sources.size(); ++i) {
+                        replay(i);
+                    }
+                }
+
+                osmium::memory::Buffer buffer{initial_merge_buffer_size, osmium::memory::Buffer::auto_grow::yes};
+
+                while (buffer.committed() < initial_merge_buffer_size) {
+                    source& next_source = m_sources[m_tree[0]];
+                    if (!next_source.ensure_data()) {
+                        // the overall winner is exhausted, so all
+                        // other sources are, too
+                        m_eof = true;
+                        break;
+                    }
+
+                    const osmium::OSMObject& object = *next_source.it;
+                    if (m_mode != mode::merge_unique || !m_have_last ||
+                        object.type() != m_last_type || object.id() != m_last_id) {
+                        buffer.add_item(object);
+                        buffer.commit();
+                        m_last_type = object.type();
+                        m_last_id = object.id();
+                        m_have_last = true;
+                    }
+
+                    ++next_source.it;
+                    replay(m_tree[0]);
+                }
+
+                if (buffer.committed() == 0) {
+                    return osmium::memory::Buffer{};
+                }
+
+                return buffer;
+            }
+
+        public:
+
+            /**
+             * Create a MultiReader reading from the given files.
+             *
+             * @param files The files to open.
+             * @param merge_mode Concatenate or merge the file contents.
+             * @param args Any further arguments are given to every
+             *             Reader created, see the Reader constructor
+             *             for the available options.
+             */
+            template <typename... TArgs>
+            explicit MultiReader(const std::vector<osmium::io::File>& files, const mode merge_mode, TArgs&&... args) :
+                m_mode(merge_mode) {
+                m_sources.reserve(files.size());
+                for (const auto& file : files) {
+                    m_sources.emplace_back(std::unique_ptr<Reader>{new Reader{file, args...}});
+                }
+            }
+
+            template <typename... TArgs>
+            explicit MultiReader(const std::vector<osmium::io::File>& files, TArgs&&... args) :
+                MultiReader(files, mode::concatenate, std::forward<TArgs>(args)...) {
+            }
+
+            /**
+             * Reads the next buffer from the input files. An invalid
+             * buffer signals end-of-file, ie all files are exhausted.
+             *
+             * @throws Some form of osmium::io_error if there is an error.
+             */
+            osmium::memory::Buffer read() {
+                if (m_eof || m_sources.empty()) {
+                    m_eof = true;
+                    return osmium::memory::Buffer{};
+                }
+
+                if (m_mode == mode::concatenate) {
+                    return read_concatenated();
+                }
+                return read_merged();
+            }
+
+            /**
+             * Have all files been read to the end?
+             */
+            bool eof() const noexcept {
+                return m_eof;
+            }
+
+            /**
+             * Close down all Readers. A call to this is optional,
+             * destruction closes them, too, but only a call to close()
+             * can report errors.
+             *
+             * @throws Some form of osmium::io_error when there is a problem.
+             */
+            void close() {
+                for (auto& s : m_sources) {
+                    s.reader->close();
+                }
+            }
+
+        }; // class MultiReader
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_MULTI_READER_HPP
@@ -0,0 +1,226 @@
+#ifndef OSMIUM_IO_MULTI_WRITER_HPP
+#define OSMIUM_IO_MULTI_WRITER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/file.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Write to several OSM files at the same time, splitting one
+         * input stream over many outputs in a single pass. One Writer
+         * per file is created, so encoding and compression for all
+         * outputs run concurrently on the shared thread pool. A routing
+         * function decides for each object which of the outputs it goes
+         * to; objects going to several outputs are copied once per
+         * output.
+         *
+         * Because all routing happens on the calling thread, a stalled
+         * output throttles the whole split through the back-pressure of
+         * its Writer, so memory use stays bounded no matter how many
+         * outputs there are.
+         *
+         * Takes the same optional arguments as the Writer and hands
+         * them to every Writer it creates.
+         */
+        class MultiWriter {
+
+        public:
+
+            /**
+             * The type of the routing function. It is called once for
+             * every object with the (cleared) vector of target indexes
+             * as second argument. Append the index of every output file
+             * the object should go to; leave the vector empty to drop
+             * the object.
+             */
+            using routing_type = std::function<void(const osmium::OSMObject&, std::vector<std::size_t>&)>;
+
+        private:
+
+            enum {
+                // Smaller than the default buffer size of the Writer,
+                // because there is one staging buffer per output file
+                // and splits into hundreds of files are common.
+                default_buffer_size = 1024ul * 1024ul
+            };
+
+            /**
+             * One output file with the staging buffer for the objects
+             * routed to it.
+             */
+            struct target {
+
+                std::unique_ptr<Writer> writer;
+                osmium::memory::Buffer buffer{};
+
+                explicit target(std::unique_ptr<Writer>&& w) :
+                    writer(std::move(w)) {
+                }
+
+            }; // struct target
+
+            std::vector<target> m_targets;
+
+            routing_type m_router;
+
+            std::vector<std::size_t> m_indexes{};
+
+            std::size_t m_buffer_size = default_buffer_size;
+
+            void flush_target(target& t) {
+                if (t.buffer && t.buffer.committed() > 0) {
+                    osmium::memory::Buffer buffer{m_buffer_size,
+                                                  osmium::memory::Buffer::auto_grow::no};
+                    using std::swap;
+                    swap(t.buffer, buffer);
+
+                    (*t.writer)(std::move(buffer));
+                }
+            }
+
+            void add_to_target(target& t, const osmium::OSMObject& object) {
+                if (!t.buffer) {
+                    t.buffer = osmium::memory::Buffer{m_buffer_size,
+                                                      osmium::memory::Buffer::auto_grow::no};
+                }
+                try {
+                    t.buffer.push_back(object);
+                } catch (const osmium::buffer_is_full&) {
+                    flush_target(t);
+                    t.buffer.push_back(object);
+                }
+            }
+
+        public:
+
+            /**
+             * Create a MultiWriter writing to the given files.
+             *
+             * @param files The files to open.
+             * @param router The routing function, see routing_type.
+             * @param args Any further arguments are given to every
+             *             Writer created, see the Writer constructor
+             *             for the available options.
+             */
+            template <typename... TArgs>
+            explicit MultiWriter(const std::vector<osmium::io::File>& files, routing_type router, TArgs&&... args) :
+                m_router(std::move(router)) {
+                m_targets.reserve(files.size());
+                for (const auto& file : files) {
+                    m_targets.emplace_back(std::unique_ptr<Writer>{new Writer{file, args...}});
+                }
+            }
+
+            /**
+             * The number of output files.
+             */
+            std::size_t size() const noexcept {
+                return m_targets.size();
+            }
+
+            /**
+             * Route a single object to the output files chosen by the
+             * routing function.
+             *
+             * @throws Some form of osmium::io_error when there is a problem.
+             */
+            void operator()(const osmium::OSMObject& object) {
+                m_indexes.clear();
+                m_router(object, m_indexes);
+                for (const auto index : m_indexes) {
+                    assert(index < m_targets.size());
+                    add_to_target(m_targets[index], object);
+                }
+            }
+
+            /**
+             * Route all objects in the given buffer to the output files
+             * chosen by the routing function. Unlike with the Writer the
+             * buffer contents are copied, so the buffer stays usable.
+             *
+             * @throws Some form of osmium::io_error when there is a problem.
+             */
+            void operator()(const osmium::memory::Buffer& buffer) {
+                for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                    operator()(object);
+                }
+            }
+
+            /**
+             * Flush the staging buffers of all output files. This is
+             * usually not needed as the buffers get flushed on close()
+             * automatically.
+             *
+             * @throws Some form of osmium::io_error when there is a problem.
+             */
+            void flush() {
+                for (auto& t : m_targets) {
+                    flush_target(t);
+                }
+            }
+
+            /**
+             * Flushes all staging buffers and closes all output files.
+             * If you do not call this, the destructors of the Writers
+             * will also do the same thing, but will ignore any errors.
+             *
+             * @throws Some form of osmium::io_error when there is a problem.
+             */
+            void close() {
+                for (auto& t : m_targets) {
+                    flush_target(t);
+                    t.writer->close();
+                }
+            }
+
+        }; // class MultiWriter
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_MULTI_WRITER_HPP
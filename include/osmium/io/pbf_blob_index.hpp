@@ -0,0 +1,394 @@
+#ifndef OSMIUM_IO_PBF_BLOB_INDEX_HPP
+#define OSMIUM_IO_PBF_BLOB_INDEX_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Sidecar index for random access into PBF files. Include this file if
+ * you want to build, store or use blob indexes.
+ *
+ * The index records for every blob in a PBF file where it is in the
+ * file, which entity types it contains and the smallest and largest
+ * object id in it. With it, programs that only need, say, the ways of
+ * a region can skip whole blobs without decoding them. Use it together
+ * with the osmium::io::mmap_input and osmium::io::pbf_blob_ranges
+ * options of the Reader.
+ */
+
+#include <osmium/io/detail/input_format.hpp>
+#include <osmium/io/detail/pbf.hpp>
+#include <osmium/io/detail/pbf_decoder.hpp>
+#include <osmium/io/detail/protobuf_tags.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/io/file_format.hpp>
+#include <osmium/io/writer_options.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
+
+#include <protozero/pbf_message.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Index entry describing one blob of a PBF file.
+         */
+        struct pbf_blob_info {
+
+            /// Offset of the blob record (the 4 length bytes) in the file.
+            uint64_t offset = 0;
+
+            /// Size of the whole blob record including the length bytes.
+            uint64_t record_size = 0;
+
+            /// Entity types contained in this blob.
+            osmium::osm_entity_bits::type entity_types = osmium::osm_entity_bits::nothing;
+
+            /// Smallest object id in this blob.
+            osmium::object_id_type first_id = std::numeric_limits<osmium::object_id_type>::max();
+
+            /// Largest object id in this blob.
+            osmium::object_id_type last_id = std::numeric_limits<osmium::object_id_type>::min();
+
+        }; // struct pbf_blob_info
+
+        /**
+         * Index over the blobs of a PBF file. Can be built by scanning the
+         * file once and then written to and read from a small sidecar file,
+         * so the scan cost is only paid once.
+         */
+        class PBFBlobIndex {
+
+            std::vector<pbf_blob_info> m_blobs{};
+
+            enum : uint32_t {
+                sidecar_magic   = 0x58444942u, // "BIDX"
+                sidecar_version = 1u
+            };
+
+            static uint32_t get_blob_header_size(const char* data, const char* end) {
+                if (end - data < 4) {
+                    throw osmium::pbf_error{"truncated data (EOF encountered)"};
+                }
+                const auto* d = reinterpret_cast<const uint8_t*>(data);
+                const uint32_t size = (static_cast<uint32_t>(d[3])) |
+                                      (static_cast<uint32_t>(d[2]) << 8u) |
+                                      (static_cast<uint32_t>(d[1]) << 16u) |
+                                      (static_cast<uint32_t>(d[0]) << 24u);
+                if (size > static_cast<uint32_t>(detail::max_blob_header_size)) {
+                    throw osmium::pbf_error{"invalid BlobHeader size (> max_blob_header_size)"};
+                }
+                return size;
+            }
+
+        public:
+
+            PBFBlobIndex() noexcept = default;
+
+            const std::vector<pbf_blob_info>& blobs() const noexcept {
+                return m_blobs;
+            }
+
+            bool empty() const noexcept {
+                return m_blobs.empty();
+            }
+
+            std::size_t size() const noexcept {
+                return m_blobs.size();
+            }
+
+            /**
+             * Build the index by scanning the given PBF file. Every data
+             * blob is decoded once to find out which entity types and which
+             * id range it contains, so this is about as expensive as
+             * reading the whole file.
+             *
+             * @throws osmium::pbf_error if the file is not a valid PBF file.
+             * @throws std::system_error if the file could not be opened.
+             */
+            void build(const std::string& filename) {
+                m_blobs.clear();
+
+                const int fd = detail::open_for_reading(filename);
+                const std::size_t file_size = osmium::util::file_size(fd);
+                if (file_size == 0) {
+                    detail::reliable_close(fd);
+                    throw osmium::pbf_error{"can not index empty file or pipe"};
+                }
+
+                const osmium::util::MemoryMapping mapping{file_size, osmium::util::MemoryMapping::mapping_mode::readonly, fd};
+                detail::reliable_close(fd);
+
+                const char* const begin = mapping.get_addr<const char>();
+                const char* const end = begin + mapping.size();
+                const char* data = begin;
+
+                bool is_first_blob = true;
+                while (data != end) {
+                    pbf_blob_info info;
+                    info.offset = static_cast<uint64_t>(data - begin);
+
+                    const auto header_size = get_blob_header_size(data, end);
+                    data += 4;
+                    if (static_cast<std::size_t>(end - data) < header_size) {
+                        throw osmium::pbf_error{"truncated data (EOF encountered)"};
+                    }
+
+                    protozero::data_view blob_header_type;
+                    std::size_t blob_size = 0;
+                    protozero::pbf_message<detail::FileFormat::BlobHeader> pbf_blob_header{data, header_size};
+                    while (pbf_blob_header.next()) {
+                        switch (pbf_blob_header.tag_and_type()) {
+                            case protozero::tag_and_type(detail::FileFormat::BlobHeader::required_string_type, protozero::pbf_wire_type::length_delimited):
+                                blob_header_type = pbf_blob_header.get_view();
+                                break;
+                            case protozero::tag_and_type(detail::FileFormat::BlobHeader::required_int32_datasize, protozero::pbf_wire_type::varint):
+                                blob_size = static_cast<std::size_t>(pbf_blob_header.get_int32());
+                                break;
+                            default:
+                                pbf_blob_header.skip();
+                        }
+                    }
+                    data += header_size;
+
+                    if (blob_size == 0 || blob_size > detail::max_uncompressed_blob_size) {
+                        throw osmium::pbf_error{"invalid blob size"};
+                    }
+                    if (static_cast<std::size_t>(end - data) < blob_size) {
+                        throw osmium::pbf_error{"truncated data (EOF encountered)"};
+                    }
+
+                    info.record_size = 4 + header_size + blob_size;
+
+                    const bool is_header_blob = blob_header_type.size() == 9 &&
+                                                !std::strncmp("OSMHeader", blob_header_type.data(), 9);
+                    if (is_first_blob) {
+                        if (!is_header_blob) {
+                            throw osmium::pbf_error{"file does not start with OSMHeader blob"};
+                        }
+                        is_first_blob = false;
+                    } else {
+                        detail::PBFDataBlobDecoder decoder{std::shared_ptr<const void>{}, protozero::data_view{data, blob_size},
+                                                           osmium::osm_entity_bits::all, osmium::io::read_meta::no};
+                        const osmium::memory::Buffer buffer{decoder()};
+                        for (auto it = buffer.cbegin<osmium::OSMObject>(); it != buffer.cend<osmium::OSMObject>(); ++it) {
+                            info.entity_types |= osmium::osm_entity_bits::from_item_type(it->type());
+                            if (it->id() < info.first_id) {
+                                info.first_id = it->id();
+                            }
+                            if (it->id() > info.last_id) {
+                                info.last_id = it->id();
+                            }
+                        }
+                        m_blobs.push_back(info);
+                    }
+
+                    data += blob_size;
+                }
+            }
+
+            /**
+             * Write the index to a sidecar file. The format is a small
+             * header followed by the raw index entries; it is not portable
+             * between architectures with different endianness.
+             */
+            void write(const std::string& filename, const osmium::io::overwrite allow_overwrite = osmium::io::overwrite::no) const {
+                const int fd = detail::open_for_writing(filename, allow_overwrite);
+
+                const uint32_t header[4] = {
+                    sidecar_magic,
+                    sidecar_version,
+                    static_cast<uint32_t>(sizeof(pbf_blob_info)),
+                    static_cast<uint32_t>(m_blobs.size())
+                };
+                detail::reliable_write(fd, reinterpret_cast<const char*>(header), sizeof(header));
+                detail::reliable_write(fd, reinterpret_cast<const char*>(m_blobs.data()), sizeof(pbf_blob_info) * m_blobs.size());
+                detail::reliable_close(fd);
+            }
+
+            /**
+             * Read an index from a sidecar file written with write().
+             *
+             * @throws osmium::io_error if the file is not a valid sidecar
+             *         index file.
+             */
+            void read(const std::string& filename) {
+                m_blobs.clear();
+
+                const int fd = detail::open_for_reading(filename);
+
+                uint32_t header[4] = {0, 0, 0, 0};
+                if (detail::reliable_read(fd, reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header) ||
+                    header[0] != sidecar_magic ||
+                    header[1] != sidecar_version ||
+                    header[2] != sizeof(pbf_blob_info)) {
+                    detail::reliable_close(fd);
+                    throw osmium::io_error{"not a PBF blob index file: " + filename};
+                }
+
+                m_blobs.resize(header[3]);
+                const auto len = sizeof(pbf_blob_info) * m_blobs.size();
+                if (static_cast<std::size_t>(detail::reliable_read(fd, reinterpret_cast<char*>(m_blobs.data()), static_cast<unsigned int>(len))) != len) {
+                    detail::reliable_close(fd);
+                    throw osmium::io_error{"truncated PBF blob index file: " + filename};
+                }
+                detail::reliable_close(fd);
+            }
+
+            /**
+             * Get the byte ranges of all blobs containing any of the given
+             * entity types with ids overlapping the given id range. The
+             * result can be given to an osmium::io::Reader as the
+             * osmium::io::pbf_blob_ranges option.
+             *
+             * Note that the id range check is only meaningful for blobs
+             * containing a single entity type, which is how all known
+             * writers lay out PBF files.
+             */
+            pbf_blob_ranges select(const osmium::osm_entity_bits::type entities,
+                                   const osmium::object_id_type first_id = std::numeric_limits<osmium::object_id_type>::min(),
+                                   const osmium::object_id_type last_id  = std::numeric_limits<osmium::object_id_type>::max()) const {
+                auto ranges = std::make_shared<std::vector<std::pair<uint64_t, uint64_t>>>();
+
+                for (const auto& blob : m_blobs) {
+                    if ((blob.entity_types & entities) &&
+                        blob.first_id <= last_id &&
+                        blob.last_id >= first_id) {
+                        ranges->emplace_back(blob.offset, blob.record_size);
+                    }
+                }
+
+                return pbf_blob_ranges{std::move(ranges)};
+            }
+
+        }; // class PBFBlobIndex
+
+        /**
+         * Reads raw blob records from a PBF file. Use this together with
+         * a PBFBlobIndex and osmium::io::Writer::write_raw_blob() to copy
+         * blobs that your program does not change byte-for-byte into the
+         * output file, without decoding and re-encoding them:
+         *
+         * @code
+         * osmium::io::PBFBlobSource source{input_filename};
+         * for (const auto& blob : index.blobs()) {
+         *     if (blob.entity_types == osmium::osm_entity_bits::node) {
+         *         writer.write_raw_blob(source.read(blob));
+         *     }
+         * }
+         * @endcode
+         */
+        class PBFBlobSource {
+
+            int m_fd = -1;
+
+        public:
+
+            explicit PBFBlobSource(const std::string& filename) :
+                m_fd(detail::open_for_reading(filename)) {
+            }
+
+            PBFBlobSource(const PBFBlobSource&) = delete;
+            PBFBlobSource& operator=(const PBFBlobSource&) = delete;
+
+            PBFBlobSource(PBFBlobSource&&) = delete;
+            PBFBlobSource& operator=(PBFBlobSource&&) = delete;
+
+            ~PBFBlobSource() noexcept {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            /**
+             * Read the complete raw blob record (length bytes, BlobHeader
+             * and Blob) described by the given index entry.
+             *
+             * @throws std::system_error if the read failed.
+             * @throws osmium::io_error if the file is shorter than the
+             *         index says.
+             */
+            std::string read(const pbf_blob_info& blob) const {
+#ifdef _MSC_VER
+                if (_lseeki64(m_fd, static_cast<int64_t>(blob.offset), SEEK_SET) < 0) {
+#else
+                if (::lseek(m_fd, static_cast<off_t>(blob.offset), SEEK_SET) < 0) {
+#endif
+                    throw std::system_error{errno, std::system_category(), "Seek failed"};
+                }
+
+                std::string data;
+                data.resize(static_cast<std::size_t>(blob.record_size));
+                const auto nread = detail::reliable_read(m_fd, &*data.begin(), static_cast<unsigned int>(data.size()));
+                if (static_cast<std::size_t>(nread) != data.size()) {
+                    throw osmium::io_error{"blob record extends beyond end of file"};
+                }
+
+                return data;
+            }
+
+            void close() {
+                if (m_fd >= 0) {
+                    detail::reliable_close(m_fd);
+                    m_fd = -1;
+                }
+            }
+
+        }; // class PBFBlobSource
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_PBF_BLOB_INDEX_HPP
@@ -0,0 +1,375 @@
+#ifndef OSMIUM_IO_PBF_CHANGE_APPLIER_HPP
+#define OSMIUM_IO_PBF_CHANGE_APPLIER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/detail/pbf.hpp>
+#include <osmium/io/detail/pbf_decoder.hpp>
+#include <osmium/io/detail/protobuf_tags.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/file_format.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/io/overwrite.hpp>
+#include <osmium/io/pbf_blob_index.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/io/writer_options.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/object_comparisons.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <protozero/pbf_message.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Apply OSM change files (.osc) to a sorted PBF file on the
+         * blob level. A change usually touches only a tiny fraction of
+         * the blobs in the file; only those are decoded, patched and
+         * re-encoded, all other blobs are copied into the output
+         * byte-for-byte without ever being decompressed. For minutely
+         * or hourly updates of a large file this replaces a full
+         * decode and encode of the whole file with a few blob
+         * rewrites.
+         *
+         * @code
+         * osmium::io::PBFChangeApplier applier{"planet.osm.pbf",
+         *                                      osmium::io::File{"planet-new.osm.pbf"}};
+         * applier.read_changes(osmium::io::File{"changes.osc.gz"});
+         * applier.apply();
+         * @endcode
+         *
+         * The blob index is built by scanning the input file unless a
+         * previously built index is supplied through index(), in which
+         * case only the patched blobs of the input are ever read.
+         *
+         * As with all change application the input file must be sorted
+         * by type and id and contain only one version of each object;
+         * the output is sorted the same way. Objects marked deleted in
+         * the change are removed, modified objects replaced, created
+         * objects inserted at their position. When several changes
+         * contain the same object only the newest version is applied.
+         */
+        class PBFChangeApplier {
+
+            /**
+             * Position of an object in a sorted file: entity type
+             * (nodes before ways before relations) first, then id.
+             */
+            struct object_position {
+
+                unsigned int nwr;
+                osmium::object_id_type id;
+
+                bool operator<(const object_position& other) const noexcept {
+                    return nwr != other.nwr ? nwr < other.nwr : id < other.id;
+                }
+
+                bool operator==(const object_position& other) const noexcept {
+                    return nwr == other.nwr && id == other.id;
+                }
+
+                bool operator<=(const object_position& other) const noexcept {
+                    return *this < other || *this == other;
+                }
+
+            }; // struct object_position
+
+            using change_iterator = std::vector<const osmium::OSMObject*>::const_iterator;
+
+            std::vector<osmium::memory::Buffer> m_change_buffers{};
+
+            std::vector<const osmium::OSMObject*> m_changes{};
+
+            std::string m_input_filename;
+
+            osmium::io::File m_output_file;
+
+            PBFBlobIndex m_index{};
+
+            uint64_t m_blobs_copied = 0;
+
+            uint64_t m_blobs_rewritten = 0;
+
+            static object_position position_of(const osmium::OSMObject& object) noexcept {
+                return object_position{osmium::item_type_to_nwr_index(object.type()), object.id()};
+            }
+
+            static object_position begin_position_of(const pbf_blob_info& blob) noexcept {
+                unsigned int nwr = 2;
+                if (blob.entity_types & osmium::osm_entity_bits::node) {
+                    nwr = 0;
+                } else if (blob.entity_types & osmium::osm_entity_bits::way) {
+                    nwr = 1;
+                }
+                return object_position{nwr, blob.first_id};
+            }
+
+            static object_position end_position_of(const pbf_blob_info& blob) noexcept {
+                unsigned int nwr = 0;
+                if (blob.entity_types & osmium::osm_entity_bits::relation) {
+                    nwr = 2;
+                } else if (blob.entity_types & osmium::osm_entity_bits::way) {
+                    nwr = 1;
+                }
+                return object_position{nwr, blob.last_id};
+            }
+
+            /// Decode the data blob of a complete raw blob record.
+            static osmium::memory::Buffer decode_record(const std::string& record) {
+                const char* data = record.data();
+                const char* const end = data + record.size();
+
+                if (end - data < 4) {
+                    throw osmium::pbf_error{"truncated data (EOF encountered)"};
+                }
+                const auto* d = reinterpret_cast<const uint8_t*>(data);
+                const uint32_t header_size = (static_cast<uint32_t>(d[3])) |
+                                             (static_cast<uint32_t>(d[2]) << 8u) |
+                                             (static_cast<uint32_t>(d[1]) << 16u) |
+                                             (static_cast<uint32_t>(d[0]) << 24u);
+                data += 4;
+                if (static_cast<std::size_t>(end - data) < header_size) {
+                    throw osmium::pbf_error{"truncated data (EOF encountered)"};
+                }
+                data += header_size;
+
+                detail::PBFDataBlobDecoder decoder{std::shared_ptr<const void>{},
+                                                   protozero::data_view{data, static_cast<std::size_t>(end - data)},
+                                                   osmium::osm_entity_bits::all,
+                                                   osmium::io::read_meta::yes};
+                return decoder();
+            }
+
+            /**
+             * Add a change object to the output buffer. Objects marked
+             * deleted are dropped, that is how a delete is applied to
+             * a file without history.
+             */
+            static void emit_change(osmium::memory::Buffer& buffer, const osmium::OSMObject& object) {
+                if (object.visible()) {
+                    buffer.add_item(object);
+                    buffer.commit();
+                }
+            }
+
+            /**
+             * Write all changes up to (and not including) the given
+             * position. These are creations of objects the input file
+             * does not have, they become new output objects.
+             */
+            void write_changes_before(Writer& writer, change_iterator& cur, const object_position limit) {
+                osmium::memory::Buffer buffer{1024ul * 64ul, osmium::memory::Buffer::auto_grow::yes};
+                while (cur != m_changes.cend() && position_of(**cur) < limit) {
+                    emit_change(buffer, **cur);
+                    ++cur;
+                }
+                if (buffer.committed() > 0) {
+                    writer(std::move(buffer));
+                }
+            }
+
+            /**
+             * Decode the given blob, merge the pending changes into it
+             * and write the result through the normal encoding path.
+             */
+            void rewrite_blob(Writer& writer, const PBFBlobSource& source, const pbf_blob_info& blob, change_iterator& cur) {
+                const osmium::memory::Buffer decoded = decode_record(source.read(blob));
+
+                osmium::memory::Buffer buffer{decoded.committed() + 1024ul * 64ul,
+                                              osmium::memory::Buffer::auto_grow::yes};
+
+                for (const auto& object : decoded.select<osmium::OSMObject>()) {
+                    const object_position pos = position_of(object);
+                    while (cur != m_changes.cend() && position_of(**cur) < pos) {
+                        emit_change(buffer, **cur);
+                        ++cur;
+                    }
+                    if (cur != m_changes.cend() && position_of(**cur) == pos) {
+                        emit_change(buffer, **cur);
+                        ++cur;
+                    } else {
+                        buffer.add_item(object);
+                        buffer.commit();
+                    }
+                }
+
+                // creations between the last object of this blob and
+                // the end of its id range
+                const object_position end_pos = end_position_of(blob);
+                while (cur != m_changes.cend() && position_of(**cur) <= end_pos) {
+                    emit_change(buffer, **cur);
+                    ++cur;
+                }
+
+                if (buffer.committed() > 0) {
+                    writer(std::move(buffer));
+                }
+                ++m_blobs_rewritten;
+            }
+
+        public:
+
+            /**
+             * Create a PBFChangeApplier reading from the given input
+             * file and writing the patched result to the given output
+             * file, which must be a PBF file and is overwritten if it
+             * exists.
+             */
+            PBFChangeApplier(std::string input_filename, osmium::io::File output_file) :
+                m_input_filename(std::move(input_filename)),
+                m_output_file(std::move(output_file)) {
+                if (m_output_file.format() != osmium::io::file_format::pbf) {
+                    throw osmium::io_error{"PBFChangeApplier can only write PBF files"};
+                }
+            }
+
+            /**
+             * The blob index of the input file. Read a sidecar index
+             * into this before calling apply() to avoid the scan of
+             * the input file, or write it to a sidecar file afterwards
+             * to reuse it.
+             */
+            PBFBlobIndex& index() noexcept {
+                return m_index;
+            }
+
+            /**
+             * Add the change objects in the given buffer. The buffer
+             * is kept alive in the applier.
+             */
+            void add_changes(osmium::memory::Buffer&& buffer) {
+                if (buffer && buffer.committed() > 0) {
+                    m_change_buffers.push_back(std::move(buffer));
+                }
+            }
+
+            /**
+             * Read all objects from the given change file. Can be
+             * called several times to apply several change files in
+             * one go; when they contain the same object only the
+             * newest version is applied.
+             *
+             * @throws Some form of osmium::io_error if there is an error.
+             */
+            void read_changes(const osmium::io::File& change_file) {
+                Reader reader{change_file};
+                while (osmium::memory::Buffer buffer = reader.read()) {
+                    add_changes(std::move(buffer));
+                }
+                reader.close();
+            }
+
+            /// The number of blobs copied byte-for-byte. Valid after apply().
+            uint64_t blobs_copied() const noexcept {
+                return m_blobs_copied;
+            }
+
+            /// The number of blobs decoded, patched and re-encoded. Valid after apply().
+            uint64_t blobs_rewritten() const noexcept {
+                return m_blobs_rewritten;
+            }
+
+            /**
+             * Apply the changes: write the output file, copying all
+             * blobs whose id range no change touches and rewriting the
+             * others.
+             *
+             * @throws Some form of osmium::io_error if there is an error.
+             */
+            void apply() {
+                m_changes.clear();
+                for (const auto& buffer : m_change_buffers) {
+                    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                        m_changes.push_back(&object);
+                    }
+                }
+                std::sort(m_changes.begin(), m_changes.end(), osmium::object_order_type_id_reverse_version{});
+                m_changes.erase(std::unique(m_changes.begin(), m_changes.end(),
+                                            [](const osmium::OSMObject* lhs, const osmium::OSMObject* rhs) {
+                                                return lhs->type() == rhs->type() && lhs->id() == rhs->id();
+                                            }),
+                                m_changes.end());
+
+                if (m_index.empty()) {
+                    m_index.build(m_input_filename);
+                }
+
+                Reader header_reader{m_input_filename, osmium::osm_entity_bits::nothing};
+                const osmium::io::Header header{header_reader.header()};
+                header_reader.close();
+
+                Writer writer{m_output_file, header, overwrite::allow};
+                const PBFBlobSource source{m_input_filename};
+
+                auto cur = m_changes.cbegin();
+                for (const auto& blob : m_index.blobs()) {
+                    write_changes_before(writer, cur, begin_position_of(blob));
+
+                    if (cur != m_changes.cend() && position_of(**cur) <= end_position_of(blob)) {
+                        rewrite_blob(writer, source, blob, cur);
+                    } else {
+                        writer.write_raw_blob(source.read(blob));
+                        ++m_blobs_copied;
+                    }
+                }
+
+                // creations after the last blob
+                write_changes_before(writer, cur,
+                                     object_position{3, std::numeric_limits<osmium::object_id_type>::max()});
+
+                writer.close();
+            }
+
+        }; // class PBFChangeApplier
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_PBF_CHANGE_APPLIER_HPP
@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/io/checkpoint.hpp>
 #include <osmium/io/compression.hpp>
 #include <osmium/io/detail/input_format.hpp>
 #include <osmium/io/detail/queue_util.hpp>
@@ -41,13 +42,20 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/error.hpp>
 #include <osmium/io/file.hpp>
 #include <osmium/io/header.hpp>
+#include <osmium/io/remote_source.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/metadata_options.hpp>
 #include <osmium/thread/pool.hpp>
+#include <osmium/thread/queue.hpp>
 #include <osmium/thread/util.hpp>
-#include <osmium/util/config.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
+#include <osmium/util/tuning.hpp>
+#include <osmium/util/verbose_output.hpp>
 
 #include <cerrno>
+#include <cstdint>
 #include <cstdlib>
 #include <fcntl.h>
 #include <future>
@@ -72,11 +80,63 @@ namespace osmium {
         namespace detail {
 
             inline std::size_t get_input_queue_size() noexcept {
-                return osmium::config::get_max_queue_size("INPUT", 20);
+                return osmium::config::tuning().input_queue_size;
             }
 
             inline std::size_t get_osmdata_queue_size() noexcept {
-                return osmium::config::get_max_queue_size("OSMDATA", 20);
+                // The queue of decoded buffers is the reorder window of
+                // the decode pipeline, see the osmdata_queue_size knob
+                // in the tuning registry for why its default depends on
+                // the number of cores.
+                return osmium::config::tuning().osmdata_queue_size;
+            }
+
+            // Find the osmium::io::mmap_input option in the arguments given
+            // to the Reader constructor. This has to happen before the
+            // constructor body runs, because the decision whether to map
+            // the file influences member initialization.
+            inline mmap_input get_mmap_input_option() noexcept {
+                return mmap_input::no;
+            }
+
+            template <typename... TArgs>
+            inline mmap_input get_mmap_input_option(const mmap_input value, TArgs&&... /*args*/) noexcept {
+                return value;
+            }
+
+            template <typename TFirst, typename... TArgs>
+            inline mmap_input get_mmap_input_option(TFirst&& /*first*/, TArgs&&... args) noexcept {
+                return get_mmap_input_option(std::forward<TArgs>(args)...);
+            }
+
+            // Same for the osmium::io::Checkpoint option.
+            inline Checkpoint get_checkpoint_option() {
+                return Checkpoint{};
+            }
+
+            template <typename... TArgs>
+            inline Checkpoint get_checkpoint_option(const Checkpoint& value, TArgs&&... /*args*/) {
+                return value;
+            }
+
+            template <typename TFirst, typename... TArgs>
+            inline Checkpoint get_checkpoint_option(TFirst&& /*first*/, TArgs&&... args) {
+                return get_checkpoint_option(std::forward<TArgs>(args)...);
+            }
+
+            // Same for the osmium::io::pbf_blob_ranges option.
+            inline pbf_blob_ranges get_pbf_blob_ranges_option() noexcept {
+                return pbf_blob_ranges{};
+            }
+
+            template <typename... TArgs>
+            inline pbf_blob_ranges get_pbf_blob_ranges_option(const pbf_blob_ranges& value, TArgs&&... /*args*/) {
+                return value;
+            }
+
+            template <typename TFirst, typename... TArgs>
+            inline pbf_blob_ranges get_pbf_blob_ranges_option(TFirst&& /*first*/, TArgs&&... args) {
+                return get_pbf_blob_ranges_option(std::forward<TArgs>(args)...);
             }
 
         } // namespace detail
@@ -100,6 +160,41 @@ namespace osmium {
 
             detail::ParserFactory::create_parser_type m_creator;
 
+            // Mapping of the whole input file if zero-copy reading was
+            // requested (and possible). Shared with the parser and the blob
+            // decoders it queues in the thread pool, so the mapping stays
+            // alive as long as anything points into it.
+            std::shared_ptr<osmium::util::MemoryMapping> m_mapping;
+
+            // Byte ranges of the blobs to read if reading was restricted
+            // with the osmium::io::pbf_blob_ranges option.
+            pbf_blob_ranges m_blob_ranges;
+
+            // Tag filter pushed down into the PBF decoder if reading was
+            // restricted with the osmium::io::pbf_tags_filter option.
+            pbf_tags_filter m_tags_filter{};
+
+            // Id filter pushed down into the PBF decoder if reading was
+            // restricted with the osmium::io::pbf_ids_filter option.
+            pbf_ids_filter m_ids_filter{};
+
+            // Maximum number of outstanding decode tasks in the thread
+            // pool if set with the osmium::io::max_pool_tasks option,
+            // 0 for no limit.
+            std::size_t m_max_pool_tasks = 0;
+
+            // Checkpoint to resume from if one was given as an option
+            // to the constructor.
+            Checkpoint m_resume{};
+
+            // Offsets after the blob records delivered so far, written
+            // by the PBF parser, used by checkpoint().
+            detail::blob_offset_log m_offset_log{};
+
+            // The number of buffers delivered from the osmdata queue
+            // to the application so far.
+            std::size_t m_buffers_delivered = 0;
+
             enum class status {
                 okay   = 0, // normal reading
                 error  = 1, // some error occurred while reading
@@ -109,7 +204,7 @@ namespace osmium {
 
             int m_childpid = 0;
 
-            detail::future_string_queue_type m_input_queue;
+            detail::raw_data_queue m_input_queue;
 
             std::unique_ptr<osmium::io::Decompressor> m_decompressor;
 
@@ -127,6 +222,9 @@ namespace osmium {
 
             osmium::osm_entity_bits::type m_read_which_entities = osmium::osm_entity_bits::all;
             osmium::io::read_meta m_read_metadata = osmium::io::read_meta::yes;
+            osmium::io::read_discussions m_read_discussions = osmium::io::read_discussions::yes;
+            osmium::io::read_visible m_read_visible_objects = osmium::io::read_visible::all;
+            osmium::metadata_options m_metadata_opts{};
 
             void set_option(osmium::thread::Pool& pool) noexcept {
                 m_pool = &pool;
@@ -140,14 +238,63 @@ namespace osmium {
                 m_read_metadata = value;
             }
 
+            void set_option(osmium::io::read_visible value) noexcept {
+                m_read_visible_objects = value;
+            }
+
+            void set_option(osmium::io::read_discussions value) noexcept {
+                m_read_discussions = value;
+            }
+
+            void set_option(const osmium::metadata_options& value) noexcept {
+                m_metadata_opts = value;
+            }
+
+            void set_option(osmium::io::mmap_input /*value*/) noexcept {
+                // Already handled in detail::get_mmap_input_option() before
+                // member initialization. This overload only makes the
+                // option known to the normal option handling.
+            }
+
+            void set_option(const osmium::io::pbf_blob_ranges& /*value*/) noexcept {
+                // Already handled in detail::get_pbf_blob_ranges_option()
+                // before member initialization.
+            }
+
+            void set_option(const osmium::io::pbf_tags_filter& value) {
+                m_tags_filter = value;
+            }
+
+            void set_option(const osmium::io::pbf_ids_filter& value) {
+                m_ids_filter = value;
+            }
+
+            void set_option(const osmium::io::max_pool_tasks& value) noexcept {
+                m_max_pool_tasks = value.value;
+            }
+
+            void set_option(const osmium::io::Checkpoint& value) {
+                m_resume = value;
+            }
+
             // This function will run in a separate thread.
             static void parser_thread(osmium::thread::Pool& pool,
                                       const detail::ParserFactory::create_parser_type& creator,
-                                      detail::future_string_queue_type& input_queue,
+                                      detail::raw_data_queue& input_queue,
                                       detail::future_buffer_queue_type& osmdata_queue,
                                       std::promise<osmium::io::Header>&& header_promise,
                                       osmium::osm_entity_bits::type read_which_entities,
-                                      osmium::io::read_meta read_metadata) {
+                                      osmium::io::read_meta read_metadata,
+                                      osmium::io::read_discussions read_discussions,
+                                      osmium::io::read_visible read_visible_objects,
+                                      std::shared_ptr<osmium::util::MemoryMapping> mapping,
+                                      pbf_blob_ranges blob_ranges,
+                                      pbf_tags_filter tags_filter,
+                                      pbf_ids_filter ids_filter,
+                                      std::size_t max_pool_tasks,
+                                      detail::blob_offset_log* offset_log,
+                                      Checkpoint resume,
+                                      osmium::metadata_options metadata_opts) {
                 std::promise<osmium::io::Header> promise{std::move(header_promise)};
                 osmium::io::detail::parser_arguments args = {
                     pool,
@@ -155,78 +302,93 @@ namespace osmium {
                     osmdata_queue,
                     promise,
                     read_which_entities,
-                    read_metadata
+                    read_metadata,
+                    read_discussions,
+                    read_visible_objects,
+                    mapping,
+                    mapping ? mapping->get_addr<const char>() : nullptr,
+                    mapping ? mapping->size() : 0,
+                    std::move(blob_ranges),
+                    std::move(tags_filter),
+                    std::move(ids_filter),
+                    max_pool_tasks,
+                    offset_log,
+                    resume.offset(),
+                    resume.header(),
+                    metadata_opts
                 };
                 creator(args)->parse();
             }
 
-#ifndef _WIN32
             /**
-             * Fork and execute the given command in the child.
-             * A pipe is created between the child and the parent.
-             * The child writes to the pipe, the parent reads from it.
-             * This function never returns in the child.
+             * Open File for reading. Handles URLs or normal files. A
+             * file name with a scheme for which a remote source is
+             * registered (by default "http", "https", "ftp", and
+             * "file", read by executing the "curl" program, which must
+             * be installed) is opened through that source, see
+             * osmium::io::RemoteSourceFactory. Everything else is
+             * opened as a local file.
              *
-             * @param command Command to execute in the child.
-             * @param filename Filename to give to command as argument.
-             * @returns File descriptor of pipe in the parent.
+             * @returns File descriptor of open file or pipe.
              * @throws std::system_error if a system call fails.
              */
-            static int execute(const std::string& command, const std::string& filename, int* childpid) {
-                int pipefd[2];
-                if (pipe(pipefd) < 0) {
-                    throw std::system_error{errno, std::system_category(), "opening pipe failed"};
+            static int open_input_file_or_url(const std::string& filename, int* childpid, const std::size_t offset = 0) {
+                const std::string scheme{filename.substr(0, filename.find_first_of(':'))};
+                if (osmium::io::RemoteSourceFactory::instance().has_source(scheme)) {
+                    return osmium::io::RemoteSourceFactory::instance().open(scheme, filename, offset, 0, childpid);
                 }
-                const pid_t pid = fork();
-                if (pid < 0) {
-                    throw std::system_error{errno, std::system_category(), "fork failed"};
-                }
-                if (pid == 0) { // child
-                    // close all file descriptors except one end of the pipe
-                    for (int i = 0; i < 32; ++i) {
-                        if (i != pipefd[1]) {
-                            ::close(i);
-                        }
+                const int fd = osmium::io::detail::open_for_reading(filename);
+                if (offset > 0) {
+                    if (fd == 0) {
+                        throw io_error{"Can not resume from a checkpoint when reading from stdin"};
                     }
-                    if (dup2(pipefd[1], 1) < 0) { // put end of pipe as stdout/stdin
-                        exit(1);
-                    }
-
-                    ::open("/dev/null", O_RDONLY); // stdin
-                    ::open("/dev/null", O_WRONLY); // stderr
-                    // hack: -g switches off globbing in curl which allows [] to be used in file names
-                    // this is important for XAPI URLs
-                    // in theory this execute() function could be used for other commands, but it is
-                    // only used for curl at the moment, so this is okay.
-                    if (::execlp(command.c_str(), command.c_str(), "-g", filename.c_str(), nullptr) < 0) {
-                        exit(1);
+#ifdef _MSC_VER
+                    if (_lseeki64(fd, static_cast<int64_t>(offset), SEEK_SET) < 0) {
+#else
+                    if (::lseek(fd, static_cast<off_t>(offset), SEEK_SET) < 0) {
+#endif
+                        throw std::system_error{errno, std::system_category(), std::string{"Seek failed for '"} + filename + "'"};
                     }
                 }
-                // parent
-                *childpid = pid;
-                ::close(pipefd[1]);
-                return pipefd[0];
+                return fd;
             }
-#endif
 
             /**
-             * Open File for reading. Handles URLs or normal files. URLs
-             * are opened by executing the "curl" program (which must be installed)
-             * and reading from its output.
-             *
-             * @returns File descriptor of open file or pipe.
-             * @throws std::system_error if a system call fails.
+             * Map the whole input file into memory if this was requested
+             * and is possible for this file: It has to be a local PBF file
+             * without outer compression, because only the PBF parser can
+             * read directly from memory. In all other cases an empty
+             * pointer is returned and the Reader falls back to reading
+             * through the read thread.
              */
-            static int open_input_file_or_url(const std::string& filename, int* childpid) {
-                const std::string protocol{filename.substr(0, filename.find_first_of(':'))};
+            static std::shared_ptr<osmium::util::MemoryMapping> create_mapping(const osmium::io::File& file, const osmium::io::mmap_input use_mmap) {
+                if (use_mmap == osmium::io::mmap_input::no) {
+                    return nullptr;
+                }
+
+                if (file.buffer() ||
+                    file.filename().empty() ||
+                    file.format() != osmium::io::file_format::pbf ||
+                    file.compression() != osmium::io::file_compression::none) {
+                    return nullptr;
+                }
+
+                const std::string protocol{file.filename().substr(0, file.filename().find_first_of(':'))};
                 if (protocol == "http" || protocol == "https" || protocol == "ftp" || protocol == "file") {
-#ifndef _WIN32
-                    return execute("curl", filename, childpid);
-#else
-                    throw io_error{"Reading OSM files from the network currently not supported on Windows."};
-#endif
+                    return nullptr;
                 }
-                return osmium::io::detail::open_for_reading(filename);
+
+                const int fd = osmium::io::detail::open_for_reading(file.filename());
+                const std::size_t size = osmium::util::file_size(fd);
+                if (size == 0) { // can not map pipes or empty files
+                    osmium::io::detail::reliable_close(fd);
+                    return nullptr;
+                }
+
+                auto mapping = std::make_shared<osmium::util::MemoryMapping>(size, osmium::util::MemoryMapping::mapping_mode::readonly, fd);
+                osmium::io::detail::reliable_close(fd);
+
+                return mapping;
             }
 
         public:
@@ -250,6 +412,68 @@ namespace osmium {
              *      etc.) is not read possibly speeding up the read. Not all
              *      file formats use this setting.
              *
+             * * osmium::metadata_options: Which metadata fields (version,
+             *      timestamp, changeset, uid, user) should be decoded.
+             *      Use this if you need some fields but want to skip the
+             *      rest, for instance
+             *      osmium::metadata_options{"version+timestamp"}. The
+             *      default is to decode all fields. Only used when
+             *      osmium::io::read_meta is set to yes and only for the
+             *      PBF format.
+             *
+             * * osmium::io::read_visible: For full-history files. The
+             *      default is osmium::io::read_visible::all which means
+             *      all object versions are read. If you set this to
+             *      osmium::io::read_visible::only, deleted versions and
+             *      versions directly superseded by a newer version of
+             *      the same object in the same data block are skipped
+             *      before they are decoded. Versions superseded across
+             *      block boundaries can not be detected this way, so
+             *      code that needs exactly one version per object must
+             *      still deduplicate. Only used for the PBF format.
+             *
+             * * osmium::io::read_discussions: Read changeset discussions
+             *      or not. The default is
+             *      osmium::io::read_discussions::yes. If you set this to
+             *      osmium::io::read_discussions::no, discussion comments
+             *      on changesets are not built, possibly speeding up the
+             *      read. Only matters when reading changeset files.
+             *
+             * * osmium::io::mmap_input: With osmium::io::mmap_input::yes
+             *      the Reader memory-maps the input file and the parser
+             *      reads directly from the mapping instead of copying the
+             *      data through the read thread. This only works for local
+             *      PBF files without outer compression; in all other cases
+             *      the option is silently ignored. Most effective when the
+             *      file is in the page cache and its blobs are not
+             *      compressed.
+             *
+             * * osmium::io::pbf_blob_ranges: Restrict reading to the given
+             *      byte ranges of blob records, usually selected from a
+             *      sidecar index (see osmium/io/pbf_blob_index.hpp).
+             *      Implies memory-mapped reading and throws an
+             *      osmium::io_error if the file can not be mapped.
+             *
+             * * osmium::io::pbf_tags_filter: Only decode objects from PBF
+             *      input that have at least one tag matching the given
+             *      filter function, for instance an osmium::TagsFilter.
+             *      All other objects, including untagged ones, are
+             *      skipped in the decoder before any buffer space is
+             *      allocated for them. Create the option with
+             *      osmium::io::make_pbf_tags_filter() to also get the
+             *      per-block key index, which rejects tags with
+             *      non-matching keys by their string-table id without
+             *      comparing any strings. Other file formats ignore this
+             *      option.
+             *
+             * * osmium::io::pbf_ids_filter: Only decode objects from PBF
+             *      input whose ids are in the given id sets (one set per
+             *      object type, an unset pointer means all objects of
+             *      that type). Useful for second passes where the needed
+             *      ids are known, for instance from
+             *      osmium::relations::RelationsManagerBase::member_ids().
+             *      Other file formats ignore this option.
+             *
              * @throws osmium::io_error If there was an error.
              * @throws std::system_error If the file could not be opened.
              */
@@ -257,14 +481,18 @@ namespace osmium {
             explicit Reader(const osmium::io::File& file, TArgs&&... args) :
                 m_file(file.check()),
                 m_creator(detail::ParserFactory::instance().get_creator_function(m_file)),
+                m_mapping(create_mapping(m_file, detail::get_pbf_blob_ranges_option(args...).ranges ? mmap_input::yes : detail::get_mmap_input_option(args...))),
+                m_blob_ranges(detail::get_pbf_blob_ranges_option(args...)),
                 m_input_queue(detail::get_input_queue_size(), "raw_input"),
                 m_decompressor(m_file.buffer() ?
                     osmium::io::CompressionFactory::instance().create_decompressor(file.compression(), m_file.buffer(), m_file.buffer_size()) :
-                    osmium::io::CompressionFactory::instance().create_decompressor(file.compression(), open_input_file_or_url(m_file.filename(), &m_childpid))),
+                    m_mapping ?
+                        osmium::io::CompressionFactory::instance().create_decompressor(file.compression(), "", 0) :
+                        osmium::io::CompressionFactory::instance().create_decompressor(file.compression(), open_input_file_or_url(m_file.filename(), &m_childpid, detail::get_checkpoint_option(args...).offset()))),
                 m_read_thread_manager(*m_decompressor, m_input_queue),
                 m_osmdata_queue(detail::get_osmdata_queue_size(), "parser_results"),
                 m_osmdata_queue_wrapper(m_osmdata_queue),
-                m_file_size(m_decompressor->file_size()) {
+                m_file_size(m_mapping ? m_mapping->size() : m_decompressor->file_size()) {
 
                 (void)std::initializer_list<int>{
                     (set_option(args), 0)...
@@ -274,9 +502,39 @@ namespace osmium {
                     m_pool = &thread::Pool::default_instance();
                 }
 
+                if (m_max_pool_tasks == 0) {
+                    m_max_pool_tasks = osmium::config::tuning().max_reader_pool_tasks;
+                }
+
+                // Unless the user fixed a queue size through the
+                // environment, let the queue limits adapt to the
+                // observed stalls, starting from the defaults. The
+                // upper bounds keep the memory use in check when the
+                // consumer can't keep up anyway.
+                if (!osmium::config::tuning().input_queue_size_fixed) {
+                    m_input_queue.set_adaptive_size(detail::get_input_queue_size(),
+                                                    detail::get_input_queue_size() * 8);
+                }
+                if (!osmium::config::tuning().osmdata_queue_size_fixed) {
+                    m_osmdata_queue.set_adaptive_size(detail::get_osmdata_queue_size(),
+                                                      detail::get_osmdata_queue_size() * 4);
+                }
+
+                if (m_blob_ranges.ranges && !m_mapping) {
+                    throw io_error{"The pbf_blob_ranges option only works for local PBF files without outer compression"};
+                }
+
+                if (m_resume.valid() &&
+                    (m_file.format() != file_format::pbf ||
+                     m_file.compression() != file_compression::none ||
+                     m_file.buffer() ||
+                     m_blob_ranges.ranges)) {
+                    throw io_error{"Resuming from a checkpoint only works for PBF files without outer compression"};
+                }
+
                 std::promise<osmium::io::Header> header_promise;
                 m_header_future = header_promise.get_future();
-                m_thread = osmium::thread::thread_handler{parser_thread, std::ref(*m_pool), std::ref(m_creator), std::ref(m_input_queue), std::ref(m_osmdata_queue), std::move(header_promise), m_read_which_entities, m_read_metadata};
+                m_thread = osmium::thread::thread_handler{parser_thread, std::ref(*m_pool), std::ref(m_creator), std::ref(m_input_queue), std::ref(m_osmdata_queue), std::move(header_promise), m_read_which_entities, m_read_metadata, m_read_discussions, m_read_visible_objects, m_mapping, m_blob_ranges, m_tags_filter, m_ids_filter, m_max_pool_tasks, &m_offset_log, m_resume, m_metadata_opts};
             }
 
             template <typename... TArgs>
@@ -406,6 +664,7 @@ namespace osmium {
                             m_read_thread_manager.close();
                             return buffer;
                         }
+                        ++m_buffers_delivered;
                         if (buffer.has_nested_buffers()) {
                             m_back_buffers = std::move(buffer);
                             buffer = std::move(*m_back_buffers.get_last_nested());
@@ -455,6 +714,95 @@ namespace osmium {
                 return m_decompressor->offset();
             }
 
+            /**
+             * Get a checkpoint for the current read position: the file
+             * offset of the first blob record whose data has not been
+             * delivered by read() yet, plus the file header. Serialize
+             * it with Checkpoint::to_string() and give it to a new
+             * Reader for the same file later to resume reading there
+             * instead of starting over.
+             *
+             * Call this between two calls to read(), from the same
+             * thread. Only works for PBF files without outer
+             * compression and without the pbf_blob_ranges option,
+             * because only then the remaining file is self-contained.
+             *
+             * @throws osmium::io_error If checkpointing is not
+             *         supported for this file.
+             */
+            Checkpoint checkpoint() {
+                if (m_file.format() != file_format::pbf ||
+                    m_file.compression() != file_compression::none ||
+                    m_blob_ranges.ranges) {
+                    throw io_error{"Checkpoints only work for PBF files without outer compression"};
+                }
+                return Checkpoint{m_offset_log.get(m_buffers_delivered), header()};
+            }
+
+            /**
+             * Snapshot of the metrics of a Reader, taken with the
+             * metrics() member function.
+             */
+            struct reader_metrics {
+
+                /// Counters of the queue with the raw input file data.
+                osmium::thread::queue_counters raw_input_queue;
+
+                /// Counters of the queue with the decoded buffers.
+                osmium::thread::queue_counters osmdata_queue;
+
+            }; // struct reader_metrics
+
+            /**
+             * Get a snapshot of the metrics of this reader. Can be
+             * called at any time from any thread, the counters are
+             * cheap enough to be always on. Use this to find out where
+             * the read pipeline stalls, see
+             * osmium::thread::queue_counters for how to interpret the
+             * counts.
+             */
+            reader_metrics metrics() const {
+                reader_metrics result;
+                result.raw_input_queue = m_input_queue.counters();
+                result.osmdata_queue = m_osmdata_queue.counters();
+                return result;
+            }
+
+            /**
+             * Print a breakdown of where this reader's pipeline spent
+             * its time waiting. Prints nothing if the VerboseOutput is
+             * not in verbose mode. Usually called through the
+             * close(VerboseOutput&) overload, but can be called at any
+             * time, for instance periodically during a long run.
+             */
+            void report_metrics(osmium::util::VerboseOutput& out, const char* name = "reader") const {
+                if (!out.verbose()) {
+                    return;
+                }
+                const reader_metrics m = metrics();
+                out << name << " pipeline for '" << m_file.filename() << "':\n";
+                out << "  raw input queue: " << m.raw_input_queue.push << " blocks read from file\n";
+                out << "    file read stalled " << m.raw_input_queue.full
+                    << " times waiting for the decoder\n";
+                out << "    decoder stalled " << m.raw_input_queue.empty
+                    << " times waiting for file data (read wait)\n";
+                out << "  osmdata queue: " << m.osmdata_queue.push << " buffers decoded\n";
+                out << "    decoder stalled " << m.osmdata_queue.full
+                    << " times waiting for the application (handler is the bottleneck)\n";
+                out << "    application stalled " << m.osmdata_queue.empty
+                    << " times waiting for decoded data (decode is the bottleneck)\n";
+            }
+
+            /**
+             * Close down the Reader as with close(), then print the
+             * pipeline breakdown from report_metrics() through the
+             * specified VerboseOutput.
+             */
+            void close(osmium::util::VerboseOutput& out) {
+                close();
+                report_metrics(out);
+            }
+
         }; // class Reader
 
         /**
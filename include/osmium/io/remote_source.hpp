@@ -0,0 +1,236 @@
+#ifndef OSMIUM_IO_REMOTE_SOURCE_HPP
+#define OSMIUM_IO_REMOTE_SOURCE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/error.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <system_error>
+
+#ifndef _WIN32
+# include <fcntl.h>
+# include <sys/types.h>
+# include <unistd.h>
+#endif
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * This singleton factory class is used to register sources for
+         * remote (or otherwise non-local) input files with the Reader.
+         * A source is selected by the scheme of the file name ("http"
+         * for a file name like "https://.../planet.osm.pbf") and opens
+         * the resource, returning a file descriptor the Reader then
+         * reads from like from any local file.
+         *
+         * Sources for the "http", "https", "ftp", and "file" schemes
+         * reading through the "curl" program (which must be installed)
+         * are registered by default. Applications can replace them or
+         * add sources for their own schemes, for instance one doing
+         * parallel ranged GETs through an HTTP client library or
+         * talking to an object store through its SDK, without the
+         * Reader having to know anything about the protocol.
+         */
+        class RemoteSourceFactory {
+
+        public:
+
+            /**
+             * Function opening the resource with the given name. The
+             * offset and length select the byte range to read, with a
+             * length of 0 meaning "from offset to the end". Sources
+             * that can't do partial reads must throw an io_error for
+             * any range other than the whole file. If reading happens
+             * through a child process, its pid has to be stored in
+             * *childpid so the Reader can wait for it on close.
+             *
+             * @returns File descriptor to read the data from.
+             */
+            using create_source_type = std::function<int(const std::string& filename,
+                                                         std::size_t offset,
+                                                         std::size_t length,
+                                                         int* childpid)>;
+
+        private:
+
+            std::map<std::string, create_source_type> m_callbacks;
+
+            RemoteSourceFactory() = default;
+
+        public:
+
+            RemoteSourceFactory(const RemoteSourceFactory&) = delete;
+            RemoteSourceFactory& operator=(const RemoteSourceFactory&) = delete;
+
+            RemoteSourceFactory(RemoteSourceFactory&&) = delete;
+            RemoteSourceFactory& operator=(RemoteSourceFactory&&) = delete;
+
+            ~RemoteSourceFactory() noexcept = default;
+
+            static RemoteSourceFactory& instance() {
+                static RemoteSourceFactory factory;
+                return factory;
+            }
+
+            /**
+             * Register a source for the given scheme, replacing any
+             * source registered for that scheme before.
+             */
+            bool register_remote_source(const std::string& scheme, create_source_type create_source) {
+                m_callbacks[scheme] = std::move(create_source);
+                return true;
+            }
+
+            /// Is there a source registered for the given scheme?
+            bool has_source(const std::string& scheme) const noexcept {
+                return m_callbacks.count(scheme) != 0;
+            }
+
+            /**
+             * Open the resource with the given name through the source
+             * registered for the given scheme.
+             *
+             * @throws osmium::io_error If no source is registered for
+             *         the scheme or the source can't open the resource.
+             */
+            int open(const std::string& scheme, const std::string& filename,
+                     const std::size_t offset, const std::size_t length, int* childpid) const {
+                const auto it = m_callbacks.find(scheme);
+                if (it == m_callbacks.end()) {
+                    throw io_error{std::string{"No remote source registered for scheme '"} + scheme + "'"};
+                }
+                return it->second(filename, offset, length, childpid);
+            }
+
+        }; // class RemoteSourceFactory
+
+        namespace detail {
+
+#ifndef _WIN32
+            /**
+             * Fork and execute the "curl" program fetching the given
+             * file name (or URL). A pipe is created between the child
+             * and the parent. The child writes to the pipe, the parent
+             * reads from it. This function never returns in the child.
+             *
+             * @param filename Filename or URL to fetch.
+             * @param offset Offset of the byte range to fetch.
+             * @param length Length of the byte range to fetch, 0 for
+             *               "from offset to the end".
+             * @param childpid The pid of the child is stored here.
+             * @returns File descriptor of pipe in the parent.
+             * @throws std::system_error if a system call fails.
+             */
+            inline int execute_curl(const std::string& filename, const std::size_t offset, const std::size_t length, int* childpid) {
+                // Build the value for curl's -r option before forking,
+                // allocation in the child after fork isn't safe.
+                std::string range;
+                if (offset > 0 || length > 0) {
+                    range = std::to_string(offset);
+                    range += '-';
+                    if (length > 0) {
+                        range += std::to_string(offset + length - 1);
+                    }
+                }
+
+                int pipefd[2];
+                if (pipe(pipefd) < 0) {
+                    throw std::system_error{errno, std::system_category(), "opening pipe failed"};
+                }
+                const pid_t pid = fork();
+                if (pid < 0) {
+                    throw std::system_error{errno, std::system_category(), "fork failed"};
+                }
+                if (pid == 0) { // child
+                    // close all file descriptors except one end of the pipe
+                    for (int i = 0; i < 32; ++i) {
+                        if (i != pipefd[1]) {
+                            ::close(i);
+                        }
+                    }
+                    if (dup2(pipefd[1], 1) < 0) { // put end of pipe as stdout/stdin
+                        exit(1);
+                    }
+
+                    ::open("/dev/null", O_RDONLY); // stdin
+                    ::open("/dev/null", O_WRONLY); // stderr
+                    // hack: -g switches off globbing in curl which allows [] to be used in file names
+                    // this is important for XAPI URLs
+                    if (range.empty()) {
+                        if (::execlp("curl", "curl", "-g", filename.c_str(), nullptr) < 0) {
+                            exit(1);
+                        }
+                    } else {
+                        if (::execlp("curl", "curl", "-g", "-r", range.c_str(), filename.c_str(), nullptr) < 0) {
+                            exit(1);
+                        }
+                    }
+                }
+                // parent
+                *childpid = pid;
+                ::close(pipefd[1]);
+                return pipefd[0];
+            }
+#else
+            inline int execute_curl(const std::string& /*filename*/, std::size_t /*offset*/, std::size_t /*length*/, int* /*childpid*/) {
+                throw io_error{"Reading OSM files from the network currently not supported on Windows."};
+            }
+#endif
+
+            // we want the register_remote_source() function to run, setting
+            // the variable is only a side-effect, it will never be used
+            const bool registered_curl_sources =
+                osmium::io::RemoteSourceFactory::instance().register_remote_source("http", execute_curl) &&
+                osmium::io::RemoteSourceFactory::instance().register_remote_source("https", execute_curl) &&
+                osmium::io::RemoteSourceFactory::instance().register_remote_source("ftp", execute_curl) &&
+                osmium::io::RemoteSourceFactory::instance().register_remote_source("file", execute_curl);
+
+            // avoid "unused variable" warning
+            inline bool get_registered_curl_sources() noexcept {
+                return registered_curl_sources;
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_REMOTE_SOURCE_HPP
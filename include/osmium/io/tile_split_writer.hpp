@@ -0,0 +1,371 @@
+#ifndef OSMIUM_IO_TILE_SPLIT_WRITER_HPP
+#define OSMIUM_IO_TILE_SPLIT_WRITER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/geom/tile.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/index/index.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/io/overwrite.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Split one input stream into tile-aligned OSM files in a
+         * single pass. This is a handler: apply() it to an input file
+         * and every object is routed to the files of all the tiles (in
+         * a fixed zoom level) it belongs to. Output files are created
+         * lazily, the first time an object is routed to their tile.
+         *
+         * Nodes go to the tile containing their location. Ways go to
+         * the tiles of all their nodes, relations to the tiles of all
+         * their node and way members, so each output file is complete
+         * in the same sense as a bounding box extract with all member
+         * ways included. To resolve the members, the handler records
+         * which tiles each node and way went to in the two indexes
+         * given to the constructor, in the same way
+         * osmium::handler::NodeLocationsForWays records node locations:
+         *
+         * @code
+         * using node_index_type = osmium::index::map::SparseMemArray<
+         *     osmium::unsigned_object_id_type, uint64_t>;
+         * using way_index_type = osmium::index::multimap::SparseMemArray<
+         *     osmium::unsigned_object_id_type, uint64_t>;
+         *
+         * node_index_type node_index;
+         * way_index_type way_index;
+         * osmium::io::TileSplitWriter<node_index_type, way_index_type>
+         *     splitter{8, [](const osmium::geom::Tile& tile) {
+         *         return osmium::io::File{"tile_" + std::to_string(tile.x) +
+         *                                 "_" + std::to_string(tile.y) + ".osm.pbf"};
+         *     }, node_index, way_index};
+         *
+         * osmium::io::Reader reader{"planet.osm.pbf"};
+         * osmium::apply(reader, splitter);
+         * splitter.close();
+         * @endcode
+         *
+         * The input must be ordered in the usual way: nodes before
+         * ways before relations, each sorted by id. If the way node
+         * references already carry locations (because a
+         * NodeLocationsForWays handler ran earlier in the chain), the
+         * node tiles are computed from those locations and the node
+         * index is only used as a fallback.
+         *
+         * Limitations: relation members of type relation are not
+         * resolved, and nodes without a valid location are dropped.
+         * References to missing members are silently skipped unless
+         * ignore_missing_members is set to false in the constructor,
+         * in which case they throw osmium::not_found.
+         *
+         * @tparam TNodeIndex Index of the osmium::index::map::Map kind
+         *         mapping osmium::unsigned_object_id_type to uint64_t.
+         * @tparam TWayIndex Index of the osmium::index::multimap::Multimap
+         *         kind mapping osmium::unsigned_object_id_type to uint64_t.
+         */
+        template <typename TNodeIndex, typename TWayIndex>
+        class TileSplitWriter : public osmium::handler::Handler {
+
+        public:
+
+            /**
+             * The type of the function creating the output File for a
+             * tile. It is called once per tile, when the first object
+             * routed to the tile is seen.
+             */
+            using file_factory_type = std::function<osmium::io::File(const osmium::geom::Tile&)>;
+
+        private:
+
+            enum {
+                // Tile splits commonly produce thousands of files and
+                // there is one staging buffer per file, so this is much
+                // smaller than the default buffer size of the Writer.
+                default_buffer_size = 256ul * 1024ul
+            };
+
+            /**
+             * One output file with the staging buffer for the objects
+             * routed to its tile.
+             */
+            struct target {
+
+                std::unique_ptr<Writer> writer;
+                osmium::memory::Buffer buffer{};
+
+                explicit target(std::unique_ptr<Writer>&& w) :
+                    writer(std::move(w)) {
+                }
+
+            }; // struct target
+
+            std::map<uint64_t, target> m_targets{};
+
+            file_factory_type m_factory;
+
+            TNodeIndex& m_node_index;
+
+            TWayIndex& m_way_index;
+
+            osmium::io::Header m_header;
+
+            std::vector<uint64_t> m_tiles{};
+
+            uint32_t m_zoom;
+
+            bool m_ignore_missing_members;
+
+            bool m_way_index_sorted = false;
+
+            static uint64_t encode_tile(const osmium::geom::Tile& tile) noexcept {
+                return (static_cast<uint64_t>(tile.x) << 32u) | tile.y;
+            }
+
+            osmium::geom::Tile decode_tile(const uint64_t value) const noexcept {
+                return osmium::geom::Tile{m_zoom,
+                                          static_cast<uint32_t>(value >> 32u),
+                                          static_cast<uint32_t>(value & 0xffffffffu)};
+            }
+
+            target& get_target(const uint64_t tile) {
+                const auto it = m_targets.find(tile);
+                if (it != m_targets.end()) {
+                    return it->second;
+                }
+                const osmium::io::File file = m_factory(decode_tile(tile));
+                return m_targets.emplace(tile,
+                    target{std::unique_ptr<Writer>{new Writer{file, m_header, overwrite::allow}}}).first->second;
+            }
+
+            void flush_target(target& t) {
+                if (t.buffer && t.buffer.committed() > 0) {
+                    osmium::memory::Buffer buffer{default_buffer_size,
+                                                  osmium::memory::Buffer::auto_grow::no};
+                    using std::swap;
+                    swap(t.buffer, buffer);
+
+                    (*t.writer)(std::move(buffer));
+                }
+            }
+
+            void write_to(const uint64_t tile, const osmium::OSMObject& object) {
+                target& t = get_target(tile);
+                if (!t.buffer) {
+                    t.buffer = osmium::memory::Buffer{default_buffer_size,
+                                                      osmium::memory::Buffer::auto_grow::no};
+                }
+                try {
+                    t.buffer.push_back(object);
+                } catch (const osmium::buffer_is_full&) {
+                    flush_target(t);
+                    t.buffer.push_back(object);
+                }
+            }
+
+            /// Remove duplicate tiles collected in m_tiles.
+            void unique_tiles() {
+                std::sort(m_tiles.begin(), m_tiles.end());
+                m_tiles.erase(std::unique(m_tiles.begin(), m_tiles.end()), m_tiles.end());
+            }
+
+            void add_node_tile(const osmium::unsigned_object_id_type id, const osmium::Location& location) {
+                if (location.valid()) {
+                    m_tiles.push_back(encode_tile(osmium::geom::Tile{m_zoom, location}));
+                    return;
+                }
+                try {
+                    m_tiles.push_back(m_node_index.get(id));
+                } catch (const osmium::not_found&) {
+                    if (!m_ignore_missing_members) {
+                        throw;
+                    }
+                }
+            }
+
+        public:
+
+            /**
+             * Create a TileSplitWriter splitting into tiles of the
+             * given zoom level.
+             *
+             * @param zoom The zoom level of the tiles to split into.
+             * @param factory Function creating the output File for a
+             *        tile, see file_factory_type. Existing files are
+             *        overwritten.
+             * @param node_index The index storing for each node the
+             *        tile it went to. Use one of the map indexes with
+             *        uint64_t values; choose the implementation like
+             *        you would for a NodeLocationsForWays handler.
+             * @param way_index The multimap index storing for each way
+             *        the tiles it went to.
+             * @param header Header written to every output file.
+             * @param ignore_missing_members If true (the default),
+             *        references to objects not seen earlier in the
+             *        input are skipped, otherwise they throw
+             *        osmium::not_found.
+             *
+             * @pre @code zoom <= 30 @endcode
+             */
+            TileSplitWriter(const uint32_t zoom,
+                            file_factory_type factory,
+                            TNodeIndex& node_index,
+                            TWayIndex& way_index,
+                            osmium::io::Header header = osmium::io::Header{},
+                            const bool ignore_missing_members = true) :
+                m_factory(std::move(factory)),
+                m_node_index(node_index),
+                m_way_index(way_index),
+                m_header(std::move(header)),
+                m_zoom(zoom),
+                m_ignore_missing_members(ignore_missing_members) {
+                assert(zoom <= osmium::geom::Tile::max_zoom);
+            }
+
+            /// The number of tiles that have an output file so far.
+            std::size_t size() const noexcept {
+                return m_targets.size();
+            }
+
+            /**
+             * Route a node to the tile containing its location. Nodes
+             * without a valid location are dropped.
+             */
+            void node(const osmium::Node& node) {
+                if (!node.location().valid()) {
+                    return;
+                }
+                const uint64_t tile = encode_tile(osmium::geom::Tile{m_zoom, node.location()});
+                m_node_index.set(node.positive_id(), tile);
+                write_to(tile, node);
+            }
+
+            /**
+             * Route a way to the tiles of all its nodes.
+             */
+            void way(const osmium::Way& way) {
+                m_tiles.clear();
+                for (const auto& node_ref : way.nodes()) {
+                    add_node_tile(node_ref.positive_ref(), node_ref.location());
+                }
+                unique_tiles();
+                for (const uint64_t tile : m_tiles) {
+                    m_way_index.set(way.positive_id(), tile);
+                    write_to(tile, way);
+                }
+            }
+
+            /**
+             * Route a relation to the tiles of all its node and way
+             * members. Members of type relation are ignored.
+             */
+            void relation(const osmium::Relation& relation) {
+                if (!m_way_index_sorted) {
+                    m_way_index.sort();
+                    m_way_index_sorted = true;
+                }
+                m_tiles.clear();
+                for (const auto& member : relation.members()) {
+                    if (member.type() == osmium::item_type::node) {
+                        add_node_tile(member.positive_ref(), osmium::Location{});
+                    } else if (member.type() == osmium::item_type::way) {
+                        const auto range = m_way_index.get_all(member.positive_ref());
+                        if (range.first == range.second && !m_ignore_missing_members) {
+                            throw osmium::not_found{member.positive_ref()};
+                        }
+                        for (auto it = range.first; it != range.second; ++it) {
+                            m_tiles.push_back(it->second);
+                        }
+                    }
+                }
+                unique_tiles();
+                for (const uint64_t tile : m_tiles) {
+                    write_to(tile, relation);
+                }
+            }
+
+            /**
+             * Flush the staging buffers of all output files. This is
+             * usually not needed as the buffers get flushed on close()
+             * automatically.
+             *
+             * @throws Some form of osmium::io_error when there is a problem.
+             */
+            void flush() {
+                for (auto& t : m_targets) {
+                    flush_target(t.second);
+                }
+            }
+
+            /**
+             * Flushes all staging buffers and closes all output files.
+             * If you do not call this, the destructors of the Writers
+             * will also do the same thing, but will ignore any errors.
+             *
+             * @throws Some form of osmium::io_error when there is a problem.
+             */
+            void close() {
+                for (auto& t : m_targets) {
+                    flush_target(t.second);
+                    t.second.writer->close();
+                }
+            }
+
+        }; // class TileSplitWriter
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_TILE_SPLIT_WRITER_HPP
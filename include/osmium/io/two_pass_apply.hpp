@@ -0,0 +1,122 @@
+#ifndef OSMIUM_IO_TWO_PASS_APPLY_HPP
+#define OSMIUM_IO_TWO_PASS_APPLY_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/handler/check_order.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/visitor.hpp>
+
+namespace osmium {
+
+    /**
+     * Run the usual two-pass pattern over an OSM file with a single
+     * sequential read: pass 1 (typically building a node index) gets
+     * all the nodes, pass 2 (typically assembling ways and relations)
+     * gets all the ways and relations. In an ordered OSM file all
+     * nodes come before the first way, so the moment a way or relation
+     * shows up, pass 1 is complete: it is flushed and pass 2 starts
+     * immediately, on the same open file, with the readahead and
+     * decoding pipeline still warm. Compared to opening the file twice
+     * this saves the teardown, reopen and rebuild of the whole reader
+     * machinery between the passes.
+     *
+     * The file is decoded in parallel on the given thread pool like
+     * with any Reader; the handlers themselves run on the calling
+     * thread, in file order.
+     *
+     * @code
+     * index_type index;
+     * location_handler_type pass1{index};
+     * MyWayHandler pass2{index};
+     * osmium::two_pass_apply(osmium::io::File{filename}, pass1, pass2);
+     * @endcode
+     *
+     * The input must be ordered (nodes, then ways, then relations,
+     * as checked by osmium::handler::CheckOrder): once pass 1 has been
+     * flushed there is no way to deliver a late node to it, so an
+     * osmium::out_of_order_error is thrown when a node appears after a
+     * way or relation.
+     *
+     * Both handlers get their flush() called, pass 1 when its last
+     * node has been seen, pass 2 at the end of the file.
+     *
+     * @param file The file to read.
+     * @param pass1 Handler that gets all nodes.
+     * @param pass2 Handler that gets all ways and relations.
+     * @param pool The thread pool used for decoding the file.
+     * @throws osmium::out_of_order_error if a node appears after a way
+     *         or relation.
+     */
+    template <typename TPass1, typename TPass2>
+    void two_pass_apply(const osmium::io::File& file, TPass1& pass1, TPass2& pass2,
+                        osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+        osmium::io::Reader reader{file, pool, osmium::osm_entity_bits::nwr};
+
+        bool in_pass1 = true;
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                if (object.type() == osmium::item_type::node) {
+                    if (!in_pass1) {
+                        throw osmium::out_of_order_error{"Found a node after a way or relation. two_pass_apply() needs ordered input.", object.id()};
+                    }
+                    apply_item(object, pass1);
+                } else {
+                    if (in_pass1) {
+                        // All nodes have been seen, finish pass 1 and
+                        // switch to pass 2 without leaving the read loop.
+                        apply_flush(pass1);
+                        in_pass1 = false;
+                    }
+                    apply_item(object, pass2);
+                }
+            }
+        }
+
+        if (in_pass1) {
+            // The file contained no ways or relations at all.
+            apply_flush(pass1);
+        }
+        apply_flush(pass2);
+        reader.close();
+    }
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_TWO_PASS_APPLY_HPP
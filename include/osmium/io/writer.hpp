@@ -44,8 +44,10 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/writer_options.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/thread/pool.hpp>
+#include <osmium/thread/queue.hpp>
 #include <osmium/thread/util.hpp>
-#include <osmium/util/config.hpp>
+#include <osmium/util/tuning.hpp>
+#include <osmium/util/verbose_output.hpp>
 #include <osmium/version.hpp>
 
 #include <cassert>
@@ -69,7 +71,7 @@ namespace osmium {
         namespace detail {
 
             inline std::size_t get_output_queue_size() noexcept {
-                return osmium::config::get_max_queue_size("OUTPUT", 20);
+                return osmium::config::tuning().output_queue_size;
             }
 
         } // namespace detail
@@ -240,6 +242,14 @@ namespace osmium {
                     options.pool = &thread::Pool::default_instance();
                 }
 
+                // Unless the user fixed the queue size through the
+                // environment, let the queue limit adapt to the
+                // observed stalls, starting from the default.
+                if (!osmium::config::tuning().output_queue_size_fixed) {
+                    m_output_queue.set_adaptive_size(detail::get_output_queue_size(),
+                                                     detail::get_output_queue_size() * 8);
+                }
+
                 m_output = osmium::io::detail::OutputFormatFactory::instance().create_output(*options.pool, m_file, m_output_queue);
 
                 if (options.header.get("generator").empty()) {
@@ -349,6 +359,32 @@ namespace osmium {
                 });
             }
 
+            /**
+             * Write a pre-serialized blob record to the output file
+             * byte-for-byte, without decoding and re-encoding it. Use
+             * this to copy blobs that your program does not change
+             * from the input file to the output file, for example all
+             * node blobs of a job that only filters ways. The raw
+             * bytes are ordered correctly with respect to objects
+             * written through operator() before and after this call.
+             *
+             * This only works for PBF output, because only PBF files
+             * are a sequence of self-contained records. The record
+             * must be a complete blob record (length bytes, BlobHeader
+             * and Blob) as found in a PBF file, see
+             * osmium::io::PBFBlobSource for a way to get those.
+             *
+             * @param data The raw blob record. Moved into this function.
+             * @throws osmium::io_error if the output format is not PBF
+             *         or there is a problem writing.
+             */
+            void write_raw_blob(std::string&& data) {
+                ensure_cleanup([&](){
+                    do_flush();
+                    m_output->write_raw_blob(std::move(data));
+                });
+            }
+
             /**
              * Flushes internal buffer and closes output file. If you do not
              * call this, the destructor of Writer will also do the same
@@ -366,6 +402,61 @@ namespace osmium {
                 }
             }
 
+            /**
+             * Snapshot of the metrics of a Writer, taken with the
+             * metrics() member function.
+             */
+            struct writer_metrics {
+
+                /// Counters of the queue with the encoded output data.
+                osmium::thread::queue_counters raw_output_queue;
+
+            }; // struct writer_metrics
+
+            /**
+             * Get a snapshot of the metrics of this writer. Can be
+             * called at any time from any thread, the counters are
+             * cheap enough to be always on. Use this to find out where
+             * the write pipeline stalls, see
+             * osmium::thread::queue_counters for how to interpret the
+             * counts.
+             */
+            writer_metrics metrics() const {
+                writer_metrics result;
+                result.raw_output_queue = m_output_queue.counters();
+                return result;
+            }
+
+            /**
+             * Print a breakdown of where this writer's pipeline spent
+             * its time waiting. Prints nothing if the VerboseOutput is
+             * not in verbose mode. Usually called through the
+             * close(VerboseOutput&) overload, but can be called at any
+             * time, for instance periodically during a long run.
+             */
+            void report_metrics(osmium::util::VerboseOutput& out, const char* name = "writer") const {
+                if (!out.verbose()) {
+                    return;
+                }
+                const writer_metrics m = metrics();
+                out << name << " pipeline for '" << m_file.filename() << "':\n";
+                out << "  raw output queue: " << m.raw_output_queue.push << " blocks serialized\n";
+                out << "    serializer stalled " << m.raw_output_queue.full
+                    << " times waiting for compression/file write (write wait)\n";
+                out << "    file write stalled " << m.raw_output_queue.empty
+                    << " times waiting for serialized data (serialize is the bottleneck)\n";
+            }
+
+            /**
+             * Close down the Writer as with close(), then print the
+             * pipeline breakdown from report_metrics() through the
+             * specified VerboseOutput.
+             */
+            void close(osmium::util::VerboseOutput& out) {
+                close();
+                report_metrics(out);
+            }
+
         }; // class Writer
 
     } // namespace io
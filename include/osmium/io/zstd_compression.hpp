@@ -0,0 +1,338 @@
+#ifndef OSMIUM_IO_ZSTD_COMPRESSION_HPP
+#define OSMIUM_IO_ZSTD_COMPRESSION_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Include this file if you want to read or write zstd-compressed OSM
+ * files (`.osm.zst` and similar).
+ *
+ * @attention If you include this file, you'll need to link with
+ *            `libzstd` (version 1.4.0 or newer).
+ */
+
+#include <osmium/io/compression.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/io/file_compression.hpp>
+#include <osmium/io/writer_options.hpp>
+
+#include <zstd.h>
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+namespace osmium {
+
+    /**
+     * Exception thrown when there are problems compressing or
+     * decompressing zstd files.
+     */
+    struct zstd_error : public io_error {
+
+        std::size_t zstd_error_code = 0;
+
+        zstd_error(const std::string& what, const std::size_t error_code) :
+            io_error(what + ": " + ZSTD_getErrorName(error_code)),
+            zstd_error_code(error_code) {
+        }
+
+        explicit zstd_error(const std::string& what) :
+            io_error(what) {
+        }
+
+    }; // struct zstd_error
+
+    namespace io {
+
+        namespace detail {
+
+            inline std::size_t check_zstd_result(const std::size_t result, const char* msg) {
+                if (ZSTD_isError(result)) {
+                    throw osmium::zstd_error{std::string{"zstd error: "} + msg, result};
+                }
+                return result;
+            }
+
+        } // namespace detail
+
+        /**
+         * Stream compressor writing a zstd frame. Compression runs
+         * multithreaded on worker threads managed by libzstd itself if
+         * the library was built with multithreading support, otherwise
+         * it falls back to single-threaded compression.
+         */
+        class ZstdCompressor : public Compressor {
+
+            std::string m_output{};
+            ZSTD_CCtx* m_cctx;
+            int m_fd;
+
+            void compress(const std::string& data, const ZSTD_EndDirective end_op) {
+                ZSTD_inBuffer input{data.data(), data.size(), 0};
+
+                while (true) {
+                    m_output.resize(ZSTD_CStreamOutSize());
+                    ZSTD_outBuffer output{&*m_output.begin(), m_output.size(), 0};
+
+                    const std::size_t remaining = detail::check_zstd_result(
+                        ZSTD_compressStream2(m_cctx, &output, &input, end_op), "compress failed");
+
+                    if (output.pos > 0) {
+                        osmium::io::detail::reliable_write(m_fd, m_output.data(), output.pos);
+                    }
+
+                    if (end_op == ZSTD_e_end ? remaining == 0 : input.pos == input.size) {
+                        break;
+                    }
+                }
+            }
+
+        public:
+
+            explicit ZstdCompressor(const int fd, const fsync sync, const int compression_level = ZSTD_CLEVEL_DEFAULT) :
+                Compressor(sync),
+                m_cctx(ZSTD_createCCtx()),
+                m_fd(fd) {
+                if (!m_cctx) {
+                    throw osmium::zstd_error{"zstd error: compression init failed"};
+                }
+                detail::check_zstd_result(
+                    ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_compressionLevel, compression_level),
+                    "setting compression level failed");
+                // Compress on multiple worker threads if the library
+                // supports it. If it doesn't, the call fails and we
+                // silently compress single-threaded.
+                const auto workers = std::thread::hardware_concurrency();
+                if (workers > 1) {
+                    (void)ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_nbWorkers, static_cast<int>(workers));
+                }
+            }
+
+            ZstdCompressor(const ZstdCompressor&) = delete;
+            ZstdCompressor& operator=(const ZstdCompressor&) = delete;
+
+            ZstdCompressor(ZstdCompressor&&) = delete;
+            ZstdCompressor& operator=(ZstdCompressor&&) = delete;
+
+            ~ZstdCompressor() noexcept final {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+                ZSTD_freeCCtx(m_cctx);
+            }
+
+            void write(const std::string& data) final {
+                assert(m_fd >= 0);
+                compress(data, ZSTD_e_continue);
+            }
+
+            void close() final {
+                if (m_fd >= 0) {
+                    const int fd = m_fd;
+                    compress(std::string{}, ZSTD_e_end);
+                    m_fd = -1;
+                    if (do_fsync()) {
+                        osmium::io::detail::reliable_fsync(fd);
+                    }
+                    osmium::io::detail::reliable_close(fd);
+                }
+            }
+
+        }; // class ZstdCompressor
+
+        class ZstdDecompressor : public Decompressor {
+
+            std::string m_input{};
+            ZSTD_DCtx* m_dctx;
+            std::size_t m_input_pos = 0;
+            std::size_t m_offset = 0;
+            int m_fd;
+            bool m_eof = false;
+
+        public:
+
+            explicit ZstdDecompressor(const int fd) :
+                m_dctx(ZSTD_createDCtx()),
+                m_fd(fd) {
+                if (!m_dctx) {
+                    osmium::io::detail::reliable_close(fd);
+                    throw osmium::zstd_error{"zstd error: decompression init failed"};
+                }
+            }
+
+            ZstdDecompressor(const ZstdDecompressor&) = delete;
+            ZstdDecompressor& operator=(const ZstdDecompressor&) = delete;
+
+            ZstdDecompressor(ZstdDecompressor&&) = delete;
+            ZstdDecompressor& operator=(ZstdDecompressor&&) = delete;
+
+            ~ZstdDecompressor() noexcept final {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+                ZSTD_freeDCtx(m_dctx);
+            }
+
+            std::string read() final {
+                std::string output;
+
+                while (output.empty() && !(m_eof && m_input_pos == m_input.size())) {
+                    if (m_input_pos == m_input.size()) {
+                        m_input.resize(osmium::io::Decompressor::input_buffer_size);
+                        const auto nread = osmium::io::detail::reliable_read(m_fd, &*m_input.begin(), osmium::io::Decompressor::input_buffer_size);
+                        m_input.resize(static_cast<std::string::size_type>(nread));
+                        m_input_pos = 0;
+                        if (nread == 0) {
+                            m_eof = true;
+                            break;
+                        }
+                    }
+
+                    output.resize(osmium::io::Decompressor::input_buffer_size);
+                    ZSTD_inBuffer input{m_input.data(), m_input.size(), m_input_pos};
+                    ZSTD_outBuffer out{&*output.begin(), output.size(), 0};
+
+                    detail::check_zstd_result(
+                        ZSTD_decompressStream(m_dctx, &out, &input), "decompress failed");
+
+                    m_offset += input.pos - m_input_pos;
+                    m_input_pos = input.pos;
+                    output.resize(out.pos);
+                }
+
+                set_offset(m_offset);
+
+                return output;
+            }
+
+            void close() final {
+                if (m_fd >= 0) {
+                    const int fd = m_fd;
+                    m_fd = -1;
+                    osmium::io::detail::reliable_close(fd);
+                }
+            }
+
+        }; // class ZstdDecompressor
+
+        class ZstdBufferDecompressor : public Decompressor {
+
+            ZSTD_DCtx* m_dctx;
+            const char* m_buffer;
+            std::size_t m_buffer_size;
+            std::size_t m_buffer_pos = 0;
+
+        public:
+
+            ZstdBufferDecompressor(const char* buffer, const std::size_t size) :
+                m_dctx(ZSTD_createDCtx()),
+                m_buffer(buffer),
+                m_buffer_size(size) {
+                if (!m_dctx) {
+                    throw osmium::zstd_error{"zstd error: decompression init failed"};
+                }
+            }
+
+            ZstdBufferDecompressor(const ZstdBufferDecompressor&) = delete;
+            ZstdBufferDecompressor& operator=(const ZstdBufferDecompressor&) = delete;
+
+            ZstdBufferDecompressor(ZstdBufferDecompressor&&) = delete;
+            ZstdBufferDecompressor& operator=(ZstdBufferDecompressor&&) = delete;
+
+            ~ZstdBufferDecompressor() noexcept final {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+                ZSTD_freeDCtx(m_dctx);
+            }
+
+            std::string read() final {
+                std::string output;
+
+                if (m_buffer_pos < m_buffer_size) {
+                    output.resize(osmium::io::Decompressor::input_buffer_size);
+                    ZSTD_inBuffer input{m_buffer, m_buffer_size, m_buffer_pos};
+                    ZSTD_outBuffer out{&*output.begin(), output.size(), 0};
+
+                    detail::check_zstd_result(
+                        ZSTD_decompressStream(m_dctx, &out, &input), "decompress failed");
+
+                    if (input.pos == m_buffer_pos && out.pos == 0) {
+                        throw osmium::zstd_error{"zstd error: decompress failed: truncated input"};
+                    }
+
+                    m_buffer_pos = input.pos;
+                    output.resize(out.pos);
+                }
+
+                return output;
+            }
+
+            void close() final {
+            }
+
+        }; // class ZstdBufferDecompressor
+
+        namespace detail {
+
+            // we want the register_compression() function to run, setting
+            // the variable is only a side-effect, it will never be used
+            const bool registered_zstd_compression = osmium::io::CompressionFactory::instance().register_compression(osmium::io::file_compression::zstd,
+                [](const int fd, const fsync sync) { return new osmium::io::ZstdCompressor{fd, sync}; },
+                [](const int fd) { return new osmium::io::ZstdDecompressor{fd}; },
+                [](const char* buffer, const std::size_t size) { return new osmium::io::ZstdBufferDecompressor{buffer, size}; }
+            );
+
+            // dummy function to silence the unused variable warning from above
+            inline bool get_registered_zstd_compression() noexcept {
+                return registered_zstd_compression;
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_ZSTD_COMPRESSION_HPP
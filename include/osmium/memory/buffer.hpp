@@ -37,16 +37,24 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/memory/item_iterator.hpp>
 #include <osmium/osm/entity.hpp>
 #include <osmium/util/compatibility.hpp>
+#include <osmium/util/profiling.hpp>
 
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <functional>
+#include <future>
 #include <iterator>
 #include <memory>
 #include <stdexcept>
 #include <utility>
+#include <vector>
+
+#ifdef __linux__
+# include <sys/mman.h>
+#endif
 
 namespace osmium {
 
@@ -68,6 +76,42 @@ namespace osmium {
      */
     namespace memory {
 
+        namespace detail {
+
+            /**
+             * Hint to the kernel that this allocation should be backed by
+             * (transparent) huge pages if possible. Iterating over the
+             * items in very large buffers is TLB-miss-bound with normal
+             * 4 kB pages. Does nothing for allocations smaller than one
+             * huge page or on systems without transparent huge page
+             * support. Failure is ignored, this is only an optimization.
+             *
+             * Define OSMIUM_DONT_USE_HUGE_PAGES if you don't want this,
+             * for instance because your transparent huge page setup has
+             * problematic latency.
+             */
+            inline void advise_huge_pages(const unsigned char* data, const std::size_t size) noexcept {
+#if defined(__linux__) && defined(MADV_HUGEPAGE) && !defined(OSMIUM_DONT_USE_HUGE_PAGES)
+                enum : std::size_t {
+                    huge_page_size = 2ul * 1024ul * 1024ul,
+                    small_page_size = 4ul * 1024ul
+                };
+                if (size >= huge_page_size) {
+                    const auto addr = reinterpret_cast<uintptr_t>(data);
+                    const uintptr_t begin = (addr + (small_page_size - 1)) & ~uintptr_t(small_page_size - 1);
+                    const uintptr_t end = (addr + size) & ~uintptr_t(small_page_size - 1);
+                    if (end > begin) {
+                        ::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE); // NOLINT(performance-no-int-to-ptr)
+                    }
+                }
+#else
+                (void)data;
+                (void)size;
+#endif
+            }
+
+        } // namespace detail
+
         /**
          * A memory area for storing OSM objects and other items. Each item stored
          * has a type and a length. See the Item class for details.
@@ -142,6 +186,7 @@ namespace osmium {
                 std::unique_ptr<Buffer> old{new Buffer{std::move(m_memory), m_capacity, m_committed}};
                 m_memory = std::unique_ptr<unsigned char[]>{new unsigned char[m_capacity]};
                 m_data = m_memory.get();
+                detail::advise_huge_pages(m_data, m_capacity);
 
                 m_written -= m_committed;
                 std::copy_n(old->data() + m_committed, m_written, m_data);
@@ -223,18 +268,21 @@ namespace osmium {
              *             The Buffer will manage this memory.
              * @param capacity The size of the memory for this buffer.
              * @param committed The size of the initialized data. If this is 0, the buffer startes out empty.
+             * @param auto_grow Should this buffer automatically grow when it
+             *        becomes to small?
              *
              * @throws std::invalid_argument if the capacity or committed isn't
              *         a multiple of the alignment or if committed is larger
              *         than capacity.
              */
-            explicit Buffer(std::unique_ptr<unsigned char[]> data, std::size_t capacity, std::size_t committed) :
+            explicit Buffer(std::unique_ptr<unsigned char[]> data, std::size_t capacity, std::size_t committed, auto_grow auto_grow = auto_grow::no) :
                 m_next_buffer(),
                 m_memory(std::move(data)),
                 m_data(m_memory.get()),
                 m_capacity(capacity),
                 m_written(committed),
-                m_committed(committed) {
+                m_committed(committed),
+                m_auto_grow(auto_grow) {
                 if (capacity % align_bytes != 0) {
                     throw std::invalid_argument{"buffer capacity needs to be multiple of alignment"};
                 }
@@ -264,6 +312,7 @@ namespace osmium {
                 m_data(m_memory.get()),
                 m_capacity(calculate_capacity(capacity)),
                 m_auto_grow(auto_grow) {
+                detail::advise_huge_pages(m_data, m_capacity);
             }
 
             // buffers can not be copied
@@ -425,6 +474,40 @@ namespace osmium {
                     swap(m_memory, memory);
                     m_data = m_memory.get();
                     m_capacity = size;
+                    detail::advise_huge_pages(m_data, m_capacity);
+                }
+            }
+
+            /**
+             * Make sure the buffer has space for at least the given number
+             * of additional bytes, growing it at most once. This is a
+             * hint: call it when you know (or can estimate) the total
+             * size of something you are about to build from many small
+             * pieces, so the growth checks in reserve_space() never hit
+             * their slow path while you build it.
+             *
+             * Does nothing on buffers that can not grow automatically
+             * (auto_grow::no or external memory management or
+             * auto_grow::internal, which creates nested buffers instead
+             * of growing); those keep their usual behaviour of throwing
+             * osmium::buffer_is_full when the space runs out.
+             *
+             * @pre The buffer must be valid.
+             *
+             * @param size Number of additional bytes needed.
+             */
+            void reserve_capacity(const std::size_t size) {
+                assert(m_data && "This must be a valid buffer");
+                if (!m_memory || m_auto_grow != auto_grow::yes) {
+                    return;
+                }
+                if (m_written + size > m_capacity) {
+                    OSMIUM_PROFILE_COUNT(buffer_grows);
+                    std::size_t new_capacity = m_capacity * 2;
+                    while (m_written + size > new_capacity) {
+                        new_capacity *= 2;
+                    }
+                    grow(new_capacity);
                 }
             }
 
@@ -453,6 +536,49 @@ namespace osmium {
                 return std::move(buffer->m_next_buffer);
             }
 
+            /**
+             * Release the memory block of an internally memory-managed
+             * buffer, for instance to put it into an
+             * osmium::memory::BufferPool for reuse. The buffer is invalid
+             * afterwards. Nested buffers (created by auto_grow::internal)
+             * are destroyed, get them with get_last_nested() first if you
+             * want to reuse their memory, too.
+             *
+             * @returns The memory block or nullptr if the buffer is
+             *          invalid or externally memory-managed.
+             */
+            std::unique_ptr<unsigned char[]> release_memory() noexcept {
+                assert(m_builder_count == 0 && "Make sure there are no Builder objects still in scope");
+                m_next_buffer.reset();
+                m_data = nullptr;
+                m_capacity = 0;
+                m_written = 0;
+                m_committed = 0;
+                return std::move(m_memory);
+            }
+
+            /**
+             * Touch every page of the buffer memory from the calling
+             * thread. On NUMA systems the operating system places memory
+             * on the node of the thread that first writes to it, so call
+             * this from the thread that will later read the data to keep
+             * those reads local to its node. Combined with a BufferPool
+             * the pages keep their placement when the buffer memory is
+             * reused.
+             *
+             * @pre The buffer must be valid and empty.
+             */
+            void prefault() noexcept {
+                assert(m_data && "This must be a valid buffer");
+                assert(m_written == 0 && "The buffer must be empty");
+                enum : std::size_t {
+                    page_size = 4096ul
+                };
+                for (std::size_t offset = 0; offset < m_capacity; offset += page_size) {
+                    m_data[offset] = 0;
+                }
+            }
+
             /**
              * Mark currently written bytes in the buffer as committed.
              *
@@ -564,6 +690,7 @@ namespace osmium {
                     if (!m_memory || m_auto_grow == auto_grow::no) {
                         throw osmium::buffer_is_full{};
                     }
+                    OSMIUM_PROFILE_COUNT(buffer_grows);
                     if (m_auto_grow == auto_grow::internal && m_committed != 0) {
                         grow_internal();
                     }
@@ -604,6 +731,57 @@ namespace osmium {
                 return *reinterpret_cast<T*>(target);
             }
 
+            /**
+             * Add all items in the range [first, last) to the buffer. This
+             * is faster than calling add_item() for every item, because
+             * the capacity is checked only once for the complete range and
+             * runs of consecutive items are copied with a single memcpy.
+             * Use this when forwarding most items from one buffer to
+             * another, for instance in a filtering pipeline.
+             *
+             * Note that you have to eventually call commit() to actually
+             * commit this data.
+             *
+             * @pre The buffer must be valid.
+             * @pre The items in the range must not be in this buffer.
+             *
+             * @tparam TIterator Forward iterator over items, such as the
+             *         iterators of a Buffer or BufferView.
+             *
+             * @param first Iterator to the first item to be copied.
+             * @param last Iterator one past the last item to be copied.
+             */
+            template <typename TIterator>
+            void add_items(TIterator first, TIterator last) {
+                assert(m_data && "This must be a valid buffer");
+
+                std::size_t size = 0;
+                for (TIterator it = first; it != last; ++it) {
+                    size += it->padded_size();
+                }
+                if (size == 0) {
+                    return;
+                }
+
+                unsigned char* target = reserve_space(size);
+
+                const unsigned char* run_begin = nullptr;
+                std::size_t run_size = 0;
+                for (TIterator it = first; it != last; ++it) {
+                    const unsigned char* data = reinterpret_cast<const unsigned char*>(&*it);
+                    if (data != run_begin + run_size) {
+                        if (run_size > 0) {
+                            std::copy_n(run_begin, run_size, target);
+                            target += run_size;
+                        }
+                        run_begin = data;
+                        run_size = 0;
+                    }
+                    run_size += it->padded_size();
+                }
+                std::copy_n(run_begin, run_size, target);
+            }
+
             /**
              * Add committed contents of the given buffer to this buffer.
              *
@@ -875,6 +1053,118 @@ namespace osmium {
                 m_committed = m_written;
             }
 
+            /**
+             * Purge removed items from the buffer like purge_removed()
+             * above, but do the actual moving of the data on the given
+             * thread pool (usually osmium::thread::Pool). The buffer is
+             * partitioned at item boundaries and the surviving items of
+             * each partition are copied into a fresh memory block
+             * concurrently.
+             *
+             * For every non-removed item that moves its position, the
+             * 'moving_in_buffer' callback is called on this thread, in
+             * the same order as in the serial version.
+             *
+             * Only worth it for buffers many megabytes in size; small or
+             * externally memory-managed buffers are purged serially.
+             *
+             * Note that calling this function invalidates all iterators
+             * on this buffer, all offsets in this buffer, and all
+             * pointers into this buffer.
+             *
+             * @pre The buffer must be valid.
+             */
+            template <typename TCallbackClass, typename TPool>
+            void purge_removed(TCallbackClass* callback, TPool& pool) {
+                assert(m_data && "This must be a valid buffer");
+
+                enum : std::size_t {
+                    min_parallel_purge_size = 16ul * 1024ul * 1024ul,
+                    purge_chunk_size = 4ul * 1024ul * 1024ul
+                };
+
+                if (!m_memory || m_committed < min_parallel_purge_size) {
+                    purge_removed(callback);
+                    return;
+                }
+
+                struct copy_run {
+                    std::size_t src_offset;
+                    std::size_t dst_offset;
+                    std::size_t size;
+                };
+
+                // Serial scan deciding where every surviving item goes,
+                // collecting contiguous surviving items into runs that
+                // can be copied with one big memcpy each. The callbacks
+                // happen here, in the same order as in the serial
+                // version above.
+                std::vector<copy_run> runs;
+                std::size_t dst_offset = 0;
+
+                iterator next;
+                for (iterator it_read = begin(); it_read != end(); it_read = next) {
+                    next = std::next(it_read);
+                    if (it_read->removed()) {
+                        continue;
+                    }
+                    assert(it_read.data() >= data());
+                    const auto src_offset = static_cast<std::size_t>(it_read.data() - data());
+                    const std::size_t size = it_read->padded_size();
+                    if (src_offset != dst_offset) {
+                        callback->moving_in_buffer(src_offset, dst_offset);
+                    }
+                    if (!runs.empty() && runs.back().src_offset + runs.back().size == src_offset) {
+                        runs.back().size += size;
+                    } else {
+                        runs.push_back(copy_run{src_offset, dst_offset, size});
+                    }
+                    dst_offset += size;
+                }
+
+                std::unique_ptr<unsigned char[]> new_memory{new unsigned char[m_capacity]};
+                detail::advise_huge_pages(new_memory.get(), m_capacity);
+
+                // Copying into fresh memory means the tasks can not
+                // overwrite data another task still has to read, so they
+                // can all run concurrently.
+                struct copy_task {
+
+                    const unsigned char* src_data;
+                    unsigned char* dst_data;
+                    const copy_run* runs;
+                    std::size_t count;
+
+                    void operator()() const {
+                        for (std::size_t i = 0; i < count; ++i) {
+                            std::memcpy(dst_data + runs[i].dst_offset, src_data + runs[i].src_offset, runs[i].size);
+                        }
+                    }
+
+                }; // struct copy_task
+
+                std::vector<std::future<void>> results;
+                std::size_t first_run = 0;
+                std::size_t chunk_bytes = 0;
+                for (std::size_t i = 0; i < runs.size(); ++i) {
+                    chunk_bytes += runs[i].size;
+                    if (chunk_bytes >= purge_chunk_size || i + 1 == runs.size()) {
+                        results.push_back(pool.submit(copy_task{m_data, new_memory.get(), runs.data() + first_run, i + 1 - first_run}));
+                        first_run = i + 1;
+                        chunk_bytes = 0;
+                    }
+                }
+
+                for (auto& result : results) {
+                    result.get();
+                }
+
+                m_memory = std::move(new_memory);
+                m_data = m_memory.get();
+                m_written = dst_offset;
+                m_committed = dst_offset;
+            }
+
         }; // class Buffer
 
         inline void swap(Buffer& lhs, Buffer& rhs) {
@@ -0,0 +1,197 @@
+#ifndef OSMIUM_MEMORY_BUFFER_POOL_HPP
+#define OSMIUM_MEMORY_BUFFER_POOL_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace memory {
+
+        /**
+         * A thread-safe pool of equal-sized memory blocks for
+         * osmium::memory::Buffer objects. Decoding OSM files allocates
+         * and frees one buffer per data blob; when the buffers are only
+         * held briefly, recycling their memory through a pool avoids
+         * this constant allocator churn.
+         *
+         * Get empty buffers with get_buffer() and hand buffers you are
+         * done with to give_back(). Returning buffers is optional, a
+         * buffer that is simply destroyed frees its memory normally.
+         * The free list is bounded, so the pool never holds on to more
+         * than max_buffers blocks. Blocks of the wrong size (for
+         * instance from buffers that were grown) are not kept.
+         */
+        class BufferPool {
+
+        public:
+
+            enum : std::size_t {
+                default_buffer_capacity = 64ul * 1024ul,
+                default_max_buffers = 64u
+            };
+
+        private:
+
+            std::vector<std::unique_ptr<unsigned char[]>> m_free_blocks{};
+            std::mutex m_mutex{};
+            std::size_t m_buffer_capacity;
+            std::size_t m_max_buffers;
+
+            /// Put the memory block of this buffer on the free list if it fits.
+            void reclaim_block(Buffer& buffer) {
+                if (buffer.capacity() == m_buffer_capacity &&
+                    m_free_blocks.size() < m_max_buffers) {
+                    std::unique_ptr<unsigned char[]> memory{buffer.release_memory()};
+                    if (memory) {
+                        m_free_blocks.push_back(std::move(memory));
+                    }
+                }
+            }
+
+        public:
+
+            explicit BufferPool(std::size_t buffer_capacity = default_buffer_capacity,
+                                std::size_t max_buffers = default_max_buffers) :
+                m_buffer_capacity(padded_length(buffer_capacity)),
+                m_max_buffers(max_buffers) {
+                m_free_blocks.reserve(max_buffers);
+            }
+
+            BufferPool(const BufferPool&) = delete;
+            BufferPool& operator=(const BufferPool&) = delete;
+
+            BufferPool(BufferPool&&) = delete;
+            BufferPool& operator=(BufferPool&&) = delete;
+
+            ~BufferPool() noexcept = default;
+
+            /**
+             * The shared default pool. Parsers draw their buffers from
+             * this pool, give buffers back to it to have their memory
+             * reused.
+             */
+            static BufferPool& default_instance() {
+                static BufferPool pool{};
+                return pool;
+            }
+
+            std::size_t buffer_capacity() const noexcept {
+                return m_buffer_capacity;
+            }
+
+            /// The number of memory blocks currently on the free list.
+            std::size_t free_blocks() {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                return m_free_blocks.size();
+            }
+
+            /**
+             * Get an empty buffer with the capacity of this pool, reusing
+             * a memory block from the free list if one is available.
+             */
+            Buffer get_buffer(Buffer::auto_grow auto_grow = Buffer::auto_grow::internal) {
+                std::unique_ptr<unsigned char[]> memory;
+
+                {
+                    std::lock_guard<std::mutex> lock{m_mutex};
+                    if (!m_free_blocks.empty()) {
+                        memory = std::move(m_free_blocks.back());
+                        m_free_blocks.pop_back();
+                    }
+                }
+
+                if (memory) {
+                    return Buffer{std::move(memory), m_buffer_capacity, 0, auto_grow};
+                }
+                return Buffer{m_buffer_capacity, auto_grow};
+            }
+
+            /**
+             * Fill the free list with up to @p count prefaulted memory
+             * blocks. The pages are touched from the calling thread, so
+             * on NUMA systems they are placed on its node. Call this from
+             * the thread that will consume the buffers before starting
+             * the producing workers and their writes and your reads stay
+             * local to your node. No blocks are added beyond the maximum
+             * free list size of the pool.
+             *
+             * @param count Number of memory blocks wanted on the free list.
+             */
+            void prefault(std::size_t count) {
+                while (true) {
+                    {
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        if (m_free_blocks.size() >= count ||
+                            m_free_blocks.size() >= m_max_buffers) {
+                            return;
+                        }
+                    }
+                    Buffer buffer{m_buffer_capacity, Buffer::auto_grow::internal};
+                    buffer.prefault();
+                    give_back(std::move(buffer));
+                }
+            }
+
+            /**
+             * Return a buffer you are done with to the pool. The memory
+             * blocks of the buffer and of any nested buffers are put on
+             * the free list to be reused, as far as they have the right
+             * size and the free list has room.
+             */
+            void give_back(Buffer&& buffer) {
+                Buffer own{std::move(buffer)};
+
+                std::lock_guard<std::mutex> lock{m_mutex};
+                while (own.has_nested_buffers()) {
+                    std::unique_ptr<Buffer> nested{own.get_last_nested()};
+                    reclaim_block(*nested);
+                }
+                reclaim_block(own);
+            }
+
+        }; // class BufferPool
+
+    } // namespace memory
+
+} // namespace osmium
+
+#endif // OSMIUM_MEMORY_BUFFER_POOL_HPP
@@ -0,0 +1,207 @@
+#ifndef OSMIUM_MEMORY_BUFFER_VIEW_HPP
+#define OSMIUM_MEMORY_BUFFER_VIEW_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item_iterator.hpp>
+#include <osmium/osm/entity.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace osmium {
+
+    namespace memory {
+
+        /**
+         * A non-owning view on a range of items in a committed Buffer.
+         * A view is just a pointer to the buffer and two offsets, copying
+         * it is cheap and never copies any OSM data. Views can be used
+         * everywhere a range of items is expected, for instance with
+         * osmium::apply(), so several threads can each work on their own
+         * slice of one buffer without copying the data first.
+         *
+         * The offsets must be at item boundaries, such as the offsets
+         * returned from Buffer::commit() or derived from buffer iterators.
+         * Use split() to partition a buffer into roughly equal-sized
+         * views at item boundaries.
+         *
+         * The view doesn't own the buffer. The buffer must stay alive and
+         * unmodified as long as any view into it is in use.
+         */
+        class BufferView {
+
+            const Buffer* m_buffer;
+            std::size_t m_begin_offset;
+            std::size_t m_end_offset;
+
+        public:
+
+            using const_iterator = Buffer::t_const_iterator<osmium::OSMEntity>;
+            using iterator = const_iterator;
+
+            /**
+             * Create a view on part of a buffer.
+             *
+             * @pre The buffer must be valid and stay alive longer than
+             *      the view.
+             * @pre Both offsets must be at item boundaries in the
+             *      committed part of the buffer and
+             *      @code begin_offset <= end_offset @endcode must hold.
+             *
+             * @param buffer The buffer this view points into.
+             * @param begin_offset Offset of the first item in the view.
+             * @param end_offset Offset one past the last item in the view.
+             */
+            BufferView(const Buffer& buffer, std::size_t begin_offset, std::size_t end_offset) noexcept :
+                m_buffer(&buffer),
+                m_begin_offset(begin_offset),
+                m_end_offset(end_offset) {
+                assert(buffer && "The buffer must be valid");
+                assert(begin_offset <= end_offset);
+                assert(end_offset <= buffer.committed());
+            }
+
+            /**
+             * Create a view on the complete committed part of a buffer.
+             *
+             * @pre The buffer must be valid and stay alive longer than
+             *      the view.
+             */
+            explicit BufferView(const Buffer& buffer) noexcept :
+                BufferView(buffer, 0, buffer.committed()) {
+            }
+
+            /// The buffer this view points into.
+            const Buffer& buffer() const noexcept {
+                return *m_buffer;
+            }
+
+            /// Offset of the first item in the view.
+            std::size_t begin_offset() const noexcept {
+                return m_begin_offset;
+            }
+
+            /// Offset one past the last item in the view.
+            std::size_t end_offset() const noexcept {
+                return m_end_offset;
+            }
+
+            /// The size of the viewed range in bytes.
+            std::size_t size() const noexcept {
+                return m_end_offset - m_begin_offset;
+            }
+
+            /// Is this view empty?
+            bool empty() const noexcept {
+                return m_begin_offset == m_end_offset;
+            }
+
+            /**
+             * Get an iterator range over all items of type T in the view.
+             */
+            template <typename T>
+            ItemIteratorRange<const T> select() const {
+                return ItemIteratorRange<const T>{m_buffer->data() + m_begin_offset, m_buffer->data() + m_end_offset};
+            }
+
+            /// Iterator to the first OSMEntity in the view.
+            const_iterator cbegin() const {
+                return const_iterator{m_buffer->data() + m_begin_offset, m_buffer->data() + m_end_offset};
+            }
+
+            /// Iterator one past the last OSMEntity in the view.
+            const_iterator cend() const {
+                return const_iterator{m_buffer->data() + m_end_offset, m_buffer->data() + m_end_offset};
+            }
+
+            const_iterator begin() const {
+                return cbegin();
+            }
+
+            const_iterator end() const {
+                return cend();
+            }
+
+        }; // class BufferView
+
+        /**
+         * Partition the committed part of a buffer into (at most) @p count
+         * views of roughly equal size. Split points are always at item
+         * boundaries, so every item ends up in exactly one view and the
+         * views cover the buffer completely and in order. Fewer views are
+         * returned when the buffer contains fewer items than @p count.
+         *
+         * The views don't own the buffer. The buffer must stay alive and
+         * unmodified as long as the views are in use.
+         *
+         * @pre The buffer must be valid.
+         * @pre @code count > 0 @endcode
+         *
+         * @param buffer The buffer to partition.
+         * @param count The maximum number of views wanted.
+         * @returns Vector of non-empty views in buffer order.
+         */
+        inline std::vector<BufferView> split(const Buffer& buffer, std::size_t count) {
+            assert(buffer && "The buffer must be valid");
+            assert(count > 0);
+
+            std::vector<BufferView> views;
+            views.reserve(count);
+
+            const std::size_t part_size = buffer.committed() / count + 1;
+            std::size_t begin_offset = 0;
+            std::size_t offset = 0;
+
+            for (auto it = buffer.cbegin(); it != buffer.cend(); ++it) {
+                offset += it->padded_size();
+                if (offset - begin_offset >= part_size && views.size() + 1 < count) {
+                    views.emplace_back(buffer, begin_offset, offset);
+                    begin_offset = offset;
+                }
+            }
+
+            if (begin_offset < buffer.committed()) {
+                views.emplace_back(buffer, begin_offset, buffer.committed());
+            }
+
+            return views;
+        }
+
+    } // namespace memory
+
+} // namespace osmium
+
+#endif // OSMIUM_MEMORY_BUFFER_VIEW_HPP
@@ -0,0 +1,258 @@
+#ifndef OSMIUM_MEMORY_SCRATCH_ARENA_HPP
+#define OSMIUM_MEMORY_SCRATCH_ARENA_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace osmium {
+
+    namespace memory {
+
+        /**
+         * A bump allocator for short-lived scratch data such as strings
+         * assembled while building OSM objects. Allocations are served
+         * from large blocks by advancing a pointer, so they cost next to
+         * nothing. There is no per-allocation free: reset() throws away
+         * all allocations at once but keeps the blocks, so an arena that
+         * is reset after every object stops calling the allocator
+         * completely once it is warmed up.
+         *
+         * Typical use when synthesizing many objects:
+         * @code
+         * auto& arena = osmium::memory::ScratchArena::instance();
+         * for (...) {
+         *     const char* role = arena.store(some_temporary_string);
+         *     ... build object using role ...
+         *     arena.reset();
+         * }
+         * @endcode
+         *
+         * The arena is not thread-safe. Use instance() to get an arena
+         * local to the current thread.
+         */
+        class ScratchArena {
+
+            struct block_type {
+                std::unique_ptr<char[]> memory;
+                std::size_t size;
+            }; // struct block_type
+
+            enum : std::size_t {
+                min_block_size = 16ul * 1024ul
+            };
+
+            std::vector<block_type> m_blocks;
+            std::size_t m_current_block = 0;
+            std::size_t m_offset = 0;
+
+            char* grow(std::size_t size) {
+                while (m_current_block < m_blocks.size()) {
+                    if (m_blocks[m_current_block].size >= size) {
+                        m_offset = size;
+                        return m_blocks[m_current_block].memory.get();
+                    }
+                    ++m_current_block;
+                }
+                const std::size_t block_size = size > min_block_size ? size : min_block_size;
+                m_blocks.push_back(block_type{std::unique_ptr<char[]>{new char[block_size]}, block_size});
+                m_offset = size;
+                return m_blocks.back().memory.get();
+            }
+
+        public:
+
+            ScratchArena() = default;
+
+            ScratchArena(const ScratchArena&) = delete;
+            ScratchArena& operator=(const ScratchArena&) = delete;
+
+            ScratchArena(ScratchArena&&) = default;
+            ScratchArena& operator=(ScratchArena&&) = default;
+
+            ~ScratchArena() noexcept = default;
+
+            /// Get the scratch arena of the current thread.
+            static ScratchArena& instance() {
+                thread_local ScratchArena arena;
+                return arena;
+            }
+
+            /**
+             * Allocate @p size bytes from the arena. The memory is
+             * uninitialized and stays valid until the next call to
+             * reset().
+             */
+            char* allocate(std::size_t size) {
+                if (m_current_block < m_blocks.size() &&
+                    size <= m_blocks[m_current_block].size - m_offset) {
+                    char* memory = m_blocks[m_current_block].memory.get() + m_offset;
+                    m_offset += size;
+                    return memory;
+                }
+                if (m_current_block < m_blocks.size()) {
+                    ++m_current_block;
+                }
+                return grow(size);
+            }
+
+            /**
+             * Allocate @p size bytes with the specified alignment.
+             * Alignments larger than that of std::max_align_t are not
+             * supported. The memory is uninitialized and stays valid
+             * until the next call to reset().
+             */
+            void* allocate_aligned(std::size_t size, std::size_t align) {
+                if (m_current_block < m_blocks.size()) {
+                    char* base = m_blocks[m_current_block].memory.get();
+                    const std::size_t misalign = reinterpret_cast<std::uintptr_t>(base + m_offset) & (align - 1);
+                    const std::size_t padding = misalign ? align - misalign : 0;
+                    if (size + padding <= m_blocks[m_current_block].size - m_offset) {
+                        m_offset += padding;
+                        char* memory = base + m_offset;
+                        m_offset += size;
+                        return memory;
+                    }
+                    ++m_current_block;
+                }
+                // Blocks are aligned for std::max_align_t.
+                return grow(size);
+            }
+
+            /**
+             * Copy @p size bytes into the arena and add a terminating
+             * null byte. The copy stays valid until the next call to
+             * reset().
+             *
+             * @returns Pointer to the null-terminated copy.
+             */
+            const char* store(const char* data, std::size_t size) {
+                char* memory = allocate(size + 1);
+                std::memcpy(memory, data, size);
+                memory[size] = '\0';
+                return memory;
+            }
+
+            /**
+             * Copy the null-terminated string @p str into the arena. The
+             * copy stays valid until the next call to reset().
+             *
+             * @returns Pointer to the copy.
+             */
+            const char* store(const char* str) {
+                return store(str, std::strlen(str));
+            }
+
+            /**
+             * Throw away all allocations but keep the underlying blocks
+             * for reuse. All pointers handed out before are invalid
+             * afterwards.
+             */
+            void reset() noexcept {
+                m_current_block = 0;
+                m_offset = 0;
+            }
+
+            /// The total size in bytes of all blocks held by the arena.
+            std::size_t capacity() const noexcept {
+                std::size_t sum = 0;
+                for (const auto& block : m_blocks) {
+                    sum += block.size;
+                }
+                return sum;
+            }
+
+        }; // class ScratchArena
+
+        /**
+         * An allocator drawing its memory from a ScratchArena, for use
+         * with the standard containers. Deallocation is a no-op, the
+         * memory is reclaimed when the arena is reset or destroyed, so
+         * only use this for containers that live shorter than the arena
+         * and don't shrink and regrow a lot.
+         */
+        template <typename T>
+        class arena_allocator {
+
+            ScratchArena* m_arena;
+
+        public:
+
+            using value_type = T;
+
+            template <typename U>
+            struct rebind {
+                using other = arena_allocator<U>;
+            };
+
+            explicit arena_allocator(ScratchArena& arena) noexcept :
+                m_arena(&arena) {
+            }
+
+            template <typename U>
+            arena_allocator(const arena_allocator<U>& other) noexcept : // NOLINT(google-explicit-constructor, hicpp-explicit-conversions)
+                m_arena(&other.arena()) {
+            }
+
+            ScratchArena& arena() const noexcept {
+                return *m_arena;
+            }
+
+            T* allocate(std::size_t n) {
+                return static_cast<T*>(m_arena->allocate_aligned(sizeof(T) * n, alignof(T)));
+            }
+
+            void deallocate(T* /*ptr*/, std::size_t /*n*/) noexcept {
+            }
+
+        }; // class arena_allocator
+
+        template <typename T, typename U>
+        inline bool operator==(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) noexcept {
+            return &lhs.arena() == &rhs.arena();
+        }
+
+        template <typename T, typename U>
+        inline bool operator!=(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+    } // namespace memory
+
+} // namespace osmium
+
+#endif // OSMIUM_MEMORY_SCRATCH_ARENA_HPP
@@ -35,10 +35,15 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/handler.hpp>
 #include <osmium/osm/object.hpp>
+#include <osmium/thread/pool.hpp>
 
 #include <boost/iterator/indirect_iterator.hpp>
 
 #include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -69,6 +74,68 @@ namespace osmium {
 
         std::vector<osmium::OSMObject*> m_objects{};
 
+        enum : std::size_t {
+            /// Ranges smaller than this are not worth a pool task.
+            min_parallel_sort_size = 1024u * 16u
+        };
+
+        /**
+         * Sort [data, data + size) on the given thread pool: the range
+         * is split into a power-of-two number of chunks matching the
+         * number of pool threads, the chunks are sorted as independent
+         * pool tasks and then merged pairwise in parallel rounds. All
+         * tasks are submitted from the calling thread, so this can not
+         * deadlock however busy the pool is.
+         */
+        template <typename T, typename TCompare>
+        static void parallel_sort_impl(T* data, const std::size_t size, TCompare& compare, osmium::thread::Pool& pool) {
+            std::size_t chunks = 1;
+            while (chunks * 2 <= static_cast<std::size_t>(pool.num_threads()) &&
+                   size / (chunks * 2) >= min_parallel_sort_size) {
+                chunks *= 2;
+            }
+
+            if (chunks == 1) {
+                std::sort(data, data + size, compare);
+                return;
+            }
+
+            std::vector<std::size_t> bounds;
+            bounds.reserve(chunks + 1);
+            for (std::size_t i = 0; i <= chunks; ++i) {
+                bounds.push_back(size / chunks * i);
+            }
+            bounds.back() = size;
+
+            std::vector<std::future<void>> tasks;
+            tasks.reserve(chunks);
+            for (std::size_t i = 0; i < chunks; ++i) {
+                const std::size_t b = bounds[i];
+                const std::size_t e = bounds[i + 1];
+                tasks.push_back(pool.submit([data, b, e, &compare]() {
+                    std::sort(data + b, data + e, compare);
+                }));
+            }
+            for (auto& task : tasks) {
+                task.get();
+            }
+
+            for (std::size_t width = 1; width < chunks; width *= 2) {
+                tasks.clear();
+                for (std::size_t i = 0; i + width < chunks; i += 2 * width) {
+                    const std::size_t b = bounds[i];
+                    const std::size_t m = bounds[i + width];
+                    const std::size_t e = bounds[std::min(i + 2 * width, chunks)];
+                    tasks.push_back(pool.submit([data, b, m, e, &compare]() {
+                        std::inplace_merge(data + b, data + m, data + e, compare);
+                    }));
+                }
+                for (auto& task : tasks) {
+                    task.get();
+                }
+            }
+        }
+
     public:
 
         using iterator       = boost::indirect_iterator<std::vector<osmium::OSMObject*>::iterator, osmium::OSMObject>;
@@ -91,6 +158,74 @@ namespace osmium {
             std::sort(m_objects.begin(), m_objects.end(), std::forward<TCompare>(compare));
         }
 
+        /**
+         * Sort objects according to the specified order functor using
+         * the given thread pool. Chunks of the collection are sorted
+         * as pool tasks and then merged, so large collections sort
+         * several times faster than with the single-threaded sort().
+         */
+        template <typename TCompare>
+        void sort(TCompare&& compare, osmium::thread::Pool& pool) {
+            parallel_sort_impl(m_objects.data(), m_objects.size(), compare, pool);
+        }
+
+        /**
+         * Sort objects according to the specified key extraction
+         * functor, for instance osmium::object_key_type_id_reverse_version.
+         *
+         * The key is computed once per object and the sort works on
+         * the packed keys, so the objects themselves are not touched
+         * during the sort. For large collections this is much faster
+         * than sort() with the matching order functor, which
+         * dereferences two object pointers per comparison. The price
+         * is a temporary vector with 24 bytes per object.
+         */
+        template <typename TKey>
+        void sort_by_key(TKey&& key) {
+            using key_type = typename std::result_of<TKey(const osmium::OSMObject&)>::type;
+            using keyed_pointer = std::pair<key_type, osmium::OSMObject*>;
+
+            std::vector<keyed_pointer> keyed;
+            keyed.reserve(m_objects.size());
+            for (auto* object : m_objects) {
+                keyed.emplace_back(key(*object), object);
+            }
+
+            // The pair comparison breaks key ties by pointer value,
+            // which keeps the result deterministic.
+            std::sort(keyed.begin(), keyed.end());
+
+            for (std::size_t i = 0; i < keyed.size(); ++i) {
+                m_objects[i] = keyed[i].second;
+            }
+        }
+
+        /**
+         * Sort objects according to the specified key extraction
+         * functor using the given thread pool. Combines sort_by_key()
+         * with the parallel sorting of sort() with a pool argument.
+         */
+        template <typename TKey>
+        void sort_by_key(TKey&& key, osmium::thread::Pool& pool) {
+            using key_type = typename std::result_of<TKey(const osmium::OSMObject&)>::type;
+            using keyed_pointer = std::pair<key_type, osmium::OSMObject*>;
+
+            std::vector<keyed_pointer> keyed;
+            keyed.reserve(m_objects.size());
+            for (auto* object : m_objects) {
+                keyed.emplace_back(key(*object), object);
+            }
+
+            // The pair comparison breaks key ties by pointer value,
+            // which keeps the result deterministic.
+            std::less<keyed_pointer> compare;
+            parallel_sort_impl(keyed.data(), keyed.size(), compare, pool);
+
+            for (std::size_t i = 0; i < keyed.size(); ++i) {
+                m_objects[i] = keyed[i].second;
+            }
+        }
+
         /**
          * Make objects unique according to the specified equality functor.
          *
@@ -102,6 +237,42 @@ namespace osmium {
             m_objects.erase(last, m_objects.end());
         }
 
+        /**
+         * Make objects unique according to the specified equality
+         * functor, calling the action on every object dropped from the
+         * collection. Of each run of equal objects the first one is
+         * kept, so sort with, for instance,
+         * osmium::object_order_type_id_reverse_version first if the
+         * latest version of each object should survive. Typical use is
+         * marking the losers of a deduplication as removed:
+         *
+         * @code
+         * collection.unique(osmium::object_equal_type_id{},
+         *                   [](osmium::OSMObject& object) {
+         *                       object.set_removed(true);
+         *                   });
+         * @endcode
+         *
+         * Complexity: Linear in the number of items.
+         */
+        template <typename TEqual, typename TAction>
+        void unique(TEqual&& equal, TAction&& action) {
+            auto it = m_objects.begin();
+            const auto last = m_objects.end();
+            if (it == last) {
+                return;
+            }
+            auto result = it;
+            while (++it != last) {
+                if (equal(*result, *it)) {
+                    action(**it);
+                } else {
+                    *++result = *it;
+                }
+            }
+            m_objects.erase(++result, last);
+        }
+
         /**
          * Is the collection empty?
          *
@@ -44,6 +44,8 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/util/compatibility.hpp>
 
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <iterator>
 #include <utility>
@@ -97,6 +99,110 @@ namespace osmium {
 
     static_assert(sizeof(InnerRing) % osmium::memory::align_bytes == 0, "Class osmium::InnerRing has wrong size to be aligned properly!");
 
+    /**
+     * A compact directory of all the rings of an Area. The assembler can
+     * optionally (see osmium::area::AssemblerConfig::create_ring_directory)
+     * write this after the rings. It stores for every outer and inner ring
+     * the offset of the ring item, the number of nodes, and the precomputed
+     * envelope of the ring, plus the envelope of the whole area. With the
+     * directory rings can be accessed in constant time and envelope checks
+     * need no iteration over the nodes.
+     */
+    class RingDirectory : public osmium::memory::Item {
+
+    public:
+
+        /**
+         * One entry in the ring directory describing a single outer or
+         * inner ring. The entries are in the same order as the ring items
+         * in the area: each outer ring followed by its inner rings.
+         */
+        struct Entry {
+
+            /// Byte offset of the ring item from the start of the Area item.
+            uint32_t ring_offset;
+
+            /// The number of nodes in the ring.
+            uint32_t num_nodes;
+
+            /// The precomputed envelope of the ring.
+            osmium::Box envelope;
+
+        }; // struct Entry
+
+    private:
+
+        osmium::Box m_envelope{};
+
+        const Entry* entries() const noexcept {
+            return reinterpret_cast<const Entry*>(data() + sizeof(RingDirectory));
+        }
+
+    public:
+
+        static constexpr osmium::item_type itemtype = osmium::item_type::ring_directory;
+
+        constexpr static bool is_compatible_to(osmium::item_type t) noexcept {
+            return t == itemtype;
+        }
+
+        RingDirectory() :
+            osmium::memory::Item(sizeof(RingDirectory), itemtype) {
+        }
+
+        /// The precomputed envelope of the whole area.
+        osmium::Box envelope() const noexcept {
+            return m_envelope;
+        }
+
+        /// Set the envelope of the whole area.
+        void set_envelope(const osmium::Box& envelope) noexcept {
+            m_envelope = envelope;
+        }
+
+        /// The number of rings described in this directory.
+        std::size_t size() const noexcept {
+            return (byte_size() - sizeof(RingDirectory)) / sizeof(Entry);
+        }
+
+        /// Is this directory empty?
+        bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        /**
+         * Get the entry with the given index.
+         *
+         * @pre @code n < size() @endcode
+         */
+        const Entry& operator[](std::size_t n) const noexcept {
+            assert(n < size());
+            return entries()[n];
+        }
+
+        /// Iterator type for iterating over the entries.
+        using const_iterator = const Entry*;
+
+        const_iterator begin() const noexcept {
+            return entries();
+        }
+
+        const_iterator end() const noexcept {
+            return entries() + size();
+        }
+
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept {
+            return end();
+        }
+
+    }; // class RingDirectory
+
+    static_assert(sizeof(RingDirectory) % osmium::memory::align_bytes == 0, "Class osmium::RingDirectory has wrong size to be aligned properly!");
+
     /**
      * Convert way or (multipolygon) relation id into unique area id.
      *
@@ -180,7 +286,8 @@ namespace osmium {
                         ++counter.second;
                         break;
                     case osmium::item_type::tag_list:
-                        // ignore tags
+                    case osmium::item_type::ring_directory:
+                        // ignore tags and the ring directory
                         break;
                     case osmium::item_type::undefined:
                     case osmium::item_type::node:
@@ -255,11 +362,46 @@ namespace osmium {
         }
 
         /**
-         * Calculate the envelope of this area.
+         * Get the ring directory of this area or nullptr if this area
+         * was assembled without one (see
+         * osmium::area::AssemblerConfig::create_ring_directory).
          *
-         * Complexity: Linear in the number of nodes in the outer rings.
+         * Complexity: Linear in the number of rings.
+         */
+        const osmium::RingDirectory* ring_directory() const noexcept {
+            for (const auto& item : *this) {
+                if (item.type() == osmium::item_type::ring_directory) {
+                    return &static_cast<const osmium::RingDirectory&>(item);
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         * Get the ring described by the given ring directory entry. Use
+         * the type() of the returned item to see whether it is an outer
+         * or inner ring.
+         *
+         * Complexity: Constant.
+         */
+        const osmium::NodeRefList& ring(const osmium::RingDirectory::Entry& entry) const noexcept {
+            return *reinterpret_cast<const osmium::NodeRefList*>(data() + entry.ring_offset);
+        }
+
+        /**
+         * Calculate the envelope of this area. If the area has a ring
+         * directory the precomputed envelope from the directory is
+         * returned instead.
+         *
+         * Complexity: Linear in the number of nodes in the outer rings,
+         *             constant (except for finding the directory) if
+         *             there is a ring directory.
          */
         osmium::Box envelope() const noexcept {
+            const auto* directory = ring_directory();
+            if (directory) {
+                return directory->envelope();
+            }
             osmium::Box box;
             for (const auto& ring : outer_rings()) {
                 box.extend(ring.envelope());
@@ -0,0 +1,130 @@
+#ifndef OSMIUM_OSM_CRC_HW_HPP
+#define OSMIUM_OSM_CRC_HW_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE4_2__)
+# include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+# include <arm_acle.h>
+#else
+# error "osmium/osm/crc_hw.hpp needs hardware CRC32C support. Compile with -msse4.2 (x86) or -march=armv8-a+crc (ARM) or use osmium::CRC_zlib instead."
+#endif
+
+namespace osmium {
+
+    /**
+     * This class is used together with the CRC class to implement a CRC32C
+     * (Castagnoli) checksum using the CRC instructions available on modern
+     * x86 (SSE4.2) and ARMv8 CPUs. It is an order of magnitude faster than
+     * the table-based implementation in CRC_zlib.
+     *
+     * Note that CRC32C uses a different polynomial than the zlib CRC32, so
+     * checksums calculated with this class are not comparable to checksums
+     * calculated with CRC_zlib.
+     *
+     * This header can only be included when the compiler is generating code
+     * for a CPU with the necessary instructions, otherwise it will fail with
+     * an error.
+     *
+     * Usage:
+     *
+     * @code
+     * osmium::CRC<osmium::CRC_hw> crc32;
+     * const osmium::Node& node = ...;
+     * crc32.update(node);
+     * std::cout << crc32.checksum() << '\n';
+     * @endcode
+     */
+    class CRC_hw {
+
+        uint32_t m_crc32 = 0xffffffffu;
+
+#if defined(__SSE4_2__)
+
+        static uint32_t crc32c_byte(uint32_t crc, const unsigned char byte) noexcept {
+            return _mm_crc32_u8(crc, byte);
+        }
+
+        static uint32_t crc32c_word(uint32_t crc, const uint64_t word) noexcept {
+            return static_cast<uint32_t>(_mm_crc32_u64(crc, word));
+        }
+
+#elif defined(__ARM_FEATURE_CRC32)
+
+        static uint32_t crc32c_byte(uint32_t crc, const unsigned char byte) noexcept {
+            return __crc32cb(crc, byte);
+        }
+
+        static uint32_t crc32c_word(uint32_t crc, const uint64_t word) noexcept {
+            return __crc32cd(crc, word);
+        }
+
+#endif
+
+    public:
+
+        void process_byte(const unsigned char byte) noexcept {
+            m_crc32 = crc32c_byte(m_crc32, byte);
+        }
+
+        void process_bytes(const void* buffer, std::size_t byte_count) noexcept {
+            const auto* data = reinterpret_cast<const unsigned char*>(buffer);
+
+            while (byte_count >= sizeof(uint64_t)) {
+                uint64_t word;
+                std::memcpy(&word, data, sizeof(word));
+                m_crc32 = crc32c_word(m_crc32, word);
+                data += sizeof(word);
+                byte_count -= sizeof(word);
+            }
+
+            while (byte_count > 0) {
+                m_crc32 = crc32c_byte(m_crc32, *data++);
+                --byte_count;
+            }
+        }
+
+        unsigned long checksum() const noexcept { // NOLINT(google-runtime-int)
+            return m_crc32 ^ 0xffffffffu;
+        }
+
+    }; // class CRC_hw
+
+} // namespace osmium
+
+#endif // OSMIUM_OSM_CRC_HW_HPP
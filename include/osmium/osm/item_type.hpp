@@ -54,6 +54,7 @@ namespace osmium {
         relation_member_list_with_full_members = 0x23,
         outer_ring                             = 0x40,
         inner_ring                             = 0x41,
+        ring_directory                         = 0x42,
         changeset_discussion                   = 0x80
 
     }; // enum class item_type
@@ -109,6 +110,8 @@ namespace osmium {
                 return item_type::outer_ring;
             case 'I':
                 return item_type::inner_ring;
+            case 'R':
+                return item_type::ring_directory;
             case 'D':
                 return item_type::changeset_discussion;
             default: // 'X'
@@ -141,6 +144,8 @@ namespace osmium {
                 return 'O';
             case item_type::inner_ring:
                 return 'I';
+            case item_type::ring_directory:
+                return 'R';
             case item_type::changeset_discussion:
                 return 'D';
             default: // item_type::undefined
@@ -173,6 +178,8 @@ namespace osmium {
                 return "outer_ring";
             case item_type::inner_ring:
                 return "inner_ring";
+            case item_type::ring_directory:
+                return "ring_directory";
             case item_type::changeset_discussion:
                 return "changeset_discussion";
             default: // item_type::undefined
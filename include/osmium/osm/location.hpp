@@ -271,6 +271,17 @@ namespace osmium {
      *
      * Coordinates are never checked on whether they are inside bounds.
      * Call valid() to check this.
+     *
+     * The lon() and lat() accessors check the validity on every call
+     * and throw for invalid locations. Code reading coordinates in
+     * hot inner loops should use the x()/y() or lon_without_check()/
+     * lat_without_check() accessors instead, which are branch-free.
+     * This is officially supported: a Location can not change once it
+     * is stored in a buffer, so one valid() check per location (or
+     * one validation pass after decoding) is enough and the per-access
+     * check is redundant. The file parsers already reject coordinates
+     * that do not fit into the fixed-point representation at decode
+     * time.
      */
     class Location {
 
@@ -404,9 +415,11 @@ namespace osmium {
         }
 
         /**
-         * Get longitude without checking the validity.
+         * Get longitude without checking the validity. Branch-free,
+         * use this in inner loops after establishing validity once,
+         * see the class documentation.
          */
-        double lon_without_check() const {
+        constexpr double lon_without_check() const noexcept {
             return fix_to_double(m_x);
         }
 
@@ -423,9 +436,11 @@ namespace osmium {
         }
 
         /**
-         * Get latitude without checking the validity.
+         * Get latitude without checking the validity. Branch-free,
+         * use this in inner loops after establishing validity once,
+         * see the class documentation.
          */
-        double lat_without_check() const {
+        constexpr double lat_without_check() const noexcept {
             return fix_to_double(m_y);
         }
 
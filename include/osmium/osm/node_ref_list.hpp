@@ -39,9 +39,21 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/node_ref.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+# define OSMIUM_USE_SSE2_ENVELOPE
+# include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+# define OSMIUM_USE_NEON_ENVELOPE
+# include <arm_neon.h>
+#endif
 
 namespace osmium {
 
@@ -185,16 +197,139 @@ namespace osmium {
          * Calculate the envelope of this node ref list. If the locations
          * are not set, the resulting box will be invalid.
          *
+         * On x86 (SSE2) and AArch64 (NEON) the min/max accumulation runs
+         * vectorized over the packed location array, several node refs at
+         * a time, instead of doing one branchy Box::extend() per node.
+         * Invalid locations are masked out, so the result is the same as
+         * with the scalar loop.
+         *
          * Complexity: Linear in the number of elements.
          */
         osmium::Box envelope() const noexcept {
             osmium::Box box;
+
+#if defined(OSMIUM_USE_SSE2_ENVELOPE) || defined(OSMIUM_USE_NEON_ENVELOPE)
+            static_assert(sizeof(NodeRef) == 16, "vectorized envelope expects the NodeRef memory layout");
+
+            const NodeRef* it = cbegin();
+            const NodeRef* const last = cend();
+
+# if defined(OSMIUM_USE_SSE2_ENVELOPE)
+            if (last - it >= 2) {
+                // lanes alternate x,y coordinates of two node refs
+                const __m128i upper_bound = _mm_set_epi32( 90 * detail::coordinate_precision,  180 * detail::coordinate_precision,  90 * detail::coordinate_precision,  180 * detail::coordinate_precision);
+                const __m128i lower_bound = _mm_set_epi32(-90 * detail::coordinate_precision, -180 * detail::coordinate_precision, -90 * detail::coordinate_precision, -180 * detail::coordinate_precision);
+                const __m128i int_min = _mm_set1_epi32(std::numeric_limits<int32_t>::min());
+                const __m128i int_max = _mm_set1_epi32(std::numeric_limits<int32_t>::max());
+
+                __m128i min_acc = int_max;
+                __m128i max_acc = int_min;
+
+                for (; last - it >= 2; it += 2) {
+                    // gather the location halves of two adjacent node refs
+                    const auto a = _mm_loadu_ps(reinterpret_cast<const float*>(it));
+                    const auto b = _mm_loadu_ps(reinterpret_cast<const float*>(it + 1));
+                    const __m128i v = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 2, 3, 2)));
+
+                    // mask out locations where x or y is outside the
+                    // valid bounds (this includes undefined locations)
+                    __m128i bad = _mm_or_si128(_mm_cmpgt_epi32(v, upper_bound),
+                                               _mm_cmpgt_epi32(lower_bound, v));
+                    bad = _mm_or_si128(bad, _mm_shuffle_epi32(bad, _MM_SHUFFLE(2, 3, 0, 1)));
+
+                    const __m128i vmin = _mm_or_si128(_mm_and_si128(bad, int_max), _mm_andnot_si128(bad, v));
+                    const __m128i vmax = _mm_or_si128(_mm_and_si128(bad, int_min), _mm_andnot_si128(bad, v));
+
+                    // SSE2 has no 32bit integer min/max, compare and select
+                    const __m128i lt = _mm_cmpgt_epi32(min_acc, vmin);
+                    min_acc = _mm_or_si128(_mm_and_si128(lt, vmin), _mm_andnot_si128(lt, min_acc));
+                    const __m128i gt = _mm_cmpgt_epi32(vmax, max_acc);
+                    max_acc = _mm_or_si128(_mm_and_si128(gt, vmax), _mm_andnot_si128(gt, max_acc));
+                }
+
+                int32_t mins[4];
+                int32_t maxs[4];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(mins), min_acc);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(maxs), max_acc);
+
+                // if all locations were masked out these are invalid and
+                // extend() ignores them
+                box.extend(Location{std::min(mins[0], mins[2]), std::min(mins[1], mins[3])});
+                box.extend(Location{std::max(maxs[0], maxs[2]), std::max(maxs[1], maxs[3])});
+            }
+# elif defined(OSMIUM_USE_NEON_ENVELOPE)
+            if (last - it >= 4) {
+                const int32x4_t x_upper = vdupq_n_s32( 180 * detail::coordinate_precision);
+                const int32x4_t x_lower = vdupq_n_s32(-180 * detail::coordinate_precision);
+                const int32x4_t y_upper = vdupq_n_s32(  90 * detail::coordinate_precision);
+                const int32x4_t y_lower = vdupq_n_s32( -90 * detail::coordinate_precision);
+                const int32x4_t int_min = vdupq_n_s32(std::numeric_limits<int32_t>::min());
+                const int32x4_t int_max = vdupq_n_s32(std::numeric_limits<int32_t>::max());
+
+                int32x4_t min_x = int_max;
+                int32x4_t min_y = int_max;
+                int32x4_t max_x = int_min;
+                int32x4_t max_y = int_min;
+
+                for (; last - it >= 4; it += 4) {
+                    // de-interleaving load of four node refs, lane group 2
+                    // has the x, lane group 3 the y coordinates
+                    const int32x4x4_t refs = vld4q_s32(reinterpret_cast<const int32_t*>(it));
+                    const int32x4_t x = refs.val[2];
+                    const int32x4_t y = refs.val[3];
+
+                    // mask out locations where x or y is outside the
+                    // valid bounds (this includes undefined locations)
+                    const uint32x4_t bad = vorrq_u32(
+                        vorrq_u32(vcgtq_s32(x, x_upper), vcgtq_s32(x_lower, x)),
+                        vorrq_u32(vcgtq_s32(y, y_upper), vcgtq_s32(y_lower, y)));
+
+                    min_x = vminq_s32(min_x, vbslq_s32(bad, int_max, x));
+                    min_y = vminq_s32(min_y, vbslq_s32(bad, int_max, y));
+                    max_x = vmaxq_s32(max_x, vbslq_s32(bad, int_min, x));
+                    max_y = vmaxq_s32(max_y, vbslq_s32(bad, int_min, y));
+                }
+
+                // if all locations were masked out these are invalid and
+                // extend() ignores them
+                box.extend(Location{vminvq_s32(min_x), vminvq_s32(min_y)});
+                box.extend(Location{vmaxvq_s32(max_x), vmaxvq_s32(max_y)});
+            }
+# endif
+
+            for (; it != last; ++it) {
+                box.extend(it->location());
+            }
+#else
             for (const auto& node_ref : *this) {
                 box.extend(node_ref.location());
             }
+#endif
+
             return box;
         }
 
+        /**
+         * Append the raw fixed-point coordinates of all node refs to
+         * the given vectors, x (longitude) and y (latitude) values
+         * separately. The planar int32 layout is meant for vectorized
+         * consumers which want to run SIMD loops over the coordinates
+         * of many ways without touching the NodeRef layout.
+         *
+         * Coordinates are exported as stored, so undefined locations
+         * show up as osmium::Location::undefined_coordinate.
+         *
+         * Complexity: Linear in the number of elements.
+         */
+        void raw_coordinates(std::vector<int32_t>& x, std::vector<int32_t>& y) const {
+            x.reserve(x.size() + size());
+            y.reserve(y.size() + size());
+            for (const auto& node_ref : *this) {
+                x.push_back(node_ref.location().x());
+                y.push_back(node_ref.location().y());
+            }
+        }
+
         /// Returns an iterator to the beginning.
         iterator begin() noexcept {
             return iterator(data() + sizeof(NodeRefList));
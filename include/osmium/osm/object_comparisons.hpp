@@ -38,8 +38,10 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/util/misc.hpp>
 
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
 #include <tuple>
+#include <utility>
 
 namespace osmium {
 
@@ -157,6 +159,58 @@ namespace osmium {
 
     }; // struct object_order_type_id_reverse_version
 
+    /**
+     * Sort key for an OSM object packed into two 64bit integers that
+     * compare like a single 128bit integer. Comparing keys instead of
+     * objects avoids dereferencing two object pointers per comparison,
+     * see ObjectPointerCollection::sort_by_key().
+     */
+    using object_order_key = std::pair<uint64_t, uint64_t>;
+
+    namespace detail {
+
+        inline uint64_t object_key_high(const osmium::OSMObject& object) noexcept {
+            const auto id = static_cast<uint64_t>(object.positive_id());
+            assert(id < (uint64_t{1} << 60u) && "object id does not fit into the sort key");
+            return (static_cast<uint64_t>(object.type()) << 61u) |
+                   (object.id() > 0 ? (uint64_t{1} << 60u) : 0u) |
+                   id;
+        }
+
+    } // namespace detail
+
+    /**
+     * Key extraction function object class ordering OSM objects like
+     * object_order_type_id_version. The only difference is that objects
+     * with and without valid timestamps are ordered by their timestamps
+     * unconditionally.
+     */
+    struct object_key_type_id_version {
+
+        object_order_key operator()(const osmium::OSMObject& object) const noexcept {
+            return object_order_key{detail::object_key_high(object),
+                                    (static_cast<uint64_t>(object.version()) << 32u) |
+                                     static_cast<uint32_t>(object.timestamp())};
+        }
+
+    }; // struct object_key_type_id_version
+
+    /**
+     * Key extraction function object class ordering OSM objects like
+     * object_order_type_id_reverse_version. The only difference is that
+     * objects with and without valid timestamps are ordered by their
+     * timestamps unconditionally.
+     */
+    struct object_key_type_id_reverse_version {
+
+        object_order_key operator()(const osmium::OSMObject& object) const noexcept {
+            return object_order_key{detail::object_key_high(object),
+                                    (static_cast<uint64_t>(~object.version()) << 32u) |
+                                     static_cast<uint32_t>(~static_cast<uint32_t>(object.timestamp()))};
+        }
+
+    }; // struct object_key_type_id_reverse_version
+
 } // namespace osmium
 
 #endif // OSMIUM_OSM_OBJECT_COMPARISONS_HPP
@@ -39,6 +39,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <cstring>
 #include <iosfwd>
 #include <iterator>
@@ -177,6 +178,95 @@ namespace osmium {
 
     static_assert(sizeof(TagList) % osmium::memory::align_bytes == 0, "Class osmium::TagList has wrong size to be aligned properly!");
 
+    /**
+     * The set of keys in a TagList approximated in a single 64-bit
+     * word: every key sets one of 64 bits based on a hash of the key.
+     * A probe that doesn't find its bit set proves the key is not in
+     * the tag list with one AND; a probe that does find it may be a
+     * false positive and has to be confirmed with has_key() or
+     * get_value_by_key().
+     *
+     * Useful for handlers probing several keys per object, where most
+     * probes miss: build the bloom with one scan over the tags, hash
+     * the probed keys once with bit() and keep the results, then
+     * probing is a single AND per object and key:
+     * @code
+     * static const uint64_t highway_bit = osmium::TagKeyBloom::bit("highway");
+     *
+     * const osmium::TagKeyBloom bloom{way.tags()};
+     * if (bloom.may_have_key(highway_bit)) {
+     *     const char* value = way.tags().get_value_by_key("highway");
+     *     ...
+     * }
+     * @endcode
+     */
+    class TagKeyBloom {
+
+        uint64_t m_bits = 0;
+
+        // FNV-1a
+        static uint64_t hash(const char* key) noexcept {
+            uint64_t value = 0xcbf29ce484222325ULL;
+            while (*key) {
+                value ^= static_cast<unsigned char>(*key++);
+                value *= 0x100000001b3ULL;
+            }
+            return value;
+        }
+
+    public:
+
+        TagKeyBloom() noexcept = default;
+
+        /// Build the bloom from the keys of the specified tag list.
+        explicit TagKeyBloom(const TagList& tags) noexcept {
+            for (const auto& tag : tags) {
+                add_key(tag.key());
+            }
+        }
+
+        /**
+         * Get the bit used for the specified key. When probing the
+         * same key for many objects, call this once and keep the
+         * result.
+         *
+         * @pre @code key != nullptr @endcode
+         */
+        static uint64_t bit(const char* key) noexcept {
+            assert(key);
+            return uint64_t{1} << (hash(key) & 0x3fU);
+        }
+
+        /**
+         * Add the specified key to the bloom.
+         *
+         * @pre @code key != nullptr @endcode
+         */
+        void add_key(const char* key) noexcept {
+            m_bits |= bit(key);
+        }
+
+        /**
+         * Could a key with the specified bit (from bit()) be in the
+         * tag list? If this returns false, the key is definitely not
+         * in the tag list; if it returns true, the key may be in the
+         * tag list, but it could be a false positive.
+         */
+        bool may_have_key(const uint64_t key_bit) const noexcept {
+            return (m_bits & key_bit) != 0;
+        }
+
+        /**
+         * Could the specified key be in the tag list? See above.
+         *
+         * @pre @code key != nullptr @endcode
+         */
+        bool may_have_key(const char* key) const noexcept {
+            return may_have_key(bit(key));
+        }
+
+    }; // class TagKeyBloom
+
 } // namespace osmium
 
 #endif // OSMIUM_OSM_TAG_HPP
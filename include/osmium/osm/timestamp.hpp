@@ -79,6 +79,23 @@ namespace osmium {
             out += static_cast<char>('0' + value);
         }
 
+        /**
+         * Convert a date in the civil (Gregorian) calendar into the
+         * number of days since 1970-01-01. Uses the well-known
+         * branch-free conversion algorithm instead of timegm(), which
+         * is much slower and not available everywhere.
+         *
+         * @pre year >= 1, 1 <= month <= 12, day valid for the month.
+         */
+        inline int64_t days_from_civil(const int year, const unsigned int month, const unsigned int day) noexcept {
+            const int y = year - (month <= 2);
+            const int era = y / 400;
+            const auto yoe = static_cast<unsigned int>(y - era * 400);
+            const unsigned int doy = (153u * (month > 2 ? month - 3 : month + 9) + 2u) / 5u + day - 1u;
+            const unsigned int doe = yoe * 365u + yoe / 4u - yoe / 100u + doy;
+            return static_cast<int64_t>(era) * 146097 + static_cast<int64_t>(doe) - 719468;
+        }
+
         inline time_t parse_timestamp(const char* str) {
             static const int mon_lengths[] = {
                 31, 29, 31, 30, 31, 30,
@@ -104,30 +121,23 @@ namespace osmium {
                 str[17] >= '0' && str[17] <= '9' &&
                 str[18] >= '0' && str[18] <= '9' &&
                 str[19] == 'Z') {
-                std::tm tm; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
-                tm.tm_year = (str[ 0] - '0') * 1000 +
-                             (str[ 1] - '0') *  100 +
-                             (str[ 2] - '0') *   10 +
-                             (str[ 3] - '0')        - 1900;
-                tm.tm_mon  = (str[ 5] - '0') * 10 + (str[ 6] - '0') - 1;
-                tm.tm_mday = (str[ 8] - '0') * 10 + (str[ 9] - '0');
-                tm.tm_hour = (str[11] - '0') * 10 + (str[12] - '0');
-                tm.tm_min  = (str[14] - '0') * 10 + (str[15] - '0');
-                tm.tm_sec  = (str[17] - '0') * 10 + (str[18] - '0');
-                tm.tm_wday = 0;
-                tm.tm_yday = 0;
-                tm.tm_isdst = 0;
-                if (tm.tm_year >= 0 &&
-                    tm.tm_mon  >= 0 && tm.tm_mon  <= 11 &&
-                    tm.tm_mday >= 1 && tm.tm_mday <= mon_lengths[tm.tm_mon] &&
-                    tm.tm_hour >= 0 && tm.tm_hour <= 23 &&
-                    tm.tm_min  >= 0 && tm.tm_min  <= 59 &&
-                    tm.tm_sec  >= 0 && tm.tm_sec  <= 60) {
-#ifndef _WIN32
-                    return timegm(&tm);
-#else
-                    return _mkgmtime(&tm);
-#endif
+                const int year           = (str[ 0] - '0') * 1000 +
+                                           (str[ 1] - '0') *  100 +
+                                           (str[ 2] - '0') *   10 +
+                                           (str[ 3] - '0');
+                const unsigned int month = static_cast<unsigned int>((str[ 5] - '0') * 10 + (str[ 6] - '0'));
+                const unsigned int day   = static_cast<unsigned int>((str[ 8] - '0') * 10 + (str[ 9] - '0'));
+                const unsigned int hour  = static_cast<unsigned int>((str[11] - '0') * 10 + (str[12] - '0'));
+                const unsigned int min   = static_cast<unsigned int>((str[14] - '0') * 10 + (str[15] - '0'));
+                const unsigned int sec   = static_cast<unsigned int>((str[17] - '0') * 10 + (str[18] - '0'));
+                if (year >= 1900 &&
+                    month >= 1 && month <= 12 &&
+                    day   >= 1 && day <= static_cast<unsigned int>(mon_lengths[month - 1]) &&
+                    hour  <= 23 &&
+                    min   <= 59 &&
+                    sec   <= 60) {
+                    return static_cast<time_t>(days_from_civil(year, month, day) * 86400 +
+                                               hour * 3600 + min * 60 + sec);
                 }
             }
             throw std::invalid_argument{"can not parse timestamp"};
@@ -147,30 +157,33 @@ namespace osmium {
         uint32_t m_timestamp = 0;
 
         void to_iso_str(std::string& s) const {
-            std::tm tm; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
-            time_t sse = seconds_since_epoch();
-#ifndef NDEBUG
-            auto result =
-#endif
-#ifndef _WIN32
-            gmtime_r(&sse, &tm);
-            assert(result != nullptr);
-#else
-            gmtime_s(&tm, &sse);
-            assert(result == 0);
-#endif
-
-            detail::add_4digit_int_to_string(tm.tm_year + 1900, s);
+            // Inverse of detail::days_from_civil(). The internal
+            // representation is unsigned, so no dates before 1970 can
+            // occur and all intermediate values fit into 32 bits. This
+            // is a lot faster than calling gmtime_r().
+            const uint32_t z    = m_timestamp / 86400u + 719468u;
+            const uint32_t era  = z / 146097u;
+            const uint32_t doe  = z - era * 146097u;
+            const uint32_t yoe  = (doe - doe / 1460u + doe / 36524u - doe / 146096u) / 365u;
+            const uint32_t doy  = doe - (365u * yoe + yoe / 4u - yoe / 100u);
+            const uint32_t mp   = (5u * doy + 2u) / 153u;
+            const uint32_t day  = doy - (153u * mp + 2u) / 5u + 1u;
+            const uint32_t mon  = mp < 10u ? mp + 3u : mp - 9u;
+            const uint32_t year = yoe + era * 400u + (mon <= 2u);
+
+            const uint32_t secs = m_timestamp % 86400u;
+
+            detail::add_4digit_int_to_string(static_cast<int>(year), s);
             s += '-';
-            detail::add_2digit_int_to_string(tm.tm_mon + 1, s);
+            detail::add_2digit_int_to_string(static_cast<int>(mon), s);
             s += '-';
-            detail::add_2digit_int_to_string(tm.tm_mday, s);
+            detail::add_2digit_int_to_string(static_cast<int>(day), s);
             s += 'T';
-            detail::add_2digit_int_to_string(tm.tm_hour, s);
+            detail::add_2digit_int_to_string(static_cast<int>(secs / 3600u), s);
             s += ':';
-            detail::add_2digit_int_to_string(tm.tm_min, s);
+            detail::add_2digit_int_to_string(static_cast<int>(secs % 3600u / 60u), s);
             s += ':';
-            detail::add_2digit_int_to_string(tm.tm_sec, s);
+            detail::add_2digit_int_to_string(static_cast<int>(secs % 60u), s);
             s += 'Z';
         }
 
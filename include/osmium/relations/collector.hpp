@@ -35,6 +35,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/handler.hpp>
 #include <osmium/handler/check_order.hpp>
+#include <osmium/index/id_set.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/object.hpp>
@@ -472,6 +473,27 @@ namespace osmium {
                 return relations_buffer_capacity + members_buffer_capacity + relations + members;
             }
 
+            /**
+             * Get the ids of all members of the specified type needed to
+             * complete the relations as an id set. Call this after
+             * read_relations(). The set can be used to restrict the
+             * second pass to the objects that are actually needed, for
+             * instance through the osmium::io::pbf_ids_filter option of
+             * the osmium::io::Reader. Members with negative ids are not
+             * included, they can not be represented in the set.
+             *
+             * @param type osmium::item_type::node, way, or relation.
+             */
+            osmium::index::IdSetDense<osmium::unsigned_object_id_type> member_ids(const item_type type) const {
+                osmium::index::IdSetDense<osmium::unsigned_object_id_type> ids;
+                for (const auto& member_meta : m_member_meta[static_cast<uint16_t>(type) - 1]) {
+                    if (!member_meta.removed() && member_meta.member_id() >= 0) {
+                        ids.set(static_cast<osmium::unsigned_object_id_type>(member_meta.member_id()));
+                    }
+                }
+                return ids;
+            }
+
             /**
              * Return reference to second pass handler.
              */
@@ -33,6 +33,8 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/id_set.hpp>
+#include <osmium/io/detail/read_write.hpp>
 #include <osmium/osm/object.hpp>
 #include <osmium/osm/relation.hpp>
 #include <osmium/osm/types.hpp>
@@ -46,6 +48,8 @@ DEALINGS IN THE SOFTWARE.
 #include <limits>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -137,6 +141,14 @@ namespace osmium {
 
             std::vector<element> m_elements{};
 
+            // Optional hash index from member id to the position of the
+            // first element with that id in the sorted m_elements vector.
+            // Built in prepare_for_lookup() when enabled, see
+            // enable_hashed_lookup().
+            std::unordered_map<osmium::object_id_type, std::size_t> m_id_index{};
+
+            bool m_use_id_index = false;
+
         protected:
 
             osmium::ItemStash& m_stash;
@@ -152,10 +164,34 @@ namespace osmium {
             using const_iterator = std::vector<element>::const_iterator;
 
             iterator_range<iterator> find(osmium::object_id_type id) {
+                if (m_use_id_index) {
+                    const auto it = m_id_index.find(id);
+                    if (it == m_id_index.end()) {
+                        return make_range(std::make_pair(m_elements.end(), m_elements.end()));
+                    }
+                    const auto first = m_elements.begin() + static_cast<std::vector<element>::difference_type>(it->second);
+                    auto last = first;
+                    while (last != m_elements.end() && last->member_id == id) {
+                        ++last;
+                    }
+                    return make_range(std::make_pair(first, last));
+                }
                 return make_range(std::equal_range(m_elements.begin(), m_elements.end(), element{id}, compare_member_id{}));
             }
 
             iterator_range<const_iterator> find(osmium::object_id_type id) const {
+                if (m_use_id_index) {
+                    const auto it = m_id_index.find(id);
+                    if (it == m_id_index.end()) {
+                        return make_range(std::make_pair(m_elements.cend(), m_elements.cend()));
+                    }
+                    const auto first = m_elements.cbegin() + static_cast<std::vector<element>::difference_type>(it->second);
+                    auto last = first;
+                    while (last != m_elements.cend() && last->member_id == id) {
+                        ++last;
+                    }
+                    return make_range(std::make_pair(first, last));
+                }
                 return make_range(std::equal_range(m_elements.cbegin(), m_elements.cend(), element{id}, compare_member_id{}));
             }
 
@@ -186,6 +222,8 @@ namespace osmium {
              */
             std::size_t used_memory() const noexcept {
                 return sizeof(element) * m_elements.capacity() +
+                       m_id_index.size() * (sizeof(std::pair<const osmium::object_id_type, std::size_t>) + 2 * sizeof(void*)) +
+                       m_id_index.bucket_count() * sizeof(void*) +
                        sizeof(MembersDatabaseCommon);
             }
 
@@ -200,6 +238,40 @@ namespace osmium {
                 return m_elements.size();
             }
 
+            /**
+             * Write the contents of the database (not including the
+             * stash) to the given file descriptor so they can be
+             * restored later with load(). Dump the stash separately, the
+             * stash handles stored here stay valid across a dump()/
+             * load() pair.
+             */
+            void dump(const int fd) const {
+                const std::size_t count = m_elements.size();
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&count), sizeof(count));
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(m_elements.data()), count * sizeof(element));
+            }
+
+            /**
+             * Restore the contents of the database from the given file
+             * descriptor. The data must have been written by dump() and
+             * the stash must have been restored to the state it had when
+             * the database was dumped. Call prepare_for_lookup() again
+             * before looking anything up.
+             *
+             * @throws std::runtime_error If the data is truncated.
+             */
+            void load(const int fd) {
+                std::size_t count = 0;
+                osmium::io::detail::reliable_read_exact(fd, reinterpret_cast<char*>(&count), sizeof(count));
+                m_elements.assign(count, element{0});
+                osmium::io::detail::reliable_read_exact(fd, reinterpret_cast<char*>(m_elements.data()), count * sizeof(element));
+                m_id_index.clear();
+                m_use_id_index = false;
+#ifndef NDEBUG
+                m_init_phase = true;
+#endif
+            }
+
             /**
              * Result from the count() function.
              */
@@ -250,6 +322,37 @@ namespace osmium {
                 rel_handle.increment_members();
             }
 
+            /**
+             * Add the ids of all members tracked in this database (and
+             * not removed yet) to the specified id set. Useful to build
+             * an id filter for the second pass, see
+             * osmium::io::pbf_ids_filter. Members with negative ids are
+             * ignored, they can not be represented in the set.
+             *
+             * Complexity: Linear in the number of members tracked.
+             */
+            void add_tracked_ids(osmium::index::IdSetDense<osmium::unsigned_object_id_type>& ids) const {
+                for (const auto& elem : m_elements) {
+                    if (!elem.is_removed() && elem.member_id >= 0) {
+                        ids.set(static_cast<osmium::unsigned_object_id_type>(elem.member_id));
+                    }
+                }
+            }
+
+            /**
+             * Enable hash-indexed lookup: prepare_for_lookup() will build
+             * a hash index from member id to the elements, making all
+             * lookups O(1) instead of logarithmic in the number of
+             * members tracked. This trades memory for speed and usually
+             * pays off with many millions of tracked members.
+             *
+             * Call this function before calling prepare_for_lookup().
+             */
+            void enable_hashed_lookup() {
+                assert(m_init_phase && "Can not call MembersDatabase::enable_hashed_lookup() after MembersDatabase::prepare_for_lookup().");
+                m_use_id_index = true;
+            }
+
             /**
              * Prepare the database for lookup. Call this function after
              * calling track() for all objects needed and before adding
@@ -259,6 +362,15 @@ namespace osmium {
             void prepare_for_lookup() {
                 assert(m_init_phase && "Can not call MembersDatabase::prepare_for_lookup() twice.");
                 std::sort(m_elements.begin(), m_elements.end());
+                if (m_use_id_index) {
+                    m_id_index.reserve(m_elements.size());
+                    for (std::size_t pos = 0; pos < m_elements.size(); ++pos) {
+                        // Only the first element with any given id ends up
+                        // in the index, the others follow directly after
+                        // it in the sorted vector.
+                        m_id_index.emplace(m_elements[pos].member_id, pos);
+                    }
+                }
 #ifndef NDEBUG
                 m_init_phase = false;
 #endif
@@ -295,7 +407,8 @@ namespace osmium {
              * with that id in the database.
              *
              * Complexity: Logarithmic in the number of members tracked (as
-             *             returned by size()).
+             *             returned by size()). Constant if hashed lookup
+             *             is enabled, see enable_hashed_lookup().
              */
             const osmium::OSMObject* get_object(osmium::object_id_type id) const {
                 assert(!m_init_phase && "Call MembersDatabase::prepare_for_lookup() before calling get_object().");
@@ -310,6 +423,21 @@ namespace osmium {
                 return nullptr;
             }
 
+            /**
+             * Is any relation tracked in this database interested in the
+             * object with the specified id? This is a read-only lookup
+             * that doesn't touch any shared state, so it can be called
+             * concurrently with lookups in the other member databases.
+             *
+             * Complexity: Logarithmic in the number of members tracked (as
+             *             returned by size()). Constant if hashed lookup
+             *             is enabled, see enable_hashed_lookup().
+             */
+            bool is_tracked(osmium::object_id_type id) const {
+                assert(!m_init_phase && "Call MembersDatabase::prepare_for_lookup() before calling is_tracked().");
+                return !find(id).empty();
+            }
+
         }; // class MembersDatabaseCommon
 
         /**
@@ -391,7 +519,8 @@ namespace osmium {
              * with that id in the database.
              *
              * Complexity: Logarithmic in the number of members tracked (as
-             *             returned by size()).
+             *             returned by size()). Constant if hashed lookup
+             *             is enabled, see enable_hashed_lookup().
              */
             const TObject* get(osmium::object_id_type id) const {
                 assert(!m_init_phase && "Call MembersDatabase::prepare_for_lookup() before calling get().");
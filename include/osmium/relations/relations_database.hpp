@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/io/detail/read_write.hpp>
 #include <osmium/osm/relation.hpp>
 #include <osmium/storage/item_stash.hpp>
 
@@ -156,6 +157,34 @@ namespace osmium {
                 return m_elements.size();
             }
 
+            /**
+             * Write the contents of the database (not including the
+             * stash) to the given file descriptor so they can be
+             * restored later with load(). Dump the stash separately, the
+             * stash handles stored here stay valid across a dump()/
+             * load() pair.
+             */
+            void dump(const int fd) const {
+                const std::size_t count = m_elements.size();
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&count), sizeof(count));
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(m_elements.data()), count * sizeof(element));
+            }
+
+            /**
+             * Restore the contents of the database from the given file
+             * descriptor. The data must have been written by dump() and
+             * the stash must have been restored to the state it had when
+             * the database was dumped.
+             *
+             * @throws std::runtime_error If the data is truncated.
+             */
+            void load(const int fd) {
+                std::size_t count = 0;
+                osmium::io::detail::reliable_read_exact(fd, reinterpret_cast<char*>(&count), sizeof(count));
+                m_elements.resize(count);
+                osmium::io::detail::reliable_read_exact(fd, reinterpret_cast<char*>(m_elements.data()), count * sizeof(element));
+            }
+
             /**
              * Insert a relation into the database. The relation is copied
              * into the stash.
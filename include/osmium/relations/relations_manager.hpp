@@ -35,6 +35,8 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/handler.hpp>
 #include <osmium/handler/check_order.hpp>
+#include <osmium/index/id_set.hpp>
+#include <osmium/index/nwr_array.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/memory/callback_buffer.hpp>
 #include <osmium/osm/item_type.hpp>
@@ -47,13 +49,20 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/storage/item_stash.hpp>
 #include <osmium/tags/taglist.hpp>
 #include <osmium/tags/tags_filter.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/queue.hpp>
+#include <osmium/util/memory.hpp>
 
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <future>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -97,6 +106,20 @@ namespace osmium {
                 m_member_relations_db(m_stash, m_relations_db) {
             }
 
+            /**
+             * Limit the amount of memory used for stashed relations and
+             * member objects. When the limit is reached, cold objects
+             * are spilled to a temporary file and read back on demand,
+             * see osmium::ItemStash::set_max_memory(). Use this when
+             * building relations planet-wide would otherwise not fit
+             * into memory.
+             *
+             * Call this before feeding any data to the manager.
+             */
+            void set_max_memory(const std::size_t max_memory) noexcept {
+                m_stash.set_max_memory(max_memory);
+            }
+
             /// Access the internal RelationsDatabase.
             osmium::relations::RelationsDatabase& relations_database() noexcept {
                 return m_relations_db;
@@ -172,6 +195,39 @@ namespace osmium {
                 throw std::logic_error{"Should not be here."};
             }
 
+            /**
+             * Write the complete state of the manager (the item stash,
+             * the relations database, and the three members databases)
+             * to the given file descriptor so it can be restored later
+             * with load_state(). Use this together with the file offset
+             * of the input reader to checkpoint a long-running run, so
+             * after a restart it can continue where it left off instead
+             * of reading everything again.
+             */
+            void dump_state(const int fd) const {
+                m_stash.dump(fd);
+                m_relations_db.dump(fd);
+                m_member_nodes_db.dump(fd);
+                m_member_ways_db.dump(fd);
+                m_member_relations_db.dump(fd);
+            }
+
+            /**
+             * Restore the state of the manager from the given file
+             * descriptor. The data must have been written by
+             * dump_state(). Call this on a freshly constructed manager
+             * before feeding it any objects.
+             *
+             * @throws std::runtime_error If the data is truncated.
+             */
+            void load_state(const int fd) {
+                m_stash.load(fd);
+                m_relations_db.load(fd);
+                m_member_nodes_db.load(fd);
+                m_member_ways_db.load(fd);
+                m_member_relations_db.load(fd);
+            }
+
             /**
              * Get member object from relation member.
              *
@@ -227,6 +283,35 @@ namespace osmium {
                 return member_relations_database().get(id);
             }
 
+            /**
+             * Enable hash-indexed member lookup in all member databases,
+             * see MembersDatabaseCommon::enable_hashed_lookup(). This
+             * trades memory for constant-time member lookups in the
+             * second pass.
+             *
+             * Call this before prepare_for_lookup().
+             */
+            void enable_hashed_lookup() {
+                m_member_nodes_db.enable_hashed_lookup();
+                m_member_ways_db.enable_hashed_lookup();
+                m_member_relations_db.enable_hashed_lookup();
+            }
+
+            /**
+             * Get the ids of all required members of the specified type
+             * as an id set. Call this after the first pass. The set can
+             * be used to restrict the second pass to the objects that are
+             * actually needed, for instance through the
+             * osmium::io::pbf_ids_filter option of the osmium::io::Reader.
+             *
+             * @param type osmium::item_type::node, way, or relation.
+             */
+            osmium::index::IdSetDense<osmium::unsigned_object_id_type> member_ids(osmium::item_type type) const {
+                osmium::index::IdSetDense<osmium::unsigned_object_id_type> ids;
+                member_database(type).add_tracked_ids(ids);
+                return ids;
+            }
+
             /**
              * Sort the members databases to prepare them for reading. Usually
              * this is called between the first and second pass reading through
@@ -251,6 +336,34 @@ namespace osmium {
                 };
             }
 
+            /**
+             * Register the components of this manager (relations
+             * database, members databases, and item stash) in the
+             * process-wide MemoryAccounting registry. The account names
+             * are built from the specified prefix, for instance
+             * "areas/stash". Keep the returned handles next to the
+             * manager; the accounts are removed when they are
+             * destroyed. The manager must not be moved or destroyed
+             * while the accounts exist.
+             */
+            std::vector<osmium::MemoryAccount> account_memory(const std::string& prefix) const {
+                const RelationsManagerBase* self = this;
+                std::vector<osmium::MemoryAccount> accounts;
+                accounts.reserve(3);
+                accounts.emplace_back(prefix + "/relations_db", [self]() {
+                    return self->m_relations_db.used_memory();
+                });
+                accounts.emplace_back(prefix + "/members_dbs", [self]() {
+                    return self->m_member_nodes_db.used_memory()
+                         + self->m_member_ways_db.used_memory()
+                         + self->m_member_relations_db.used_memory();
+                });
+                accounts.emplace_back(prefix + "/stash", [self]() {
+                    return self->m_stash.used_memory();
+                });
+                return accounts;
+            }
+
             /// Access the output buffer.
             osmium::memory::Buffer& buffer() noexcept {
                 return m_output.buffer();
@@ -306,6 +419,69 @@ namespace osmium {
 
             SecondPassHandler<RelationsManager> m_handler_pass2;
 
+            /// Pool used for parallel completion. Not used if this is nullptr.
+            osmium::thread::Pool* m_pool = nullptr;
+
+            /// Completed relations waiting for parallel completion.
+            std::vector<std::size_t> m_pending_completions{};
+
+            enum : std::size_t {
+                default_completion_batch_size = 1024,
+                initial_completion_buffer_size = 1024ul * 1024ul,
+                parallel_pass_buffer_size = 1024ul * 1024ul
+            };
+
+            std::size_t m_completion_batch_size = default_completion_batch_size;
+
+            /**
+             * A task run on the thread pool calling complete_relation_into()
+             * for a range of completed relations and collecting all output
+             * in its own buffer.
+             */
+            struct completion_task {
+
+                RelationsManager* manager;
+                const std::size_t* first;
+                const std::size_t* last;
+
+                osmium::memory::Buffer operator()() const {
+                    osmium::memory::Buffer buffer{initial_completion_buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                    for (const std::size_t* it = first; it != last; ++it) {
+                        auto rel_handle = manager->relations_database()[*it];
+                        manager->derived().complete_relation_into(*rel_handle, buffer);
+                    }
+                    return buffer;
+                }
+
+            }; // struct completion_task
+
+            /**
+             * A task run on its own thread handling the member matching
+             * for one member type in the parallel second pass. It reads
+             * buffers from its queue until it sees an invalid buffer which
+             * marks the end of the input.
+             */
+            struct pipeline_task {
+
+                RelationsManager* manager;
+                osmium::thread::Queue<osmium::memory::Buffer>* queue;
+                std::mutex* mutex;
+
+                void operator()() const {
+                    while (true) {
+                        osmium::memory::Buffer buffer;
+                        queue->wait_and_pop(buffer);
+                        if (!buffer) {
+                            return;
+                        }
+                        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                            manager->process_object_parallel(object, *mutex);
+                        }
+                    }
+                }
+
+            }; // struct pipeline_task
+
             static bool wanted_type(osmium::item_type type) noexcept {
                 return (TNodes     && type == osmium::item_type::node) ||
                        (TWays      && type == osmium::item_type::way) ||
@@ -348,6 +524,21 @@ namespace osmium {
             void complete_relation(const osmium::Relation& /*relation*/) const noexcept {
             }
 
+            /**
+             * This method is called instead of complete_relation() when
+             * parallel completion has been enabled with
+             * enable_parallel_completion(). It is run concurrently on the
+             * worker threads of a thread pool, so it must not change any
+             * state of the manager. It may read the member databases. All
+             * output must be written into the specified buffer, not into
+             * the shared output buffer of the manager.
+             *
+             * You have to overwrite this in a derived class if you want to
+             * use parallel completion.
+             */
+            void complete_relation_into(const osmium::Relation& /*relation*/, osmium::memory::Buffer& /*buffer*/) const noexcept {
+            }
+
             /**
              * This method is called for all nodes during the second pass
              * before the relation member handling.
@@ -442,10 +633,7 @@ namespace osmium {
                 return *static_cast<TManager*>(this);
             }
 
-            void handle_complete_relation(RelationHandle& rel_handle) {
-                derived().complete_relation(*rel_handle);
-                possibly_flush();
-
+            void remove_relation(RelationHandle& rel_handle) {
                 for (const auto& member : rel_handle->members()) {
                     if (member.ref() != 0) {
                         member_database(member.type()).remove(member.ref(), rel_handle->id());
@@ -455,6 +643,101 @@ namespace osmium {
                 rel_handle.remove();
             }
 
+            void handle_complete_relation(RelationHandle& rel_handle) {
+                if (m_pool) {
+                    m_pending_completions.push_back(rel_handle.pos());
+                    if (m_pending_completions.size() >= m_completion_batch_size) {
+                        complete_pending_relations();
+                    }
+                    return;
+                }
+
+                derived().complete_relation(*rel_handle);
+                possibly_flush();
+
+                remove_relation(rel_handle);
+            }
+
+            void process_node_parallel(const osmium::Node& node, std::mutex& mutex) {
+                derived().before_node(node);
+                bool added = false;
+                if (member_nodes_database().is_tracked(node.id())) {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    added = member_nodes_database().add(node, [this](RelationHandle& rel_handle) {
+                        handle_complete_relation(rel_handle);
+                    });
+                    possibly_flush();
+                }
+                if (!added) {
+                    derived().node_not_in_any_relation(node);
+                }
+                derived().after_node(node);
+            }
+
+            void process_way_parallel(const osmium::Way& way, std::mutex& mutex) {
+                derived().before_way(way);
+                bool added = false;
+                if (member_ways_database().is_tracked(way.id())) {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    added = member_ways_database().add(way, [this](RelationHandle& rel_handle) {
+                        handle_complete_relation(rel_handle);
+                    });
+                    possibly_flush();
+                }
+                if (!added) {
+                    derived().way_not_in_any_relation(way);
+                }
+                derived().after_way(way);
+            }
+
+            void process_relation_parallel(const osmium::Relation& relation, std::mutex& mutex) {
+                derived().before_relation(relation);
+                bool added = false;
+                if (member_relations_database().is_tracked(relation.id())) {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    added = member_relations_database().add(relation, [this](RelationHandle& rel_handle) {
+                        handle_complete_relation(rel_handle);
+                    });
+                    possibly_flush();
+                }
+                if (!added) {
+                    derived().relation_not_in_any_relation(relation);
+                }
+                derived().after_relation(relation);
+            }
+
+            void process_object_parallel(const osmium::OSMObject& object, std::mutex& mutex) {
+                switch (object.type()) {
+                    case osmium::item_type::node:
+                        process_node_parallel(static_cast<const osmium::Node&>(object), mutex);
+                        break;
+                    case osmium::item_type::way:
+                        process_way_parallel(static_cast<const osmium::Way&>(object), mutex);
+                        break;
+                    case osmium::item_type::relation:
+                        process_relation_parallel(static_cast<const osmium::Relation&>(object), mutex);
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            void check_order(const osmium::OSMObject& object) {
+                switch (object.type()) {
+                    case osmium::item_type::node:
+                        m_check_order_handler.node(static_cast<const osmium::Node&>(object));
+                        break;
+                    case osmium::item_type::way:
+                        m_check_order_handler.way(static_cast<const osmium::Way&>(object));
+                        break;
+                    case osmium::item_type::relation:
+                        m_check_order_handler.relation(static_cast<const osmium::Relation&>(object));
+                        break;
+                    default:
+                        break;
+                }
+            }
+
         public:
 
             RelationsManager() :
@@ -471,6 +754,209 @@ namespace osmium {
                 return m_handler_pass2;
             }
 
+            /**
+             * Enable parallel handling of completed relations. Instead of
+             * calling complete_relation() directly when the last member of
+             * a relation arrives, completed relations are collected and
+             * then handled in batches as tasks on the specified thread
+             * pool. Each task calls complete_relation_into() with its own
+             * output buffer; the buffers are appended to the shared output
+             * buffer in the order the relations completed, so the output
+             * is deterministic.
+             *
+             * For this to do anything useful you have to overwrite
+             * complete_relation_into() in your derived class and make sure
+             * it is thread-safe, ie it must not change any state of the
+             * manager.
+             *
+             * Must not be combined with set_max_memory(), because reading
+             * spilled objects back from disk is not thread-safe.
+             *
+             * Call this before the second pass through the data. Any
+             * relations still pending when the pass is done are handled
+             * by flush_output(), which osmium::apply() calls through the
+             * second pass handler.
+             *
+             * @param pool The thread pool the completion tasks are run on.
+             * @param batch_size Number of completed relations collected
+             *        before a batch is dispatched to the pool.
+             */
+            void enable_parallel_completion(osmium::thread::Pool& pool, std::size_t batch_size = default_completion_batch_size) noexcept {
+                m_pool = &pool;
+                m_completion_batch_size = batch_size > 0 ? batch_size : 1;
+            }
+
+            /**
+             * Handle all completed relations that are waiting for parallel
+             * completion. Does nothing if there are none or if parallel
+             * completion is not enabled. Called automatically when a full
+             * batch has been collected and from flush_output().
+             */
+            void complete_pending_relations() {
+                if (m_pending_completions.empty()) {
+                    return;
+                }
+                assert(m_pool);
+
+                const auto size = m_pending_completions.size();
+                const std::size_t num_tasks = std::min(size, static_cast<std::size_t>(m_pool->num_threads()));
+                const std::size_t per_task = (size + num_tasks - 1) / num_tasks;
+                const std::size_t* const data = m_pending_completions.data();
+
+                std::vector<std::future<osmium::memory::Buffer>> results;
+                results.reserve(num_tasks);
+                for (std::size_t offset = 0; offset < size; offset += per_task) {
+                    const std::size_t end = std::min(offset + per_task, size);
+                    results.push_back(m_pool->submit(completion_task{this, data + offset, data + end}));
+                }
+
+                // Wait for the tasks in the order they were submitted, so
+                // the output ends up in the order the relations completed.
+                for (auto& result : results) {
+                    const osmium::memory::Buffer task_buffer{result.get()};
+                    if (task_buffer.committed() > 0) {
+                        buffer().add_buffer(task_buffer);
+                        buffer().commit();
+                        possibly_flush();
+                    }
+                }
+
+                for (const auto pos : m_pending_completions) {
+                    auto rel_handle = relations_database()[pos];
+                    remove_relation(rel_handle);
+                }
+                m_pending_completions.clear();
+            }
+
+            /**
+             * Flush the output buffer. When parallel completion is enabled
+             * this handles all pending completed relations first.
+             *
+             * (This hides RelationsManagerBase::flush_output().)
+             */
+            void flush_output() {
+                complete_pending_relations();
+                RelationsManagerBase::flush_output();
+            }
+
+            /**
+             * Run the second pass through the data with the member matching
+             * for nodes, ways, and relations running on separate threads,
+             * one per member type. Use this instead of applying the
+             * handler() to the input:
+             *
+             * @code
+             * osmium::io::Reader reader{infile};
+             * manager.second_pass_parallel(reader, callback);
+             * reader.close();
+             * @endcode
+             *
+             * The input is read on the calling thread and split into
+             * per-type buffers which are handed to the matching threads,
+             * overlapping the member matching of each type with the
+             * decoding of the input and with the matching of the other
+             * types. Objects not needed by any relation are rejected
+             * without taking any lock; everything that changes shared
+             * state (storing members, completing relations, writing to
+             * the output buffer) is serialized through an internal lock.
+             * Relations are completed in the order their last members are
+             * processed, which can differ from the single-threaded order.
+             *
+             * The before_*(), *_not_in_any_relation(), and after_*()
+             * functions of the derived class are called on the matching
+             * threads. Calls for the same type are made in input order
+             * from a single thread, but calls for different types run
+             * concurrently, so these functions and the output callback
+             * must be thread-safe. complete_relation() is always called
+             * under the internal lock. Can be combined with
+             * enable_parallel_completion().
+             *
+             * Call prepare_for_lookup() before calling this function.
+             *
+             * @tparam TSource The source class, usually osmium::io::Reader.
+             *         Needs a read() function returning an
+             *         osmium::memory::Buffer that is invalid when the
+             *         input is exhausted.
+             * @param source Where to read the input from.
+             * @param callback Called with the output buffer whenever it
+             *        is full, see set_callback().
+             */
+            template <typename TSource>
+            void second_pass_parallel(TSource& source, const std::function<void(osmium::memory::Buffer&&)>& callback = nullptr) {
+                set_callback(callback);
+
+                const osmium::item_type types[] = {osmium::item_type::node,
+                                                   osmium::item_type::way,
+                                                   osmium::item_type::relation};
+
+                osmium::nwr_array<osmium::thread::Queue<osmium::memory::Buffer>> queues;
+                osmium::nwr_array<osmium::memory::Buffer> staging;
+                std::mutex mutex;
+
+                std::vector<std::thread> threads;
+                std::vector<std::future<void>> results;
+                for (const auto type : types) {
+                    if (wanted_type(type)) {
+                        staging(type) = osmium::memory::Buffer{parallel_pass_buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                        std::packaged_task<void()> task{pipeline_task{this, &queues(type), &mutex}};
+                        results.push_back(task.get_future());
+                        threads.emplace_back(std::move(task));
+                    }
+                }
+
+                try {
+                    while (osmium::memory::Buffer buffer = source.read()) {
+                        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                            check_order(object);
+                            if (!wanted_type(object.type())) {
+                                continue;
+                            }
+                            auto& staging_buffer = staging(object.type());
+                            staging_buffer.add_item(object);
+                            staging_buffer.commit();
+                            if (staging_buffer.committed() >= parallel_pass_buffer_size) {
+                                queues(object.type()).push(std::move(staging_buffer));
+                                staging_buffer = osmium::memory::Buffer{parallel_pass_buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                            }
+                        }
+                    }
+                } catch (...) {
+                    // Shut down the matching threads before letting the
+                    // exception escape, otherwise they would wait on their
+                    // queues forever.
+                    for (const auto type : types) {
+                        if (wanted_type(type)) {
+                            queues(type).push(osmium::memory::Buffer{});
+                        }
+                    }
+                    for (auto& thread : threads) {
+                        thread.join();
+                    }
+                    throw;
+                }
+
+                // Push the remaining objects and then an invalid buffer as
+                // end marker to each queue.
+                for (const auto type : types) {
+                    if (wanted_type(type)) {
+                        auto& staging_buffer = staging(type);
+                        if (staging_buffer.committed() > 0) {
+                            queues(type).push(std::move(staging_buffer));
+                        }
+                        queues(type).push(osmium::memory::Buffer{});
+                    }
+                }
+
+                for (auto& thread : threads) {
+                    thread.join();
+                }
+                for (auto& result : results) {
+                    result.get();
+                }
+
+                flush_output();
+            }
+
             /**
              * Add the specified relation to the list of relations we want to
              * build. This calls the new_relation() and new_member()
@@ -33,13 +33,24 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/io/detail/read_write.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/memory/item.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <limits>
+#include <map>
+#include <memory>
 #include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
 #include <vector>
 
 #ifdef OSMIUM_ITEM_STORAGE_GC_DEBUG
@@ -119,14 +130,64 @@ namespace osmium {
             initial_buffer_size = 1024ul * 1024ul
         };
 
+        enum : std::size_t {
+            default_gc_step_size = 10ul * 1000ul
+        };
+
         enum {
             removed_item_offset = std::numeric_limits<std::size_t>::max()
         };
 
+        // In spill mode the offsets of items that have been written out
+        // to the temporary file are marked with this bit.
+        enum : std::size_t {
+            spilled_item_flag = std::size_t{1} << (std::numeric_limits<std::size_t>::digits - 1)
+        };
+
+        // While an incremental garbage collection cycle is running, the
+        // offsets of items that still live in the old buffer are marked
+        // with this bit.
+        enum : std::size_t {
+            old_space_item_flag = std::size_t{1} << (std::numeric_limits<std::size_t>::digits - 2)
+        };
+
         osmium::memory::Buffer m_buffer;
         std::vector<std::size_t> m_index;
         std::size_t m_count_items = 0;
         std::size_t m_count_removed = 0;
+
+        // Incremental garbage collection, see enable_incremental_gc().
+        // While a collection cycle is running, m_old_buffer holds the
+        // buffer being collected and live items are moved from it into
+        // m_buffer a bounded number of index entries at a time.
+        osmium::memory::Buffer m_old_buffer{};
+        std::size_t m_gc_items_per_step = 0;
+        std::size_t m_gc_pos = 0;
+        std::size_t m_gc_end = 0;
+        std::size_t m_count_removed_old = 0;
+        bool m_gc_active = false;
+
+        // Items added while a collection cycle is running interleave in
+        // the buffer with items moved later, so the index entries are
+        // not ordered by buffer offset any more. The stop-the-world
+        // compaction in garbage_collect() relies on that order, so once
+        // this happened collection always goes through a full cycle.
+        bool m_index_unordered = false;
+
+        // Spill mode, see set_max_memory(). When m_max_memory is 0,
+        // spilling is disabled and none of the following members are
+        // used.
+        std::size_t m_max_memory = 0;
+        std::size_t m_spill_file_size = 0;
+        int m_spill_fd = -1;
+
+        // Spilled items loaded back with get_item() are kept hot in
+        // this cache, each in its own allocation so references stay
+        // stable. The cache is emptied wholesale in add_item() when it
+        // grows too big, which is the only place where the API allows
+        // references to be invalidated anyway.
+        mutable std::map<std::size_t, std::unique_ptr<unsigned char[]>> m_cache{};
+        mutable std::size_t m_cache_size = 0;
 #ifdef OSMIUM_ITEM_STORAGE_GC_DEBUG
         int64_t m_gc_time = 0;
 #endif
@@ -153,22 +214,105 @@ namespace osmium {
 
         }; // cleanup_helper
 
-        std::size_t& get_item_offset_ref(handle_type handle) noexcept {
-            assert(handle.valid() && "handle must be valid");
-            assert(handle.value <= m_index.size());
-            auto& offset = m_index[handle.value - 1];
-            assert(offset != removed_item_offset);
-            assert(offset < m_buffer.committed());
-            return offset;
+        bool is_spilled(const std::size_t offset) const noexcept {
+            return m_max_memory != 0 && (offset & spilled_item_flag) != 0;
         }
 
-        std::size_t get_item_offset(handle_type handle) const noexcept {
-            assert(handle.valid() && "handle must be valid");
-            assert(handle.value <= m_index.size());
-            const auto& offset = m_index[handle.value - 1];
-            assert(offset != removed_item_offset);
-            assert(offset < m_buffer.committed());
-            return offset;
+        bool is_in_old_space(const std::size_t offset) const noexcept {
+            return m_gc_active && (offset & old_space_item_flag) != 0;
+        }
+
+        /**
+         * Start an incremental garbage collection cycle: The current
+         * buffer becomes the old space and all live in-buffer items are
+         * marked in the index. The items are then moved into a fresh
+         * buffer by garbage_collect_step().
+         */
+        void start_gc_cycle() {
+            assert(!m_gc_active);
+            m_old_buffer = std::move(m_buffer);
+            m_buffer = osmium::memory::Buffer{initial_buffer_size, osmium::memory::Buffer::auto_grow::yes};
+            for (auto& offset : m_index) {
+                if (offset != removed_item_offset && !is_spilled(offset)) {
+                    offset |= old_space_item_flag;
+                }
+            }
+            m_count_removed_old += m_count_removed;
+            m_count_removed = 0;
+            m_gc_pos = 0;
+            m_gc_end = m_index.size();
+            m_gc_active = true;
+        }
+
+        void spill_seek(const std::size_t offset) const {
+#ifdef _MSC_VER
+            _lseeki64(m_spill_fd, static_cast<__int64>(offset), SEEK_SET);
+#else
+            ::lseek(m_spill_fd, static_cast<off_t>(offset), SEEK_SET);
+#endif
+        }
+
+        void spill_read(unsigned char* data, const std::size_t size) const {
+            std::size_t done = 0;
+            while (done < size) {
+                const auto nread = osmium::io::detail::reliable_read(m_spill_fd, reinterpret_cast<char*>(data) + done, static_cast<unsigned int>(size - done));
+                if (nread == 0) {
+                    throw std::runtime_error{"unexpected end of ItemStash spill file"};
+                }
+                done += static_cast<std::size_t>(nread);
+            }
+        }
+
+        /**
+         * Write everything in the buffer out to the temporary file and
+         * mark the affected index entries as spilled. Removed items are
+         * garbage collected first so they don't take up disk space.
+         */
+        void spill_to_disk() {
+            garbage_collect();
+            if (m_buffer.committed() == 0) {
+                return;
+            }
+            if (m_spill_fd == -1) {
+                m_spill_fd = osmium::detail::create_tmp_file();
+            }
+            spill_seek(m_spill_file_size);
+            osmium::io::detail::reliable_write(m_spill_fd, m_buffer.data(), m_buffer.committed());
+            for (auto& offset : m_index) {
+                if (offset != removed_item_offset && (offset & spilled_item_flag) == 0) {
+                    offset = (m_spill_file_size + offset) | spilled_item_flag;
+                }
+            }
+            m_spill_file_size += m_buffer.committed();
+            m_buffer.clear();
+        }
+
+        osmium::memory::Item& load_spilled_item(const std::size_t handle_value, const std::size_t file_offset) const {
+            auto it = m_cache.find(handle_value);
+            if (it == m_cache.end()) {
+                spill_seek(file_offset);
+                osmium::memory::item_size_type item_size = 0;
+                spill_read(reinterpret_cast<unsigned char*>(&item_size), sizeof(item_size));
+                const std::size_t padded_size = osmium::memory::padded_length(item_size);
+
+                std::unique_ptr<unsigned char[]> data{new unsigned char[padded_size]};
+                spill_seek(file_offset);
+                spill_read(data.get(), padded_size);
+                m_cache_size += padded_size;
+                it = m_cache.emplace(handle_value, std::move(data)).first;
+            }
+            return *reinterpret_cast<osmium::memory::Item*>(it->second.get());
+        }
+
+        void close_spill_file() noexcept {
+            if (m_spill_fd != -1) {
+                try {
+                    osmium::io::detail::reliable_close(m_spill_fd);
+                } catch (const std::system_error&) {
+                    // Ignore, the temporary file is gone either way.
+                }
+                m_spill_fd = -1;
+            }
         }
 
         // This function decides whether it makes sense to garbage collect the
@@ -199,6 +343,87 @@ namespace osmium {
             m_buffer(initial_buffer_size, osmium::memory::Buffer::auto_grow::yes) {
         }
 
+        ItemStash(const ItemStash&) = delete;
+        ItemStash& operator=(const ItemStash&) = delete;
+
+        ItemStash(ItemStash&& other) noexcept :
+            m_buffer(std::move(other.m_buffer)),
+            m_index(std::move(other.m_index)),
+            m_count_items(other.m_count_items),
+            m_count_removed(other.m_count_removed),
+            m_old_buffer(std::move(other.m_old_buffer)),
+            m_gc_items_per_step(other.m_gc_items_per_step),
+            m_gc_pos(other.m_gc_pos),
+            m_gc_end(other.m_gc_end),
+            m_count_removed_old(other.m_count_removed_old),
+            m_gc_active(other.m_gc_active),
+            m_index_unordered(other.m_index_unordered),
+            m_max_memory(other.m_max_memory),
+            m_spill_file_size(other.m_spill_file_size),
+            m_spill_fd(other.m_spill_fd),
+            m_cache(std::move(other.m_cache)),
+            m_cache_size(other.m_cache_size) {
+            other.m_gc_active = false;
+            other.m_spill_fd = -1;
+        }
+
+        ItemStash& operator=(ItemStash&& other) noexcept {
+            close_spill_file();
+            m_buffer            = std::move(other.m_buffer);
+            m_index             = std::move(other.m_index);
+            m_count_items       = other.m_count_items;
+            m_count_removed     = other.m_count_removed;
+            m_old_buffer        = std::move(other.m_old_buffer);
+            m_gc_items_per_step = other.m_gc_items_per_step;
+            m_gc_pos            = other.m_gc_pos;
+            m_gc_end            = other.m_gc_end;
+            m_count_removed_old = other.m_count_removed_old;
+            m_gc_active         = other.m_gc_active;
+            m_index_unordered   = other.m_index_unordered;
+            m_max_memory        = other.m_max_memory;
+            m_spill_file_size   = other.m_spill_file_size;
+            m_spill_fd          = other.m_spill_fd;
+            m_cache             = std::move(other.m_cache);
+            m_cache_size        = other.m_cache_size;
+            other.m_gc_active   = false;
+            other.m_spill_fd    = -1;
+            return *this;
+        }
+
+        ~ItemStash() noexcept {
+            close_spill_file();
+        }
+
+        /**
+         * Enable spill mode: When the internal buffer grows beyond
+         * max_memory bytes, its contents are written out to an unnamed
+         * temporary file and the memory is reused. Spilled items read
+         * with get_item() are loaded back into an in-memory cache of
+         * hot items which is emptied again when it grows beyond a
+         * quarter of max_memory.
+         *
+         * The usual rule that references into the stash stay valid
+         * until the next add_item() or clear() call still holds, both
+         * spilling and cache eviction only ever happen inside those
+         * calls.
+         *
+         * Call this before adding the first item. Setting max_memory
+         * to 0 disables spilling for items added from then on.
+         */
+        void set_max_memory(const std::size_t max_memory) noexcept {
+            m_max_memory = max_memory;
+        }
+
+        /**
+         * The number of bytes of spilled items in the temporary file.
+         * Always 0 if spill mode is not enabled, see set_max_memory().
+         * Disk space of spilled items that were removed later is not
+         * reclaimed until the stash is cleared or destroyed.
+         */
+        std::size_t spill_file_size() const noexcept {
+            return m_spill_file_size;
+        }
+
         /**
          * Return an estimate of the number of bytes currently used by this
          * ItemStash instance.
@@ -208,7 +433,24 @@ namespace osmium {
         std::size_t used_memory() const noexcept {
             return sizeof(ItemStash) +
                    m_buffer.capacity() +
-                   m_index.capacity() * sizeof(std::size_t);
+                   m_old_buffer.capacity() +
+                   m_index.capacity() * sizeof(std::size_t) +
+                   m_cache_size;
+        }
+
+        /**
+         * Register this stash in the process-wide MemoryAccounting
+         * registry under the specified name, reporting its
+         * used_memory(). Keep the returned handle next to the stash;
+         * the account is removed when the handle is destroyed. The
+         * stash must not be moved or destroyed while the account
+         * exists.
+         */
+        osmium::MemoryAccount account_memory(std::string name) const {
+            const ItemStash* self = this;
+            return osmium::MemoryAccount{std::move(name), [self]() {
+                return self->used_memory();
+            }};
         }
 
         /**
@@ -228,7 +470,7 @@ namespace osmium {
          * Complexity: Constant.
          */
         std::size_t count_removed() const noexcept {
-            return m_count_removed;
+            return m_count_removed + m_count_removed_old;
         }
 
         /**
@@ -240,6 +482,69 @@ namespace osmium {
             m_index.clear();
             m_count_items = 0;
             m_count_removed = 0;
+            m_old_buffer = osmium::memory::Buffer{};
+            m_gc_pos = 0;
+            m_gc_end = 0;
+            m_count_removed_old = 0;
+            m_gc_active = false;
+            m_index_unordered = false;
+            m_spill_file_size = 0;
+            m_cache.clear();
+            m_cache_size = 0;
+        }
+
+        /**
+         * Write the contents of the stash to the given file descriptor
+         * so they can be restored later with load(). Handles stay valid
+         * across a dump()/load() pair, so data structures holding
+         * handles can be checkpointed alongside the stash. Items are
+         * written out one by one, so this works no matter if a garbage
+         * collection cycle is running or items have been spilled to
+         * disk.
+         */
+        void dump(const int fd) const {
+            const std::size_t num_slots = m_index.size();
+            osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&num_slots), sizeof(num_slots));
+            for (std::size_t i = 0; i < num_slots; ++i) {
+                if (m_index[i] == removed_item_offset) {
+                    const std::size_t marker = removed_item_offset;
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&marker), sizeof(marker));
+                } else {
+                    const auto& item = get_item(handle_type{i + 1});
+                    const std::size_t size = item.padded_size();
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&size), sizeof(size));
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&item), size);
+                }
+            }
+        }
+
+        /**
+         * Restore the contents of the stash from the given file
+         * descriptor. The stash is cleared first, the data must have
+         * been written by dump(). All handles that were valid when the
+         * stash was dumped are valid for the restored stash.
+         *
+         * @throws std::runtime_error If the data is truncated.
+         */
+        void load(const int fd) {
+            clear();
+            std::size_t num_slots = 0;
+            osmium::io::detail::reliable_read_exact(fd, reinterpret_cast<char*>(&num_slots), sizeof(num_slots));
+            m_index.reserve(num_slots);
+            for (std::size_t i = 0; i < num_slots; ++i) {
+                std::size_t size = 0;
+                osmium::io::detail::reliable_read_exact(fd, reinterpret_cast<char*>(&size), sizeof(size));
+                if (size == removed_item_offset) {
+                    m_index.push_back(removed_item_offset);
+                    ++m_count_removed;
+                } else {
+                    const auto offset = m_buffer.committed();
+                    osmium::io::detail::reliable_read_exact(fd, reinterpret_cast<char*>(m_buffer.reserve_space(size)), size);
+                    m_buffer.commit();
+                    m_index.push_back(offset);
+                    ++m_count_items;
+                }
+            }
         }
 
         /**
@@ -249,8 +554,27 @@ namespace osmium {
          * Complexity: Amortized constant.
          */
         handle_type add_item(const osmium::memory::Item& item) {
-            if (should_gc()) {
-                garbage_collect();
+            if (m_max_memory != 0) {
+                if (m_cache_size > m_max_memory / 4) {
+                    m_cache.clear();
+                    m_cache_size = 0;
+                }
+                if (m_buffer.committed() >= m_max_memory) {
+                    spill_to_disk();
+                }
+            }
+            if (m_gc_active) {
+                garbage_collect_step(m_gc_items_per_step);
+            } else if (should_gc()) {
+                if (m_gc_items_per_step != 0) {
+                    start_gc_cycle();
+                    garbage_collect_step(m_gc_items_per_step);
+                } else {
+                    garbage_collect();
+                }
+            }
+            if (m_gc_active) {
+                m_index_unordered = true;
             }
             ++m_count_items;
             const auto offset = m_buffer.committed();
@@ -272,7 +596,18 @@ namespace osmium {
          *      item.
          */
         osmium::memory::Item& get_item(handle_type handle) const {
-            return m_buffer.get<osmium::memory::Item>(get_item_offset(handle));
+            assert(handle.valid() && "handle must be valid");
+            assert(handle.value <= m_index.size());
+            const auto offset = m_index[handle.value - 1];
+            assert(offset != removed_item_offset);
+            if (is_spilled(offset)) {
+                return load_spilled_item(handle.value, offset & ~static_cast<std::size_t>(spilled_item_flag));
+            }
+            if (is_in_old_space(offset)) {
+                return m_old_buffer.get<osmium::memory::Item>(offset & ~static_cast<std::size_t>(old_space_item_flag));
+            }
+            assert(offset < m_buffer.committed());
+            return m_buffer.get<osmium::memory::Item>(offset);
         }
 
         /**
@@ -295,15 +630,102 @@ namespace osmium {
             return static_cast<T&>(get_item(handle));
         }
 
+        /**
+         * Enable incremental garbage collection: Instead of compacting
+         * the whole internal buffer in one go, which can stall for
+         * seconds on large stashes, add_item() will from then on do a
+         * bounded amount of collection work per call. A collection
+         * cycle moves all live items into a fresh buffer, up to
+         * items_per_step index entries at a time, and then throws the
+         * old buffer away. While a cycle is running both buffers exist,
+         * so peak memory use is higher than with the stop-the-world
+         * garbage_collect().
+         *
+         * You can also drive collection yourself by calling
+         * garbage_collect_step() whenever you have time to spare.
+         *
+         * @param items_per_step Maximum number of index entries handled
+         *        per add_item() call. Set to 0 to go back to
+         *        stop-the-world collection.
+         */
+        void enable_incremental_gc(std::size_t items_per_step = default_gc_step_size) noexcept {
+            m_gc_items_per_step = items_per_step;
+        }
+
+        /// Is an incremental garbage collection cycle running?
+        bool garbage_collecting() const noexcept {
+            return m_gc_active;
+        }
+
+        /**
+         * Do a bounded amount of garbage collection work. If no
+         * collection cycle is running, a new cycle is started if there
+         * are any removed items, otherwise this does nothing. Handles
+         * stay valid, but references into the stash are invalidated
+         * just like by add_item().
+         *
+         * Complexity: Linear in max_items.
+         *
+         * @param max_items Maximum number of index entries to handle.
+         * @returns True if the collection cycle is complete (or none
+         *          was needed), false if there is still work to do.
+         */
+        bool garbage_collect_step(const std::size_t max_items) {
+            if (!m_gc_active) {
+                if (m_count_removed == 0) {
+                    return true;
+                }
+                start_gc_cycle();
+            }
+
+            const std::size_t end = m_gc_pos + std::min(max_items, m_gc_end - m_gc_pos);
+            while (m_gc_pos < end) {
+                auto& offset = m_index[m_gc_pos];
+                if (offset != removed_item_offset && (offset & old_space_item_flag) != 0 && !is_spilled(offset)) {
+                    const auto& item = m_old_buffer.get<osmium::memory::Item>(offset & ~static_cast<std::size_t>(old_space_item_flag));
+                    const auto new_offset = m_buffer.committed();
+                    m_buffer.add_item(item);
+                    m_buffer.commit();
+                    offset = new_offset;
+                }
+                ++m_gc_pos;
+            }
+
+            if (m_gc_pos >= m_gc_end) {
+                m_old_buffer = osmium::memory::Buffer{};
+                m_count_removed_old = 0;
+                m_gc_active = false;
+            }
+
+            return !m_gc_active;
+        }
+
         /**
          * Garbage collect the memory used by the ItemStash. This will free up
          * memory for adding new items. No memory is actually returned to the
          * OS. Usually you do not need to call this, because add_item() will
          * call it for you as necessary.
          *
+         * If an incremental garbage collection cycle is running, it is
+         * finished first.
+         *
          * Complexity: Linear in size() + count_removed().
          */
         void garbage_collect() {
+            while (m_gc_active) {
+                garbage_collect_step(std::numeric_limits<std::size_t>::max());
+            }
+
+            if (m_index_unordered) {
+                // A complete collection cycle without any interleaved
+                // add_item() calls restores the index order.
+                start_gc_cycle();
+                while (!garbage_collect_step(std::numeric_limits<std::size_t>::max())) {
+                }
+                m_index_unordered = false;
+                return;
+            }
+
 #ifdef OSMIUM_ITEM_STORAGE_GC_DEBUG
             std::cerr << "GC items=" << m_count_items << " removed=" << m_count_removed << " buffer.committed=" << m_buffer.committed() << " buffer.capacity=" << m_buffer.capacity() << "\n";
             using clock = std::chrono::high_resolution_clock;
@@ -336,13 +758,32 @@ namespace osmium {
          *      item.
          */
         void remove_item(handle_type handle) {
-            auto& offset = get_item_offset_ref(handle);
-            auto& item = m_buffer.get<osmium::memory::Item>(offset);
-            assert(!item.removed() && "can not call remove_item() on already removed item");
-            item.set_removed(true);
+            assert(handle.valid() && "handle must be valid");
+            assert(handle.value <= m_index.size());
+            auto& offset = m_index[handle.value - 1];
+            assert(offset != removed_item_offset);
+            if (is_spilled(offset)) {
+                // The disk space is not reclaimed, it is only freed
+                // with the temporary file. Just drop the item from the
+                // cache of hot items.
+                const auto it = m_cache.find(handle.value);
+                if (it != m_cache.end()) {
+                    m_cache_size -= reinterpret_cast<const osmium::memory::Item*>(it->second.get())->padded_size();
+                    m_cache.erase(it);
+                }
+            } else if (is_in_old_space(offset)) {
+                // The old buffer is thrown away wholesale when the
+                // collection cycle is done, no need to mark the item.
+                ++m_count_removed_old;
+            } else {
+                assert(offset < m_buffer.committed());
+                auto& item = m_buffer.get<osmium::memory::Item>(offset);
+                assert(!item.removed() && "can not call remove_item() on already removed item");
+                item.set_removed(true);
+                ++m_count_removed;
+            }
             offset = removed_item_offset;
             --m_count_items;
-            ++m_count_removed;
         }
 
     }; // class ItemStash
@@ -0,0 +1,338 @@
+#ifndef OSMIUM_STORAGE_PACKED_WAY_NODE_STORAGE_HPP
+#define OSMIUM_STORAGE_PACKED_WAY_NODE_STORAGE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/osm/node_ref_list.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/util/delta.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * Compact in-memory storage for the node references of ways. For
+     * every added way the way id and the ids of its nodes are stored
+     * as delta-encoded varints, which typically needs one to three
+     * bytes per node reference instead of the 16 bytes a NodeRef
+     * takes up in a buffer. Locations are not stored.
+     *
+     * Use this for id-only processing, for instance when building
+     * relation or routing graphs from ways, where keeping all way
+     * buffers in memory does not fit into RAM:
+     *
+     * @code
+     * osmium::PackedWayNodeStorage storage;
+     * ... storage.add(way); ...
+     * for (const auto way : storage) {
+     *     ... way.way_id() ...
+     *     for (const osmium::object_id_type id : way) {
+     *         ...
+     *     }
+     * }
+     * @endcode
+     *
+     * Ways can only be added, not changed or removed. Iteration
+     * delivers the ways in the order they were added.
+     */
+    class PackedWayNodeStorage {
+
+        std::vector<unsigned char> m_data{};
+
+        /// Start offset of each way record in m_data.
+        std::vector<std::size_t> m_offsets{};
+
+        static uint64_t zigzag_encode(const int64_t value) noexcept {
+            return (static_cast<uint64_t>(value) << 1u) ^ static_cast<uint64_t>(value >> 63u);
+        }
+
+        static int64_t zigzag_decode(const uint64_t value) noexcept {
+            return static_cast<int64_t>(value >> 1u) ^ -static_cast<int64_t>(value & 1u);
+        }
+
+        static void append_varint(std::vector<unsigned char>& data, uint64_t value) {
+            while (value >= 0x80u) {
+                data.push_back(static_cast<unsigned char>((value & 0x7fu) | 0x80u));
+                value >>= 7u;
+            }
+            data.push_back(static_cast<unsigned char>(value));
+        }
+
+        /// Decode one varint, advancing the data pointer behind it.
+        static uint64_t decode_varint(const unsigned char** data) noexcept {
+            const unsigned char* p = *data;
+            uint64_t value = 0;
+            unsigned int shift = 0;
+            while (*p & 0x80u) {
+                value |= static_cast<uint64_t>(*p++ & 0x7fu) << shift;
+                shift += 7;
+                assert(shift < 70);
+            }
+            value |= static_cast<uint64_t>(*p++) << shift;
+            *data = p;
+            return value;
+        }
+
+    public:
+
+        /**
+         * Iterator over the node ids of one way. Decodes the packed
+         * delta varints transparently while iterating.
+         */
+        class node_id_iterator {
+
+            const unsigned char* m_pos = nullptr;
+            std::size_t m_remaining = 0;
+            osmium::object_id_type m_value = 0;
+
+            void decode_next() noexcept {
+                m_value += zigzag_decode(decode_varint(&m_pos));
+            }
+
+            friend class PackedWayNodeStorage;
+
+            node_id_iterator(const unsigned char* pos, const std::size_t count) noexcept :
+                m_pos(pos),
+                m_remaining(count) {
+                if (m_remaining > 0) {
+                    decode_next();
+                }
+            }
+
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = osmium::object_id_type;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const value_type*;
+            using reference         = const value_type&;
+
+            node_id_iterator() noexcept = default;
+
+            osmium::object_id_type operator*() const noexcept {
+                assert(m_remaining > 0);
+                return m_value;
+            }
+
+            node_id_iterator& operator++() noexcept {
+                assert(m_remaining > 0);
+                --m_remaining;
+                if (m_remaining > 0) {
+                    decode_next();
+                }
+                return *this;
+            }
+
+            node_id_iterator operator++(int) noexcept {
+                node_id_iterator tmp{*this};
+                operator++();
+                return tmp;
+            }
+
+            bool operator==(const node_id_iterator& other) const noexcept {
+                return m_remaining == other.m_remaining &&
+                       (m_remaining == 0 || m_pos == other.m_pos);
+            }
+
+            bool operator!=(const node_id_iterator& other) const noexcept {
+                return !(*this == other);
+            }
+
+        }; // class node_id_iterator
+
+        /**
+         * One way in the storage: its id and an iterator range over
+         * the ids of its nodes.
+         */
+        class way_ref {
+
+            const unsigned char* m_nodes = nullptr;
+            osmium::object_id_type m_way_id = 0;
+            std::size_t m_num_nodes = 0;
+
+            friend class PackedWayNodeStorage;
+
+            explicit way_ref(const unsigned char* record) noexcept {
+                m_way_id = zigzag_decode(decode_varint(&record));
+                m_num_nodes = decode_varint(&record);
+                m_nodes = record;
+            }
+
+        public:
+
+            osmium::object_id_type way_id() const noexcept {
+                return m_way_id;
+            }
+
+            /// The number of node references of this way.
+            std::size_t size() const noexcept {
+                return m_num_nodes;
+            }
+
+            node_id_iterator begin() const noexcept {
+                return {m_nodes, m_num_nodes};
+            }
+
+            node_id_iterator end() const noexcept {
+                return {};
+            }
+
+        }; // class way_ref
+
+        /// Iterator over the ways in the storage.
+        class const_iterator {
+
+            const PackedWayNodeStorage* m_storage = nullptr;
+            std::size_t m_index = 0;
+
+            friend class PackedWayNodeStorage;
+
+            const_iterator(const PackedWayNodeStorage* storage, const std::size_t index) noexcept :
+                m_storage(storage),
+                m_index(index) {
+            }
+
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = way_ref;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const value_type*;
+            using reference         = value_type;
+
+            const_iterator() noexcept = default;
+
+            way_ref operator*() const noexcept {
+                assert(m_storage && m_index < m_storage->m_offsets.size());
+                return way_ref{m_storage->m_data.data() + m_storage->m_offsets[m_index]};
+            }
+
+            const_iterator& operator++() noexcept {
+                ++m_index;
+                return *this;
+            }
+
+            const_iterator operator++(int) noexcept {
+                const_iterator tmp{*this};
+                ++m_index;
+                return tmp;
+            }
+
+            bool operator==(const const_iterator& other) const noexcept {
+                return m_storage == other.m_storage && m_index == other.m_index;
+            }
+
+            bool operator!=(const const_iterator& other) const noexcept {
+                return !(*this == other);
+            }
+
+        }; // class const_iterator
+
+        PackedWayNodeStorage() = default;
+
+        /**
+         * Add a way with the given id and node references to the
+         * storage.
+         */
+        void add(const osmium::object_id_type way_id, const osmium::NodeRefList& nodes) {
+            m_offsets.push_back(m_data.size());
+            append_varint(m_data, zigzag_encode(way_id));
+            append_varint(m_data, nodes.size());
+
+            osmium::DeltaEncode<osmium::object_id_type> delta;
+            for (const auto& node_ref : nodes) {
+                append_varint(m_data, zigzag_encode(delta.update(node_ref.ref())));
+            }
+        }
+
+        /**
+         * Add the id and node references of the given way to the
+         * storage. Locations are not stored.
+         */
+        void add(const osmium::Way& way) {
+            add(way.id(), way.nodes());
+        }
+
+        /// The number of ways in the storage.
+        std::size_t size() const noexcept {
+            return m_offsets.size();
+        }
+
+        /// Is the storage empty?
+        bool empty() const noexcept {
+            return m_offsets.empty();
+        }
+
+        /// Clear the storage.
+        void clear() {
+            m_data.clear();
+            m_offsets.clear();
+        }
+
+        /**
+         * The number of bytes currently needed for this storage
+         * including all management overhead.
+         */
+        std::size_t used_memory() const noexcept {
+            return sizeof(PackedWayNodeStorage) +
+                   m_data.capacity() +
+                   m_offsets.capacity() * sizeof(std::size_t);
+        }
+
+        const_iterator begin() const noexcept {
+            return {this, 0};
+        }
+
+        const_iterator end() const noexcept {
+            return {this, m_offsets.size()};
+        }
+
+        const_iterator cbegin() const noexcept {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept {
+            return end();
+        }
+
+    }; // class PackedWayNodeStorage
+
+} // namespace osmium
+
+#endif // OSMIUM_STORAGE_PACKED_WAY_NODE_STORAGE_HPP
@@ -0,0 +1,107 @@
+#ifndef OSMIUM_TAGS_FILTER_BUFFER_HPP
+#define OSMIUM_TAGS_FILTER_BUFFER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/id_set.hpp>
+#include <osmium/index/nwr_array.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+
+namespace osmium {
+
+    namespace tags {
+
+        /// Id sets filled by filter_buffer(), one per object type.
+        using filter_id_sets = osmium::nwr_array<osmium::index::IdSetDense<osmium::unsigned_object_id_type>>;
+
+        /**
+         * Check all OSM objects in the committed part of a buffer
+         * against the specified filter in one pass. Objects with at
+         * least one tag matching the filter (as in match_any_of()) get
+         * their id added to the set for their type in matching_ids.
+         * Objects with negative ids and objects that are not nodes,
+         * ways, or relations are checked but never added to a set.
+         *
+         * If remove_non_matches is set, objects without a matching tag
+         * are flagged as removed, so a following call to
+         * Buffer::purge_removed() leaves only the matching objects in
+         * the buffer.
+         *
+         * Checking a whole buffer at a time instead of dispatching
+         * object-by-object through a handler amortizes the filter setup
+         * over many objects and makes buffers the unit of work when
+         * parallelizing a filter stage.
+         *
+         * @param buffer Buffer with the objects to check.
+         * @param filter A filter callable for single tags, for instance
+         *               an osmium::TagsFilter.
+         * @param matching_ids Id sets the ids of matching objects are
+         *                     added to.
+         * @param remove_non_matches If set, flag objects without a
+         *                           matching tag as removed.
+         * @returns The number of matching objects.
+         */
+        template <typename TFilter>
+        std::size_t filter_buffer(osmium::memory::Buffer& buffer, const TFilter& filter, filter_id_sets& matching_ids, const bool remove_non_matches = false) {
+            std::size_t count = 0;
+
+            for (auto& object : buffer.select<osmium::OSMObject>()) {
+                const auto& tags = object.tags();
+                if (std::any_of(tags.cbegin(), tags.cend(), std::cref(filter))) {
+                    ++count;
+                    const auto type = object.type();
+                    if (object.id() >= 0 && (type == osmium::item_type::node ||
+                                             type == osmium::item_type::way ||
+                                             type == osmium::item_type::relation)) {
+                        matching_ids(type).set(static_cast<osmium::unsigned_object_id_type>(object.id()));
+                    }
+                } else if (remove_non_matches) {
+                    object.set_removed(true);
+                }
+            }
+
+            return count;
+        }
+
+    } // namespace tags
+
+} // namespace osmium
+
+#endif // OSMIUM_TAGS_FILTER_BUFFER_HPP
@@ -36,6 +36,10 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/tag.hpp>
 #include <osmium/util/string_matcher.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
 #include <type_traits>
 #include <utility>
 
@@ -90,6 +94,24 @@ namespace osmium {
             m_result(!invert) {
         }
 
+        /**
+         * Access the StringMatcher used for matching the key.
+         */
+        const osmium::StringMatcher& key_matcher() const noexcept {
+            return m_key_matcher;
+        }
+
+        /**
+         * Match only the value against the value matcher, ignoring the
+         * key matcher. Used by the osmium::TagsFilterBase when the key
+         * was already checked through its compiled index.
+         *
+         * @returns true if the value matches.
+         */
+        bool match_value(const char* value) const noexcept {
+            return m_value_matcher(value) == m_result;
+        }
+
         /**
          * Match against the specified key and value.
          *
@@ -125,6 +147,153 @@ namespace osmium {
 
     }; // class TagMatcher
 
+    /**
+     * @brief String matchers for StaticTagMatcher, resolved at compile time
+     */
+    namespace static_matcher {
+
+        /// Always matches. The default value matcher of StaticTagMatcher.
+        struct always_true {
+
+            bool operator()(const char* /*test_string*/) const noexcept {
+                return true;
+            }
+
+        }; // struct always_true
+
+        /// Matches if the test string is equal to the stored string.
+        class equal {
+
+            const char* m_str;
+
+        public:
+
+            explicit constexpr equal(const char* str) noexcept :
+                m_str(str) {
+            }
+
+            bool operator()(const char* test_string) const noexcept {
+                return !std::strcmp(m_str, test_string);
+            }
+
+        }; // class equal
+
+        /// Matches if the test string is equal to any of the stored strings.
+        template <std::size_t N>
+        class any_equal {
+
+            std::array<const char*, N> m_strings;
+
+        public:
+
+            explicit any_equal(const char* const (&strings)[N]) noexcept {
+                std::copy_n(strings, N, m_strings.begin());
+            }
+
+            bool operator()(const char* test_string) const noexcept {
+                for (const char* str : m_strings) {
+                    if (!std::strcmp(str, test_string)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+        }; // class any_equal
+
+        /// Create an any_equal matcher, deducing the number of strings.
+        template <std::size_t N>
+        inline any_equal<N> any_of(const char* const (&strings)[N]) noexcept {
+            return any_equal<N>{strings};
+        }
+
+    } // namespace static_matcher
+
+    /**
+     * Like TagMatcher, but with the key and value matchers fixed at
+     * compile time. There is no variant or function dispatch: the
+     * matchers are members of known type and their comparisons can be
+     * inlined into the calling loop. Use this instead of TagMatcher in
+     * hot loops when the filter doesn't have to be configurable at
+     * runtime. Create instances with static_tag_matcher():
+     * @code
+     * const auto matcher = osmium::static_tag_matcher("highway",
+     *     osmium::static_matcher::any_of({"motorway", "trunk"}));
+     * if (matcher(way.tags())) { ... }
+     * @endcode
+     */
+    template <typename TKeyMatcher, typename TValueMatcher = static_matcher::always_true>
+    class StaticTagMatcher {
+
+        TKeyMatcher m_key_matcher;
+        TValueMatcher m_value_matcher;
+
+    public:
+
+        explicit constexpr StaticTagMatcher(TKeyMatcher key_matcher, TValueMatcher value_matcher = TValueMatcher{}) noexcept :
+            m_key_matcher(key_matcher),
+            m_value_matcher(value_matcher) {
+        }
+
+        /**
+         * Match against the specified key and value.
+         *
+         * @returns true if the tag matches.
+         */
+        bool operator()(const char* key, const char* value) const noexcept {
+            return m_key_matcher(key) && m_value_matcher(value);
+        }
+
+        /**
+         * Match against the specified tag.
+         *
+         * @returns true if the tag matches.
+         */
+        bool operator()(const osmium::Tag& tag) const noexcept {
+            return operator()(tag.key(), tag.value());
+        }
+
+        /**
+         * Match against the specified tags.
+         *
+         * @returns true if any of the tags in the TagList matches.
+         */
+        bool operator()(const osmium::TagList& tags) const noexcept {
+            for (const auto& tag : tags) {
+                if (operator()(tag)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    }; // class StaticTagMatcher
+
+    /**
+     * Create a StaticTagMatcher matching all tags with the specified key.
+     */
+    inline constexpr StaticTagMatcher<static_matcher::equal> static_tag_matcher(const char* key) noexcept {
+        return StaticTagMatcher<static_matcher::equal>{static_matcher::equal{key}};
+    }
+
+    /**
+     * Create a StaticTagMatcher matching tags with the specified key
+     * and value.
+     */
+    inline constexpr StaticTagMatcher<static_matcher::equal, static_matcher::equal> static_tag_matcher(const char* key, const char* value) noexcept {
+        return StaticTagMatcher<static_matcher::equal, static_matcher::equal>{static_matcher::equal{key}, static_matcher::equal{value}};
+    }
+
+    /**
+     * Create a StaticTagMatcher matching tags with the specified key
+     * and the specified value matcher, for instance one created with
+     * static_matcher::any_of().
+     */
+    template <typename TValueMatcher>
+    inline StaticTagMatcher<static_matcher::equal, TValueMatcher> static_tag_matcher(const char* key, TValueMatcher value_matcher) noexcept {
+        return StaticTagMatcher<static_matcher::equal, TValueMatcher>{static_matcher::equal{key}, value_matcher};
+    }
+
 } // namespace osmium
 
 #endif // OSMIUM_TAGS_MATCHER_HPP
@@ -38,6 +38,9 @@ DEALINGS IN THE SOFTWARE.
 
 #include <boost/iterator/filter_iterator.hpp>
 
+#include <cstddef>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -68,7 +71,9 @@ namespace osmium {
     class TagsFilterBase {
 
         std::vector<std::pair<TResult, TagMatcher>> m_rules;
+        std::unordered_map<std::string, std::vector<std::size_t>> m_index;
         TResult m_default_result;
+        bool m_compiled = false;
 
     public:
 
@@ -92,6 +97,14 @@ namespace osmium {
             m_default_result = default_result;
         }
 
+        /**
+         * Get the default result, the result the matching function will
+         * return if none of the rules matched.
+         */
+        TResult default_result() const noexcept {
+            return m_default_result;
+        }
+
         /**
          * Add a rule to the filter.
          *
@@ -101,6 +114,8 @@ namespace osmium {
          */
         TagsFilterBase& add_rule(const TResult result, const TagMatcher& matcher) {
             m_rules.emplace_back(result, matcher);
+            m_index.clear();
+            m_compiled = false;
             return *this;
         }
 
@@ -115,9 +130,45 @@ namespace osmium {
         template <typename... TArgs>
         TagsFilterBase& add_rule(const TResult result, TArgs&&... args) {
             m_rules.emplace_back(result, osmium::TagMatcher{std::forward<TArgs>(args)...});
+            m_index.clear();
+            m_compiled = false;
             return *this;
         }
 
+        /**
+         * Compile the rules into a lookup table indexed by the tag key.
+         * With the compiled table the matching functions need only a
+         * single hash probe plus the value checks for the rules with the
+         * matching key, instead of scanning all rules. With filters
+         * containing hundreds of rules this is much faster.
+         *
+         * Compiling is only possible if all rules match their key against
+         * an exact string (as rules created from plain strings do). If
+         * any rule uses a different kind of key matcher (prefix, regex,
+         * ...), the filter is left uncompiled and the matching functions
+         * fall back to scanning the rules in order. Results are the same
+         * either way, including the first-match-wins semantics.
+         *
+         * Adding more rules to the filter invalidates the compiled table,
+         * call compile() again after all rules have been added.
+         *
+         * @returns true if the filter could be compiled.
+         */
+        bool compile() {
+            m_index.clear();
+            m_compiled = false;
+            for (std::size_t i = 0; i < m_rules.size(); ++i) {
+                const std::string* key = m_rules[i].second.key_matcher().equal_string();
+                if (!key) {
+                    m_index.clear();
+                    return false;
+                }
+                m_index[*key].push_back(i);
+            }
+            m_compiled = true;
+            return true;
+        }
+
         /**
          * Matching function. Check the specified tag against the rules.
          *
@@ -126,14 +177,62 @@ namespace osmium {
          *          matched, the default result.
          */
         TResult operator()(const osmium::Tag& tag) const noexcept {
+            return operator()(tag.key(), tag.value());
+        }
+
+        /**
+         * Matching function. Check the tag specified as plain key and
+         * value strings against the rules. Use this when you don't have
+         * an osmium::Tag object, for instance when filtering data while
+         * it is being decoded.
+         *
+         * @param key Tag key.
+         * @param value Tag value.
+         * @returns The result of the matching rule, or, if none of the rules
+         *          matched, the default result.
+         */
+        TResult operator()(const char* key, const char* value) const noexcept {
+            if (m_compiled) {
+                const auto it = m_index.find(key);
+                if (it != m_index.end()) {
+                    for (const auto i : it->second) {
+                        if (m_rules[i].second.match_value(value)) {
+                            return m_rules[i].first;
+                        }
+                    }
+                }
+                return m_default_result;
+            }
             for (const auto& rule : m_rules) {
-                if (rule.second(tag)) {
+                if (rule.second(key, value)) {
                     return rule.first;
                 }
             }
             return m_default_result;
         }
 
+        /**
+         * Check whether any of the rules could match a tag with the
+         * specified key, whatever its value. Useful as a cheap
+         * pre-filter: if this returns false, the matching functions will
+         * return the default result for every tag with this key. With a
+         * compiled filter this is a single hash probe.
+         *
+         * @param key Tag key.
+         * @returns true if the key matcher of any rule matches the key.
+         */
+        bool matches_key(const char* key) const noexcept {
+            if (m_compiled) {
+                return m_index.count(key) != 0;
+            }
+            for (const auto& rule : m_rules) {
+                if (rule.second.key_matcher()(key)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
         /**
          * Return the number of rules in this filter.
          *
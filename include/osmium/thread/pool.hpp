@@ -34,12 +34,22 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/thread/function_wrapper.hpp>
-#include <osmium/thread/queue.hpp>
 #include <osmium/thread/util.hpp>
-#include <osmium/util/config.hpp>
-
+#include <osmium/util/probes.hpp>
+#include <osmium/util/tuning.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdlib>
+#include <deque>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
 #include <type_traits>
 #include <utility>
@@ -79,13 +89,98 @@ namespace osmium {
             }
 
             inline std::size_t get_work_queue_size() noexcept {
-                return osmium::config::get_max_queue_size("WORK", 10);
+                return osmium::config::tuning().work_queue_size;
+            }
+
+            /**
+             * Parse a CPU list in the usual taskset format, for
+             * instance "0,2,4-7". Parsing stops at the first character
+             * that doesn't fit, an unparseable list comes back empty.
+             */
+            inline std::vector<int> parse_cpu_list(const std::string& list) {
+                std::vector<int> cpus;
+
+                const char* str = list.c_str();
+                while (*str) {
+                    char* end = nullptr;
+                    const long first = std::strtol(str, &end, 10); // NOLINT(google-runtime-int)
+                    if (end == str || first < 0) {
+                        return {};
+                    }
+                    long last = first; // NOLINT(google-runtime-int)
+                    str = end;
+                    if (*str == '-') {
+                        last = std::strtol(str + 1, &end, 10);
+                        if (end == str + 1 || last < first) {
+                            return {};
+                        }
+                        str = end;
+                    }
+                    for (long cpu = first; cpu <= last; ++cpu) { // NOLINT(google-runtime-int)
+                        cpus.push_back(static_cast<int>(cpu));
+                    }
+                    if (*str == ',') {
+                        ++str;
+                    } else if (*str) {
+                        return {};
+                    }
+                }
+
+                return cpus;
+            }
+
+            /**
+             * Turn an affinity policy into one CPU per worker thread.
+             * Returns an empty vector if the workers are not pinned,
+             * otherwise a vector with num_threads entries, one CPU
+             * number for each worker.
+             */
+            inline std::vector<int> affinity_cpus(const std::string& policy, int num_threads, unsigned hardware_concurrency) {
+                std::vector<int> cpus;
+
+                if (policy.empty() || policy == "none" || hardware_concurrency == 0) {
+                    return cpus;
+                }
+
+                const auto num_cpus = static_cast<int>(hardware_concurrency);
+
+                if (policy == "compact") {
+                    for (int i = 0; i < num_threads; ++i) {
+                        cpus.push_back(i % num_cpus);
+                    }
+                    return cpus;
+                }
+
+                if (policy == "scatter") {
+                    int stride = num_threads > 0 ? num_cpus / num_threads : 1;
+                    if (stride < 1) {
+                        stride = 1;
+                    }
+                    for (int i = 0; i < num_threads; ++i) {
+                        cpus.push_back((i * stride) % num_cpus);
+                    }
+                    return cpus;
+                }
+
+                const auto list = parse_cpu_list(policy);
+                if (!list.empty()) {
+                    for (int i = 0; i < num_threads; ++i) {
+                        cpus.push_back(list[static_cast<std::size_t>(i) % list.size()]);
+                    }
+                }
+
+                return cpus;
             }
 
         } // namespace detail
 
         /**
          *  Thread pool.
+         *
+         *  Tasks are distributed round-robin over one deque per worker
+         *  thread and idle workers steal tasks from the other deques.
+         *  With many threads and small tasks this avoids the convoy on
+         *  the single lock a central work queue would have.
          */
         class Pool {
 
@@ -119,21 +214,194 @@ namespace osmium {
 
             }; // class thread_joiner
 
-            osmium::thread::Queue<function_wrapper> m_work_queue;
+            // The task deques of a single worker. A worker takes tasks
+            // from the front of its own deques, idle workers steal from
+            // the back of the deques of other workers. Every queue has
+            // its own mutex, so busy workers don't contend on a single
+            // central lock. High-priority tasks have their own lane
+            // that is always served first, so a burst of normal tasks
+            // can not starve them.
+            struct worker_queue {
+                std::mutex mutex;
+                std::deque<function_wrapper> tasks;
+                std::deque<function_wrapper> high_tasks;
+            };
+
+            static bool pop_front_task(worker_queue& queue, function_wrapper& task) {
+                // The mutex of the queue must be locked by the caller.
+                auto& deque = queue.high_tasks.empty() ? queue.tasks : queue.high_tasks;
+                if (deque.empty()) {
+                    return false;
+                }
+                task = std::move(deque.front());
+                deque.pop_front();
+                return true;
+            }
+
+            static bool pop_back_task(worker_queue& queue, function_wrapper& task) {
+                // The mutex of the queue must be locked by the caller.
+                auto& deque = queue.high_tasks.empty() ? queue.tasks : queue.high_tasks;
+                if (deque.empty()) {
+                    return false;
+                }
+                task = std::move(deque.back());
+                deque.pop_back();
+                return true;
+            }
+
+        public:
+
+            /**
+             * Priority class of a submitted task. Tasks of priority
+             * "high" are always run before queued tasks of priority
+             * "normal". Use "high" for tasks on the output side of a
+             * pipeline, so bursts of input-side tasks can not starve
+             * them into stalling the pipeline through back-pressure.
+             */
+            enum class priority {
+                normal,
+                high
+            };
+
+            /**
+             * Snapshot of the metrics of a Pool, taken with the
+             * metrics() member function.
+             */
+            struct pool_metrics {
+
+                /// The number of tasks the workers have run.
+                std::uint64_t tasks_run = 0;
+
+                /**
+                 * Histogram of task run times: bucket i counts the
+                 * tasks that ran for at least 2^i and less than
+                 * 2^(i+1) microseconds, the last bucket counts all
+                 * longer tasks.
+                 */
+                std::array<std::uint64_t, 16> task_run_time{{}};
+
+                /// The number of tasks waiting in the worker deques.
+                std::size_t pending_tasks = 0;
+
+            }; // struct pool_metrics
+
+        private:
+
+            std::size_t m_max_queue_size;
+            std::vector<std::unique_ptr<worker_queue>> m_queues{};
+
+            /// The number of tasks sitting in all the worker deques.
+            std::atomic<std::size_t> m_pending{0};
+
+            /// Used to distribute submitted tasks round-robin.
+            std::atomic<std::size_t> m_next_queue{0};
+
+            // Only used for sleeping and waking up threads, never held
+            // while working on the deques.
+            std::mutex m_wakeup_mutex;
+            std::condition_variable m_task_available;
+            std::condition_variable m_space_available;
+
+            /// The number of tasks the workers have run.
+            std::atomic<std::uint64_t> m_tasks_run{0};
+
+            /// Histogram of task run times, see pool_metrics.
+            std::array<std::atomic<std::uint64_t>, 16> m_task_run_time{{}};
+
             std::vector<std::thread> m_threads{};
             thread_joiner m_joiner;
             int m_num_threads;
 
-            void worker_thread() {
+            void record_task_run_time(const std::chrono::steady_clock::duration duration) noexcept {
+                auto usec = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+                std::size_t bucket = 0;
+                while (usec > 1 && bucket < m_task_run_time.size() - 1) {
+                    usec >>= 1;
+                    ++bucket;
+                }
+                ++m_task_run_time[bucket];
+                ++m_tasks_run;
+            }
+
+            void push_task(function_wrapper&& task, const priority task_priority = priority::normal) {
+                constexpr const std::chrono::milliseconds max_wait{10};
+                if (m_max_queue_size) {
+                    while (m_pending >= m_max_queue_size) {
+                        std::unique_lock<std::mutex> lock{m_wakeup_mutex};
+                        m_space_available.wait_for(lock, max_wait, [this] {
+                            return m_pending < m_max_queue_size;
+                        });
+                    }
+                }
+
+                auto& queue = *m_queues[m_next_queue++ % m_queues.size()];
+                {
+                    std::lock_guard<std::mutex> lock{queue.mutex};
+                    if (task_priority == priority::high) {
+                        queue.high_tasks.push_back(std::move(task));
+                    } else {
+                        queue.tasks.push_back(std::move(task));
+                    }
+                }
+                ++m_pending;
+
+                {
+                    // Taking the lock (without doing anything under it)
+                    // makes sure the notification can not fall between
+                    // predicate check and sleep of a worker.
+                    std::lock_guard<std::mutex> lock{m_wakeup_mutex};
+                }
+                m_task_available.notify_one();
+            }
+
+            bool pop_or_steal_task(const std::size_t index, function_wrapper& task) {
+                const std::size_t num_queues = m_queues.size();
+
+                {
+                    auto& queue = *m_queues[index];
+                    std::lock_guard<std::mutex> lock{queue.mutex};
+                    if (pop_front_task(queue, task)) {
+                        --m_pending;
+                        return true;
+                    }
+                }
+
+                for (std::size_t n = 1; n < num_queues; ++n) {
+                    auto& queue = *m_queues[(index + n) % num_queues];
+                    std::lock_guard<std::mutex> lock{queue.mutex};
+                    if (pop_back_task(queue, task)) {
+                        --m_pending;
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            void worker_thread(const std::size_t index) {
                 osmium::thread::set_thread_name("_osmium_worker");
+                constexpr const std::chrono::milliseconds max_wait{10};
                 while (true) {
                     function_wrapper task;
-                    m_work_queue.wait_and_pop(task);
+                    if (!pop_or_steal_task(index, task)) {
+                        std::unique_lock<std::mutex> lock{m_wakeup_mutex};
+                        m_task_available.wait_for(lock, max_wait, [this] {
+                            return m_pending > 0;
+                        });
+                        continue;
+                    }
+                    if (m_max_queue_size) {
+                        m_space_available.notify_one();
+                    }
+                    const auto start = std::chrono::steady_clock::now();
+                    OSMIUM_PROBE1(pool_task_begin, index);
                     if (task && task()) {
                         // The called tasks returns true only when the
                         // worker thread should shut down.
                         return;
                     }
+                    OSMIUM_PROBE1(pool_task_end, index);
+                    record_task_run_time(std::chrono::steady_clock::now() - start);
                 }
             }
 
@@ -161,15 +429,47 @@ namespace osmium {
              *
              * If max_queue_size is 0, the queue size is read from
              * the environment variable OSMIUM_MAX_WORK_QUEUE_SIZE.
+             *
+             * The affinity policy decides which CPUs the worker
+             * threads are pinned to (only on Linux, on other systems
+             * the workers are never pinned):
+             *
+             * - "none": Workers are not pinned and can migrate freely.
+             * - "compact": Worker i is pinned to CPU i, filling up the
+             *   CPUs of one socket before using the next one.
+             * - "scatter": Workers are spread out evenly over all
+             *   CPUs, on a multi-socket system this distributes them
+             *   over the sockets.
+             * - A CPU list in the usual taskset format, for instance
+             *   "0,2,4-7": Workers are pinned round-robin to exactly
+             *   those CPUs. Use this to keep the workers on one NUMA
+             *   node and away from the CPUs of reader and writer
+             *   threads.
+             *
+             * If the policy is empty, it is read from the environment
+             * variable OSMIUM_POOL_AFFINITY.
              */
-            explicit Pool(int num_threads = default_num_threads, std::size_t max_queue_size = default_queue_size) :
-                m_work_queue(max_queue_size > 0 ? max_queue_size : detail::get_work_queue_size(), "work"),
+            explicit Pool(int num_threads = default_num_threads, std::size_t max_queue_size = default_queue_size, const std::string& affinity = "") :
+                m_max_queue_size(max_queue_size > 0 ? max_queue_size : detail::get_work_queue_size()),
                 m_joiner(m_threads),
-                m_num_threads(detail::get_pool_size(num_threads, osmium::config::get_pool_threads(), std::thread::hardware_concurrency())) {
+                m_num_threads(detail::get_pool_size(num_threads, osmium::config::tuning().pool_threads, std::thread::hardware_concurrency())) {
+
+                m_queues.reserve(static_cast<std::size_t>(m_num_threads));
+                for (int i = 0; i < m_num_threads; ++i) {
+                    m_queues.emplace_back(new worker_queue{});
+                }
 
                 try {
                     for (int i = 0; i < m_num_threads; ++i) {
-                        m_threads.emplace_back(&Pool::worker_thread, this);
+                        m_threads.emplace_back(&Pool::worker_thread, this, static_cast<std::size_t>(i));
+                    }
+
+                    const auto cpus = detail::affinity_cpus(affinity.empty() ? osmium::config::tuning().pool_affinity : affinity,
+                                                            m_num_threads, std::thread::hardware_concurrency());
+                    if (!cpus.empty()) {
+                        for (int i = 0; i < m_num_threads; ++i) {
+                            set_thread_affinity(m_threads[static_cast<std::size_t>(i)], {cpus[static_cast<std::size_t>(i)]});
+                        }
                     }
                 } catch (...) {
                     shutdown_all_workers();
@@ -185,7 +485,7 @@ namespace osmium {
             void shutdown_all_workers() {
                 for (int i = 0; i < m_num_threads; ++i) {
                     // The special function wrapper makes a worker shut down.
-                    m_work_queue.push(function_wrapper{0});
+                    push_task(function_wrapper{0});
                 }
             }
 
@@ -203,25 +503,168 @@ namespace osmium {
                 return m_num_threads;
             }
 
+            /**
+             * Restrict all worker threads to the given CPUs. Use this to
+             * keep the workers on the NUMA node of the thread consuming
+             * their results, avoiding cross-socket traffic on multi-socket
+             * machines. This only works on Linux, on other systems it does
+             * nothing.
+             *
+             * @param cpus The CPU numbers the workers may run on.
+             * @returns True if the affinity was set for all workers.
+             */
+            bool set_affinity(const std::vector<int>& cpus) noexcept {
+                bool okay = true;
+                for (auto& thread : m_threads) {
+                    okay = set_thread_affinity(thread, cpus) && okay;
+                }
+                return okay;
+            }
+
             std::size_t queue_size() const {
-                return m_work_queue.size();
+                return m_pending;
+            }
+
+            /**
+             * Get a snapshot of the metrics of this pool. Can be
+             * called at any time from any thread, the counters are
+             * cheap enough to be always on.
+             */
+            pool_metrics metrics() const {
+                pool_metrics result;
+                result.tasks_run = m_tasks_run;
+                for (std::size_t i = 0; i < m_task_run_time.size(); ++i) {
+                    result.task_run_time[i] = m_task_run_time[i];
+                }
+                result.pending_tasks = m_pending;
+                return result;
             }
 
             bool queue_empty() const {
-                return m_work_queue.empty();
+                return m_pending == 0;
             }
 
+            /**
+             * Submit a task to the pool. Queued tasks of priority
+             * "high" always run before queued tasks of priority
+             * "normal".
+             */
             template <typename TFunction>
-            std::future<typename std::result_of<TFunction()>::type> submit(TFunction&& func) {
+            std::future<typename std::result_of<TFunction()>::type> submit(const priority task_priority, TFunction&& func) {
                 using result_type = typename std::result_of<TFunction()>::type;
 
                 std::packaged_task<result_type()> task{std::forward<TFunction>(func)};
                 std::future<result_type> future_result{task.get_future()};
-                m_work_queue.push(std::move(task));
+                push_task(std::move(task), task_priority);
 
                 return future_result;
             }
 
+            /// Submit a task of normal priority to the pool.
+            template <typename TFunction>
+            std::future<typename std::result_of<TFunction()>::type> submit(TFunction&& func) {
+                return submit(priority::normal, std::forward<TFunction>(func));
+            }
+
+            /**
+             * A handle for submitting tasks to a pool with a limit on
+             * how many tasks submitted through this handle may be
+             * outstanding (queued or running) at any time. When the
+             * limit is reached, submit() blocks until one of the tasks
+             * is done.
+             *
+             * Use one Quota per client when many clients share one
+             * pool, so a single client with a lot of work can not
+             * monopolize the pool and starve the others.
+             */
+            class Quota {
+
+                struct counter_type {
+                    std::atomic<std::size_t> outstanding{0};
+                    std::mutex mutex;
+                    std::condition_variable task_done;
+                };
+
+                template <typename TFunction>
+                struct quota_task {
+
+                    std::shared_ptr<counter_type> counter;
+                    TFunction func;
+
+                    typename std::result_of<TFunction()>::type operator()() {
+                        struct decrement_guard {
+                            counter_type& counter;
+                            ~decrement_guard() {
+                                --counter.outstanding;
+                                {
+                                    // Taking the lock (without doing
+                                    // anything under it) makes sure the
+                                    // notification can not fall between
+                                    // predicate check and sleep of a
+                                    // waiting submitter.
+                                    std::lock_guard<std::mutex> lock{counter.mutex};
+                                }
+                                counter.task_done.notify_one();
+                            }
+                        } guard{*counter};
+                        return func();
+                    }
+
+                }; // struct quota_task
+
+                Pool* m_pool;
+                std::shared_ptr<counter_type> m_counter;
+                std::size_t m_max_tasks;
+
+            public:
+
+                /**
+                 * Create a quota handle for the given pool.
+                 *
+                 * @param pool The pool tasks are submitted to.
+                 * @param max_tasks Maximum number of outstanding tasks
+                 *        submitted through this handle. Set to 0 for
+                 *        no limit.
+                 */
+                explicit Quota(Pool& pool, std::size_t max_tasks = 0) :
+                    m_pool(&pool),
+                    m_counter(std::make_shared<counter_type>()),
+                    m_max_tasks(max_tasks) {
+                }
+
+                /// The number of outstanding tasks of this handle.
+                std::size_t outstanding() const noexcept {
+                    return m_counter->outstanding;
+                }
+
+                /**
+                 * Submit a task to the pool like Pool::submit(), but
+                 * block while the maximum number of tasks submitted
+                 * through this handle are still outstanding.
+                 */
+                template <typename TFunction>
+                std::future<typename std::result_of<TFunction()>::type> submit(const priority task_priority, TFunction&& func) {
+                    constexpr const std::chrono::milliseconds max_wait{10};
+                    if (m_max_tasks) {
+                        std::unique_lock<std::mutex> lock{m_counter->mutex};
+                        while (m_counter->outstanding >= m_max_tasks) {
+                            m_counter->task_done.wait_for(lock, max_wait);
+                        }
+                    }
+                    ++m_counter->outstanding;
+
+                    using functor_type = typename std::decay<TFunction>::type;
+                    return m_pool->submit(task_priority, quota_task<functor_type>{m_counter, std::forward<TFunction>(func)});
+                }
+
+                /// Submit a task of normal priority.
+                template <typename TFunction>
+                std::future<typename std::result_of<TFunction()>::type> submit(TFunction&& func) {
+                    return submit(priority::normal, std::forward<TFunction>(func));
+                }
+
+            }; // class Quota
+
         }; // class Pool
 
     } // namespace thread
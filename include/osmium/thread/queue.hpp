@@ -33,16 +33,20 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/util/profiling.hpp>
+
+#include <atomic>
+#include <cassert>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <mutex>
 #include <queue>
 #include <string>
 #include <utility> // IWYU pragma: keep
 
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
-# include <atomic>
 # include <iostream>
 #endif
 
@@ -50,6 +54,38 @@ namespace osmium {
 
     namespace thread {
 
+        /**
+         * Snapshot of the counters of a thread-safe queue, taken with
+         * the counters() member function of the queue. Use this to
+         * find out where a pipeline stalls: a large "full" count means
+         * the consumer side of this queue is the bottleneck, a large
+         * "empty" count means the producer side is.
+         */
+        struct queue_counters {
+
+            /// The number of times push() was called on the queue.
+            std::uint64_t push = 0;
+
+            /// The number of times the queue was full and a thread
+            /// pushing to the queue was blocked.
+            std::uint64_t full = 0;
+
+            /// The number of times wait_and_pop() or try_pop() was
+            /// called on the queue.
+            std::uint64_t pop = 0;
+
+            /// The number of times the queue was empty and a thread
+            /// popping from the queue didn't get data immediately.
+            std::uint64_t empty = 0;
+
+            /// The largest size the queue has had so far.
+            std::size_t largest_size = 0;
+
+            /// The size of the queue when the snapshot was taken.
+            std::size_t size = 0;
+
+        }; // struct queue_counters
+
         /**
          *  A thread-safe queue.
          */
@@ -57,8 +93,53 @@ namespace osmium {
         class Queue {
 
             /// Maximum size of this queue. If the queue is full pushing to
-            /// the queue will block.
-            const std::size_t m_max_size;
+            /// the queue will block. Can change while the queue is in
+            /// use when adaptive sizing is enabled.
+            std::atomic<std::size_t> m_max_size;
+
+            /// Lower and upper bound for m_max_size when adaptive
+            /// sizing is enabled, both 0 otherwise.
+            std::size_t m_adaptive_min_size{0};
+            std::size_t m_adaptive_max_size{0};
+
+            /// State of the adaptive controller, only accessed under
+            /// m_mutex.
+            std::uint64_t m_adjust_after_push{0};
+            std::uint64_t m_last_full_count{0};
+            std::uint64_t m_last_empty_count{0};
+
+            /// The number of pushes between two looks at the stall
+            /// counters of the adaptive controller.
+            enum : std::uint64_t {
+                adjust_interval = 64
+            };
+
+            // Adapt the effective queue limit based on the stall
+            // counters since the last adjustment. Both kinds of stalls
+            // mean producer and consumer run at different speeds in
+            // bursts and a larger queue can smooth that out. Only full
+            // stalls mean the consumer is steadily the bottleneck and
+            // more queue would just buffer more memory without helping
+            // throughput, so fall back towards the minimum.
+            // Must be called with m_mutex locked.
+            void adjust_max_size() {
+                const std::uint64_t full_delta = m_full_counter - m_last_full_count;
+                const std::uint64_t empty_delta = m_empty_counter - m_last_empty_count;
+
+                if (full_delta > 0) {
+                    if (empty_delta > 0) {
+                        const std::size_t new_size = m_max_size * 2;
+                        m_max_size = new_size < m_adaptive_max_size ? new_size : m_adaptive_max_size;
+                    } else {
+                        const std::size_t new_size = m_max_size / 2;
+                        m_max_size = new_size > m_adaptive_min_size ? new_size : m_adaptive_min_size;
+                    }
+                }
+
+                m_last_full_count = m_full_counter;
+                m_last_empty_count = m_empty_counter;
+                m_adjust_after_push = m_push_counter + adjust_interval;
+            }
 
             /// Name of this queue (for debugging only).
             const std::string m_name;
@@ -73,27 +154,25 @@ namespace osmium {
             /// Used to signal producers when queue is not full.
             std::condition_variable m_space_available;
 
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
             /// The largest size the queue has been so far.
-            std::size_t m_largest_size;
+            std::size_t m_largest_size{0};
 
             /// The number of times push() was called on the queue.
-            std::atomic<int> m_push_counter;
+            std::atomic<std::uint64_t> m_push_counter{0};
 
             /// The number of times the queue was full and a thread pushing
             /// to the queue was blocked.
-            std::atomic<int> m_full_counter;
+            std::atomic<std::uint64_t> m_full_counter{0};
 
             /**
-             * The number of times wait_and_pop(with_timeout)() was called
+             * The number of times wait_and_pop() or try_pop() was called
              * on the queue.
              */
-            std::atomic<int> m_pop_counter;
+            std::atomic<std::uint64_t> m_pop_counter{0};
 
-            /// The number of times the queue was full and a thread pushing
-            /// to the queue was blocked.
-            std::atomic<int> m_empty_counter;
-#endif
+            /// The number of times the queue was empty and a thread popping
+            /// from the queue didn't get data immediately.
+            std::atomic<std::uint64_t> m_empty_counter{0};
 
         public:
 
@@ -107,16 +186,7 @@ namespace osmium {
             explicit Queue(std::size_t max_size = 0, std::string name = "") :
                 m_max_size(max_size),
                 m_name(std::move(name)),
-                m_queue()
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
-                ,
-                m_largest_size(0),
-                m_push_counter(0),
-                m_full_counter(0),
-                m_pop_counter(0),
-                m_empty_counter(0)
-#endif
-            {
+                m_queue() {
             }
 
             Queue(const Queue&) = delete;
@@ -146,40 +216,35 @@ namespace osmium {
              */
             void push(T value) {
                 constexpr const std::chrono::milliseconds max_wait{10};
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
                 ++m_push_counter;
-#endif
                 if (m_max_size) {
                     while (size() >= m_max_size) {
                         std::unique_lock<std::mutex> lock{m_mutex};
                         m_space_available.wait_for(lock, max_wait, [this] {
                             return m_queue.size() < m_max_size;
                         });
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
                         ++m_full_counter;
-#endif
+                        OSMIUM_PROFILE_COUNT(queue_full_stalls);
                     }
                 }
                 std::lock_guard<std::mutex> lock{m_mutex};
                 m_queue.push(std::move(value));
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
                 if (m_largest_size < m_queue.size()) {
                     m_largest_size = m_queue.size();
                 }
-#endif
+                if (m_adaptive_max_size && m_push_counter >= m_adjust_after_push) {
+                    adjust_max_size();
+                }
                 m_data_available.notify_one();
             }
 
             void wait_and_pop(T& value) {
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
                 ++m_pop_counter;
-#endif
                 std::unique_lock<std::mutex> lock{m_mutex};
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
                 if (m_queue.empty()) {
                     ++m_empty_counter;
+                    OSMIUM_PROFILE_COUNT(queue_empty_stalls);
                 }
-#endif
                 m_data_available.wait(lock, [this] {
                     return !m_queue.empty();
                 });
@@ -194,15 +259,12 @@ namespace osmium {
             }
 
             bool try_pop(T& value) {
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
                 ++m_pop_counter;
-#endif
                 {
                     std::lock_guard<std::mutex> lock{m_mutex};
                     if (m_queue.empty()) {
-#ifdef OSMIUM_DEBUG_QUEUE_SIZE
                         ++m_empty_counter;
-#endif
+                        OSMIUM_PROFILE_COUNT(queue_empty_stalls);
                         return false;
                     }
                     value = std::move(m_queue.front());
@@ -224,6 +286,58 @@ namespace osmium {
                 return m_queue.size();
             }
 
+            /**
+             * Enable adaptive sizing of this queue: the effective
+             * maximum size starts at the max_size given to the
+             * constructor and is, based on the observed stalls, grown
+             * when producer and consumer speeds oscillate and shrunk
+             * back when the consumer is steadily the bottleneck and
+             * a larger queue would only buffer more memory. Can be
+             * called while the queue is already in use.
+             *
+             * @param min_size The limit never falls below this.
+             * @param max_size The limit never grows beyond this.
+             *
+             * @pre The queue must be bounded and
+             *      @code min_size >= 2 && min_size <= max_size @endcode.
+             */
+            void set_adaptive_size(const std::size_t min_size, const std::size_t max_size) {
+                assert(m_max_size > 0 && min_size >= 2 && min_size <= max_size);
+                std::lock_guard<std::mutex> lock{m_mutex};
+                m_adaptive_min_size = min_size;
+                m_adaptive_max_size = max_size;
+                if (m_max_size < min_size) {
+                    m_max_size = min_size;
+                } else if (m_max_size > max_size) {
+                    m_max_size = max_size;
+                }
+                m_adjust_after_push = m_push_counter + adjust_interval;
+                m_last_full_count = m_full_counter;
+                m_last_empty_count = m_empty_counter;
+            }
+
+            /// The current effective maximum size of the queue.
+            std::size_t max_size() const noexcept {
+                return m_max_size;
+            }
+
+            /**
+             * Get a snapshot of the counters of this queue. Can be
+             * called at any time from any thread, the counters are
+             * cheap enough to be always on.
+             */
+            queue_counters counters() const {
+                queue_counters result;
+                result.push = m_push_counter;
+                result.full = m_full_counter;
+                result.pop = m_pop_counter;
+                result.empty = m_empty_counter;
+                std::lock_guard<std::mutex> lock{m_mutex};
+                result.largest_size = m_largest_size;
+                result.size = m_queue.size();
+                return result;
+            }
+
         }; // class Queue
 
     } // namespace thread
@@ -0,0 +1,345 @@
+#ifndef OSMIUM_THREAD_RING_QUEUE_HPP
+#define OSMIUM_THREAD_RING_QUEUE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/thread/queue.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility> // IWYU pragma: keep
+
+#ifdef OSMIUM_DEBUG_QUEUE_SIZE
+# include <iostream>
+#endif
+
+namespace osmium {
+
+    namespace thread {
+
+        /**
+         * A bounded thread-safe queue implemented as a lock-free ring
+         * buffer (in the style of Dmitry Vyukov's bounded MPMC queue).
+         * Unlike osmium::thread::Queue, push and pop on the fast path
+         * touch no mutex at all: every slot of the ring carries a
+         * sequence counter that tells producers and consumers whether
+         * the slot is theirs. Threads only fall back to a mutex and
+         * condition variable when the queue is completely full or
+         * completely empty and they have to block.
+         *
+         * The interface is the same as that of osmium::thread::Queue,
+         * so the two can be used interchangeably. Differences:
+         *
+         * - The queue is always bounded. The capacity is the max_size
+         *   given to the constructor rounded up to the next power of
+         *   two (an unlimited size of 0 gets a large default).
+         * - size() and empty() are approximations while other threads
+         *   are pushing or popping.
+         *
+         * The element type T must be default constructible and movable.
+         */
+        template <typename T>
+        class RingQueue {
+
+            struct slot {
+                std::atomic<std::size_t> sequence;
+                T data;
+            };
+
+            enum : std::size_t {
+                default_capacity = 1024
+            };
+
+            static std::size_t round_up_to_power_of_two(std::size_t value) noexcept {
+                std::size_t result = 2;
+                while (result < value) {
+                    result *= 2;
+                }
+                return result;
+            }
+
+            /// Capacity of the ring. Always a power of two.
+            const std::size_t m_capacity;
+
+            /// Used for indexing into the ring with bitwise AND.
+            const std::size_t m_mask;
+
+            /// Name of this queue (for debugging only).
+            const std::string m_name;
+
+            const std::unique_ptr<slot[]> m_slots;
+
+            std::atomic<std::size_t> m_enqueue_pos{0};
+            std::atomic<std::size_t> m_dequeue_pos{0};
+
+            /// The number of threads blocked in push() resp. pop().
+            std::atomic<int> m_waiting_producers{0};
+            std::atomic<int> m_waiting_consumers{0};
+
+            // Only used for blocking and waking up threads when the
+            // ring is full or empty, never held on the fast path.
+            std::mutex m_wait_mutex;
+            std::condition_variable m_data_available;
+            std::condition_variable m_space_available;
+
+            /// The number of times push() was called on the queue.
+            std::atomic<std::uint64_t> m_push_counter{0};
+
+            /// The number of times the queue was full and a thread pushing
+            /// to the queue was blocked.
+            std::atomic<std::uint64_t> m_full_counter{0};
+
+            /**
+             * The number of times wait_and_pop() or try_pop() was called
+             * on the queue.
+             */
+            std::atomic<std::uint64_t> m_pop_counter{0};
+
+            /// The number of times the queue was empty and a thread popping
+            /// from the queue didn't get data.
+            std::atomic<std::uint64_t> m_empty_counter{0};
+
+            /// The largest size the queue has had so far (approximate).
+            std::atomic<std::size_t> m_largest_size{0};
+
+            bool try_push_internal(T& value) {
+                std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                while (true) {
+                    slot& s = m_slots[pos & m_mask];
+                    const std::size_t sequence = s.sequence.load(std::memory_order_acquire);
+                    const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+                    if (diff == 0) {
+                        if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            s.data = std::move(value);
+                            s.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    } else if (diff < 0) {
+                        // The consumer for this slot one lap behind us
+                        // hasn't taken its element out yet: full.
+                        return false;
+                    } else {
+                        pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            bool try_pop_internal(T& value) {
+                std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                while (true) {
+                    slot& s = m_slots[pos & m_mask];
+                    const std::size_t sequence = s.sequence.load(std::memory_order_acquire);
+                    const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1);
+                    if (diff == 0) {
+                        if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            value = std::move(s.data);
+                            s.sequence.store(pos + m_capacity, std::memory_order_release);
+                            return true;
+                        }
+                    } else if (diff < 0) {
+                        // The producer for this slot hasn't published
+                        // its element yet: empty.
+                        return false;
+                    } else {
+                        pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            void notify_data_available() {
+                if (m_waiting_consumers.load() > 0) {
+                    {
+                        // Taking the lock (without doing anything under
+                        // it) makes sure the notification can not fall
+                        // between predicate check and sleep of a waiter.
+                        std::lock_guard<std::mutex> lock{m_wait_mutex};
+                    }
+                    m_data_available.notify_one();
+                }
+            }
+
+            void notify_space_available() {
+                if (m_waiting_producers.load() > 0) {
+                    {
+                        std::lock_guard<std::mutex> lock{m_wait_mutex};
+                    }
+                    m_space_available.notify_one();
+                }
+            }
+
+        public:
+
+            /**
+             * Construct a bounded multithreaded queue.
+             *
+             * @param max_size Maximum number of elements in the queue,
+             *                 rounded up to the next power of two. Set
+             *                 to 0 for a large default capacity.
+             * @param name Optional name for this queue. (Used for debugging.)
+             */
+            explicit RingQueue(std::size_t max_size = 0, std::string name = "") :
+                m_capacity(round_up_to_power_of_two(max_size > 0 ? max_size : default_capacity)),
+                m_mask(m_capacity - 1),
+                m_name(std::move(name)),
+                m_slots(new slot[m_capacity]) {
+                for (std::size_t i = 0; i < m_capacity; ++i) {
+                    m_slots[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            RingQueue(const RingQueue&) = delete;
+            RingQueue& operator=(const RingQueue&) = delete;
+
+            RingQueue(RingQueue&&) = delete;
+            RingQueue& operator=(RingQueue&&) = delete;
+
+#ifdef OSMIUM_DEBUG_QUEUE_SIZE
+            ~RingQueue() {
+                std::cerr << "ring queue '" << m_name
+                          << "' with capacity=" << m_capacity
+                          << " was full " << m_full_counter
+                          << " times in " << m_push_counter
+                          << " push() calls and was empty " << m_empty_counter
+                          << " times in " << m_pop_counter
+                          << " pop() calls\n";
+            }
+#else
+            ~RingQueue() = default;
+#endif
+
+            /**
+             * Push an element onto the queue. This call will block if
+             * the queue is full.
+             */
+            void push(T value) {
+                constexpr const std::chrono::milliseconds max_wait{1};
+                ++m_push_counter;
+                if (!try_push_internal(value)) {
+                    ++m_full_counter;
+                    std::unique_lock<std::mutex> lock{m_wait_mutex};
+                    ++m_waiting_producers;
+                    while (!try_push_internal(value)) {
+                        // The timeout is only a safety net, normally a
+                        // consumer will notify us as soon as there is
+                        // space in the ring.
+                        m_space_available.wait_for(lock, max_wait);
+                    }
+                    --m_waiting_producers;
+                }
+                const std::size_t current_size = size();
+                std::size_t largest = m_largest_size.load();
+                while (current_size > largest && !m_largest_size.compare_exchange_weak(largest, current_size)) {
+                }
+                notify_data_available();
+            }
+
+            void wait_and_pop(T& value) {
+                ++m_pop_counter;
+                constexpr const std::chrono::milliseconds max_wait{1};
+                if (!try_pop_internal(value)) {
+                    ++m_empty_counter;
+                    std::unique_lock<std::mutex> lock{m_wait_mutex};
+                    ++m_waiting_consumers;
+                    while (!try_pop_internal(value)) {
+                        m_data_available.wait_for(lock, max_wait);
+                    }
+                    --m_waiting_consumers;
+                }
+                notify_space_available();
+            }
+
+            bool try_pop(T& value) {
+                ++m_pop_counter;
+                if (!try_pop_internal(value)) {
+                    ++m_empty_counter;
+                    return false;
+                }
+                notify_space_available();
+                return true;
+            }
+
+            bool empty() const {
+                return size() == 0;
+            }
+
+            std::size_t size() const {
+                const std::size_t dequeue_pos = m_dequeue_pos.load();
+                const std::size_t enqueue_pos = m_enqueue_pos.load();
+                return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+            }
+
+            /**
+             * Adaptive sizing as offered by osmium::thread::Queue is
+             * not available for this queue, because the capacity of
+             * the ring is fixed at construction time. This function
+             * does nothing, it only exists so code can switch between
+             * the two queue types without changing call sites.
+             */
+            void set_adaptive_size(std::size_t /*min_size*/, std::size_t /*max_size*/) noexcept {
+            }
+
+            /// The capacity of the ring. Never changes.
+            std::size_t max_size() const noexcept {
+                return m_capacity;
+            }
+
+            /**
+             * Get a snapshot of the counters of this queue. Can be
+             * called at any time from any thread, the counters are
+             * cheap enough to be always on.
+             */
+            queue_counters counters() const {
+                queue_counters result;
+                result.push = m_push_counter;
+                result.full = m_full_counter;
+                result.pop = m_pop_counter;
+                result.empty = m_empty_counter;
+                result.largest_size = m_largest_size;
+                result.size = size();
+                return result;
+            }
+
+        }; // class RingQueue
+
+    } // namespace thread
+
+} // namespace osmium
+
+#endif // OSMIUM_THREAD_RING_QUEUE_HPP
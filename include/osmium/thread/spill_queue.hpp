@@ -0,0 +1,305 @@
+#ifndef OSMIUM_THREAD_SPILL_QUEUE_HPP
+#define OSMIUM_THREAD_SPILL_QUEUE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/util/file.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <utility>
+
+namespace osmium {
+
+    namespace thread {
+
+        /**
+         * Snapshot of the counters of a SpillQueue, taken with its
+         * counters() member function.
+         */
+        struct spill_queue_counters {
+
+            /// The number of times push() was called on the queue.
+            std::uint64_t push = 0;
+
+            /// The number of times wait_and_pop() or try_pop() was
+            /// called on the queue.
+            std::uint64_t pop = 0;
+
+            /// The number of buffers that went through the spill file
+            /// because the in-memory queue was full.
+            std::uint64_t spilled = 0;
+
+            /// The number of bytes written to the spill file.
+            std::uint64_t spilled_bytes = 0;
+
+            /// The number of buffers currently in the spill file.
+            std::size_t spill_size = 0;
+
+            /// The size of the in-memory queue when the snapshot was taken.
+            std::size_t size = 0;
+
+        }; // struct spill_queue_counters
+
+        /**
+         * A thread-safe queue of osmium::memory::Buffers that spills
+         * to a temporary file instead of blocking the producer when
+         * it is full. Use this between a fast producer (typically a
+         * thread draining an osmium::io::Reader) and a consumer that
+         * stalls now and then (typically a database load): during a
+         * consumer stall the producer keeps running at full speed,
+         * buffers overflow to disk, and when the consumer catches up
+         * the spilled buffers are replayed in order and the queue
+         * returns to pure in-memory operation.
+         *
+         * Buffers are delivered strictly in the order they were
+         * pushed. Once a buffer has been spilled all following ones
+         * are spilled too until the spill file has been drained, so
+         * the order is preserved.
+         *
+         * Unlike osmium::thread::Queue::push() the push() here never
+         * blocks; the spill file grows as needed and the only limit
+         * is the available disk space. Watch the spilled counters if
+         * you need to know how often the overflow is used.
+         */
+        class SpillQueue {
+
+            /// Marks a default-constructed (invalid) buffer in the spill file.
+            enum : std::uint64_t {
+                invalid_buffer_marker = std::numeric_limits<std::uint64_t>::max()
+            };
+
+            mutable std::mutex m_mutex;
+
+            std::queue<osmium::memory::Buffer> m_queue{};
+
+            /// Used to signal consumers when data is available in the queue.
+            std::condition_variable m_data_available;
+
+            /// Maximum size of the in-memory queue.
+            std::size_t m_max_size;
+
+            /// Fd of the spill file, lazily created on the first spill.
+            int m_fd = -1;
+
+            /// Read and write positions in the spill file.
+            std::size_t m_read_offset = 0;
+            std::size_t m_write_offset = 0;
+
+            /// The number of buffers currently in the spill file.
+            std::size_t m_spill_size = 0;
+
+            std::uint64_t m_push_counter = 0;
+            std::uint64_t m_pop_counter = 0;
+            std::uint64_t m_spilled_counter = 0;
+            std::uint64_t m_spilled_bytes = 0;
+
+            /// Append the buffer to the spill file. Must be called with
+            /// m_mutex locked.
+            void spill(const osmium::memory::Buffer& buffer) {
+                if (m_fd == -1) {
+                    m_fd = osmium::detail::create_tmp_file();
+                }
+
+                const std::uint64_t record_size = buffer ? buffer.committed()
+                                                         : static_cast<std::uint64_t>(invalid_buffer_marker);
+
+                osmium::util::file_seek(m_fd, m_write_offset);
+                osmium::io::detail::reliable_write(m_fd, reinterpret_cast<const char*>(&record_size), sizeof(record_size));
+                m_write_offset += sizeof(record_size);
+                if (buffer && buffer.committed() > 0) {
+                    osmium::io::detail::reliable_write(m_fd, reinterpret_cast<const char*>(buffer.data()), buffer.committed());
+                    m_write_offset += buffer.committed();
+                }
+
+                ++m_spill_size;
+                ++m_spilled_counter;
+                m_spilled_bytes += sizeof(record_size) + (buffer ? buffer.committed() : 0);
+            }
+
+            /// Read the oldest buffer from the spill file. Must be
+            /// called with m_mutex locked and m_spill_size > 0.
+            osmium::memory::Buffer replay() {
+                std::uint64_t record_size = 0;
+                osmium::util::file_seek(m_fd, m_read_offset);
+                osmium::io::detail::reliable_read_exact(m_fd, reinterpret_cast<char*>(&record_size), sizeof(record_size));
+                m_read_offset += sizeof(record_size);
+
+                osmium::memory::Buffer buffer{};
+                if (record_size != static_cast<std::uint64_t>(invalid_buffer_marker)) {
+                    std::unique_ptr<unsigned char[]> data{new unsigned char[record_size]};
+                    if (record_size > 0) {
+                        osmium::io::detail::reliable_read_exact(m_fd, reinterpret_cast<char*>(data.get()), static_cast<unsigned int>(record_size));
+                        m_read_offset += static_cast<std::size_t>(record_size);
+                    }
+                    buffer = osmium::memory::Buffer{std::move(data), static_cast<std::size_t>(record_size), static_cast<std::size_t>(record_size)};
+                }
+
+                --m_spill_size;
+                if (m_spill_size == 0) {
+                    // the spill file has been drained, reclaim its
+                    // space and return to pure in-memory operation
+                    m_read_offset = 0;
+                    m_write_offset = 0;
+                    osmium::util::resize_file(m_fd, 0);
+                }
+
+                return buffer;
+            }
+
+        public:
+
+            /**
+             * Construct a spilling queue.
+             *
+             * @param max_size Maximum number of buffers held in memory.
+             *                 When it is reached further buffers spill
+             *                 to the temporary file.
+             */
+            explicit SpillQueue(const std::size_t max_size) :
+                m_max_size(max_size) {
+            }
+
+            SpillQueue(const SpillQueue&) = delete;
+            SpillQueue& operator=(const SpillQueue&) = delete;
+
+            SpillQueue(SpillQueue&&) = delete;
+            SpillQueue& operator=(SpillQueue&&) = delete;
+
+            ~SpillQueue() noexcept {
+                try {
+                    if (m_fd >= 0) {
+                        osmium::io::detail::reliable_close(m_fd);
+                    }
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            /**
+             * Push a buffer onto the queue. Never blocks: when the
+             * in-memory queue is full the buffer goes to the spill
+             * file instead.
+             */
+            void push(osmium::memory::Buffer&& buffer) {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                ++m_push_counter;
+                if (m_spill_size == 0 && m_queue.size() < m_max_size) {
+                    m_queue.push(std::move(buffer));
+                } else {
+                    spill(buffer);
+                }
+                m_data_available.notify_one();
+            }
+
+            /**
+             * Wait until a buffer is available and pop it from the
+             * queue.
+             */
+            void wait_and_pop(osmium::memory::Buffer& value) {
+                std::unique_lock<std::mutex> lock{m_mutex};
+                ++m_pop_counter;
+                m_data_available.wait(lock, [this] {
+                    return !m_queue.empty() || m_spill_size > 0;
+                });
+                if (!m_queue.empty()) {
+                    value = std::move(m_queue.front());
+                    m_queue.pop();
+                } else {
+                    value = replay();
+                }
+            }
+
+            /**
+             * Pop a buffer from the queue if one is available.
+             *
+             * @returns Was there a buffer?
+             */
+            bool try_pop(osmium::memory::Buffer& value) {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                ++m_pop_counter;
+                if (!m_queue.empty()) {
+                    value = std::move(m_queue.front());
+                    m_queue.pop();
+                    return true;
+                }
+                if (m_spill_size > 0) {
+                    value = replay();
+                    return true;
+                }
+                return false;
+            }
+
+            bool empty() const {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                return m_queue.empty() && m_spill_size == 0;
+            }
+
+            /// The number of buffers in the queue, in memory and spilled.
+            std::size_t size() const {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                return m_queue.size() + m_spill_size;
+            }
+
+            /**
+             * Get a snapshot of the counters of this queue. Can be
+             * called at any time from any thread.
+             */
+            spill_queue_counters counters() const {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                spill_queue_counters result;
+                result.push = m_push_counter;
+                result.pop = m_pop_counter;
+                result.spilled = m_spilled_counter;
+                result.spilled_bytes = m_spilled_bytes;
+                result.spill_size = m_spill_size;
+                result.size = m_queue.size();
+                return result;
+            }
+
+        }; // class SpillQueue
+
+    } // namespace thread
+
+} // namespace osmium
+
+#endif // OSMIUM_THREAD_SPILL_QUEUE_HPP
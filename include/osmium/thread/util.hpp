@@ -37,8 +37,11 @@ DEALINGS IN THE SOFTWARE.
 #include <future>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #ifdef __linux__
+# include <pthread.h>
+# include <sched.h>
 # include <sys/prctl.h>
 #endif
 
@@ -82,6 +85,35 @@ namespace osmium {
         }
 #endif
 
+        /**
+         * Restrict the given thread to the given CPUs. Use this to keep
+         * threads that share data on the same NUMA node. This only works
+         * on Linux, on other systems it does nothing.
+         *
+         * @param thread The thread to restrict.
+         * @param cpus The CPU numbers the thread may run on.
+         * @returns True if the affinity was set.
+         */
+#ifdef __linux__
+        inline bool set_thread_affinity(std::thread& thread, const std::vector<int>& cpus) noexcept {
+            if (cpus.empty()) {
+                return false;
+            }
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            for (const int cpu : cpus) {
+                if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                    CPU_SET(cpu, &cpuset);
+                }
+            }
+            return pthread_setaffinity_np(thread.native_handle(), sizeof(cpuset), &cpuset) == 0;
+        }
+#else
+        inline bool set_thread_affinity(std::thread&, const std::vector<int>&) noexcept {
+            return false;
+        }
+#endif
+
         class thread_handler {
 
             std::thread m_thread;
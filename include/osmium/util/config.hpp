@@ -67,6 +67,54 @@ namespace osmium {
             return 0;
         }
 
+        /**
+         * Get affinity policy for the worker threads of the thread
+         * pool from the environment variable OSMIUM_POOL_AFFINITY.
+         * See the osmium::thread::Pool constructor for the values
+         * understood. Returns the empty string if the variable isn't
+         * set, which means the workers are not pinned.
+         */
+        inline std::string get_pool_affinity() {
+            const auto env = osmium::detail::getenv_wrapper("OSMIUM_POOL_AFFINITY");
+            return env ? env : "";
+        }
+
+        /**
+         * Get the maximum number of decode tasks a Reader may have
+         * outstanding in the thread pool at any time from the
+         * environment variable OSMIUM_MAX_READER_POOL_TASKS. Returns
+         * 0 (no limit) if the variable isn't set. See the
+         * osmium::io::max_pool_tasks option for details.
+         */
+        inline std::size_t get_max_reader_pool_tasks() noexcept {
+            const auto env = osmium::detail::getenv_wrapper("OSMIUM_MAX_READER_POOL_TASKS");
+            if (env) {
+                return osmium::detail::str_to_int<std::size_t>(env);
+            }
+            return 0;
+        }
+
+        /**
+         * Should reads of uncompressed files bypass the page cache?
+         * Set the environment variable OSMIUM_DIRECT_READS to "yes" for
+         * one-shot bulk jobs, so reading a huge file once doesn't evict
+         * more useful data of other processes from the cache. Where
+         * direct io is not available, the kernel is instead told to
+         * drop the data just read from the cache. Off by default.
+         */
+        inline bool use_direct_reads() noexcept {
+            const auto env = osmium::detail::getenv_wrapper("OSMIUM_DIRECT_READS");
+            if (env) {
+                if (!strcasecmp(env, "on") ||
+                    !strcasecmp(env, "true") ||
+                    !strcasecmp(env, "yes") ||
+                    !strcasecmp(env, "1")) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
         inline bool use_pool_threads_for_pbf_parsing() noexcept {
             auto env = osmium::detail::getenv_wrapper("OSMIUM_USE_POOL_THREADS_FOR_PBF_PARSING");
             if (env) {
@@ -80,6 +128,51 @@ namespace osmium {
             return true;
         }
 
+        /**
+         * Directory where anonymous temporary files backing the
+         * file-based indexes are created. Set the environment variable
+         * OSMIUM_TMPDIR to put them on fast scratch storage or a tmpfs
+         * instead of the system default temporary directory.
+         */
+        inline std::string get_tmpdir() {
+            const auto env = osmium::detail::getenv_wrapper("OSMIUM_TMPDIR");
+            return env ? env : "";
+        }
+
+        /**
+         * Number of bytes to preallocate (without changing the file
+         * size) when a temporary index file is created, from the
+         * OSMIUM_TMPFILE_PREALLOCATE environment variable. Avoids
+         * fragmentation and repeated extent allocation while a
+         * file-backed index grows. 0 (the default) means off.
+         */
+        inline std::size_t get_tmpfile_preallocation() noexcept {
+            const auto env = osmium::detail::getenv_wrapper("OSMIUM_TMPFILE_PREALLOCATE");
+            if (env) {
+                return osmium::detail::str_to_int<std::size_t>(env);
+            }
+            return 0;
+        }
+
+        /**
+         * Should the memory mappings backing the mmap-based indexes ask
+         * the kernel for (transparent) huge pages? Set the environment
+         * variable OSMIUM_INDEX_HUGEPAGES to "yes" for this. Best
+         * effort, off by default.
+         */
+        inline bool use_index_hugepages() noexcept {
+            const auto env = osmium::detail::getenv_wrapper("OSMIUM_INDEX_HUGEPAGES");
+            if (env) {
+                if (!strcasecmp(env, "on") ||
+                    !strcasecmp(env, "true") ||
+                    !strcasecmp(env, "yes") ||
+                    !strcasecmp(env, "1")) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
         inline std::size_t get_max_queue_size(const char* queue_name, const std::size_t default_value) noexcept {
             assert(queue_name);
             std::string name{"OSMIUM_MAX_"};
@@ -103,6 +196,21 @@ namespace osmium {
             return value;
         }
 
+        /**
+         * Is the maximum size of the named queue explicitly configured
+         * through the OSMIUM_MAX_queue_name_QUEUE_SIZE environment
+         * variable? If so, the configured size is used as a fixed queue
+         * size and adaptive queue sizing is disabled for that queue.
+         */
+        inline bool max_queue_size_is_set(const char* queue_name) noexcept {
+            assert(queue_name);
+            std::string name{"OSMIUM_MAX_"};
+            name += queue_name;
+            name += "_QUEUE_SIZE";
+            const auto env = osmium::detail::getenv_wrapper(name.c_str());
+            return env && osmium::detail::str_to_int<std::size_t>(env) != 0;
+        }
+
     } // namespace config
 
 } // namespace osmium
@@ -0,0 +1,183 @@
+#ifndef OSMIUM_UTIL_CPU_FEATURES_HPP
+#define OSMIUM_UTIL_CPU_FEATURES_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Runtime CPU feature detection for the vectorized kernels. The
+ * baseline SIMD paths (SSE2 on x86-64, NEON on AArch64) are selected
+ * at compile time because every CPU the binary can run on has them.
+ * Kernels with variants using newer instruction sets (AVX2 and wider)
+ * check the features of the CPU the binary actually runs on, once,
+ * and select the variant through a function pointer:
+ *
+ * @code
+ * inline std::size_t kernel(const char* data, std::size_t size) {
+ *     using fn_type = std::size_t (*)(const char*, std::size_t);
+ *     static const fn_type fn = osmium::util::cpu_features().avx2 ?
+ *         kernel_avx2 : kernel_default;
+ *     return fn(data, size);
+ * }
+ * @endcode
+ *
+ * This way the same binary uses the best available code path on every
+ * machine it is deployed to, instead of the lowest common denominator
+ * chosen at compile time.
+ */
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+# define OSMIUM_CPU_FEATURES_X86
+# ifdef _MSC_VER
+#  include <immintrin.h>
+#  include <intrin.h>
+# else
+#  include <cpuid.h>
+# endif
+#endif
+
+// The variants for newer instruction sets are compiled with the GCC
+// and Clang "target" function attribute, so they can live in this
+// header-only library without special compiler flags. MSVC doesn't
+// have an equivalent, there the baseline paths are used.
+#if defined(OSMIUM_CPU_FEATURES_X86) && defined(__GNUC__) && !defined(_MSC_VER)
+# define OSMIUM_USE_RUNTIME_DISPATCH
+# define OSMIUM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace osmium {
+
+    inline namespace util {
+
+        /**
+         * The SIMD-related features of the CPU this process is running
+         * on. Use cpu_features() to get the (cached) features.
+         */
+        struct CpuFeatures {
+
+            /// Baseline on x86-64, always true there.
+            bool sse2 = false;
+
+            bool sse42 = false;
+
+            /// AVX2, and the OS saves/restores the ymm registers.
+            bool avx2 = false;
+
+            /// AVX-512 F+BW, and the OS saves/restores the zmm registers.
+            bool avx512bw = false;
+
+            /// Baseline on AArch64, always true there.
+            bool neon = false;
+
+        }; // struct CpuFeatures
+
+#ifdef OSMIUM_CPU_FEATURES_X86
+
+        inline void cpu_features_cpuid(const uint32_t leaf, const uint32_t subleaf, uint32_t regs[4]) noexcept {
+# ifdef _MSC_VER
+            int data[4];
+            __cpuidex(data, static_cast<int>(leaf), static_cast<int>(subleaf));
+            regs[0] = static_cast<uint32_t>(data[0]);
+            regs[1] = static_cast<uint32_t>(data[1]);
+            regs[2] = static_cast<uint32_t>(data[2]);
+            regs[3] = static_cast<uint32_t>(data[3]);
+# else
+            __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+# endif
+        }
+
+        /// Contents of the XCR0 register: which register states the OS saves.
+        inline uint64_t cpu_features_xgetbv() noexcept {
+# ifdef _MSC_VER
+            return _xgetbv(0);
+# else
+            uint32_t eax = 0;
+            uint32_t edx = 0;
+            __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return (static_cast<uint64_t>(edx) << 32U) | eax;
+# endif
+        }
+
+#endif
+
+        /// Detect the features of this CPU. Use cpu_features() instead.
+        inline CpuFeatures detect_cpu_features() noexcept {
+            CpuFeatures features;
+
+#if defined(OSMIUM_CPU_FEATURES_X86)
+            uint32_t regs[4] = {0, 0, 0, 0};
+
+            cpu_features_cpuid(0, 0, regs);
+            const uint32_t max_leaf = regs[0];
+
+            cpu_features_cpuid(1, 0, regs);
+            features.sse2  = (regs[3] & (1U << 26U)) != 0;
+            features.sse42 = (regs[2] & (1U << 20U)) != 0;
+
+            const bool osxsave = (regs[2] & (1U << 27U)) != 0;
+            const bool avx     = (regs[2] & (1U << 28U)) != 0;
+
+            if (osxsave && avx && max_leaf >= 7) {
+                const uint64_t xcr0 = cpu_features_xgetbv();
+                const bool ymm_saved = (xcr0 & 0x6U) == 0x6U;
+                const bool zmm_saved = (xcr0 & 0xe6U) == 0xe6U;
+
+                cpu_features_cpuid(7, 0, regs);
+                features.avx2 = ymm_saved && (regs[1] & (1U << 5U)) != 0;
+                features.avx512bw = zmm_saved &&
+                                    (regs[1] & (1U << 16U)) != 0 && // AVX-512F
+                                    (regs[1] & (1U << 30U)) != 0;   // AVX-512BW
+            }
+#elif defined(__aarch64__)
+            features.neon = true;
+#endif
+
+            return features;
+        }
+
+        /// The features of this CPU, detected once on the first call.
+        inline const CpuFeatures& cpu_features() noexcept {
+            static const CpuFeatures features = detect_cpu_features();
+            return features;
+        }
+
+    } // namespace util
+
+} // namespace osmium
+
+#undef OSMIUM_CPU_FEATURES_X86
+
+#endif // OSMIUM_UTIL_CPU_FEATURES_HPP
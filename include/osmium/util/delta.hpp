@@ -36,12 +36,68 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/util/cast.hpp>
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
 #include <utility>
 
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+# define OSMIUM_USE_SSE2_DELTA_DECODE
+# include <emmintrin.h>
+#endif
+
 namespace osmium {
 
+    namespace detail {
+
+        /**
+         * Decode an array of deltas in place, replacing every delta
+         * with the decoded absolute value, ie calculate the prefix
+         * sum of the array seeded with the given start value.
+         *
+         * @returns The last decoded value, or the start value for an
+         *          empty array.
+         */
+        template <typename TValue, typename TDelta>
+        inline TValue delta_decode_in_place(TDelta* deltas, const std::size_t size, TValue value) noexcept {
+            for (std::size_t i = 0; i < size; ++i) {
+                value = static_cast<TValue>(static_cast<TDelta>(value) + deltas[i]);
+                deltas[i] = static_cast<TDelta>(value);
+            }
+            return value;
+        }
+
+#ifdef OSMIUM_USE_SSE2_DELTA_DECODE
+        // For the common 64bit case the prefix sum is done two
+        // elements at a time in SSE2 registers: shift-and-add inside
+        // the register, then add the running sum broadcast from the
+        // previous iteration.
+        inline int64_t delta_decode_in_place(int64_t* deltas, const std::size_t size, int64_t value) noexcept {
+            std::size_t i = 0;
+
+            __m128i running = _mm_set1_epi64x(value);
+            for (; i + 2 <= size; i += 2) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + i));
+                v = _mm_add_epi64(v, _mm_slli_si128(v, 8));
+                v = _mm_add_epi64(v, running);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(deltas + i), v);
+                running = _mm_unpackhi_epi64(v, v);
+            }
+
+            if (i != 0) {
+                value = deltas[i - 1];
+            }
+            for (; i < size; ++i) {
+                value += deltas[i];
+                deltas[i] = value;
+            }
+
+            return value;
+        }
+#endif
+
+    } // namespace detail
+
     inline namespace util {
 
         /**
@@ -90,6 +146,24 @@ namespace osmium {
                        static_cast<TDelta>(new_value);
             }
 
+            /**
+             * Bulk update: Replace every value in the array by its delta
+             * to the value before it (the first one by its delta to the
+             * current state). Afterwards the internal state is the last
+             * original value, so bulk and single-value updates can be
+             * mixed. The loop has no carried dependency and is easily
+             * auto-vectorized by compilers.
+             */
+            void update(TDelta* values, const std::size_t size) noexcept {
+                TDelta previous = static_cast<TDelta>(m_value);
+                for (std::size_t i = 0; i < size; ++i) {
+                    const TDelta current = values[i];
+                    values[i] = current - previous;
+                    previous = current;
+                }
+                m_value = static_cast<TValue>(previous);
+            }
+
         }; // class DeltaEncode
 
         /**
@@ -129,6 +203,22 @@ namespace osmium {
                 return m_value;
             }
 
+            /**
+             * Bulk update: Decode all deltas in the array in place,
+             * replacing every delta with its decoded absolute value, ie
+             * calculate the prefix sum of the array seeded with the
+             * current state. Afterwards the internal state is the last
+             * decoded value, so bulk and single-value updates can be
+             * mixed. Uses a SIMD implementation where available.
+             *
+             * @returns The last decoded value, or the current state for
+             *          an empty array.
+             */
+            TValue update(TDelta* deltas, const std::size_t size) noexcept {
+                m_value = detail::delta_decode_in_place(deltas, size, m_value);
+                return m_value;
+            }
+
         }; // class DeltaDecode
 
     } // namespace util
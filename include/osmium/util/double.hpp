@@ -33,10 +33,14 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/util/itoa.hpp>
+
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
-#include <iterator>
 #include <string>
 
 namespace osmium {
@@ -62,6 +66,57 @@ namespace osmium {
 
             char buffer[max_double_length];
 
+            // Fast path for the common case (all coordinates): scale the
+            // value into a 64 bit integer and format that, which is much
+            // faster than going through snprintf.
+            if (precision <= 8 && std::fabs(value) < 999999999.0) {
+                static const double scale_factor[] = {
+                    1.0, 10.0, 100.0, 1000.0, 10000.0,
+                    100000.0, 1000000.0, 10000000.0, 100000000.0
+                };
+                static const int64_t scale_int[] = {
+                    1, 10, 100, 1000, 10000,
+                    100000, 1000000, 10000000, 100000000
+                };
+
+                const double scaled_d = std::fabs(value) * scale_factor[precision];
+
+                // snprintf rounds based on the exact binary value. The
+                // product above is correctly rounded, so as long as it is
+                // small enough for a double to resolve single units (2^53)
+                // rounding it can only differ from that when it lands
+                // exactly on a tie (for instance 0.25 at precision 1).
+                // Leave both cases to the snprintf path below so the
+                // output stays the same.
+                if (scaled_d < 9007199254740992.0 &&
+                    scaled_d - std::floor(scaled_d) != 0.5) {
+                    const auto scaled = static_cast<int64_t>(std::llround(scaled_d));
+                    const int64_t scale = scale_int[precision];
+
+                    char* b = buffer;
+                    if (std::signbit(value)) {
+                        *b++ = '-';
+                    }
+                    b = uint64_to_string(static_cast<uint64_t>(scaled / scale), b);
+
+                    int64_t frac = scaled % scale;
+                    if (frac != 0) {
+                        *b++ = '.';
+                        char* const frac_end = b + precision;
+                        for (char* f = frac_end - 1; f >= b; --f) {
+                            *f = static_cast<char>('0' + frac % 10);
+                            frac /= 10;
+                        }
+                        b = frac_end;
+                        while (*(b - 1) == '0') {
+                            --b;
+                        }
+                    }
+
+                    return std::copy(buffer, b, iterator);
+                }
+            }
+
 #ifndef _MSC_VER
             int len = snprintf(buffer, max_double_length, "%.*f", precision, value);
 #else
@@ -69,11 +124,16 @@ namespace osmium {
 #endif
             assert(len > 0 && len < max_double_length);
 
-            while (buffer[len - 1] == '0') {
-                --len;
-            }
-            if (buffer[len - 1] == '.') {
-                --len;
+            // Only fractional digits are superfluous, with a precision of
+            // 0 there is no decimal dot and the zeros are part of the
+            // integer.
+            if (precision > 0) {
+                while (buffer[len - 1] == '0') {
+                    --len;
+                }
+                if (buffer[len - 1] == '.') {
+                    --len;
+                }
             }
 
             return std::copy_n(buffer, len, iterator);
@@ -88,7 +148,9 @@ namespace osmium {
          * @param precision max number of digits after the decimal point
          */
         inline void double2string(std::string& out, double value, int precision) {
-            double2string(std::back_inserter(out), value, precision);
+            char buffer[20];
+            char* const end = double2string(buffer, value, precision);
+            out.append(buffer, static_cast<std::size_t>(end - buffer));
         }
 
     } // namespace util
@@ -223,6 +223,21 @@ namespace osmium {
             return static_cast<std::size_t>(offset);
         }
 
+        /**
+         * Set current offset into file.
+         *
+         * @param fd Open file descriptor.
+         * @param offset Desired absolute offset into the file.
+         */
+        inline void file_seek(int fd, const std::size_t offset) {
+#ifdef _MSC_VER
+            osmium::detail::disable_invalid_parameter_handler diph;
+            _lseeki64(fd, static_cast<__int64>(offset), SEEK_SET);
+#else
+            ::lseek(fd, static_cast<off_t>(offset), SEEK_SET);
+#endif
+        }
+
         /**
          * Check whether the file descriptor refers to a TTY.
          */
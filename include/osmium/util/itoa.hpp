@@ -0,0 +1,104 @@
+#ifndef OSMIUM_UTIL_ITOA_HPP
+#define OSMIUM_UTIL_ITOA_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <cstdint>
+
+namespace osmium {
+
+    inline namespace util {
+
+        /**
+         * Write decimal representation of an unsigned integer into the
+         * buffer, which must have room for at least 20 characters. Digits
+         * are generated two at a time from a lookup table, which is much
+         * faster than sprintf and the like.
+         *
+         * @returns Pointer past the last character written.
+         */
+        inline char* uint64_to_string(uint64_t value, char* buffer) noexcept {
+            static const char pairs[] =
+                "00010203040506070809"
+                "10111213141516171819"
+                "20212223242526272829"
+                "30313233343536373839"
+                "40414243444546474849"
+                "50515253545556575859"
+                "60616263646566676869"
+                "70717273747576777879"
+                "80818283848586878889"
+                "90919293949596979899";
+
+            char temp[20];
+            char* t = temp + sizeof(temp);
+
+            while (value >= 100) {
+                const auto index = static_cast<unsigned int>(value % 100) * 2;
+                value /= 100;
+                *--t = pairs[index + 1];
+                *--t = pairs[index];
+            }
+
+            if (value >= 10) {
+                const auto index = static_cast<unsigned int>(value) * 2;
+                *--t = pairs[index + 1];
+                *--t = pairs[index];
+            } else {
+                *--t = static_cast<char>('0' + value);
+            }
+
+            return std::copy(t, temp + sizeof(temp), buffer);
+        }
+
+        /**
+         * Write decimal representation of a signed integer into the
+         * buffer, which must have room for at least 21 characters.
+         *
+         * @returns Pointer past the last character written.
+         */
+        inline char* int64_to_string(const int64_t value, char* buffer) noexcept {
+            auto uvalue = static_cast<uint64_t>(value);
+            if (value < 0) {
+                *buffer++ = '-';
+                uvalue = 0 - uvalue; // also works for the smallest int64_t
+            }
+            return uint64_to_string(uvalue, buffer);
+        }
+
+    } // namespace util
+
+} // namespace osmium
+
+#endif // OSMIUM_UTIL_ITOA_HPP
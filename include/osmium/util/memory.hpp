@@ -33,9 +33,15 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <fstream>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <osmium/util/misc.hpp>
 
@@ -95,6 +101,163 @@ namespace osmium {
 
     }; // class MemoryUsage
 
+    /**
+     * Process-wide registry of named memory accounts. While MemoryUsage
+     * tells you how much memory the whole process is using, this tells
+     * you which subsystem is using it: components register a name and a
+     * callback reporting their current memory use (usually their
+     * used_memory() function) and a report walks all accounts.
+     *
+     * Use the MemoryAccount class or the account_memory() convenience
+     * functions on the index maps, the ItemStash, and the relations
+     * managers instead of talking to this class directly.
+     */
+    class MemoryAccounting {
+
+        struct account_entry {
+            uint64_t id;
+            std::string name;
+            std::function<std::size_t()> callback;
+        };
+
+        mutable std::mutex m_mutex;
+
+        std::vector<account_entry> m_accounts;
+
+        uint64_t m_next_id = 1;
+
+    public:
+
+        /// Access the process-wide registry.
+        static MemoryAccounting& instance() {
+            static MemoryAccounting accounting;
+            return accounting;
+        }
+
+        /**
+         * Register an account. Prefer the RAII MemoryAccount class
+         * which calls this for you.
+         *
+         * @param name Name of the account shown in reports. Doesn't
+         *             have to be unique.
+         * @param callback Called (under the registry lock) whenever a
+         *                 report is generated, must return the current
+         *                 memory use in bytes.
+         * @returns Id to be used for remove_account().
+         */
+        uint64_t add_account(std::string name, std::function<std::size_t()> callback) {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            const uint64_t id = m_next_id++;
+            m_accounts.push_back(account_entry{id, std::move(name), std::move(callback)});
+            return id;
+        }
+
+        /// Remove the account with the specified id.
+        void remove_account(const uint64_t id) {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_accounts.erase(std::remove_if(m_accounts.begin(), m_accounts.end(), [id](const account_entry& entry) {
+                return entry.id == id;
+            }), m_accounts.end());
+        }
+
+        /**
+         * Call func(name, bytes) for every registered account, in
+         * registration order. The callbacks run while the registry is
+         * locked, so they must not register or remove accounts.
+         */
+        template <typename TFunc>
+        void for_each(TFunc&& func) const {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            for (const auto& entry : m_accounts) {
+                func(entry.name.c_str(), entry.callback());
+            }
+        }
+
+        /// The sum of all accounts in bytes.
+        std::size_t total() const {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            std::size_t sum = 0;
+            for (const auto& entry : m_accounts) {
+                sum += entry.callback();
+            }
+            return sum;
+        }
+
+        /// The number of registered accounts.
+        std::size_t size() const {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            return m_accounts.size();
+        }
+
+    }; // class MemoryAccounting
+
+    /**
+     * RAII handle for an entry in the MemoryAccounting registry. The
+     * account is registered on construction and removed again when this
+     * object is destroyed, so keep it next to the object it reports on.
+     *
+     * @code
+     * index_type index;
+     * auto account = index.account_memory("location_index");
+     * @endcode
+     *
+     * The callback must stay valid as long as the account exists: don't
+     * move or destroy the object it reports on while the account is
+     * still registered.
+     */
+    class MemoryAccount {
+
+        uint64_t m_id = 0;
+
+    public:
+
+        /// Create an empty handle not connected to any account.
+        MemoryAccount() noexcept = default;
+
+        /**
+         * Register an account. See MemoryAccounting::add_account() for
+         * the parameters.
+         */
+        MemoryAccount(std::string name, std::function<std::size_t()> callback) :
+            m_id(MemoryAccounting::instance().add_account(std::move(name), std::move(callback))) {
+        }
+
+        MemoryAccount(const MemoryAccount&) = delete;
+        MemoryAccount& operator=(const MemoryAccount&) = delete;
+
+        MemoryAccount(MemoryAccount&& other) noexcept :
+            m_id(other.m_id) {
+            other.m_id = 0;
+        }
+
+        MemoryAccount& operator=(MemoryAccount&& other) noexcept {
+            if (this != &other) {
+                reset();
+                m_id = other.m_id;
+                other.m_id = 0;
+            }
+            return *this;
+        }
+
+        ~MemoryAccount() {
+            reset();
+        }
+
+        /// Is this handle connected to an account?
+        bool valid() const noexcept {
+            return m_id != 0;
+        }
+
+        /// Remove the account from the registry.
+        void reset() {
+            if (m_id != 0) {
+                MemoryAccounting::instance().remove_account(m_id);
+                m_id = 0;
+            }
+        }
+
+    }; // class MemoryAccount
+
 } // namespace osmium
 
 #endif // OSMIUM_UTIL_MEMORY_HPP
@@ -275,6 +275,60 @@ namespace osmium {
                 return m_mapping_mode != mapping_mode::readonly;
             }
 
+            /// Access pattern hints for advise().
+            enum class advice {
+                normal     = 0,
+                random     = 1,
+                sequential = 2,
+                willneed   = 3,
+                dontneed   = 4
+            };
+
+            /**
+             * Tell the kernel how this mapping will be accessed (see
+             * madvise(2)), so it can adapt its readahead and page
+             * reclaim. Use advice::random for index lookups,
+             * advice::sequential for one-pass scans, advice::willneed
+             * to start reading the whole mapping in the background, and
+             * advice::dontneed when you are done with the data for now.
+             *
+             * This is only ever an optimization, failure is ignored.
+             * Does nothing on Windows.
+             *
+             * @returns true if the hint was given to the OS.
+             */
+            bool advise(advice hint) noexcept;
+
+            /**
+             * Tell the kernel to back this mapping with (transparent)
+             * huge pages if it can. Linux only, on other systems this
+             * does nothing. Only an optimization, failure is ignored.
+             *
+             * @returns true if the hint was given to the OS.
+             */
+            bool advise_huge_pages() noexcept;
+
+            /**
+             * Fault in all pages of the mapping by touching one byte
+             * per page. Later accesses then don't take scattered page
+             * faults, which is a big win before random lookups in a
+             * file-backed index. Call advise() with advice::willneed
+             * first to give the kernel a chance to read the pages in
+             * larger batches.
+             *
+             * Does nothing if the mapping is invalid.
+             */
+            void populate() const noexcept {
+                if (!is_valid()) {
+                    return;
+                }
+                const std::size_t page_size = osmium::get_pagesize();
+                const volatile unsigned char* data = static_cast<const unsigned char*>(m_addr);
+                for (std::size_t offset = 0; offset < m_size; offset += page_size) {
+                    (void)data[offset];
+                }
+            }
+
             /**
              * Get the address of the mapping as any pointer type you like.
              *
@@ -451,6 +505,21 @@ namespace osmium {
                 return m_mapping.writable();
             }
 
+            /// See MemoryMapping::advise().
+            bool advise(MemoryMapping::advice hint) noexcept {
+                return m_mapping.advise(hint);
+            }
+
+            /// See MemoryMapping::advise_huge_pages().
+            bool advise_huge_pages() noexcept {
+                return m_mapping.advise_huge_pages();
+            }
+
+            /// See MemoryMapping::populate().
+            void populate() const noexcept {
+                m_mapping.populate();
+            }
+
             /**
              * Get the address of the beginning of the mapping.
              *
@@ -591,6 +660,41 @@ inline void osmium::util::MemoryMapping::unmap() {
     }
 }
 
+inline bool osmium::util::MemoryMapping::advise(advice hint) noexcept {
+    if (!is_valid()) {
+        return false;
+    }
+    int flag = MADV_NORMAL;
+    switch (hint) {
+        case advice::random:
+            flag = MADV_RANDOM;
+            break;
+        case advice::sequential:
+            flag = MADV_SEQUENTIAL;
+            break;
+        case advice::willneed:
+            flag = MADV_WILLNEED;
+            break;
+        case advice::dontneed:
+            flag = MADV_DONTNEED;
+            break;
+        default: // advice::normal
+            break;
+    }
+    return ::madvise(m_addr, m_size, flag) == 0;
+}
+
+inline bool osmium::util::MemoryMapping::advise_huge_pages() noexcept {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (!is_valid()) {
+        return false;
+    }
+    return ::madvise(m_addr, m_size, MADV_HUGEPAGE) == 0;
+#else
+    return false;
+#endif
+}
+
 inline void osmium::util::MemoryMapping::resize(std::size_t new_size) {
     assert(new_size > 0 && "can not resize to zero size");
     if (m_fd == -1) { // anonymous mapping
@@ -700,6 +804,16 @@ inline void osmium::util::MemoryMapping::make_invalid() noexcept {
     m_addr = nullptr;
 }
 
+// There is nothing like madvise() on Windows, so these hints do nothing.
+
+inline bool osmium::util::MemoryMapping::advise(advice /*hint*/) noexcept {
+    return false;
+}
+
+inline bool osmium::util::MemoryMapping::advise_huge_pages() noexcept {
+    return false;
+}
+
 // GetLastError() returns a DWORD (A 32-bit unsigned integer), but the error
 // code for std::system_error is an int. So we convert this here and hope
 // it all works.
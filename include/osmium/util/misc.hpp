@@ -55,6 +55,19 @@ namespace osmium {
 
     namespace detail {
 
+        /**
+         * Hint to the CPU that the cache line containing the specified
+         * address will be read soon. Does nothing on compilers without
+         * a prefetch intrinsic.
+         */
+        inline void prefetch_read(const void* addr) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(addr, 0);
+#else
+            (void)addr;
+#endif
+        }
+
         /**
          * Interpret the input string as number. Leading white space is
          * ignored. If there is any error, return 0.
@@ -0,0 +1,70 @@
+#ifndef OSMIUM_UTIL_PROBES_HPP
+#define OSMIUM_UTIL_PROBES_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Opt-in USDT (SystemTap sdt.h) probe points at the boundaries of the
+ * logical pipeline stages. Profiles of the worker threads otherwise
+ * show only anonymous operator() frames that can not be mapped to a
+ * stage without reading the assembly; with the probes compiled in,
+ * tools like perf can attribute samples and trace spans to stages:
+ *
+ * @code
+ * perf probe --add 'sdt_osmium:*'
+ * perf record -e sdt_osmium:pbf_blob_decode -e sdt_osmium:pbf_blob_serialize ...
+ * @endcode
+ *
+ * Define OSMIUM_WITH_SDT before including any Osmium header to compile
+ * the probes in (needs <sys/sdt.h> from the systemtap-sdt-dev package
+ * or equivalent). Without it the macros expand to nothing and there is
+ * zero overhead. An sdt.h probe site is a single nop instruction, so
+ * even compiled in they cost next to nothing until a tracer arms them.
+ */
+
+#ifdef OSMIUM_WITH_SDT
+# include <sys/sdt.h>
+# define OSMIUM_PROBE(_name_) \
+    DTRACE_PROBE(osmium, _name_)
+# define OSMIUM_PROBE1(_name_, _arg1_) \
+    DTRACE_PROBE1(osmium, _name_, _arg1_)
+#else
+# define OSMIUM_PROBE(_name_) \
+    static_cast<void>(0)
+# define OSMIUM_PROBE1(_name_, _arg1_) \
+    static_cast<void>(0)
+#endif
+
+#endif // OSMIUM_UTIL_PROBES_HPP
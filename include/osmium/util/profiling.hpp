@@ -0,0 +1,143 @@
+#ifndef OSMIUM_UTIL_PROFILING_HPP
+#define OSMIUM_UTIL_PROFILING_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Opt-in counters for the library hot paths. Define
+ * OSMIUM_WITH_PROFILING before including any Osmium header to compile
+ * them in; without it the counting macros expand to nothing and there
+ * is zero overhead.
+ *
+ * With profiling enabled, the counters are incremented with relaxed
+ * atomics from all threads and collected in a single process-wide
+ * registry that can be read (and reset) at any time:
+ *
+ * @code
+ * osmium::util::profiling_counters().for_each([](const char* name, uint64_t value) {
+ *     std::cerr << name << ": " << value << "\n";
+ * });
+ * @endcode
+ */
+
+#include <atomic>
+#include <cstdint>
+
+namespace osmium {
+
+    inline namespace util {
+
+        /**
+         * Process-wide registry of the profiling counters. Counters are
+         * only incremented if the library was compiled with
+         * OSMIUM_WITH_PROFILING, but the registry itself is always
+         * available so monitoring code works with either build.
+         */
+        struct ProfilingCounters {
+
+            /// OSM objects decoded from PBF input.
+            std::atomic<std::uint64_t> objects_decoded{0};
+
+            /// Compressed bytes of PBF blob data handed to the decompressor.
+            std::atomic<std::uint64_t> bytes_compressed{0};
+
+            /// Number of times a buffer had to grow.
+            std::atomic<std::uint64_t> buffer_grows{0};
+
+            /// Number of times a thread pushing to a full queue was blocked.
+            std::atomic<std::uint64_t> queue_full_stalls{0};
+
+            /// Number of times popping from a queue didn't get data immediately.
+            std::atomic<std::uint64_t> queue_empty_stalls{0};
+
+            /// Lookups in the index maps.
+            std::atomic<std::uint64_t> index_probes{0};
+
+            /// Lookups in the index maps that didn't find the id.
+            std::atomic<std::uint64_t> index_misses{0};
+
+            /// IdSetAdaptive promotions from the small to the dense representation.
+            std::atomic<std::uint64_t> id_set_promotions{0};
+
+            /**
+             * Call func(name, value) for every counter.
+             */
+            template <typename TFunc>
+            void for_each(TFunc&& func) const {
+                func("objects_decoded",   objects_decoded.load(std::memory_order_relaxed));
+                func("bytes_compressed",  bytes_compressed.load(std::memory_order_relaxed));
+                func("buffer_grows",      buffer_grows.load(std::memory_order_relaxed));
+                func("queue_full_stalls", queue_full_stalls.load(std::memory_order_relaxed));
+                func("queue_empty_stalls", queue_empty_stalls.load(std::memory_order_relaxed));
+                func("index_probes",      index_probes.load(std::memory_order_relaxed));
+                func("index_misses",      index_misses.load(std::memory_order_relaxed));
+                func("id_set_promotions", id_set_promotions.load(std::memory_order_relaxed));
+            }
+
+            /// Reset all counters to zero.
+            void reset() noexcept {
+                objects_decoded.store(0, std::memory_order_relaxed);
+                bytes_compressed.store(0, std::memory_order_relaxed);
+                buffer_grows.store(0, std::memory_order_relaxed);
+                queue_full_stalls.store(0, std::memory_order_relaxed);
+                queue_empty_stalls.store(0, std::memory_order_relaxed);
+                index_probes.store(0, std::memory_order_relaxed);
+                index_misses.store(0, std::memory_order_relaxed);
+                id_set_promotions.store(0, std::memory_order_relaxed);
+            }
+
+        }; // struct ProfilingCounters
+
+        /// Access the process-wide profiling counters.
+        inline ProfilingCounters& profiling_counters() noexcept {
+            static ProfilingCounters counters;
+            return counters;
+        }
+
+    } // namespace util
+
+} // namespace osmium
+
+#ifdef OSMIUM_WITH_PROFILING
+# define OSMIUM_PROFILE_ADD(_counter_, _amount_) \
+    osmium::util::profiling_counters()._counter_.fetch_add((_amount_), std::memory_order_relaxed)
+#else
+# define OSMIUM_PROFILE_ADD(_counter_, _amount_) \
+    static_cast<void>(0)
+#endif
+
+#define OSMIUM_PROFILE_COUNT(_counter_) OSMIUM_PROFILE_ADD(_counter_, 1)
+
+#endif // OSMIUM_UTIL_PROFILING_HPP
@@ -0,0 +1,149 @@
+#ifndef OSMIUM_UTIL_STRING_INTERNER_HPP
+#define OSMIUM_UTIL_STRING_INTERNER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * Interns strings, assigning each distinct string a small
+     * consecutive id. Tag keys (and many values) repeat endlessly in
+     * OSM data, so applications comparing the same keys over and over
+     * can intern them once and compare the ids instead of calling
+     * strcmp on every tag.
+     *
+     * Ids are assigned in the order strings are first interned,
+     * starting at 0, and stay valid for the lifetime of the interner.
+     *
+     * This class is not thread-safe. If you want to fill it from
+     * several threads, you have to synchronize the calls yourself, or
+     * better, fill it once up front and only call the const member
+     * functions afterwards, which is safe.
+     */
+    class StringInterner {
+
+    public:
+
+        using id_type = uint32_t;
+
+        enum : id_type {
+            /// Returned by get_id() for strings that were never interned.
+            invalid_id = 0xffffffffU
+        };
+
+    private:
+
+        std::unordered_map<std::string, id_type> m_ids;
+
+        // Pointers into the keys of m_ids, indexed by id. References
+        // into an unordered_map stay valid when it grows.
+        std::vector<const std::string*> m_strings;
+
+    public:
+
+        StringInterner() = default;
+
+        /**
+         * Get the id for the specified string, interning it first if it
+         * wasn't interned before.
+         */
+        id_type intern(const std::string& str) {
+            const auto result = m_ids.emplace(str, static_cast<id_type>(m_strings.size()));
+            if (result.second) {
+                m_strings.push_back(&result.first->first);
+            }
+            return result.first->second;
+        }
+
+        /**
+         * Get the id for the specified string, interning it first if it
+         * wasn't interned before.
+         */
+        id_type intern(const char* str) {
+            return intern(std::string{str});
+        }
+
+        /**
+         * Get the id for the specified string, or invalid_id if the
+         * string was never interned. Doesn't change the interner, so
+         * unlike intern() this is safe to call concurrently.
+         */
+        id_type get_id(const char* str) const {
+            const auto it = m_ids.find(str);
+            return it == m_ids.end() ? static_cast<id_type>(invalid_id) : it->second;
+        }
+
+        /**
+         * Get the string with the specified id.
+         *
+         * @throws std::out_of_range If the id is not valid.
+         */
+        const char* get_string(const id_type id) const {
+            return m_strings.at(id)->c_str();
+        }
+
+        /**
+         * The number of interned strings.
+         */
+        std::size_t size() const noexcept {
+            return m_strings.size();
+        }
+
+        /**
+         * Are there no interned strings?
+         */
+        bool empty() const noexcept {
+            return m_strings.empty();
+        }
+
+        /**
+         * Return a process-wide interner instance for the common case
+         * of one shared key dictionary. The same thread-safety caveats
+         * apply as for any other instance.
+         */
+        static StringInterner& default_instance() {
+            static StringInterner interner;
+            return interner;
+        }
+
+    }; // class StringInterner
+
+} // namespace osmium
+
+#endif // OSMIUM_UTIL_STRING_INTERNER_HPP
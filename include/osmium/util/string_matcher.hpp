@@ -35,7 +35,10 @@ DEALINGS IN THE SOFTWARE.
 
 #include <boost/variant.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
+#include <functional>
 #include <iosfwd>
 #include <regex>
 #include <string>
@@ -135,6 +138,10 @@ namespace osmium {
                 return !std::strcmp(m_str.c_str(), test_string);
             }
 
+            const std::string& str() const noexcept {
+                return m_str;
+            }
+
             template <typename TChar, typename TTraits>
             void print(std::basic_ostream<TChar, TTraits>& out) const {
                 out << "equal[" << m_str << ']';
@@ -229,7 +236,35 @@ namespace osmium {
          */
         class list : public matcher {
 
+            // For lists with at least this many strings a sorted copy is
+            // kept and matching uses a binary search instead of the linear
+            // scan. The crossover point where the binary search wins was
+            // determined experimentally.
+            enum : std::size_t {
+                min_strings_for_binary_search = 16
+            };
+
             std::vector<std::string> m_strings;
+            std::vector<std::string> m_sorted_strings;
+
+            struct str_compare {
+
+                bool operator()(const std::string& lhs, const char* rhs) const noexcept {
+                    return std::strcmp(lhs.c_str(), rhs) < 0;
+                }
+
+                bool operator()(const char* lhs, const std::string& rhs) const noexcept {
+                    return std::strcmp(lhs, rhs.c_str()) < 0;
+                }
+
+            }; // struct str_compare
+
+            void update_index() {
+                if (m_strings.size() >= min_strings_for_binary_search) {
+                    m_sorted_strings = m_strings;
+                    std::sort(m_sorted_strings.begin(), m_sorted_strings.end());
+                }
+            }
 
         public:
 
@@ -237,19 +272,25 @@ namespace osmium {
 
             explicit list(std::vector<std::string> strings) :
                 m_strings(std::move(strings)) {
+                update_index();
             }
 
             list& add_string(const char* str) {
                 m_strings.emplace_back(str);
+                update_index();
                 return *this;
             }
 
             list& add_string(const std::string& str) {
                 m_strings.push_back(str);
+                update_index();
                 return *this;
             }
 
             bool match(const char* test_string) const noexcept {
+                if (!m_sorted_strings.empty()) {
+                    return std::binary_search(m_sorted_strings.begin(), m_sorted_strings.end(), test_string, str_compare{});
+                }
                 for (const auto& s : m_strings) {
                     if (!std::strcmp(s.c_str(), test_string)) {
                         return true;
@@ -270,6 +311,41 @@ namespace osmium {
 
         }; // class list
 
+        /**
+         * Matches using a caller-supplied function. Use this to plug
+         * matching engines into libosmium that it doesn't support
+         * itself, for instance a linear-time regex library such as RE2
+         * instead of the (usually slow, backtracking) std::regex:
+         * @code
+         * auto re = std::make_shared<RE2>("^(foo|bar)");
+         * osmium::StringMatcher m{osmium::StringMatcher::function{
+         *     [re](const char* str) {
+         *         return RE2::PartialMatch(str, *re);
+         *     }}};
+         * @endcode
+         * The function must not be empty and must not throw.
+         */
+        class function : public matcher {
+
+            std::function<bool(const char*)> m_function;
+
+        public:
+
+            explicit function(std::function<bool(const char*)> func) :
+                m_function(std::move(func)) {
+            }
+
+            bool match(const char* test_string) const noexcept {
+                return m_function(test_string);
+            }
+
+            template <typename TChar, typename TTraits>
+            void print(std::basic_ostream<TChar, TTraits>& out) const {
+                out << "function";
+            }
+
+        }; // class function
+
     private:
 
         using matcher_type = boost::variant<always_false,
@@ -280,7 +356,8 @@ namespace osmium {
 #ifdef OSMIUM_WITH_REGEX
                                             regex,
 #endif
-                                            list>;
+                                            list,
+                                            function>;
 
         matcher_type m_matcher;
 
@@ -387,7 +464,8 @@ namespace osmium {
          *
          * @tparam TMatcher Must be one of the matcher classes
          *                  osmium::StringMatcher::always_false, always_true,
-         *                  equal, prefix, substring, regex or list.
+         *                  equal, prefix, substring, regex, list or
+         *                  function.
          */
         template <typename TMatcher, typename std::enable_if<
             std::is_base_of<matcher, TMatcher>::value, int>::type = 0>
@@ -395,6 +473,17 @@ namespace osmium {
             m_matcher(std::forward<TMatcher>(matcher)) {
         }
 
+        /**
+         * If this matcher matches a single string exactly (ie it is an
+         * equal matcher), return a pointer to that string, otherwise
+         * return nullptr. This allows callers such as the
+         * osmium::TagsFilterBase to index matchers by their string.
+         */
+        const std::string* equal_string() const noexcept {
+            const equal* matcher = boost::get<equal>(&m_matcher);
+            return matcher ? &matcher->str() : nullptr;
+        }
+
         /**
          * Match the specified string.
          */
@@ -0,0 +1,198 @@
+#ifndef OSMIUM_UTIL_TUNING_HPP
+#define OSMIUM_UTIL_TUNING_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/util/config.hpp>
+#include <osmium/util/misc.hpp>
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace osmium {
+
+    namespace config {
+
+        /**
+         * Typed registry of the runtime performance knobs used by the
+         * thread pool, the Reader, and the Writer. It collects in one
+         * place what used to be scattered over environment variable
+         * lookups and hardcoded constants.
+         *
+         * The registry is filled once from the environment when it is
+         * first used, see tuning(). All fields can be changed
+         * programmatically after that; changes only affect Readers,
+         * Writers, and thread pools created afterwards. Hot paths read
+         * plain struct fields instead of doing getenv() and string
+         * parsing again.
+         *
+         * Use dump() to log the effective values.
+         */
+        struct Tuning {
+
+            // thread pool
+
+            /// Number of worker threads in the default thread pool
+            /// (OSMIUM_POOL_THREADS). 0 or negative values choose
+            /// automatically based on the number of cores.
+            int pool_threads;
+
+            /// CPU affinity for the pool worker threads
+            /// (OSMIUM_POOL_AFFINITY). See the osmium::thread::Pool
+            /// constructor for the values understood. Empty means the
+            /// workers are not pinned.
+            std::string pool_affinity;
+
+            /// Maximum size of the thread pool work queue
+            /// (OSMIUM_MAX_WORK_QUEUE_SIZE).
+            std::size_t work_queue_size;
+
+            // reader
+
+            /// Maximum number of decode tasks a Reader may have
+            /// outstanding in the thread pool at any time
+            /// (OSMIUM_MAX_READER_POOL_TASKS). 0 means no limit.
+            std::size_t max_reader_pool_tasks;
+
+            /// Initial maximum size of the raw input queue of a Reader
+            /// (OSMIUM_MAX_INPUT_QUEUE_SIZE).
+            std::size_t input_queue_size;
+
+            /// Is input_queue_size fixed? When it comes from the
+            /// environment it is used as-is, otherwise the queue limit
+            /// adapts to observed stalls starting from input_queue_size.
+            bool input_queue_size_fixed;
+
+            /// Initial maximum size of the queue of decoded buffers
+            /// (OSMIUM_MAX_OSMDATA_QUEUE_SIZE). This queue is the
+            /// reorder window of the decode pipeline: blobs can finish
+            /// decoding in any order, delivery happens in submission
+            /// order. The default grows with the number of cores,
+            /// otherwise a single slow blob at the head blocks
+            /// submission of new decode tasks and leaves workers idle
+            /// on many-core machines.
+            std::size_t osmdata_queue_size;
+
+            /// Is osmdata_queue_size fixed? See input_queue_size_fixed.
+            bool osmdata_queue_size_fixed;
+
+            /// Size in bytes of the blocks read from uncompressed
+            /// input files (OSMIUM_INPUT_BUFFER_SIZE). Previously a
+            /// hardcoded constant, the default is unchanged.
+            std::size_t input_buffer_size;
+
+            /// Should reads of uncompressed files bypass the page
+            /// cache (OSMIUM_DIRECT_READS)?
+            bool direct_reads;
+
+            /// Decode PBF blobs on the pool worker threads instead of
+            /// the parser thread
+            /// (OSMIUM_USE_POOL_THREADS_FOR_PBF_PARSING)?
+            bool pool_threads_for_pbf_parsing;
+
+            // writer
+
+            /// Initial maximum size of the output queue of a Writer
+            /// (OSMIUM_MAX_OUTPUT_QUEUE_SIZE).
+            std::size_t output_queue_size;
+
+            /// Is output_queue_size fixed? See input_queue_size_fixed.
+            bool output_queue_size_fixed;
+
+            Tuning() :
+                pool_threads(osmium::config::get_pool_threads()),
+                pool_affinity(osmium::config::get_pool_affinity()),
+                work_queue_size(osmium::config::get_max_queue_size("WORK", 10)),
+                max_reader_pool_tasks(osmium::config::get_max_reader_pool_tasks()),
+                input_queue_size(osmium::config::get_max_queue_size("INPUT", 20)),
+                input_queue_size_fixed(osmium::config::max_queue_size_is_set("INPUT")),
+                osmdata_queue_size(osmium::config::get_max_queue_size("OSMDATA", default_osmdata_queue_size())),
+                osmdata_queue_size_fixed(osmium::config::max_queue_size_is_set("OSMDATA")),
+                input_buffer_size(get_input_buffer_size()),
+                direct_reads(osmium::config::use_direct_reads()),
+                pool_threads_for_pbf_parsing(osmium::config::use_pool_threads_for_pbf_parsing()),
+                output_queue_size(osmium::config::get_max_queue_size("OUTPUT", 20)),
+                output_queue_size_fixed(osmium::config::max_queue_size_is_set("OUTPUT")) {
+            }
+
+            /// Write all effective values to the stream, one
+            /// "name = value" pair per line.
+            void dump(std::ostream& out) const {
+                out << "pool_threads = " << pool_threads << '\n'
+                    << "pool_affinity = " << pool_affinity << '\n'
+                    << "work_queue_size = " << work_queue_size << '\n'
+                    << "max_reader_pool_tasks = " << max_reader_pool_tasks << '\n'
+                    << "input_queue_size = " << input_queue_size << (input_queue_size_fixed ? " (fixed)" : "") << '\n'
+                    << "osmdata_queue_size = " << osmdata_queue_size << (osmdata_queue_size_fixed ? " (fixed)" : "") << '\n'
+                    << "input_buffer_size = " << input_buffer_size << '\n'
+                    << "direct_reads = " << (direct_reads ? "yes" : "no") << '\n'
+                    << "pool_threads_for_pbf_parsing = " << (pool_threads_for_pbf_parsing ? "yes" : "no") << '\n'
+                    << "output_queue_size = " << output_queue_size << (output_queue_size_fixed ? " (fixed)" : "") << '\n';
+            }
+
+        private:
+
+            static std::size_t default_osmdata_queue_size() noexcept {
+                const std::size_t per_core_size = std::thread::hardware_concurrency() * 4u;
+                return per_core_size > 20u ? per_core_size : 20u;
+            }
+
+            static std::size_t get_input_buffer_size() noexcept {
+                const auto env = osmium::detail::getenv_wrapper("OSMIUM_INPUT_BUFFER_SIZE");
+                if (env) {
+                    const auto value = osmium::detail::str_to_int<std::size_t>(env);
+                    if (value != 0) {
+                        return value;
+                    }
+                }
+                return 1024u * 1024u;
+            }
+
+        }; // struct Tuning
+
+        /**
+         * Access the process-wide tuning registry. The registry is
+         * initialized from the environment on the first call.
+         */
+        inline Tuning& tuning() {
+            static Tuning single_instance{};
+            return single_instance;
+        }
+
+    } // namespace config
+
+} // namespace osmium
+
+#endif // OSMIUM_UTIL_TUNING_HPP
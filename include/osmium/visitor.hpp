@@ -39,9 +39,16 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm.hpp>
 #include <osmium/osm/entity.hpp>
 #include <osmium/osm/item_type.hpp>
+#include <osmium/thread/pool.hpp>
 
+#include <cstddef>
+#include <future>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -90,6 +97,9 @@ namespace osmium {
                 case osmium::item_type::inner_ring:
                     std::forward<THandler>(handler).inner_ring(static_cast<ConstIfConst<TItem, osmium::InnerRing>&>(item));
                     break;
+                case osmium::item_type::ring_directory:
+                    std::forward<THandler>(handler).ring_directory(static_cast<ConstIfConst<TItem, osmium::RingDirectory>&>(item));
+                    break;
                 case osmium::item_type::changeset_discussion:
                     std::forward<THandler>(handler).changeset_discussion(static_cast<ConstIfConst<TItem, osmium::ChangesetDiscussion>&>(item));
                     break;
@@ -234,6 +244,159 @@ namespace osmium {
         apply(buffer.cbegin(), buffer.cend(), std::forward<THandlers>(handlers)...);
     }
 
+    /**
+     * Apply a handler to a range of buffers in parallel using the given
+     * thread pool. The range [it, end) is partitioned into one chunk of
+     * buffers per pool thread, every chunk is run as one pool task with
+     * its own handler instance created by calling make_handler(). When
+     * all tasks are done, reduce() is called once per handler instance,
+     * in chunk order, on the calling thread.
+     *
+     * Only use this if your handler doesn't care about the order the
+     * objects are handled in. The handler type must be movable, the
+     * factory must be safe to call from several threads at the same
+     * time. Exceptions thrown in a handler are re-thrown here.
+     *
+     * @code
+     * std::vector<osmium::memory::Buffer> buffers = ...;
+     * std::size_t count = 0;
+     * osmium::apply_parallel(buffers.begin(), buffers.end(),
+     *     osmium::thread::Pool::default_instance(),
+     *     []() { return CountHandler{}; },
+     *     [&count](CountHandler&& handler) { count += handler.count; });
+     * @endcode
+     */
+    template <typename TIterator, typename THandlerFactory, typename TReduce>
+    inline void apply_parallel(TIterator it, TIterator end, osmium::thread::Pool& pool, THandlerFactory&& make_handler, TReduce&& reduce) {
+        using handler_type = typename std::decay<decltype(make_handler())>::type;
+
+        const auto num_buffers = std::distance(it, end);
+        if (num_buffers <= 0) {
+            return;
+        }
+
+        auto num_chunks = static_cast<std::size_t>(pool.num_threads());
+        if (num_chunks > static_cast<std::size_t>(num_buffers)) {
+            num_chunks = static_cast<std::size_t>(num_buffers);
+        }
+
+        std::vector<std::future<handler_type>> results;
+        results.reserve(num_chunks);
+
+        const auto chunk_size = (static_cast<std::size_t>(num_buffers) + num_chunks - 1) / num_chunks;
+        while (it != end) {
+            const TIterator chunk_begin = it;
+            for (std::size_t n = 0; n < chunk_size && it != end; ++n) {
+                ++it;
+            }
+            const TIterator chunk_end = it;
+            results.push_back(pool.submit([chunk_begin, chunk_end, make_handler]() mutable -> handler_type {
+                auto handler = make_handler();
+                for (TIterator b = chunk_begin; b != chunk_end; ++b) {
+                    for (const auto& item : *b) {
+                        apply_item(item, handler);
+                    }
+                }
+                apply_flush(handler);
+                return handler;
+            }));
+        }
+
+        for (auto& result : results) {
+            reduce(result.get());
+        }
+    }
+
+    /**
+     * Apply a handler to a range of buffers in parallel using the given
+     * thread pool. Like the overload with a reduce function, but the
+     * handler instances are thrown away when their chunk is done. Use
+     * this for handlers that publish their results themselves, for
+     * instance into something thread-safe like an IdSetSmall per chunk
+     * or an atomic counter.
+     */
+    template <typename TIterator, typename THandlerFactory>
+    inline void apply_parallel(TIterator it, TIterator end, osmium::thread::Pool& pool, THandlerFactory&& make_handler) {
+        using handler_type = typename std::decay<decltype(make_handler())>::type;
+        apply_parallel(it, end, pool, std::forward<THandlerFactory>(make_handler), [](handler_type&&) {});
+    }
+
+    namespace detail {
+
+        template <typename THandler>
+        inline std::future<void> submit_apply(const osmium::memory::Buffer& buffer, osmium::thread::Pool& pool, THandler& handler) {
+            return pool.submit([&buffer, &handler](){
+                osmium::apply(buffer, handler);
+            });
+        }
+
+        template <typename THandler>
+        inline std::future<void> submit_apply(const std::shared_ptr<osmium::memory::Buffer>& buffer, osmium::thread::Pool& pool, THandler& handler) {
+            return pool.submit([buffer, &handler](){
+                osmium::apply(static_cast<const osmium::memory::Buffer&>(*buffer), handler);
+            });
+        }
+
+    } // namespace detail
+
+    /**
+     * Apply all items in the buffer to each of the handlers, with every
+     * handler running as its own task in the given thread pool. A
+     * committed buffer is never changed in read paths, so independent
+     * handlers can read it concurrently and a stats + geometry +
+     * validation triple pass needs only one walk over the data instead
+     * of one per handler (or a buffer copy per handler).
+     *
+     * The handlers must not share any mutable state. Blocks until all
+     * handlers are done with the buffer; exceptions from the handlers
+     * are re-thrown here.
+     */
+    template <typename... THandlers>
+    inline void apply_fanout(const osmium::memory::Buffer& buffer, osmium::thread::Pool& pool, THandlers&... handlers) {
+        std::vector<std::future<void>> results;
+        results.reserve(sizeof...(THandlers));
+        (void)std::initializer_list<int>{
+            (results.push_back(detail::submit_apply(buffer, pool, handlers)), 0)...
+        };
+        for (auto& result : results) {
+            result.get();
+        }
+    }
+
+    /**
+     * Like apply_fanout() on a plain buffer reference, but the buffer
+     * is passed as a shared pointer that every task holds on to, and
+     * the futures are returned instead of waited for. Use this to keep
+     * feeding buffers from a reader loop without waiting for the
+     * slowest handler each time:
+     *
+     * @code
+     * while (osmium::memory::Buffer buffer = reader.read()) {
+     *     auto shared = std::make_shared<osmium::memory::Buffer>(std::move(buffer));
+     *     for (auto& f : osmium::apply_fanout(shared, pool, h1, h2)) {
+     *         futures.push_back(std::move(f));
+     *     }
+     * }
+     * @endcode
+     *
+     * The buffer stays alive until the last task is done with it. The
+     * handlers must outlive the returned futures and must not share any
+     * mutable state; note that each handler still handles only one
+     * buffer at a time only if the caller waits for its previous future
+     * before submitting the next buffer to it, otherwise the same
+     * handler can run concurrently with itself. Call get() on the
+     * futures to re-throw any exceptions.
+     */
+    template <typename... THandlers>
+    inline std::vector<std::future<void>> apply_fanout(const std::shared_ptr<osmium::memory::Buffer>& buffer, osmium::thread::Pool& pool, THandlers&... handlers) {
+        std::vector<std::future<void>> results;
+        results.reserve(sizeof...(THandlers));
+        (void)std::initializer_list<int>{
+            (results.push_back(detail::submit_apply(buffer, pool, handlers)), 0)...
+        };
+        return results;
+    }
+
 } // namespace osmium
 
 #endif // OSMIUM_VISITOR_HPP
@@ -0,0 +1,102 @@
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2018 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/*
+ * This is the only translation unit of the optional compiled osmium-io
+ * library (CMake option BUILD_IO_LIBRARY). It pulls in the complete
+ * parser and encoder stack for all supported formats so the code is
+ * generated exactly once, with the flags of the library build, behind
+ * the stable entry points declared in osmium/io/compiled_io.hpp.
+ */
+
+#include <osmium/io/any_input.hpp>
+#include <osmium/io/any_output.hpp>
+#include <osmium/io/compiled_io.hpp>
+
+#include <utility>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace compiled {
+
+            osmium::io::Header read_header(const osmium::io::File& file) {
+                osmium::io::Reader reader{file, osmium::osm_entity_bits::nothing};
+                osmium::io::Header header{reader.header()};
+                reader.close();
+                return header;
+            }
+
+            std::vector<osmium::memory::Buffer> read_file(const osmium::io::File& file,
+                                                          const osmium::osm_entity_bits::type entities) {
+                std::vector<osmium::memory::Buffer> buffers;
+
+                osmium::io::Reader reader{file, entities};
+                while (osmium::memory::Buffer buffer = reader.read()) {
+                    buffers.push_back(std::move(buffer));
+                }
+                reader.close();
+
+                return buffers;
+            }
+
+            void for_each_buffer(const osmium::io::File& file,
+                                 const std::function<void(osmium::memory::Buffer&)>& callback,
+                                 const osmium::osm_entity_bits::type entities) {
+                osmium::io::Reader reader{file, entities};
+                while (osmium::memory::Buffer buffer = reader.read()) {
+                    callback(buffer);
+                }
+                reader.close();
+            }
+
+            void write_file(const osmium::io::File& file,
+                            const osmium::io::Header& header,
+                            const std::vector<osmium::memory::Buffer>& buffers) {
+                osmium::io::Writer writer{file, header, osmium::io::overwrite::allow};
+                for (const auto& buffer : buffers) {
+                    if (buffer.committed() > 0) {
+                        osmium::memory::Buffer copy{buffer.committed()};
+                        copy.add_buffer(buffer);
+                        copy.commit();
+                        writer(std::move(copy));
+                    }
+                }
+                writer.close();
+            }
+
+        } // namespace compiled
+
+    } // namespace io
+
+} // namespace osmium
@@ -4,6 +4,7 @@
 #include <osmium/builder/attr.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/area.hpp>
+#include <osmium/osm/relation.hpp>
 
 using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
 
@@ -141,3 +142,88 @@ TEST_CASE("Build area from way with ignored invalid location") {
     REQUIRE(s.invalid_locations == 1);
 }
 
+
+TEST_CASE("Build area with ring directory") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto wpos = osmium::builder::add_way(buffer,
+        _id(1),
+        _nodes({
+            {1, {1.0, 1.0}},
+            {2, {1.0, 2.0}},
+            {3, {2.0, 2.0}},
+            {4, {2.0, 1.0}},
+            {1, {1.0, 1.0}}
+        })
+    );
+
+    osmium::area::AssemblerConfig config;
+    config.create_ring_directory = true;
+    osmium::area::Assembler assembler{config};
+
+    osmium::memory::Buffer area_buffer{10240};
+    REQUIRE(assembler(buffer.get<osmium::Way>(wpos), area_buffer));
+
+    const auto& area = area_buffer.get<osmium::Area>(0);
+    REQUIRE(area.id() == 2);
+
+    const auto* directory = area.ring_directory();
+    REQUIRE(directory != nullptr);
+    REQUIRE(directory->size() == 1);
+
+    const auto& entry = (*directory)[0];
+    REQUIRE(entry.num_nodes == 5);
+    REQUIRE(entry.envelope.bottom_left() == osmium::Location(1.0, 1.0));
+    REQUIRE(entry.envelope.top_right() == osmium::Location(2.0, 2.0));
+
+    const auto& ring = area.ring(entry);
+    REQUIRE(ring.type() == osmium::item_type::outer_ring);
+    REQUIRE(ring.size() == 5);
+    REQUIRE(ring.front().ref() == 1);
+
+    REQUIRE(directory->envelope() == area.envelope());
+
+    // the directory does not confuse the ring counting
+    REQUIRE(area.num_rings().first == 1);
+    REQUIRE(area.num_rings().second == 0);
+}
+
+TEST_CASE("Without the config option no ring directory is created") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto wpos = osmium::builder::add_way(buffer,
+        _id(1),
+        _nodes({
+            {1, {1.0, 1.0}},
+            {2, {1.0, 2.0}},
+            {3, {2.0, 2.0}},
+            {1, {1.0, 1.0}}
+        })
+    );
+
+    osmium::area::AssemblerConfig config;
+    osmium::area::Assembler assembler{config};
+
+    osmium::memory::Buffer area_buffer{10240};
+    REQUIRE(assembler(buffer.get<osmium::Way>(wpos), area_buffer));
+
+    const auto& area = area_buffer.get<osmium::Area>(0);
+    REQUIRE(area.ring_directory() == nullptr);
+}
+
+TEST_CASE("Assembler tells the manager which relations to ignore") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto rpos = osmium::builder::add_relation(buffer,
+        _id(1),
+        _tag("type", "multipolygon"),
+        _tag("landuse", "forest")
+    );
+    const auto& relation = buffer.get<osmium::Relation>(rpos);
+
+    osmium::area::AssemblerConfig config;
+    REQUIRE(osmium::area::Assembler::relation_can_produce_area(relation, config));
+
+    config.create_new_style_polygons = false;
+    REQUIRE_FALSE(osmium::area::Assembler::relation_can_produce_area(relation, config));
+}
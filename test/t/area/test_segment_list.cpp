@@ -0,0 +1,165 @@
+#include "catch.hpp"
+
+#include <osmium/area/detail/segment_list.hpp>
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+using osmium::area::detail::SegmentList;
+
+TEST_CASE("SegmentList finds intersections") {
+    // Build pairs of crossing segments ("X" shapes), each pair well away
+    // from all the others, so each pair contributes exactly one
+    // intersection. With enough pairs this also exercises the sweep-based
+    // intersection check used for large segment lists.
+    const int num_crossings = 60;
+
+    osmium::memory::Buffer buffer{1024ul * 1024ul};
+
+    int64_t id = 1;
+    for (int n = 0; n < num_crossings; ++n) {
+        const double x = n * 1.0;
+        osmium::builder::add_way(buffer,
+            _id(id++),
+            _nodes({
+                {id * 10,     {x,       0.0}},
+                {id * 10 + 1, {x + 0.4, 0.4}}
+            })
+        );
+        osmium::builder::add_way(buffer,
+            _id(id++),
+            _nodes({
+                {id * 10,     {x,       0.4}},
+                {id * 10 + 1, {x + 0.4, 0.0}}
+            })
+        );
+    }
+
+    SegmentList list{false};
+    uint64_t duplicate_nodes = 0;
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        REQUIRE(list.extract_segments_from_way(nullptr, duplicate_nodes, way) == 0);
+    }
+    REQUIRE(duplicate_nodes == 0);
+    REQUIRE(list.size() == 2 * num_crossings);
+
+    list.sort();
+
+    REQUIRE(list.find_intersections(nullptr) == num_crossings);
+}
+
+TEST_CASE("SegmentList radix sort produces comparison order") {
+    osmium::memory::Buffer buffer{4ul * 1024ul * 1024ul};
+
+    // More than 1024 segments, so the radix sort is used. The "fans" of
+    // segments starting at the same location exercise the ordering by
+    // slope between segments with equal first location.
+    int64_t id = 1;
+    for (int f = 0; f < 100; ++f) {
+        const double x = f * 0.01 - 0.5;
+        const double y = -f * 0.01;
+        for (int s = 0; s < 8; ++s) {
+            osmium::builder::add_way(buffer,
+                _id(id++),
+                _nodes({
+                    {id * 10,     {x, y}},
+                    {id * 10 + 1, {x + (s + 1) * 0.001, y + (8 - s) * 0.001}}
+                })
+            );
+        }
+    }
+    for (int n = 0; n < 700; ++n) {
+        const double x = (n % 37) * 0.1 - 1.8;
+        const double y = (n % 53) * 0.1 - 2.6;
+        osmium::builder::add_way(buffer,
+            _id(id++),
+            _nodes({
+                {id * 10,     {x, y}},
+                {id * 10 + 1, {x + 0.05, y - 0.03}}
+            })
+        );
+    }
+
+    SegmentList list{false};
+    uint64_t duplicate_nodes = 0;
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        list.extract_segments_from_way(nullptr, duplicate_nodes, way);
+    }
+    REQUIRE(list.size() == 1500);
+
+    list.sort();
+
+    REQUIRE(std::is_sorted(list.begin(), list.end()));
+}
+
+TEST_CASE("SegmentList erases duplicate segments") {
+    osmium::memory::Buffer buffer{1024ul * 1024ul};
+
+    // Three ways with the same two node locations create a run of three
+    // duplicate segments: two are removed, one remains. A fourth way
+    // somewhere else is untouched.
+    for (int64_t id = 1; id <= 3; ++id) {
+        osmium::builder::add_way(buffer,
+            _id(id),
+            _nodes({
+                {1, {0.0, 0.0}},
+                {2, {1.0, 1.0}}
+            })
+        );
+    }
+    osmium::builder::add_way(buffer,
+        _id(4),
+        _nodes({
+            {3, {2.0, 2.0}},
+            {4, {3.0, 3.0}}
+        })
+    );
+
+    SegmentList list{false};
+    uint64_t duplicate_nodes = 0;
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        list.extract_segments_from_way(nullptr, duplicate_nodes, way);
+    }
+    REQUIRE(list.size() == 4);
+
+    list.sort();
+
+    uint64_t duplicate_segments = 0;
+    uint64_t overlapping_segments = 0;
+    list.erase_duplicate_segments(nullptr, duplicate_segments, overlapping_segments);
+
+    REQUIRE(list.size() == 2);
+    REQUIRE(duplicate_segments == 1);
+    REQUIRE(overlapping_segments == 1);
+}
+
+TEST_CASE("SegmentList without intersections") {
+    osmium::memory::Buffer buffer{1024ul * 1024ul};
+
+    // Parallel segments, overlapping in their x range.
+    int64_t id = 1;
+    for (int n = 0; n < 200; ++n) {
+        osmium::builder::add_way(buffer,
+            _id(id++),
+            _nodes({
+                {id * 10,     {0.0, n * 0.1}},
+                {id * 10 + 1, {1.0, n * 0.1 + 0.05}}
+            })
+        );
+    }
+
+    SegmentList list{false};
+    uint64_t duplicate_nodes = 0;
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        REQUIRE(list.extract_segments_from_way(nullptr, duplicate_nodes, way) == 0);
+    }
+
+    list.sort();
+
+    REQUIRE(list.find_intersections(nullptr) == 0);
+}
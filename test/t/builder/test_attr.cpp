@@ -573,3 +573,64 @@ TEST_CASE("create area using builders") {
 
 }
 
+
+TEST_CASE("size estimate covers the whole object") {
+
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    // The estimate computed from the attribute pack presizes the
+    // buffer, so building the object must never need more space than
+    // the estimate said.
+    const std::vector<std::pair<const char*, const char*>> tags = {
+        {"highway", "primary"},
+        {"name", "High Street"},
+        {"oneway", "yes"}
+    };
+
+    SECTION("node") {
+        const auto estimate = osmium::builder::detail::estimated_entity_size<osmium::Node>(
+            _id(17), _user("some_user_name"), _tags(tags), _location(1.2, 3.4));
+
+        osmium::memory::Buffer buffer{1024 * 10};
+        const auto committed_before = buffer.committed();
+        osmium::builder::add_node(buffer,
+            _id(17), _user("some_user_name"), _tags(tags), _location(1.2, 3.4));
+
+        REQUIRE(buffer.committed() - committed_before <= estimate);
+    }
+
+    SECTION("way") {
+        const auto estimate = osmium::builder::detail::estimated_entity_size<osmium::Way>(
+            _id(1), _user("u"), _tags(tags), _nodes({1, 2, 3, 4, 5}));
+
+        osmium::memory::Buffer buffer{1024 * 10};
+        const auto committed_before = buffer.committed();
+        osmium::builder::add_way(buffer,
+            _id(1), _user("u"), _tags(tags), _nodes({1, 2, 3, 4, 5}));
+
+        REQUIRE(buffer.committed() - committed_before <= estimate);
+    }
+
+    SECTION("relation") {
+        const auto estimate = osmium::builder::detail::estimated_entity_size<osmium::Relation>(
+            _id(1), _user("u"), _member(osmium::item_type::way, 113, "outer"));
+
+        osmium::memory::Buffer buffer{1024 * 10};
+        const auto committed_before = buffer.committed();
+        osmium::builder::add_relation(buffer,
+            _id(1), _user("u"), _member(osmium::item_type::way, 113, "outer"));
+
+        REQUIRE(buffer.committed() - committed_before <= estimate);
+    }
+
+    SECTION("building into a minimal presized buffer needs no growth") {
+        osmium::memory::Buffer buffer{64, osmium::memory::Buffer::auto_grow::yes};
+        const auto pos = osmium::builder::add_way(buffer,
+            _id(1), _user("longer_user_name_here"), _tags(tags), _nodes({1, 2, 3, 4, 5, 6, 7, 8}));
+
+        const auto& way = buffer.get<osmium::Way>(pos);
+        REQUIRE(way.id() == 1);
+        REQUIRE(way.tags().size() == 3);
+        REQUIRE(way.nodes().size() == 8);
+    }
+}
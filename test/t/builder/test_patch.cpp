@@ -0,0 +1,154 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/builder/patch.hpp>
+#include <osmium/memory/buffer.hpp>
+
+#include <string>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+TEST_CASE("Patch a node") {
+    osmium::memory::Buffer buffer{1024 * 10};
+    osmium::builder::add_node(buffer,
+        _id(1),
+        _version(2),
+        _cid(3),
+        _uid(4),
+        _user("foo"),
+        _timestamp(time_t(100)),
+        _location(1.0, 2.0),
+        _tag("highway", "primary"),
+        _tag("name", "High Street"));
+    const osmium::Node& source = buffer.get<osmium::Node>(0);
+
+    osmium::memory::Buffer target{1024 * 10};
+
+    SECTION("empty patch copies the object unchanged") {
+        const osmium::builder::Patch patch;
+        const auto pos = patch.apply(target, source);
+
+        const osmium::Node& node = target.get<osmium::Node>(pos);
+        REQUIRE(node.id() == 1);
+        REQUIRE(node.version() == 2);
+        REQUIRE(node.changeset() == 3);
+        REQUIRE(node.uid() == 4);
+        REQUIRE(std::string{node.user()} == "foo");
+        REQUIRE(node.timestamp() == osmium::Timestamp{time_t(100)});
+        REQUIRE(node.location() == osmium::Location(1.0, 2.0));
+        REQUIRE(node.tags().size() == 2);
+        REQUIRE(std::string{node.tags()["highway"]} == "primary");
+    }
+
+    SECTION("replace one tag, keep the rest") {
+        osmium::builder::Patch patch;
+        patch.set_tag("highway", "secondary");
+        const auto pos = patch.apply(target, source);
+
+        const osmium::Node& node = target.get<osmium::Node>(pos);
+        REQUIRE(node.tags().size() == 2);
+        REQUIRE(std::string{node.tags()["highway"]} == "secondary");
+        REQUIRE(std::string{node.tags()["name"]} == "High Street");
+    }
+
+    SECTION("add and remove tags") {
+        osmium::builder::Patch patch;
+        patch.set_tag("oneway", "yes").remove_tag("name");
+        const auto pos = patch.apply(target, source);
+
+        const osmium::Node& node = target.get<osmium::Node>(pos);
+        REQUIRE(node.tags().size() == 2);
+        REQUIRE(std::string{node.tags()["oneway"]} == "yes");
+        REQUIRE(node.tags()["name"] == nullptr);
+    }
+
+    SECTION("clear tags and field overrides") {
+        osmium::builder::Patch patch;
+        patch.clear_tags()
+             .set_version(3)
+             .set_user("bar")
+             .set_location(osmium::Location{5.0, 6.0})
+             .set_visible(false);
+        const auto pos = patch.apply(target, source);
+
+        const osmium::Node& node = target.get<osmium::Node>(pos);
+        REQUIRE(node.tags().empty());
+        REQUIRE(node.version() == 3);
+        REQUIRE(std::string{node.user()} == "bar");
+        REQUIRE(node.location() == osmium::Location(5.0, 6.0));
+        REQUIRE_FALSE(node.visible());
+        REQUIRE(node.id() == 1); // untouched fields stay
+    }
+}
+
+TEST_CASE("Patch a way keeps the node refs") {
+    osmium::memory::Buffer buffer{1024 * 10};
+    osmium::builder::add_way(buffer,
+        _id(17),
+        _nodes({1, 2, 3}),
+        _tag("highway", "primary"));
+    const osmium::Way& source = buffer.get<osmium::Way>(0);
+
+    osmium::memory::Buffer target{1024 * 10};
+    osmium::builder::Patch patch;
+    patch.set_tag("highway", "tertiary");
+    const auto pos = osmium::builder::add_patched_object(target, source, patch);
+
+    const osmium::Way& way = target.get<osmium::Way>(pos);
+    REQUIRE(way.id() == 17);
+    REQUIRE(way.nodes().size() == 3);
+    REQUIRE(way.nodes()[1].ref() == 2);
+    REQUIRE(std::string{way.tags()["highway"]} == "tertiary");
+}
+
+TEST_CASE("Patch a relation") {
+    osmium::memory::Buffer buffer{1024 * 10};
+    osmium::builder::add_relation(buffer,
+        _id(21),
+        _member(osmium::item_type::way, 42, "outer"),
+        _tag("type", "multipolygon"));
+    const osmium::Relation& source = buffer.get<osmium::Relation>(0);
+
+    osmium::memory::Buffer target{1024 * 10};
+
+    SECTION("add a member, members are appended") {
+        osmium::builder::Patch patch;
+        patch.add_member(osmium::item_type::way, 43, "inner");
+        const auto pos = patch.apply(target, source);
+
+        const osmium::Relation& relation = target.get<osmium::Relation>(pos);
+        REQUIRE(relation.members().size() == 2);
+        auto it = relation.members().begin();
+        REQUIRE(it->ref() == 42);
+        REQUIRE(std::string{it->role()} == "outer");
+        ++it;
+        REQUIRE(it->ref() == 43);
+        REQUIRE(std::string{it->role()} == "inner");
+        REQUIRE(std::string{relation.tags()["type"]} == "multipolygon");
+    }
+
+    SECTION("tags only, member list copied verbatim") {
+        osmium::builder::Patch patch;
+        patch.set_tag("type", "boundary");
+        const auto pos = patch.apply(target, source);
+
+        const osmium::Relation& relation = target.get<osmium::Relation>(pos);
+        REQUIRE(relation.members().size() == 1);
+        REQUIRE(std::string{relation.tags()["type"]} == "boundary");
+    }
+}
+
+TEST_CASE("Patch adds tags to an object without any") {
+    osmium::memory::Buffer buffer{1024 * 10};
+    osmium::builder::add_node(buffer, _id(7), _location(1.0, 1.0));
+    const osmium::Node& source = buffer.get<osmium::Node>(0);
+
+    osmium::memory::Buffer target{1024 * 10};
+    osmium::builder::Patch patch;
+    patch.set_tag("amenity", "bench");
+    const auto pos = patch.apply(target, source);
+
+    const osmium::Node& node = target.get<osmium::Node>(pos);
+    REQUIRE(node.tags().size() == 1);
+    REQUIRE(std::string{node.tags()["amenity"]} == "bench");
+}
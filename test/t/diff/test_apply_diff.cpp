@@ -0,0 +1,134 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/diff_visitor.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+    // records one line per diff object: "type/id/version/first/last"
+    struct RecordingHandler {
+
+        std::vector<std::string> records{};
+
+        void record(const osmium::DiffObject& diff) {
+            records.push_back(std::string{osmium::item_type_to_char(diff.type())} + '/' +
+                              std::to_string(diff.id()) + '/' +
+                              std::to_string(diff.version()) + '/' +
+                              (diff.first() ? "f" : "-") +
+                              (diff.last() ? "l" : "-"));
+        }
+
+        void node(const osmium::DiffNode& diff) {
+            record(diff);
+        }
+
+        void way(const osmium::DiffWay& diff) {
+            record(diff);
+        }
+
+        void relation(const osmium::DiffRelation& diff) {
+            record(diff);
+        }
+
+    }; // struct RecordingHandler
+
+    void add_test_objects(osmium::memory::Buffer& buffer) {
+        osmium::builder::add_node(buffer, _id(1), _version(1));
+        osmium::builder::add_node(buffer, _id(1), _version(2));
+        osmium::builder::add_node(buffer, _id(2), _version(1));
+        osmium::builder::add_node(buffer, _id(3), _version(1));
+        osmium::builder::add_node(buffer, _id(3), _version(2));
+        osmium::builder::add_node(buffer, _id(3), _version(3));
+        osmium::builder::add_way(buffer, _id(1), _version(1));
+        osmium::builder::add_way(buffer, _id(1), _version(2));
+    }
+
+    std::vector<std::string> expected_records() {
+        osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+        add_test_objects(buffer);
+        RecordingHandler handler;
+        {
+            const auto objects = buffer.select<osmium::OSMObject>();
+            osmium::apply_diff(objects.cbegin(), objects.cend(), handler);
+        }
+        return handler.records;
+    }
+
+    std::vector<std::string> merge_and_sort(const std::vector<RecordingHandler>& handlers) {
+        std::vector<std::string> all;
+        for (const auto& handler : handlers) {
+            all.insert(all.end(), handler.records.begin(), handler.records.end());
+        }
+        std::sort(all.begin(), all.end());
+        return all;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("Parallel apply_diff on a buffer gives the same diff objects") {
+    osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+    add_test_objects(buffer);
+
+    auto expected = expected_records();
+    REQUIRE(expected.size() == 8);
+    std::sort(expected.begin(), expected.end());
+
+    osmium::thread::Pool pool{4};
+    std::vector<RecordingHandler> handlers{3};
+    osmium::apply_diff(buffer, pool, handlers);
+
+    REQUIRE(merge_and_sort(handlers) == expected);
+}
+
+namespace {
+
+    // a source handing out prepared buffers like an osmium::io::Reader
+    struct BufferSource {
+
+        std::vector<osmium::memory::Buffer> buffers;
+        std::size_t index = 0;
+
+        osmium::memory::Buffer read() {
+            if (index >= buffers.size()) {
+                return osmium::memory::Buffer{};
+            }
+            return std::move(buffers[index++]);
+        }
+
+    }; // struct BufferSource
+
+} // anonymous namespace
+
+TEST_CASE("Parallel apply_diff carries version runs across buffer boundaries") {
+    // the version run of node 3 is torn across the first and second
+    // buffer, the way versions are alone in the third buffer
+    BufferSource source;
+    source.buffers.emplace_back(1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes);
+    osmium::builder::add_node(source.buffers.back(), _id(1), _version(1));
+    osmium::builder::add_node(source.buffers.back(), _id(1), _version(2));
+    osmium::builder::add_node(source.buffers.back(), _id(2), _version(1));
+    osmium::builder::add_node(source.buffers.back(), _id(3), _version(1));
+    source.buffers.emplace_back(1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes);
+    osmium::builder::add_node(source.buffers.back(), _id(3), _version(2));
+    osmium::builder::add_node(source.buffers.back(), _id(3), _version(3));
+    source.buffers.emplace_back(1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes);
+    osmium::builder::add_way(source.buffers.back(), _id(1), _version(1));
+    osmium::builder::add_way(source.buffers.back(), _id(1), _version(2));
+
+    auto expected = expected_records();
+    std::sort(expected.begin(), expected.end());
+
+    osmium::thread::Pool pool{4};
+    std::vector<RecordingHandler> handlers{2};
+    osmium::apply_diff(source, pool, handlers);
+
+    REQUIRE(merge_and_sort(handlers) == expected);
+}
@@ -0,0 +1,124 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/geom/batch.hpp>
+#include <osmium/memory/buffer.hpp>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+    osmium::memory::Buffer build_test_data() {
+        osmium::memory::Buffer buffer{1024 * 10};
+        osmium::builder::add_node(buffer, _id(1), _location(3.2, 4.2));
+        osmium::builder::add_way(buffer, _id(10), _nodes({
+            {1, osmium::Location{0.0, 0.0}},
+            {2, osmium::Location{0.0, 1.0}},
+            {3, osmium::Location{1.0, 1.0}}
+        }));
+        return buffer;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("Coordinate batch extraction") {
+    const auto buffer = build_test_data();
+
+    osmium::geom::CoordinateBatch batch;
+    batch.add_buffer(buffer);
+
+    REQUIRE(batch.size() == 2);
+    REQUIRE(batch.coordinates_size() == 4);
+    REQUIRE(batch.entries()[0].id == 1);
+    REQUIRE(batch.entries()[0].count == 1);
+    REQUIRE(batch.entries()[1].id == 10);
+    REQUIRE(batch.entries()[1].offset == 1);
+    REQUIRE(batch.entries()[1].count == 3);
+    REQUIRE(batch.x()[0] == Approx(3.2));
+    REQUIRE(batch.y()[3] == Approx(1.0));
+
+    batch.clear();
+    REQUIRE(batch.empty());
+}
+
+TEST_CASE("Nodes without location are not added to a batch") {
+    osmium::memory::Buffer buffer{1024 * 10};
+    osmium::builder::add_node(buffer, _id(1));
+
+    osmium::geom::CoordinateBatch batch;
+    batch.add_buffer(buffer);
+    REQUIRE(batch.empty());
+}
+
+TEST_CASE("Batch engine with CPU backend") {
+    const auto buffer = build_test_data();
+
+    osmium::geom::BatchEngine engine;
+
+    SECTION("mercator projection matches the scalar functions") {
+        osmium::geom::CoordinateBatch batch;
+        batch.add_buffer(buffer);
+
+        const auto projected = engine.project_web_mercator(std::move(batch)).get();
+        REQUIRE(projected.x()[0] == Approx(osmium::geom::detail::lon_to_x(3.2)));
+        REQUIRE(projected.y()[0] == Approx(osmium::geom::detail::lat_to_y(4.2)));
+    }
+
+    SECTION("haversine lengths match the scalar function") {
+        osmium::geom::CoordinateBatch batch;
+        batch.add_buffer(buffer);
+
+        const auto lengths = engine.haversine_lengths(std::move(batch)).get();
+        REQUIRE(lengths.size() == 2);
+        REQUIRE(lengths[0].first == 1);
+        REQUIRE(lengths[0].second == Approx(0.0));
+        REQUIRE(lengths[1].first == 10);
+
+        const osmium::Way& way = *buffer.select<osmium::Way>().begin();
+        REQUIRE(lengths[1].second == Approx(osmium::geom::haversine::distance(way.nodes())));
+    }
+
+    SECTION("envelopes") {
+        osmium::geom::CoordinateBatch batch;
+        batch.add_buffer(buffer);
+
+        const auto boxes = engine.envelopes(std::move(batch)).get();
+        REQUIRE(boxes.size() == 2);
+        REQUIRE(boxes[1].first == 10);
+        REQUIRE(boxes[1].second.bottom_left() == osmium::Location(0.0, 0.0));
+        REQUIRE(boxes[1].second.top_right() == osmium::Location(1.0, 1.0));
+    }
+}
+
+TEST_CASE("Batch engine with a custom backend") {
+    // A backend that "projects" everything to zero, standing in for an
+    // out-of-tree device implementation.
+    class ZeroBackend final : public osmium::geom::BatchBackend {
+    public:
+        void project_web_mercator(osmium::geom::CoordinateBatch& batch) override {
+            for (std::size_t i = 0; i < batch.coordinates_size(); ++i) {
+                batch.x()[i] = 0.0;
+                batch.y()[i] = 0.0;
+            }
+        }
+        void haversine_lengths(const osmium::geom::CoordinateBatch& batch, double* lengths) override {
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                lengths[i] = 0.0;
+            }
+        }
+        void envelopes(const osmium::geom::CoordinateBatch& batch, osmium::Box* boxes) override {
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                boxes[i] = osmium::Box{};
+            }
+        }
+    };
+
+    const auto buffer = build_test_data();
+    osmium::geom::CoordinateBatch batch;
+    batch.add_buffer(buffer);
+
+    ZeroBackend backend;
+    osmium::geom::BatchEngine engine{backend};
+    const auto projected = engine.project_web_mercator(std::move(batch)).get();
+    REQUIRE(projected.x()[0] == Approx(0.0));
+}
@@ -0,0 +1,33 @@
+#include "catch.hpp"
+
+#include "wnl_helper.hpp"
+
+#include <osmium/geom/haversine.hpp>
+
+TEST_CASE("Haversine distance between coordinates") {
+    const osmium::geom::Coordinates c1{13.377, 52.516}; // Berlin
+    const osmium::geom::Coordinates c2{2.350, 48.857}; // Paris
+
+    REQUIRE(osmium::geom::haversine::distance(c1, c2) == Approx(879065).epsilon(0.01));
+    REQUIRE(osmium::geom::haversine::distance(c1, c1) == Approx(0.0));
+}
+
+TEST_CASE("Haversine distance of way node list") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+
+    const double d12 = osmium::geom::haversine::distance(osmium::geom::Coordinates{3.2, 4.2}, osmium::geom::Coordinates{3.5, 4.7});
+    const double d23 = osmium::geom::haversine::distance(osmium::geom::Coordinates{3.5, 4.7}, osmium::geom::Coordinates{3.6, 4.9});
+
+    REQUIRE(osmium::geom::haversine::distance(wnl) == Approx(d12 + d23));
+}
+
+TEST_CASE("Approximate distance is close to haversine distance") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+
+    const double exact = osmium::geom::haversine::distance(wnl);
+    const double approx = osmium::geom::haversine::approximate_distance(wnl);
+
+    REQUIRE(approx == Approx(exact).epsilon(0.0001));
+}
@@ -1,6 +1,12 @@
 #include "catch.hpp"
 
+#include <osmium/builder/attr.hpp>
 #include <osmium/geom/mercator_projection.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <cstddef>
+#include <vector>
 
 TEST_CASE("Mercator projection") {
     const osmium::geom::MercatorProjection projection;
@@ -25,6 +31,48 @@ TEST_CASE("Low level mercator functions") {
     REQUIRE(r3.y == Approx(c3.y).epsilon(0.000001));
 }
 
+TEST_CASE("Batch mercator projection") {
+    std::vector<osmium::geom::Coordinates> coordinates{
+        osmium::geom::Coordinates{17.839, -3.249},
+        osmium::geom::Coordinates{-89.2, 15.915},
+        osmium::geom::Coordinates{180.0, 85.0},
+        osmium::geom::Coordinates{0.0, 0.0},
+        osmium::geom::Coordinates{13.377, 52.516}
+    };
+
+    std::vector<osmium::geom::Coordinates> batch{coordinates};
+    osmium::geom::lonlat_to_mercator(batch.data(), batch.size());
+
+    for (std::size_t i = 0; i < coordinates.size(); ++i) {
+        const auto c = osmium::geom::lonlat_to_mercator(coordinates[i]);
+        REQUIRE(batch[i].x == c.x);
+        REQUIRE(batch[i].y == c.y);
+    }
+}
+
+TEST_CASE("Batch mercator projection of node ref list") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto wpos = osmium::builder::add_way(buffer,
+        osmium::builder::attr::_nodes({
+            {1, {1.1, 1.2}},
+            {2, {2.1, 2.2}},
+            {3, {3.1, 3.2}}
+        })
+    );
+    const auto& nodes = buffer.get<osmium::Way>(wpos).nodes();
+
+    std::vector<osmium::geom::Coordinates> coordinates;
+    osmium::geom::lonlat_to_mercator(nodes, coordinates);
+
+    REQUIRE(coordinates.size() == 3);
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        const auto c = osmium::geom::lonlat_to_mercator(osmium::geom::Coordinates{nodes[i].lon(), nodes[i].lat()});
+        REQUIRE(coordinates[i].x == c.x);
+        REQUIRE(coordinates[i].y == c.y);
+    }
+}
+
 TEST_CASE("Mercator bounds") {
     const osmium::Location mmax{180.0, osmium::geom::MERCATOR_MAX_LAT};
     const osmium::geom::Coordinates c = osmium::geom::lonlat_to_mercator(mmax);
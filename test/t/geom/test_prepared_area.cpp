@@ -0,0 +1,75 @@
+#include "catch.hpp"
+
+#include "area_helper.hpp"
+
+#include <osmium/geom/prepared_area.hpp>
+#include <osmium/memory/buffer.hpp>
+
+TEST_CASE("PreparedArea from area with one outer ring") {
+    osmium::memory::Buffer buffer{10000};
+    const osmium::Area& area = create_test_area_1outer_0inner(buffer);
+
+    const osmium::geom::PreparedArea prepared{area};
+    REQUIRE_FALSE(prepared.empty());
+    REQUIRE(prepared.envelope() == area.envelope());
+
+    REQUIRE(prepared.contains(osmium::Location(3.435, 4.6)));
+    REQUIRE_FALSE(prepared.contains(osmium::Location(3.3, 4.8)));
+    REQUIRE_FALSE(prepared.contains(osmium::Location(1.0, 1.0)));
+    REQUIRE_FALSE(prepared.contains(osmium::Location(3.45, 5.5)));
+}
+
+TEST_CASE("PreparedArea respects holes") {
+    osmium::memory::Buffer buffer{10000};
+    const osmium::Area& area = create_test_area_1outer_1inner(buffer);
+
+    const osmium::geom::PreparedArea prepared{area};
+
+    // between outer and inner ring
+    REQUIRE(prepared.contains(osmium::Location(0.5, 0.5)));
+    REQUIRE(prepared.contains(osmium::Location(8.5, 8.5)));
+    REQUIRE(prepared.contains(osmium::Location(0.5, 5.0)));
+
+    // in the hole
+    REQUIRE_FALSE(prepared.contains(osmium::Location(4.5, 4.5)));
+    REQUIRE_FALSE(prepared.contains(osmium::Location(1.5, 7.5)));
+
+    // outside
+    REQUIRE_FALSE(prepared.contains(osmium::Location(9.5, 5.0)));
+    REQUIRE_FALSE(prepared.contains(osmium::Location(0.0, 0.0)));
+}
+
+TEST_CASE("PreparedArea with multipolygon matches simple box checks") {
+    osmium::memory::Buffer buffer{10000};
+    const osmium::Area& area = create_test_area_2outer_2inner(buffer);
+
+    const osmium::geom::PreparedArea prepared{area};
+
+    // in the second outer ring
+    REQUIRE(prepared.contains(osmium::Location(10.5, 10.5)));
+
+    // between the two outer rings
+    REQUIRE_FALSE(prepared.contains(osmium::Location(9.5, 9.5)));
+
+    // The first outer ring is the box (0.1, 0.1)-(9.1, 9.1) with a
+    // square hole (1, 1)-(4, 4) and a triangular hole, so membership
+    // on a grid away from the triangle can be computed from the
+    // coordinates alone. The grid is chosen so no point lies exactly
+    // on a ring, where the result would be ambiguous.
+    for (double x = -0.875; x < 5.0; x += 0.25) {
+        for (double y = -0.875; y < 5.0; y += 0.25) {
+            const bool in_outer = x > 0.1 && x < 9.1 && y > 0.1 && y < 9.1;
+            const bool in_hole = x > 1.0 && x < 4.0 && y > 1.0 && y < 4.0;
+            REQUIRE(prepared.contains(osmium::Location(x, y)) == (in_outer && !in_hole));
+        }
+    }
+}
+
+TEST_CASE("PreparedArea from empty area") {
+    osmium::memory::Buffer buffer{10000};
+    osmium::builder::add_area(buffer, _user("foo"));
+
+    const osmium::geom::PreparedArea prepared{buffer.get<osmium::Area>(0)};
+    REQUIRE(prepared.empty());
+    REQUIRE_FALSE(prepared.contains(osmium::Location(1.0, 1.0)));
+}
@@ -0,0 +1,104 @@
+#include "catch.hpp"
+
+#include "wnl_helper.hpp"
+
+#include <osmium/geom/rapid_geojson.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/util/double.hpp>
+
+#include <string>
+
+namespace {
+
+    // Minimal writer with the part of the RapidJSON handler interface
+    // used by the factory, collecting the output in a string.
+    class FakeWriter {
+
+        std::string m_data;
+        int m_max_decimal_places = -1;
+
+        void next_value() {
+            if (!m_data.empty()) {
+                const char c = m_data.back();
+                if (c != '[' && c != '{') {
+                    m_data += ',';
+                }
+            }
+        }
+
+    public:
+
+        void SetMaxDecimalPlaces(int precision) {
+            m_max_decimal_places = precision;
+        }
+
+        void StartObject() {
+            next_value();
+            m_data += '{';
+        }
+
+        void EndObject() {
+            m_data += '}';
+        }
+
+        void StartArray() {
+            next_value();
+            m_data += '[';
+        }
+
+        void EndArray() {
+            m_data += ']';
+        }
+
+        void String(const char* str, unsigned int length, bool /*copy*/ = false) {
+            next_value();
+            m_data += '"';
+            m_data.append(str, length);
+            m_data += '"';
+        }
+
+        void Double(double value) {
+            next_value();
+            osmium::double2string(m_data, value, m_max_decimal_places >= 0 ? m_max_decimal_places : 7);
+        }
+
+        const std::string& data() const noexcept {
+            return m_data;
+        }
+
+        int max_decimal_places() const noexcept {
+            return m_max_decimal_places;
+        }
+
+    }; // class FakeWriter
+
+} // anonymous namespace
+
+TEST_CASE("RapidGeoJSON point") {
+    FakeWriter writer;
+    osmium::geom::RapidGeoJSONFactory<FakeWriter> factory{writer};
+
+    factory.create_point(osmium::Location{3.2, 4.2});
+    REQUIRE(writer.data() == R"("geometry",{"type","Point","coordinates",[3.2,4.2]})");
+}
+
+TEST_CASE("RapidGeoJSON linestring") {
+    FakeWriter writer;
+    osmium::geom::RapidGeoJSONFactory<FakeWriter> factory{writer};
+
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+
+    factory.create_linestring(wnl);
+    REQUIRE(writer.data() == R"("geometry",{"type","LineString","coordinates",[[3.2,4.2],[3.5,4.7],[3.6,4.9]]})");
+}
+
+TEST_CASE("RapidGeoJSON factory with precision") {
+    FakeWriter writer;
+    osmium::geom::RapidGeoJSONFactory<FakeWriter> factory{writer, 2};
+
+    REQUIRE(writer.max_decimal_places() == 2);
+
+    factory.create_point(osmium::Location{3.141592, 4.2});
+    REQUIRE(writer.data() == R"("geometry",{"type","Point","coordinates",[3.14,4.2]})");
+}
@@ -4,7 +4,9 @@
 
 #include <osmium/geom/tile.hpp>
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 TEST_CASE("Helper functions") {
     REQUIRE(osmium::geom::num_tiles_in_zoom(0) == 1);
@@ -97,6 +99,62 @@ TEST_CASE("Tile order") {
     REQUIRE(d < c);
 }
 
+TEST_CASE("Z-order index of tiles") {
+    REQUIRE(osmium::geom::Tile(1, 0, 0).zorder() == 0);
+    REQUIRE(osmium::geom::Tile(1, 1, 0).zorder() == 2);
+    REQUIRE(osmium::geom::Tile(1, 0, 1).zorder() == 1);
+    REQUIRE(osmium::geom::Tile(1, 1, 1).zorder() == 3);
+
+    REQUIRE(osmium::geom::Tile(30u, (1u << 30u) - 1, (1u << 30u) - 1).zorder() == (1llu << 60u) - 1);
+}
+
+TEST_CASE("Hilbert index of tiles") {
+    REQUIRE(osmium::geom::Tile(1, 0, 0).hilbert_index() == 0);
+    REQUIRE(osmium::geom::Tile(1, 0, 1).hilbert_index() == 1);
+    REQUIRE(osmium::geom::Tile(1, 1, 1).hilbert_index() == 2);
+    REQUIRE(osmium::geom::Tile(1, 1, 0).hilbert_index() == 3);
+}
+
+TEST_CASE("Hilbert curve is continuous") {
+    const uint32_t n = osmium::geom::num_tiles_in_zoom(4);
+
+    std::vector<osmium::geom::Tile> tiles;
+    for (uint32_t x = 0; x < n; ++x) {
+        for (uint32_t y = 0; y < n; ++y) {
+            tiles.emplace_back(4, x, y);
+        }
+    }
+
+    std::sort(tiles.begin(), tiles.end(), [](const osmium::geom::Tile& lhs, const osmium::geom::Tile& rhs) {
+        return lhs.hilbert_index() < rhs.hilbert_index();
+    });
+
+    // every tile index appears exactly once and tiles with consecutive
+    // indexes are next to each other
+    for (uint64_t i = 0; i < tiles.size(); ++i) {
+        REQUIRE(tiles[i].hilbert_index() == i);
+        if (i > 0) {
+            const auto dx = tiles[i].x > tiles[i - 1].x ? tiles[i].x - tiles[i - 1].x : tiles[i - 1].x - tiles[i].x;
+            const auto dy = tiles[i].y > tiles[i - 1].y ? tiles[i].y - tiles[i - 1].y : tiles[i - 1].y - tiles[i].y;
+            REQUIRE(dx + dy == 1);
+        }
+    }
+}
+
+TEST_CASE("Batch conversion of coordinates to tiles") {
+    std::vector<osmium::geom::Coordinates> coordinates{
+        osmium::geom::Coordinates{9.99312, 53.55078},
+        osmium::geom::Coordinates{0.0, 0.0}
+    };
+
+    std::vector<osmium::geom::Tile> tiles;
+    osmium::geom::lonlat_to_tiles(12, coordinates.data(), coordinates.size(), tiles);
+
+    REQUIRE(tiles.size() == 2);
+    REQUIRE(tiles[0] == osmium::geom::Tile(12, 2161, 1323));
+    REQUIRE(tiles[1] == osmium::geom::Tile(12, 2048, 2048));
+}
+
 TEST_CASE("Check a random list of tiles") {
     std::istringstream input_data(s);
     while (input_data) {
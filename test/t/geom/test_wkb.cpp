@@ -6,6 +6,7 @@
 #include <osmium/geom/wkb.hpp>
 #include <osmium/util/endian.hpp>
 
+#include <cstddef>
 #include <string>
 
 #if __BYTE_ORDER == __LITTLE_ENDIAN
@@ -75,6 +76,24 @@ TEST_CASE("WKB geometry factory (byte-order-dependent): linestring") {
     }
 }
 
+TEST_CASE("WKB geometry factory (byte-order-dependent): output buffer") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+
+    std::string out;
+    out.reserve(osmium::geom::wkb_point_size(osmium::geom::wkb_type::wkb, osmium::geom::out_type::hex) +
+                osmium::geom::wkb_linestring_size(wnl.size(), osmium::geom::wkb_type::wkb, osmium::geom::out_type::hex));
+
+    osmium::geom::WKBFactory<> factory{&out, osmium::geom::wkb_type::wkb, osmium::geom::out_type::hex};
+
+    REQUIRE(factory.create_point(osmium::Location{3.2, 4.2}).empty());
+    const std::size_t point_end = out.size();
+    REQUIRE(factory.create_linestring(wnl).empty());
+
+    REQUIRE(out.substr(0, point_end) == "01010000009A99999999990940CDCCCCCCCCCC1040");
+    REQUIRE(out.substr(point_end) == "0102000000030000009A99999999990940CDCCCCCCCCCC10400000000000000C40CDCCCCCCCCCC1240CDCCCCCCCCCC0C409A99999999991340");
+}
+
 TEST_CASE("WKB geometry factory (byte-order-dependent): linestring as ewkb") {
     osmium::memory::Buffer buffer{10000};
     osmium::geom::WKBFactory<> factory{osmium::geom::wkb_type::ewkb, osmium::geom::out_type::hex};
@@ -33,6 +33,23 @@ TEST_CASE("WKT geometry for point in ekwt in web mercator") {
     REQUIRE(wkt == "SRID=3857;POINT(356222.37 467961.14)");
 }
 
+TEST_CASE("WKT geometry for linestring in web mercator") {
+    osmium::geom::WKTFactory<osmium::geom::MercatorProjection> factory{2};
+
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+
+    SECTION("unique forwards (default)") {
+        const std::string wkt{factory.create_linestring(wnl)};
+        REQUIRE(wkt == "LINESTRING(356222.37 467961.14,389618.22 523789.37,400750.17 546131.63)");
+    }
+
+    SECTION("unique backwards") {
+        const std::string wkt{factory.create_linestring(wnl, osmium::geom::use_nodes::unique, osmium::geom::direction::backward)};
+        REQUIRE(wkt == "LINESTRING(400750.17 546131.63,389618.22 523789.37,356222.37 467961.14)");
+    }
+}
+
 TEST_CASE("WKT geometry factory") {
     osmium::geom::WKTFactory<> factory;
 
@@ -0,0 +1,107 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler/aggregator.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstdint>
+#include <map>
+
+namespace {
+
+    struct IdSumPerType {
+
+        struct value_type {
+            uint64_t count = 0;
+            uint64_t id_sum = 0;
+        };
+
+        bool key(const osmium::OSMObject& object, uint64_t& key) const noexcept {
+            if (object.type() == osmium::item_type::relation) {
+                return false;
+            }
+            key = static_cast<uint64_t>(object.type());
+            return true;
+        }
+
+        void update(value_type& value, const osmium::OSMObject& object) const noexcept {
+            ++value.count;
+            value.id_sum += static_cast<uint64_t>(object.id());
+        }
+
+    }; // struct IdSumPerType
+
+    struct OneGroupPerId {
+
+        using value_type = uint64_t;
+
+        bool key(const osmium::OSMObject& object, uint64_t& key) const noexcept {
+            key = static_cast<uint64_t>(object.id());
+            return true;
+        }
+
+        void update(value_type& value, const osmium::OSMObject& /*object*/) const noexcept {
+            ++value;
+        }
+
+    }; // struct OneGroupPerId
+
+} // anonymous namespace
+
+TEST_CASE("Aggregator groups objects and emits on flush") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(1));
+    osmium::builder::add_node(buffer, _id(2));
+    osmium::builder::add_way(buffer, _id(10), _nodes({1, 2}));
+    osmium::builder::add_relation(buffer, _id(20));
+
+    std::map<uint64_t, IdSumPerType::value_type> results;
+    osmium::handler::Aggregator<IdSumPerType> agg{[&](uint64_t key, const IdSumPerType::value_type& value) {
+        results[key] = value;
+    }};
+
+    osmium::apply(buffer, agg);
+
+    REQUIRE(results.size() == 2);
+    REQUIRE(results[static_cast<uint64_t>(osmium::item_type::node)].count == 2);
+    REQUIRE(results[static_cast<uint64_t>(osmium::item_type::node)].id_sum == 3);
+    REQUIRE(results[static_cast<uint64_t>(osmium::item_type::way)].count == 1);
+    REQUIRE(results[static_cast<uint64_t>(osmium::item_type::way)].id_sum == 10);
+
+    // flush() at the end of apply() reset the table
+    REQUIRE(agg.size() == 0);
+}
+
+TEST_CASE("Aggregator grows beyond its initial capacity") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 1024UL, osmium::memory::Buffer::auto_grow::yes};
+    const int num_nodes = 5000;
+    for (int n = 1; n <= num_nodes; ++n) {
+        osmium::builder::add_node(buffer, _id(n));
+    }
+
+    osmium::handler::Aggregator<OneGroupPerId> agg;
+    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+        agg.osm_object(object);
+        agg.osm_object(object);
+    }
+
+    REQUIRE(agg.size() == static_cast<std::size_t>(num_nodes));
+
+    uint64_t groups = 0;
+    agg.for_each([&](uint64_t /*key*/, const uint64_t& count) {
+        ++groups;
+        REQUIRE(count == 2);
+    });
+    REQUIRE(groups == static_cast<uint64_t>(num_nodes));
+
+    // for_each() does not reset, flush() does
+    REQUIRE(agg.size() == static_cast<std::size_t>(num_nodes));
+    agg.flush();
+    REQUIRE(agg.size() == 0);
+}
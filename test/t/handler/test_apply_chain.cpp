@@ -0,0 +1,97 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/handler/chain.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstdint>
+
+namespace {
+
+    struct CountHandler : public osmium::handler::Handler {
+
+        uint64_t nodes = 0;
+        uint64_t ways = 0;
+        uint64_t relations = 0;
+        uint64_t flushed = 0;
+
+        void node(const osmium::Node& /*node*/) noexcept {
+            ++nodes;
+        }
+
+        void way(const osmium::Way& /*way*/) noexcept {
+            ++ways;
+        }
+
+        void relation(const osmium::Relation& /*relation*/) noexcept {
+            ++relations;
+        }
+
+        void flush() noexcept {
+            ++flushed;
+        }
+
+    }; // struct CountHandler
+
+    struct TagCountHandler : public osmium::handler::Handler {
+
+        uint64_t tags = 0;
+
+        void osm_object(const osmium::OSMObject& object) noexcept {
+            tags += object.tags().size();
+        }
+
+    }; // struct TagCountHandler
+
+    osmium::memory::Buffer make_buffer() {
+        using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+        osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+
+        osmium::builder::add_node(buffer, _id(1), _tag("amenity", "restaurant"));
+        osmium::builder::add_node(buffer, _id(2));
+        osmium::builder::add_way(buffer, _id(3), _nodes({1, 2}), _tag("highway", "primary"));
+        osmium::builder::add_relation(buffer, _id(4));
+
+        return buffer;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("apply_chain calls all handlers for every object") {
+    const osmium::memory::Buffer buffer = make_buffer();
+
+    CountHandler count1;
+    CountHandler count2;
+    TagCountHandler tags;
+
+    osmium::apply_chain(buffer, count1, tags, count2);
+
+    for (const CountHandler* count : {&count1, &count2}) {
+        REQUIRE(count->nodes == 2);
+        REQUIRE(count->ways == 1);
+        REQUIRE(count->relations == 1);
+        REQUIRE(count->flushed == 1);
+    }
+    REQUIRE(tags.tags == 2);
+}
+
+TEST_CASE("apply_chain gives the same result as apply") {
+    const osmium::memory::Buffer buffer = make_buffer();
+
+    CountHandler from_apply;
+    CountHandler from_apply_chain;
+
+    osmium::apply(buffer, from_apply);
+    osmium::apply_chain(buffer, from_apply_chain);
+
+    REQUIRE(from_apply.nodes == from_apply_chain.nodes);
+    REQUIRE(from_apply.ways == from_apply_chain.ways);
+    REQUIRE(from_apply.relations == from_apply_chain.relations);
+    REQUIRE(from_apply.flushed == from_apply_chain.flushed);
+}
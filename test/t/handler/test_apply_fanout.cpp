@@ -0,0 +1,110 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    struct CountHandler : public osmium::handler::Handler {
+
+        uint64_t nodes = 0;
+        uint64_t ways = 0;
+
+        void node(const osmium::Node& /*node*/) noexcept {
+            ++nodes;
+        }
+
+        void way(const osmium::Way& /*way*/) noexcept {
+            ++ways;
+        }
+
+    }; // struct CountHandler
+
+    struct IdSumHandler : public osmium::handler::Handler {
+
+        uint64_t sum = 0;
+
+        void node(const osmium::Node& node) noexcept {
+            sum += static_cast<uint64_t>(node.id());
+        }
+
+    }; // struct IdSumHandler
+
+    struct ThrowingHandler : public osmium::handler::Handler {
+
+        void way(const osmium::Way& /*way*/) {
+            throw std::runtime_error{"boom"};
+        }
+
+    }; // struct ThrowingHandler
+
+    osmium::memory::Buffer make_buffer() {
+        using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+        osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+        osmium::builder::add_node(buffer, _id(1));
+        osmium::builder::add_node(buffer, _id(2));
+        osmium::builder::add_way(buffer, _id(3), _nodes({1, 2}));
+
+        return buffer;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("apply_fanout runs all handlers over the same buffer") {
+    const osmium::memory::Buffer buffer = make_buffer();
+    osmium::thread::Pool pool{4};
+
+    CountHandler count;
+    IdSumHandler sum;
+
+    osmium::apply_fanout(buffer, pool, count, sum);
+
+    REQUIRE(count.nodes == 2);
+    REQUIRE(count.ways == 1);
+    REQUIRE(sum.sum == 3);
+}
+
+TEST_CASE("apply_fanout re-throws handler exceptions") {
+    const osmium::memory::Buffer buffer = make_buffer();
+    osmium::thread::Pool pool{4};
+
+    CountHandler count;
+    ThrowingHandler thrower;
+
+    REQUIRE_THROWS_AS(osmium::apply_fanout(buffer, pool, count, thrower), const std::runtime_error&);
+}
+
+TEST_CASE("apply_fanout on a shared buffer returns the futures") {
+    osmium::thread::Pool pool{4};
+
+    CountHandler count;
+    IdSumHandler sum;
+
+    std::vector<std::future<void>> futures;
+    {
+        auto shared = std::make_shared<osmium::memory::Buffer>(make_buffer());
+        futures = osmium::apply_fanout(shared, pool, count, sum);
+        // our reference goes away here, the tasks keep the buffer alive
+    }
+
+    for (auto& future : futures) {
+        future.get();
+    }
+
+    REQUIRE(count.nodes == 2);
+    REQUIRE(count.ways == 1);
+    REQUIRE(sum.sum == 3);
+}
@@ -0,0 +1,107 @@
+#include "catch.hpp"
+
+#include <osmium/handler.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/opl.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    struct CountHandler : public osmium::handler::Handler {
+
+        uint64_t nodes = 0;
+        uint64_t ways = 0;
+
+        void node(const osmium::Node&) noexcept {
+            ++nodes;
+        }
+
+        void way(const osmium::Way&) noexcept {
+            ++ways;
+        }
+
+    }; // struct CountHandler
+
+    struct ThrowHandler : public osmium::handler::Handler {
+
+        void node(const osmium::Node&) {
+            throw std::runtime_error{"exception in handler"};
+        }
+
+    }; // struct ThrowHandler
+
+    std::vector<osmium::memory::Buffer> make_buffers(int num_buffers) {
+        std::vector<osmium::memory::Buffer> buffers;
+
+        int id = 1;
+        for (int n = 0; n < num_buffers; ++n) {
+            osmium::memory::Buffer buffer{1024 * 10};
+            for (int i = 0; i < 10; ++i) {
+                REQUIRE(osmium::opl_parse(("n" + std::to_string(id++)).c_str(), buffer));
+            }
+            REQUIRE(osmium::opl_parse(("w" + std::to_string(id++)).c_str(), buffer));
+            buffers.push_back(std::move(buffer));
+        }
+
+        return buffers;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("apply_parallel with reduce counts all objects") {
+    auto buffers = make_buffers(7);
+
+    osmium::thread::Pool pool{4};
+
+    uint64_t nodes = 0;
+    uint64_t ways = 0;
+    osmium::apply_parallel(buffers.begin(), buffers.end(), pool,
+        []() { return CountHandler{}; },
+        [&nodes, &ways](CountHandler&& handler) {
+            nodes += handler.nodes;
+            ways += handler.ways;
+        });
+
+    REQUIRE(nodes == 70);
+    REQUIRE(ways == 7);
+}
+
+TEST_CASE("apply_parallel on empty range does nothing") {
+    std::vector<osmium::memory::Buffer> buffers;
+
+    osmium::thread::Pool pool{2};
+
+    osmium::apply_parallel(buffers.begin(), buffers.end(), pool,
+        []() { return CountHandler{}; },
+        [](CountHandler&&) {
+            REQUIRE(false);
+        });
+}
+
+TEST_CASE("apply_parallel without reduce works") {
+    auto buffers = make_buffers(3);
+
+    osmium::thread::Pool pool{2};
+
+    osmium::apply_parallel(buffers.begin(), buffers.end(), pool,
+        []() { return CountHandler{}; });
+}
+
+TEST_CASE("apply_parallel re-throws exceptions from handlers") {
+    auto buffers = make_buffers(2);
+
+    osmium::thread::Pool pool{2};
+
+    REQUIRE_THROWS_AS(osmium::apply_parallel(buffers.begin(), buffers.end(), pool,
+                          []() { return ThrowHandler{}; }),
+                      const std::runtime_error&);
+}
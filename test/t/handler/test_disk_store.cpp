@@ -0,0 +1,86 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler/disk_store.hpp>
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/index.hpp>
+#include <osmium/index/map/sparse_mem_map.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+using offset_index_type = osmium::index::map::SparseMemMap<osmium::unsigned_object_id_type, std::size_t>;
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+static osmium::memory::Buffer make_buffer() {
+    osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+
+    osmium::builder::add_node(buffer, _id(17), _version(1), _location(1.2, 3.4), _tag("amenity", "restaurant"));
+    osmium::builder::add_node(buffer, _id(18), _version(1), _location(1.3, 3.5));
+    osmium::builder::add_way(buffer, _id(21), _version(2), _nodes({17, 18}));
+    osmium::builder::add_relation(buffer, _id(31), _version(1));
+
+    return buffer;
+}
+
+static void check_store(const int fd, const offset_index_type& node_index, const offset_index_type& way_index, const offset_index_type& relation_index) {
+    const osmium::handler::DiskStoreReader reader{fd, node_index, way_index, relation_index};
+
+    const osmium::Node& node = reader.get_node(17);
+    REQUIRE(node.id() == 17);
+    REQUIRE(std::string{node.tags()["amenity"]} == "restaurant");
+    REQUIRE(reader.get_node(18).id() == 18);
+
+    const osmium::Way& way = reader.get_way(21);
+    REQUIRE(way.id() == 21);
+    REQUIRE(way.version() == 2);
+    REQUIRE(way.nodes().size() == 2);
+
+    REQUIRE(reader.get_relation(31).id() == 31);
+
+    REQUIRE_THROWS_AS(reader.get_node(99), const osmium::not_found&);
+}
+
+TEST_CASE("DiskStore with synchronous writes") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    offset_index_type node_index;
+    offset_index_type way_index;
+    offset_index_type relation_index;
+
+    osmium::memory::Buffer buffer = make_buffer();
+
+    {
+        osmium::handler::DiskStore disk_store{fd, node_index, way_index, relation_index};
+        disk_store(buffer);
+        disk_store.close();
+    }
+
+    check_store(fd, node_index, way_index, relation_index);
+}
+
+TEST_CASE("DiskStore with asynchronous writes") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    offset_index_type node_index;
+    offset_index_type way_index;
+    offset_index_type relation_index;
+
+    {
+        osmium::handler::DiskStore disk_store{fd, node_index, way_index, relation_index, osmium::handler::DiskStore::async_writes::yes};
+        disk_store.preallocate(1024UL * 10UL);
+
+        osmium::memory::Buffer buffer = make_buffer();
+        disk_store(std::move(buffer));
+        disk_store.close();
+    }
+
+    check_store(fd, node_index, way_index, relation_index);
+}
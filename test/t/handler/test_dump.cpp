@@ -0,0 +1,84 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler/dump.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/visitor.hpp>
+
+#include <sstream>
+#include <string>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+TEST_CASE("Dump a node") {
+    osmium::memory::Buffer buffer{1024 * 10};
+    osmium::builder::add_node(buffer,
+        _id(1),
+        _version(2),
+        _uid(3),
+        _user("foo"),
+        _cid(4),
+        _timestamp("2015-01-01T10:00:00Z"),
+        _location(1.02, 3.0),
+        _tag("highway", "primary"));
+
+    std::stringstream out;
+    osmium::handler::Dump dump{out, false};
+    osmium::apply(buffer, dump);
+
+    const std::string expected{
+        "NODE:\n"
+        "  id=1\n"
+        "  version=2\n"
+        "  uid=3\n"
+        "  user=|foo|\n"
+        "  changeset=4\n"
+        "  timestamp=2015-01-01T10:00:00Z\n"
+        "  visible=yes\n"
+        "  TAGS:\n"
+        "    k=|highway| v=|primary|\n"
+        "  lon=1.0200000\n"
+        "  lat=3.0000000\n"
+    };
+
+    REQUIRE(out.str() == expected);
+}
+
+TEST_CASE("Dump a node with negative coordinates") {
+    osmium::memory::Buffer buffer{1024 * 10};
+    osmium::builder::add_node(buffer, _id(2), _location(-0.5, -1.0));
+
+    std::stringstream out;
+    osmium::handler::Dump dump{out, false};
+    osmium::apply(buffer, dump);
+
+    REQUIRE(out.str().find("  lon=-0.5000000\n") != std::string::npos);
+    REQUIRE(out.str().find("  lat=-1.0000000\n") != std::string::npos);
+}
+
+TEST_CASE("Dump a way") {
+    osmium::memory::Buffer buffer{1024 * 10};
+    osmium::builder::add_way(buffer, _id(5), _nodes({1, 2}));
+
+    std::stringstream out;
+    osmium::handler::Dump dump{out, false};
+    osmium::apply(buffer, dump);
+
+    const std::string result{out.str()};
+    REQUIRE(result.find("WAY:\n") == 0);
+    REQUIRE(result.find("  id=5\n") != std::string::npos);
+    REQUIRE(result.find("  NODES:\n") != std::string::npos);
+    REQUIRE(result.find("    ref=1\n") != std::string::npos);
+    REQUIRE(result.find("    ref=2\n") != std::string::npos);
+}
+
+TEST_CASE("Dump with sizes") {
+    osmium::memory::Buffer buffer{1024 * 10};
+    osmium::builder::add_node(buffer, _id(1));
+
+    std::stringstream out;
+    osmium::handler::Dump dump{out};
+    osmium::apply(buffer, dump);
+
+    REQUIRE(out.str().find("NODE: [") == 0);
+}
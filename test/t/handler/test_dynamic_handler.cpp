@@ -114,3 +114,25 @@ TEST_CASE("Dynamic handler") {
     REQUIRE(count == 10);
 }
 
+
+TEST_CASE("Dynamic handler with handle_buffer") {
+    const auto buffer = fill_buffer();
+
+    osmium::handler::DynamicHandler handler;
+    int count = 0;
+
+    handler.handle_buffer(buffer);
+    REQUIRE(count == 0);
+
+    handler.set<Handler1>(count);
+    handler.handle_buffer(buffer);
+    REQUIRE(count == 5); // no flush()
+
+    handler.flush();
+    REQUIRE(count == 6);
+
+    count = 0;
+    handler.set<Handler2>(count);
+    handler.handle_buffer(buffer);
+    REQUIRE(count == 10);
+}
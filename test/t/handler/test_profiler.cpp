@@ -0,0 +1,67 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/handler/profiler.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstdint>
+
+namespace {
+
+    struct CountHandler : public osmium::handler::Handler {
+
+        uint64_t nodes = 0;
+        uint64_t ways = 0;
+        uint64_t flushed = 0;
+
+        void node(const osmium::Node& /*node*/) noexcept {
+            ++nodes;
+        }
+
+        void way(const osmium::Way& /*way*/) noexcept {
+            ++ways;
+        }
+
+        void flush() noexcept {
+            ++flushed;
+        }
+
+    }; // struct CountHandler
+
+} // anonymous namespace
+
+TEST_CASE("Profiler forwards to the wrapped handler and counts calls") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(1));
+    osmium::builder::add_node(buffer, _id(2));
+    osmium::builder::add_way(buffer, _id(3), _nodes({1, 2}));
+
+    CountHandler handler;
+    osmium::handler::Profiler<CountHandler> profiler{handler};
+
+    osmium::apply(buffer, profiler);
+
+    REQUIRE(handler.nodes == 2);
+    REQUIRE(handler.ways == 1);
+    REQUIRE(handler.flushed == 1);
+
+    REQUIRE(profiler.node_timings().count == 2);
+    REQUIRE(profiler.way_timings().count == 1);
+    REQUIRE(profiler.relation_timings().count == 0);
+    REQUIRE(profiler.flush_timings().count == 1);
+
+    REQUIRE(profiler.node_timings().max <= profiler.node_timings().total);
+    REQUIRE(profiler.node_timings().mean() <= static_cast<double>(profiler.node_timings().total));
+
+    uint64_t in_buckets = 0;
+    for (const uint64_t bucket : profiler.node_timings().histogram) {
+        in_buckets += bucket;
+    }
+    REQUIRE(in_buckets == 2);
+}
@@ -0,0 +1,97 @@
+#include "catch.hpp"
+
+#include <osmium/index/multimap/hybrid.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
+
+using id_type = osmium::unsigned_object_id_type;
+using hybrid_map = osmium::index::multimap::Hybrid<id_type, id_type>;
+
+namespace {
+
+    template <typename TRange>
+    int count_entries(TRange range) {
+        int count = 0;
+        for (auto it = range.first; it != range.second; ++it) {
+            ++count;
+        }
+        return count;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("Hybrid multimap without a threshold keeps extra entries until consolidate") {
+    hybrid_map index;
+
+    index.set(17, 100);
+    index.set(17, 101);
+    index.set(21, 200);
+
+    REQUIRE(index.extra_size() == 3);
+    REQUIRE(index.main_size() == 0);
+
+    index.consolidate();
+
+    REQUIRE(index.extra_size() == 0);
+    REQUIRE(index.main_size() == 3);
+    REQUIRE(index.counters().consolidations == 1);
+    REQUIRE(index.counters().auto_consolidations == 0);
+
+    REQUIRE(count_entries(index.get_all(17)) == 2);
+}
+
+TEST_CASE("Hybrid multimap consolidates itself past the threshold") {
+    hybrid_map index;
+    index.set_max_extra_size(4);
+
+    for (id_type id = 1; id <= 10; ++id) {
+        index.set(id, id * 10);
+    }
+
+    // every fourth set() spilled the extra map into the main array
+    REQUIRE(index.counters().auto_consolidations == 2);
+    REQUIRE(index.counters().background_consolidations == 0);
+    REQUIRE(index.extra_size() < 4);
+    REQUIRE(index.size() == 10);
+
+    auto r = index.get_all(7);
+    REQUIRE(count_entries(r) == 1);
+    REQUIRE(r.first->second == 70);
+}
+
+TEST_CASE("Hybrid multimap consolidates in the background on a pool") {
+    osmium::thread::Pool pool{1};
+
+    hybrid_map index;
+    index.set_max_extra_size(4);
+    index.enable_background_consolidation(pool);
+
+    for (id_type id = 1; id <= 20; ++id) {
+        index.set(id, id * 10);
+    }
+
+    REQUIRE(index.size() == 20);
+    REQUIRE(index.counters().background_consolidations >= 1);
+
+    // lookups wait for a running merge, nothing is lost
+    for (id_type id = 1; id <= 20; ++id) {
+        auto r = index.get_all(id);
+        REQUIRE(count_entries(r) == 1);
+        REQUIRE(r.first->second == id * 10);
+    }
+
+    REQUIRE(index.size() == 20);
+    index.disable_background_consolidation();
+}
+
+TEST_CASE("Hybrid multimap counts lookup costs") {
+    hybrid_map index;
+
+    index.set(17, 100);
+    index.get_all(17); // extra map not empty
+    index.consolidate();
+    index.get_all(17); // served from the main array alone
+
+    REQUIRE(index.counters().lookups == 2);
+    REQUIRE(index.counters().lookups_in_extra == 1);
+}
@@ -1,7 +1,11 @@
 #include "catch.hpp"
 
+#include <osmium/index/detail/tmpfile.hpp>
 #include <osmium/index/id_set.hpp>
 #include <osmium/osm/types.hpp>
+#include <osmium/util/file.hpp>
+
+#include <vector>
 
 TEST_CASE("Basic functionality of IdSetDense") {
     osmium::index::IdSetDense<osmium::unsigned_object_id_type> s;
@@ -104,6 +108,129 @@ TEST_CASE("Large gap") {
     REQUIRE_FALSE(s.get(1u << 29u));
 }
 
+TEST_CASE("for_each over IdSetDense") {
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> s;
+    s.set(7);
+    s.set(35);
+    s.set(20);
+    s.set(1ull << 33u);
+    s.set(21);
+    s.set((1ull << 27u) + 13u);
+
+    std::vector<osmium::unsigned_object_id_type> ids;
+    s.for_each([&ids](osmium::unsigned_object_id_type id) {
+        ids.push_back(id);
+    });
+
+    const std::vector<osmium::unsigned_object_id_type> expected{
+        7, 20, 21, 35, (1ull << 27u) + 13u, 1ull << 33u
+    };
+    REQUIRE(ids == expected);
+}
+
+TEST_CASE("Union and intersection of IdSetDense") {
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> a;
+    a.set(3);
+    a.set(17);
+    a.set(444);
+    a.set(1ull << 30u);
+
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> b;
+    b.set(17);
+    b.set(100);
+    b.set(1ull << 30u);
+    b.set(1ull << 33u);
+
+    REQUIRE(a.count_intersection(b) == 2);
+    REQUIRE(b.count_intersection(a) == 2);
+
+    SECTION("union_with adds all Ids from the other set") {
+        a.union_with(b);
+        REQUIRE(a.size() == 6);
+        REQUIRE(a.get(3));
+        REQUIRE(a.get(17));
+        REQUIRE(a.get(100));
+        REQUIRE(a.get(444));
+        REQUIRE(a.get(1ull << 30u));
+        REQUIRE(a.get(1ull << 33u));
+
+        // b is unchanged
+        REQUIRE(b.size() == 4);
+        REQUIRE_FALSE(b.get(3));
+    }
+
+    SECTION("intersect_with keeps only common Ids") {
+        a.intersect_with(b);
+        REQUIRE(a.size() == 2);
+        REQUIRE_FALSE(a.get(3));
+        REQUIRE(a.get(17));
+        REQUIRE_FALSE(a.get(444));
+        REQUIRE(a.get(1ull << 30u));
+        REQUIRE_FALSE(a.get(1ull << 33u));
+
+        // b is unchanged
+        REQUIRE(b.size() == 4);
+        REQUIRE(b.get(100));
+    }
+
+    SECTION("intersection with an empty set is empty") {
+        const osmium::index::IdSetDense<osmium::unsigned_object_id_type> empty;
+        REQUIRE(a.count_intersection(empty) == 0);
+        a.intersect_with(empty);
+        REQUIRE(a.empty());
+    }
+}
+
+TEST_CASE("Set a range of Ids in IdSetDense") {
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> s;
+
+    SECTION("range smaller than a byte") {
+        s.set_range(3, 6);
+        REQUIRE(s.size() == 3);
+        REQUIRE_FALSE(s.get(2));
+        REQUIRE(s.get(3));
+        REQUIRE(s.get(5));
+        REQUIRE_FALSE(s.get(6));
+    }
+
+    SECTION("empty range") {
+        s.set_range(100, 100);
+        REQUIRE(s.empty());
+    }
+
+    SECTION("unaligned range covering whole bytes") {
+        s.set_range(5, 1000);
+        REQUIRE(s.size() == 995);
+        REQUIRE_FALSE(s.get(4));
+        REQUIRE(s.get(5));
+        REQUIRE(s.get(512));
+        REQUIRE(s.get(999));
+        REQUIRE_FALSE(s.get(1000));
+    }
+
+    SECTION("range overlapping already set Ids keeps the size correct") {
+        s.set(10);
+        s.set(200);
+        s.set(5000);
+        s.set_range(8, 2048);
+        REQUIRE(s.size() == 2041);
+        REQUIRE(s.get(10));
+        REQUIRE(s.get(2047));
+        REQUIRE(s.get(5000));
+        REQUIRE_FALSE(s.get(2048));
+    }
+
+    SECTION("range spanning a chunk boundary") {
+        const osmium::unsigned_object_id_type chunk_bits = 1ull << 25u;
+        s.set_range(chunk_bits - 100, chunk_bits + 100);
+        REQUIRE(s.size() == 200);
+        REQUIRE(s.get(chunk_bits - 100));
+        REQUIRE(s.get(chunk_bits));
+        REQUIRE(s.get(chunk_bits + 99));
+        REQUIRE_FALSE(s.get(chunk_bits + 100));
+    }
+}
+
 TEST_CASE("Basic functionality of IdSetSmall") {
     osmium::index::IdSetSmall<osmium::unsigned_object_id_type> s;
 
@@ -162,3 +289,113 @@ TEST_CASE("Iterating over IdSetSmall") {
     REQUIRE(it == s.end());
 }
 
+
+TEST_CASE("Dump and load IdSetDense") {
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> set;
+    set.set(17);
+    set.set(28);
+    set.set(1 << 30);
+
+    const int fd = osmium::detail::create_tmp_file();
+    set.dump(fd);
+    osmium::util::file_seek(fd, 0);
+
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> restored;
+    restored.set(5); // overwritten by load()
+    restored.load(fd);
+
+    REQUIRE(restored.size() == 3);
+    REQUIRE(restored.get(17));
+    REQUIRE(restored.get(28));
+    REQUIRE(restored.get(1 << 30));
+    REQUIRE_FALSE(restored.get(5));
+}
+
+TEST_CASE("Dump and load IdSetSmall") {
+    osmium::index::IdSetSmall<osmium::unsigned_object_id_type> set;
+    set.set(42);
+    set.set(23);
+
+    const int fd = osmium::detail::create_tmp_file();
+    set.dump(fd);
+    osmium::util::file_seek(fd, 0);
+
+    osmium::index::IdSetSmall<osmium::unsigned_object_id_type> restored;
+    restored.load(fd);
+
+    REQUIRE(restored.get(42));
+    REQUIRE(restored.get(23));
+    REQUIRE_FALSE(restored.get(17));
+    restored.sort_unique();
+    REQUIRE(restored.size() == 2);
+}
+
+TEST_CASE("IdSetAdaptive starts small and promotes itself at the threshold") {
+    osmium::index::IdSetAdaptive<osmium::unsigned_object_id_type> s{4};
+
+    REQUIRE(s.empty());
+    REQUIRE_FALSE(s.is_dense());
+    REQUIRE(s.conversions() == 0);
+
+    s.set(17);
+    s.set(28);
+    s.set(4000);
+    REQUIRE_FALSE(s.is_dense());
+    REQUIRE(s.get(17));
+    REQUIRE_FALSE(s.get(18));
+
+    s.set(1);
+    REQUIRE(s.is_dense());
+    REQUIRE(s.conversions() == 1);
+
+    REQUIRE(s.get(1));
+    REQUIRE(s.get(17));
+    REQUIRE(s.get(28));
+    REQUIRE(s.get(4000));
+    REQUIRE_FALSE(s.get(18));
+    REQUIRE(s.size() == 4);
+
+    s.set(100000);
+    REQUIRE(s.get(100000));
+    REQUIRE(s.size() == 5);
+
+    std::vector<osmium::unsigned_object_id_type> ids;
+    s.for_each([&](osmium::unsigned_object_id_type id) {
+        ids.push_back(id);
+    });
+    REQUIRE(ids == (std::vector<osmium::unsigned_object_id_type>{1, 17, 28, 4000, 100000}));
+}
+
+TEST_CASE("IdSetAdaptive falls back to the small representation on clear") {
+    osmium::index::IdSetAdaptive<osmium::unsigned_object_id_type> s{2};
+
+    s.set(1);
+    s.set(2);
+    REQUIRE(s.is_dense());
+
+    s.clear();
+    REQUIRE(s.empty());
+    REQUIRE_FALSE(s.is_dense());
+    REQUIRE(s.conversions() == 1); // the counter survives clear()
+
+    s.set(3);
+    REQUIRE(s.get(3));
+    REQUIRE_FALSE(s.get(1));
+    s.sort_unique();
+    REQUIRE(s.size() == 1);
+
+    s.set(4);
+    REQUIRE(s.is_dense());
+    REQUIRE(s.conversions() == 2);
+}
+
+TEST_CASE("IdSetAdaptive counts duplicates only once in the dense representation") {
+    osmium::index::IdSetAdaptive<osmium::unsigned_object_id_type> s{3};
+
+    s.set(5);
+    s.set(5);
+    s.set(5);
+    REQUIRE(s.is_dense());
+    REQUIRE(s.size() == 1);
+    REQUIRE(s.get(5));
+}
@@ -2,20 +2,25 @@
 
 #include <osmium/index/map/dense_file_array.hpp>
 #include <osmium/index/map/dense_mem_array.hpp>
+#include <osmium/index/map/dense_mem_compressed.hpp>
 #include <osmium/index/map/dense_mmap_array.hpp>
 #include <osmium/index/map/dummy.hpp>
 #include <osmium/index/map/flex_mem.hpp>
 #include <osmium/index/map/sparse_file_array.hpp>
 #include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/index/map/sparse_mem_hash_map.hpp>
 #include <osmium/index/map/sparse_mem_map.hpp>
 #include <osmium/index/map/sparse_mem_table.hpp>
 #include <osmium/index/map/sparse_mmap_array.hpp>
 #include <osmium/index/node_locations_map.hpp>
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
 
 #include <memory>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 static_assert(osmium::index::empty_value<osmium::Location>() == osmium::Location{}, "Empty value for location is wrong");
@@ -59,6 +64,11 @@ void test_func_real(TIndex& index) {
 
     index.sort();
 
+    // just a hint, must not change any results
+    index.prefetch(id1);
+    index.prefetch(id2);
+    index.prefetch(100);
+
     REQUIRE(loc1 == index.get(id1));
     REQUIRE(loc2 == index.get(id2));
 
@@ -120,6 +130,32 @@ TEST_CASE("Map Id to location: DenseMemArray") {
 }
 
 #ifdef __linux__
+TEST_CASE("Map Id to location: DenseMemArray concurrent insertion") {
+    using index_type = osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+    const osmium::unsigned_object_id_type count = 100000;
+
+    index_type index;
+    index.resize(count + 1);
+
+    // Each thread writes a disjoint set of ids.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&index, t]() {
+            for (osmium::unsigned_object_id_type id = t + 1; id <= count; id += 4) {
+                index.set_concurrent(id, osmium::Location{id * 0.00001, id * 0.00002});
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (osmium::unsigned_object_id_type id = 1; id <= count; ++id) {
+        REQUIRE(index.get(id) == osmium::Location(id * 0.00001, id * 0.00002));
+    }
+}
+
 TEST_CASE("Map Id to location: DenseMmapArray") {
     using index_type = osmium::index::map::DenseMmapArray<osmium::unsigned_object_id_type, osmium::Location>;
 
@@ -143,8 +179,80 @@ TEST_CASE("Map Id to location: DenseFileArray") {
     test_func_real<index_type>(index2);
 }
 
+TEST_CASE("Map Id to location: DenseFileArray with write batching") {
+    using index_type = osmium::index::map::DenseFileArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index;
+    index.enable_write_batching(4);
+
+    const osmium::Location loc1{1.2, 4.5};
+    const osmium::Location loc2{3.5, -7.2};
+
+    // Unsorted writes including one id written twice, where the later
+    // write must win.
+    index.set(57, loc1);
+    index.set(3, loc1);
+    index.set(57, loc2);
+    REQUIRE(index.size() == 0); // nothing applied yet
+
+    index.set(99, loc1); // batch is full now, flushes automatically
+    REQUIRE(index.size() == 100);
+
+    index.set(12, loc2);
+    index.flush_writes();
+
+    REQUIRE(index.get(3) == loc1);
+    REQUIRE(index.get(12) == loc2);
+    REQUIRE(index.get(57) == loc2);
+    REQUIRE(index.get(99) == loc1);
+    REQUIRE_THROWS_AS(index.get(58), const osmium::not_found&);
+
+    index.set(7, loc1);
+    index.sort(); // flushes, too
+    REQUIRE(index.get(7) == loc1);
+}
+
 #ifdef OSMIUM_WITH_SPARSEHASH
 
+TEST_CASE("Map Id to location: DenseMemCompressed") {
+    using index_type = osmium::index::map::DenseMemCompressed<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index1;
+    test_func_all<index_type>(index1);
+
+    REQUIRE(2 == index1.size());
+
+    index_type index2;
+    test_func_real<index_type>(index2);
+}
+
+TEST_CASE("Map Id to location: DenseMemCompressed with many pages") {
+    using index_type = osmium::index::map::DenseMemCompressed<osmium::unsigned_object_id_type, osmium::Location>;
+
+    // Use a small hot-page cache so pages get compressed and
+    // decompressed while filling and reading the index.
+    index_type index{2};
+
+    const osmium::unsigned_object_id_type count = 500000;
+    for (osmium::unsigned_object_id_type id = 2; id <= count; id += 2) {
+        index.set(id, osmium::Location{id * 0.00001, id * 0.00002});
+    }
+    REQUIRE(index.size() == count / 2);
+
+    for (osmium::unsigned_object_id_type id = 2; id <= count; id += 2) {
+        REQUIRE(index.get(id) == osmium::Location(id * 0.00001, id * 0.00002));
+        REQUIRE(index.get_noexcept(id + 1) == osmium::Location{});
+    }
+
+    // Compressed storage should be much smaller than the 8 bytes per
+    // possible id the uncompressed dense indexes need.
+    REQUIRE(index.used_memory() < count * sizeof(osmium::Location));
+
+    index.clear();
+    REQUIRE(index.size() == 0);
+    REQUIRE_THROWS_AS(index.get(2), const osmium::not_found&);
+}
+
 TEST_CASE("Map Id to location: SparseMemTable") {
     using index_type = osmium::index::map::SparseMemTable<osmium::unsigned_object_id_type, osmium::Location>;
 
@@ -167,6 +275,33 @@ TEST_CASE("Map Id to location: SparseMemMap") {
     test_func_real<index_type>(index2);
 }
 
+TEST_CASE("Map Id to location: SparseMemHashMap") {
+    using index_type = osmium::index::map::SparseMemHashMap<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index1;
+    test_func_all<index_type>(index1);
+
+    REQUIRE(2 == index1.size());
+
+    index_type index2;
+    test_func_real<index_type>(index2);
+}
+
+TEST_CASE("Map Id to location: SparseMemHashMap with many elements") {
+    using index_type = osmium::index::map::SparseMemHashMap<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index;
+    for (osmium::unsigned_object_id_type id = 1; id <= 10000; ++id) {
+        index.set(id * 3, osmium::Location{id * 0.0001, id * 0.0002});
+    }
+    REQUIRE(index.size() == 10000);
+
+    for (osmium::unsigned_object_id_type id = 1; id <= 10000; ++id) {
+        REQUIRE(index.get(id * 3) == osmium::Location(id * 0.0001, id * 0.0002));
+        REQUIRE(index.get_noexcept(id * 3 + 1) == osmium::Location{});
+    }
+}
+
 TEST_CASE("Map Id to location: SparseMemArray") {
     using index_type = osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
 
@@ -183,6 +318,68 @@ TEST_CASE("Map Id to location: SparseMemArray") {
     test_func_real<index_type>(index2);
 }
 
+TEST_CASE("Map Id to location: SparseMemArray with id filter") {
+    using index_type = osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index;
+
+    const osmium::unsigned_object_id_type count = 30000;
+    for (osmium::unsigned_object_id_type id = 3; id <= count; id += 3) {
+        index.set(id, osmium::Location{id * 0.0001, id * 0.0002});
+    }
+
+    index.sort();
+    index.build_id_filter();
+
+    for (osmium::unsigned_object_id_type id = 3; id <= count; id += 3) {
+        REQUIRE(index.get(id) == osmium::Location(id * 0.0001, id * 0.0002));
+        REQUIRE(index.get_noexcept(id + 1) == osmium::Location{});
+    }
+    REQUIRE_THROWS_AS(index.get(count + 1), const osmium::not_found&);
+
+    // Adding more data throws the filter away, lookups must still work.
+    index.set(1, osmium::Location{1.5, 2.5});
+    index.sort();
+    REQUIRE(index.get(1) == osmium::Location(1.5, 2.5));
+    REQUIRE(index.get(3) == osmium::Location(3 * 0.0001, 3 * 0.0002));
+}
+
+TEST_CASE("Map Id to location: SparseMemArray parallel sort") {
+    using index_type = osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index;
+
+    const osmium::unsigned_object_id_type count = 200000;
+    for (osmium::unsigned_object_id_type id = count; id >= 1; --id) {
+        index.set(id, osmium::Location{id * 0.00001, id * 0.00002});
+    }
+
+    index.sort(osmium::thread::Pool::default_instance());
+
+    for (osmium::unsigned_object_id_type id = 1; id <= count; ++id) {
+        REQUIRE(index.get(id) == osmium::Location(id * 0.00001, id * 0.00002));
+    }
+}
+
+TEST_CASE("Map Id to location: SparseFileArray external sort") {
+    using index_type = osmium::index::map::SparseFileArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index;
+
+    const osmium::unsigned_object_id_type count = 100000;
+    for (osmium::unsigned_object_id_type id = count; id >= 1; --id) {
+        index.set(id, osmium::Location{id * 0.00001, id * 0.00002});
+    }
+
+    // small memory limit so the data is split into many runs
+    index.sort_external(1024 * sizeof(std::pair<osmium::unsigned_object_id_type, osmium::Location>));
+
+    for (osmium::unsigned_object_id_type id = 1; id <= count; ++id) {
+        REQUIRE(index.get(id) == osmium::Location(id * 0.00001, id * 0.00002));
+    }
+    REQUIRE_THROWS_AS(index.get(count + 1), const osmium::not_found&);
+}
+
 #ifdef __linux__
 TEST_CASE("Map Id to location: SparseMmapArray") {
     using index_type = osmium::index::map::SparseMmapArray<osmium::unsigned_object_id_type, osmium::Location>;
@@ -249,6 +446,38 @@ TEST_CASE("Map Id to location: FlexMem switch") {
     REQUIRE(index.get_noexcept(2000000000) == osmium::Location{});
 }
 
+TEST_CASE("Map Id to location: FlexMem switch threshold and stats") {
+    using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index;
+
+    REQUIRE(index.max_id() == 0);
+    REQUIRE(index.sparse_memory() == 0);
+    REQUIRE(index.dense_memory() == 0);
+
+    // Make the index switch after only a few dense entries.
+    index.set_switch_threshold(10, 3);
+
+    for (osmium::unsigned_object_id_type id = 1; id <= 9; ++id) {
+        index.set(id, osmium::Location{id * 0.001, id * 0.002});
+    }
+
+    REQUIRE_FALSE(index.is_dense());
+    REQUIRE(index.max_id() == 9);
+    REQUIRE(index.sparse_memory() > 0);
+    REQUIRE(index.dense_memory() > index.sparse_memory());
+
+    index.set(10, osmium::Location{0.010, 0.020});
+
+    REQUIRE(index.is_dense());
+    REQUIRE(index.sparse_memory() == 0);
+    REQUIRE(index.dense_memory() == index.used_memory() - sizeof(index_type));
+
+    for (osmium::unsigned_object_id_type id = 1; id <= 10; ++id) {
+        REQUIRE(index.get(id) == osmium::Location(id * 0.001, id * 0.002));
+    }
+}
+
 TEST_CASE("Map Id to location: Dynamic map choice") {
     using map_type = osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>;
     const auto& map_factory = osmium::index::MapFactory<osmium::unsigned_object_id_type, osmium::Location>::instance();
@@ -0,0 +1,129 @@
+#include "catch.hpp"
+
+#include <osmium/index/multimap/flat_mem_multimap.hpp>
+#include <osmium/index/multimap/sparse_mem_array.hpp>
+#include <osmium/index/multimap/sparse_mem_multimap.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstddef>
+
+using id_type = osmium::unsigned_object_id_type;
+
+TEST_CASE("Multimap set_all bulk insert") {
+    const id_type ids[] = {17, 21, 17, 42};
+
+    SECTION("sparse mem array uses the bulk overload") {
+        osmium::index::multimap::SparseMemArray<id_type, id_type> index;
+
+        index.set_all(ids, 4, 100);
+        index.set(21, 200);
+        index.sort();
+
+        REQUIRE(index.size() == 5);
+
+        const auto r17 = index.get_all(17);
+        REQUIRE(std::distance(r17.first, r17.second) == 2);
+        REQUIRE(r17.first->second == 100);
+
+        const auto r21 = index.get_all(21);
+        REQUIRE(std::distance(r21.first, r21.second) == 2);
+    }
+
+    SECTION("sparse mem multimap uses the default implementation") {
+        osmium::index::multimap::SparseMemMultimap<id_type, id_type> index;
+
+        index.set_all(ids, 4, 100);
+
+        REQUIRE(index.size() == 4);
+
+        const auto r17 = index.get_all(17);
+        REQUIRE(std::distance(r17.first, r17.second) == 2);
+    }
+
+    SECTION("flat mem multimap has its own bulk overload") {
+        osmium::index::multimap::FlatMemMultimap<id_type, id_type> index;
+
+        index.set_all(ids, 4, 100);
+        index.set(21, 200);
+
+        REQUIRE(index.size() == 5);
+
+        auto r17 = index.get_all(17);
+        int count = 0;
+        for (auto it = r17.first; it != r17.second; ++it) {
+            REQUIRE(it->first == 17);
+            REQUIRE(it->second == 100);
+            ++count;
+        }
+        REQUIRE(count == 2);
+    }
+}
+
+TEST_CASE("Flat mem multimap") {
+    osmium::index::multimap::FlatMemMultimap<id_type, id_type> index;
+
+    SECTION("empty map finds nothing") {
+        REQUIRE(index.size() == 0);
+        const auto r = index.get_all(17);
+        REQUIRE(r.first == r.second);
+    }
+
+    SECTION("multiple values per key") {
+        index.set(17, 100);
+        index.set(21, 200);
+        index.set(17, 101);
+
+        REQUIRE(index.size() == 3);
+
+        auto r = index.get_all(17);
+        id_type sum = 0;
+        for (auto it = r.first; it != r.second; ++it) {
+            sum += it->second;
+        }
+        REQUIRE(sum == 201);
+
+        const auto r42 = index.get_all(42);
+        REQUIRE(r42.first == r42.second);
+    }
+
+    SECTION("removed values are skipped") {
+        index.set(17, 100);
+        index.set(17, 101);
+        index.remove(17, 100);
+
+        REQUIRE(index.size() == 1);
+
+        auto r = index.get_all(17);
+        REQUIRE(r.first != r.second);
+        REQUIRE(r.first->second == 101);
+        REQUIRE(++r.first == r.second);
+    }
+
+    SECTION("chains survive growing the table") {
+        for (id_type id = 1; id <= 10000; ++id) {
+            index.set(id, id);
+            index.set(id, id + 1);
+        }
+
+        REQUIRE(index.size() == 20000);
+
+        for (id_type id = 1; id <= 10000; ++id) {
+            auto r = index.get_all(id);
+            id_type sum = 0;
+            for (auto it = r.first; it != r.second; ++it) {
+                sum += it->second;
+            }
+            REQUIRE(sum == 2 * id + 1);
+        }
+    }
+
+    SECTION("clear empties the map") {
+        index.set(17, 100);
+        index.clear();
+
+        REQUIRE(index.size() == 0);
+        REQUIRE(index.used_memory() == 0);
+        const auto r = index.get_all(17);
+        REQUIRE(r.first == r.second);
+    }
+}
@@ -82,3 +82,94 @@ TEST_CASE("Create ObjectPointerCollection") {
     REQUIRE(collection.empty());
 }
 
+
+TEST_CASE("Sort ObjectPointerCollection by key and in parallel") {
+    osmium::memory::Buffer buffer{1024UL * 512UL, osmium::memory::Buffer::auto_grow::yes};
+
+    // enough objects in shuffled order so the parallel sort actually
+    // splits the range into chunks
+    for (int i = 39999; i >= 0; --i) {
+        osmium::builder::add_node(buffer,
+            _id((i * 7919) % 1000 + 1),
+            _version(i % 5 + 1)
+        );
+    }
+
+    osmium::ObjectPointerCollection expected;
+    osmium::apply(buffer, expected);
+    expected.sort(osmium::object_order_type_id_reverse_version{});
+
+    const auto same_order = [&expected](const osmium::ObjectPointerCollection& collection) {
+        auto it = collection.cbegin();
+        for (auto eit = expected.cbegin(); eit != expected.cend(); ++eit, ++it) {
+            if (eit->id() != it->id() || eit->version() != it->version()) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    SECTION("sort_by_key gives the same order") {
+        osmium::ObjectPointerCollection collection;
+        osmium::apply(buffer, collection);
+        collection.sort_by_key(osmium::object_key_type_id_reverse_version{});
+        REQUIRE(same_order(collection));
+    }
+
+    SECTION("parallel sort gives the same order") {
+        osmium::thread::Pool pool{4};
+        osmium::ObjectPointerCollection collection;
+        osmium::apply(buffer, collection);
+        collection.sort(osmium::object_order_type_id_reverse_version{}, pool);
+        REQUIRE(same_order(collection));
+    }
+
+    SECTION("parallel sort_by_key gives the same order") {
+        osmium::thread::Pool pool{4};
+        osmium::ObjectPointerCollection collection;
+        osmium::apply(buffer, collection);
+        collection.sort_by_key(osmium::object_key_type_id_reverse_version{}, pool);
+        REQUIRE(same_order(collection));
+    }
+}
+
+TEST_CASE("Unique with action marks dropped objects") {
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+
+    osmium::builder::add_node(buffer, _id(3), _version(3));
+    osmium::builder::add_node(buffer, _id(1), _version(2));
+    osmium::builder::add_node(buffer, _id(1), _version(4));
+
+    osmium::ObjectPointerCollection collection;
+    osmium::apply(buffer, collection);
+
+    collection.sort(osmium::object_order_type_id_reverse_version{});
+    collection.unique(osmium::object_equal_type_id{},
+                      [](osmium::OSMObject& object) {
+                          object.set_removed(true);
+                      });
+
+    REQUIRE(collection.size() == 2);
+
+    auto it = collection.cbegin();
+    REQUIRE(it->id() == 1);
+    REQUIRE(it->version() == 4);
+    REQUIRE_FALSE(it->removed());
+    ++it;
+    REQUIRE(it->id() == 3);
+    REQUIRE(it->version() == 3);
+    REQUIRE_FALSE(it->removed());
+    ++it;
+    REQUIRE(it == collection.cend());
+
+    // the dropped older version is marked as removed in the buffer
+    int removed_count = 0;
+    for (const auto& node : buffer.select<osmium::OSMObject>()) {
+        if (node.removed()) {
+            ++removed_count;
+            REQUIRE(node.id() == 1);
+            REQUIRE(node.version() == 2);
+        }
+    }
+    REQUIRE(removed_count == 1);
+}
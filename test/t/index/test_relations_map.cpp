@@ -1,8 +1,11 @@
 #include "catch.hpp"
 
 #include <osmium/index/relations_map.hpp>
+#include <osmium/thread/pool.hpp>
 
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 static_assert(!std::is_default_constructible<osmium::index::RelationsMapIndex>::value, "RelationsMapIndex should not be default constructible");
 static_assert(!std::is_copy_constructible<osmium::index::RelationsMapIndex>::value, "RelationsMapIndex should not be copy constructible");
@@ -105,3 +108,98 @@ TEST_CASE("RelationsMapStash both indexes") {
     REQUIRE(count == 2);
 }
 
+TEST_CASE("RelationsMapIndex dump and reload") {
+    osmium::index::RelationsMapStash stash;
+    stash.add(1, 2);
+    stash.add(2, 3);
+    stash.add(2, 4);
+
+    const auto index = stash.build_member_to_parent_index();
+
+    // "persist" the index...
+    std::vector<std::pair<osmium::unsigned_object_id_type, osmium::unsigned_object_id_type>> entries;
+    index.for_each_entry([&](osmium::unsigned_object_id_type member_id, osmium::unsigned_object_id_type parent_id) {
+        entries.emplace_back(member_id, parent_id);
+    });
+
+    const std::vector<std::pair<osmium::unsigned_object_id_type, osmium::unsigned_object_id_type>> expected{
+        {1, 2}, {2, 3}, {2, 4}
+    };
+    REQUIRE(entries == expected);
+
+    // ...and build a new index from the dump
+    osmium::index::RelationsMapStash reloaded_stash;
+    for (const auto& entry : entries) {
+        reloaded_stash.add(entry.first, entry.second);
+    }
+
+    const auto reloaded_index = reloaded_stash.build_member_to_parent_index();
+    REQUIRE(reloaded_index.size() == index.size());
+
+    int count = 0;
+    reloaded_index.for_each(2, [&](osmium::unsigned_object_id_type id) {
+        ++count;
+        REQUIRE((id == 3 || id == 4));
+    });
+    REQUIRE(count == 2);
+}
+
+TEST_CASE("RelationsMapStash merge") {
+    osmium::index::RelationsMapStash stash;
+    stash.add(1, 2);
+
+    osmium::index::RelationsMapStash other;
+    other.add(2, 3);
+    other.add(1, 2); // duplicate of an entry in the first stash
+
+    stash.merge(std::move(other));
+    REQUIRE(stash.size() == 3);
+
+    const auto index = stash.build_member_to_parent_index();
+    REQUIRE(index.size() == 2); // duplicate is gone
+
+    int count = 0;
+    index.for_each(1, [&](osmium::unsigned_object_id_type id) {
+        REQUIRE(id == 2);
+        ++count;
+    });
+    index.for_each(2, [&](osmium::unsigned_object_id_type id) {
+        REQUIRE(id == 3);
+        ++count;
+    });
+    REQUIRE(count == 2);
+}
+
+TEST_CASE("RelationsMapStash parallel index building") {
+    osmium::thread::Pool pool{2};
+
+    // enough entries to make the parallel sort kick in
+    const osmium::unsigned_object_id_type num = 200000;
+
+    osmium::index::RelationsMapStash stash;
+    osmium::index::RelationsMapStash reference;
+    for (osmium::unsigned_object_id_type n = 0; n < num; ++n) {
+        // unsorted insertion order with some duplicate entries
+        const auto member_id = (num - n) % 1000;
+        stash.add(member_id, n % 77);
+        reference.add(member_id, n % 77);
+    }
+
+    const auto index = stash.build_indexes(pool);
+    const auto expected = reference.build_indexes();
+    REQUIRE(index.size() == expected.size());
+
+    for (osmium::unsigned_object_id_type id = 0; id < 1000; id += 111) {
+        std::vector<osmium::unsigned_object_id_type> results;
+        index.member_to_parent().for_each(id, [&](osmium::unsigned_object_id_type parent_id) {
+            results.push_back(parent_id);
+        });
+        std::vector<osmium::unsigned_object_id_type> expected_results;
+        expected.member_to_parent().for_each(id, [&](osmium::unsigned_object_id_type parent_id) {
+            expected_results.push_back(parent_id);
+        });
+        REQUIRE(results == expected_results);
+        REQUIRE_FALSE(results.empty());
+    }
+}
+
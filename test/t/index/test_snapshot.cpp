@@ -0,0 +1,130 @@
+#include "catch.hpp"
+
+#include <osmium/index/map/dense_mem_array.hpp>
+#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+using dense_mem_array = osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+using sparse_mem_array = osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+using flex_mem = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+
+namespace {
+
+    const char* const snapshot_filename = "test_index_snapshot.idx";
+
+    // Remove the snapshot file when the test case is done with it.
+    struct file_guard {
+        ~file_guard() {
+            std::remove(snapshot_filename);
+        }
+    };
+
+    const osmium::Location loc1{1.2, 4.5};
+    const osmium::Location loc2{3.5, -7.2};
+    const osmium::Location loc3{-12.7, 14.5};
+
+} // anonymous namespace
+
+TEST_CASE("Snapshot of DenseMemArray") {
+    const file_guard guard;
+
+    dense_mem_array index;
+    index.set(12, loc1);
+    index.set(3, loc2);
+    index.set(7, loc3);
+    index.dump_to_file(snapshot_filename);
+
+    dense_mem_array restored;
+    restored.load_from_file(snapshot_filename);
+
+    REQUIRE(restored.size() == index.size());
+    REQUIRE(restored.get(12) == loc1);
+    REQUIRE(restored.get(3) == loc2);
+    REQUIRE(restored.get(7) == loc3);
+    REQUIRE_THROWS_AS(restored.get(5), const osmium::not_found&);
+}
+
+TEST_CASE("Snapshot of SparseMemArray") {
+    const file_guard guard;
+
+    sparse_mem_array index;
+    index.set(12, loc1);
+    index.set(3, loc2);
+    index.set(7, loc3);
+    index.sort();
+    index.dump_to_file(snapshot_filename);
+
+    sparse_mem_array restored;
+    restored.load_from_file(snapshot_filename);
+
+    REQUIRE(restored.size() == 3);
+    REQUIRE(restored.get(12) == loc1);
+    REQUIRE(restored.get(3) == loc2);
+    REQUIRE(restored.get(7) == loc3);
+    REQUIRE_THROWS_AS(restored.get(5), const osmium::not_found&);
+
+    // the id filter is not part of the snapshot, but can be rebuilt
+    restored.build_id_filter();
+    REQUIRE(restored.get(12) == loc1);
+    REQUIRE_THROWS_AS(restored.get(5), const osmium::not_found&);
+}
+
+TEST_CASE("Snapshot of FlexMem in sparse mode") {
+    const file_guard guard;
+
+    flex_mem index;
+    index.set(12, loc1);
+    index.set(3, loc2);
+    index.set(7, loc3);
+    index.sort();
+    index.dump_to_file(snapshot_filename);
+
+    flex_mem restored;
+    restored.load_from_file(snapshot_filename);
+
+    REQUIRE_FALSE(restored.is_dense());
+    REQUIRE(restored.max_id() == 12);
+    REQUIRE(restored.get(12) == loc1);
+    REQUIRE(restored.get(3) == loc2);
+    REQUIRE(restored.get(7) == loc3);
+    REQUIRE_THROWS_AS(restored.get(5), const osmium::not_found&);
+}
+
+TEST_CASE("Snapshot of FlexMem in dense mode") {
+    const file_guard guard;
+
+    flex_mem index{true};
+    index.set(12, loc1);
+    index.set(3, loc2);
+    index.set(100000, loc3);
+    index.dump_to_file(snapshot_filename);
+
+    flex_mem restored;
+    restored.load_from_file(snapshot_filename);
+
+    REQUIRE(restored.is_dense());
+    REQUIRE(restored.get(12) == loc1);
+    REQUIRE(restored.get(3) == loc2);
+    REQUIRE(restored.get(100000) == loc3);
+    REQUIRE_THROWS_AS(restored.get(5), const osmium::not_found&);
+}
+
+TEST_CASE("Snapshot of wrong index kind is rejected") {
+    const file_guard guard;
+
+    dense_mem_array index;
+    index.set(12, loc1);
+    index.dump_to_file(snapshot_filename);
+
+    sparse_mem_array restored;
+    REQUIRE_THROWS_AS(restored.load_from_file(snapshot_filename), const std::runtime_error&);
+
+    flex_mem flex_restored;
+    REQUIRE_THROWS_AS(flex_restored.load_from_file(snapshot_filename), const std::runtime_error&);
+}
@@ -0,0 +1,52 @@
+#include "catch.hpp"
+
+#include <osmium/index/detail/tmpfile.hpp>
+
+#include <cstring>
+
+#ifndef _MSC_VER
+# include <unistd.h>
+#endif
+
+TEST_CASE("Temporary file is usable") {
+    const int fd = osmium::detail::create_tmp_file();
+    REQUIRE(fd >= 0);
+
+#ifndef _MSC_VER
+    REQUIRE(::write(fd, "foo", 3) == 3);
+    REQUIRE(::lseek(fd, 0, SEEK_SET) == 0);
+    char buffer[3];
+    REQUIRE(::read(fd, buffer, 3) == 3);
+    REQUIRE(!std::strncmp(buffer, "foo", 3));
+    ::close(fd);
+#endif
+}
+
+#ifndef _MSC_VER
+TEST_CASE("Temporary file in chosen directory") {
+    const int fd = osmium::detail::create_tmp_file(".");
+    REQUIRE(fd >= 0);
+
+    REQUIRE(::write(fd, "bar", 3) == 3);
+    REQUIRE(::lseek(fd, 0, SEEK_SET) == 0);
+    char buffer[3];
+    REQUIRE(::read(fd, buffer, 3) == 3);
+    REQUIRE(!std::strncmp(buffer, "bar", 3));
+    ::close(fd);
+}
+
+TEST_CASE("Temporary file in nonexistent directory throws") {
+    REQUIRE_THROWS_AS(osmium::detail::create_tmp_file("/nonexistent-directory-osmium-test"),
+                      const std::system_error&);
+}
+
+TEST_CASE("Preallocation does not change the file size") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    // Best effort: may return false on filesystems without fallocate
+    // support, but must never change the file size.
+    osmium::detail::preallocate_tmp_file(fd, 1024 * 1024);
+    REQUIRE(::lseek(fd, 0, SEEK_END) == 0);
+    ::close(fd);
+}
+#endif
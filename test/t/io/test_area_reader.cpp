@@ -0,0 +1,104 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler/node_locations_for_ways.hpp>
+#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/io/area_reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/io/xml_output.hpp>
+#include <osmium/osm/area.hpp>
+
+#include <cstdio>
+#include <string>
+#include <utility>
+
+namespace {
+
+    using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+    using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
+
+} // anonymous namespace
+
+TEST_CASE("AreaReader delivers objects and areas assembled from closed ways") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 1.0));
+    osmium::builder::add_node(buffer, _id(2), _location(2.0, 1.0));
+    osmium::builder::add_node(buffer, _id(3), _location(2.0, 2.0));
+    osmium::builder::add_way(buffer, _id(10), _nodes({1, 2, 3, 1}), _tag("building", "yes"));
+
+    const std::string filename{"test_area_reader.osm"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    index_type index;
+    location_handler_type location_handler{index};
+
+    osmium::io::AreaReader<location_handler_type> reader{filename, location_handler};
+
+    int nodes = 0;
+    int ways = 0;
+    int areas = 0;
+    osmium::object_id_type area_orig_id = 0;
+    while (osmium::memory::Buffer b = reader.read()) {
+        for (const auto& item : b) {
+            if (item.type() == osmium::item_type::node) {
+                ++nodes;
+            } else if (item.type() == osmium::item_type::way) {
+                ++ways;
+            } else if (item.type() == osmium::item_type::area) {
+                ++areas;
+                area_orig_id = static_cast<const osmium::Area&>(item).orig_id();
+            }
+        }
+    }
+    reader.close();
+    std::remove(filename.c_str());
+
+    REQUIRE(reader.eof());
+    REQUIRE(nodes == 3);
+    REQUIRE(ways == 1);
+    REQUIRE(areas == 1);
+    REQUIRE(area_orig_id == 10);
+}
+
+TEST_CASE("AreaReader without the area bit set works like a plain reader with locations") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 1.0));
+    osmium::builder::add_node(buffer, _id(2), _location(2.0, 1.0));
+    osmium::builder::add_way(buffer, _id(10), _nodes({1, 2}));
+
+    const std::string filename{"test_area_reader_plain.osm"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    index_type index;
+    location_handler_type location_handler{index};
+
+    osmium::io::AreaReader<location_handler_type> reader{filename, location_handler, osmium::osm_entity_bits::nwr};
+
+    int objects = 0;
+    int areas = 0;
+    while (osmium::memory::Buffer b = reader.read()) {
+        for (const auto& item : b) {
+            if (item.type() == osmium::item_type::area) {
+                ++areas;
+            } else {
+                ++objects;
+            }
+        }
+    }
+    reader.close();
+    std::remove(filename.c_str());
+
+    REQUIRE(objects == 3);
+    REQUIRE(areas == 0);
+    // the location handler has still been applied
+    REQUIRE(index.get(1) == osmium::Location(1.0, 1.0));
+}
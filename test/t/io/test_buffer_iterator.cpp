@@ -0,0 +1,83 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/input_iterator.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+
+#include <utility>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+    // A source yielding pre-built buffers, standing in for an
+    // osmium::io::Reader.
+    class mock_source {
+
+        std::vector<osmium::memory::Buffer> m_buffers;
+        std::size_t m_pos = 0;
+
+    public:
+
+        void add(osmium::memory::Buffer&& buffer) {
+            m_buffers.push_back(std::move(buffer));
+        }
+
+        osmium::memory::Buffer read() {
+            if (m_pos == m_buffers.size()) {
+                return osmium::memory::Buffer{};
+            }
+            return std::move(m_buffers[m_pos++]);
+        }
+
+    }; // class mock_source
+
+    osmium::memory::Buffer build_buffer(osmium::object_id_type id) {
+        osmium::memory::Buffer buffer{1024};
+        osmium::builder::add_node(buffer, _id(id));
+        return buffer;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("Iterating over the buffers of an empty source") {
+    mock_source source;
+
+    for (auto& buffer : osmium::io::buffers(source)) {
+        (void)buffer;
+        REQUIRE(false);
+    }
+}
+
+TEST_CASE("Iterating over the buffers of a source") {
+    mock_source source;
+    source.add(build_buffer(1));
+    source.add(build_buffer(2));
+    source.add(build_buffer(3));
+
+    osmium::object_id_type next_id = 1;
+    for (auto& buffer : osmium::io::buffers(source)) {
+        REQUIRE(buffer);
+        for (const auto& node : buffer.select<osmium::Node>()) {
+            REQUIRE(node.id() == next_id++);
+        }
+    }
+    REQUIRE(next_id == 4);
+}
+
+TEST_CASE("BufferIterator end iterators compare equal") {
+    const osmium::io::BufferIterator<mock_source> end1;
+    const osmium::io::BufferIterator<mock_source> end2;
+    REQUIRE(end1 == end2);
+
+    mock_source source;
+    source.add(build_buffer(1));
+
+    osmium::io::BufferIterator<mock_source> it{source};
+    REQUIRE(it != end1);
+    REQUIRE(it->select<osmium::Node>().begin()->id() == 1);
+    ++it;
+    REQUIRE(it == end1);
+}
@@ -2,9 +2,14 @@
 
 #include "utils.hpp"
 
+// make the ParallelBzip2Decompressor available, too
+#define OSMIUM_WITH_PARALLEL_BZIP2
+
 #include <osmium/io/bzip2_compression.hpp>
 #include <osmium/io/detail/read_write.hpp>
 
+#include <bzlib.h>
+
 #include <string>
 
 TEST_CASE("Invalid file descriptor of bzip2-compressed file") {
@@ -134,3 +139,95 @@ TEST_CASE("Write bzip2-compressed file with implicit close") {
     REQUIRE(osmium::file_size(output_file) > 10);
 }
 
+namespace {
+
+std::string compress_one_stream(const std::string& input) {
+    unsigned int dest_len = static_cast<unsigned int>(input.size() + input.size() / 100 + 600);
+    std::string dest(dest_len, '\0');
+    const int result = BZ2_bzBuffToBuffCompress(&*dest.begin(), &dest_len,
+                                                const_cast<char*>(input.data()),
+                                                static_cast<unsigned int>(input.size()),
+                                                9, 0, 0);
+    REQUIRE(result == BZ_OK);
+    dest.resize(dest_len);
+    return dest;
+}
+
+std::string decompress_all(const std::string& file_name) {
+    const int fd = osmium::io::detail::open_for_reading(file_name);
+    REQUIRE(fd > 0);
+
+    std::string all;
+    osmium::io::ParallelBzip2Decompressor decomp{fd};
+    for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+        all += data;
+    }
+    decomp.close();
+    return all;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Parallel decompressor reads multi-stream bzip2 file") {
+    const int count = count_fds();
+
+    const std::string output_file = "test_bzip2_multistream.txt.bz2";
+
+    std::string original;
+    std::string compressed;
+    for (int i = 0; i < 8; ++i) {
+        std::string part;
+        while (part.size() < 100000u) {
+            part += "data in stream ";
+            part += static_cast<char>('0' + i);
+            part += '\n';
+        }
+        original += part;
+        compressed += compress_one_stream(part);
+    }
+
+    const int fd = osmium::io::detail::open_for_writing(output_file, osmium::io::overwrite::allow);
+    REQUIRE(fd > 0);
+    osmium::io::detail::reliable_write(fd, compressed.data(), compressed.size());
+    osmium::io::detail::reliable_close(fd);
+
+    REQUIRE(decompress_all(output_file) == original);
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Parallel decompressor falls back to serial for single-stream file") {
+    const int count = count_fds();
+
+    const std::string output_file = "test_bzip2_singlestream.txt.bz2";
+
+    std::string original;
+    while (original.size() < 500000u) {
+        original += "the quick brown fox jumps over the lazy dog\n";
+    }
+
+    const std::string compressed{compress_one_stream(original)};
+
+    const int fd = osmium::io::detail::open_for_writing(output_file, osmium::io::overwrite::allow);
+    REQUIRE(fd > 0);
+    osmium::io::detail::reliable_write(fd, compressed.data(), compressed.size());
+    osmium::io::detail::reliable_close(fd);
+
+    REQUIRE(decompress_all(output_file) == original);
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Parallel decompressor on empty file") {
+    const int count = count_fds();
+
+    const std::string input_file = with_data_dir("t/io/empty_file");
+    const int fd = osmium::io::detail::open_for_reading(input_file);
+    REQUIRE(fd > 0);
+
+    osmium::io::ParallelBzip2Decompressor decomp{fd};
+    REQUIRE(decomp.read().empty());
+    decomp.close();
+
+    REQUIRE(count == count_fds());
+}
@@ -0,0 +1,137 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/changeset_index.hpp>
+#include <osmium/memory/buffer.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <string>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+    osmium::memory::Buffer build_changesets() {
+        osmium::memory::Buffer buffer{10 * 1000};
+
+        const auto pos1 = osmium::builder::add_changeset(buffer,
+            _cid(1),
+            _created_at(time_t(100)),
+            _closed_at(time_t(200)));
+        buffer.get<osmium::Changeset>(pos1).bounds() =
+            osmium::Box{1.0, 1.0, 2.0, 2.0};
+
+        const auto pos2 = osmium::builder::add_changeset(buffer,
+            _cid(2),
+            _created_at(time_t(300)),
+            _closed_at(time_t(400)));
+        buffer.get<osmium::Changeset>(pos2).bounds() =
+            osmium::Box{10.0, 10.0, 11.0, 11.0};
+
+        // Still open, no bounds.
+        osmium::builder::add_changeset(buffer,
+            _cid(3),
+            _created_at(time_t(500)));
+
+        return buffer;
+    }
+
+    osmium::io::ChangesetIndex build_index() {
+        osmium::io::ChangesetIndex index;
+
+        const auto buffer = build_changesets();
+        uint64_t offset = 1000;
+        for (const auto& changeset : buffer.select<osmium::Changeset>()) {
+            index.add(changeset, offset);
+            offset += 1000;
+        }
+        index.sort();
+
+        return index;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("Empty changeset index") {
+    const osmium::io::ChangesetIndex index;
+    REQUIRE(index.empty());
+    REQUIRE(index.select().empty());
+}
+
+TEST_CASE("Changeset index time window queries") {
+    const auto index = build_index();
+    REQUIRE(index.size() == 3);
+
+    SECTION("no restriction finds everything") {
+        REQUIRE(index.select().size() == 3);
+    }
+
+    SECTION("window on close time") {
+        const auto result = index.select(osmium::Timestamp{time_t(150)}, osmium::Timestamp{time_t(450)});
+        REQUIRE(result.size() == 2);
+        REQUIRE(result[0].id == 1);
+        REQUIRE(result[0].offset == 1000);
+        REQUIRE(result[1].id == 2);
+    }
+
+    SECTION("open changesets count with their creation time") {
+        const auto result = index.select(osmium::Timestamp{time_t(450)});
+        REQUIRE(result.size() == 1);
+        REQUIRE(result[0].id == 3);
+        REQUIRE(result[0].closed_at == 0);
+    }
+
+    SECTION("empty window finds nothing") {
+        REQUIRE(index.select(osmium::Timestamp{time_t(600)}).empty());
+    }
+}
+
+TEST_CASE("Changeset index bbox queries") {
+    const auto index = build_index();
+
+    SECTION("box overlapping one changeset") {
+        const auto result = index.select(osmium::start_of_time(), osmium::end_of_time(),
+                                         osmium::Box{1.5, 1.5, 3.0, 3.0});
+        REQUIRE(result.size() == 1);
+        REQUIRE(result[0].id == 1);
+        REQUIRE(result[0].bounds.bottom_left() == osmium::Location(1.0, 1.0));
+    }
+
+    SECTION("changesets without bounds never match a box") {
+        const auto result = index.select(osmium::start_of_time(), osmium::end_of_time(),
+                                         osmium::Box{-180.0, -90.0, 180.0, 90.0});
+        REQUIRE(result.size() == 2);
+    }
+
+    SECTION("box not overlapping anything") {
+        REQUIRE(index.select(osmium::start_of_time(), osmium::end_of_time(),
+                             osmium::Box{50.0, 50.0, 60.0, 60.0}).empty());
+    }
+}
+
+TEST_CASE("Changeset index sidecar round-trip") {
+    const std::string filename{"test-changeset-index.cidx"};
+
+    const auto index = build_index();
+    index.write(filename, osmium::io::overwrite::allow);
+
+    osmium::io::ChangesetIndex copy;
+    copy.read(filename);
+    std::remove(filename.c_str());
+
+    REQUIRE(copy.size() == index.size());
+    const auto result = copy.select(osmium::Timestamp{time_t(150)}, osmium::Timestamp{time_t(250)});
+    REQUIRE(result.size() == 1);
+    REQUIRE(result[0].id == 1);
+    REQUIRE(result[0].created_at == 100);
+    REQUIRE(result[0].closed_at == 200);
+
+    const std::string bogus_filename{"test-changeset-index-bogus.cidx"};
+    std::ofstream{bogus_filename} << "this is not an index file";
+    osmium::io::ChangesetIndex other;
+    REQUIRE_THROWS_AS(other.read(bogus_filename), const osmium::io_error&);
+    std::remove(bogus_filename.c_str());
+}
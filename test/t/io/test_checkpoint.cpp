@@ -0,0 +1,33 @@
+#include "catch.hpp"
+
+#include <osmium/io/checkpoint.hpp>
+
+TEST_CASE("Default constructed checkpoint is invalid") {
+    const osmium::io::Checkpoint checkpoint;
+    REQUIRE_FALSE(checkpoint.valid());
+    REQUIRE(checkpoint.offset() == 0);
+}
+
+TEST_CASE("Checkpoint serialization round-trip") {
+    osmium::io::Header header;
+    header.set("generator", "testcase");
+    header.set("osmosis_replication_sequence_number", "123");
+    header.set_has_multiple_object_versions(true);
+
+    const osmium::io::Checkpoint checkpoint{4711, header};
+    REQUIRE(checkpoint.valid());
+
+    const osmium::io::Checkpoint copy{checkpoint.to_string()};
+    REQUIRE(copy.valid());
+    REQUIRE(copy.offset() == 4711);
+    REQUIRE(copy.header().get("generator") == "testcase");
+    REQUIRE(copy.header().get("osmosis_replication_sequence_number") == "123");
+    REQUIRE(copy.header().has_multiple_object_versions());
+}
+
+TEST_CASE("Invalid checkpoint data throws") {
+    REQUIRE_THROWS_AS(osmium::io::Checkpoint{"nonsense"}, const osmium::io_error&);
+    REQUIRE_THROWS_AS(osmium::io::Checkpoint{"offset 0\n"}, const osmium::io_error&);
+    REQUIRE_THROWS_AS(osmium::io::Checkpoint{"offset 1\noption withoutequals\n"}, const osmium::io_error&);
+    REQUIRE_THROWS_AS(osmium::io::Checkpoint{""}, const osmium::io_error&);
+}
@@ -2,9 +2,13 @@
 
 #include "utils.hpp"
 
+// make the ParallelGzipCompressor available, too
+#define OSMIUM_WITH_PARALLEL_GZIP
+
 #include <osmium/io/detail/read_write.hpp>
 #include <osmium/io/gzip_compression.hpp>
 
+#include <cstddef>
 #include <string>
 
 TEST_CASE("Invalid file descriptor of gzip-compressed file") {
@@ -135,3 +139,64 @@ TEST_CASE("Write gzip-compressed file with implicit close") {
     REQUIRE(osmium::file_size(output_file) > 10);
 }
 
+TEST_CASE("Parallel compressor roundtrip") {
+    const int count = count_fds();
+
+    const std::string output_file = "test_gzip_parallel_out.txt.gz";
+
+    // more data than one compression chunk so several chunks are in flight
+    std::string data;
+    while (data.size() < 1024u * 1024u) {
+        data += "the quick brown fox jumps over the lazy dog\n";
+    }
+
+    {
+        const int fd = osmium::io::detail::open_for_writing(output_file, osmium::io::overwrite::allow);
+        REQUIRE(fd > 0);
+
+        osmium::io::ParallelGzipCompressor comp{fd, osmium::io::fsync::no};
+        std::size_t offset = 0;
+        while (offset < data.size()) {
+            comp.write(data.substr(offset, 10000u));
+            offset += 10000u;
+        }
+        comp.close();
+    }
+
+    {
+        const int fd = osmium::io::detail::open_for_reading(output_file);
+        REQUIRE(fd > 0);
+
+        std::string all;
+        osmium::io::GzipDecompressor decomp{fd};
+        for (std::string out = decomp.read(); !out.empty(); out = decomp.read()) {
+            all += out;
+        }
+        decomp.close();
+
+        REQUIRE(all == data);
+    }
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Parallel compressor writes valid empty gzip file") {
+    const std::string output_file = "test_gzip_parallel_empty.txt.gz";
+
+    {
+        const int fd = osmium::io::detail::open_for_writing(output_file, osmium::io::overwrite::allow);
+        REQUIRE(fd > 0);
+
+        osmium::io::ParallelGzipCompressor comp{fd, osmium::io::fsync::no};
+        comp.close();
+    }
+
+    {
+        const int fd = osmium::io::detail::open_for_reading(output_file);
+        REQUIRE(fd > 0);
+
+        osmium::io::GzipDecompressor decomp{fd};
+        REQUIRE(decomp.read().empty());
+        decomp.close();
+    }
+}
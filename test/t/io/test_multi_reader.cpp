@@ -0,0 +1,80 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/io/multi_reader.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <vector>
+
+static std::vector<osmium::io::File> test_files() {
+    return std::vector<osmium::io::File>{
+        osmium::io::File{with_data_dir("t/io/data-multi-1.osm")},
+        osmium::io::File{with_data_dir("t/io/data-multi-2.osm")}
+    };
+}
+
+TEST_CASE("MultiReader with no files") {
+    osmium::io::MultiReader reader{std::vector<osmium::io::File>{}};
+    REQUIRE_FALSE(reader.read());
+    REQUIRE(reader.eof());
+}
+
+TEST_CASE("MultiReader concatenates files") {
+    osmium::io::MultiReader reader{test_files()};
+
+    std::vector<osmium::object_id_type> ids;
+    while (const auto buffer = reader.read()) {
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            ids.push_back(object.id());
+        }
+    }
+    reader.close();
+
+    REQUIRE(reader.eof());
+    REQUIRE(ids == (std::vector<osmium::object_id_type>{1, 3, 2, 4}));
+}
+
+TEST_CASE("MultiReader merges files in object order") {
+    osmium::io::MultiReader reader{test_files(), osmium::io::MultiReader::mode::merge};
+
+    std::vector<osmium::object_id_type> ids;
+    while (const auto buffer = reader.read()) {
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            ids.push_back(object.id());
+        }
+    }
+    reader.close();
+
+    REQUIRE(reader.eof());
+    REQUIRE(ids == (std::vector<osmium::object_id_type>{1, 2, 3, 4}));
+}
+
+TEST_CASE("MultiReader merges overlapping files keeping only the newest versions") {
+    auto files = test_files();
+    files.emplace_back(with_data_dir("t/io/data-multi-3.osm"));
+
+    osmium::io::MultiReader reader{files, osmium::io::MultiReader::mode::merge_unique};
+
+    std::vector<osmium::object_id_type> ids;
+    std::vector<osmium::object_version_type> versions;
+    while (const auto buffer = reader.read()) {
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            ids.push_back(object.id());
+            versions.push_back(object.version());
+        }
+    }
+    reader.close();
+
+    REQUIRE(reader.eof());
+    REQUIRE(ids == (std::vector<osmium::object_id_type>{1, 2, 3, 4}));
+    REQUIRE(versions == (std::vector<osmium::object_version_type>{2, 1, 2, 1}));
+}
+
+TEST_CASE("MultiReader forwards options to the Readers") {
+    osmium::io::MultiReader reader{test_files(), osmium::osm_entity_bits::way};
+
+    REQUIRE_FALSE(reader.read());
+    REQUIRE(reader.eof());
+}
@@ -0,0 +1,85 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/multi_writer.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/io/xml_output.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <vector>
+
+TEST_CASE("MultiWriter splits one input over several outputs") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 2.0));
+    osmium::builder::add_node(buffer, _id(2), _location(1.1, 2.1));
+    osmium::builder::add_way(buffer, _id(10), _nodes({1, 2}));
+
+    const std::string nodes_filename{"test-multi-writer-nodes.osm"};
+    const std::string ways_filename{"test-multi-writer-ways.osm"};
+
+    const std::vector<osmium::io::File> files{
+        osmium::io::File{nodes_filename},
+        osmium::io::File{ways_filename}
+    };
+
+    osmium::io::MultiWriter writer{files,
+        [](const osmium::OSMObject& object, std::vector<std::size_t>& indexes) {
+            indexes.push_back(object.type() == osmium::item_type::node ? 0 : 1);
+        },
+        osmium::io::overwrite::allow};
+
+    REQUIRE(writer.size() == 2);
+
+    writer(buffer);
+    writer.close();
+
+    const auto nodes = osmium::io::read_file(nodes_filename);
+    const auto ways = osmium::io::read_file(ways_filename);
+    std::remove(nodes_filename.c_str());
+    std::remove(ways_filename.c_str());
+
+    const auto node_objects = nodes.select<osmium::OSMObject>();
+    REQUIRE(std::distance(node_objects.cbegin(), node_objects.cend()) == 2);
+    REQUIRE(node_objects.cbegin()->id() == 1);
+
+    const auto way_objects = ways.select<osmium::OSMObject>();
+    REQUIRE(std::distance(way_objects.cbegin(), way_objects.cend()) == 1);
+    REQUIRE(way_objects.cbegin()->id() == 10);
+}
+
+TEST_CASE("MultiWriter drops objects the routing function sends nowhere") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 2.0));
+    osmium::builder::add_node(buffer, _id(2), _location(1.1, 2.1));
+
+    const std::string filename{"test-multi-writer-dropped.osm"};
+
+    osmium::io::MultiWriter writer{std::vector<osmium::io::File>{osmium::io::File{filename}},
+        [](const osmium::OSMObject& object, std::vector<std::size_t>& indexes) {
+            if (object.id() == 2) {
+                indexes.push_back(0);
+            }
+        },
+        osmium::io::overwrite::allow};
+
+    writer(buffer);
+    writer.close();
+
+    const auto result = osmium::io::read_file(filename);
+    std::remove(filename.c_str());
+
+    const auto objects = result.select<osmium::OSMObject>();
+    REQUIRE(std::distance(objects.cbegin(), objects.cend()) == 1);
+    REQUIRE(objects.cbegin()->id() == 2);
+}
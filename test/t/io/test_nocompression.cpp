@@ -4,6 +4,7 @@
 
 #include <osmium/io/compression.hpp>
 
+#include <cstdlib>
 #include <string>
 
 TEST_CASE("Invalid file descriptor of uncompressed file") {
@@ -123,3 +124,32 @@ TEST_CASE("Write uncompressed file with implicit close") {
     REQUIRE(osmium::file_size(output_file) == 3);
 }
 
+
+#ifndef _WIN32
+TEST_CASE("Read uncompressed file with direct reads enabled") {
+    ::setenv("OSMIUM_DIRECT_READS", "yes", 1);
+
+    const int count = count_fds();
+
+    const std::string input_file = with_data_dir("t/io/data.txt");
+    const int fd = osmium::io::detail::open_for_reading(input_file);
+    REQUIRE(fd > 0);
+
+    std::string all;
+    {
+        osmium::io::NoDecompressor decomp{fd};
+        for (std::string data = decomp.read(); !data.empty(); data = decomp.read()) {
+            all += data;
+        }
+        decomp.close();
+    }
+
+    ::unsetenv("OSMIUM_DIRECT_READS");
+
+    REQUIRE(all.size() >= 9);
+    all.resize(8);
+    REQUIRE("TESTDATA" == all);
+
+    REQUIRE(count == count_fds());
+}
+#endif
@@ -0,0 +1,160 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/o5m_input.hpp>
+#include <osmium/io/o5m_output.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/visitor.hpp>
+
+#include <string>
+#include <utility>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+    osmium::memory::Buffer build_test_data() {
+        osmium::memory::Buffer buffer{1024 * 10};
+
+        osmium::builder::add_node(buffer, _id(1), _version(2), _timestamp("2018-01-01T01:00:00Z"),
+            _cid(30), _uid(17), _user("foo"),
+            _location(1.02, 2.03),
+            _tag("amenity", "post_box"));
+        osmium::builder::add_node(buffer, _id(2), _version(3), _timestamp("2018-01-01T02:00:00Z"),
+            _cid(31), _uid(17), _user("foo"),
+            _location(1.03, 2.04));
+        osmium::builder::add_way(buffer, _id(10), _version(4), _timestamp("2018-01-01T03:00:00Z"),
+            _cid(32), _uid(18), _user("bar"),
+            _nodes({1, 2}),
+            _tag("highway", "residential"));
+        osmium::builder::add_relation(buffer, _id(20), _version(5), _timestamp("2018-01-01T04:00:00Z"),
+            _cid(33), _uid(18), _user("bar"),
+            _member(osmium::item_type::way, 10, "outer"),
+            _tag("type", "multipolygon"));
+
+        return buffer;
+    }
+
+    osmium::memory::Buffer write_and_read(const std::string& filename, const std::string& add_metadata) {
+        osmium::io::File file{filename};
+        file.set("add_metadata", add_metadata);
+
+        osmium::io::Writer writer{file, osmium::io::overwrite::allow};
+        writer(build_test_data());
+        writer.close();
+
+        osmium::io::Reader reader{filename};
+        osmium::memory::Buffer buffer = reader.read();
+        reader.close();
+        REQUIRE(buffer);
+
+        return buffer;
+    }
+
+    void check_ids_and_data(const osmium::memory::Buffer& buffer) {
+        const auto objects = buffer.select<osmium::OSMObject>();
+        REQUIRE(objects.size() == 4);
+
+        auto it = objects.cbegin();
+        REQUIRE(it->id() == 1);
+        REQUIRE(static_cast<const osmium::Node&>(*it).location() == osmium::Location(1.02, 2.03));
+        REQUIRE(std::string{it->tags()["amenity"]} == "post_box");
+        ++it;
+        REQUIRE(it->id() == 2);
+        ++it;
+        REQUIRE(it->id() == 10);
+        REQUIRE(static_cast<const osmium::Way&>(*it).nodes().size() == 2);
+        REQUIRE(static_cast<const osmium::Way&>(*it).nodes()[1].ref() == 2);
+        ++it;
+        REQUIRE(it->id() == 20);
+        const auto& members = static_cast<const osmium::Relation&>(*it).members();
+        REQUIRE(members.size() == 1);
+        REQUIRE(members.cbegin()->ref() == 10);
+        REQUIRE(std::string{members.cbegin()->role()} == "outer");
+    }
+
+} // anonymous namespace
+
+TEST_CASE("o5m round trip with all metadata") {
+    const auto buffer = write_and_read("test-o5m-roundtrip-all.o5m", "all");
+    check_ids_and_data(buffer);
+
+    const auto objects = buffer.select<osmium::OSMObject>();
+    auto it = objects.cbegin();
+    REQUIRE(it->version() == 2);
+    REQUIRE(it->timestamp() == osmium::Timestamp{"2018-01-01T01:00:00Z"});
+    REQUIRE(it->changeset() == 30);
+    REQUIRE(it->uid() == 17);
+    REQUIRE(std::string{it->user()} == "foo");
+    ++it;
+    REQUIRE(it->timestamp() == osmium::Timestamp{"2018-01-01T02:00:00Z"});
+    ++it;
+    REQUIRE(it->version() == 4);
+    REQUIRE(it->changeset() == 32);
+    REQUIRE(std::string{it->user()} == "bar");
+    ++it;
+    REQUIRE(it->version() == 5);
+    REQUIRE(it->uid() == 18);
+}
+
+TEST_CASE("o5m round trip without metadata") {
+    const auto buffer = write_and_read("test-o5m-roundtrip-none.o5m", "none");
+    check_ids_and_data(buffer);
+
+    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+        REQUIRE(object.version() == 0);
+        REQUIRE(object.timestamp() == osmium::Timestamp{});
+        REQUIRE(object.changeset() == 0);
+        REQUIRE(object.uid() == 0);
+        REQUIRE(std::string{object.user()}.empty());
+    }
+}
+
+TEST_CASE("o5m round trip with version only") {
+    const auto buffer = write_and_read("test-o5m-roundtrip-version.o5m", "version");
+    check_ids_and_data(buffer);
+
+    const auto objects = buffer.select<osmium::OSMObject>();
+    auto it = objects.cbegin();
+    REQUIRE(it->version() == 2);
+    REQUIRE(it->timestamp() == osmium::Timestamp{});
+    REQUIRE(it->changeset() == 0);
+    ++it;
+    ++it;
+    REQUIRE(it->version() == 4);
+    REQUIRE(it->timestamp() == osmium::Timestamp{});
+}
+
+TEST_CASE("o5m round trip with version and timestamp") {
+    const auto buffer = write_and_read("test-o5m-roundtrip-version-timestamp.o5m", "version+timestamp");
+    check_ids_and_data(buffer);
+
+    const auto objects = buffer.select<osmium::OSMObject>();
+    auto it = objects.cbegin();
+    REQUIRE(it->version() == 2);
+    REQUIRE(it->timestamp() == osmium::Timestamp{"2018-01-01T01:00:00Z"});
+    REQUIRE(it->changeset() == 0);
+    REQUIRE(it->uid() == 0);
+    ++it;
+    ++it;
+    REQUIRE(it->version() == 4);
+    REQUIRE(it->timestamp() == osmium::Timestamp{"2018-01-01T03:00:00Z"});
+}
+
+TEST_CASE("o5m round trip without version does not write other metadata") {
+    // The o5m info section starts with the version and a version of 0
+    // means "no info at all", so excluding the version from the
+    // metadata options means no other metadata can be written either.
+    const auto buffer = write_and_read("test-o5m-roundtrip-no-version.o5m", "timestamp+changeset+uid+user");
+    check_ids_and_data(buffer);
+
+    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+        REQUIRE(object.version() == 0);
+        REQUIRE(object.timestamp() == osmium::Timestamp{});
+        REQUIRE(object.changeset() == 0);
+        REQUIRE(object.uid() == 0);
+    }
+}
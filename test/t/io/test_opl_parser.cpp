@@ -213,6 +213,25 @@ TEST_CASE("Parse OPL: parse string") {
         REQUIRE(s == e);
     }
 
+    SECTION("long string so the vectorized delimiter scan is used") {
+        const std::string str(100, 'x');
+        const std::string input{str + " bar"};
+        const char* s = input.c_str();
+        const char* e = s + str.size();
+        oid::opl_parse_string(&s, result);
+        REQUIRE(result == str);
+        REQUIRE(s == e);
+    }
+
+    SECTION("long string with escape near a 16 byte boundary") {
+        const std::string input{"aaaaaaaaaaaaaaa%21%bbbbbbbbbbbbbbbbbbbbbbbbb cc"};
+        const char* s = input.c_str();
+        const char* e = s + input.size() - 3;
+        oid::opl_parse_string(&s, result);
+        REQUIRE(result == "aaaaaaaaaaaaaaa!bbbbbbbbbbbbbbbbbbbbbbbbb");
+        REQUIRE(s == e);
+    }
+
     SECTION("string with escaped characters") {
         const char* s = "foo%3d%bar";
         const char* e = s + std::strlen(s);
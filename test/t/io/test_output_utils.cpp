@@ -2,6 +2,7 @@
 
 #include <osmium/io/detail/string_util.hpp>
 
+#include <cstddef>
 #include <iterator>
 #include <locale>
 #include <stdexcept>
@@ -94,6 +95,67 @@ TEST_CASE("html encoding encodes special XML characters") {
     REQUIRE(out == "&amp; &quot; &apos; &lt; &gt; &#xA; &#xD; &#x9;");
 }
 
+TEST_CASE("html encoding encodes special XML characters in long strings") {
+    // long enough that the vectorized clean-run scan is used
+    std::string s;
+    std::string expected;
+    for (int i = 0; i < 100; ++i) {
+        s += "some text without special characters ";
+        expected += "some text without special characters ";
+        s += "<&>";
+        expected += "&lt;&amp;&gt;";
+    }
+
+    std::string out;
+    osmium::io::detail::append_xml_encoded_string(out, s.c_str());
+    REQUIRE(out == expected);
+}
+
+TEST_CASE("runtime-dispatched clean-run scan gives the same result as the baseline") {
+    std::string s;
+    for (int i = 0; i < 20; ++i) {
+        s += "a text that is long enough for all vector widths ";
+    }
+
+    for (const std::size_t pos : {std::size_t(0), std::size_t(1), std::size_t(15),
+                                  std::size_t(16), std::size_t(31), std::size_t(32),
+                                  std::size_t(33), s.size() - 1}) {
+        std::string str{s};
+        str[pos] = '<';
+        REQUIRE(osmium::io::detail::xml_clean_prefix_length(str.data(), str.size()) == pos);
+        REQUIRE(osmium::io::detail::xml_clean_prefix_length_default(str.data(), str.size()) == pos);
+    }
+
+    REQUIRE(osmium::io::detail::xml_clean_prefix_length(s.data(), s.size()) == s.size());
+}
+
+TEST_CASE("runtime-dispatched OPL clean-run scan gives the same result as the baseline") {
+    std::string s;
+    for (int i = 0; i < 20; ++i) {
+        s += "a-text-that-is-long-enough-for-all-vector-widths;";
+    }
+
+    for (const char special : {' ', '%', ',', '=', '@', '\n', '\x7f', '\xc3'}) {
+        for (const std::size_t pos : {std::size_t(0), std::size_t(1), std::size_t(15),
+                                      std::size_t(16), std::size_t(31), std::size_t(32),
+                                      std::size_t(33), s.size() - 1}) {
+            std::string str{s};
+            str[pos] = special;
+            REQUIRE(osmium::io::detail::opl_clean_prefix_length(str.data(), str.size()) == pos);
+            REQUIRE(osmium::io::detail::opl_clean_prefix_length_default(str.data(), str.size()) == pos);
+        }
+    }
+
+    REQUIRE(osmium::io::detail::opl_clean_prefix_length(s.data(), s.size()) == s.size());
+}
+
+TEST_CASE("html encoding leaves multibyte UTF-8 characters alone") {
+    const char* s = "gr\xc3\xbc\xc3\xbcner <Baum das\xc2\xa0ist ein l\xc3\xa4ngerer Text>";
+    std::string out;
+    osmium::io::detail::append_xml_encoded_string(out, s);
+    REQUIRE(out == "gr\xc3\xbc\xc3\xbcner &lt;Baum das\xc2\xa0ist ein l\xc3\xa4ngerer Text&gt;");
+}
+
 TEST_CASE("debug encoding does not encode normal characters") {
     const char* s = "abc123,.-";
     std::string out;
@@ -2,9 +2,21 @@
 
 #include "utils.hpp"
 
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/pbf_blob_index.hpp>
+#include <osmium/io/pbf_change_applier.hpp>
 #include <osmium/io/pbf_input.hpp>
+#include <osmium/io/pbf_output.hpp>
 #include <osmium/io/reader.hpp>
+#include <osmium/osm/metadata_options.hpp>
 #include <osmium/osm/object.hpp>
+#include <osmium/tags/tags_filter.hpp>
+
+#include <cstdio>
+#include <vector>
+#include <iterator>
+#include <string>
+#include <utility>
 
 /**
  * Osmosis writes PBF with changeset=-1 if its input file did not contain the changeset field.
@@ -43,3 +55,241 @@ TEST_CASE("Read PBF file with version=-1 and changeset=-1 and DenseNodes (writte
     REQUIRE(object.version() == 0);
     REQUIRE(object.changeset() == 0);
 }
+
+TEST_CASE("Read PBF file with tag filter pushed down into the decoder") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 2.0), _tag("amenity", "post_box"));
+    osmium::builder::add_node(buffer, _id(2), _location(1.1, 2.1));
+    osmium::builder::add_node(buffer, _id(3), _location(1.2, 2.2), _tag("highway", "crossing"));
+    osmium::builder::add_way(buffer, _id(10), _nodes({1, 2, 3}), _tag("highway", "primary"));
+    osmium::builder::add_way(buffer, _id(11), _nodes({1, 2}));
+
+    const std::string filename{"test_tags_filter.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    osmium::TagsFilter filter;
+    filter.add_rule(true, "amenity");
+    filter.add_rule(true, "highway", "primary");
+
+    const auto result = osmium::io::read_file(filename, osmium::io::pbf_tags_filter{filter});
+    std::remove(filename.c_str());
+
+    const auto objects = result.select<osmium::OSMObject>();
+    REQUIRE(std::distance(objects.cbegin(), objects.cend()) == 2);
+
+    auto it = objects.cbegin();
+    REQUIRE(it->id() == 1);
+    REQUIRE(it->tags().has_tag("amenity", "post_box"));
+    ++it;
+    REQUIRE(it->id() == 10);
+    REQUIRE(it->tags().has_tag("highway", "primary"));
+}
+
+TEST_CASE("Build blob index for PBF file") {
+    osmium::io::PBFBlobIndex index;
+    index.build(with_data_dir("t/io/data_pbf_version-1-densenodes.osm.pbf"));
+
+    REQUIRE(index.size() == 1);
+    const auto& blob = index.blobs().front();
+    REQUIRE(blob.entity_types == osmium::osm_entity_bits::node);
+    REQUIRE(blob.first_id == 1);
+    REQUIRE(blob.last_id == 1);
+}
+
+TEST_CASE("Write and read back blob index sidecar file") {
+    osmium::io::PBFBlobIndex index;
+    index.build(with_data_dir("t/io/data_pbf_version-1-densenodes.osm.pbf"));
+
+    const std::string sidecar{"test_blob_index.idx"};
+    index.write(sidecar, osmium::io::overwrite::allow);
+
+    osmium::io::PBFBlobIndex index2;
+    index2.read(sidecar);
+    std::remove(sidecar.c_str());
+
+    REQUIRE(index2.size() == index.size());
+    REQUIRE(index2.blobs().front().offset == index.blobs().front().offset);
+    REQUIRE(index2.blobs().front().record_size == index.blobs().front().record_size);
+    REQUIRE(index2.blobs().front().entity_types == index.blobs().front().entity_types);
+}
+
+TEST_CASE("Read PBF file restricted to blob ranges from index") {
+    const std::string filename{with_data_dir("t/io/data_pbf_version-1-densenodes.osm.pbf")};
+
+    osmium::io::PBFBlobIndex index;
+    index.build(filename);
+
+    SECTION("matching selection yields the data") {
+        const auto ranges = index.select(osmium::osm_entity_bits::node);
+        REQUIRE(ranges.ranges->size() == 1);
+
+        osmium::io::Reader reader{filename, ranges};
+        const auto buffer = reader.read();
+        REQUIRE(buffer);
+        REQUIRE(buffer.cbegin<osmium::OSMObject>()->id() == 1);
+    }
+
+    SECTION("non-matching selection yields nothing") {
+        const auto ranges = index.select(osmium::osm_entity_bits::way);
+        REQUIRE(ranges.ranges->empty());
+
+        osmium::io::Reader reader{filename, ranges};
+        const auto buffer = reader.read();
+        REQUIRE_FALSE(buffer);
+    }
+
+    SECTION("id range outside yields nothing") {
+        const auto ranges = index.select(osmium::osm_entity_bits::node, 100, 200);
+        REQUIRE(ranges.ranges->empty());
+    }
+}
+
+TEST_CASE("Copy blobs byte-for-byte with raw blob pass-through") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 2.0));
+    osmium::builder::add_node(buffer, _id(2), _location(1.1, 2.1));
+    osmium::builder::add_way(buffer, _id(10), _nodes({1, 2}));
+
+    const std::string filename{"test_raw_blob_in.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    osmium::io::PBFBlobIndex index;
+    index.build(filename);
+    REQUIRE(index.size() == 2); // one node blob, one way blob
+
+    const std::string copy_filename{"test_raw_blob_out.osm.pbf"};
+    {
+        osmium::io::PBFBlobSource source{filename};
+        osmium::io::Writer copy_writer{copy_filename, osmium::io::overwrite::allow};
+        for (const auto& blob : index.blobs()) {
+            copy_writer.write_raw_blob(source.read(blob));
+        }
+        copy_writer.close();
+    }
+
+    const auto result = osmium::io::read_file(copy_filename);
+    std::remove(filename.c_str());
+    std::remove(copy_filename.c_str());
+
+    const auto objects = result.select<osmium::OSMObject>();
+    REQUIRE(std::distance(objects.cbegin(), objects.cend()) == 3);
+
+    auto it = objects.cbegin();
+    REQUIRE(it->id() == 1);
+    ++it;
+    REQUIRE(it->id() == 2);
+    ++it;
+    REQUIRE(it->id() == 10);
+}
+
+TEST_CASE("Read PBF file with only some metadata fields") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _version(3), _timestamp("2018-01-01T10:00:00Z"), _cid(42), _uid(7), _user("foo"), _location(1.0, 2.0));
+    osmium::builder::add_node(buffer, _id(2), _version(1), _timestamp("2018-01-02T10:00:00Z"), _cid(43), _uid(8), _user("bar"), _location(1.1, 2.1));
+    osmium::builder::add_way(buffer, _id(10), _version(2), _timestamp("2018-01-03T10:00:00Z"), _cid(44), _uid(9), _user("baz"), _nodes({1, 2}));
+
+    const std::string filename{"test_metadata_options.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    const auto result = osmium::io::read_file(filename, osmium::metadata_options{"version+timestamp"});
+    std::remove(filename.c_str());
+
+    const auto objects = result.select<osmium::OSMObject>();
+    REQUIRE(std::distance(objects.cbegin(), objects.cend()) == 3);
+
+    for (const auto& object : objects) {
+        REQUIRE(object.version() > 0);
+        REQUIRE(object.timestamp().valid());
+        REQUIRE(object.changeset() == 0);
+        REQUIRE(object.uid() == 0);
+        REQUIRE(object.user()[0] == '\0');
+    }
+
+    auto it = objects.cbegin();
+    REQUIRE(it->version() == 3);
+    REQUIRE(it->timestamp() == osmium::Timestamp{"2018-01-01T10:00:00Z"});
+    ++it;
+    ++it;
+    REQUIRE(it->version() == 2);
+    REQUIRE(it->timestamp() == osmium::Timestamp{"2018-01-03T10:00:00Z"});
+}
+
+TEST_CASE("Apply change file to PBF file on the blob level") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _version(1), _location(1.0, 2.0));
+    osmium::builder::add_node(buffer, _id(2), _version(1), _location(1.1, 2.1));
+    osmium::builder::add_node(buffer, _id(3), _version(1), _location(1.2, 2.2));
+    osmium::builder::add_way(buffer, _id(10), _version(1), _nodes({1, 2}));
+
+    const std::string filename{"test_change_applier_in.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    // modify node 2, delete node 3, create node 5 and way 11
+    osmium::memory::Buffer changes{1024UL * 10UL};
+    osmium::builder::add_node(changes, _id(2), _version(2), _location(5.1, 5.2));
+    osmium::builder::add_node(changes, _id(3), _version(2), _deleted());
+    osmium::builder::add_node(changes, _id(5), _version(1), _location(1.4, 2.4));
+    osmium::builder::add_way(changes, _id(11), _version(1), _nodes({1, 5}));
+
+    const std::string out_filename{"test_change_applier_out.osm.pbf"};
+    osmium::io::PBFChangeApplier applier{filename, osmium::io::File{out_filename}};
+    applier.add_changes(std::move(changes));
+    applier.apply();
+
+    // the node blob is rewritten, the way blob copied byte-for-byte
+    // (the created way is past the end of the way blob's id range)
+    REQUIRE(applier.blobs_copied() == 1);
+    REQUIRE(applier.blobs_rewritten() == 1);
+
+    const auto result = osmium::io::read_file(out_filename);
+    std::remove(filename.c_str());
+    std::remove(out_filename.c_str());
+
+    std::vector<osmium::object_id_type> ids;
+    std::vector<osmium::object_version_type> versions;
+    for (const auto& object : result.select<osmium::OSMObject>()) {
+        ids.push_back(object.id());
+        versions.push_back(object.version());
+    }
+    REQUIRE(ids == (std::vector<osmium::object_id_type>{1, 2, 5, 10, 11}));
+    REQUIRE(versions == (std::vector<osmium::object_version_type>{1, 2, 1, 1, 1}));
+}
+
+TEST_CASE("Skip blobs without requested entity types using BlobHeader indexdata") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 2.0));
+    osmium::builder::add_node(buffer, _id(2), _location(1.1, 2.1));
+    osmium::builder::add_way(buffer, _id(10), _nodes({1, 2}));
+
+    const std::string filename{"test_indexdata.osm.pbf"};
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    // the node blob is skipped based on the BlobHeader alone, without
+    // being decompressed or decoded
+    const auto result = osmium::io::read_file(filename, osmium::osm_entity_bits::way);
+    std::remove(filename.c_str());
+
+    const auto objects = result.select<osmium::OSMObject>();
+    REQUIRE(std::distance(objects.cbegin(), objects.cend()) == 1);
+    REQUIRE(objects.cbegin()->id() == 10);
+}
@@ -0,0 +1,43 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/io/xml_output.hpp>
+#include <osmium/util/verbose_output.hpp>
+
+#include <utility>
+
+TEST_CASE("Reader can report its pipeline metrics on close") {
+    osmium::io::Reader reader{with_data_dir("t/io/data.osm")};
+    while (reader.read()) {
+    }
+
+    const auto metrics = reader.metrics();
+    REQUIRE(metrics.osmdata_queue.push >= 1);
+    REQUIRE(metrics.osmdata_queue.pop >= 1);
+
+    osmium::util::VerboseOutput verbose_output{true};
+    reader.close(verbose_output);
+    REQUIRE(reader.eof());
+}
+
+TEST_CASE("Writer can report its pipeline metrics on close") {
+    osmium::io::Reader reader{with_data_dir("t/io/data.osm")};
+    const osmium::io::Header header{reader.header()};
+
+    const std::string filename{"test_pipeline_metrics_out.osm"};
+    osmium::io::Writer writer{filename, header, osmium::io::overwrite::allow};
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        writer(std::move(buffer));
+    }
+    reader.close();
+
+    REQUIRE(writer.metrics().raw_output_queue.push >= 1);
+
+    // not verbose: close(VerboseOutput&) must not print anything
+    osmium::util::VerboseOutput quiet_output{false};
+    writer.close(quiet_output);
+}
@@ -3,13 +3,17 @@
 #include "utils.hpp"
 
 #include <osmium/handler.hpp>
+#include <osmium/io/checkpoint.hpp>
 #include <osmium/io/any_compression.hpp>
 #include <osmium/io/pbf_input.hpp>
 #include <osmium/io/xml_input.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/visitor.hpp>
 
+#include <cstddef>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 struct CountHandler : public osmium::handler::Handler {
 
@@ -231,6 +235,38 @@ TEST_CASE("Reader should decode zero node positions in history (PBF)") {
     REQUIRE(count == count_fds());
 }
 
+TEST_CASE("Reader with mmap_input option gives same result (PBF)") {
+    const int count = count_fds();
+
+    osmium::io::Reader reader{with_data_dir("t/io/deleted_nodes.osh.pbf"),
+                              osmium::osm_entity_bits::node,
+                              osmium::io::mmap_input::yes};
+    ZeroPositionNodeCountHandler handler;
+
+    osmium::apply(reader, handler);
+
+    REQUIRE(handler.count == 0);
+    REQUIRE(handler.total_count == 2);
+
+    reader.close();
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Reader ignores mmap_input option for XML files") {
+    const int count = count_fds();
+
+    osmium::io::Reader reader{with_data_dir("t/io/data.osm"),
+                              osmium::io::mmap_input::yes};
+    CountHandler handler;
+
+    osmium::apply(reader, handler);
+
+    REQUIRE(handler.count == 1);
+
+    reader.close();
+    REQUIRE(count == count_fds());
+}
+
 TEST_CASE("Reader should fail with nonexistent file") {
     const int count = count_fds();
 
@@ -342,3 +378,59 @@ TEST_CASE("Can not read after close") {
     REQUIRE(count == count_fds());
 }
 
+
+TEST_CASE("Reader checkpoint and resume (PBF)") {
+    const std::string filename{with_data_dir("t/io/deleted_nodes.osh.pbf")};
+
+    // Read the whole file, taking a checkpoint after every buffer.
+    std::vector<osmium::io::Checkpoint> checkpoints;
+    int total_count = 0;
+    {
+        osmium::io::Reader reader{filename, osmium::osm_entity_bits::node};
+        checkpoints.push_back(reader.checkpoint());
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            for (const auto& node : buffer.select<osmium::Node>()) {
+                (void)node;
+                ++total_count;
+            }
+            checkpoints.push_back(reader.checkpoint());
+        }
+        reader.close();
+    }
+
+    REQUIRE(total_count == 2);
+    REQUIRE(checkpoints.size() >= 2);
+
+    // Resuming from the first checkpoint repeats the whole data,
+    // resuming from the last delivers nothing.
+    for (std::size_t n = 0; n < checkpoints.size(); ++n) {
+        // Round-trip through the serialization format.
+        const osmium::io::Checkpoint checkpoint{checkpoints[n].to_string()};
+        REQUIRE(checkpoint.offset() == checkpoints[n].offset());
+
+        osmium::io::Reader reader{filename, osmium::osm_entity_bits::node, checkpoint};
+        REQUIRE(reader.header().get("generator") == checkpoints[n].header().get("generator"));
+
+        int count = 0;
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            for (const auto& node : buffer.select<osmium::Node>()) {
+                (void)node;
+                ++count;
+            }
+        }
+        reader.close();
+
+        if (n == 0) {
+            REQUIRE(count == total_count);
+        }
+        if (n == checkpoints.size() - 1) {
+            REQUIRE(count == 0);
+        }
+    }
+}
+
+TEST_CASE("Reader checkpoint fails for XML files") {
+    osmium::io::Reader reader{with_data_dir("t/io/data.osm")};
+    REQUIRE_THROWS_AS(reader.checkpoint(), const osmium::io_error&);
+    reader.close();
+}
@@ -0,0 +1,47 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/remote_source.hpp>
+
+#include <cstddef>
+#include <string>
+
+TEST_CASE("Default remote sources are registered") {
+    const auto& factory = osmium::io::RemoteSourceFactory::instance();
+    REQUIRE(factory.has_source("http"));
+    REQUIRE(factory.has_source("https"));
+    REQUIRE(factory.has_source("ftp"));
+    REQUIRE(factory.has_source("file"));
+    REQUIRE_FALSE(factory.has_source("nonsense"));
+}
+
+TEST_CASE("Opening through an unregistered scheme fails") {
+    int childpid = 0;
+    REQUIRE_THROWS_AS(osmium::io::RemoteSourceFactory::instance().open("nonsense", "nonsense://foo", 0, 0, &childpid),
+                      const osmium::io_error&);
+}
+
+TEST_CASE("User-registered remote source is used") {
+    osmium::io::RemoteSourceFactory::instance().register_remote_source("testlocal",
+        [](const std::string& filename, std::size_t /*offset*/, std::size_t /*length*/, int* /*childpid*/) {
+            // strip the "testlocal:" prefix and open as local file
+            return osmium::io::detail::open_for_reading(filename.substr(10));
+        });
+
+    REQUIRE(osmium::io::RemoteSourceFactory::instance().has_source("testlocal"));
+
+    const std::string input_file = with_data_dir("t/io/data.txt");
+    int childpid = 0;
+    const int fd = osmium::io::RemoteSourceFactory::instance().open("testlocal", "testlocal:" + input_file, 0, 0, &childpid);
+    REQUIRE(fd > 0);
+    REQUIRE(childpid == 0);
+
+    char buffer[8];
+    const auto nread = osmium::io::detail::reliable_read(fd, buffer, sizeof(buffer));
+    REQUIRE(nread == 8);
+    REQUIRE(std::string(buffer, 8) == "TESTDATA");
+
+    osmium::io::detail::reliable_close(fd);
+}
@@ -138,3 +138,20 @@ TEST_CASE("Lots of strings in string table so chunk overflows") {
     REQUIRE(it == st.end());
 }
 
+TEST_CASE("Strings are found again after the string table index has grown") {
+    osmium::io::detail::StringTable st;
+
+    const int n = 2000;
+    for (int i = 0; i < n; ++i) {
+        const auto s = std::to_string(i);
+        REQUIRE(st.add(s.c_str()) == i + 1);
+    }
+
+    for (int i = 0; i < n; ++i) {
+        const auto s = std::to_string(i);
+        REQUIRE(st.add(s.c_str()) == i + 1);
+    }
+
+    REQUIRE(st.size() == n + 1);
+}
+
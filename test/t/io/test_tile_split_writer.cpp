@@ -0,0 +1,105 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/index/multimap/sparse_mem_array.hpp>
+#include <osmium/io/tile_split_writer.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/io/xml_output.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <string>
+
+namespace {
+
+    using node_index_type = osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, uint64_t>;
+    using way_index_type = osmium::index::multimap::SparseMemArray<osmium::unsigned_object_id_type, uint64_t>;
+
+    std::string tile_filename(const osmium::geom::Tile& tile) {
+        return "test-tile-split-" + std::to_string(tile.z) +
+               "-" + std::to_string(tile.x) +
+               "-" + std::to_string(tile.y) + ".osm";
+    }
+
+    std::ptrdiff_t count_objects(const std::string& filename) {
+        const auto buffer = osmium::io::read_file(filename);
+        std::remove(filename.c_str());
+        const auto objects = buffer.select<osmium::OSMObject>();
+        return std::distance(objects.cbegin(), objects.cend());
+    }
+
+} // anonymous namespace
+
+TEST_CASE("TileSplitWriter splits a stream into complete tiles in one pass") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    // at zoom 1 there are four tiles, one node in each quadrant
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _location(-90.0, 45.0));  // tile 0/0
+    osmium::builder::add_node(buffer, _id(2), _location(90.0, 45.0));   // tile 1/0
+    osmium::builder::add_node(buffer, _id(3), _location(-90.0, -45.0)); // tile 0/1
+    osmium::builder::add_node(buffer, _id(4), _location(90.0, -45.0));  // tile 1/1
+
+    // the node refs carry no locations, so the way and relation tiles
+    // have to come out of the indexes
+    osmium::builder::add_way(buffer, _id(10), _nodes({1, 2}));
+    osmium::builder::add_relation(buffer, _id(20), _member(osmium::item_type::way, 10, "outer"),
+                                                   _member(osmium::item_type::node, 3, "admin_centre"));
+
+    node_index_type node_index;
+    way_index_type way_index;
+
+    osmium::io::TileSplitWriter<node_index_type, way_index_type> splitter{1,
+        [](const osmium::geom::Tile& tile) {
+            return osmium::io::File{tile_filename(tile)};
+        },
+        node_index, way_index};
+
+    osmium::apply(buffer, splitter);
+    splitter.close();
+
+    REQUIRE(splitter.size() == 4);
+
+    // tile 0/0: node 1, way 10, relation 20
+    REQUIRE(count_objects(tile_filename(osmium::geom::Tile{1, 0, 0})) == 3);
+
+    // tile 1/0: node 2, way 10, relation 20
+    REQUIRE(count_objects(tile_filename(osmium::geom::Tile{1, 1, 0})) == 3);
+
+    // tile 0/1: node 3, relation 20
+    REQUIRE(count_objects(tile_filename(osmium::geom::Tile{1, 0, 1})) == 2);
+
+    // tile 1/1: node 4 only
+    REQUIRE(count_objects(tile_filename(osmium::geom::Tile{1, 1, 1})) == 1);
+}
+
+TEST_CASE("TileSplitWriter can throw on references to missing members") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _location(-90.0, 45.0));
+    osmium::builder::add_way(buffer, _id(10), _nodes({1, 2}));
+
+    node_index_type node_index;
+    way_index_type way_index;
+
+    osmium::io::TileSplitWriter<node_index_type, way_index_type> splitter{1,
+        [](const osmium::geom::Tile& tile) {
+            return osmium::io::File{tile_filename(tile)};
+        },
+        node_index, way_index,
+        osmium::io::Header{}, false};
+
+    REQUIRE_THROWS_AS(osmium::apply(buffer, splitter), const osmium::not_found&);
+
+    splitter.close();
+    std::remove(tile_filename(osmium::geom::Tile{1, 0, 0}).c_str());
+}
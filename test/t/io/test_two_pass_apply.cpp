@@ -0,0 +1,119 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/io/two_pass_apply.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/io/xml_input.hpp>
+#include <osmium/io/xml_output.hpp>
+
+#include <cstdio>
+#include <string>
+#include <utility>
+
+namespace {
+
+    struct NodePass : public osmium::handler::Handler {
+        int nodes = 0;
+        bool flushed = false;
+
+        void node(const osmium::Node& /*node*/) {
+            ++nodes;
+        }
+
+        void flush() {
+            flushed = true;
+        }
+    };
+
+    struct WayPass : public osmium::handler::Handler {
+        const NodePass& pass1;
+        int ways = 0;
+        int relations = 0;
+        bool pass1_was_flushed = true;
+
+        explicit WayPass(const NodePass& p1) : pass1(p1) {
+        }
+
+        void way(const osmium::Way& /*way*/) {
+            ++ways;
+            pass1_was_flushed = pass1_was_flushed && pass1.flushed;
+        }
+
+        void relation(const osmium::Relation& /*relation*/) {
+            ++relations;
+            pass1_was_flushed = pass1_was_flushed && pass1.flushed;
+        }
+    };
+
+    void write_test_file(const std::string& filename, osmium::memory::Buffer&& buffer) {
+        osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+        writer(std::move(buffer));
+        writer.close();
+    }
+
+} // anonymous namespace
+
+TEST_CASE("two_pass_apply runs pass 1 on nodes, then pass 2 on ways and relations") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 2.0));
+    osmium::builder::add_node(buffer, _id(2), _location(1.1, 2.1));
+    osmium::builder::add_node(buffer, _id(3), _location(1.2, 2.2));
+    osmium::builder::add_way(buffer, _id(10), _nodes({1, 2}));
+    osmium::builder::add_way(buffer, _id(11), _nodes({2, 3}));
+    osmium::builder::add_relation(buffer, _id(20), _member(osmium::item_type::way, 10, "outer"));
+
+    const std::string filename{"test_two_pass.osm"};
+    write_test_file(filename, std::move(buffer));
+
+    NodePass pass1;
+    WayPass pass2{pass1};
+    osmium::two_pass_apply(osmium::io::File{filename}, pass1, pass2);
+    std::remove(filename.c_str());
+
+    REQUIRE(pass1.nodes == 3);
+    REQUIRE(pass1.flushed);
+    REQUIRE(pass2.ways == 2);
+    REQUIRE(pass2.relations == 1);
+    // pass 1 was complete before pass 2 saw its first object
+    REQUIRE(pass2.pass1_was_flushed);
+}
+
+TEST_CASE("two_pass_apply flushes pass 1 for a file without ways or relations") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 2.0));
+
+    const std::string filename{"test_two_pass_nodes_only.osm"};
+    write_test_file(filename, std::move(buffer));
+
+    NodePass pass1;
+    WayPass pass2{pass1};
+    osmium::two_pass_apply(osmium::io::File{filename}, pass1, pass2);
+    std::remove(filename.c_str());
+
+    REQUIRE(pass1.nodes == 1);
+    REQUIRE(pass1.flushed);
+    REQUIRE(pass2.ways == 0);
+}
+
+TEST_CASE("two_pass_apply throws on a node after a way") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 2.0));
+    osmium::builder::add_way(buffer, _id(10), _nodes({1}));
+    osmium::builder::add_node(buffer, _id(2), _location(1.1, 2.1));
+
+    const std::string filename{"test_two_pass_unordered.osm"};
+    write_test_file(filename, std::move(buffer));
+
+    NodePass pass1;
+    WayPass pass2{pass1};
+    REQUIRE_THROWS_AS(osmium::two_pass_apply(osmium::io::File{filename}, pass1, pass2),
+                      const osmium::out_of_order_error&);
+    std::remove(filename.c_str());
+}
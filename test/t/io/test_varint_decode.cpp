@@ -0,0 +1,126 @@
+#include "catch.hpp"
+
+#include <osmium/io/detail/varint_decode.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+    void append_varint(std::string& data, uint64_t value) {
+        while (value >= 0x80u) {
+            data += static_cast<char>((value & 0x7fu) | 0x80u);
+            value >>= 7;
+        }
+        data += static_cast<char>(value);
+    }
+
+    uint64_t zigzag_encode(int64_t value) noexcept {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    void append_svarint(std::string& data, int64_t value) {
+        append_varint(data, zigzag_encode(value));
+    }
+
+} // anonymous namespace
+
+TEST_CASE("zigzag decode") {
+    REQUIRE(osmium::io::detail::zigzag_decode(0) == 0);
+    REQUIRE(osmium::io::detail::zigzag_decode(1) == -1);
+    REQUIRE(osmium::io::detail::zigzag_decode(2) == 1);
+    REQUIRE(osmium::io::detail::zigzag_decode(3) == -2);
+    REQUIRE(osmium::io::detail::zigzag_decode(0xfffffffffffffffeULL) == 0x7fffffffffffffffLL);
+    REQUIRE(osmium::io::detail::zigzag_decode(0xffffffffffffffffULL) == INT64_C(-0x7fffffffffffffff) - 1);
+}
+
+TEST_CASE("decode empty packed varint field") {
+    std::string data;
+    std::vector<uint64_t> values;
+    osmium::io::detail::decode_packed_varint(data.data(), data.data() + data.size(), values);
+    REQUIRE(values.empty());
+}
+
+TEST_CASE("decode packed varint field with mixed sizes") {
+    std::string data;
+    const std::vector<uint64_t> input = {
+        0, 1, 127, 128, 300, 16383, 16384, 1ULL << 32u, 0xffffffffffffffffULL
+    };
+    for (const auto value : input) {
+        append_varint(data, value);
+    }
+
+    std::vector<uint64_t> values;
+    osmium::io::detail::decode_packed_varint(data.data(), data.data() + data.size(), values);
+    REQUIRE(values == input);
+}
+
+TEST_CASE("decode long run of single-byte varints uses chunked fast path") {
+    std::string data;
+    std::vector<uint64_t> input;
+    for (uint64_t i = 0; i < 1000; ++i) {
+        input.push_back(i % 128);
+        append_varint(data, i % 128);
+    }
+
+    std::vector<uint64_t> values;
+    osmium::io::detail::decode_packed_varint(data.data(), data.data() + data.size(), values);
+    REQUIRE(values == input);
+}
+
+TEST_CASE("decode truncated varint throws") {
+    std::string data;
+    append_varint(data, 300);
+    data.resize(1); // keep only the continuation byte
+
+    std::vector<uint64_t> values;
+    REQUIRE_THROWS_AS(osmium::io::detail::decode_packed_varint(data.data(), data.data() + data.size(), values),
+                      const osmium::pbf_error&);
+}
+
+TEST_CASE("decode overlong varint throws") {
+    const std::string data(11, static_cast<char>(0x80u));
+
+    std::vector<uint64_t> values;
+    REQUIRE_THROWS_AS(osmium::io::detail::decode_packed_varint(data.data(), data.data() + data.size(), values),
+                      const osmium::pbf_error&);
+}
+
+TEST_CASE("delta decode packed sint64 field") {
+    std::string data;
+    append_svarint(data, 1000);
+    append_svarint(data, 10);
+    append_svarint(data, -30);
+    append_svarint(data, 0);
+    append_svarint(data, 5);
+
+    std::vector<int64_t> values;
+    osmium::io::detail::decode_packed_sint64_delta(data.data(), data.data() + data.size(), values);
+    REQUIRE(values == (std::vector<int64_t>{1000, 1010, 980, 980, 985}));
+}
+
+TEST_CASE("delta decode clears previous content") {
+    std::string data;
+    append_svarint(data, -7);
+
+    std::vector<int64_t> values = {1, 2, 3};
+    osmium::io::detail::decode_packed_sint64_delta(data.data(), data.data() + data.size(), values);
+    REQUIRE(values == (std::vector<int64_t>{-7}));
+}
+
+TEST_CASE("delta decode long run of small deltas") {
+    std::string data;
+    std::vector<int64_t> expected;
+    int64_t sum = 0;
+    for (int64_t i = 0; i < 1000; ++i) {
+        const int64_t delta = (i % 64) - 32;
+        sum += delta;
+        expected.push_back(sum);
+        append_svarint(data, delta);
+    }
+
+    std::vector<int64_t> values;
+    osmium::io::detail::decode_packed_sint64_delta(data.data(), data.data() + data.size(), values);
+    REQUIRE(values == expected);
+}
@@ -223,3 +223,19 @@ TEST_CASE("Writer with user-provided pool with outlier positive number of thread
     REQUIRE(count == count_fds());
 }
 
+
+TEST_CASE("Writer: raw blob pass-through fails for non-PBF output") {
+    const int count = count_fds();
+
+    bool error = false;
+    try {
+        osmium::io::Writer writer{"test-writer-out-raw-blob.osm", osmium::io::overwrite::allow};
+        writer.write_raw_blob(std::string{"not a blob"});
+    } catch (const osmium::io_error&) {
+        error = true;
+    }
+
+    REQUIRE(error);
+
+    REQUIRE(count == count_fds());
+}
@@ -0,0 +1,112 @@
+#include "catch.hpp"
+
+#include <osmium/io/xml_input.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+    std::vector<osmium::object_id_type> read_ids(const std::string& filename) {
+        std::vector<osmium::object_id_type> ids;
+
+        osmium::io::Reader reader{filename};
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                ids.push_back(object.id());
+            }
+        }
+        reader.close();
+
+        return ids;
+    }
+
+    void write_file(const std::string& filename, const std::string& data) {
+        std::ofstream file{filename, std::ofstream::trunc};
+        file << data;
+        file.close();
+        REQUIRE(file.good());
+    }
+
+} // anonymous namespace
+
+TEST_CASE("Reading XML with object-start strings in comments") {
+    const std::string filename{"test-xml-split-comments.osm"};
+    write_file(filename,
+        "<?xml version='1.0' encoding='UTF-8'?>\n"
+        "<osm version=\"0.6\" generator=\"testdata\">\n"
+        "  <!-- <node id=\"999\" lat=\"1\" lon=\"1\"/> -->\n"
+        "  <node id=\"1\" lat=\"1.0\" lon=\"2.0\"/>\n"
+        "  <!-- <way id=\"998\"> is not real either -->\n"
+        "  <node id=\"2\" lat=\"1.1\" lon=\"2.1\">\n"
+        "    <tag k=\"amenity\" v=\"post_box\"/>\n"
+        "  </node>\n"
+        "  <way id=\"3\">\n"
+        "    <nd ref=\"1\"/>\n"
+        "    <nd ref=\"2\"/>\n"
+        "  </way>\n"
+        "  <!-- <relation id=\"997\"/> -->\n"
+        "</osm>\n");
+
+    const auto ids = read_ids(filename);
+    REQUIRE(ids.size() == 3);
+    REQUIRE(ids[0] == 1);
+    REQUIRE(ids[1] == 2);
+    REQUIRE(ids[2] == 3);
+
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Reading XML with object-start strings in CDATA section") {
+    const std::string filename{"test-xml-split-cdata.osm"};
+    write_file(filename,
+        "<?xml version='1.0' encoding='UTF-8'?>\n"
+        "<osm version=\"0.6\" generator=\"testdata\">\n"
+        "  <![CDATA[ <node id=\"996\" lat=\"1\" lon=\"1\"/> ]]>\n"
+        "  <node id=\"1\" lat=\"1.0\" lon=\"2.0\"/>\n"
+        "  <node id=\"2\" lat=\"1.1\" lon=\"2.1\"/>\n"
+        "</osm>\n");
+
+    const auto ids = read_ids(filename);
+    REQUIRE(ids.size() == 2);
+    REQUIRE(ids[0] == 1);
+    REQUIRE(ids[1] == 2);
+
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Reading a large XML file with comments does not split inside them") {
+    // Large enough that the input is cut into several segments, with a
+    // comment containing an object-start string between every two nodes
+    // so most split point candidates fall into a comment.
+    const std::string filename{"test-xml-split-large.osm"};
+    const osmium::object_id_type num_nodes = 20000;
+
+    {
+        std::ofstream file{filename, std::ofstream::trunc};
+        file << "<?xml version='1.0' encoding='UTF-8'?>\n"
+                "<osm version=\"0.6\" generator=\"testdata\">\n";
+        for (osmium::object_id_type id = 1; id <= num_nodes; ++id) {
+            file << "  <!-- <node id=\"888888\" lat=\"0\" lon=\"0\"/> nothing to see here,"
+                    " just making sure comments are long enough to be likely split"
+                    " point candidates ................................................ -->\n";
+            file << "  <node id=\"" << id << "\" version=\"1\" lat=\"1.0\" lon=\"2.0\"/>\n";
+        }
+        file << "</osm>\n";
+        file.close();
+        REQUIRE(file.good());
+    }
+
+    const auto ids = read_ids(filename);
+    REQUIRE(ids.size() == std::size_t(num_nodes));
+    for (osmium::object_id_type id = 1; id <= num_nodes; ++id) {
+        REQUIRE(ids[std::size_t(id - 1)] == id);
+    }
+
+    std::remove(filename.c_str());
+}
@@ -1,9 +1,13 @@
 #include "catch.hpp"
 
+#include <osmium/builder/attr.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
 
 #include <array>
 #include <stdexcept>
+#include <vector>
 
 TEST_CASE("Buffer basics") {
     osmium::memory::Buffer invalid_buffer1;
@@ -70,6 +74,27 @@ TEST_CASE("Grow a buffer") {
     REQUIRE(buffer.is_aligned());
 }
 
+TEST_CASE("Reserve capacity in a growing buffer") {
+    osmium::memory::Buffer buffer{128, osmium::memory::Buffer::auto_grow::yes};
+
+    buffer.reserve_capacity(1000);
+    REQUIRE(buffer.capacity() >= 1000);
+    REQUIRE(buffer.written() == 0);
+    REQUIRE(buffer.committed() == 0);
+
+    // enough space already, nothing happens
+    const auto capacity = buffer.capacity();
+    buffer.reserve_capacity(100);
+    REQUIRE(buffer.capacity() == capacity);
+}
+
+TEST_CASE("Reserve capacity does nothing on a non-growing buffer") {
+    osmium::memory::Buffer buffer{128, osmium::memory::Buffer::auto_grow::no};
+
+    buffer.reserve_capacity(1000);
+    REQUIRE(buffer.capacity() == 128);
+}
+
 TEST_CASE("Reserve space in a non-growing buffer") {
     osmium::memory::Buffer buffer{128, osmium::memory::Buffer::auto_grow::no};
 
@@ -129,3 +154,125 @@ TEST_CASE("Create buffer from existing data with bad alignment fails") {
     REQUIRE_THROWS_AS(l4(), const std::invalid_argument&);
 }
 
+
+TEST_CASE("Add items from one buffer to another") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer source{1024 * 1024};
+    for (int i = 1; i <= 10; ++i) {
+        osmium::builder::add_node(source, _id(i), _user("testuser"));
+    }
+
+    osmium::memory::Buffer destination{1024 * 1024};
+
+    SECTION("complete range becomes one memcpy") {
+        destination.add_items(source.cbegin(), source.cend());
+        destination.commit();
+
+        REQUIRE(destination.committed() == source.committed());
+        osmium::object_id_type id = 1;
+        for (const auto& node : destination.select<osmium::Node>()) {
+            REQUIRE(node.id() == id);
+            ++id;
+        }
+        REQUIRE(id == 11);
+    }
+
+    SECTION("range of node iterators") {
+        destination.add_items(source.begin<osmium::Node>(), source.end<osmium::Node>());
+        destination.commit();
+
+        REQUIRE(destination.committed() == source.committed());
+    }
+
+    SECTION("empty range adds nothing") {
+        destination.add_items(source.cend(), source.cend());
+        destination.commit();
+
+        REQUIRE(destination.committed() == 0);
+    }
+}
+
+TEST_CASE("Add items from non-consecutive runs") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer source{1024 * 1024};
+    for (int i = 1; i <= 10; ++i) {
+        osmium::builder::add_node(source, _id(i), _user("testuser"));
+    }
+
+    // Collect every node except number 5, so there are two runs of
+    // consecutive items with a hole in between.
+    std::vector<const osmium::Node*> nodes;
+    for (const auto& node : source.select<osmium::Node>()) {
+        if (node.id() != 5) {
+            nodes.push_back(&node);
+        }
+    }
+
+    struct indirect_iterator {
+        std::vector<const osmium::Node*>::const_iterator it;
+
+        const osmium::Node& operator*() const noexcept {
+            return **it;
+        }
+
+        const osmium::Node* operator->() const noexcept {
+            return *it;
+        }
+
+        indirect_iterator& operator++() noexcept {
+            ++it;
+            return *this;
+        }
+
+        bool operator!=(const indirect_iterator& rhs) const noexcept {
+            return it != rhs.it;
+        }
+    };
+
+    osmium::memory::Buffer destination{1024 * 1024};
+    destination.add_items(indirect_iterator{nodes.begin()}, indirect_iterator{nodes.end()});
+    destination.commit();
+
+    osmium::object_id_type id = 1;
+    for (const auto& node : destination.select<osmium::Node>()) {
+        REQUIRE(node.id() == id);
+        id += (id == 4) ? 2 : 1;
+    }
+    REQUIRE(id == 11);
+}
+
+TEST_CASE("Pipelined for_each over the items in a buffer") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024UL * 64UL, osmium::memory::Buffer::auto_grow::yes};
+    for (int n = 1; n <= 100; ++n) {
+        osmium::builder::add_node(buffer, _id(n));
+    }
+    osmium::builder::add_way(buffer, _id(1000), _nodes({1, 2}));
+
+    // all items in order
+    std::vector<osmium::object_id_type> ids;
+    buffer.select<osmium::OSMObject>().for_each([&ids](const osmium::OSMObject& object) {
+        ids.push_back(object.id());
+    });
+    REQUIRE(ids.size() == 101);
+    REQUIRE(ids.front() == 1);
+    REQUIRE(ids[99] == 100);
+    REQUIRE(ids.back() == 1000);
+
+    // only the items of the selected type
+    int ways = 0;
+    osmium::memory::for_each_item<osmium::Way>(buffer, [&ways](const osmium::Way& way) {
+        REQUIRE(way.id() == 1000);
+        ++ways;
+    });
+    REQUIRE(ways == 1);
+
+    // empty buffer
+    const osmium::memory::Buffer empty{1024UL};
+    empty.select<osmium::OSMObject>().for_each([](const osmium::OSMObject&) {
+        REQUIRE(false);
+    });
+}
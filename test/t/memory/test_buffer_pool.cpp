@@ -0,0 +1,98 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/buffer_pool.hpp>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+TEST_CASE("Buffer pool") {
+    osmium::memory::BufferPool pool{1024, 4};
+
+    REQUIRE(pool.buffer_capacity() == 1024);
+    REQUIRE(pool.free_blocks() == 0);
+
+    SECTION("get_buffer() returns empty buffer with pool capacity") {
+        osmium::memory::Buffer buffer = pool.get_buffer();
+        REQUIRE(buffer);
+        REQUIRE(buffer.capacity() == 1024);
+        REQUIRE(buffer.committed() == 0);
+    }
+
+    SECTION("memory of returned buffer is reused") {
+        osmium::memory::Buffer buffer = pool.get_buffer();
+        const unsigned char* const data = buffer.data();
+
+        pool.give_back(std::move(buffer));
+        REQUIRE(pool.free_blocks() == 1);
+
+        osmium::memory::Buffer reused = pool.get_buffer();
+        REQUIRE(pool.free_blocks() == 0);
+        REQUIRE(reused.data() == data);
+        REQUIRE(reused.capacity() == 1024);
+        REQUIRE(reused.committed() == 0);
+    }
+
+    SECTION("buffers with the wrong capacity are not kept") {
+        osmium::memory::Buffer buffer{2048};
+        pool.give_back(std::move(buffer));
+        REQUIRE(pool.free_blocks() == 0);
+    }
+
+    SECTION("the free list is bounded") {
+        std::vector<osmium::memory::Buffer> buffers;
+        for (int i = 0; i < 10; ++i) {
+            buffers.push_back(pool.get_buffer());
+        }
+        for (auto& buffer : buffers) {
+            pool.give_back(std::move(buffer));
+        }
+        REQUIRE(pool.free_blocks() == 4);
+    }
+
+    SECTION("prefault fills the free list") {
+        pool.prefault(2);
+        REQUIRE(pool.free_blocks() == 2);
+
+        pool.prefault(100); // bounded by the maximum free list size
+        REQUIRE(pool.free_blocks() == 4);
+
+        osmium::memory::Buffer buffer = pool.get_buffer();
+        REQUIRE(buffer);
+        REQUIRE(buffer.committed() == 0);
+        REQUIRE(pool.free_blocks() == 3);
+    }
+
+    SECTION("nested buffers are reclaimed, too") {
+        using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+        osmium::memory::Buffer buffer = pool.get_buffer();
+        for (int i = 1; i <= 20; ++i) {
+            osmium::builder::add_node(buffer, _id(i), _user("some user name to fill the buffer"));
+        }
+        REQUIRE(buffer.has_nested_buffers());
+
+        pool.give_back(std::move(buffer));
+        REQUIRE(pool.free_blocks() > 1);
+    }
+}
+
+TEST_CASE("Buffer pool default instance") {
+    osmium::memory::BufferPool& pool = osmium::memory::BufferPool::default_instance();
+    osmium::memory::Buffer buffer = pool.get_buffer();
+    REQUIRE(buffer);
+    REQUIRE(buffer.capacity() == pool.buffer_capacity());
+}
+
+TEST_CASE("Buffer release_memory") {
+    osmium::memory::Buffer buffer{1024};
+    std::unique_ptr<unsigned char[]> memory{buffer.release_memory()};
+    REQUIRE(memory);
+    REQUIRE_FALSE(buffer);
+    REQUIRE(buffer.capacity() == 0);
+
+    osmium::memory::Buffer invalid_buffer;
+    REQUIRE_FALSE(invalid_buffer.release_memory());
+}
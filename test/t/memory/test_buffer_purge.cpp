@@ -2,8 +2,10 @@
 
 #include <osmium/builder/osm_object_builder.hpp>
 #include <osmium/osm/node.hpp>
+#include <osmium/thread/pool.hpp>
 
 #include <iterator>
+#include <string>
 
 struct CallbackClass {
 
@@ -189,3 +191,58 @@ TEST_CASE("Purge buffer with three objects, all get deleted") {
     REQUIRE(std::distance(buffer.begin(), buffer.end()) == 0);
 }
 
+
+TEST_CASE("Parallel purge falls back to serial for small buffers") {
+    constexpr const size_t buffer_size = 10000;
+    osmium::memory::Buffer buffer{buffer_size};
+
+    {
+        osmium::builder::NodeBuilder node_builder{buffer};
+        node_builder.set_user("testuser");
+        node_builder.set_removed(true);
+    }
+    buffer.commit();
+    {
+        osmium::builder::NodeBuilder node_builder{buffer};
+        node_builder.set_user("testuser");
+    }
+    buffer.commit();
+
+    CallbackClass callback;
+    buffer.purge_removed(&callback, osmium::thread::Pool::default_instance());
+
+    REQUIRE(callback.count == 1);
+    REQUIRE(std::distance(buffer.begin(), buffer.end()) == 1);
+}
+
+TEST_CASE("Parallel purge of large buffer") {
+    osmium::memory::Buffer buffer{20ul * 1024ul * 1024ul};
+
+    // More than the 16 MB threshold so the parallel path is taken.
+    osmium::object_id_type id = 0;
+    while (buffer.committed() < 17ul * 1024ul * 1024ul) {
+        {
+            osmium::builder::NodeBuilder node_builder{buffer};
+            node_builder.object().set_id(++id);
+            node_builder.set_user("testuser");
+            if (id % 2 == 0) {
+                node_builder.set_removed(true);
+            }
+        }
+        buffer.commit();
+    }
+
+    CallbackClass callback;
+    buffer.purge_removed(&callback, osmium::thread::Pool::default_instance());
+
+    REQUIRE(callback.count > 0);
+
+    // only the odd ids survive, in order
+    osmium::object_id_type expected = 1;
+    for (const auto& node : buffer.select<osmium::Node>()) {
+        REQUIRE(node.id() == expected);
+        REQUIRE(std::string{node.user()} == "testuser");
+        expected += 2;
+    }
+    REQUIRE(expected > id);
+}
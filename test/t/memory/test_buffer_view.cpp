@@ -0,0 +1,125 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/buffer_view.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+    osmium::memory::Buffer fill_buffer(int count, std::vector<std::size_t>& offsets) {
+        using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+        osmium::memory::Buffer buffer{1024 * 1024};
+        for (int i = 1; i <= count; ++i) {
+            offsets.push_back(buffer.committed());
+            osmium::builder::add_node(buffer, _id(i), _user("testuser"));
+        }
+        return buffer;
+    }
+
+    struct CountHandler : public osmium::handler::Handler {
+
+        int count = 0;
+        osmium::object_id_type sum = 0;
+
+        void node(const osmium::Node& node) {
+            ++count;
+            sum += node.id();
+        }
+
+    }; // struct CountHandler
+
+} // anonymous namespace
+
+TEST_CASE("View on complete buffer") {
+    std::vector<std::size_t> offsets;
+    const osmium::memory::Buffer buffer = fill_buffer(10, offsets);
+
+    const osmium::memory::BufferView view{buffer};
+
+    REQUIRE(view.begin_offset() == 0);
+    REQUIRE(view.end_offset() == buffer.committed());
+    REQUIRE(view.size() == buffer.committed());
+    REQUIRE_FALSE(view.empty());
+    REQUIRE(std::distance(view.begin(), view.end()) == 10);
+
+    CountHandler handler;
+    osmium::apply(view, handler);
+    REQUIRE(handler.count == 10);
+    REQUIRE(handler.sum == 55);
+}
+
+TEST_CASE("View on part of a buffer") {
+    std::vector<std::size_t> offsets;
+    const osmium::memory::Buffer buffer = fill_buffer(10, offsets);
+
+    const osmium::memory::BufferView view{buffer, offsets[2], offsets[5]};
+
+    REQUIRE(std::distance(view.begin(), view.end()) == 3);
+
+    osmium::object_id_type id = 3;
+    for (const auto& node : view.select<osmium::Node>()) {
+        REQUIRE(node.id() == id);
+        ++id;
+    }
+    REQUIRE(id == 6);
+}
+
+TEST_CASE("Empty view") {
+    std::vector<std::size_t> offsets;
+    const osmium::memory::Buffer buffer = fill_buffer(3, offsets);
+
+    const osmium::memory::BufferView view{buffer, offsets[1], offsets[1]};
+
+    REQUIRE(view.empty());
+    REQUIRE(view.size() == 0);
+    REQUIRE(view.begin() == view.end());
+}
+
+TEST_CASE("Split buffer into views") {
+    std::vector<std::size_t> offsets;
+    const osmium::memory::Buffer buffer = fill_buffer(100, offsets);
+
+    const auto views = osmium::memory::split(buffer, 4);
+    REQUIRE(views.size() == 4);
+
+    osmium::object_id_type id = 1;
+    std::size_t offset = 0;
+    for (const auto& view : views) {
+        REQUIRE(view.begin_offset() == offset);
+        REQUIRE_FALSE(view.empty());
+        for (const auto& node : view.select<osmium::Node>()) {
+            REQUIRE(node.id() == id);
+            ++id;
+        }
+        offset = view.end_offset();
+    }
+    REQUIRE(id == 101);
+    REQUIRE(offset == buffer.committed());
+}
+
+TEST_CASE("Split buffer with fewer items than views wanted") {
+    std::vector<std::size_t> offsets;
+    const osmium::memory::Buffer buffer = fill_buffer(2, offsets);
+
+    const auto views = osmium::memory::split(buffer, 8);
+    REQUIRE(views.size() <= 2);
+
+    int count = 0;
+    for (const auto& view : views) {
+        count += static_cast<int>(std::distance(view.begin(), view.end()));
+    }
+    REQUIRE(count == 2);
+}
+
+TEST_CASE("Split empty buffer") {
+    const osmium::memory::Buffer buffer{1024};
+    const auto views = osmium::memory::split(buffer, 4);
+    REQUIRE(views.empty());
+}
@@ -0,0 +1,89 @@
+#include "catch.hpp"
+
+#include <osmium/memory/scratch_arena.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <string>
+#include <vector>
+
+TEST_CASE("Scratch arena allocation") {
+    osmium::memory::ScratchArena arena;
+    REQUIRE(arena.capacity() == 0);
+
+    char* a = arena.allocate(100);
+    REQUIRE(a != nullptr);
+    char* b = arena.allocate(100);
+    REQUIRE(b == a + 100);
+    REQUIRE(arena.capacity() >= 200);
+}
+
+TEST_CASE("Scratch arena stores strings") {
+    osmium::memory::ScratchArena arena;
+
+    const std::string role{"outer"};
+    const char* stored = arena.store(role.c_str());
+    REQUIRE(stored != role.c_str());
+    REQUIRE(std::strcmp(stored, "outer") == 0);
+
+    const char* part = arena.store("abcdef", 3);
+    REQUIRE(std::strcmp(part, "abc") == 0);
+}
+
+TEST_CASE("Scratch arena reset reuses memory") {
+    osmium::memory::ScratchArena arena;
+
+    const char* first = arena.store("something");
+    const std::size_t capacity = arena.capacity();
+
+    arena.reset();
+    const char* second = arena.store("something else");
+    REQUIRE(second == first);
+    REQUIRE(arena.capacity() == capacity);
+}
+
+TEST_CASE("Scratch arena handles allocations larger than the block size") {
+    osmium::memory::ScratchArena arena;
+
+    char* small = arena.allocate(10);
+    REQUIRE(small != nullptr);
+
+    char* large = arena.allocate(100ul * 1024ul);
+    REQUIRE(large != nullptr);
+    std::memset(large, 'x', 100ul * 1024ul);
+
+    arena.reset();
+    REQUIRE(arena.allocate(10) == small);
+}
+
+TEST_CASE("Scratch arena aligned allocation") {
+    osmium::memory::ScratchArena arena;
+
+    arena.allocate(1);
+    void* d = arena.allocate_aligned(sizeof(double), alignof(double));
+    REQUIRE((reinterpret_cast<std::uintptr_t>(d) % alignof(double)) == 0);
+}
+
+TEST_CASE("Scratch arena allocator works with standard containers") {
+    osmium::memory::ScratchArena arena;
+
+    std::vector<int, osmium::memory::arena_allocator<int>> v{osmium::memory::arena_allocator<int>{arena}};
+    std::list<int, osmium::memory::arena_allocator<int>> l{osmium::memory::arena_allocator<int>{arena}};
+    for (int i = 0; i < 100; ++i) {
+        v.push_back(i);
+        l.push_back(i);
+    }
+    REQUIRE(v.back() == 99);
+    REQUIRE(l.back() == 99);
+    REQUIRE(arena.capacity() >= 100 * sizeof(int));
+
+    REQUIRE(v.get_allocator() == l.get_allocator());
+}
+
+TEST_CASE("Scratch arena per-thread instance") {
+    auto& arena = osmium::memory::ScratchArena::instance();
+    const char* str = arena.store("test");
+    REQUIRE(std::strcmp(str, "test") == 0);
+    REQUIRE(&arena == &osmium::memory::ScratchArena::instance());
+}
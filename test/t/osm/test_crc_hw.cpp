@@ -0,0 +1,55 @@
+#include "catch.hpp"
+
+// The hardware CRC32C implementation can only be compiled when the target
+// CPU has the necessary instructions, so all tests are disabled otherwise.
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+
+#include <osmium/osm/crc.hpp>
+#include <osmium/osm/crc_hw.hpp>
+
+TEST_CASE("CRC32C of known test vector") {
+    osmium::CRC_hw crc32c;
+
+    crc32c.process_bytes("123456789", 9);
+
+    REQUIRE(crc32c.checksum() == 0xe3069283);
+}
+
+TEST_CASE("CRC32C processed byte-by-byte gives the same checksum") {
+    osmium::CRC_hw crc32c;
+
+    for (const char c : {'1', '2', '3', '4', '5', '6', '7', '8', '9'}) {
+        crc32c.process_byte(static_cast<unsigned char>(c));
+    }
+
+    REQUIRE(crc32c.checksum() == 0xe3069283);
+}
+
+TEST_CASE("CRC32C of 32 zero bytes") {
+    osmium::CRC_hw crc32c;
+
+    const unsigned char buffer[32] = {0};
+    crc32c.process_bytes(buffer, sizeof(buffer));
+
+    REQUIRE(crc32c.checksum() == 0x8a9136aa);
+}
+
+TEST_CASE("Hardware CRC32C of bool") {
+    osmium::CRC<osmium::CRC_hw> crc32c;
+
+    crc32c.update_bool(true);
+    crc32c.update_bool(false);
+
+    REQUIRE(crc32c().checksum() == 0xe2c3efa5);
+}
+
+TEST_CASE("Hardware CRC32C of char") {
+    osmium::CRC<osmium::CRC_hw> crc32c;
+
+    crc32c.update_int8('x');
+    crc32c.update_int8('y');
+
+    REQUIRE(crc32c().checksum() == 0xda06ef2c);
+}
+
+#endif
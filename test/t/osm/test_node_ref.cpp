@@ -5,6 +5,9 @@
 #include <osmium/osm/node_ref.hpp>
 #include <osmium/osm/node_ref_list.hpp>
 
+#include <cstdint>
+#include <vector>
+
 TEST_CASE("Default construct a NodeRef") {
     const osmium::NodeRef node_ref;
     REQUIRE(node_ref.ref() == 0);
@@ -124,3 +127,26 @@ TEST_CASE("WayNodeList") {
 
 }
 
+
+TEST_CASE("Export raw coordinates of a WayNodeList") {
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_way_node_list(buffer, osmium::builder::attr::_nodes({
+        {1, {1.2, 3.4}},
+        {2, osmium::Location{}},
+        {3, {-0.5, 0.5}}
+    }));
+
+    const osmium::WayNodeList& nrl = buffer.get<osmium::WayNodeList>(0);
+
+    std::vector<int32_t> x;
+    std::vector<int32_t> y;
+    nrl.raw_coordinates(x, y);
+
+    REQUIRE(x == (std::vector<int32_t>{12000000, osmium::Location::undefined_coordinate, -5000000}));
+    REQUIRE(y == (std::vector<int32_t>{34000000, osmium::Location::undefined_coordinate, 5000000}));
+
+    // appends on repeated calls
+    nrl.raw_coordinates(x, y);
+    REQUIRE(x.size() == 6);
+    REQUIRE(y.size() == 6);
+}
@@ -151,3 +151,24 @@ TEST_CASE("Invalid timestamps") {
     REQUIRE_THROWS_AS(osmium::Timestamp{"2000-03-32T00:00:00Z"}, const std::invalid_argument&);
 }
 
+
+TEST_CASE("Timestamp round-trip on calendar edge cases") {
+    const std::vector<std::string> test_cases = {
+        "1970-01-01T00:00:01Z",
+        "1999-12-31T23:59:59Z",
+        "2000-02-29T12:34:56Z",
+        "2038-01-19T03:14:08Z",
+        "2100-02-28T23:59:59Z",
+        "2106-02-07T06:28:15Z" // largest timestamp fitting into 32 bits
+    };
+
+    for (const auto& tc : test_cases) {
+        const osmium::Timestamp t{tc};
+        REQUIRE(tc == t.to_iso());
+    }
+}
+
+TEST_CASE("Leap second is normalized into the next minute") {
+    const osmium::Timestamp t{"2016-12-31T23:59:60Z"};
+    REQUIRE(t.to_iso() == "2017-01-01T00:00:00Z");
+}
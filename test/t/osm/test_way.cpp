@@ -105,3 +105,47 @@ TEST_CASE("build way with helpers") {
     REQUIRE(envelope.top_right().lat() == Approx(4.7));
 }
 
+
+TEST_CASE("way envelope ignores invalid locations") {
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+
+    {
+        osmium::builder::WayBuilder builder{buffer};
+        builder.add_node_refs({
+            {1, {3.5, 4.7}},
+            {2, osmium::Location{}},
+            {3, {4.1, 2.2}},
+            {4, {200.0, 95.0}}, // out of bounds
+            {5, {3.9, 3.1}},
+            {6, {3.7, 4.9}},
+            {7, osmium::Location{}},
+            {8, {3.6, 2.5}},
+            {9, {4.0, 3.3}}
+        });
+    }
+    buffer.commit();
+
+    const osmium::Box envelope = buffer.get<osmium::Way>(0).envelope();
+    REQUIRE(envelope.valid());
+    REQUIRE(envelope.bottom_left().lon() == Approx(3.5));
+    REQUIRE(envelope.bottom_left().lat() == Approx(2.2));
+    REQUIRE(envelope.top_right().lon() == Approx(4.1));
+    REQUIRE(envelope.top_right().lat() == Approx(4.9));
+}
+
+TEST_CASE("way envelope is undefined without valid locations") {
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+
+    {
+        osmium::builder::WayBuilder builder{buffer};
+        builder.add_node_refs({
+            {1, osmium::Location{}},
+            {2, osmium::Location{}},
+            {3, osmium::Location{}}
+        });
+    }
+    buffer.commit();
+
+    const osmium::Box envelope = buffer.get<osmium::Way>(0).envelope();
+    REQUIRE_FALSE(envelope);
+}
@@ -1,6 +1,7 @@
 #include "catch.hpp"
 
 #include <osmium/builder/attr.hpp>
+#include <osmium/index/id_set.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/relations/members_database.hpp>
 #include <osmium/relations/relations_database.hpp>
@@ -45,7 +46,15 @@ TEST_CASE("Fill member database") {
     osmium::relations::RelationsDatabase rdb{stash};
     osmium::relations::MembersDatabase<osmium::Way> mdb{stash, rdb};
 
-    REQUIRE(mdb.used_memory() < 100);
+    // sizeof(MembersDatabaseCommon) includes the (still empty) hash index
+    REQUIRE(mdb.used_memory() < 200);
+
+    SECTION("with binary search lookup") {
+    }
+
+    SECTION("with hashed lookup") {
+        mdb.enable_hashed_lookup();
+    }
 
     for (const auto& relation : buffer.select<osmium::Relation>()) {
         auto handle = rdb.add(relation);
@@ -56,6 +65,13 @@ TEST_CASE("Fill member database") {
         }
     }
 
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> ids;
+    mdb.add_tracked_ids(ids);
+    REQUIRE(ids.size() == 5); // way 10 is tracked twice
+    REQUIRE(ids.get(10));
+    REQUIRE(ids.get(14));
+    REQUIRE_FALSE(ids.get(15));
+
     mdb.prepare_for_lookup();
 
     int n = 0;
@@ -1,9 +1,11 @@
 #include "catch.hpp"
 
 #include <osmium/builder/attr.hpp>
+#include <osmium/index/detail/tmpfile.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/relations/relations_database.hpp>
 #include <osmium/storage/item_stash.hpp>
+#include <osmium/util/file.hpp>
 
 #include <vector>
 
@@ -105,3 +107,34 @@ TEST_CASE("Check need members and handle ops") {
     REQUIRE(rdb.count_relations() == 1);
 }
 
+
+TEST_CASE("Dump and load relation database") {
+    const auto buffer = fill_buffer();
+
+    osmium::ItemStash stash;
+    osmium::relations::RelationsDatabase rdb{stash};
+
+    for (const auto& relation : buffer.select<osmium::Relation>()) {
+        auto handle = rdb.add(relation);
+        handle.set_members(relation.cmembers().size());
+    }
+
+    const int fd = osmium::detail::create_tmp_file();
+    stash.dump(fd);
+    rdb.dump(fd);
+    osmium::util::file_seek(fd, 0);
+
+    osmium::ItemStash restored_stash;
+    osmium::relations::RelationsDatabase restored{restored_stash};
+    restored_stash.load(fd);
+    restored.load(fd);
+
+    REQUIRE(restored.size() == 3);
+
+    int n = 0;
+    restored.for_each_relation([&](const osmium::relations::RelationHandle& rel_handle) {
+        ++n;
+        REQUIRE(rel_handle->members().size() == (*rel_handle).id());
+    });
+    REQUIRE(n == 3);
+}
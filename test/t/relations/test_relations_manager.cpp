@@ -5,7 +5,10 @@
 #include <osmium/io/xml_input.hpp>
 #include <osmium/osm/relation.hpp>
 #include <osmium/relations/relations_manager.hpp>
+#include <osmium/thread/pool.hpp>
 
+#include <atomic>
+#include <cstddef>
 #include <iterator>
 
 struct EmptyRM : public osmium::relations::RelationsManager<EmptyRM, true, true, true> {
@@ -320,3 +323,158 @@ TEST_CASE("Check handling of missing members") {
     REQUIRE(missing_relations == 2);
 }
 
+struct ParallelRM : public osmium::relations::RelationsManager<ParallelRM, true, false, false> {
+
+    std::atomic<std::size_t> count_nodes{0};
+
+    bool new_member(const osmium::Relation& /*relation*/, const osmium::RelationMember& member, std::size_t /*n*/) noexcept {
+        return member.type() == osmium::item_type::node;
+    }
+
+    // Runs on the worker threads of the pool, so it must only read from
+    // the manager and write into the buffer it was given.
+    void complete_relation_into(const osmium::Relation& relation, osmium::memory::Buffer& buffer) {
+        for (const auto& member : relation.members()) {
+            if (member.type() == osmium::item_type::node) {
+                const auto* node = get_member_node(member.ref());
+                if (node != nullptr) {
+                    ++count_nodes;
+                    buffer.add_item(*node);
+                    buffer.commit();
+                }
+            }
+        }
+    }
+
+};
+
+TEST_CASE("Relations manager with parallel completion") {
+    osmium::io::File file{with_data_dir("t/relations/data.osm")};
+
+    osmium::thread::Pool pool{2};
+
+    std::size_t batch_size = 1; // dispatch a batch for every completed relation
+
+    SECTION("dispatching batches during the second pass") {
+        batch_size = 1;
+    }
+
+    SECTION("handling pending relations when flushing") {
+        batch_size = 100; // larger than the number of relations in the input
+    }
+
+    ParallelRM manager;
+    manager.enable_parallel_completion(pool, batch_size);
+
+    osmium::relations::read_relations(file, manager);
+
+    osmium::io::Reader reader{file};
+    osmium::apply(reader, manager.handler());
+    reader.close();
+
+    auto buffer = manager.read();
+    REQUIRE(std::distance(buffer.begin(), buffer.end()) == 2);
+    REQUIRE(manager.count_nodes == 2);
+
+    const auto c = manager.member_nodes_database().count();
+    REQUIRE(c.tracked == 0);
+}
+
+struct ThreadedRM : public osmium::relations::RelationsManager<ThreadedRM, true, true, true> {
+
+    std::atomic<std::size_t> count_complete_rels{0};
+    std::atomic<std::size_t> count_before{0};
+    std::atomic<std::size_t> count_not_in_any{0};
+    std::atomic<std::size_t> count_after{0};
+
+    void complete_relation(const osmium::Relation& /*relation*/) noexcept {
+        ++count_complete_rels;
+    }
+
+    // These run on the per-type matching threads, so they may only touch
+    // thread-safe state.
+    void before_node(const osmium::Node& /*node*/) noexcept {
+        ++count_before;
+    }
+
+    void node_not_in_any_relation(const osmium::Node& /*node*/) noexcept {
+        ++count_not_in_any;
+    }
+
+    void after_node(const osmium::Node& /*node*/) noexcept {
+        ++count_after;
+    }
+
+    void before_way(const osmium::Way& /*way*/) noexcept {
+        ++count_before;
+    }
+
+    void way_not_in_any_relation(const osmium::Way& /*way*/) noexcept {
+        ++count_not_in_any;
+    }
+
+    void after_way(const osmium::Way& /*way*/) noexcept {
+        ++count_after;
+    }
+
+    void before_relation(const osmium::Relation& /*relation*/) noexcept {
+        ++count_before;
+    }
+
+    void relation_not_in_any_relation(const osmium::Relation& /*relation*/) noexcept {
+        ++count_not_in_any;
+    }
+
+    void after_relation(const osmium::Relation& /*relation*/) noexcept {
+        ++count_after;
+    }
+
+};
+
+TEST_CASE("Relations manager parallel second pass") {
+    osmium::io::File file{with_data_dir("t/relations/data.osm")};
+
+    ThreadedRM manager;
+
+    osmium::relations::read_relations(file, manager);
+
+    osmium::io::Reader reader{file};
+    manager.second_pass_parallel(reader);
+    reader.close();
+
+    REQUIRE(manager.count_complete_rels ==  2);
+    REQUIRE(manager.count_before        == 10);
+    REQUIRE(manager.count_not_in_any    ==  6);
+    REQUIRE(manager.count_after         == 10);
+
+    int n = 0;
+    manager.for_each_incomplete_relation([&](const osmium::relations::RelationHandle& handle){
+        ++n;
+        REQUIRE(handle->id() == 31);
+    });
+    REQUIRE(n == 1);
+}
+
+TEST_CASE("Export member ids from RelationsManager") {
+    osmium::io::File file{with_data_dir("t/relations/data.osm")};
+
+    AnyRM manager;
+
+    osmium::relations::read_relations(file, manager);
+
+    const auto node_ids = manager.member_ids(osmium::item_type::node);
+    REQUIRE(node_ids.size() == 2);
+    REQUIRE(node_ids.get(10));
+    REQUIRE(node_ids.get(11));
+    REQUIRE_FALSE(node_ids.get(12));
+
+    const auto way_ids = manager.member_ids(osmium::item_type::way);
+    REQUIRE(way_ids.size() == 2);
+    REQUIRE(way_ids.get(20));
+    REQUIRE(way_ids.get(22));
+    REQUIRE_FALSE(way_ids.get(21));
+
+    const auto relation_ids = manager.member_ids(osmium::item_type::relation);
+    REQUIRE(relation_ids.size() == 1);
+    REQUIRE(relation_ids.get(30));
+}
@@ -1,10 +1,13 @@
 #include "catch.hpp"
 
 #include <osmium/builder/attr.hpp>
+#include <osmium/index/detail/tmpfile.hpp>
 #include <osmium/storage/item_stash.hpp>
+#include <osmium/util/file.hpp>
 
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 osmium::memory::Buffer generate_test_data() {
@@ -166,3 +169,149 @@ TEST_CASE("Fill item stash until it garbage collects") {
     REQUIRE(stash.count_removed() == 0);
 }
 
+
+TEST_CASE("Item stash with spilling to disk") {
+    const auto buffer = generate_test_data();
+
+    osmium::ItemStash stash;
+    stash.set_max_memory(16 * 1024);
+
+    std::vector<osmium::ItemStash::handle_type> handles;
+    for (const auto& item : buffer) {
+        // Add every item a few times so the stash certainly grows
+        // beyond its memory limit.
+        for (int n = 0; n < 10; ++n) {
+            handles.push_back(stash.add_item(item));
+        }
+    }
+
+    REQUIRE(stash.size() == 1800);
+    REQUIRE(stash.spill_file_size() > 0);
+
+    // All items must be readable, whether they are still in memory,
+    // spilled to disk, or already in the cache of hot items.
+    osmium::object_id_type id = 1;
+    std::size_t n = 0;
+    for (const auto& item : buffer) {
+        REQUIRE(item.type() != osmium::item_type::undefined);
+        for (int m = 0; m < 10; ++m) {
+            const auto& object = stash.get<osmium::OSMObject>(handles[n]);
+            REQUIRE(object.id() == id);
+            REQUIRE(object.type() == item.type());
+            ++n;
+        }
+        ++id;
+    }
+
+    // Removing spilled items must work, too.
+    stash.remove_item(handles[0]);
+    stash.remove_item(handles.back());
+    REQUIRE(stash.size() == 1798);
+
+    stash.clear();
+    REQUIRE(stash.size() == 0);
+    REQUIRE(stash.spill_file_size() == 0);
+}
+
+TEST_CASE("Item stash incremental garbage collection") {
+    const auto buffer = generate_test_data();
+
+    osmium::ItemStash stash;
+    stash.enable_incremental_gc(10);
+
+    std::vector<std::pair<osmium::ItemStash::handle_type, osmium::object_id_type>> handles;
+    for (int i = 0; i < 10; ++i) {
+        for (const auto& item : buffer) {
+            const auto& obj = static_cast<const osmium::OSMObject&>(item);
+            handles.emplace_back(stash.add_item(item), obj.id());
+        }
+    }
+    REQUIRE(stash.size() == 1800);
+
+    // Remove every other item.
+    for (std::size_t i = 0; i < handles.size(); i += 2) {
+        stash.remove_item(handles[i].first);
+        handles[i].first = osmium::ItemStash::handle_type{};
+    }
+    REQUIRE(stash.size() == 900);
+    REQUIRE(stash.count_removed() == 900);
+
+    const auto check_all = [&]() {
+        for (const auto& hi : handles) {
+            if (hi.first.valid()) {
+                const auto& obj = stash.get<osmium::OSMObject>(hi.first);
+                REQUIRE(obj.id() == hi.second);
+            }
+        }
+    };
+
+    // Drive the collection cycle explicitly in small steps...
+    REQUIRE_FALSE(stash.garbage_collect_step(100));
+    REQUIRE(stash.garbage_collecting());
+
+    // ...and interleave adding and reading items while it is running.
+    for (const auto& item : buffer) {
+        const auto& obj = static_cast<const osmium::OSMObject&>(item);
+        handles.emplace_back(stash.add_item(item), obj.id());
+    }
+    check_all();
+
+    while (!stash.garbage_collect_step(100)) {
+    }
+    REQUIRE_FALSE(stash.garbage_collecting());
+    REQUIRE(stash.count_removed() == 0);
+    REQUIRE(stash.size() == 1080);
+    check_all();
+
+    // The stop-the-world collection still works after that.
+    for (std::size_t i = 1; i < handles.size(); i += 2) {
+        if (handles[i].first.valid()) {
+            stash.remove_item(handles[i].first);
+            handles[i].first = osmium::ItemStash::handle_type{};
+        }
+    }
+    stash.garbage_collect();
+    REQUIRE(stash.count_removed() == 0);
+    check_all();
+
+    stash.clear();
+    REQUIRE(stash.size() == 0);
+    REQUIRE_FALSE(stash.garbage_collecting());
+}
+
+TEST_CASE("Dump and load item stash") {
+    const auto buffer = generate_test_data();
+
+    osmium::ItemStash stash;
+    std::vector<osmium::ItemStash::handle_type> handles;
+    for (const auto& item : buffer) {
+        handles.push_back(stash.add_item(item));
+    }
+    stash.remove_item(handles[7]);
+    stash.remove_item(handles[70]);
+
+    const int fd = osmium::detail::create_tmp_file();
+    stash.dump(fd);
+    osmium::util::file_seek(fd, 0);
+
+    osmium::ItemStash restored;
+    restored.load(fd);
+
+    REQUIRE(restored.size() == stash.size());
+    REQUIRE(restored.count_removed() == 2);
+
+    // handles from the dumped stash work on the restored one
+    for (std::size_t i = 0; i < handles.size(); ++i) {
+        if (i == 7 || i == 70) {
+            continue;
+        }
+        const auto& orig = stash.get<osmium::OSMObject>(handles[i]);
+        const auto& rest = restored.get<osmium::OSMObject>(handles[i]);
+        REQUIRE(orig.id() == rest.id());
+        REQUIRE(orig.type() == rest.type());
+    }
+
+    // the restored stash is fully functional
+    const auto handle = restored.add_item(buffer.get<osmium::memory::Item>(0));
+    REQUIRE(restored.get<osmium::OSMObject>(handle).id() == 1);
+}
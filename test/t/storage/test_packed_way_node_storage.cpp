@@ -0,0 +1,66 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/storage/packed_way_node_storage.hpp>
+
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+TEST_CASE("Empty PackedWayNodeStorage") {
+    const osmium::PackedWayNodeStorage storage;
+    REQUIRE(storage.empty());
+    REQUIRE(storage.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(storage.begin() == storage.end());
+}
+
+TEST_CASE("PackedWayNodeStorage stores and iterates way node ids") {
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_way(buffer, _id(17), _nodes({100, 101, 103, 102}));
+    osmium::builder::add_way(buffer, _id(-3), _nodes({2000000000000LL, 1, 2000000000001LL}));
+
+    osmium::PackedWayNodeStorage storage;
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        storage.add(way);
+    }
+
+    REQUIRE_FALSE(storage.empty());
+    REQUIRE(storage.size() == 2);
+    REQUIRE(storage.used_memory() > sizeof(osmium::PackedWayNodeStorage));
+
+    auto it = storage.begin();
+    auto way = *it;
+    REQUIRE(way.way_id() == 17);
+    REQUIRE(way.size() == 4);
+    const std::vector<osmium::object_id_type> first{way.begin(), way.end()};
+    REQUIRE(first == (std::vector<osmium::object_id_type>{100, 101, 103, 102}));
+
+    ++it;
+    way = *it;
+    REQUIRE(way.way_id() == -3);
+    REQUIRE(way.size() == 3);
+    const std::vector<osmium::object_id_type> second{way.begin(), way.end()};
+    REQUIRE(second == (std::vector<osmium::object_id_type>{2000000000000LL, 1, 2000000000001LL}));
+
+    ++it;
+    REQUIRE(it == storage.end());
+
+    storage.clear();
+    REQUIRE(storage.empty());
+}
+
+TEST_CASE("PackedWayNodeStorage handles ways without nodes") {
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    osmium::builder::add_way(buffer, _id(42));
+
+    osmium::PackedWayNodeStorage storage;
+    storage.add(*buffer.select<osmium::Way>().cbegin());
+
+    REQUIRE(storage.size() == 1);
+    const auto way = *storage.begin();
+    REQUIRE(way.way_id() == 42);
+    REQUIRE(way.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(way.begin() == way.end());
+}
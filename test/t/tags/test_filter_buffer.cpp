@@ -0,0 +1,79 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/tags/filter_buffer.hpp>
+#include <osmium/tags/tags_filter.hpp>
+
+#include <cstddef>
+#include <iterator>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+struct NullCallback {
+
+    void moving_in_buffer(std::size_t /*old_offset*/, std::size_t /*new_offset*/) {
+    }
+
+}; // struct NullCallback
+
+void fill_buffer(osmium::memory::Buffer& buffer) {
+    osmium::builder::add_node(buffer, _id(1), _tag("highway", "primary"));
+    osmium::builder::add_node(buffer, _id(2), _tag("name", "Main Street"));
+    osmium::builder::add_node(buffer, _id(3));
+    osmium::builder::add_way(buffer, _id(4), _tag("highway", "residential"));
+    osmium::builder::add_relation(buffer, _id(5), _tag("type", "route"));
+}
+
+} // anonymous namespace
+
+TEST_CASE("Filter whole buffer marking matching ids") {
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    fill_buffer(buffer);
+
+    osmium::TagsFilter filter;
+    filter.add_rule(true, "highway");
+    filter.add_rule(true, "type", "route");
+
+    osmium::tags::filter_id_sets matching_ids;
+    const auto count = osmium::tags::filter_buffer(buffer, filter, matching_ids);
+
+    REQUIRE(count == 3);
+    REQUIRE(matching_ids(osmium::item_type::node).get(1));
+    REQUIRE_FALSE(matching_ids(osmium::item_type::node).get(2));
+    REQUIRE_FALSE(matching_ids(osmium::item_type::node).get(3));
+    REQUIRE(matching_ids(osmium::item_type::way).get(4));
+    REQUIRE(matching_ids(osmium::item_type::relation).get(5));
+
+    // nothing was flagged as removed
+    const auto objects = buffer.select<osmium::OSMObject>();
+    REQUIRE(std::distance(objects.begin(), objects.end()) == 5);
+    for (const auto& object : objects) {
+        REQUIRE_FALSE(object.removed());
+    }
+}
+
+TEST_CASE("Filter whole buffer removing non-matches") {
+    osmium::memory::Buffer buffer{1024UL * 10UL};
+    fill_buffer(buffer);
+
+    osmium::TagsFilter filter;
+    filter.add_rule(true, "highway");
+    filter.add_rule(true, "type", "route");
+
+    osmium::tags::filter_id_sets matching_ids;
+    const auto count = osmium::tags::filter_buffer(buffer, filter, matching_ids, true);
+    REQUIRE(count == 3);
+
+    NullCallback callback;
+    buffer.purge_removed(&callback);
+
+    const auto objects = buffer.select<osmium::OSMObject>();
+    REQUIRE(std::distance(objects.begin(), objects.end()) == 3);
+    for (const auto& object : objects) {
+        REQUIRE(matching_ids(object.type()).get(static_cast<osmium::unsigned_object_id_type>(object.id())));
+    }
+}
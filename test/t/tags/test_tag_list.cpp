@@ -223,3 +223,38 @@ TEST_CASE("tag key or value is too long") {
     REQUIRE_THROWS(builder.add_tag(kv, 1, kv, 1500));
 }
 
+
+TEST_CASE("tag key bloom") {
+    osmium::memory::Buffer buffer{10240};
+    const auto pos = osmium::builder::add_tag_list(buffer, _tags({
+        { "highway", "primary" },
+        { "name", "Main Street" },
+        { "maxspeed", "50" }
+    }));
+    const osmium::TagList& tag_list = buffer.get<osmium::TagList>(pos);
+
+    const osmium::TagKeyBloom bloom{tag_list};
+
+    // keys in the tag list must be reported as possible
+    REQUIRE(bloom.may_have_key("highway"));
+    REQUIRE(bloom.may_have_key("name"));
+    REQUIRE(bloom.may_have_key("maxspeed"));
+
+    REQUIRE(bloom.may_have_key(osmium::TagKeyBloom::bit("highway")));
+    REQUIRE(bloom.may_have_key(osmium::TagKeyBloom::bit("name")));
+
+    // an empty bloom reports all keys as definite misses
+    const osmium::TagKeyBloom empty_bloom;
+    REQUIRE_FALSE(empty_bloom.may_have_key("highway"));
+    REQUIRE_FALSE(empty_bloom.may_have_key(osmium::TagKeyBloom::bit("name")));
+
+    // a miss can be a false positive, so count misses over many keys
+    // instead of testing specific ones
+    int misses = 0;
+    for (int i = 0; i < 100; ++i) {
+        if (!bloom.may_have_key(("key" + std::to_string(i)).c_str())) {
+            ++misses;
+        }
+    }
+    REQUIRE(misses > 50);
+}
@@ -141,3 +141,39 @@ TEST_CASE("Copy and move tag matcher") {
     REQUIRE_FALSE(c1("name", "High Street"));
 }
 
+
+TEST_CASE("Static tag matcher") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto pos = osmium::builder::add_tag_list(buffer,
+        osmium::builder::attr::_tags({
+            { "highway", "primary" },
+            { "name", "Main Street" },
+            { "source", "GPS" }
+    }));
+    const osmium::TagList& tag_list = buffer.get<osmium::TagList>(pos);
+
+    SECTION("Matching key") {
+        const auto m = osmium::static_tag_matcher("highway");
+        REQUIRE(m(tag_list));
+        REQUIRE(m(*tag_list.begin()));
+        REQUIRE_FALSE(m(*std::next(tag_list.begin())));
+        REQUIRE_FALSE(m("name", "High Street"));
+    }
+
+    SECTION("Matching key and value") {
+        const auto m = osmium::static_tag_matcher("highway", "primary");
+        REQUIRE(m(tag_list));
+        REQUIRE(m(*tag_list.begin()));
+        REQUIRE_FALSE(m("highway", "secondary"));
+    }
+
+    SECTION("Matching key and value list") {
+        const auto m = osmium::static_tag_matcher("highway",
+            osmium::static_matcher::any_of({"primary", "secondary"}));
+        REQUIRE(m(tag_list));
+        REQUIRE(m("highway", "secondary"));
+        REQUIRE_FALSE(m("highway", "motorway"));
+        REQUIRE_FALSE(m("name", "primary"));
+    }
+}
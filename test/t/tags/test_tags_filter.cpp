@@ -45,6 +45,16 @@ TEST_CASE("Tags filter") {
         REQUIRE_FALSE(filter(*std::next(tag_list2.begin())));
     }
 
+    SECTION("Filter called with plain key and value strings") {
+        osmium::TagsFilter filter;
+        filter.add_rule(true, "highway");
+        filter.add_rule(true, "amenity", "restaurant");
+        REQUIRE(filter("highway", "primary"));
+        REQUIRE(filter("amenity", "restaurant"));
+        REQUIRE_FALSE(filter("amenity", "post_box"));
+        REQUIRE_FALSE(filter("name", "Main Street"));
+    }
+
     SECTION("Filter based on key only: fail") {
         osmium::TagsFilter filter;
         filter.add_rule(true, osmium::StringMatcher::equal{"foo"});
@@ -79,6 +89,74 @@ TEST_CASE("Tags filter") {
 
 }
 
+TEST_CASE("Compiled tags filter") {
+    SECTION("Compiling works with exact key matchers only") {
+        osmium::TagsFilter filter;
+        filter.add_rule(false, "highway", "motorway");
+        filter.add_rule(true, "highway");
+        filter.add_rule(true, "amenity", "restaurant");
+
+        REQUIRE(filter.compile());
+
+        REQUIRE_FALSE(filter("highway", "motorway"));
+        REQUIRE(filter("highway", "primary"));
+        REQUIRE(filter("amenity", "restaurant"));
+        REQUIRE_FALSE(filter("amenity", "post_box"));
+        REQUIRE_FALSE(filter("name", "Main Street"));
+    }
+
+    SECTION("Compiling fails with other key matchers") {
+        osmium::TagsFilter filter;
+        filter.add_rule(true, "highway");
+        filter.add_rule(true, osmium::StringMatcher::prefix{"addr:"});
+
+        REQUIRE_FALSE(filter.compile());
+
+        // the filter still works with the uncompiled rule scan
+        REQUIRE(filter("highway", "primary"));
+        REQUIRE(filter("addr:street", "Main Street"));
+        REQUIRE_FALSE(filter("name", "Main Street"));
+    }
+
+    SECTION("Check keys only") {
+        osmium::TagsFilter filter;
+        REQUIRE_FALSE(filter.default_result());
+        filter.add_rule(false, "highway", "motorway");
+        filter.add_rule(true, "amenity", "restaurant");
+        filter.add_rule(true, osmium::StringMatcher::prefix{"addr:"});
+
+        REQUIRE(filter.matches_key("highway"));
+        REQUIRE(filter.matches_key("amenity"));
+        REQUIRE(filter.matches_key("addr:street"));
+        REQUIRE_FALSE(filter.matches_key("name"));
+    }
+
+    SECTION("Check keys only with compiled filter") {
+        osmium::TagsFilter filter{true};
+        REQUIRE(filter.default_result());
+        filter.add_rule(false, "highway", "motorway");
+        filter.add_rule(true, "amenity", "restaurant");
+        REQUIRE(filter.compile());
+
+        REQUIRE(filter.matches_key("highway"));
+        REQUIRE(filter.matches_key("amenity"));
+        REQUIRE_FALSE(filter.matches_key("name"));
+    }
+
+    SECTION("Adding a rule invalidates the compiled table") {
+        osmium::TagsFilter filter;
+        filter.add_rule(true, "highway");
+
+        REQUIRE(filter.compile());
+        REQUIRE_FALSE(filter("amenity", "restaurant"));
+
+        filter.add_rule(true, "amenity");
+        REQUIRE(filter("amenity", "restaurant"));
+        REQUIRE(filter.compile());
+        REQUIRE(filter("amenity", "restaurant"));
+    }
+}
+
 struct result_type {
 
     int v = 0;
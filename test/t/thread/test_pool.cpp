@@ -3,7 +3,11 @@
 #include <osmium/thread/pool.hpp>
 #include <osmium/util/compatibility.hpp>
 
+#include <cstdint>
+#include <future>
+#include <mutex>
 #include <stdexcept>
+#include <vector>
 
 struct test_job_with_result {
     int operator()() const {
@@ -105,3 +109,131 @@ TEST_CASE("can throw from job in user provided thread pool") {
     REQUIRE_THROWS_AS(future.get(), const std::runtime_error&);
 }
 
+
+TEST_CASE("restrict pool workers to given cpus") {
+    osmium::thread::Pool pool{2};
+
+#ifdef __linux__
+    REQUIRE(pool.set_affinity({0}));
+
+    auto future = pool.submit(test_job_with_result{});
+    REQUIRE(future.get() == 42);
+#else
+    REQUIRE_FALSE(pool.set_affinity({0}));
+#endif
+
+    REQUIRE_FALSE(pool.set_affinity({}));
+}
+
+TEST_CASE("parse cpu list") {
+    REQUIRE(osmium::thread::detail::parse_cpu_list("0") == std::vector<int>{0});
+    REQUIRE(osmium::thread::detail::parse_cpu_list("0,2") == (std::vector<int>{0, 2}));
+    REQUIRE(osmium::thread::detail::parse_cpu_list("0,4-7") == (std::vector<int>{0, 4, 5, 6, 7}));
+    REQUIRE(osmium::thread::detail::parse_cpu_list("2-3,0") == (std::vector<int>{2, 3, 0}));
+
+    REQUIRE(osmium::thread::detail::parse_cpu_list("").empty());
+    REQUIRE(osmium::thread::detail::parse_cpu_list("x").empty());
+    REQUIRE(osmium::thread::detail::parse_cpu_list("-1").empty());
+    REQUIRE(osmium::thread::detail::parse_cpu_list("3-1").empty());
+    REQUIRE(osmium::thread::detail::parse_cpu_list("1,x").empty());
+}
+
+TEST_CASE("affinity policy gives one cpu per worker") {
+    REQUIRE(osmium::thread::detail::affinity_cpus("", 4, 8).empty());
+    REQUIRE(osmium::thread::detail::affinity_cpus("none", 4, 8).empty());
+    REQUIRE(osmium::thread::detail::affinity_cpus("compact", 4, 8) == (std::vector<int>{0, 1, 2, 3}));
+    REQUIRE(osmium::thread::detail::affinity_cpus("compact", 4, 2) == (std::vector<int>{0, 1, 0, 1}));
+    REQUIRE(osmium::thread::detail::affinity_cpus("scatter", 4, 8) == (std::vector<int>{0, 2, 4, 6}));
+    REQUIRE(osmium::thread::detail::affinity_cpus("scatter", 4, 4) == (std::vector<int>{0, 1, 2, 3}));
+    REQUIRE(osmium::thread::detail::affinity_cpus("4-5", 4, 8) == (std::vector<int>{4, 5, 4, 5}));
+    REQUIRE(osmium::thread::detail::affinity_cpus("nonsense", 4, 8).empty());
+}
+
+TEST_CASE("high priority tasks run before queued normal tasks") {
+    osmium::thread::Pool pool{1};
+
+    // Block the only worker so the following tasks stay queued until
+    // both have been submitted.
+    std::promise<void> gate;
+    auto gate_future = gate.get_future();
+    auto blocker = pool.submit([&gate_future] {
+        gate_future.wait();
+    });
+
+    std::vector<int> order;
+    std::mutex mutex;
+    auto normal = pool.submit([&order, &mutex] {
+        std::lock_guard<std::mutex> lock{mutex};
+        order.push_back(1);
+    });
+    auto high = pool.submit(osmium::thread::Pool::priority::high, [&order, &mutex] {
+        std::lock_guard<std::mutex> lock{mutex};
+        order.push_back(2);
+    });
+
+    gate.set_value();
+    blocker.get();
+    normal.get();
+    high.get();
+
+    REQUIRE(order == (std::vector<int>{2, 1}));
+}
+
+TEST_CASE("quota limits outstanding tasks") {
+    osmium::thread::Pool pool{2};
+    osmium::thread::Pool::Quota quota{pool, 1};
+
+    REQUIRE(quota.outstanding() == 0);
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 10; ++i) {
+        results.push_back(quota.submit(test_job_with_result{}));
+        REQUIRE(quota.outstanding() <= 1);
+    }
+    for (auto& future : results) {
+        REQUIRE(future.get() == 42);
+    }
+
+    REQUIRE(quota.outstanding() == 0);
+}
+
+TEST_CASE("quota without limit does not block") {
+    osmium::thread::Pool pool{2};
+    osmium::thread::Pool::Quota quota{pool};
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 10; ++i) {
+        results.push_back(quota.submit(test_job_with_result{}));
+    }
+    for (auto& future : results) {
+        REQUIRE(future.get() == 42);
+    }
+}
+
+TEST_CASE("pool metrics count tasks run") {
+    osmium::thread::Pool pool{2};
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 10; ++i) {
+        results.push_back(pool.submit(test_job_with_result{}));
+    }
+    for (auto& future : results) {
+        REQUIRE(future.get() == 42);
+    }
+
+    const auto metrics = pool.metrics();
+    REQUIRE(metrics.tasks_run == 10);
+    REQUIRE(metrics.pending_tasks == 0);
+
+    uint64_t sum = 0;
+    for (const auto count : metrics.task_run_time) {
+        sum += count;
+    }
+    REQUIRE(sum == 10);
+}
+
+TEST_CASE("can construct pool with affinity policy") {
+    osmium::thread::Pool pool{2, osmium::thread::Pool::default_queue_size, "compact"};
+    auto future = pool.submit(test_job_with_result{});
+    REQUIRE(future.get() == 42);
+}
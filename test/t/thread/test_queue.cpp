@@ -2,6 +2,8 @@
 
 #include <osmium/thread/queue.hpp>
 
+#include <thread>
+
 TEST_CASE("Basic use of thread-safe queue") {
     osmium::thread::Queue<int> queue;
     REQUIRE(queue.empty());
@@ -18,3 +20,57 @@ TEST_CASE("Queue can have max elements and can be named") {
     osmium::thread::Queue<int> queue{100, "Queue of max size 100"};
 }
 
+TEST_CASE("Queue counts pushes and pops") {
+    osmium::thread::Queue<int> queue;
+
+    queue.push(1);
+    queue.push(2);
+
+    int value = 0;
+    queue.wait_and_pop(value);
+    REQUIRE(queue.try_pop(value));
+    REQUIRE_FALSE(queue.try_pop(value));
+
+    const auto counters = queue.counters();
+    REQUIRE(counters.push == 2);
+    REQUIRE(counters.full == 0);
+    REQUIRE(counters.pop == 3);
+    REQUIRE(counters.empty == 1);
+    REQUIRE(counters.largest_size == 2);
+    REQUIRE(counters.size == 0);
+}
+
+
+TEST_CASE("Adaptive sizing clamps the queue limit into the given range") {
+    osmium::thread::Queue<int> queue{100};
+    REQUIRE(queue.max_size() == 100);
+
+    queue.set_adaptive_size(2, 10);
+    REQUIRE(queue.max_size() == 10);
+
+    queue.set_adaptive_size(20, 50);
+    REQUIRE(queue.max_size() == 20);
+}
+
+TEST_CASE("Adaptive queue limit stays in range under load") {
+    osmium::thread::Queue<int> queue{2};
+    queue.set_adaptive_size(2, 64);
+
+    std::thread producer{[&queue] {
+        for (int i = 0; i < 300; ++i) {
+            queue.push(i);
+        }
+    }};
+
+    int sum = 0;
+    for (int i = 0; i < 300; ++i) {
+        int value = 0;
+        queue.wait_and_pop(value);
+        sum += value;
+    }
+    producer.join();
+
+    REQUIRE(sum == 300 * 299 / 2);
+    REQUIRE(queue.max_size() >= 2);
+    REQUIRE(queue.max_size() <= 64);
+}
@@ -0,0 +1,97 @@
+#include "catch.hpp"
+
+#include <osmium/thread/ring_queue.hpp>
+
+#include <thread>
+#include <vector>
+
+TEST_CASE("Basic use of ring queue") {
+    osmium::thread::RingQueue<int> queue;
+    REQUIRE(queue.empty());
+    queue.push(22);
+    REQUIRE_FALSE(queue.empty());
+    REQUIRE(queue.size() == 1);
+    int value = 0;
+    queue.wait_and_pop(value);
+    REQUIRE(value == 22);
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("Ring queue can have max elements and can be named") {
+    osmium::thread::RingQueue<int> queue{100, "Ring queue of max size 100"};
+}
+
+TEST_CASE("Ring queue counts pushes and pops") {
+    osmium::thread::RingQueue<int> queue;
+
+    queue.push(1);
+    queue.push(2);
+
+    int value = 0;
+    queue.wait_and_pop(value);
+    REQUIRE(queue.try_pop(value));
+    REQUIRE_FALSE(queue.try_pop(value));
+
+    const auto counters = queue.counters();
+    REQUIRE(counters.push == 2);
+    REQUIRE(counters.full == 0);
+    REQUIRE(counters.pop == 3);
+    REQUIRE(counters.empty == 1);
+    REQUIRE(counters.largest_size == 2);
+    REQUIRE(counters.size == 0);
+}
+
+TEST_CASE("Ring queue blocks producers when full") {
+    osmium::thread::RingQueue<int> queue{2};
+
+    std::thread producer{[&queue] {
+        for (int i = 0; i < 100; ++i) {
+            queue.push(i);
+        }
+    }};
+
+    for (int i = 0; i < 100; ++i) {
+        int value = -1;
+        queue.wait_and_pop(value);
+        REQUIRE(value == i);
+    }
+
+    producer.join();
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("Ring queue works with multiple producers and consumers") {
+    osmium::thread::RingQueue<int> queue{16};
+
+    std::vector<std::thread> producers;
+    for (int n = 0; n < 4; ++n) {
+        producers.emplace_back([&queue] {
+            for (int i = 0; i < 1000; ++i) {
+                queue.push(1);
+            }
+        });
+    }
+
+    std::vector<std::thread> consumers;
+    std::vector<int> sums(4, 0);
+    for (int n = 0; n < 4; ++n) {
+        int& sum = sums[n];
+        consumers.emplace_back([&queue, &sum] {
+            for (int i = 0; i < 1000; ++i) {
+                int value = 0;
+                queue.wait_and_pop(value);
+                sum += value;
+            }
+        });
+    }
+
+    for (auto& thread : producers) {
+        thread.join();
+    }
+    for (auto& thread : consumers) {
+        thread.join();
+    }
+
+    REQUIRE(sums[0] + sums[1] + sums[2] + sums[3] == 4000);
+    REQUIRE(queue.empty());
+}
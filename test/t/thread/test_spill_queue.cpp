@@ -0,0 +1,107 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/thread/spill_queue.hpp>
+
+#include <utility>
+
+namespace {
+
+    osmium::memory::Buffer buffer_with_node(const osmium::object_id_type id) {
+        using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+        osmium::memory::Buffer buffer{1024UL};
+        osmium::builder::add_node(buffer, _id(id), _location(1.0, 2.0));
+        return buffer;
+    }
+
+    osmium::object_id_type first_id(const osmium::memory::Buffer& buffer) {
+        return buffer.cbegin<osmium::Node>()->id();
+    }
+
+} // anonymous namespace
+
+TEST_CASE("SpillQueue works in memory while there is space") {
+    osmium::thread::SpillQueue queue{2};
+
+    REQUIRE(queue.empty());
+
+    queue.push(buffer_with_node(1));
+    queue.push(buffer_with_node(2));
+    REQUIRE(queue.size() == 2);
+    REQUIRE(queue.counters().spilled == 0);
+
+    osmium::memory::Buffer buffer;
+    queue.wait_and_pop(buffer);
+    REQUIRE(first_id(buffer) == 1);
+    queue.wait_and_pop(buffer);
+    REQUIRE(first_id(buffer) == 2);
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("SpillQueue spills to disk when full and replays in order") {
+    osmium::thread::SpillQueue queue{2};
+
+    for (osmium::object_id_type id = 1; id <= 5; ++id) {
+        queue.push(buffer_with_node(id));
+    }
+
+    const auto counters = queue.counters();
+    REQUIRE(counters.push == 5);
+    REQUIRE(counters.spilled == 3);
+    REQUIRE(counters.spill_size == 3);
+    REQUIRE(counters.spilled_bytes > 0);
+    REQUIRE(queue.size() == 5);
+
+    osmium::memory::Buffer buffer;
+    for (osmium::object_id_type id = 1; id <= 5; ++id) {
+        REQUIRE(queue.try_pop(buffer));
+        REQUIRE(first_id(buffer) == id);
+    }
+    REQUIRE(queue.empty());
+    REQUIRE_FALSE(queue.try_pop(buffer));
+
+    // after the spill file has been drained the queue is in-memory again
+    queue.push(buffer_with_node(10));
+    REQUIRE(queue.counters().spilled == 3);
+    REQUIRE(queue.try_pop(buffer));
+    REQUIRE(first_id(buffer) == 10);
+}
+
+TEST_CASE("SpillQueue preserves order across spilling and draining cycles") {
+    osmium::thread::SpillQueue queue{1};
+
+    osmium::memory::Buffer buffer;
+    osmium::object_id_type next_pop = 1;
+    osmium::object_id_type next_push = 1;
+
+    // push two, pop one, repeatedly: the queue keeps alternating
+    // between spilling and draining
+    for (int i = 0; i < 10; ++i) {
+        queue.push(buffer_with_node(next_push++));
+        queue.push(buffer_with_node(next_push++));
+        queue.wait_and_pop(buffer);
+        REQUIRE(first_id(buffer) == next_pop++);
+    }
+    while (queue.try_pop(buffer)) {
+        REQUIRE(first_id(buffer) == next_pop++);
+    }
+    REQUIRE(next_pop == next_push);
+}
+
+TEST_CASE("SpillQueue can spill invalid buffers used as end marker") {
+    osmium::thread::SpillQueue queue{1};
+
+    queue.push(buffer_with_node(1));
+    queue.push(buffer_with_node(2));
+    queue.push(osmium::memory::Buffer{});
+
+    osmium::memory::Buffer buffer;
+    queue.wait_and_pop(buffer);
+    REQUIRE(first_id(buffer) == 1);
+    queue.wait_and_pop(buffer);
+    REQUIRE(first_id(buffer) == 2);
+    queue.wait_and_pop(buffer);
+    REQUIRE_FALSE(buffer);
+}
@@ -81,3 +81,24 @@ TEST_CASE("get_max_queue_size") {
     REQUIRE(osmium::config::get_max_queue_size("NAME", 7) == 3);
 }
 
+
+TEST_CASE("use_direct_reads") {
+    osmium::detail::env = nullptr;
+    REQUIRE_FALSE(osmium::config::use_direct_reads());
+    REQUIRE(osmium::detail::name == "OSMIUM_DIRECT_READS");
+    osmium::detail::env = "";
+    REQUIRE_FALSE(osmium::config::use_direct_reads());
+    osmium::detail::env = "off";
+    REQUIRE_FALSE(osmium::config::use_direct_reads());
+
+    osmium::detail::env = "on";
+    REQUIRE(osmium::config::use_direct_reads());
+    osmium::detail::env = "true";
+    REQUIRE(osmium::config::use_direct_reads());
+    osmium::detail::env = "yes";
+    REQUIRE(osmium::config::use_direct_reads());
+    osmium::detail::env = "Yes";
+    REQUIRE(osmium::config::use_direct_reads());
+    osmium::detail::env = "1";
+    REQUIRE(osmium::config::use_direct_reads());
+}
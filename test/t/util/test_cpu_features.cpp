@@ -0,0 +1,26 @@
+#include "catch.hpp"
+
+#include <osmium/util/cpu_features.hpp>
+
+TEST_CASE("CPU feature detection") {
+    const auto& features = osmium::util::cpu_features();
+
+#if defined(__x86_64__) || defined(_M_X64)
+    // SSE2 is baseline on x86-64
+    REQUIRE(features.sse2);
+    REQUIRE_FALSE(features.neon);
+#elif defined(__aarch64__)
+    REQUIRE(features.neon);
+    REQUIRE_FALSE(features.sse2);
+#endif
+
+    // AVX-512 implies AVX2: both need OS support for the wide registers
+    if (features.avx512bw) {
+        REQUIRE(features.avx2);
+    }
+
+    // the cached features don't change between calls
+    const auto& features_again = osmium::util::cpu_features();
+    REQUIRE(&features == &features_again);
+    REQUIRE(features.avx2 == osmium::util::detect_cpu_features().avx2);
+}
@@ -2,6 +2,7 @@
 
 #include <osmium/util/delta.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -87,3 +88,63 @@ TEST_CASE("delta encode and decode") {
     REQUIRE(a == c);
 }
 
+
+TEST_CASE("bulk delta decode") {
+    std::vector<int64_t> values = { 1000, 10, -30, 0, 5 };
+
+    osmium::DeltaDecode<int64_t> x;
+    REQUIRE(x.update(values.data(), values.size()) == 985);
+
+    REQUIRE(values == (std::vector<int64_t>{ 1000, 1010, 980, 980, 985 }));
+
+    // bulk and single-value updates can be mixed
+    REQUIRE(x.update(15) == 1000);
+}
+
+TEST_CASE("bulk delta decode of empty array") {
+    osmium::DeltaDecode<int64_t> x;
+    x.update(100);
+
+    REQUIRE(x.update(nullptr, 0) == 100);
+}
+
+TEST_CASE("bulk delta decode of large array") {
+    std::vector<int64_t> values(1000, 2);
+    values[0] = 10000;
+
+    osmium::DeltaDecode<int64_t> x;
+    REQUIRE(x.update(values.data(), values.size()) == 10000 + 999 * 2);
+
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        REQUIRE(values[i] == 10000 + static_cast<int64_t>(i) * 2);
+    }
+}
+
+TEST_CASE("bulk delta encode") {
+    std::vector<int64_t> values = { 1000, 1010, 980, 980, 985 };
+
+    osmium::DeltaEncode<int64_t> x;
+    x.update(values.data(), values.size());
+
+    REQUIRE(values == (std::vector<int64_t>{ 1000, 10, -30, 0, 5 }));
+
+    // the state is the last original value
+    REQUIRE(x.update(1000) == 15);
+}
+
+TEST_CASE("bulk delta encode and decode round trip") {
+    std::vector<int64_t> values;
+    values.reserve(777);
+    for (int64_t i = 0; i < 777; ++i) {
+        values.push_back(i * i - 300 * i);
+    }
+    const std::vector<int64_t> original{values};
+
+    osmium::DeltaEncode<int64_t> de;
+    de.update(values.data(), values.size());
+
+    osmium::DeltaDecode<int64_t> dd;
+    dd.update(values.data(), values.size());
+
+    REQUIRE(values == original);
+}
@@ -2,7 +2,10 @@
 
 #include <osmium/util/double.hpp>
 
+#include <cstddef>
+#include <cstdio>
 #include <string>
+#include <utility>
 
 TEST_CASE("Check double2string function") {
     std::string s1;
@@ -28,5 +31,68 @@ TEST_CASE("Check double2string function") {
     std::string s6;
     osmium::double2string(s6, -0.0, 7);
     REQUIRE(s6 == "-0");
+
+    std::string s7;
+    osmium::double2string(s7, 180.0000001, 7);
+    REQUIRE(s7 == "180.0000001");
+
+    std::string s8;
+    osmium::double2string(s8, -179.9999999, 7);
+    REQUIRE(s8 == "-179.9999999");
+
+    std::string s9;
+    osmium::double2string(s9, 3.141592653589793, 7);
+    REQUIRE(s9 == "3.1415927");
+}
+
+TEST_CASE("Check double2string function on the snprintf fallback path") {
+    // too many digits for the integer fast path
+    std::string s1;
+    osmium::double2string(s1, 1.123, 12);
+    REQUIRE(s1 == "1.123");
+
+    // too large for the integer fast path
+    std::string s2;
+    osmium::double2string(s2, 1234567890.5, 7);
+    REQUIRE(s2 == "1234567890.5");
+}
+
+TEST_CASE("double2string with a precision of 0 keeps integer zeros") {
+    std::string s1;
+    osmium::double2string(s1, 250.0, 0);
+    REQUIRE(s1 == "250");
+
+    // too large for the integer fast path
+    std::string s2;
+    osmium::double2string(s2, 1234567890.0, 0);
+    REQUIRE(s2 == "1234567890");
+}
+
+TEST_CASE("double2string rounds decimal ties like snprintf") {
+    // Exactly representable ties like 0.25 at precision 1 must print
+    // the same as with snprintf, whatever the platform does with them.
+    const std::pair<double, int> ties[] = {
+        { 0.25, 1}, {-0.25, 1},
+        { 0.75, 1}, {-0.75, 1},
+        {12.125, 2}, {-12.125, 2},
+        { 1.0625, 3},
+        { 2.5, 0}, {3.5, 0}
+    };
+
+    for (const auto& tie : ties) {
+        char expected[20];
+        int len = snprintf(expected, sizeof(expected), "%.*f", tie.second, tie.first);
+        REQUIRE(len > 0);
+        while (expected[len - 1] == '0') {
+            --len;
+        }
+        if (expected[len - 1] == '.') {
+            --len;
+        }
+
+        std::string s;
+        osmium::double2string(s, tie.first, tie.second);
+        REQUIRE(s == std::string(expected, std::size_t(len)));
+    }
 }
 
@@ -0,0 +1,46 @@
+#include "catch.hpp"
+
+#include <osmium/util/itoa.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace {
+
+std::string fmt_unsigned(uint64_t value) {
+    char buffer[20];
+    return std::string{buffer, osmium::util::uint64_to_string(value, buffer)};
+}
+
+std::string fmt_signed(int64_t value) {
+    char buffer[21];
+    return std::string{buffer, osmium::util::int64_to_string(value, buffer)};
+}
+
+} // anonymous namespace
+
+TEST_CASE("Convert unsigned integers to strings") {
+    REQUIRE(fmt_unsigned(0) == "0");
+    REQUIRE(fmt_unsigned(7) == "7");
+    REQUIRE(fmt_unsigned(10) == "10");
+    REQUIRE(fmt_unsigned(99) == "99");
+    REQUIRE(fmt_unsigned(100) == "100");
+    REQUIRE(fmt_unsigned(12345678901234ull) == "12345678901234");
+    REQUIRE(fmt_unsigned(std::numeric_limits<uint64_t>::max()) == "18446744073709551615");
+}
+
+TEST_CASE("Convert signed integers to strings") {
+    REQUIRE(fmt_signed(0) == "0");
+    REQUIRE(fmt_signed(42) == "42");
+    REQUIRE(fmt_signed(-1) == "-1");
+    REQUIRE(fmt_signed(-12345678901234ll) == "-12345678901234");
+    REQUIRE(fmt_signed(std::numeric_limits<int64_t>::max()) == "9223372036854775807");
+    REQUIRE(fmt_signed(std::numeric_limits<int64_t>::min()) == "-9223372036854775808");
+}
+
+TEST_CASE("All two-digit combinations round-trip") {
+    for (uint64_t i = 0; i < 100; ++i) {
+        REQUIRE(fmt_unsigned(i) == std::to_string(i));
+    }
+}
@@ -1,7 +1,14 @@
 #include "catch.hpp"
 
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/storage/item_stash.hpp>
 #include <osmium/util/memory.hpp>
 
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
 #include <vector>
 
 TEST_CASE("Check memory usage") {
@@ -16,3 +23,82 @@ TEST_CASE("Check memory usage") {
 #endif
 }
 
+
+TEST_CASE("Memory accounts are registered and removed with their handle") {
+    auto& accounting = osmium::MemoryAccounting::instance();
+    const std::size_t num_accounts_before = accounting.size();
+
+    {
+        osmium::MemoryAccount account{"some_component", []() {
+            return std::size_t(1000);
+        }};
+        REQUIRE(account.valid());
+        REQUIRE(accounting.size() == num_accounts_before + 1);
+
+        std::map<std::string, std::size_t> seen;
+        accounting.for_each([&](const char* name, std::size_t bytes) {
+            seen[name] = bytes;
+        });
+        REQUIRE(seen["some_component"] == 1000);
+        REQUIRE(accounting.total() >= 1000);
+
+        osmium::MemoryAccount moved{std::move(account)};
+        REQUIRE(moved.valid());
+        REQUIRE_FALSE(account.valid()); // NOLINT(bugprone-use-after-move,hicpp-invalid-access-moved)
+        REQUIRE(accounting.size() == num_accounts_before + 1);
+    }
+
+    REQUIRE(accounting.size() == num_accounts_before);
+}
+
+TEST_CASE("Memory accounts report live values") {
+    auto& accounting = osmium::MemoryAccounting::instance();
+
+    std::size_t bytes = 100;
+    const osmium::MemoryAccount account{"growing", [&bytes]() {
+        return bytes;
+    }};
+
+    std::size_t reported = 0;
+    accounting.for_each([&](const char* name, std::size_t value) {
+        if (std::string{name} == "growing") {
+            reported = value;
+        }
+    });
+    REQUIRE(reported == 100);
+
+    bytes = 200;
+    accounting.for_each([&](const char* name, std::size_t value) {
+        if (std::string{name} == "growing") {
+            reported = value;
+        }
+    });
+    REQUIRE(reported == 200);
+}
+
+TEST_CASE("Index maps and item stashes can register memory accounts") {
+    auto& accounting = osmium::MemoryAccounting::instance();
+    const std::size_t num_accounts_before = accounting.size();
+
+    osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, std::size_t> index;
+    const auto index_account = index.account_memory("location_index");
+
+    osmium::ItemStash stash;
+    const auto stash_account = stash.account_memory("stash");
+
+    REQUIRE(accounting.size() == num_accounts_before + 2);
+
+    bool found_index = false;
+    bool found_stash = false;
+    accounting.for_each([&](const char* name, std::size_t bytes) {
+        if (std::string{name} == "location_index") {
+            found_index = true;
+            REQUIRE(bytes == index.used_memory());
+        } else if (std::string{name} == "stash") {
+            found_stash = true;
+            REQUIRE(bytes == stash.used_memory());
+        }
+    });
+    REQUIRE(found_index);
+    REQUIRE(found_stash);
+}
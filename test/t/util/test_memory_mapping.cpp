@@ -408,3 +408,27 @@ TEST_CASE("Anonymous memory mapping class: remapping to smaller size should work
 }
 #endif
 
+
+TEST_CASE("Anonymous mapping: advise and populate should work") {
+    osmium::MemoryMapping mapping{1024 * 1024, osmium::MemoryMapping::mapping_mode::write_private};
+    REQUIRE(mapping.get_addr() != nullptr);
+
+#ifndef _WIN32
+    REQUIRE(mapping.advise(osmium::MemoryMapping::advice::random));
+    REQUIRE(mapping.advise(osmium::MemoryMapping::advice::sequential));
+    REQUIRE(mapping.advise(osmium::MemoryMapping::advice::willneed));
+    REQUIRE(mapping.advise(osmium::MemoryMapping::advice::normal));
+#else
+    REQUIRE_FALSE(mapping.advise(osmium::MemoryMapping::advice::random));
+#endif
+
+    // huge pages are only a hint, this must not fail either way
+    mapping.advise_huge_pages();
+
+    mapping.populate();
+    auto* addr = mapping.get_addr<int>();
+    *addr = 42;
+    REQUIRE(*addr == 42);
+
+    mapping.unmap();
+}
@@ -0,0 +1,15 @@
+#include "catch.hpp"
+
+#include <osmium/util/probes.hpp>
+
+// Without OSMIUM_WITH_SDT the probe macros must compile to nothing
+// and be usable as statements wherever a probe point makes sense.
+TEST_CASE("Probe macros are no-ops when compiled without OSMIUM_WITH_SDT") {
+    int value = 1;
+    OSMIUM_PROBE(test_probe);
+    OSMIUM_PROBE1(test_probe_with_arg, value);
+    if (value) {
+        OSMIUM_PROBE(test_probe_in_branch);
+    }
+    REQUIRE(value == 1);
+}
@@ -0,0 +1,69 @@
+#include "catch.hpp"
+
+// This must come before any Osmium include so the counting macros in
+// this translation unit are compiled in.
+#define OSMIUM_WITH_PROFILING
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/util/profiling.hpp>
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+TEST_CASE("Profiling counters can be incremented, read, and reset") {
+    auto& counters = osmium::util::profiling_counters();
+    counters.reset();
+
+    OSMIUM_PROFILE_COUNT(buffer_grows);
+    OSMIUM_PROFILE_ADD(bytes_compressed, 42);
+
+    REQUIRE(counters.buffer_grows == 1);
+    REQUIRE(counters.bytes_compressed == 42);
+
+    std::map<std::string, uint64_t> seen;
+    counters.for_each([&](const char* name, uint64_t value) {
+        seen[name] = value;
+    });
+
+    REQUIRE(seen.size() == 8);
+    REQUIRE(seen["buffer_grows"] == 1);
+    REQUIRE(seen["bytes_compressed"] == 42);
+    REQUIRE(seen["objects_decoded"] == 0);
+
+    counters.reset();
+    REQUIRE(counters.buffer_grows == 0);
+    REQUIRE(counters.bytes_compressed == 0);
+}
+
+TEST_CASE("Profiling counts buffer grows") {
+    auto& counters = osmium::util::profiling_counters();
+    counters.reset();
+
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{64, osmium::memory::Buffer::auto_grow::yes};
+    for (int n = 1; n <= 100; ++n) {
+        osmium::builder::add_node(buffer, _id(n));
+    }
+
+    REQUIRE(counters.buffer_grows > 0);
+}
+
+TEST_CASE("Profiling counts index probes and misses") {
+    auto& counters = osmium::util::profiling_counters();
+    counters.reset();
+
+    osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, std::size_t> index;
+    index.set(17, 1);
+    index.sort();
+
+    REQUIRE(index.get(17) == 1);
+    REQUIRE_THROWS_AS(index.get(18), const osmium::not_found&);
+
+    REQUIRE(counters.index_probes == 2);
+    REQUIRE(counters.index_misses == 1);
+}
@@ -0,0 +1,46 @@
+#include "catch.hpp"
+
+#include <osmium/util/string_interner.hpp>
+
+#include <stdexcept>
+#include <string>
+
+TEST_CASE("Empty string interner") {
+    osmium::StringInterner interner;
+    REQUIRE(interner.empty());
+    REQUIRE(interner.size() == 0);
+    REQUIRE(interner.get_id("highway") == osmium::StringInterner::invalid_id);
+    REQUIRE_THROWS_AS(interner.get_string(0), const std::out_of_range&);
+}
+
+TEST_CASE("Intern some strings") {
+    osmium::StringInterner interner;
+
+    const auto highway = interner.intern("highway");
+    const auto name = interner.intern(std::string{"name"});
+    const auto building = interner.intern("building");
+
+    REQUIRE(interner.size() == 3);
+    REQUIRE(highway == 0);
+    REQUIRE(name == 1);
+    REQUIRE(building == 2);
+
+    // interning again gives the same id
+    REQUIRE(interner.intern("name") == name);
+    REQUIRE(interner.size() == 3);
+
+    REQUIRE(interner.get_id("highway") == highway);
+    REQUIRE(interner.get_id("building") == building);
+    REQUIRE(interner.get_id("landuse") == osmium::StringInterner::invalid_id);
+
+    REQUIRE(std::string{interner.get_string(highway)} == "highway");
+    REQUIRE(std::string{interner.get_string(building)} == "building");
+    REQUIRE_THROWS_AS(interner.get_string(3), const std::out_of_range&);
+}
+
+TEST_CASE("Default instance of string interner") {
+    auto& interner = osmium::StringInterner::default_instance();
+    const auto id = interner.intern("test-default-instance");
+    REQUIRE(&osmium::StringInterner::default_instance() == &interner);
+    REQUIRE(osmium::StringInterner::default_instance().get_id("test-default-instance") == id);
+}
@@ -2,6 +2,7 @@
 
 #include <osmium/util/string_matcher.hpp>
 
+#include <cstring>
 #include <sstream>
 #include <string>
 #include <type_traits>
@@ -104,6 +105,24 @@ TEST_CASE("String matcher: regex substr") {
 }
 #endif
 
+TEST_CASE("String matcher: function") {
+    osmium::StringMatcher::function m{[](const char* str) {
+        return str[0] == 'f';
+    }};
+    REQUIRE(m.match("foo"));
+    REQUIRE_FALSE(m.match("bar"));
+    REQUIRE_FALSE(m.match(""));
+}
+
+TEST_CASE("Construct StringMatcher from function matcher") {
+    osmium::StringMatcher m{osmium::StringMatcher::function{[](const char* str) {
+        return std::strcmp(str, "foo") == 0;
+    }}};
+    REQUIRE(m("foo"));
+    REQUIRE_FALSE(m("bar"));
+    REQUIRE(print(m) == "function");
+}
+
 TEST_CASE("String matcher: list") {
     osmium::StringMatcher::list m{{"foo", "bar"}};
     REQUIRE(m.match("foo"));
@@ -126,6 +145,25 @@ TEST_CASE("String matcher: list with add") {
     REQUIRE_FALSE(m.match(""));
 }
 
+TEST_CASE("String matcher: large list") {
+    std::vector<std::string> strings;
+    for (int i = 0; i < 100; ++i) {
+        strings.push_back("value" + std::to_string(i));
+    }
+
+    osmium::StringMatcher::list m{strings};
+    REQUIRE(m.match("value0"));
+    REQUIRE(m.match("value42"));
+    REQUIRE(m.match("value99"));
+    REQUIRE_FALSE(m.match("value100"));
+    REQUIRE_FALSE(m.match("foo"));
+    REQUIRE_FALSE(m.match(""));
+
+    m.add_string("foo");
+    REQUIRE(m.match("foo"));
+    REQUIRE(m.match("value42"));
+}
+
 TEST_CASE("Default constructed StringMatcher matches nothing") {
     osmium::StringMatcher m;
     REQUIRE_FALSE(m("foo"));
@@ -0,0 +1,88 @@
+#include "catch.hpp"
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+namespace osmium {
+
+    namespace detail {
+
+        const char* env = nullptr;
+
+        inline const char* getenv_wrapper(const char* /*var*/) noexcept {
+            return env;
+        }
+
+    } // namespace detail
+
+} // namespace osmium
+
+#define OSMIUM_TEST_RUNNER
+#include <osmium/util/tuning.hpp>
+
+TEST_CASE("Tuning defaults without environment") {
+    osmium::detail::env = nullptr;
+    const osmium::config::Tuning tuning{};
+
+    REQUIRE(tuning.pool_threads == 0);
+    REQUIRE(tuning.pool_affinity.empty());
+    REQUIRE(tuning.work_queue_size == 10);
+    REQUIRE(tuning.max_reader_pool_tasks == 0);
+    REQUIRE(tuning.input_queue_size == 20);
+    REQUIRE_FALSE(tuning.input_queue_size_fixed);
+    REQUIRE(tuning.osmdata_queue_size >= 20);
+    REQUIRE_FALSE(tuning.osmdata_queue_size_fixed);
+    REQUIRE(tuning.input_buffer_size == 1024u * 1024u);
+    REQUIRE_FALSE(tuning.direct_reads);
+    REQUIRE(tuning.pool_threads_for_pbf_parsing);
+    REQUIRE(tuning.output_queue_size == 20);
+    REQUIRE_FALSE(tuning.output_queue_size_fixed);
+}
+
+TEST_CASE("Tuning picks up environment overrides") {
+    osmium::detail::env = "7";
+    const osmium::config::Tuning tuning{};
+    osmium::detail::env = nullptr;
+
+    REQUIRE(tuning.pool_threads == 7);
+    REQUIRE(tuning.pool_affinity == "7");
+    REQUIRE(tuning.work_queue_size == 7);
+    REQUIRE(tuning.max_reader_pool_tasks == 7);
+    REQUIRE(tuning.input_queue_size == 7);
+    REQUIRE(tuning.input_queue_size_fixed);
+    REQUIRE(tuning.osmdata_queue_size == 7);
+    REQUIRE(tuning.osmdata_queue_size_fixed);
+    REQUIRE(tuning.input_buffer_size == 7);
+    REQUIRE(tuning.output_queue_size == 7);
+    REQUIRE(tuning.output_queue_size_fixed);
+
+    // "7" is not a valid value for the boolean knobs
+    REQUIRE_FALSE(tuning.direct_reads);
+    REQUIRE(tuning.pool_threads_for_pbf_parsing);
+}
+
+TEST_CASE("Tuning registry can be changed programmatically") {
+    osmium::detail::env = nullptr;
+
+    osmium::config::tuning().work_queue_size = 42;
+    REQUIRE(osmium::config::tuning().work_queue_size == 42);
+
+    osmium::config::tuning().direct_reads = true;
+    REQUIRE(osmium::config::tuning().direct_reads);
+}
+
+TEST_CASE("Tuning dump shows the effective values") {
+    osmium::detail::env = nullptr;
+    osmium::config::Tuning tuning{};
+    tuning.input_queue_size = 5;
+    tuning.input_queue_size_fixed = true;
+
+    std::ostringstream out;
+    tuning.dump(out);
+    const std::string dump{out.str()};
+
+    REQUIRE(dump.find("pool_threads = 0") != std::string::npos);
+    REQUIRE(dump.find("input_queue_size = 5 (fixed)") != std::string::npos);
+    REQUIRE(dump.find("direct_reads = no") != std::string::npos);
+}